@@ -17,11 +17,17 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "streamWriterImpl.h"
 #include "memoryStreamImpl.h"
 #include "memoryImpl.h"
+#include "fileStreamImpl.h"
+#include "mappedFileStreamImpl.h"
 #include "configurationImpl.h"
 #include "dicomStreamCodecImpl.h"
 #include "dataHandlerStringUIImpl.h"
 #include <memory.h>
 #include <cassert>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <vector>
 
 namespace imebra
 {
@@ -31,6 +37,84 @@ namespace implementation
 
 static const std::string m_applicationContext("1.2.840.10008.3.1.1.1");
 
+namespace
+{
+
+///////////////////////////////////////////////////////////
+//
+// Removes a temporary file when it goes out of scope,
+//  also when an exception is thrown while the file is
+//  being filled or mapped.
+//
+///////////////////////////////////////////////////////////
+class temporaryFileRemover
+{
+public:
+    temporaryFileRemover(const std::string& fileName): m_fileName(fileName)
+    {
+    }
+
+    ~temporaryFileRemover()
+    {
+        ::remove(m_fileName.c_str());
+    }
+
+private:
+    temporaryFileRemover(const temporaryFileRemover&) = delete;
+    temporaryFileRemover& operator=(const temporaryFileRemover&) = delete;
+
+    const std::string m_fileName;
+};
+
+
+///////////////////////////////////////////////////////////
+//
+// Create a new temporary file with a random name in the
+//  spool folder. The file is opened only if it doesn't
+//  exist yet, so a file or link prepared in the folder by
+//  someone else is never overwritten.
+//
+///////////////////////////////////////////////////////////
+std::shared_ptr<fileStreamOutput> createSpoolFile(const std::string& spoolFolder, std::string& spoolFileName)
+{
+    IMEBRA_FUNCTION_START();
+
+    const size_t maxAttempts(16);
+    std::random_device randomDevice;
+
+    for(size_t attempt(1); ; ++attempt)
+    {
+        std::ostringstream fileName;
+        fileName << spoolFolder;
+        if(spoolFolder.back() != '/' && spoolFolder.back() != '\\')
+        {
+            fileName << '/';
+        }
+        fileName << "imebra_spool_" << std::hex << std::setfill('0')
+                 << std::setw(8) << randomDevice()
+                 << std::setw(8) << randomDevice()
+                 << std::setw(8) << randomDevice();
+
+        try
+        {
+            std::shared_ptr<fileStreamOutput> spoolFile(std::make_shared<fileStreamOutput>(fileName.str(), true));
+            spoolFileName = fileName.str();
+            return spoolFile;
+        }
+        catch(const StreamOpenError&)
+        {
+            if(attempt == maxAttempts)
+            {
+                throw;
+            }
+        }
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+} // anonymous namespace
+
 
 acseItem::~acseItem()
 {
@@ -1637,6 +1721,29 @@ presentationContexts::presentationContexts(const presentationContexts &right)
 }
 
 
+payloadSpoolFolders::payloadSpoolFolders()
+{
+
+}
+
+
+void payloadSpoolFolders::setPayloadSpoolFolder(const std::string& abstractSyntax, const std::string& spoolFolder, std::uint32_t maxSizeBufferLoad)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(spoolFolder.empty())
+    {
+        m_spoolFolders.erase(abstractSyntax);
+    }
+    else
+    {
+        m_spoolFolders[abstractSyntax] = std::pair<std::string, std::uint32_t>(spoolFolder, maxSizeBufferLoad);
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
 associationMessage::associationMessage(const std::string& abstractSyntax):
     associationMessage(abstractSyntax, nullptr)
 {
@@ -1734,7 +1841,8 @@ associationBase::associationBase(
         std::uint32_t maxOperationsWeCanPerform,
         std::shared_ptr<streamReader> pReader,
         std::shared_ptr<streamWriter> pWriter,
-        std::uint32_t dimseTimeout):
+        std::uint32_t dimseTimeout,
+        bool bReaderThread):
     m_role(role),
     m_thisAET(thisAET),
     m_otherAET(otherAET),
@@ -1744,6 +1852,7 @@ associationBase::associationBase(
     m_maxPDULength(MAXIMUM_PDU_SIZE),
     m_pReader(pReader),
     m_pWriter(pWriter),
+    m_bReaderThread(bReaderThread),
     m_bTerminated(false),
     m_dimseTimeout(dimseTimeout)
 {
@@ -1983,6 +2092,32 @@ std::shared_ptr<associationMessage> associationBase::getMessage(std::uint16_t me
             scanDatasets = nextDataset;
         }
 
+        // Without a reading thread the message is read by the
+        // first thread that needs it, while the other ones
+        // wait for the notification
+        ///////////////////////////////////////////////////////////
+        if(!m_bReaderThread)
+        {
+            std::unique_lock<std::mutex> lockRead(m_lockReadMessage, std::try_to_lock);
+            if(lockRead.owns_lock())
+            {
+                lock.unlock();
+                try
+                {
+                    readMessage();
+                }
+                catch(...)
+                {
+                    std::unique_lock<std::mutex> lockTerminated(m_lockReadyDataSets);
+                    m_bTerminated = true;
+                    m_notifyReadyDataSets.notify_all();
+                    throw;
+                }
+                lock.lock();
+                continue;
+            }
+        }
+
         if(m_dimseTimeout != 0 && std::chrono::steady_clock::now() > endTime)
         {
             abort(acsePDUAAbort::reason_t::serviceUser);
@@ -2018,128 +2153,173 @@ associationBase::receivedDataset::receivedDataset(const std::string& presentatio
 // Decode and return a complete dataset
 //
 ///////////////////////////////////////////////////////////
-std::shared_ptr<associationBase::receivedDataset> associationBase::decodePDU(bool bCommand, std::list<std::shared_ptr<acseItemPDataValue> >& pendingPData, size_t& numberOfLastPData) const
+std::shared_ptr<associationBase::receivedDataset> associationBase::decodePDU(bool bCommand, std::list<std::shared_ptr<acseItemPDataValue> >& pendingPData) const
 {
     IMEBRA_FUNCTION_START();
 
-    // Loop until a dataset is complete
+    // Wait for the first value of the dataset
     ///////////////////////////////////////////////////////////
-    for(;;)
+    while(pendingPData.empty())
+    {
+        receivePData(pendingPData);
+    }
+
+    presentationContextsIds_t::const_iterator findPresentationContext(
+                m_presentationContextsIds.find(pendingPData.front()->m_presentationContextId));
+    if(findPresentationContext == m_presentationContextsIds.end())
+    {
+        IMEBRA_THROW(AcseCorruptedMessageError, "Presentation context ID " << pendingPData.front()->m_presentationContextId << " not valid");
+    }
+    const std::string abstractSyntax(findPresentationContext->second.first->m_abstractSyntax);
+    const std::string transferSyntax(findPresentationContext->second.second);
+
+    bool bExplicitDataType(false);
+    streamController::tByteOrdering endianType(streamController::lowByteEndian);
+
+    if(!bCommand)
     {
-        // Check if a complete dataset is available
+        // Adjust the transfer syntax flags
+        ///////////////////////////////////////////////////////////
+        bExplicitDataType = (transferSyntax != "1.2.840.10008.1.2");        // Implicit VR little endian
+
+        // Explicit VR big endian
         ///////////////////////////////////////////////////////////
-        if(numberOfLastPData != 0)
+        endianType = (transferSyntax == "1.2.840.10008.1.2.2") ? streamController::highByteEndian : streamController::lowByteEndian;
+    }
+
+    // Check if the payload has to be spooled to a file
+    ///////////////////////////////////////////////////////////
+    std::string spoolFolder;
+    std::uint32_t maxSizeBufferLoad(0xffffffff);
+    if(!bCommand)
+    {
+        std::lock_guard<std::mutex> lock(m_lockSpoolFolders);
+        payloadSpoolFolders::spoolFolders_t::const_iterator findSpoolFolder(m_spoolFolders.find(abstractSyntax));
+        if(findSpoolFolder != m_spoolFolders.end())
         {
-            // Decode all the pdata values until the last one of a
-            // dataset is found
-            ///////////////////////////////////////////////////////////
-            size_t datasetSize(0);
-            std::string abstractSyntax;
-            std::string transferSyntax;
-            for(std::shared_ptr<acseItemPDataValue> pData: pendingPData)
-            {
-                datasetSize += pData->m_memorySize;
-                if(pData->m_bLast)
-                {
-                    presentationContextsIds_t::const_iterator findPresentationContext(
-                                m_presentationContextsIds.find(pData->m_presentationContextId));
-                    if(findPresentationContext == m_presentationContextsIds.end())
-                    {
-                        IMEBRA_THROW(AcseCorruptedMessageError, "Presentation context ID " << pData->m_presentationContextId << " not valid");
-                    }
-                    abstractSyntax = findPresentationContext->second.first->m_abstractSyntax;
-                    transferSyntax = findPresentationContext->second.second;
-                    break;
-                }
-            }
+            spoolFolder = findSpoolFolder->second.first;
+            maxSizeBufferLoad = findSpoolFolder->second.second;
+        }
+    }
+
+    std::shared_ptr<pDataStreamInput> dataSetStream(std::make_shared<pDataStreamInput>(*this, pendingPData));
+    std::shared_ptr<dataSet> pDataset(std::make_shared<dataSet>(transferSyntax, charsetsList_t()));
 
-            std::shared_ptr<memory> datasetMemory(std::make_shared<memory>(datasetSize));
-            size_t memoryOffset(0);
-            for(;;)
+    if(spoolFolder.empty())
+    {
+        // Parse the dataset while its P-DATA values are received
+        ///////////////////////////////////////////////////////////
+        std::shared_ptr<streamReader> dataSetStreamReader(std::make_shared<streamReader>(dataSetStream));
+        codecs::dicomStreamCodec::parseStream(dataSetStreamReader, pDataset, bExplicitDataType, endianType);
+        dataSetStream->skipToEnd();
+    }
+    else
+    {
+        // Write the P-DATA values into a temporary file while
+        //  they are received
+        ///////////////////////////////////////////////////////////
+        std::string spoolFileName;
+        std::shared_ptr<fileStreamOutput> spoolFile(createSpoolFile(spoolFolder, spoolFileName));
+        temporaryFileRemover removeSpoolFile(spoolFileName);
+        {
+            std::vector<std::uint8_t> copyBuffer(65536);
+            size_t spoolPosition(0);
+            for(size_t readBytes(dataSetStream->read(0, copyBuffer.data(), copyBuffer.size()));
+                readBytes != 0;
+                readBytes = dataSetStream->read(0, copyBuffer.data(), copyBuffer.size()))
             {
-                std::shared_ptr<acseItemPDataValue> pData(pendingPData.front());
-                pendingPData.pop_front();
-                ::memcpy(datasetMemory->data() + memoryOffset,
-                         pData->m_pMemory->data() + pData->m_memoryOffset,
-                         pData->m_memorySize);
-                memoryOffset += pData->m_memorySize;
-                if(pData->m_bLast)
-                {
-                    break;
-                }
+                spoolFile->write(spoolPosition, copyBuffer.data(), readBytes);
+                spoolPosition += readBytes;
             }
-            --numberOfLastPData;
+            spoolFile.reset();
+        }
 
-            bool bExplicitDataType(false);
-            streamController::tByteOrdering endianType(streamController::lowByteEndian);
+        // Map the file and remove it from the folder: the
+        //  mapping remains valid until the dataset is
+        //  released. removeSpoolFile takes care of the file
+        //  if the copy or the mapping fail
+        ///////////////////////////////////////////////////////////
+        std::shared_ptr<mappedFileStreamInput> spoolStream(std::make_shared<mappedFileStreamInput>(spoolFileName));
+        ::remove(spoolFileName.c_str());
+        std::shared_ptr<streamReader> dataSetStreamReader(std::make_shared<streamReader>(spoolStream));
+        codecs::dicomStreamCodec::parseStream(dataSetStreamReader, pDataset, bExplicitDataType, endianType, maxSizeBufferLoad);
+    }
 
-            if(!bCommand)
-            {
-                // Adjust the transfer syntax flags
-                ///////////////////////////////////////////////////////////
-                bExplicitDataType = (transferSyntax != "1.2.840.10008.1.2");        // Implicit VR little endian
+    // Return the dataset
+    ///////////////////////////////////////////////////////////
+    return std::make_shared<receivedDataset>(abstractSyntax, pDataset);
 
-                // Explicit VR big endian
-                ///////////////////////////////////////////////////////////
-                endianType = (transferSyntax == "1.2.840.10008.1.2.2") ? streamController::highByteEndian : streamController::lowByteEndian;
-            }
+    IMEBRA_FUNCTION_END();
+}
 
-            std::shared_ptr<memoryStreamInput> dataSetStream(std::make_shared<memoryStreamInput>(datasetMemory));
-            std::shared_ptr<streamReader> dataSetStreamReader(std::make_shared<streamReader>(dataSetStream));
-            std::shared_ptr<dataSet> pDataset(std::make_shared<dataSet>(transferSyntax, charsetsList_t()));
-            codecs::dicomStreamCodec::parseStream(dataSetStreamReader, pDataset, bExplicitDataType, endianType);
 
-            // Return the dataset
-            ///////////////////////////////////////////////////////////
-            return std::make_shared<receivedDataset>(abstractSyntax, pDataset);
-        }
+///////////////////////////////////////////////////////////
+//
+// Decode the next PDU and append its P-DATA values to the
+//  pending ones
+//
+///////////////////////////////////////////////////////////
+void associationBase::receivePData(std::list<std::shared_ptr<acseItemPDataValue> >& pendingPData) const
+{
+    IMEBRA_FUNCTION_START();
 
-        // Get pdata values
-        ///////////////////////////////////////////////////////////
-        std::shared_ptr<acsePDU> pdu(acsePDU::decodePDU(m_pReader));
+    std::shared_ptr<acsePDU> pdu(acsePDU::decodePDU(m_pReader));
 
-        switch(pdu->getPDUType())
+    switch(pdu->getPDUType())
+    {
+    case acsePDU::pduType_t::aReleaseRQ:
+        // release request. Send a release response and
+        // throw a StreamClosedError exception
         {
-        case acsePDU::pduType_t::aReleaseRQ:
-            // release request. Send a release response and
-            // throw a StreamClosedError exception
-            {
-                std::unique_lock<std::mutex> lock(m_lockWrite);
-                std::shared_ptr<acsePDUAReleaseRP> releaseRP(std::make_shared<acsePDUAReleaseRP>());
-                releaseRP->encodePDU(m_pWriter);
-                IMEBRA_THROW(StreamClosedError, "The association has been released");
-            }
-            break;
-        case acsePDU::pduType_t::aReleaseRP:
-            // release response received
+            std::unique_lock<std::mutex> lock(m_lockWrite);
+            std::shared_ptr<acsePDUAReleaseRP> releaseRP(std::make_shared<acsePDUAReleaseRP>());
+            releaseRP->encodePDU(m_pWriter);
             IMEBRA_THROW(StreamClosedError, "The association has been released");
-        case acsePDU::pduType_t::aAbort:
-            // association aborted
-            IMEBRA_THROW(StreamClosedError, "The association has been aborted");
-        case acsePDU::pduType_t::pData:
-            {
+        }
+        break;
+    case acsePDU::pduType_t::aReleaseRP:
+        // release response received
+        IMEBRA_THROW(StreamClosedError, "The association has been released");
+    case acsePDU::pduType_t::aAbort:
+        // association aborted
+        IMEBRA_THROW(StreamClosedError, "The association has been aborted");
+    case acsePDU::pduType_t::pData:
+        {
 
-                std::shared_ptr<acsePDUPData> pData(std::static_pointer_cast<acsePDUPData>(pdu));
+            std::shared_ptr<acsePDUPData> pData(std::static_pointer_cast<acsePDUPData>(pdu));
 
-                // Add the pdata values to the pending pdata
-                ///////////////////////////////////////////////////////////
-                for(std::shared_ptr<acseItemPDataValue> pDataValue: pData->getValues())
+            // Add the pdata values to the pending pdata
+            ///////////////////////////////////////////////////////////
+            for(std::shared_ptr<acseItemPDataValue> pDataValue: pData->getValues())
+            {
+                if(pDataValue->m_memorySize != 0)
                 {
-                    if(pDataValue->m_memorySize != 0)
-                    {
-                        pendingPData.push_back(pDataValue);
-                        if(pDataValue->m_bLast)
-                        {
-                            ++numberOfLastPData;
-                        }
-                    }
+                    pendingPData.push_back(pDataValue);
                 }
             }
-            break;
-        default:
-            IMEBRA_THROW(AcseCorruptedMessageError, "Unexpected association request message (association already negotiated)");
         }
+        break;
+    default:
+        IMEBRA_THROW(AcseCorruptedMessageError, "Unexpected association request message (association already negotiated)");
+    }
 
+    IMEBRA_FUNCTION_END();
+}
+
+
+void associationBase::setPayloadSpoolFolder(const std::string& abstractSyntax, const std::string& spoolFolder, std::uint32_t maxSizeBufferLoad)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::lock_guard<std::mutex> lock(m_lockSpoolFolders);
+
+    if(spoolFolder.empty())
+    {
+        m_spoolFolders.erase(abstractSyntax);
+    }
+    else
+    {
+        m_spoolFolders[abstractSyntax] = std::pair<std::string, std::uint32_t>(spoolFolder, maxSizeBufferLoad);
     }
 
     IMEBRA_FUNCTION_END();
@@ -2179,6 +2359,26 @@ void associationBase::release()
         std::unique_lock<std::mutex> lock(m_lockReadyDataSets);
         while(!m_bTerminated)
         {
+            if(!m_bReaderThread)
+            {
+                std::unique_lock<std::mutex> lockRead(m_lockReadMessage, std::try_to_lock);
+                if(lockRead.owns_lock())
+                {
+                    lock.unlock();
+                    try
+                    {
+                        readMessage();
+                    }
+                    catch(const std::exception&)
+                    {
+                        std::unique_lock<std::mutex> lockTerminated(m_lockReadyDataSets);
+                        m_bTerminated = true;
+                        m_notifyReadyDataSets.notify_all();
+                    }
+                    lock.lock();
+                    continue;
+                }
+            }
             m_notifyReadyDataSets.wait(lock);
         }
     }
@@ -2264,18 +2464,25 @@ std::vector<std::string> associationBase::getPresentationContextTransferSyntaxes
 
 void associationBase::getMessagesThread()
 {
-    std::shared_ptr<associationMessage> pMessage;
+    // Loop until terminated
+    ///////////////////////////////////////////////////////////
+    while(readMessage())
+    {
+    }
+}
 
-    std::list<std::shared_ptr<acseItemPDataValue> > pendingData;
-    size_t numberOfLastPData(0);
+
+bool associationBase::readMessage()
+{
+    std::shared_ptr<associationMessage>& pMessage(m_pIncompleteMessage);
 
     try
     {
-        // Loop until terminated
+        // Loop until a message is complete
         ///////////////////////////////////////////////////////////
         for(;;)
         {
-            std::shared_ptr<receivedDataset> pReceivedDataset(decodePDU(pMessage == nullptr, pendingData, numberOfLastPData));
+            std::shared_ptr<receivedDataset> pReceivedDataset(decodePDU(pMessage == nullptr, m_pendingPData));
 
             if(pReceivedDataset->m_pDataset->bufferExists(0, 0, 0x100, 0))
             {
@@ -2366,21 +2573,146 @@ void associationBase::getMessagesThread()
                 m_readyDataSets.push_back(pMessage);
                 pMessage.reset();
                 m_notifyReadyDataSets.notify_all();
+                return true;
             }
 
+            // Without a reading thread decode only the dataset
+            //  that the caller knows has been received
+            ///////////////////////////////////////////////////////////
+            if(!m_bReaderThread)
+            {
+                return true;
+            }
         }
     }
     catch(const StreamEOFError&)
     {
-        // Set the terminated flag, release current getMessage()
-        // operations
+    }
+    catch(const StreamError&)
+    {
+        // The received data cannot be read or stored (e.g. a
+        //  payload cannot be spooled): abort the association
+        ///////////////////////////////////////////////////////////
+        try
+        {
+            abort(acsePDUAAbort::reason_t::serviceProviderReasonNotSpecified);
+        }
+        catch(const StreamError&)
+        {
+        }
+    }
+
+    // Set the terminated flag, release current getMessage()
+    // operations
+    ///////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(m_lockReadyDataSets);
+    m_bTerminated = true;
+    m_notifyReadyDataSets.notify_all();
+
+    return false;
+}
+
+
+bool associationBase::isCommandPending()
+{
+    IMEBRA_FUNCTION_START();
+
+    {
         std::unique_lock<std::mutex> lock(m_lockReadyDataSets);
-        m_bTerminated = true;
-        m_notifyReadyDataSets.notify_all();
+        for(const std::shared_ptr<associationMessage>& pMessage: m_readyDataSets)
+        {
+            if((pMessage->getCommandDataSet()->getUnsignedLong(0x0, 0, 0x100, 0, 0, 0) & 0x00008000) == 0)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+
+    IMEBRA_FUNCTION_END();
+}
+
+///////////////////////////////////////////////////////////
+//
+// pDataStreamInput
+//
+///////////////////////////////////////////////////////////
+pDataStreamInput::pDataStreamInput(const associationBase& association, std::list<std::shared_ptr<acseItemPDataValue> >& pendingData):
+    m_association(association),
+    m_pendingData(pendingData),
+    m_bEndOfDataset(false)
+{
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Return the content of the pending P-DATA values. New
+//  PDUs are decoded only when no data is available
+//
+///////////////////////////////////////////////////////////
+size_t pDataStreamInput::read(size_t /* startPosition */, std::uint8_t* pBuffer, size_t bufferLength)
+{
+    IMEBRA_FUNCTION_START();
+
+    size_t readBytes(0);
+    while(readBytes != bufferLength && !m_bEndOfDataset)
+    {
+        if(m_pendingData.empty())
+        {
+            if(readBytes != 0)
+            {
+                break;
+            }
+            m_association.receivePData(m_pendingData);
+            continue;
+        }
+
+        acseItemPDataValue& pData(*(m_pendingData.front()));
+        const size_t copyBytes(std::min(pData.m_memorySize, bufferLength - readBytes));
+        ::memcpy(pBuffer + readBytes, pData.m_pMemory->data() + pData.m_memoryOffset, copyBytes);
+        pData.m_memoryOffset += copyBytes;
+        pData.m_memorySize -= copyBytes;
+        readBytes += copyBytes;
+
+        if(pData.m_memorySize == 0)
+        {
+            m_bEndOfDataset = pData.m_bLast;
+            m_pendingData.pop_front();
+        }
+    }
+
+    return readBytes;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+void pDataStreamInput::terminate()
+{
+}
+
+
+void pDataStreamInput::skipToEnd()
+{
+    IMEBRA_FUNCTION_START();
+
+    while(!m_bEndOfDataset)
+    {
+        if(m_pendingData.empty())
+        {
+            m_association.receivePData(m_pendingData);
+            continue;
+        }
+        m_bEndOfDataset = m_pendingData.front()->m_bLast;
+        m_pendingData.pop_front();
     }
 
+    IMEBRA_FUNCTION_END();
 }
 
+
 associationSCU::associationSCU(
         const std::shared_ptr<const presentationContexts>& contexts,
         const std::string& thisAET,
@@ -2390,7 +2722,7 @@ associationSCU::associationSCU(
         std::shared_ptr<streamReader> pReader,
         std::shared_ptr<streamWriter> pWriter,
         std::uint32_t dimseTimeout):
-    associationBase(role_t::scu, thisAET, otherAET, maxOperationsWeInvoke, maxOperationsWeCanPerform, pReader, pWriter, dimseTimeout)
+    associationBase(role_t::scu, thisAET, otherAET, maxOperationsWeInvoke, maxOperationsWeCanPerform, pReader, pWriter, dimseTimeout, true)
 
 {
     IMEBRA_FUNCTION_START();
@@ -2609,11 +2941,24 @@ associationSCP::associationSCP(
         std::shared_ptr<streamReader> pReader,
         std::shared_ptr<streamWriter> pWriter,
         std::uint32_t dimseTimeout,
-        std::uint32_t artimTimeoutSeconds):
-    associationBase(role_t::scp, thisAET, "", maxOperationsWeInvoke, maxOperationsWeCanPerform, pReader, pWriter, dimseTimeout)
+        std::uint32_t artimTimeoutSeconds,
+        const std::shared_ptr<const payloadSpoolFolders>& spoolFolders,
+        bool bReaderThread):
+    associationBase(role_t::scp, thisAET, "", maxOperationsWeInvoke, maxOperationsWeCanPerform, pReader, pWriter, dimseTimeout, bReaderThread)
 {
     IMEBRA_FUNCTION_START();
 
+    // The spool folders must be known before the first payload
+    //  arrives, which may happen right after the negotiation
+    ///////////////////////////////////////////////////////////
+    if(spoolFolders != nullptr)
+    {
+        for(const payloadSpoolFolders::spoolFolders_t::value_type& spoolFolder: spoolFolders->m_spoolFolders)
+        {
+            setPayloadSpoolFolder(spoolFolder.first, spoolFolder.second.first, spoolFolder.second.second);
+        }
+    }
+
     IMEBRA_LOG_INFO("-- Starting SCP association negotiation");
 
     // Wait for association request PDU
@@ -2795,7 +3140,7 @@ associationSCP::associationSCP(
         }
     }
     std::shared_ptr<acseItemUserInformation> pUserInformationAC(std::make_shared<acseItemUserInformation>(
-                                                                    m_maxPDULength,
+                                                                    MAXIMUM_PDU_SIZE,
                                                                     IMEBRA_IMPLEMENTATION_CLASS_UID,
                                                                     IMEBRA_IMPLEMENTATION_NAME,
                                                                     m_maxOperationsPerformed,
@@ -2811,7 +3156,10 @@ associationSCP::associationSCP(
 
     IMEBRA_LOG_INFO("-- Terminated SCP association negotiation");
 
-    m_readDataSetsThread.reset(new std::thread(&associationBase::getMessagesThread, this));
+    if(m_bReaderThread)
+    {
+        m_readDataSetsThread.reset(new std::thread(&associationBase::getMessagesThread, this));
+    }
 
     IMEBRA_FUNCTION_END_MODIFY(CodecCorruptedFileError, AcseCorruptedMessageError);
 }
@@ -24,6 +24,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include <string>
 #include <memory>
 #include <list>
+#include <map>
 #include <vector>
 #include <set>
 #include <atomic>
@@ -1110,6 +1111,39 @@ public:
 };
 
 
+///
+/// \brief Spool folders of the received payloads, per
+///        abstract syntax.
+///
+//////////////////////////////////////////////////////////////////
+class payloadSpoolFolders
+{
+public:
+    payloadSpoolFolders();
+
+    ///
+    /// \brief Set the spool folder for an abstract syntax.
+    ///
+    /// \param abstractSyntax    the abstract syntax of the
+    ///                          payloads to store on disk
+    /// \param spoolFolder       the folder where the temporary
+    ///                          files are created. An empty string
+    ///                          disables the spooling for the
+    ///                          abstract syntax
+    /// \param maxSizeBufferLoad the tags larger than this size are
+    ///                          not loaded in memory
+    ///
+    //////////////////////////////////////////////////////////////////
+    void setPayloadSpoolFolder(const std::string& abstractSyntax, const std::string& spoolFolder, std::uint32_t maxSizeBufferLoad);
+
+    /// Spool folder and maximum size of the tags loaded in
+    ///  memory, per abstract syntax
+    ///////////////////////////////////////////////////////////
+    typedef std::map<std::string, std::pair<std::string, std::uint32_t> > spoolFolders_t;
+    spoolFolders_t m_spoolFolders;
+};
+
+
 ///
 /// \brief A message sent through an association.
 ///
@@ -1240,6 +1274,63 @@ public:
 
     std::vector<std::string> getPresentationContextTransferSyntaxes(const std::string& abstractSyntax) const;
 
+    ///
+    /// \brief Store the payloads received for an abstract syntax
+    ///        in a temporary file instead of memory.
+    ///
+    /// The payload is parsed from the temporary file after all its
+    ///  fragments have been received, and the tags larger than
+    ///  maxSizeBufferLoad are not loaded in memory: they
+    ///  reference the temporary file, which is memory mapped and
+    ///  removed from the folder.
+    ///
+    /// \param abstractSyntax    the abstract syntax of the
+    ///                          payloads to store on disk
+    /// \param spoolFolder       the folder where the temporary
+    ///                          files are created. An empty string
+    ///                          disables the spooling for the
+    ///                          abstract syntax
+    /// \param maxSizeBufferLoad the tags larger than this size are
+    ///                          not loaded in memory
+    ///
+    //////////////////////////////////////////////////////////////////
+    void setPayloadSpoolFolder(const std::string& abstractSyntax, const std::string& spoolFolder, std::uint32_t maxSizeBufferLoad);
+
+    ///
+    /// \brief Returns true if a complete command has been
+    ///        received and is waiting to be retrieved via
+    ///        getCommand().
+    ///
+    /// Used by the associations that don't have a reading
+    ///  thread (e.g. the ones served by a tcpReactor) to
+    ///  decide whether getCommand() can be called without
+    ///  waiting for new data.
+    ///
+    /// \return true if a command is waiting to be processed
+    ///
+    //////////////////////////////////////////////////////////////////
+    bool isCommandPending();
+
+    ///
+    /// \brief Decodes the next dataset received by the
+    ///        association.
+    ///
+    /// When the association has a reading thread the
+    ///  datasets are decoded until a message is complete
+    ///  and the message is added to the received ones.
+    ///
+    /// When the association doesn't have a reading thread
+    ///  only one dataset (or one PDU other than P-DATA) is
+    ///  decoded: the caller must call this method only when
+    ///  the whole dataset has been received (see
+    ///  pduAssembler), so the call never waits for data.
+    ///
+    /// \return false if the association has been released
+    ///         or aborted
+    ///
+    //////////////////////////////////////////////////////////////////
+    bool readMessage();
+
     void getMessagesThread();
 
 protected:
@@ -1252,7 +1343,8 @@ protected:
             std::uint32_t maxOperationsWeCanPerform,
             std::shared_ptr<streamReader> pReader,
             std::shared_ptr<streamWriter> pWriter,
-            std::uint32_t dimseTimeout);
+            std::uint32_t dimseTimeout,
+            bool bReaderThread);
 
     std::shared_ptr<associationMessage> getMessage(std::uint16_t messageId, bool bResponse);
 
@@ -1285,9 +1377,18 @@ protected:
     std::shared_ptr<streamReader> m_pReader;
     std::shared_ptr<streamWriter> m_pWriter;
 
+    ///
+    /// \brief true if the messages are read by
+    ///        m_readDataSetsThread, false if they are read by
+    ///        the threads that call getMessage().
+    ///
+    ///////////////////////////////////////////////////////////
+    const bool m_bReaderThread;
+
     std::unique_ptr<std::thread> m_readDataSetsThread;
 
 private:
+    friend class pDataStreamInput;
 
     struct receivedDataset
     {
@@ -1297,13 +1398,41 @@ private:
     };
 
     ///
-    /// \brief Decodes several PDUs until a full dataset
-    ///        has been decoded
+    /// \brief Decodes a full dataset, pulling the PDUs from
+    ///        the connection only when the parser needs more
+    ///        data.
     ///
     /// \return a decoded dataSet
     ///
     ///////////////////////////////////////////////////////////
-    std::shared_ptr<receivedDataset> decodePDU(bool bCommand, std::list<std::shared_ptr<acseItemPDataValue> >& pendingData, size_t& m_numberOfLastPData) const;
+    std::shared_ptr<receivedDataset> decodePDU(bool bCommand, std::list<std::shared_ptr<acseItemPDataValue> >& pendingData) const;
+
+    ///
+    /// \brief Decodes the next PDU and appends its P-DATA
+    ///        values to pendingData.
+    ///
+    /// Throws StreamClosedError when the association is
+    ///  released or aborted.
+    ///
+    ///////////////////////////////////////////////////////////
+    void receivePData(std::list<std::shared_ptr<acseItemPDataValue> >& pendingData) const;
+
+    /// Message for which the payload has not been received
+    ///  yet and P-DATA values not consumed yet
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<associationMessage> m_pIncompleteMessage;
+    std::list<std::shared_ptr<acseItemPDataValue> > m_pendingPData;
+
+    /// Locked by the thread that reads the next message when
+    ///  there isn't a reading thread
+    ///////////////////////////////////////////////////////////
+    std::mutex m_lockReadMessage;
+
+    /// Payloads spooling folders and maximum size of the
+    ///  tags loaded in memory, per abstract syntax
+    ///////////////////////////////////////////////////////////
+    payloadSpoolFolders::spoolFolders_t m_spoolFolders;
+    mutable std::mutex m_lockSpoolFolders;
 
     /// Datasets ready to be retrieved by getMessage()
     ///////////////////////////////////////////////////////////
@@ -1337,6 +1466,42 @@ private:
 };
 
 
+///
+/// \brief Input stream that returns the content of the P-DATA
+///        values of a single dataset.
+///
+/// The P-DATA values are consumed as they are read: new PDUs
+///  are decoded from the association only when all the
+///  pending values have been read, so the dataset can be
+///  parsed while it is being received.
+///
+/// The stream reaches the end after the last P-DATA value
+///  of the dataset has been read.
+///
+//////////////////////////////////////////////////////////////////
+class pDataStreamInput: public baseStreamInput
+{
+public:
+    pDataStreamInput(const associationBase& association, std::list<std::shared_ptr<acseItemPDataValue> >& pendingData);
+
+    virtual size_t read(size_t startPosition, std::uint8_t* pBuffer, size_t bufferLength) override;
+
+    virtual void terminate() override;
+
+    ///
+    /// \brief Discard the unread P-DATA values up to the end
+    ///        of the dataset.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void skipToEnd();
+
+protected:
+    const associationBase& m_association;
+    std::list<std::shared_ptr<acseItemPDataValue> >& m_pendingData;
+    bool m_bEndOfDataset;
+};
+
+
 ///
 /// \brief Manages a connection acting as SCU.
 ///
@@ -1422,6 +1587,15 @@ public:
     /// \param artimTimeoutSeconds  maximum time, in seconds, that can
     ///                             pass before an association request
     ///                             arrives
+    /// \param spoolFolders         folders where the received
+    ///                             payloads are spooled, per abstract
+    ///                             syntax (see setPayloadSpoolFolder()).
+    ///                             Can be null
+    /// \param bReaderThread        if true then a secondary thread
+    ///                             reads the incoming messages,
+    ///                             otherwise they are read by the
+    ///                             threads that call getCommand() and
+    ///                             getResponse()
     ///
     //////////////////////////////////////////////////////////////////
     associationSCP(
@@ -1432,7 +1606,9 @@ public:
             std::shared_ptr<streamReader> pReader,
             std::shared_ptr<streamWriter> pWriter,
             std::uint32_t dimseTimeoutSeconds,
-            std::uint32_t artimTimeoutSeconds);
+            std::uint32_t artimTimeoutSeconds,
+            const std::shared_ptr<const payloadSpoolFolders>& spoolFolders,
+            bool bReaderThread);
 
 };
 
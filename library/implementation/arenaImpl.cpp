@@ -0,0 +1,176 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file arenaImpl.cpp
+    \brief Implementation of the arena class.
+
+*/
+
+#include "arenaImpl.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+arena::arena():
+    m_nextBlockSize(IMEBRA_ARENA_FIRST_BLOCK_SIZE),
+    m_pCurrent(nullptr),
+    m_available(0)
+{
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Allocate memory from the current block, or from a new
+//  one when the current block is full
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void* arena::allocate(size_t size, size_t alignment)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Large objects get their own block. The blocks
+    //  allocated by the memory pool are aligned to
+    //  max_align_t
+    ///////////////////////////////////////////////////////////
+    if(size > IMEBRA_ARENA_MAX_BLOCK_SIZE / 4)
+    {
+        m_blocks.emplace_back(new memory(size));
+        return m_blocks.back()->data();
+    }
+
+    size = roundSize(size);
+
+    // Reuse the memory released with the same size, if it
+    //  has the required alignment
+    ///////////////////////////////////////////////////////////
+    const size_t freeListIndex(size / sizeof(void*));
+    if(freeListIndex < m_freeLists.size() && m_freeLists[freeListIndex] != nullptr)
+    {
+        void* pReleased(m_freeLists[freeListIndex]);
+        if((reinterpret_cast<std::uintptr_t>(pReleased) & (alignment - 1)) == 0)
+        {
+            ::memcpy(&(m_freeLists[freeListIndex]), pReleased, sizeof(void*));
+            return pReleased;
+        }
+    }
+
+    size_t padding((alignment - (reinterpret_cast<std::uintptr_t>(m_pCurrent) & (alignment - 1))) & (alignment - 1));
+    if(m_pCurrent == nullptr || padding + size > m_available)
+    {
+        while(m_nextBlockSize < size)
+        {
+            m_nextBlockSize *= 2;
+        }
+        m_blocks.emplace_back(new memory(m_nextBlockSize));
+        m_pCurrent = m_blocks.back()->data();
+        m_available = m_nextBlockSize;
+        padding = 0;
+        if(m_nextBlockSize < IMEBRA_ARENA_MAX_BLOCK_SIZE)
+        {
+            m_nextBlockSize *= 2;
+        }
+    }
+
+    std::uint8_t* pMemory(m_pCurrent + padding);
+    m_pCurrent = pMemory + size;
+    m_available -= padding + size;
+
+    return pMemory;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return the memory to the pool, or store it in the free
+//  list for its size
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void arena::deallocate(void* pMemory, size_t size) noexcept
+{
+    if(pMemory == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // The dedicated blocks go back to the memory pool
+    ///////////////////////////////////////////////////////////
+    if(size > IMEBRA_ARENA_MAX_BLOCK_SIZE / 4)
+    {
+        std::vector<std::unique_ptr<memory> >::iterator findBlock(
+                    std::find_if(m_blocks.begin(), m_blocks.end(), [pMemory](const std::unique_ptr<memory>& pBlock)
+        {
+            return pBlock->data() == pMemory;
+        }));
+        if(findBlock != m_blocks.end())
+        {
+            m_blocks.erase(findBlock);
+        }
+        return;
+    }
+
+    const size_t freeListIndex(roundSize(size) / sizeof(void*));
+    if(freeListIndex >= m_freeLists.size())
+    {
+        // Without a free list the memory is released with
+        //  the arena
+        ///////////////////////////////////////////////////////////
+        try
+        {
+            m_freeLists.resize(freeListIndex + 1, nullptr);
+        }
+        catch(const std::bad_alloc&)
+        {
+            return;
+        }
+    }
+    ::memcpy(pMemory, &(m_freeLists[freeListIndex]), sizeof(void*));
+    m_freeLists[freeListIndex] = pMemory;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Round the size to a multiple of the pointer size, so
+//  each released block can store the pointer to the next
+//  one
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+size_t arena::roundSize(size_t size)
+{
+    return std::max((size + sizeof(void*) - 1) & ~(sizeof(void*) - 1), sizeof(void*));
+}
+
+} // namespace implementation
+
+} // namespace imebra
@@ -0,0 +1,237 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file arenaImpl.h
+    \brief Declaration of the arena class and of the
+           arenaAllocator template.
+
+*/
+
+#if !defined(imebraArena_3B8E51D2_7C4A_4F09_9E26_A1D0C5F8B713__INCLUDED_)
+#define imebraArena_3B8E51D2_7C4A_4F09_9E26_A1D0C5F8B713__INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "memoryImpl.h"
+
+#if(!defined IMEBRA_ARENA_FIRST_BLOCK_SIZE)
+    #define IMEBRA_ARENA_FIRST_BLOCK_SIZE 1024
+#endif
+#if(!defined IMEBRA_ARENA_MAX_BLOCK_SIZE)
+    #define IMEBRA_ARENA_MAX_BLOCK_SIZE 65536
+#endif
+#if(!defined IMEBRA_ARENA_MAX_VALUE_SIZE)
+    #define IMEBRA_ARENA_MAX_VALUE_SIZE 256
+#endif
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief A bump allocator that carves small objects out
+///         of larger memory blocks.
+///
+/// The memory released with deallocate() is kept in a
+///  free list for each size and reused by the next
+///  allocations of the same size, so vectors that grow
+///  and values that are replaced don't accumulate in the
+///  arena. The requests served by a dedicated block are
+///  returned to the memory pool immediately.
+/// The other blocks are released together when the
+///  arena is destroyed.
+///
+/// The blocks are \ref memory objects, so they are
+///  recycled by the \ref memoryPool when the arena is
+///  destroyed and reused by the next arena.
+///
+/// Each dataSet owns an arena used to allocate its
+///  data and buffer objects, which are created once per
+///  tag and live as long as the dataset, and the values
+///  not larger than IMEBRA_ARENA_MAX_VALUE_SIZE bytes
+///  read from a stream. This replaces hundreds of small
+///  heap allocations with a few blocks, allocated with a
+///  growing size.
+///
+/// The arena is kept alive by the arenaAllocator and
+///  arenaDeleter objects that reference it, so objects
+///  allocated from it may outlive the dataSet that
+///  created them. A single surviving object keeps all the
+///  arena's blocks allocated.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class arena
+{
+public:
+    arena();
+
+    /// \brief Allocate a block of memory from the arena.
+    ///
+    /// Requests larger than IMEBRA_ARENA_MAX_BLOCK_SIZE / 4
+    ///  are allocated in a dedicated block.
+    ///
+    /// @param size      the number of bytes to allocate
+    /// @param alignment the required alignment. Must be a
+    ///                   power of 2 not larger than the
+    ///                   alignment of std::max_align_t
+    /// @return a pointer to the allocated memory
+    ///
+    ///////////////////////////////////////////////////////////
+    void* allocate(size_t size, size_t alignment);
+
+    /// \brief Return to the arena a block of memory
+    ///         obtained from allocate().
+    ///
+    /// @param pMemory the memory returned by allocate()
+    /// @param size    the size passed to allocate()
+    ///
+    ///////////////////////////////////////////////////////////
+    void deallocate(void* pMemory, size_t size) noexcept;
+
+private:
+    /// \brief Round a size up to the size of the free list
+    ///         in which it is stored once released.
+    ///
+    /// @param size the requested size
+    /// @return the size actually reserved in the arena
+    ///
+    ///////////////////////////////////////////////////////////
+    static size_t roundSize(size_t size);
+
+    std::vector<std::unique_ptr<memory> > m_blocks;
+
+    // Heads of the lists of released memory, one for each
+    //  rounded size. Each released block stores the pointer
+    //  to the next one
+    ///////////////////////////////////////////////////////////
+    std::vector<void*> m_freeLists;
+
+    size_t m_nextBlockSize;
+
+    std::uint8_t* m_pCurrent;
+    size_t m_available;
+
+    std::mutex m_mutex;
+};
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief A standard allocator that allocates the
+///         memory from an arena.
+///
+/// Use it with std::allocate_shared(): the allocator
+///  stored in the shared pointer's control block keeps
+///  the arena alive until the object is destroyed.
+///
+/// deallocate() returns the memory to the arena, which
+///  reuses it for the next allocations of the same size.
+///
+/// When the allocator is constructed with a null arena
+///  then it allocates the memory from the heap.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+template<typename T>
+class arenaAllocator
+{
+    template<typename U> friend class arenaAllocator;
+
+public:
+    typedef T value_type;
+
+    explicit arenaAllocator(const std::shared_ptr<arena>& pArena): m_pArena(pArena)
+    {
+    }
+
+    template<typename U>
+    arenaAllocator(const arenaAllocator<U>& right): m_pArena(right.m_pArena)
+    {
+    }
+
+    T* allocate(size_t numElements)
+    {
+        if(m_pArena == nullptr)
+        {
+            return static_cast<T*>(::operator new(numElements * sizeof(T)));
+        }
+        return static_cast<T*>(m_pArena->allocate(numElements * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pMemory, size_t numElements)
+    {
+        if(m_pArena == nullptr)
+        {
+            ::operator delete(pMemory);
+            return;
+        }
+        m_pArena->deallocate(pMemory, numElements * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const arenaAllocator<U>& right) const
+    {
+        return m_pArena == right.m_pArena;
+    }
+
+    template<typename U>
+    bool operator!=(const arenaAllocator<U>& right) const
+    {
+        return m_pArena != right.m_pArena;
+    }
+
+private:
+    std::shared_ptr<arena> m_pArena;
+};
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief A deleter for std::shared_ptr that returns to
+///         an arena the memory allocated with
+///         arena::allocate().
+///
+/// The deleter keeps the arena alive until the memory has
+///  been returned.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class arenaDeleter
+{
+public:
+    arenaDeleter(const std::shared_ptr<arena>& pArena, size_t size): m_pArena(pArena), m_size(size)
+    {
+    }
+
+    void operator()(void* pMemory) const
+    {
+        m_pArena->deallocate(pMemory, m_size);
+    }
+
+private:
+    std::shared_ptr<arena> m_pArena;
+    size_t m_size;
+};
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraArena_3B8E51D2_7C4A_4F09_9E26_A1D0C5F8B713__INCLUDED_)
@@ -17,6 +17,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 */
 
 #include "baseStreamImpl.h"
+#include "memoryImpl.h"
 #include <list>
 
 namespace imebra
@@ -34,10 +35,20 @@ bool baseStreamInput::seekable() const
     return false;
 }
 
+std::shared_ptr<const memory> baseStreamInput::getMemoryView(size_t /* startPosition */, size_t /* length */) const
+{
+    return nullptr;
+}
+
 baseStreamOutput::~baseStreamOutput()
 {
 }
 
+bool baseStreamOutput::seekable() const
+{
+    return false;
+}
+
 
 ///////////////////////////////////////////////////////////
 //
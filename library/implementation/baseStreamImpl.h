@@ -36,6 +36,8 @@ namespace imebra
 namespace implementation
 {
 
+class memory;
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 /// \brief This class represents an input stream.
@@ -111,6 +113,25 @@ public:
     ///////////////////////////////////////////////////////////
     virtual bool seekable() const;
 
+    ///
+    /// \brief Return a memory object that references the
+    ///        stream's content directly, without copying it.
+    ///
+    /// The default implementation returns a null pointer:
+    ///  only the streams that keep their whole content
+    ///  addressable (e.g. memory mapped files) can supply
+    ///  a view.
+    ///
+    /// \param startPosition the position of the first byte
+    ///                      referenced by the view
+    /// \param length        the number of bytes referenced
+    ///                      by the view
+    /// \return a memory object referencing the requested
+    ///         region, or a null pointer if the stream
+    ///         cannot supply a view of the region
+    ///
+    ///////////////////////////////////////////////////////////
+    virtual std::shared_ptr<const memory> getMemoryView(size_t startPosition, size_t length) const;
 
 };
 
@@ -147,6 +168,18 @@ public:
     ///////////////////////////////////////////////////////////
     virtual void write(size_t startPosition, const std::uint8_t* pBuffer, size_t bufferLength) = 0;
 
+    ///
+    /// \brief Return true if data already written can be
+    ///        overwritten, false otherwise.
+    ///
+    /// The default behaviour is not-seekable (returns false).
+    ///
+    /// \return true if the writing position can be moved
+    ///         backward, false otherwise
+    ///
+    ///////////////////////////////////////////////////////////
+    virtual bool seekable() const;
+
 };
 
 
@@ -41,11 +41,18 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "dataHandlerDateTimeImpl.h"
 #include "dataHandlerTimeImpl.h"
 #include "dicomDictImpl.h"
+#include "loadedMemoryCacheImpl.h"
 #include "../include/imebra/exceptions.h"
 #include "../include/imebra/definitions.h"
 
-#include <vector>
 #include <string.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+#include <limits>
+#include <type_traits>
 
 
 namespace imebra
@@ -54,6 +61,310 @@ namespace imebra
 namespace implementation
 {
 
+namespace
+{
+
+///////////////////////////////////////////////////////////
+//
+// Result of the direct decoding of an element
+//
+///////////////////////////////////////////////////////////
+enum class elementStatus_t
+{
+    found,      // The element has been decoded
+    missing,    // The element doesn't exist
+    unsupported // The element must be decoded by a data handler
+};
+
+
+///////////////////////////////////////////////////////////
+//
+// Read an element of a numeric buffer, with the same
+//  cast used by readingDataHandlerNumeric
+//
+///////////////////////////////////////////////////////////
+template<typename elementType, typename valueType>
+elementStatus_t getElement(const memory& elements, size_t index, valueType& value)
+{
+    if(index >= elements.size() / sizeof(elementType))
+    {
+        return elementStatus_t::missing;
+    }
+    elementType element;
+    ::memcpy(&element, elements.data() + index * sizeof(elementType), sizeof(elementType));
+    value = (valueType)element;
+    return elementStatus_t::found;
+}
+
+template<typename valueType>
+elementStatus_t getNumericElement(const memory& elements, tagVR_t tagVR, size_t index, valueType& value)
+{
+    switch(tagVR)
+    {
+    case tagVR_t::OB:
+    case tagVR_t::UN:
+        return getElement<std::uint8_t>(elements, index, value);
+    case tagVR_t::SB:
+        return getElement<std::int8_t>(elements, index, value);
+    case tagVR_t::OW:
+    case tagVR_t::US:
+        return getElement<std::uint16_t>(elements, index, value);
+    case tagVR_t::SS:
+        return getElement<std::int16_t>(elements, index, value);
+    case tagVR_t::OL:
+    case tagVR_t::SL:
+        return getElement<std::int32_t>(elements, index, value);
+    case tagVR_t::AT:
+    case tagVR_t::UL:
+        return getElement<std::uint32_t>(elements, index, value);
+    case tagVR_t::OV:
+        return getElement<std::uint64_t>(elements, index, value);
+    case tagVR_t::FL:
+    case tagVR_t::OF:
+        return getElement<float>(elements, index, value);
+    case tagVR_t::FD:
+    case tagVR_t::OD:
+        return getElement<double>(elements, index, value);
+    default:
+        return elementStatus_t::unsupported;
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Locate an element of a string buffer, splitting the
+//  buffer like the readingDataHandlerString constructor
+//  does
+//
+///////////////////////////////////////////////////////////
+elementStatus_t getStringElement(const memory& elements, tagVR_t tagVR, size_t index, const char*& pBegin, const char*& pEnd)
+{
+    char separator('\\');
+    char paddingByte(0x20);
+    switch(tagVR)
+    {
+    case tagVR_t::AE:
+    case tagVR_t::CS:
+    case tagVR_t::DS:
+    case tagVR_t::IS:
+        break;
+    case tagVR_t::UI:
+        separator = 0;
+        paddingByte = 0;
+        break;
+    case tagVR_t::UR:
+        separator = 0;
+        break;
+    default:
+        return elementStatus_t::unsupported;
+    }
+
+    pBegin = reinterpret_cast<const char*>(elements.data());
+    pEnd = pBegin + elements.size();
+    while(pEnd != pBegin && (*(pEnd - 1) == paddingByte || *(pEnd - 1) == 0))
+    {
+        --pEnd;
+    }
+
+    if(separator == 0)
+    {
+        return index == 0 ? elementStatus_t::found : elementStatus_t::missing;
+    }
+
+    for(size_t scanIndex(0); ; ++scanIndex)
+    {
+        const char* pSeparator(std::find(pBegin, pEnd, separator));
+        if(scanIndex == index)
+        {
+            pEnd = pSeparator;
+            return elementStatus_t::found;
+        }
+        if(pSeparator == pEnd)
+        {
+            return elementStatus_t::missing;
+        }
+        pBegin = pSeparator + 1;
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Parse an integer like std::istream does. Returns false
+//  when the text is not a valid number or overflows: in
+//  this case the data handler reports the error
+//
+///////////////////////////////////////////////////////////
+template<typename valueType>
+bool parseInteger(const char* pBegin, const char* pEnd, valueType& value)
+{
+    while(pBegin != pEnd && std::isspace(static_cast<unsigned char>(*pBegin)))
+    {
+        ++pBegin;
+    }
+
+    bool bNegative(false);
+    if(pBegin != pEnd && (*pBegin == '+' || *pBegin == '-'))
+    {
+        bNegative = (*pBegin == '-');
+        ++pBegin;
+    }
+    if(pBegin == pEnd || !std::isdigit(static_cast<unsigned char>(*pBegin)))
+    {
+        return false;
+    }
+
+    std::int64_t parsedValue(0);
+    for(; pBegin != pEnd && std::isdigit(static_cast<unsigned char>(*pBegin)); ++pBegin)
+    {
+        parsedValue = parsedValue * 10 + (*pBegin - '0');
+        if(parsedValue > std::numeric_limits<std::uint32_t>::max())
+        {
+            return false;
+        }
+    }
+    if(bNegative)
+    {
+        parsedValue = -parsedValue;
+    }
+
+    if(parsedValue < static_cast<std::int64_t>(std::numeric_limits<valueType>::min()) ||
+            parsedValue > static_cast<std::int64_t>(std::numeric_limits<valueType>::max()))
+    {
+        return false;
+    }
+    value = static_cast<valueType>(parsedValue);
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Parse a floating point number. Returns false when
+//  the text may be parsed differently by std::istream
+//
+///////////////////////////////////////////////////////////
+bool parseDouble(const char* pBegin, const char* pEnd, double& value)
+{
+    while(pBegin != pEnd && std::isspace(static_cast<unsigned char>(*pBegin)))
+    {
+        ++pBegin;
+    }
+
+    char number[64];
+    size_t length(0);
+    for(; pBegin != pEnd && *pBegin != 0 && ::strchr("0123456789+-.eE", *pBegin) != nullptr; ++pBegin)
+    {
+        if(length == sizeof(number) - 1)
+        {
+            return false;
+        }
+        number[length++] = *pBegin;
+    }
+    number[length] = 0;
+
+    if(length == 0 || *(std::localeconv()->decimal_point) != '.')
+    {
+        return false;
+    }
+
+    char* pParseEnd(nullptr);
+    errno = 0;
+    value = std::strtod(number, &pParseEnd);
+    return pParseEnd == number + length && errno != ERANGE;
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Parse a number with the conversion used by
+//  readingDataHandlerString
+//
+///////////////////////////////////////////////////////////
+bool parseNumber(const char* pBegin, const char* pEnd, std::int32_t& value)
+{
+    return parseInteger(pBegin, pEnd, value);
+}
+
+bool parseNumber(const char* pBegin, const char* pEnd, std::uint32_t& value)
+{
+    return parseInteger(pBegin, pEnd, value);
+}
+
+bool parseNumber(const char* pBegin, const char* pEnd, double& value)
+{
+    return parseDouble(pBegin, pEnd, value);
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Read a number from a string element. DS converts its
+//  elements to integers through a double, IS converts
+//  its elements to double through a signed long
+//
+///////////////////////////////////////////////////////////
+template<typename valueType>
+elementStatus_t getNumberStringElement(const memory& elements, tagVR_t tagVR, size_t index, valueType& value)
+{
+    if(tagVR == tagVR_t::UI || tagVR == tagVR_t::UR)
+    {
+        return elementStatus_t::unsupported;
+    }
+
+    const char* pBegin;
+    const char* pEnd;
+    elementStatus_t status(getStringElement(elements, tagVR, index, pBegin, pEnd));
+    if(status != elementStatus_t::found)
+    {
+        return status;
+    }
+
+    if(tagVR == tagVR_t::DS)
+    {
+        double doubleValue;
+        if(!parseDouble(pBegin, pEnd, doubleValue))
+        {
+            return elementStatus_t::unsupported;
+        }
+        value = (valueType)doubleValue;
+    }
+    else if(tagVR == tagVR_t::IS && std::is_floating_point<valueType>::value)
+    {
+        std::int32_t integerValue;
+        if(!parseInteger(pBegin, pEnd, integerValue))
+        {
+            return elementStatus_t::unsupported;
+        }
+        value = (valueType)integerValue;
+    }
+    else if(!parseNumber(pBegin, pEnd, value))
+    {
+        return elementStatus_t::unsupported;
+    }
+    return elementStatus_t::found;
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Read an element through a data handler
+//
+///////////////////////////////////////////////////////////
+template<typename valueType>
+bool getHandlerElement(const std::shared_ptr<handlers::readingDataHandler>& pHandler, size_t index, valueType (handlers::readingDataHandler::*getValue)(const size_t) const, valueType& value)
+{
+    if(index >= pHandler->getSize())
+    {
+        return false;
+    }
+    value = ((*pHandler).*getValue)(index);
+    return true;
+}
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
@@ -78,6 +389,7 @@ namespace implementation
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 buffer::buffer(const std::shared_ptr<const charsetsList_t>& pCharsets, streamController::tByteOrdering endianType):
+    m_bFrozen(false),
     m_byteOrdering(endianType),
     m_originalBufferPosition(0),
     m_originalBufferLength(0),
@@ -103,6 +415,7 @@ buffer::buffer(
         size_t wordLength,
         streamController::tByteOrdering endianType,
         const std::shared_ptr<const charsetsList_t>& pCharsets):
+        m_bFrozen(false),
         m_byteOrdering(endianType),
         m_originalStream(originalStream),
         m_originalBufferPosition(bufferPosition),
@@ -124,6 +437,14 @@ buffer::buffer(
 ///////////////////////////////////////////////////////////
 buffer::~buffer()
 {
+    // Don't keep the memory loaded on demand in the cache
+    //  after the buffer has been destroyed
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<const memory> loadedMemory(m_loadedMemory.lock());
+    if(loadedMemory != nullptr)
+    {
+        loadedMemoryCache::getLoadedMemoryCache().remove(loadedMemory);
+    }
 }
 
 
@@ -136,20 +457,38 @@ std::shared_ptr<const memory> buffer::getLocalMemory() const
     ///////////////////////////////////////////////////////////
     if(m_originalStream != nullptr)
     {
-        std::shared_ptr<memory> localMemory(std::make_shared<memory>(m_originalBufferLength));
-        if(m_originalBufferLength != 0)
+        // Reuse the memory loaded previously if it is still
+        //  alive
+        ///////////////////////////////////////////////////////////
+        std::shared_ptr<const memory> loadedMemory(m_loadedMemory.lock());
+        if(loadedMemory == nullptr && (m_originalWordLength <= 1u || m_byteOrdering == streamReader::getPlatformEndian()))
         {
-            std::shared_ptr<streamReader> reader(std::make_shared<streamReader>(m_originalStream, m_originalBufferPosition, m_originalBufferLength));
-            std::vector<std::uint8_t> localBuffer;
-            localBuffer.resize(m_originalBufferLength);
-            reader->read(&localBuffer[0], m_originalBufferLength);
-            if(m_originalWordLength != 0)
+            // The stream may expose its content directly
+            //  (memory mapped files): no copy necessary
+            ///////////////////////////////////////////////////////////
+            loadedMemory = m_originalStream->getMemoryView(m_originalBufferPosition, m_originalBufferLength);
+            if(loadedMemory != nullptr)
             {
-                reader->adjustEndian(&localBuffer[0], m_originalWordLength, m_byteOrdering, m_originalBufferLength/m_originalWordLength);
+                return loadedMemory;
             }
-            localMemory->assign(&localBuffer[0], m_originalBufferLength);
         }
-        return localMemory;
+        if(loadedMemory == nullptr)
+        {
+            std::shared_ptr<memory> localMemory(std::make_shared<memory>(m_originalBufferLength));
+            if(m_originalBufferLength != 0)
+            {
+                std::shared_ptr<streamReader> reader(std::make_shared<streamReader>(m_originalStream, m_originalBufferPosition, m_originalBufferLength));
+                reader->read(localMemory->data(), m_originalBufferLength);
+                if(m_originalWordLength != 0)
+                {
+                    reader->adjustEndian(localMemory->data(), m_originalWordLength, m_byteOrdering, m_originalBufferLength/m_originalWordLength);
+                }
+            }
+            loadedMemory = localMemory;
+            m_loadedMemory = loadedMemory;
+        }
+        loadedMemoryCache::getLoadedMemoryCache().touch(loadedMemory);
+        return loadedMemory;
     }
 
     return joinMemory();
@@ -208,7 +547,7 @@ std::shared_ptr<handlers::readingDataHandler> buffer::getReadingDataHandler(tagV
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     std::shared_ptr<const memory> localMemory(getLocalMemory());
 
@@ -262,6 +601,9 @@ std::shared_ptr<handlers::readingDataHandler> buffer::getReadingDataHandler(tagV
     case tagVR_t::OL:
         return std::make_shared<handlers::readingDataHandlerNumeric<std::int32_t> >(localMemory, tagVR);
 
+    case tagVR_t::OV:
+        return std::make_shared<handlers::readingDataHandlerNumeric<std::uint64_t> >(localMemory, tagVR);
+
     case tagVR_t::SB:
         return std::make_shared<handlers::readingDataHandlerNumeric<std::int8_t> >(localMemory, tagVR);
 
@@ -317,6 +659,98 @@ std::shared_ptr<handlers::readingDataHandler> buffer::getReadingDataHandler(tagV
     IMEBRA_FUNCTION_END();
 }
 
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Read an element without creating a data handler
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+template<typename valueType>
+bool buffer::tryGetNumber(tagVR_t tagVR, size_t index, valueType (handlers::readingDataHandler::*getValue)(const size_t) const, valueType& value) const
+{
+    std::shared_ptr<const memory> localMemory;
+    {
+        std::unique_lock<std::mutex> lock(lockForReading());
+        localMemory = getLocalMemory();
+    }
+
+    elementStatus_t status(getNumericElement(*localMemory, tagVR, index, value));
+    if(status == elementStatus_t::unsupported)
+    {
+        status = getNumberStringElement(*localMemory, tagVR, index, value);
+    }
+    if(status == elementStatus_t::unsupported)
+    {
+        return getHandlerElement(getReadingDataHandler(tagVR), index, getValue, value);
+    }
+    return status == elementStatus_t::found;
+}
+
+
+bool buffer::tryGetSignedLong(tagVR_t tagVR, size_t index, std::int32_t& value) const
+{
+    IMEBRA_FUNCTION_START();
+
+    return tryGetNumber(tagVR, index, &handlers::readingDataHandler::getSignedLong, value);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+bool buffer::tryGetUnsignedLong(tagVR_t tagVR, size_t index, std::uint32_t& value) const
+{
+    IMEBRA_FUNCTION_START();
+
+    return tryGetNumber(tagVR, index, &handlers::readingDataHandler::getUnsignedLong, value);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+bool buffer::tryGetDouble(tagVR_t tagVR, size_t index, double& value) const
+{
+    IMEBRA_FUNCTION_START();
+
+    return tryGetNumber(tagVR, index, &handlers::readingDataHandler::getDouble, value);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+bool buffer::tryGetString(tagVR_t tagVR, size_t index, std::string& value) const
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<const memory> localMemory;
+    {
+        std::unique_lock<std::mutex> lock(lockForReading());
+        localMemory = getLocalMemory();
+    }
+
+    const char* pBegin;
+    const char* pEnd;
+    switch(getStringElement(*localMemory, tagVR, index, pBegin, pEnd))
+    {
+    case elementStatus_t::found:
+        value.assign(pBegin, pEnd);
+        if(tagVR == tagVR_t::UI)
+        {
+            value = handlers::normalizeUid(value);
+        }
+        return true;
+    case elementStatus_t::missing:
+        return false;
+    default:
+        return getHandlerElement(getReadingDataHandler(tagVR), index, &handlers::readingDataHandler::getString, value);
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
 std::shared_ptr<handlers::writingDataHandler> buffer::getWritingDataHandler(tagVR_t tagVR, std::uint32_t size)
 {
     IMEBRA_FUNCTION_START();
@@ -377,6 +811,9 @@ std::shared_ptr<handlers::writingDataHandler> buffer::getWritingDataHandler(tagV
     case tagVR_t::OL:
         return std::make_shared<handlers::writingDataHandlerNumeric<std::int32_t> >(shared_from_this(), size, tagVR);
 
+    case tagVR_t::OV:
+        return std::make_shared<handlers::writingDataHandlerNumeric<std::uint64_t> >(shared_from_this(), size, tagVR);
+
     case tagVR_t::SB:
         return std::make_shared<handlers::writingDataHandlerNumeric<std::int8_t> >(shared_from_this(), size, tagVR);
 
@@ -444,7 +881,7 @@ std::shared_ptr<handlers::writingDataHandler> buffer::getWritingDataHandler(tagV
 ///////////////////////////////////////////////////////////
 bool buffer::hasExternalStream() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     return m_originalStream != nullptr;
 }
@@ -463,7 +900,7 @@ std::shared_ptr<streamReader> buffer::getStreamReader()
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     // If the object must be loaded from the original stream,
     //  then return the original stream
@@ -486,6 +923,37 @@ std::shared_ptr<streamReader> buffer::getStreamReader()
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Get the stream containing the buffer's content
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::shared_ptr<baseStreamInput> buffer::getStreamInput(size_t* pStartPosition, size_t* pLength)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::unique_lock<std::mutex> lock(lockForReading());
+
+    if(m_originalStream != nullptr && (m_originalWordLength <= 1u || m_byteOrdering == streamReader::getPlatformEndian()))
+    {
+        *pStartPosition = m_originalBufferPosition;
+        *pLength = m_originalBufferLength;
+        return m_originalStream;
+    }
+
+    std::shared_ptr<const memory> localMemory(getLocalMemory());
+    *pStartPosition = 0;
+    *pLength = localMemory->size();
+    return std::make_shared<memoryStreamInput>(localMemory);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -520,7 +988,7 @@ std::shared_ptr<handlers::readingDataHandlerRaw> buffer::getReadingDataHandlerRa
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     return std::make_shared<handlers::readingDataHandlerRaw>(getLocalMemory(), tagVR);
 
@@ -604,7 +1072,7 @@ size_t buffer::getBufferSizeBytes() const
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     // The buffer has not been loaded yet
     ///////////////////////////////////////////////////////////
@@ -648,10 +1116,38 @@ void buffer::commit(std::shared_ptr<memory> newMemory)
     m_memory.push_back(newMemory);
     m_originalStream.reset();
 
+    std::shared_ptr<const memory> loadedMemory(m_loadedMemory.lock());
+    if(loadedMemory != nullptr)
+    {
+        loadedMemoryCache::getLoadedMemoryCache().remove(loadedMemory);
+        m_loadedMemory.reset();
+    }
+
     IMEBRA_FUNCTION_END();
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+// Make the buffer immutable
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void buffer::freeze()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_bFrozen = (m_originalStream == nullptr);
+}
+
+
+std::unique_lock<std::mutex> buffer::lockForReading() const
+{
+    return m_bFrozen ? std::unique_lock<std::mutex>() : std::unique_lock<std::mutex>(m_mutex);
+}
+
+
 } // namespace implementation
 
 } // namespace imebra
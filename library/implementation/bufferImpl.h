@@ -176,6 +176,65 @@ public:
     std::shared_ptr<handlers::writingDataHandlerNumericBase> getWritingDataHandlerNumeric(tagVR_t tagVR, std::uint32_t size = 0);
     //@}
 
+    ///////////////////////////////////////////////////////////
+    /// \name Direct access to the elements
+    ///
+    ///////////////////////////////////////////////////////////
+    //@{
+
+    /// \brief Read an element as a signed long without
+    ///         creating a data handler.
+    ///
+    /// The numeric elements and the elements of the AE, CS,
+    ///  DS and IS strings are decoded directly from the
+    ///  buffer's memory; the other VRs go through a reading
+    ///  data handler. The returned value is the same that
+    ///  the data handler would return.
+    ///
+    /// Conversion errors throw the same exceptions thrown by
+    ///  the data handlers.
+    ///
+    /// @param tagVR    the tag's VR
+    /// @param index    the element's index
+    /// @param value    set to the element's value
+    /// @return true if the element exists, false otherwise
+    ///
+    ///////////////////////////////////////////////////////////
+    bool tryGetSignedLong(tagVR_t tagVR, size_t index, std::int32_t& value) const;
+
+    /// \brief Read an element as an unsigned long without
+    ///         creating a data handler.
+    ///
+    /// See tryGetSignedLong().
+    ///
+    ///////////////////////////////////////////////////////////
+    bool tryGetUnsignedLong(tagVR_t tagVR, size_t index, std::uint32_t& value) const;
+
+    /// \brief Read an element as a double without creating
+    ///         a data handler.
+    ///
+    /// See tryGetSignedLong().
+    ///
+    ///////////////////////////////////////////////////////////
+    bool tryGetDouble(tagVR_t tagVR, size_t index, double& value) const;
+
+    /// \brief Read an element as a string without creating
+    ///         a data handler.
+    ///
+    /// The elements of the AE, CS, DS, IS, UI and UR strings
+    ///  are copied directly from the buffer's memory; the
+    ///  other VRs go through a reading data handler.
+    ///
+    /// @param tagVR    the tag's VR
+    /// @param index    the element's index
+    /// @param value    set to the element's value
+    /// @return true if the element exists, false otherwise
+    ///
+    ///////////////////////////////////////////////////////////
+    bool tryGetString(tagVR_t tagVR, size_t index, std::string& value) const;
+
+    //@}
+
     /// \brief Add a new block of memory to the current data.
     ///
     /// The appended block of memory should not be modified
@@ -231,6 +290,25 @@ public:
     ///////////////////////////////////////////////////////////
     std::shared_ptr<streamReader> getStreamReader();
 
+    /// \brief Return the stream that contains the buffer's
+    ///         content and the content's position, without
+    ///         copying or loading the content.
+    ///
+    /// If the buffer must be loaded from the original stream
+    ///  then the original stream is returned, otherwise a
+    ///  memory stream connected to the buffer's memory is
+    ///  returned.
+    ///
+    /// @param pStartPosition set to the position of the
+    ///                  buffer's first byte in the returned
+    ///                  stream
+    /// @param pLength   set to the buffer's length
+    /// @return          the stream containing the buffer's
+    ///                  content
+    ///
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<baseStreamInput> getStreamInput(size_t* pStartPosition, size_t* pLength);
+
     /// \brief Return a stream writer connected to the
     ///         buffer's content.
     ///
@@ -247,14 +325,49 @@ public:
 
     void commit(std::shared_ptr<memory> newMemory);
 
+    /// \brief Mark the buffer as immutable.
+    ///
+    /// The reading methods of a frozen buffer don't lock
+    ///  its mutex. The buffers that are loaded lazily from
+    ///  their original stream remain locked, because
+    ///  reading them updates the reference to the loaded
+    ///  memory.
+    ///
+    /// The buffer must not be modified once it has been
+    ///  frozen.
+    ///
+    ///////////////////////////////////////////////////////////
+    void freeze();
+
 protected:
+    /// \brief Lock the buffer's mutex, unless the buffer
+    ///         is frozen.
+    ///
+    /// @return the lock, which doesn't own the mutex when
+    ///          the buffer is frozen
+    ///
+    ///////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lockForReading() const;
+
+    /// \brief Implements tryGetSignedLong(),
+    ///         tryGetUnsignedLong() and tryGetDouble().
+    ///
+    /// @param getValue the data handler's method used when
+    ///                 the element cannot be decoded directly
+    ///
+    ///////////////////////////////////////////////////////////
+    template<typename valueType>
+    bool tryGetNumber(tagVR_t tagVR, size_t index, valueType (handlers::readingDataHandler::*getValue)(const size_t) const, valueType& value) const;
+
 
     /// \brief Returns a memory block containing the buffer
     ///        data.
     ///
     /// If a lazy load is enabled and the data is available on
-    /// a stream then load the data into a temporary block of
-    /// memory and return it.
+    /// a stream then load the data into a block of memory
+    /// and return it. The loaded block is reused while it is
+    /// still referenced by a handler or by the
+    /// loadedMemoryCache.
     ///
     /// @return a block of memory containing the buffer's data
     ///
@@ -281,6 +394,11 @@ private:
 
     mutable std::mutex m_mutex;
 
+    // True when the reading methods don't need the lock
+    //  (see freeze())
+    ///////////////////////////////////////////////////////////
+    bool m_bFrozen;
+
     streamController::tByteOrdering m_byteOrdering; // < Byte ordering in the stream or memory
 
 protected:
@@ -292,6 +410,10 @@ protected:
     size_t m_originalBufferLength;   // < Original buffer's length
     size_t m_originalWordLength;     // < Original word's length (for low/high endian adjustment)
 
+    // Memory loaded from the original stream
+    ///////////////////////////////////////////////////////////
+    mutable std::weak_ptr<const memory> m_loadedMemory;
+
 private:
     // Charset list
     ///////////////////////////////////////////////////////////
@@ -28,6 +28,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "jpegImageCodecImpl.h"
 #include "dicomNativeImageCodecImpl.h"
 #include "dicomRLEImageCodecImpl.h"
+#include "jpegLsImageCodecImpl.h"
 
 #ifdef JPEG2000
 #include "jpeg2000ImageCodecImpl.h"
@@ -66,7 +67,8 @@ static codecFactory::forceCodecFactoryCreation forceCreation;
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-codecFactory::codecFactory(): m_maximumImageWidth(MAXIMUM_IMAGE_WIDTH), m_maximumImageHeight(MAXIMUM_IMAGE_HEIGHT)
+codecFactory::codecFactory(): m_maximumImageWidth(MAXIMUM_IMAGE_WIDTH), m_maximumImageHeight(MAXIMUM_IMAGE_HEIGHT),
+    m_jpegDecodingThreads(1), m_jpegRestartRows(0), m_bJpegStandardHuffmanTables(false), m_rleEncodingThreads(1)
 {
     IMEBRA_FUNCTION_START();
 
@@ -76,6 +78,7 @@ codecFactory::codecFactory(): m_maximumImageWidth(MAXIMUM_IMAGE_WIDTH), m_maximu
     registerImageCodec(std::make_shared<jpegImageCodec>());
     registerImageCodec(std::make_shared<dicomNativeImageCodec>());
     registerImageCodec(std::make_shared<dicomRLEImageCodec>());
+    registerImageCodec(std::make_shared<jpegLsImageCodec>());
 
 #ifdef JPEG2000
     registerImageCodec(std::make_shared<jpeg2000ImageCodec>());
@@ -192,7 +195,7 @@ std::shared_ptr<codecFactory> codecFactory::getCodecFactory()
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-std::shared_ptr<dataSet> codecFactory::load(std::shared_ptr<streamReader> pStream, std::uint32_t maxSizeBufferLoad /* = 0xffffffff */)
+std::shared_ptr<dataSet> codecFactory::load(std::shared_ptr<streamReader> pStream, std::uint32_t maxSizeBufferLoad /* = 0xffffffff */, std::uint32_t stopTag /* = 0xffffffff */)
 {
     IMEBRA_FUNCTION_START();
 
@@ -235,7 +238,7 @@ std::shared_ptr<dataSet> codecFactory::load(std::shared_ptr<streamReader> pStrea
 
         try
         {
-            std::shared_ptr<dataSet> pDataSet(scanCodecs->second->read(pTempReader, maxSizeBufferLoad));
+            std::shared_ptr<dataSet> pDataSet(scanCodecs->second->read(pTempReader, maxSizeBufferLoad, stopTag));
             return pDataSet;
         }
         catch(CodecWrongFormatError&)
@@ -268,6 +271,54 @@ std::uint32_t codecFactory::getMaximumImageHeight()
     return m_maximumImageHeight;
 }
 
+
+void codecFactory::setJpegDecodingThreads(std::uint32_t threadsCount)
+{
+    m_jpegDecodingThreads = threadsCount;
+}
+
+
+std::uint32_t codecFactory::getJpegDecodingThreads()
+{
+    return m_jpegDecodingThreads;
+}
+
+
+void codecFactory::setJpegRestartRows(std::uint32_t mcuRows)
+{
+    m_jpegRestartRows = mcuRows;
+}
+
+
+std::uint32_t codecFactory::getJpegRestartRows()
+{
+    return m_jpegRestartRows;
+}
+
+
+void codecFactory::setJpegStandardHuffmanTables(bool bStandardTables)
+{
+    m_bJpegStandardHuffmanTables = bStandardTables;
+}
+
+
+bool codecFactory::getJpegStandardHuffmanTables()
+{
+    return m_bJpegStandardHuffmanTables;
+}
+
+
+void codecFactory::setRLEEncodingThreads(std::uint32_t threadsCount)
+{
+    m_rleEncodingThreads = threadsCount;
+}
+
+
+std::uint32_t codecFactory::getRLEEncodingThreads()
+{
+    return m_rleEncodingThreads;
+}
+
 } // namespace codecs
 
 } // namespace implementation
@@ -147,11 +147,17 @@ public:
 	///                 ignore this parameter.
 	///                Set to 0xffffffff to load all the 
 	///                 buffers immediatly
+	/// @param stopTag the parsing stops before the first tag
+	///                 of the root dataset with an id equal
+	///                 or greater than this one, expressed
+	///                 as (groupId << 16) | tagId.
+	///                Set to 0xffffffff to parse the whole
+	///                 stream
 	/// @return a pointer to the dataSet containing the parsed
 	///          data
 	///
 	///////////////////////////////////////////////////////////
-	std::shared_ptr<dataSet> load(std::shared_ptr<streamReader> pStream, std::uint32_t maxSizeBufferLoad = 0xffffffff);
+	std::shared_ptr<dataSet> load(std::shared_ptr<streamReader> pStream, std::uint32_t maxSizeBufferLoad = 0xffffffff, std::uint32_t stopTag = 0xffffffff);
 
     /// \brief Set the maximum size of the images created by
     ///         the codec::getImage() function.
@@ -184,6 +190,87 @@ public:
     ///////////////////////////////////////////////////////////
     std::uint32_t getMaximumImageHeight();
 
+    /// \brief Set the number of threads used to decode the
+    ///         restart intervals of a jpeg image.
+    ///
+    /// @param threadsCount the maximum number of threads. 0
+    ///                      means one thread per CPU core,
+    ///                      1 decodes the image on the
+    ///                      calling thread only
+    ///
+    ///////////////////////////////////////////////////////////
+    void setJpegDecodingThreads(std::uint32_t threadsCount);
+
+    /// \brief Get the number of threads used to decode the
+    ///         restart intervals of a jpeg image.
+    ///
+    /// @return the number of threads, or 0 for one thread
+    ///          per CPU core
+    ///
+    ///////////////////////////////////////////////////////////
+    std::uint32_t getJpegDecodingThreads();
+
+    /// \brief Set the number of MCU rows in each restart
+    ///         interval written by the jpeg encoder.
+    ///
+    /// @param mcuRows the number of MCU rows in each restart
+    ///                 interval. 0 disables the restart
+    ///                 intervals
+    ///
+    ///////////////////////////////////////////////////////////
+    void setJpegRestartRows(std::uint32_t mcuRows);
+
+    /// \brief Get the number of MCU rows in each restart
+    ///         interval written by the jpeg encoder.
+    ///
+    /// @return the number of MCU rows in each restart
+    ///          interval, or 0 if the restart intervals are
+    ///          disabled
+    ///
+    ///////////////////////////////////////////////////////////
+    std::uint32_t getJpegRestartRows();
+
+    /// \brief Enable or disable the typical huffman tables
+    ///         (Annex K) in the jpeg encoder.
+    ///
+    /// @param bStandardTables true if the jpeg encoder must
+    ///                         use the typical huffman tables,
+    ///                         false if it must calculate the
+    ///                         optimal tables for each image
+    ///
+    ///////////////////////////////////////////////////////////
+    void setJpegStandardHuffmanTables(bool bStandardTables);
+
+    /// \brief Return true if the jpeg encoder uses the
+    ///         typical huffman tables (Annex K).
+    ///
+    /// @return true if the jpeg encoder uses the typical
+    ///          huffman tables, false if it calculates the
+    ///          optimal tables for each image
+    ///
+    ///////////////////////////////////////////////////////////
+    bool getJpegStandardHuffmanTables();
+
+    /// \brief Set the number of threads used to compress
+    ///         the segments of an RLE image.
+    ///
+    /// @param threadsCount the maximum number of threads. 0
+    ///                      means one thread per CPU core,
+    ///                      1 compresses the image on the
+    ///                      calling thread only
+    ///
+    ///////////////////////////////////////////////////////////
+    void setRLEEncodingThreads(std::uint32_t threadsCount);
+
+    /// \brief Get the number of threads used to compress
+    ///         the segments of an RLE image.
+    ///
+    /// @return the number of threads, or 0 for one thread
+    ///          per CPU core
+    ///
+    ///////////////////////////////////////////////////////////
+    std::uint32_t getRLEEncodingThreads();
+
 protected:
 	// The list of the registered codecs
 	///////////////////////////////////////////////////////////
@@ -196,6 +283,19 @@ protected:
     std::uint32_t m_maximumImageWidth;
     std::uint32_t m_maximumImageHeight;
 
+    // Jpeg restart intervals
+    ///////////////////////////////////////////////////////////
+    std::uint32_t m_jpegDecodingThreads;
+    std::uint32_t m_jpegRestartRows;
+
+    // Jpeg huffman tables
+    ///////////////////////////////////////////////////////////
+    bool m_bJpegStandardHuffmanTables;
+
+    // RLE segments compression
+    ///////////////////////////////////////////////////////////
+    std::uint32_t m_rleEncodingThreads;
+
 
 public:
 	// Force the creation of the codec factory before main()
@@ -60,7 +60,12 @@ namespace implementation
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 data::data(tagVR_t tagVR, const std::shared_ptr<charsetsList_t> pCharsets):
-    m_pCharsetsList(pCharsets), m_tagVR(tagVR)
+    m_pCharsetsList(pCharsets), m_tagVR(tagVR), m_buffers(arenaAllocator<std::shared_ptr<buffer> >(nullptr)), m_bFrozen(false)
+{
+}
+
+data::data(tagVR_t tagVR, const std::shared_ptr<charsetsList_t> pCharsets, const std::shared_ptr<arena>& pArena):
+    m_pCharsetsList(pCharsets), m_pArena(pArena), m_tagVR(tagVR), m_buffers(arenaAllocator<std::shared_ptr<buffer> >(pArena)), m_bFrozen(false)
 {
 }
 
@@ -135,7 +140,7 @@ size_t data::getBuffersCount() const
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     // Returns the number of buffers
     ///////////////////////////////////////////////////////////
@@ -156,7 +161,7 @@ size_t data::getBuffersCount() const
 ///////////////////////////////////////////////////////////
 bool data::bufferExists(size_t bufferId) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     return bufferId < m_buffers.size() && m_buffers.at(bufferId) != nullptr;
 }
@@ -185,7 +190,7 @@ std::shared_ptr<buffer> data::getBuffer(size_t bufferId) const
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     // Retrieve the buffer
     ///////////////////////////////////////////////////////////
@@ -200,6 +205,34 @@ std::shared_ptr<buffer> data::getBuffer(size_t bufferId) const
 }
 
 
+std::shared_ptr<buffer> data::findBuffer(size_t bufferId) const
+{
+    std::unique_lock<std::mutex> lock(lockForReading());
+
+    return bufferId < m_buffers.size() ? m_buffers[bufferId] : nullptr;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Allocate a new buffer
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+template<typename... Args>
+std::shared_ptr<buffer> data::createBuffer(Args&&... args) const
+{
+    if(m_pArena == nullptr)
+    {
+        return std::make_shared<buffer>(std::forward<Args>(args)...);
+    }
+    return std::allocate_shared<buffer>(arenaAllocator<buffer>(m_pArena), std::forward<Args>(args)...);
+}
+
+
 std::shared_ptr<buffer> data::getBufferCreate(size_t bufferId)
 {
     IMEBRA_FUNCTION_START();
@@ -213,7 +246,7 @@ std::shared_ptr<buffer> data::getBufferCreate(size_t bufferId)
         return m_buffers.at(bufferId);
     }
 
-    std::shared_ptr<buffer> pNewBuffer(std::make_shared<buffer>(m_pCharsetsList));
+    std::shared_ptr<buffer> pNewBuffer(createBuffer(m_pCharsetsList));
     if(bufferId >= m_buffers.size())
     {
         m_buffers.resize(bufferId + 1);
@@ -239,7 +272,7 @@ std::shared_ptr<buffer> data::getBufferCreate(size_t bufferId, streamController:
         return m_buffers.at(bufferId);
     }
 
-    std::shared_ptr<buffer> pNewBuffer(std::make_shared<buffer>(m_pCharsetsList, endianType));
+    std::shared_ptr<buffer> pNewBuffer(createBuffer(m_pCharsetsList, endianType));
     if(bufferId >= m_buffers.size())
     {
         m_buffers.resize(bufferId + 1);
@@ -263,12 +296,12 @@ std::shared_ptr<buffer> data::getBufferCreate(size_t bufferId,
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    std::shared_ptr<buffer> pNewBuffer(std::make_shared<buffer>(originalStream,
-                                                                bufferPosition,
-                                                                bufferLength,
-                                                                wordLength,
-                                                                endianType,
-                                                                m_pCharsetsList));
+    std::shared_ptr<buffer> pNewBuffer(createBuffer(originalStream,
+                                                    bufferPosition,
+                                                    bufferLength,
+                                                    wordLength,
+                                                    endianType,
+                                                    m_pCharsetsList));
     if(bufferId >= m_buffers.size())
     {
         m_buffers.resize(bufferId + 1);
@@ -413,6 +446,9 @@ std::uint8_t data::getPaddingByte() const
     case tagVR_t::OL:
         return 0x0;
 
+    case tagVR_t::OV:
+        return 0x0;
+
     case tagVR_t::SB:
         return 0x0;
 
@@ -558,7 +594,7 @@ std::shared_ptr<dataSet> data::getSequenceItem(size_t dataSetId) const
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     if(m_embeddedDataSets.size() <= dataSetId)
     {
@@ -574,7 +610,7 @@ bool data::dataSetExists(size_t dataSetId) const
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(lockForReading());
 
     return m_embeddedDataSets.size() > dataSetId;
 
@@ -606,6 +642,46 @@ std::shared_ptr<dataSet> data::appendSequenceItem()
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Make the tag immutable
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void data::freeze()
+{
+    IMEBRA_FUNCTION_START();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(const std::shared_ptr<buffer>& pBuffer: m_buffers)
+    {
+        if(pBuffer != nullptr)
+        {
+            pBuffer->freeze();
+        }
+    }
+
+    for(const ptrDataSet& pDataSet: m_embeddedDataSets)
+    {
+        pDataSet->freeze();
+    }
+
+    m_bFrozen = true;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+std::unique_lock<std::mutex> data::lockForReading() const
+{
+    return m_bFrozen ? std::unique_lock<std::mutex>() : std::unique_lock<std::mutex>(m_mutex);
+}
+
+
 } // namespace implementation
 
 } // namespace imebra
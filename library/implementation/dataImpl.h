@@ -23,6 +23,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 
 #include "dataHandlerNumericImpl.h"
 #include "streamControllerImpl.h"
+#include "arenaImpl.h"
 #include "../include/imebra/definitions.h"
 
 #include <map>
@@ -72,6 +73,18 @@ public:
 
     data(tagVR_t tagVR, const std::shared_ptr<charsetsList_t> pCharsets);
 
+    /// \brief Constructor used by the dataSet: the buffers
+    ///         created by the tag are allocated from the
+    ///         dataset's arena.
+    ///
+    /// @param tagVR     the tag's VR
+    /// @param pCharsets the charsets used by the tag
+    /// @param pArena    the arena from which the buffers are
+    ///                   allocated
+    ///
+    ///////////////////////////////////////////////////////////
+    data(tagVR_t tagVR, const std::shared_ptr<charsetsList_t> pCharsets, const std::shared_ptr<arena>& pArena);
+
     virtual ~data();
 
     ///////////////////////////////////////////////////////////
@@ -118,6 +131,19 @@ public:
 
     std::shared_ptr<buffer> getBuffer(size_t bufferId) const;
 
+    /// \brief Returns the specified buffer, or nullptr if the
+    ///         buffer doesn't exist.
+    ///
+    /// Same as getBuffer(), but doesn't throw when the
+    ///  buffer is missing.
+    ///
+    /// @param bufferId the zero-based buffer's id
+    /// @return the buffer, or nullptr if the buffer doesn't
+    ///          exist
+    ///
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<buffer> findBuffer(size_t bufferId) const;
+
     std::shared_ptr<buffer> getBufferCreate(size_t bufferId);
 
     std::shared_ptr<buffer> getBufferCreate(size_t bufferId, streamController::tByteOrdering endianType);
@@ -340,15 +366,44 @@ public:
     ///////////////////////////////////////////////////////////
     void setBuffer(size_t bufferId, const std::shared_ptr<buffer>& newBuffer);
 
+    /// \brief Mark the tag, its buffers and its sequence
+    ///         items as immutable.
+    ///
+    /// The reading methods of a frozen tag don't lock its
+    ///  mutex. The tag must not be modified once it has
+    ///  been frozen.
+    ///
+    ///////////////////////////////////////////////////////////
+    void freeze();
+
 protected:
+    /// \brief Lock the tag's mutex, unless the tag is
+    ///         frozen.
+    ///
+    /// @return the lock, which doesn't own the mutex when
+    ///          the tag is frozen
+    ///
+    ///////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lockForReading() const;
+
+    /// \brief Allocate a new buffer, from the arena if the
+    ///         tag has one.
+    ///
+    ///////////////////////////////////////////////////////////
+    template<typename... Args>
+    std::shared_ptr<buffer> createBuffer(Args&&... args) const;
 
     const std::shared_ptr<charsetsList_t> m_pCharsetsList;
 
+    // Arena used to allocate the buffers (may be null)
+    ///////////////////////////////////////////////////////////
+    const std::shared_ptr<arena> m_pArena;
+
     const tagVR_t m_tagVR;
 
     // Pointers to the internal buffers
     ///////////////////////////////////////////////////////////
-    typedef std::vector<std::shared_ptr<buffer>> tBuffersVector;
+    typedef std::vector<std::shared_ptr<buffer>, arenaAllocator<std::shared_ptr<buffer> > > tBuffersVector;
     tBuffersVector m_buffers;
 
     // Pointers to the embedded datasets
@@ -358,6 +413,11 @@ protected:
     tEmbeddedDatasetsVector m_embeddedDataSets;
 
     mutable std::mutex m_mutex;
+
+    // True when the reading methods don't need the lock
+    //  (see freeze())
+    ///////////////////////////////////////////////////////////
+    bool m_bFrozen;
 };
 
 /// @}
@@ -20,6 +20,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "streamReaderImpl.h"
 #include "streamWriterImpl.h"
 #include "memoryStreamImpl.h"
+#include "fragmentsStreamImpl.h"
 #include "dataSetImpl.h"
 #include "dataHandlerNumericImpl.h"
 #include "dicomDictImpl.h"
@@ -39,9 +40,11 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "overlayImpl.h"
 #include "dicomNativeImageCodecImpl.h"
 #include "codecFactoryImpl.h"
+#include "parallelTasksImpl.h"
 #include <iostream>
 #include <string.h>
 #include <limits>
+#include <algorithm>
 
 
 namespace imebra
@@ -64,18 +67,18 @@ namespace implementation
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 
-dataSet::dataSet(const std::shared_ptr<charsetsList_t>& pCharsetsList): m_itemOffset(0), m_pCharsetsList(pCharsetsList)
+dataSet::dataSet(const std::shared_ptr<charsetsList_t>& pCharsetsList): m_itemOffset(0), m_pArena(std::make_shared<arena>()), m_pCharsetsList(pCharsetsList), m_bFrozen(false)
 {
 }
 
 dataSet::dataSet(const std::string& transferSyntax, const std::shared_ptr<charsetsList_t>& pCharsetsList):
-    m_itemOffset(0), m_pCharsetsList(pCharsetsList)
+    m_itemOffset(0), m_pArena(std::make_shared<arena>()), m_pCharsetsList(pCharsetsList), m_bFrozen(false)
 {
     setString(0x0002, 0x0, 0x0010, 0, transferSyntax);
 }
 
 dataSet::dataSet(const std::string& transferSyntax, const charsetsList_t& charsetsList):
-    m_itemOffset(0), m_pCharsetsList(std::make_shared<charsetsList_t>(charsetsList))
+    m_itemOffset(0), m_pArena(std::make_shared<arena>()), m_pCharsetsList(std::make_shared<charsetsList_t>(charsetsList)), m_bFrozen(false)
 {
     setString(0x0002, 0x0, 0x0010, 0, transferSyntax);
 
@@ -104,26 +107,38 @@ std::shared_ptr<data> dataSet::getTag(std::uint16_t groupId, std::uint32_t order
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
 
-    tGroups::const_iterator findGroup(m_groups.find(groupId));
-    if(findGroup == m_groups.end())
+    const std::uint64_t key(getTagKey(groupId, order, tagId));
+    tTagRecords::const_iterator findTag(findTagRecord(key));
+    if(findTag == m_tags.end() || findTag->m_key != key)
     {
-        IMEBRA_THROW(MissingGroupError, "The requested group is missing");
+        if(getGroupsNumber(groupId) <= order)
+        {
+            IMEBRA_THROW(MissingGroupError, "The requested group is missing");
+        }
+        IMEBRA_THROW(MissingTagError, "The requested tag is missing");
     }
+    return findTag->m_pData;
 
-    if(findGroup->second.size() <= order)
-    {
-        IMEBRA_THROW(MissingGroupError, "The requested group is missing");
-    }
+    IMEBRA_FUNCTION_END();
+}
 
-    const tTags& tagsMap = findGroup->second.at(order);
-    tTags::const_iterator findTag(tagsMap.find(tagId));
-    if(findTag == tagsMap.end())
+
+std::shared_ptr<buffer> dataSet::findBuffer(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, tagVR_t& tagVR) const
+{
+    IMEBRA_FUNCTION_START();
+
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
+
+    const std::uint64_t key(getTagKey(groupId, order, tagId));
+    tTagRecords::const_iterator findTag(findTagRecord(key));
+    if(findTag == m_tags.end() || findTag->m_key != key)
     {
-        IMEBRA_THROW(MissingTagError, "The requested tag is missing");
+        return nullptr;
     }
-    return findTag->second;
+    tagVR = findTag->m_pData->getDataType();
+    return findTag->m_pData->findBuffer(bufferId);
 
     IMEBRA_FUNCTION_END();
 }
@@ -135,17 +150,25 @@ std::shared_ptr<data> dataSet::getTagCreate(std::uint16_t groupId, std::uint32_t
 
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-    if(m_groups[groupId].size() <= order)
-    {
-        m_groups[groupId].resize(order + 1);
-    }
+    const std::uint64_t key(getTagKey(groupId, order, tagId));
 
-    if(m_groups[groupId][order][tagId] == nullptr)
+    // While a stream is parsed the tags arrive in ascending
+    //  order: try to append the tag before searching for it
+    ///////////////////////////////////////////////////////////
+    tTagRecords::const_iterator insertPosition(m_tags.end());
+    if(!m_tags.empty() && m_tags.back().m_key >= key)
     {
-        m_groups[groupId][order][tagId] = std::make_shared<data>(tagVR, m_pCharsetsList);
+        insertPosition = findTagRecord(key);
+        if(insertPosition->m_key == key)
+        {
+            return insertPosition->m_pData;
+        }
     }
 
-    return m_groups[groupId][order][tagId];
+    tagRecord newTag;
+    newTag.m_key = key;
+    newTag.m_pData = std::allocate_shared<data>(arenaAllocator<data>(m_pArena), tagVR, m_pCharsetsList, m_pArena);
+    return m_tags.insert(m_tags.begin() + (insertPosition - m_tags.cbegin()), newTag)->m_pData;
 
     IMEBRA_FUNCTION_END();
 }
@@ -189,7 +212,106 @@ std::shared_ptr<image> dataSet::getImage(std::uint32_t frameNumber) const
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    frameInformation information;
+    {
+        std::unique_lock<std::recursive_mutex> lock(lockForReading());
+        information = getFrameInformation(frameNumber);
+    }
+
+    // The dataset is not locked while the frame is decoded
+    ///////////////////////////////////////////////////////////
+    return decodeFrame(information);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Retrieve a region of an image from the structure
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::shared_ptr<image> dataSet::getImage(std::uint32_t frameNumber, std::uint32_t left, std::uint32_t top, std::uint32_t width, std::uint32_t height) const
+{
+    IMEBRA_FUNCTION_START();
+
+    frameInformation information;
+    {
+        std::unique_lock<std::recursive_mutex> lock(lockForReading());
+        information = getFrameInformation(frameNumber);
+    }
+
+    if(width == 0 || height == 0 ||
+            left >= information.m_imageWidth || width > information.m_imageWidth - left ||
+            top >= information.m_imageHeight || height > information.m_imageHeight - top)
+    {
+        IMEBRA_THROW(ImageInvalidSizeError, "The region is empty or is not inside the image");
+    }
+
+    // The dataset is not locked while the frame is decoded
+    ///////////////////////////////////////////////////////////
+    return decodeFrame(information, left, top, width, height);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Retrieve several frames, decoding them in parallel
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::vector<std::shared_ptr<image> > dataSet::getImages(std::uint32_t firstFrame, std::uint32_t framesCount, size_t threadsCount) const
+{
+    IMEBRA_FUNCTION_START();
+
+    // Locate all the frames while holding the lock
+    ///////////////////////////////////////////////////////////
+    std::vector<frameInformation> frames;
+    frames.reserve(framesCount);
+    {
+        std::unique_lock<std::recursive_mutex> lock(lockForReading());
+        for(std::uint32_t scanFrames(0); scanFrames != framesCount; ++scanFrames)
+        {
+            frames.push_back(getFrameInformation(firstFrame + scanFrames));
+        }
+    }
+
+    // Decode the frames without holding the lock
+    ///////////////////////////////////////////////////////////
+    std::vector<std::shared_ptr<image> > images(framesCount);
+    runParallelTasks(frames.size(), threadsCount, [&frames, &images](size_t frame)
+    {
+        images[frame] = decodeFrame(frames[frame]);
+    });
+
+    return images;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Locate a frame and collect the information needed to
+//  decode it
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+dataSet::frameInformation dataSet::getFrameInformation(std::uint32_t frameNumber) const
+{
+    IMEBRA_FUNCTION_START();
 
     // Retrieve the transfer syntax
     ///////////////////////////////////////////////////////////
@@ -266,7 +388,7 @@ std::shared_ptr<image> dataSet::getImage(std::uint32_t frameNumber) const
             {
                 std::uint32_t firstBufferId(0), endBufferId(0);
                 size_t totalLength(0);
-                if(imageTag->getBufferSize(0) == 0 && numberOfFrames + 1 == imageTag->getBuffersCount())
+                if(imageTag->getBufferSize(0) == 0 && numberOfFrames + 1 == imageTag->getBuffersCount() && !hasExtendedOffsetTable())
                 {
                     firstBufferId = frameNumber + 1;
                     endBufferId = firstBufferId + 1;
@@ -276,23 +398,23 @@ std::shared_ptr<image> dataSet::getImage(std::uint32_t frameNumber) const
                 {
                     totalLength = getFrameBufferIds(frameNumber, &firstBufferId, &endBufferId);
                 }
-                if(firstBufferId == endBufferId - 1)
+                if(firstBufferId == endBufferId - 1 && totalLength == imageTag->getBufferSize(firstBufferId))
                 {
                     imageStream = imageTag->getStreamReader(firstBufferId);
                 }
                 else
                 {
-                    std::shared_ptr<memory> temporaryMemory(std::make_shared<memory>(totalLength));
-                    std::uint8_t* pDest = temporaryMemory->data();
+                    // Read the fragments directly from their
+                    //  streams, without concatenating them
+                    ///////////////////////////////////////////////////////////
+                    std::shared_ptr<fragmentsStreamInput> compositeStream(std::make_shared<fragmentsStreamInput>());
                     for(std::uint32_t scanBuffers = firstBufferId; scanBuffers != endBufferId; ++scanBuffers)
                     {
-                        std::shared_ptr<handlers::readingDataHandlerRaw> bufferHandler = imageTag->getReadingDataHandlerRaw(scanBuffers);
-                        const std::uint8_t* pSource = bufferHandler->getMemoryBuffer();
-                        ::memcpy(pDest, pSource, bufferHandler->getSize());
-                        pDest += bufferHandler->getSize();
+                        size_t fragmentPosition(0), fragmentLength(0);
+                        std::shared_ptr<baseStreamInput> fragmentStream(imageTag->getBuffer(scanBuffers)->getStreamInput(&fragmentPosition, &fragmentLength));
+                        compositeStream->addFragment(fragmentStream, fragmentPosition, fragmentLength);
                     }
-                    std::shared_ptr<baseStreamInput> compositeStream(std::make_shared<memoryStreamInput>(temporaryMemory));
-                    imageStream = std::make_shared<streamReader>(compositeStream);
+                    imageStream = std::make_shared<streamReader>(compositeStream, 0, totalLength);
                 }
             }
         }
@@ -349,31 +471,32 @@ std::shared_ptr<image> dataSet::getImage(std::uint32_t frameNumber) const
             imageStream = getStreamReader(0x7fe0, static_cast<std::uint16_t>(frameNumber), 0x0010, 0x0);
         }
 
-        std::shared_ptr<image> pImage;
-        pImage = pCodec->getImage(transferSyntax,
-                                  colorSpace,
-                                  channelsNumber,
-                                  imageWidth,
-                                  imageHeight,
-                                  bSubSampledX,
-                                  bSubSampledY,
-                                  bInterleaved,
-                                  b2Complement,
-                                  allocatedBits,
-                                  storedBits,
-                                  highBit,
-                                  imageStream);
-
-        if(pImage->getColorSpace() == "PALETTE COLOR")
+        frameInformation information;
+        information.m_pCodec = pCodec;
+        information.m_transferSyntax = transferSyntax;
+        information.m_colorSpace = colorSpace;
+        information.m_channelsNumber = channelsNumber;
+        information.m_imageWidth = imageWidth;
+        information.m_imageHeight = imageHeight;
+        information.m_bSubSampledX = bSubSampledX;
+        information.m_bSubSampledY = bSubSampledY;
+        information.m_bInterleaved = bInterleaved;
+        information.m_b2Complement = b2Complement;
+        information.m_allocatedBits = allocatedBits;
+        information.m_storedBits = storedBits;
+        information.m_highBit = highBit;
+        information.m_pImageStream = imageStream;
+
+        if(colorSpace == "PALETTE COLOR")
         {
-            std::shared_ptr<lut> red(std::make_shared<lut>(getReadingDataHandlerNumeric(0x0028, 0x0, 0x1101, 0), getReadingDataHandlerNumeric(0x0028, 0x0, 0x1201, 0), L"", pImage->isSigned()));
-            std::shared_ptr<lut> green(std::make_shared<lut>(getReadingDataHandlerNumeric(0x0028, 0x0, 0x1102, 0), getReadingDataHandlerNumeric(0x0028, 0x0, 0x1202, 0), L"", pImage->isSigned()));
-            std::shared_ptr<lut> blue(std::make_shared<lut>(getReadingDataHandlerNumeric(0x0028, 0x0, 0x1103, 0), getReadingDataHandlerNumeric(0x0028, 0x0, 0x1203, 0), L"", pImage->isSigned()));
-            std::shared_ptr<palette> imagePalette(std::make_shared<palette>(red, green, blue));
-            pImage->setPalette(imagePalette);
+            for(std::uint16_t scanChannels(0); scanChannels != 3; ++scanChannels)
+            {
+                information.m_paletteDescriptors[scanChannels] = getReadingDataHandlerNumeric(0x0028, 0x0, static_cast<std::uint16_t>(0x1101 + scanChannels), 0);
+                information.m_paletteData[scanChannels] = getReadingDataHandlerNumeric(0x0028, 0x0, static_cast<std::uint16_t>(0x1201 + scanChannels), 0);
+            }
         }
 
-        return pImage;
+        return information;
     }
     catch(const MissingDataElementError&)
     {
@@ -384,6 +507,106 @@ std::shared_ptr<image> dataSet::getImage(std::uint32_t frameNumber) const
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Decode a frame located by getFrameInformation()
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::shared_ptr<image> dataSet::decodeFrame(const frameInformation& information)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<image> pImage;
+    pImage = information.m_pCodec->getImage(information.m_transferSyntax,
+                                            information.m_colorSpace,
+                                            information.m_channelsNumber,
+                                            information.m_imageWidth,
+                                            information.m_imageHeight,
+                                            information.m_bSubSampledX,
+                                            information.m_bSubSampledY,
+                                            information.m_bInterleaved,
+                                            information.m_b2Complement,
+                                            information.m_allocatedBits,
+                                            information.m_storedBits,
+                                            information.m_highBit,
+                                            information.m_pImageStream);
+
+    setFramePalette(information, pImage);
+
+    return pImage;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Decode a region of a frame located by
+//  getFrameInformation()
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::shared_ptr<image> dataSet::decodeFrame(const frameInformation& information, std::uint32_t left, std::uint32_t top, std::uint32_t width, std::uint32_t height)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<image> pImage;
+    pImage = information.m_pCodec->getImageRegion(information.m_transferSyntax,
+                                                  information.m_colorSpace,
+                                                  information.m_channelsNumber,
+                                                  information.m_imageWidth,
+                                                  information.m_imageHeight,
+                                                  information.m_bSubSampledX,
+                                                  information.m_bSubSampledY,
+                                                  information.m_bInterleaved,
+                                                  information.m_b2Complement,
+                                                  information.m_allocatedBits,
+                                                  information.m_storedBits,
+                                                  information.m_highBit,
+                                                  information.m_pImageStream,
+                                                  left, top, width, height);
+
+    setFramePalette(information, pImage);
+
+    return pImage;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Set the palette of a decoded frame
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void dataSet::setFramePalette(const frameInformation& information, const std::shared_ptr<image>& pImage)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(pImage->getColorSpace() == "PALETTE COLOR" && information.m_paletteData[0] != nullptr)
+    {
+        std::shared_ptr<lut> red(std::make_shared<lut>(information.m_paletteDescriptors[0], information.m_paletteData[0], L"", pImage->isSigned()));
+        std::shared_ptr<lut> green(std::make_shared<lut>(information.m_paletteDescriptors[1], information.m_paletteData[1], L"", pImage->isSigned()));
+        std::shared_ptr<lut> blue(std::make_shared<lut>(information.m_paletteDescriptors[2], information.m_paletteData[2], L"", pImage->isSigned()));
+        std::shared_ptr<palette> imagePalette(std::make_shared<palette>(red, green, blue));
+        pImage->setPalette(imagePalette);
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -398,7 +621,7 @@ std::shared_ptr<image> dataSet::getModalityImage(std::uint32_t frameNumber) cons
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
 
     std::shared_ptr<image> originalImage = getImage(frameNumber);
 
@@ -481,6 +704,77 @@ void dataSet::setImage(std::uint32_t frameNumber, std::shared_ptr<image> pImage,
 
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
+    storeFrame(frameNumber, pImage, getFrameEncoding(frameNumber, pImage, quality), nullptr);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Insert several consecutive frames, encoding them in
+//  parallel
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void dataSet::setImages(std::uint32_t firstFrame, const std::vector<std::shared_ptr<image> >& images, imageQuality_t quality, size_t threadsCount)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(images.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    // All the frames are encoded with the parameters of the
+    //  first one, so they must have the same format
+    ///////////////////////////////////////////////////////////
+    const frameEncoding encoding(getFrameEncoding(firstFrame, images.front(), quality));
+    for(const std::shared_ptr<image>& pImage: images)
+    {
+        checkFrameFormat(encoding, pImage);
+    }
+
+    // Encode each frame into a separate memory buffer
+    ///////////////////////////////////////////////////////////
+    std::vector<std::shared_ptr<memory> > encodedFrames(images.size());
+    runParallelTasks(images.size(), threadsCount, [&images, &encoding, &encodedFrames](size_t frame)
+    {
+        encodedFrames[frame] = encodeFrame(encoding, images[frame]);
+    });
+
+    // Store the encoded frames in order
+    ///////////////////////////////////////////////////////////
+    for(size_t frame(0); frame != images.size(); ++frame)
+    {
+        storeFrame(firstFrame + static_cast<std::uint32_t>(frame), images[frame], encoding, encodedFrames[frame]);
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Calculate the parameters used to encode a frame
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+dataSet::frameEncoding dataSet::getFrameEncoding(std::uint32_t frameNumber, const std::shared_ptr<image>& pImage, imageQuality_t quality) const
+{
+    IMEBRA_FUNCTION_START();
+
+    frameEncoding encoding;
+    encoding.m_quality = quality;
+
     // bDontChangeAttributes is true if some images already
     //  exist in the dataset and we must save the new image
     //  using the attributes already stored
@@ -491,32 +785,32 @@ void dataSet::setImage(std::uint32_t frameNumber, std::shared_ptr<image> pImage,
         IMEBRA_THROW(DataSetWrongFrameError, "The frames must be inserted in sequence");
     }
     const bool bDontChangeAttributes = (numberOfFrames != 0);
-    const std::string transferSyntax = getString(0x0002, 0x0, 0x0010, 0, 0, "1.2.840.10008.1.2");
+    encoding.m_transferSyntax = getString(0x0002, 0x0, 0x0010, 0, 0, "1.2.840.10008.1.2");
 
     // Select the right codec
     ///////////////////////////////////////////////////////////
-    std::shared_ptr<const codecs::imageCodec> saveCodec(codecs::codecFactory::getCodecFactory()->getImageCodec(transferSyntax));
+    encoding.m_pCodec = codecs::codecFactory::getCodecFactory()->getImageCodec(encoding.m_transferSyntax);
 
     // Do we have to save the basic offset table?
     ///////////////////////////////////////////////////////////
     const std::uint16_t groupId(0x7fe0), tagId(0x0010); // The tag where the image must be stored
-    const bool bEncapsulated = saveCodec->encapsulated(transferSyntax) || bufferExists(groupId, 0x0, tagId, 0x1);
+    encoding.m_bEncapsulated = encoding.m_pCodec->encapsulated(encoding.m_transferSyntax) || bufferExists(groupId, 0x0, tagId, 0x1);
 
     // Set the subsampling flags
     ///////////////////////////////////////////////////////////
-    bool bSubSampledX = static_cast<std::uint32_t>(quality) > static_cast<std::uint32_t>(imageQuality_t::high);
-    bool bSubSampledY = static_cast<std::uint32_t>(quality) > static_cast<std::uint32_t>(imageQuality_t::medium);
+    encoding.m_bSubSampledX = static_cast<std::uint32_t>(quality) > static_cast<std::uint32_t>(imageQuality_t::high);
+    encoding.m_bSubSampledY = static_cast<std::uint32_t>(quality) > static_cast<std::uint32_t>(imageQuality_t::medium);
     if( !transforms::colorTransforms::colorTransformsFactory::canSubsample(pImage->getColorSpace()) )
     {
-        bSubSampledX = bSubSampledY = false;
+        encoding.m_bSubSampledX = encoding.m_bSubSampledY = false;
     }
 
-    std::uint32_t width, height;
-    pImage->getSize(&width, &height);
-    const bool b2complement = pImage->isSigned();
-    const std::uint32_t channelsNumber = pImage->getChannelsNumber();
-    const std::uint32_t highBit = pImage->getHighBit();
-    const bool bInterleaved = (getUnsignedLong(0x0028, 0x0, 0x0006, 0, 0, channelsNumber > 1 ? 0 : 1) == 0x0);
+    pImage->getSize(&encoding.m_width, &encoding.m_height);
+    encoding.m_colorSpace = transforms::colorTransforms::colorTransformsFactory::normalizeColorSpace(pImage->getColorSpace());
+    encoding.m_b2Complement = pImage->isSigned();
+    encoding.m_channelsNumber = pImage->getChannelsNumber();
+    encoding.m_highBit = pImage->getHighBit();
+    encoding.m_bInterleaved = (getUnsignedLong(0x0028, 0x0, 0x0006, 0, 0, encoding.m_channelsNumber > 1 ? 0 : 1) == 0x0);
 
     // If the attributes cannot be changed, then check the
     //  attributes already stored in the dataset
@@ -525,15 +819,14 @@ void dataSet::setImage(std::uint32_t frameNumber, std::shared_ptr<image> pImage,
     {
         const std::string currentColorSpace = getString(0x0028, 0x0, 0x0004, 0, 0);
         if(
-                transforms::colorTransforms::colorTransformsFactory::normalizeColorSpace(pImage->getColorSpace()) !=
-                    transforms::colorTransforms::colorTransformsFactory::normalizeColorSpace(currentColorSpace) ||
-                bSubSampledX != transforms::colorTransforms::colorTransformsFactory::isSubsampledX(currentColorSpace) ||
-                bSubSampledY != transforms::colorTransforms::colorTransformsFactory::isSubsampledY(currentColorSpace) ||
-                b2complement != (getUnsignedLong(0x0028, 0, 0x0103, 0, 0) != 0) ||
-                highBit != getUnsignedLong(0x0028, 0x0, 0x0102, 0, 0) ||
-                channelsNumber != getUnsignedLong(0x0028, 0x0, 0x0002, 0, 0) ||
-                width != getUnsignedLong(0x0028, 0, 0x0011, 0, 0) ||
-                height != getUnsignedLong(0x0028, 0, 0x0010, 0, 0))
+                encoding.m_colorSpace != transforms::colorTransforms::colorTransformsFactory::normalizeColorSpace(currentColorSpace) ||
+                encoding.m_bSubSampledX != transforms::colorTransforms::colorTransformsFactory::isSubsampledX(currentColorSpace) ||
+                encoding.m_bSubSampledY != transforms::colorTransforms::colorTransformsFactory::isSubsampledY(currentColorSpace) ||
+                encoding.m_b2Complement != (getUnsignedLong(0x0028, 0, 0x0103, 0, 0) != 0) ||
+                encoding.m_highBit != getUnsignedLong(0x0028, 0x0, 0x0102, 0, 0) ||
+                encoding.m_channelsNumber != getUnsignedLong(0x0028, 0x0, 0x0002, 0, 0) ||
+                encoding.m_width != getUnsignedLong(0x0028, 0, 0x0011, 0, 0) ||
+                encoding.m_height != getUnsignedLong(0x0028, 0, 0x0010, 0, 0))
         {
             IMEBRA_THROW(DataSetDifferentFormatError, "An image already exists in the dataset and has different attributes");
         }
@@ -542,17 +835,106 @@ void dataSet::setImage(std::uint32_t frameNumber, std::shared_ptr<image> pImage,
     // Select the data type OB if not already set in the
     //  dataset
     ///////////////////////////////////////////////////////////
-    tagVR_t dataHandlerType;
-    if(transferSyntax == "1.2.840.10008.1.2")
+    if(encoding.m_transferSyntax == "1.2.840.10008.1.2")
     {
-        dataHandlerType = dicomDictionary::getDicomDictionary()->getTagType(0x7FE0, 0x0010);
+        encoding.m_dataHandlerType = dicomDictionary::getDicomDictionary()->getTagType(0x7FE0, 0x0010);
     }
     else
     {
-        dataHandlerType = (bEncapsulated || highBit <= 7) ? tagVR_t::OB : tagVR_t::OW;
+        encoding.m_dataHandlerType = (encoding.m_bEncapsulated || encoding.m_highBit <= 7) ? tagVR_t::OB : tagVR_t::OW;
     }
 
-    const std::uint32_t allocatedBits = saveCodec->suggestAllocatedBits(transferSyntax, pImage->getHighBit());
+    encoding.m_allocatedBits = encoding.m_pCodec->suggestAllocatedBits(encoding.m_transferSyntax, encoding.m_highBit);
+
+    return encoding;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Check that an image has the format described by the
+//  encoding parameters
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void dataSet::checkFrameFormat(const frameEncoding& encoding, const std::shared_ptr<image>& pImage)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::uint32_t width, height;
+    pImage->getSize(&width, &height);
+    if(
+            transforms::colorTransforms::colorTransformsFactory::normalizeColorSpace(pImage->getColorSpace()) != encoding.m_colorSpace ||
+            pImage->isSigned() != encoding.m_b2Complement ||
+            pImage->getHighBit() != encoding.m_highBit ||
+            pImage->getChannelsNumber() != encoding.m_channelsNumber ||
+            width != encoding.m_width ||
+            height != encoding.m_height)
+    {
+        IMEBRA_THROW(DataSetDifferentFormatError, "The images have different attributes");
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Encode a frame into a memory buffer
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::shared_ptr<memory> dataSet::encodeFrame(const frameEncoding& encoding, const std::shared_ptr<image>& pImage)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<memory> pEncodedFrame(std::make_shared<memory>());
+    std::shared_ptr<memoryStreamOutput> memStream(std::make_shared<memoryStreamOutput>(pEncodedFrame));
+    std::shared_ptr<streamWriter> outputStream(std::make_shared<streamWriter>(memStream));
+
+    encoding.m_pCodec->setImage(
+        outputStream,
+        pImage,
+        encoding.m_transferSyntax,
+        encoding.m_quality,
+        encoding.m_allocatedBits,
+        encoding.m_bSubSampledX, encoding.m_bSubSampledY,
+        encoding.m_bInterleaved,
+        encoding.m_b2Complement);
+
+    outputStream->flushDataBuffer();
+
+    return pEncodedFrame;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Store an encoded frame in the dataset
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void dataSet::storeFrame(std::uint32_t frameNumber, const std::shared_ptr<image>& pImage, const frameEncoding& encoding, std::shared_ptr<memory> pEncodedFrame)
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint16_t groupId(0x7fe0), tagId(0x0010); // The tag where the image must be stored
+    const bool bEncapsulated(encoding.m_bEncapsulated);
+    const std::uint32_t allocatedBits(encoding.m_allocatedBits);
+    tagVR_t dataHandlerType(encoding.m_dataHandlerType);
 
     // Encapsulated mode. Check if we have the offsets table
     ///////////////////////////////////////////////////////////
@@ -590,43 +972,39 @@ void dataSet::setImage(std::uint32_t frameNumber, std::shared_ptr<image> pImage,
         firstBufferId = getFirstAvailFrameBufferId();
     }
 
-    // Get a stream to save the image
+    // Save the image: encapsulated frames not encoded yet are
+    //  encoded directly into the tag
     ///////////////////////////////////////////////////////////
     {
-        std::shared_ptr<memory> uncompressedImage(std::make_shared<memory>());
-        std::shared_ptr<streamWriter> outputStream;
-        if(bEncapsulated)
+        if(bEncapsulated && pEncodedFrame == nullptr)
         {
-            outputStream = getStreamWriter(groupId, 0, tagId, firstBufferId, dataHandlerType);
+            std::shared_ptr<streamWriter> outputStream(getStreamWriter(groupId, 0, tagId, firstBufferId, dataHandlerType));
+            encoding.m_pCodec->setImage(
+                outputStream,
+                pImage,
+                encoding.m_transferSyntax,
+                encoding.m_quality,
+                allocatedBits,
+                encoding.m_bSubSampledX, encoding.m_bSubSampledY,
+                encoding.m_bInterleaved,
+                encoding.m_b2Complement);
+
+            outputStream->flushDataBuffer();
         }
-        else
+        else if(bEncapsulated)
         {
-            std::shared_ptr<memoryStreamOutput> memStream(std::make_shared<memoryStreamOutput>(uncompressedImage));
-            outputStream = std::make_shared<streamWriter>(memStream);
+            getTagCreate(groupId, 0, tagId, dataHandlerType)->getBufferCreate(firstBufferId, streamController::tByteOrdering::lowByteEndian)->appendMemory(pEncodedFrame);
         }
-
-        // Save the image in the stream
-        ///////////////////////////////////////////////////////////
-        saveCodec->setImage(
-            outputStream,
-            pImage,
-            transferSyntax,
-            quality,
-            allocatedBits,
-            bSubSampledX, bSubSampledY,
-            bInterleaved,
-            b2complement);
-
-        outputStream->flushDataBuffer();
-
-        if(!bEncapsulated)
+        else
         {
+            std::shared_ptr<memory> uncompressedImage(pEncodedFrame == nullptr ? encodeFrame(encoding, pImage) : pEncodedFrame);
+
             size_t imageSizeBits = codecs::dicomNativeImageCodec::getNativeImageSizeBits(allocatedBits,
-                                                                                          width,
-                                                                                          height,
-                                                                                          channelsNumber,
-                                                                                          bSubSampledX,
-                                                                                          bSubSampledY);
+                                                                                          encoding.m_width,
+                                                                                          encoding.m_height,
+                                                                                          encoding.m_channelsNumber,
+                                                                                          encoding.m_bSubSampledX,
+                                                                                          encoding.m_bSubSampledY);
 
             // Images with allocatedBits == 1 need special treatment (if not byte aligned)
             if(allocatedBits == 1 && ((frameNumber * imageSizeBits) & 0x7) != 0)
@@ -655,61 +1033,134 @@ void dataSet::setImage(std::uint32_t frameNumber, std::shared_ptr<image> pImage,
 
     // Write the attributes in the dataset
     ///////////////////////////////////////////////////////////
-    if(!bDontChangeAttributes)
+    if(frameNumber == 0)
     {
-        std::shared_ptr<handlers::writingDataHandler> dataHandlerTransferSyntax = getWritingDataHandler(0x0002, 0x0, 0x0010, 0x0);
-        dataHandlerTransferSyntax->setString(0, transferSyntax);
-
-        std::string colorSpace = pImage->getColorSpace();
-        setString(0x0028, 0x0, 0x0004, 0, transforms::colorTransforms::colorTransformsFactory::makeSubsampled(colorSpace, bSubSampledX, bSubSampledY));
-        if(channelsNumber > 1)
-        {
-            setUnsignedLong(0x0028, 0x0, 0x0006, 0, bInterleaved ? 0 : 1);
-        }
-        setUnsignedLong(0x0028, 0x0, 0x0100, 0, allocatedBits);            // allocated bits
-        setUnsignedLong(0x0028, 0x0, 0x0101, 0, pImage->getHighBit() + 1); // stored bits
-        setUnsignedLong(0x0028, 0x0, 0x0102, 0, pImage->getHighBit());     // high bit
-        setUnsignedLong(0x0028, 0x0, 0x0103, 0, b2complement ? 1 : 0);
-        setUnsignedLong(0x0028, 0x0, 0x0002, 0, channelsNumber);
-        pImage->getSize(&width, &height);
-        setUnsignedLong(0x0028, 0x0, 0x0011, 0, width);
-        setUnsignedLong(0x0028, 0x0, 0x0010, 0, height);
-
-        if(colorSpace == "PALETTE COLOR")
-        {
-            IMEBRA_THROW(DataSetImagePaletteColorIsReadOnly, "Cannot set images with color space PALETTE COLOR");
-        }
+        setImageAttributes(pImage, encoding);
     }
 
     // Update the number of frames
     ///////////////////////////////////////////////////////////
-    numberOfFrames = frameNumber + 1;
-    setUnsignedLong(0x0028, 0, 0x0008, 0, numberOfFrames );
+    setUnsignedLong(0x0028, 0, 0x0008, 0, frameNumber + 1);
 
     // Update the offsets tag with the image's offsets
     ///////////////////////////////////////////////////////////
     if(bEncapsulated)
     {
-        std::uint32_t calculatePosition(0);
-        std::shared_ptr<const data> tag(getTag(groupId, 0, tagId));
-        for(std::uint32_t scanBuffers = 1; scanBuffers < firstBufferId; ++scanBuffers)
+        updateOffsetTable(frameNumber, firstBufferId + 1, dataHandlerType);
+    }
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Update the basic or the extended offset table
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void dataSet::updateOffsetTable(std::uint32_t frameNumber, std::uint32_t endBufferId, tagVR_t dataHandlerType)
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint16_t groupId(0x7fe0), tagId(0x0010);
+
+    // Calculate the position of each fragment
+    ///////////////////////////////////////////////////////////
+    std::vector<std::uint64_t> positions;
+    std::vector<std::uint64_t> lengths;
+    std::uint64_t calculatePosition(0);
+    std::shared_ptr<const data> tag(getTag(groupId, 0, tagId));
+    for(std::uint32_t scanBuffers = 1; scanBuffers < endBufferId; ++scanBuffers)
+    {
+        size_t bufferSize = tag->getBufferSize(scanBuffers);
+        if((bufferSize & 1u) == 1u)
         {
-            size_t bufferSize = tag->getBufferSize(scanBuffers);
-            if((bufferSize & 1u) == 1u)
-            {
-                ++bufferSize;
-            }
-            calculatePosition += static_cast<std::uint32_t>(bufferSize);
-            calculatePosition += 8;
+            ++bufferSize;
         }
+        positions.push_back(calculatePosition);
+        lengths.push_back(bufferSize);
+        calculatePosition += bufferSize;
+        calculatePosition += 8;
+    }
+    const std::uint64_t framePosition(positions.back());
+
+    if(!bufferExists(groupId, 0, 0x0001, 0) && framePosition <= std::numeric_limits<std::uint32_t>::max())
+    {
         std::shared_ptr<handlers::writingDataHandlerRaw> offsetHandler(getWritingDataHandlerRaw(groupId, 0, tagId, 0, dataHandlerType));
         offsetHandler->setSize(4 * (frameNumber + 1));
         std::shared_ptr<handlers::readingDataHandlerRaw> originalOffsetHandler(getReadingDataHandlerRaw(groupId, 0, tagId, 0));
         originalOffsetHandler->copyTo(offsetHandler->getMemoryBuffer(), offsetHandler->getSize());
         std::uint8_t* pOffsetFrame(offsetHandler->getMemoryBuffer() + (frameNumber * 4));
-        *( reinterpret_cast<std::uint32_t*>(pOffsetFrame) ) = calculatePosition;
+        *( reinterpret_cast<std::uint32_t*>(pOffsetFrame) ) = static_cast<std::uint32_t>(framePosition);
         streamController::adjustEndian(pOffsetFrame, 4, streamController::lowByteEndian, 1);
+        return;
+    }
+
+    // The Extended Offset Table requires one fragment per
+    //  frame
+    ///////////////////////////////////////////////////////////
+    if(positions.size() != frameNumber + 1)
+    {
+        IMEBRA_THROW(DataSetWrongFrameError, "The Extended Offset Table requires one fragment per frame");
+    }
+
+    std::shared_ptr<handlers::writingDataHandlerRaw> extendedOffsetsHandler(getWritingDataHandlerRaw(groupId, 0, 0x0001, 0, tagVR_t::OV));
+    extendedOffsetsHandler->setSize(positions.size() * sizeof(std::uint64_t));
+    ::memcpy(extendedOffsetsHandler->getMemoryBuffer(), positions.data(), extendedOffsetsHandler->getSize());
+    streamController::adjustEndian(extendedOffsetsHandler->getMemoryBuffer(), sizeof(std::uint64_t), streamController::lowByteEndian, positions.size());
+
+    std::shared_ptr<handlers::writingDataHandlerRaw> extendedLengthsHandler(getWritingDataHandlerRaw(groupId, 0, 0x0002, 0, tagVR_t::OV));
+    extendedLengthsHandler->setSize(lengths.size() * sizeof(std::uint64_t));
+    ::memcpy(extendedLengthsHandler->getMemoryBuffer(), lengths.data(), extendedLengthsHandler->getSize());
+    streamController::adjustEndian(extendedLengthsHandler->getMemoryBuffer(), sizeof(std::uint64_t), streamController::lowByteEndian, lengths.size());
+
+    // The basic offset table must be empty when the
+    //  Extended Offset Table is present
+    ///////////////////////////////////////////////////////////
+    getWritingDataHandlerRaw(groupId, 0, tagId, 0, dataHandlerType)->setSize(0);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Write the image's attributes in the dataset
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void dataSet::setImageAttributes(const std::shared_ptr<image>& pImage, const frameEncoding& encoding)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<handlers::writingDataHandler> dataHandlerTransferSyntax = getWritingDataHandler(0x0002, 0x0, 0x0010, 0x0);
+    dataHandlerTransferSyntax->setString(0, encoding.m_transferSyntax);
+
+    std::string colorSpace = pImage->getColorSpace();
+    setString(0x0028, 0x0, 0x0004, 0, transforms::colorTransforms::colorTransformsFactory::makeSubsampled(colorSpace, encoding.m_bSubSampledX, encoding.m_bSubSampledY));
+    if(encoding.m_channelsNumber > 1)
+    {
+        setUnsignedLong(0x0028, 0x0, 0x0006, 0, encoding.m_bInterleaved ? 0 : 1);
+    }
+    setUnsignedLong(0x0028, 0x0, 0x0100, 0, encoding.m_allocatedBits);  // allocated bits
+    setUnsignedLong(0x0028, 0x0, 0x0101, 0, pImage->getHighBit() + 1); // stored bits
+    setUnsignedLong(0x0028, 0x0, 0x0102, 0, pImage->getHighBit());     // high bit
+    setUnsignedLong(0x0028, 0x0, 0x0103, 0, encoding.m_b2Complement ? 1 : 0);
+    setUnsignedLong(0x0028, 0x0, 0x0002, 0, encoding.m_channelsNumber);
+    setUnsignedLong(0x0028, 0x0, 0x0011, 0, encoding.m_width);
+    setUnsignedLong(0x0028, 0x0, 0x0010, 0, encoding.m_height);
+
+    if(colorSpace == "PALETTE COLOR")
+    {
+        IMEBRA_THROW(DataSetImagePaletteColorIsReadOnly, "Cannot set images with color space PALETTE COLOR");
     }
+
     IMEBRA_FUNCTION_END();
 }
 
@@ -866,7 +1317,7 @@ void dataSet::setOverlay(std::uint32_t overlayNumber, std::shared_ptr<overlay> p
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-std::uint32_t dataSet::getFrameOffset(std::uint32_t frameNumber) const
+std::uint64_t dataSet::getFrameOffset(std::uint32_t frameNumber) const
 {
     IMEBRA_FUNCTION_START();
 
@@ -881,11 +1332,11 @@ std::uint32_t dataSet::getFrameOffset(std::uint32_t frameNumber) const
         std::uint32_t offsetsCount = static_cast<std::uint32_t>(framesPointer->getSize() / sizeof(std::uint32_t));
 
         // If the requested frame doesn't exist then return
-        //  0xffffffff (the maximum value)
+        //  the maximum value
         ///////////////////////////////////////////////////////////
         if(frameNumber >= offsetsCount && frameNumber != 0)
         {
-            return std::numeric_limits<std::uint32_t>::max();
+            return std::numeric_limits<std::uint64_t>::max();
         }
 
         // Return the requested offset. If the requested frame is
@@ -903,7 +1354,7 @@ std::uint32_t dataSet::getFrameOffset(std::uint32_t frameNumber) const
     }
     catch(const MissingDataElementError&)
     {
-        return std::numeric_limits<std::uint32_t>::max();
+        return std::numeric_limits<std::uint64_t>::max();
     }
 
     IMEBRA_FUNCTION_END();
@@ -917,7 +1368,7 @@ std::uint32_t dataSet::getFrameOffset(std::uint32_t frameNumber) const
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-std::uint32_t dataSet::getFrameBufferId(std::uint32_t offset) const
+std::uint32_t dataSet::getFrameBufferId(std::uint64_t offset) const
 {
     IMEBRA_FUNCTION_START();
 
@@ -928,7 +1379,7 @@ std::uint32_t dataSet::getFrameBufferId(std::uint32_t offset) const
     ///////////////////////////////////////////////////////////
     std::uint32_t scanBuffers(1);
 
-    if(offset == std::numeric_limits<std::uint32_t>::max())
+    if(offset == std::numeric_limits<std::uint64_t>::max())
     {
         while(imageTag->bufferExists(scanBuffers))
         {
@@ -942,7 +1393,7 @@ std::uint32_t dataSet::getFrameBufferId(std::uint32_t offset) const
         // Calculate the total size of the buffer, including
         //  its descriptor (tag group and id and length)
         ///////////////////////////////////////////////////////////
-        std::uint32_t bufferSize = static_cast<std::uint32_t>(imageTag->getBufferSize(scanBuffers));
+        std::uint64_t bufferSize = imageTag->getBufferSize(scanBuffers);
         bufferSize += 4; // one WORD for the group id, one WORD for the tag id
         bufferSize += 4; // one DWORD for the tag length
         if(bufferSize > offset)
@@ -973,14 +1424,22 @@ size_t dataSet::getFrameBufferIds(std::uint32_t frameNumber, std::uint32_t* pFir
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
+
+    // The Extended Offset Table, when present, replaces
+    //  the basic offset table
+    ///////////////////////////////////////////////////////////
+    if(hasExtendedOffsetTable())
+    {
+        return getExtendedFrameBufferIds(frameNumber, pFirstBuffer, pEndBuffer);
+    }
 
     try
     {
-        std::uint32_t startOffset = getFrameOffset(frameNumber);
-        std::uint32_t endOffset = getFrameOffset(frameNumber + 1);
+        std::uint64_t startOffset = getFrameOffset(frameNumber);
+        std::uint64_t endOffset = getFrameOffset(frameNumber + 1);
 
-        if(startOffset == std::numeric_limits<std::uint32_t>::max())
+        if(startOffset == std::numeric_limits<std::uint64_t>::max())
         {
             IMEBRA_THROW(DataSetImageDoesntExistError, "Image not in the table offset");
         }
@@ -1014,6 +1473,123 @@ size_t dataSet::getFrameBufferIds(std::uint32_t frameNumber, std::uint32_t* pFir
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Check if the dataset contains an Extended Offset Table
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+bool dataSet::hasExtendedOffsetTable() const
+{
+    IMEBRA_FUNCTION_START();
+
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
+
+    return bufferExists(0x7fe0, 0x0, 0x0001, 0) && getTag(0x7fe0, 0x0, 0x0001)->getBufferSize(0) != 0;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Get the fragment occupied by a frame from the Extended
+//  Offset Table
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+size_t dataSet::getExtendedFrameBufferIds(std::uint32_t frameNumber, std::uint32_t* pFirstBuffer, std::uint32_t* pEndBuffer) const
+{
+    IMEBRA_FUNCTION_START();
+
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
+
+    std::shared_ptr<handlers::readingDataHandlerRaw> offsetsHandler(getReadingDataHandlerRaw(0x7fe0, 0x0, 0x0001, 0));
+    const size_t offsetsCount(offsetsHandler->getSize() / sizeof(std::uint64_t));
+    if(frameNumber >= offsetsCount)
+    {
+        IMEBRA_THROW(DataSetImageDoesntExistError, "Image not in the Extended Offset Table");
+    }
+
+    // Each frame is stored in one fragment: the entry n
+    //  refers to the fragment n + 1 (the buffer 0 contains the
+    //  basic offset table)
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<data> imageTag(getTag(0x7fe0, 0x0, 0x0010));
+    if(imageTag->getBuffersCount() != offsetsCount + 1)
+    {
+        IMEBRA_THROW(DataSetCorruptedOffsetTableError, "The Extended Offset Table has " << offsetsCount << " entries but the pixel data has " << imageTag->getBuffersCount() - 1 << " fragments");
+    }
+    const std::uint32_t fragmentId(frameNumber + 1);
+
+    // The entry must follow the previous fragment, including
+    //  its padding byte and its item tag and length
+    ///////////////////////////////////////////////////////////
+    const std::uint64_t offset(readExtendedOffsetTableEntry(*offsetsHandler, frameNumber));
+    std::uint64_t expectedOffset(0);
+    if(frameNumber != 0)
+    {
+        const std::uint64_t previousFragmentSize(imageTag->getBufferSize(fragmentId - 1));
+        expectedOffset = readExtendedOffsetTableEntry(*offsetsHandler, frameNumber - 1) + previousFragmentSize + (previousFragmentSize & 1u) + 8;
+    }
+    if(offset != expectedOffset)
+    {
+        IMEBRA_THROW(DataSetCorruptedOffsetTableError, "The Extended Offset Table entry for the frame " << frameNumber << " doesn't point to the fragment " << fragmentId);
+    }
+
+    // The Extended Offset Table Lengths specify the size of
+    //  the frame, without the fragment's padding byte
+    ///////////////////////////////////////////////////////////
+    const size_t fragmentSize(imageTag->getBufferSize(fragmentId));
+    size_t frameLength(fragmentSize);
+    if(bufferExists(0x7fe0, 0x0, 0x0002, 0))
+    {
+        std::shared_ptr<handlers::readingDataHandlerRaw> lengthsHandler(getReadingDataHandlerRaw(0x7fe0, 0x0, 0x0002, 0));
+        if(lengthsHandler->getSize() / sizeof(std::uint64_t) != offsetsCount)
+        {
+            IMEBRA_THROW(DataSetCorruptedOffsetTableError, "The Extended Offset Table Lengths and the Extended Offset Table have different sizes");
+        }
+        const std::uint64_t length(readExtendedOffsetTableEntry(*lengthsHandler, frameNumber));
+        if(length > fragmentSize + (fragmentSize & 1u))
+        {
+            IMEBRA_THROW(DataSetCorruptedOffsetTableError, "The Extended Offset Table Lengths entry for the frame " << frameNumber << " is larger than the fragment " << fragmentId);
+        }
+        frameLength = std::min(fragmentSize, static_cast<size_t>(length));
+    }
+
+    *pFirstBuffer = fragmentId;
+    *pEndBuffer = fragmentId + 1;
+
+    return frameLength;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Read one entry of the Extended Offset Table or of the
+//  Extended Offset Table Lengths
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::uint64_t dataSet::readExtendedOffsetTableEntry(const handlers::readingDataHandlerRaw& tableHandler, size_t entry)
+{
+    std::uint64_t value;
+    ::memcpy(&value, tableHandler.getMemoryBuffer() + entry * sizeof(std::uint64_t), sizeof(value));
+    return streamController::adjustEndian(value, streamController::lowByteEndian);
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -1091,7 +1667,7 @@ std::shared_ptr<lut> dataSet::getLut(std::uint16_t groupId, std::uint16_t tagId,
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
 
     std::shared_ptr<dataSet> embeddedLUT = getSequenceItem(groupId, 0, tagId, lutId);
     std::shared_ptr<handlers::readingDataHandlerNumericBase> descriptorHandle = embeddedLUT->getReadingDataHandlerNumeric(0x0028, 0x0, 0x3002, 0x0);
@@ -1188,6 +1764,15 @@ std::int32_t dataSet::getSignedLong(std::uint16_t groupId, std::uint32_t order,
 {
     IMEBRA_FUNCTION_START();
 
+    std::int32_t value;
+    if(tryGetSignedLong(groupId, order, tagId, bufferId, elementNumber, value))
+    {
+        return value;
+    }
+
+    // The element is missing: let the data handler throw
+    //  the appropriate exception
+    ///////////////////////////////////////////////////////////
     return getReadingDataHandler(groupId, order, tagId, bufferId)->getSignedLong(elementNumber);
 
     IMEBRA_FUNCTION_END();
@@ -1197,14 +1782,23 @@ std::int32_t dataSet::getSignedLong(std::uint16_t groupId, std::uint32_t order,
 {
     IMEBRA_FUNCTION_START();
 
-    try
+    std::int32_t value;
+    if(tryGetSignedLong(groupId, order, tagId, bufferId, elementNumber, value))
     {
-        return getSignedLong(groupId, order, tagId, bufferId, elementNumber);
-    }
-    catch(const MissingDataElementError&)
-    {
-        return defaultValue;
+        return value;
     }
+    return defaultValue;
+
+    IMEBRA_FUNCTION_END();
+}
+
+bool dataSet::tryGetSignedLong(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, std::int32_t& value) const
+{
+    IMEBRA_FUNCTION_START();
+
+    tagVR_t tagVR;
+    std::shared_ptr<buffer> pBuffer(findBuffer(groupId, order, tagId, bufferId, tagVR));
+    return pBuffer != nullptr && pBuffer->tryGetSignedLong(tagVR, elementNumber, value);
 
     IMEBRA_FUNCTION_END();
 }
@@ -1256,6 +1850,15 @@ std::uint32_t dataSet::getUnsignedLong(std::uint16_t groupId, std::uint32_t orde
 {
     IMEBRA_FUNCTION_START();
 
+    std::uint32_t value;
+    if(tryGetUnsignedLong(groupId, order, tagId, bufferId, elementNumber, value))
+    {
+        return value;
+    }
+
+    // The element is missing: let the data handler throw
+    //  the appropriate exception
+    ///////////////////////////////////////////////////////////
     return getReadingDataHandler(groupId, order, tagId, bufferId)->getUnsignedLong(elementNumber);
 
     IMEBRA_FUNCTION_END();
@@ -1265,14 +1868,23 @@ std::uint32_t dataSet::getUnsignedLong(std::uint16_t groupId, std::uint32_t orde
 {
     IMEBRA_FUNCTION_START();
 
-    try
+    std::uint32_t value;
+    if(tryGetUnsignedLong(groupId, order, tagId, bufferId, elementNumber, value))
     {
-        return getUnsignedLong(groupId, order, tagId, bufferId, elementNumber);
-    }
-    catch(const MissingDataElementError&)
-    {
-        return defaultValue;
+        return value;
     }
+    return defaultValue;
+
+    IMEBRA_FUNCTION_END();
+}
+
+bool dataSet::tryGetUnsignedLong(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, std::uint32_t& value) const
+{
+    IMEBRA_FUNCTION_START();
+
+    tagVR_t tagVR;
+    std::shared_ptr<buffer> pBuffer(findBuffer(groupId, order, tagId, bufferId, tagVR));
+    return pBuffer != nullptr && pBuffer->tryGetUnsignedLong(tagVR, elementNumber, value);
 
     IMEBRA_FUNCTION_END();
 }
@@ -1324,6 +1936,15 @@ double dataSet::getDouble(std::uint16_t groupId, std::uint32_t order, std::uint1
 {
     IMEBRA_FUNCTION_START();
 
+    double value;
+    if(tryGetDouble(groupId, order, tagId, bufferId, elementNumber, value))
+    {
+        return value;
+    }
+
+    // The element is missing: let the data handler throw
+    //  the appropriate exception
+    ///////////////////////////////////////////////////////////
     return getReadingDataHandler(groupId, order, tagId, bufferId)->getDouble(elementNumber);
 
     IMEBRA_FUNCTION_END();
@@ -1333,14 +1954,23 @@ double dataSet::getDouble(std::uint16_t groupId, std::uint32_t order, std::uint1
 {
     IMEBRA_FUNCTION_START();
 
-    try
-    {
-        return getDouble(groupId, order, tagId, bufferId, elementNumber);
-    }
-    catch(const MissingDataElementError&)
+    double value;
+    if(tryGetDouble(groupId, order, tagId, bufferId, elementNumber, value))
     {
-        return defaultValue;
+        return value;
     }
+    return defaultValue;
+
+    IMEBRA_FUNCTION_END();
+}
+
+bool dataSet::tryGetDouble(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, double& value) const
+{
+    IMEBRA_FUNCTION_START();
+
+    tagVR_t tagVR;
+    std::shared_ptr<buffer> pBuffer(findBuffer(groupId, order, tagId, bufferId, tagVR));
+    return pBuffer != nullptr && pBuffer->tryGetDouble(tagVR, elementNumber, value);
 
     IMEBRA_FUNCTION_END();
 }
@@ -1390,6 +2020,15 @@ std::string dataSet::getString(std::uint16_t groupId, std::uint32_t order, std::
 {
     IMEBRA_FUNCTION_START();
 
+    std::string value;
+    if(tryGetString(groupId, order, tagId, bufferId, elementNumber, value))
+    {
+        return value;
+    }
+
+    // The element is missing: let the data handler throw
+    //  the appropriate exception
+    ///////////////////////////////////////////////////////////
     return getReadingDataHandler(groupId, order, tagId, bufferId)->getString(elementNumber);
 
     IMEBRA_FUNCTION_END();
@@ -1399,14 +2038,23 @@ std::string dataSet::getString(std::uint16_t groupId, std::uint32_t order, std::
 {
     IMEBRA_FUNCTION_START();
 
-    try
-    {
-        return getString(groupId, order, tagId, bufferId, elementNumber);
-    }
-    catch(const MissingDataElementError&)
+    std::string value;
+    if(tryGetString(groupId, order, tagId, bufferId, elementNumber, value))
     {
-        return defaultValue;
+        return value;
     }
+    return defaultValue;
+
+    IMEBRA_FUNCTION_END();
+}
+
+bool dataSet::tryGetString(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, std::string& value) const
+{
+    IMEBRA_FUNCTION_START();
+
+    tagVR_t tagVR;
+    std::shared_ptr<buffer> pBuffer(findBuffer(groupId, order, tagId, bufferId, tagVR));
+    return pBuffer != nullptr && pBuffer->tryGetString(tagVR, elementNumber, value);
 
     IMEBRA_FUNCTION_END();
 }
@@ -1886,7 +2534,7 @@ void dataSet::setItemOffset(std::uint32_t offset)
 ///////////////////////////////////////////////////////////
 std::uint32_t dataSet::getItemOffset() const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
 
     return m_itemOffset;
 }
@@ -1895,13 +2543,13 @@ dataSet::tGroupsIds dataSet::getGroups() const
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
 
     dataSet::tGroupsIds groups;
 
-    for(tGroups::const_iterator scanGroups(m_groups.begin()), endGroups(m_groups.end()); scanGroups != endGroups; ++scanGroups)
+    for(const tagRecord& tag: m_tags)
     {
-        groups.insert(scanGroups->first);
+        groups.insert(groups.end(), static_cast<std::uint16_t>(tag.m_key >> 48));
     }
 
     return groups;
@@ -1913,39 +2561,99 @@ std::uint32_t dataSet::getGroupsNumber(uint16_t groupId) const
 {
     IMEBRA_FUNCTION_START();
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
 
-    dataSet::tGroups::const_iterator findGroup(m_groups.find(groupId));
+    // Find the last tag in the group
+    ///////////////////////////////////////////////////////////
+    tTagRecords::const_iterator findLastTag(std::upper_bound(
+                                                 m_tags.begin(),
+                                                 m_tags.end(),
+                                                 getTagKey(groupId, 0xffffffff, 0xffff),
+                                                 [](std::uint64_t key, const tagRecord& tag){ return key < tag.m_key; }));
 
-    if(findGroup == m_groups.end())
+    if(findLastTag == m_tags.begin() || static_cast<std::uint16_t>((--findLastTag)->m_key >> 48) != groupId)
     {
         return 0;
     }
 
-    return static_cast<std::uint32_t>(findGroup->second.size());
+    return static_cast<std::uint32_t>((findLastTag->m_key >> 16) & 0xffffffff) + 1;
 
     IMEBRA_FUNCTION_END();
 }
 
-const dataSet::tTags& dataSet::getGroupTags(std::uint16_t groupId, size_t groupOrder) const
+dataSet::tTags dataSet::getGroupTags(std::uint16_t groupId, size_t groupOrder) const
 {
     IMEBRA_FUNCTION_START();
 
-    static const dataSet::tTags emptyTags;
+    dataSet::tTags tags;
+
+    if(groupOrder > 0xffffffff)
+    {
+        return tags;
+    }
+
+    std::unique_lock<std::recursive_mutex> lock(lockForReading());
+
+    const std::uint32_t order(static_cast<std::uint32_t>(groupOrder));
+    const tTagRecords::const_iterator firstTag(findTagRecord(getTagKey(groupId, order, 0)));
+    tTagRecords::const_iterator endTag(firstTag);
+    const std::uint64_t lastKey(getTagKey(groupId, order, 0xffff));
+    while(endTag != m_tags.end() && endTag->m_key <= lastKey)
+    {
+        ++endTag;
+    }
+
+    tags.reserve(static_cast<size_t>(endTag - firstTag));
+    for(tTagRecords::const_iterator scanTags(firstTag); scanTags != endTag; ++scanTags)
+    {
+        tags.emplace_back(static_cast<std::uint16_t>(scanTags->m_key & 0xffff), scanTags->m_pData);
+    }
+
+    return tags;
+
+    IMEBRA_FUNCTION_END();
+}
+
+std::uint64_t dataSet::getTagKey(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId)
+{
+    return (static_cast<std::uint64_t>(groupId) << 48) | (static_cast<std::uint64_t>(order) << 16) | tagId;
+}
+
+dataSet::tTagRecords::const_iterator dataSet::findTagRecord(std::uint64_t key) const
+{
+    return std::lower_bound(
+                m_tags.begin(),
+                m_tags.end(),
+                key,
+                [](const tagRecord& tag, std::uint64_t findKey){ return tag.m_key < findKey; });
+}
+
+const std::shared_ptr<arena>& dataSet::getArena() const
+{
+    return m_pArena;
+}
+
+void dataSet::freeze()
+{
+    IMEBRA_FUNCTION_START();
 
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-    tGroups::const_iterator findGroup(m_groups.find(groupId));
-    if(findGroup == m_groups.end() || findGroup->second.size() <= groupOrder)
+    for(const tagRecord& tag: m_tags)
     {
-        return emptyTags;
+        tag.m_pData->freeze();
     }
 
-    return findGroup->second.at(groupOrder);
+    m_bFrozen = true;
 
     IMEBRA_FUNCTION_END();
 }
 
+std::unique_lock<std::recursive_mutex> dataSet::lockForReading() const
+{
+    return m_bFrozen ? std::unique_lock<std::recursive_mutex>() : std::unique_lock<std::recursive_mutex>(m_mutex);
+}
+
 void dataSet::setCharsetsList(const charsetsList_t& charsets)
 {
     IMEBRA_FUNCTION_START();
@@ -44,6 +44,12 @@ class VOIDescription;
 class streamReader;
 class streamWriter;
 class overlay;
+class framesWriter;
+
+namespace codecs
+{
+    class imageCodec;
+}
 
 /// \addtogroup group_dataset Dicom data
 /// \brief The Dicom dataset is represented by the
@@ -84,6 +90,8 @@ class overlay;
 ///////////////////////////////////////////////////////////
 class dataSet : public std::enable_shared_from_this<dataSet>
 {
+    friend class framesWriter;
+
 public:
     // Costructor
     ///////////////////////////////////////////////////////////
@@ -192,6 +200,49 @@ public:
     ///////////////////////////////////////////////////////////
     std::shared_ptr<image> getImage(std::uint32_t frameNumber) const;
 
+    /// \brief Retrieve a rectangular region of an image from
+    ///        the dataset.
+    ///
+    /// The codecs that support it decode only the data
+    ///  needed by the region; the other codecs decode the
+    ///  whole frame and then copy the region.
+    ///
+    /// Throws ImageInvalidSizeError if the region is empty or
+    ///  is not completely inside the image.
+    ///
+    /// @param frameNumber The frame number to retrieve.
+    ///                    The first frame's id is 0
+    /// @param left        the region's left column
+    /// @param top         the region's top row
+    /// @param width       the region's width, in pixels
+    /// @param height      the region's height, in pixels
+    /// @return            an image containing the region
+    ///
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<image> getImage(std::uint32_t frameNumber, std::uint32_t left, std::uint32_t top, std::uint32_t width, std::uint32_t height) const;
+
+    /// \brief Retrieve several consecutive frames, decoding
+    ///        them in parallel.
+    ///
+    /// The position of the frames in the dataset is resolved
+    ///  while the dataset is locked, then the frames are
+    ///  decoded by several threads without holding the
+    ///  dataset's lock.
+    ///
+    /// If the decoding of one frame fails then the exception
+    ///  is rethrown after all the threads have exited.
+    ///
+    /// @param firstFrame   the first frame to retrieve
+    /// @param framesCount  the number of frames to retrieve
+    /// @param threadsCount the number of threads used for
+    ///                     the decoding. 0 means one thread
+    ///                     per hardware core
+    /// @return the decoded frames, in the same order as in
+    ///          the dataset
+    ///
+    ///////////////////////////////////////////////////////////
+    std::vector<std::shared_ptr<image> > getImages(std::uint32_t firstFrame, std::uint32_t framesCount, size_t threadsCount) const;
+
     /// \brief Retrieve an image from the dataset and apply the
     ///        modality transform if it is specified in the
     ///        dataset.
@@ -224,6 +275,33 @@ public:
     ///////////////////////////////////////////////////////////
     void setImage(std::uint32_t frameNumber, std::shared_ptr<image> pImage, imageQuality_t quality);
 
+    /// \brief Insert several consecutive frames, encoding
+    ///        them in parallel.
+    ///
+    /// The encoding parameters are calculated once, then the
+    ///  frames are encoded into separate memory buffers by
+    ///  several threads and finally stored in the dataset
+    ///  in order.
+    ///
+    /// All the images must have the same format; the first
+    ///  frame must follow the frames already stored in the
+    ///  dataset.
+    ///
+    /// If the encoding of one frame fails then the exception
+    ///  is rethrown after all the threads have exited and no
+    ///  frame is stored.
+    ///
+    /// @param firstFrame   the frame number of the first
+    ///                     image
+    /// @param images       the images to store
+    /// @param quality      the compression quality
+    /// @param threadsCount the number of threads used for
+    ///                     the encoding. 0 means one thread
+    ///                     per hardware core
+    ///
+    ///////////////////////////////////////////////////////////
+    void setImages(std::uint32_t firstFrame, const std::vector<std::shared_ptr<image> >& images, imageQuality_t quality, size_t threadsCount);
+
     /// \brief Retrieve an overlay from the dataset.
     ///
     /// If the dataSet does not contain the requested overlay
@@ -595,6 +673,39 @@ public:
 
     std::string getString(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, const std::string& defaultValue) const;
 
+    /// \brief Read the value of the requested tag without
+    ///         throwing when the tag is missing.
+    ///
+    /// Unlike getSignedLong(), getUnsignedLong(),
+    ///  getDouble() and getString(), these methods don't
+    ///  throw MissingDataElementError when the group, the
+    ///  tag, the buffer or the element don't exist, and
+    ///  decode the most common VRs directly from the
+    ///  buffer's memory without creating a data handler
+    ///  (see buffer::tryGetSignedLong()).
+    ///
+    /// Conversion errors still throw.
+    ///
+    /// @param groupId The group to which the tag to be read
+    ///                 belongs
+    /// @param order   The group's order, usually zero
+    /// @param tagId   The id of the tag to retrieve
+    /// @param bufferId The buffer's id, usually zero
+    /// @param elementNumber The element's number to retrieve.
+    /// @param value   set to the element's value. Left
+    ///                 unchanged when the element is missing
+    /// @return        true if the element exists, false
+    ///                 otherwise
+    ///
+    ///////////////////////////////////////////////////////////
+    bool tryGetSignedLong(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, std::int32_t& value) const;
+
+    bool tryGetUnsignedLong(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, std::uint32_t& value) const;
+
+    bool tryGetDouble(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, double& value) const;
+
+    bool tryGetString(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, size_t elementNumber, std::string& value) const;
+
     /// \brief Retrieve a tag's value as an unicode string.
     ///
     /// Read the value of the requested tag and return it as
@@ -903,9 +1014,10 @@ public:
 
     //@}
 
-    typedef std::map<std::uint16_t, std::shared_ptr<data> > tTags;
-    typedef std::vector<tTags> tGroupsList;
-    typedef std::map<std::uint16_t, tGroupsList> tGroups;
+    /// \brief The tags in one group, sorted by tag id.
+    ///
+    ///////////////////////////////////////////////////////////
+    typedef std::vector<std::pair<std::uint16_t, std::shared_ptr<data> > > tTags;
 
     typedef std::set<std::uint16_t> tGroupsIds;
 
@@ -913,19 +1025,236 @@ public:
 
     std::uint32_t getGroupsNumber(std::uint16_t groupId) const;
 
-    const tTags& getGroupTags(std::uint16_t groupId, size_t groupOrder) const;
+    tTags getGroupTags(std::uint16_t groupId, size_t groupOrder) const;
 
     void setCharsetsList(const charsetsList_t& charsets);
 
+    /// \brief Return the arena used to allocate the
+    ///         dataset's tags and small values.
+    ///
+    /// @return the dataset's arena
+    ///
+    ///////////////////////////////////////////////////////////
+    const std::shared_ptr<arena>& getArena() const;
+
+    /// \brief Mark the dataset, its tags and its sequence
+    ///         items as immutable.
+    ///
+    /// The reading methods of a frozen dataset don't lock
+    ///  its mutex, so several threads can read the dataset
+    ///  without contention. Called when a loaded dataset is
+    ///  returned as an immutable DataSet.
+    ///
+    /// The dataset must not be modified once it has been
+    ///  frozen.
+    ///
+    ///////////////////////////////////////////////////////////
+    void freeze();
+
 private:
-    /// \brief Get a frame's offset from the offset table.
+    /// \brief Lock the dataset's mutex, unless the dataset
+    ///         is frozen.
+    ///
+    /// @return the lock, which doesn't own the mutex when
+    ///          the dataset is frozen
+    ///
+    ///////////////////////////////////////////////////////////
+    std::unique_lock<std::recursive_mutex> lockForReading() const;
+
+    /// \brief Information needed to decode one frame.
+    ///
+    /// Filled by getFrameInformation() while the dataset is
+    ///  locked, then used by decodeFrame() without any lock.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct frameInformation
+    {
+        std::shared_ptr<const codecs::imageCodec> m_pCodec;
+        std::string m_transferSyntax;
+        std::string m_colorSpace;
+        std::uint32_t m_channelsNumber;
+        std::uint32_t m_imageWidth;
+        std::uint32_t m_imageHeight;
+        bool m_bSubSampledX;
+        bool m_bSubSampledY;
+        bool m_bInterleaved;
+        bool m_b2Complement;
+        std::uint8_t m_allocatedBits;
+        std::uint8_t m_storedBits;
+        std::uint8_t m_highBit;
+        std::shared_ptr<streamReader> m_pImageStream;
+
+        // Palette descriptors and data (red, green, blue)
+        ///////////////////////////////////////////////////////////
+        std::shared_ptr<handlers::readingDataHandlerNumericBase> m_paletteDescriptors[3];
+        std::shared_ptr<handlers::readingDataHandlerNumericBase> m_paletteData[3];
+    };
+
+    /// \brief Locate a frame and read the information
+    ///        needed to decode it.
+    ///
+    /// The caller must hold the dataset's lock.
+    ///
+    /// @param frameNumber the frame to locate
+    /// @return the information needed by decodeFrame()
+    ///
+    ///////////////////////////////////////////////////////////
+    frameInformation getFrameInformation(std::uint32_t frameNumber) const;
+
+    /// \brief Decode a frame located by
+    ///        getFrameInformation().
+    ///
+    /// Doesn't access the dataset and can be called without
+    ///  holding its lock.
+    ///
+    /// @param information the frame's information
+    /// @return the decoded frame
+    ///
+    ///////////////////////////////////////////////////////////
+    static std::shared_ptr<image> decodeFrame(const frameInformation& information);
+
+    /// \brief Decode a region of a frame located by
+    ///        getFrameInformation().
+    ///
+    /// The region must be inside the frame.
+    ///
+    /// @param information the frame's information
+    /// @param left        the region's left column
+    /// @param top         the region's top row
+    /// @param width       the region's width, in pixels
+    /// @param height      the region's height, in pixels
+    /// @return the decoded region
+    ///
+    ///////////////////////////////////////////////////////////
+    static std::shared_ptr<image> decodeFrame(const frameInformation& information, std::uint32_t left, std::uint32_t top, std::uint32_t width, std::uint32_t height);
+
+    /// \brief Set the palette of a decoded frame, if it uses
+    ///        the PALETTE COLOR color space.
+    ///
+    /// @param information the frame's information
+    /// @param pImage      the decoded frame
+    ///
+    ///////////////////////////////////////////////////////////
+    static void setFramePalette(const frameInformation& information, const std::shared_ptr<image>& pImage);
+
+    /// \brief Parameters used to encode a frame.
+    ///
+    /// Filled by getFrameEncoding() while the dataset is
+    ///  locked, then used by encodeFrame() and storeFrame().
+    ///
+    ///////////////////////////////////////////////////////////
+    struct frameEncoding
+    {
+        std::shared_ptr<const codecs::imageCodec> m_pCodec;
+        std::string m_transferSyntax;
+        std::string m_colorSpace;
+        imageQuality_t m_quality;
+        bool m_bEncapsulated;
+        bool m_bSubSampledX;
+        bool m_bSubSampledY;
+        bool m_bInterleaved;
+        bool m_b2Complement;
+        std::uint32_t m_width;
+        std::uint32_t m_height;
+        std::uint32_t m_channelsNumber;
+        std::uint32_t m_highBit;
+        std::uint32_t m_allocatedBits;
+        tagVR_t m_dataHandlerType;
+    };
+
+    /// \brief Calculate the parameters used to encode a
+    ///        frame and check that the image is compatible
+    ///        with the frames already in the dataset.
+    ///
+    /// The caller must hold the dataset's lock.
+    ///
+    /// @param frameNumber the frame that will be stored
+    /// @param pImage      the image that will be stored
+    /// @param quality     the compression quality
+    /// @return the parameters needed by encodeFrame() and
+    ///          storeFrame()
+    ///
+    ///////////////////////////////////////////////////////////
+    frameEncoding getFrameEncoding(std::uint32_t frameNumber, const std::shared_ptr<image>& pImage, imageQuality_t quality) const;
+
+    /// \brief Check that an image can be encoded with the
+    ///        parameters calculated for another one.
+    ///
+    /// Throws DataSetDifferentFormatError if the image's
+    ///  attributes don't match the encoding parameters.
+    ///
+    /// @param encoding the encoding parameters
+    /// @param pImage   the image to check
+    ///
+    ///////////////////////////////////////////////////////////
+    static void checkFrameFormat(const frameEncoding& encoding, const std::shared_ptr<image>& pImage);
+
+    /// \brief Write the image's attributes (transfer syntax,
+    ///        color space, size, bits, ...) in the dataset.
+    ///
+    /// The caller must hold the dataset's lock.
+    ///
+    /// @param pImage   the first image stored in the dataset
+    /// @param encoding the encoding parameters
+    ///
+    ///////////////////////////////////////////////////////////
+    void setImageAttributes(const std::shared_ptr<image>& pImage, const frameEncoding& encoding);
+
+    /// \brief Encode a frame into a memory buffer.
+    ///
+    /// Doesn't access the dataset and can be called without
+    ///  holding its lock.
+    ///
+    /// @param encoding the encoding parameters
+    /// @param pImage   the image to encode
+    /// @return the encoded frame
+    ///
+    ///////////////////////////////////////////////////////////
+    static std::shared_ptr<memory> encodeFrame(const frameEncoding& encoding, const std::shared_ptr<image>& pImage);
+
+    /// \brief Store a frame in the dataset and update the
+    ///        image's attributes and the offset table.
+    ///
+    /// The caller must hold the dataset's lock.
+    ///
+    /// @param frameNumber   the frame number
+    /// @param pImage        the image being stored
+    /// @param encoding      the encoding parameters
+    /// @param pEncodedFrame the frame already encoded by
+    ///                      encodeFrame(), or null to
+    ///                      encode the image directly into
+    ///                      the dataset
+    ///
+    ///////////////////////////////////////////////////////////
+    void storeFrame(std::uint32_t frameNumber, const std::shared_ptr<image>& pImage, const frameEncoding& encoding, std::shared_ptr<memory> pEncodedFrame);
+
+    /// \brief Get a frame's offset from the basic offset
+    ///         table.
     ///
     /// @param frameNumber the number of the frame for which
     ///                     the offset is requested
     /// @return the offset for the specified frame
     ///
     ///////////////////////////////////////////////////////////
-    std::uint32_t getFrameOffset(std::uint32_t frameNumber) const;
+    std::uint64_t getFrameOffset(std::uint32_t frameNumber) const;
+
+    /// \brief Update the basic offset table or the Extended
+    ///         Offset Table after a frame has been stored.
+    ///
+    /// The Extended Offset Table and its lengths table
+    ///  (7FE0,0002) are used when they already exist or when
+    ///  a frame's offset doesn't fit in 32 bits. In this
+    ///  case the basic offset table is left empty.
+    ///
+    /// The caller must hold the dataset's lock.
+    ///
+    /// @param frameNumber   the number of the stored frame
+    /// @param endBufferId   the id of the buffer following the
+    ///                       one containing the stored frame
+    /// @param dataHandlerType the pixel data's data type
+    ///
+    ///////////////////////////////////////////////////////////
+    void updateOffsetTable(std::uint32_t frameNumber, std::uint32_t endBufferId, tagVR_t dataHandlerType);
 
     /// \brief Return the first buffer's id available where
     ///         a new frame can be saved.
@@ -950,13 +1279,110 @@ private:
     ///                  the specified offset
     ///
     ///////////////////////////////////////////////////////////
-    std::uint32_t getFrameBufferId(std::uint32_t offset) const;
+    std::uint32_t getFrameBufferId(std::uint64_t offset) const;
 
-    tGroups m_groups;
+    /// \brief Return true if the dataset contains a non
+    ///         empty Extended Offset Table (7FE0,0001).
+    ///
+    /// @return true if the frames must be located through
+    ///          the Extended Offset Table
+    ///
+    ///////////////////////////////////////////////////////////
+    bool hasExtendedOffsetTable() const;
+
+    /// \brief Retrieve the fragment that contains a frame
+    ///         from the Extended Offset Table.
+    ///
+    /// The Extended Offset Table requires one fragment per
+    ///  frame: the entry is checked against the size of the
+    ///  previous fragment and, when the Extended Offset Table
+    ///  Lengths (7FE0,0002) are present, the frame's length
+    ///  is checked against the fragment's size.
+    ///
+    /// Throws DataSetCorruptedOffsetTableError if the tables
+    ///  don't match the fragments.
+    ///
+    /// @param frameNumber  the frame for which the fragment
+    ///                      has to be retrieved
+    /// @param pFirstBuffer a pointer to a variable that will
+    ///                      contain the id of the fragment
+    /// @param pEndBuffer   a pointer to a variable that will
+    ///                      contain the id of the next fragment
+    /// @return the frame's length, from the Extended Offset
+    ///          Table Lengths if present or from the fragment
+    ///
+    ///////////////////////////////////////////////////////////
+    size_t getExtendedFrameBufferIds(std::uint32_t frameNumber, std::uint32_t* pFirstBuffer, std::uint32_t* pEndBuffer) const;
+
+    /// \brief Read a little endian entry from the Extended
+    ///         Offset Table or its lengths table.
+    ///
+    /// @param tableHandler the handler of the table
+    /// @param entry        the entry to read
+    /// @return the entry's value
+    ///
+    ///////////////////////////////////////////////////////////
+    static std::uint64_t readExtendedOffsetTableEntry(const handlers::readingDataHandlerRaw& tableHandler, size_t entry);
+
+    /// \brief Build the key used to sort the tags in
+    ///         m_tags.
+    ///
+    /// @param groupId the group id
+    /// @param order   the group's order
+    /// @param tagId   the tag id
+    /// @return the tag's sort key
+    ///
+    ///////////////////////////////////////////////////////////
+    static std::uint64_t getTagKey(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId);
+
+    /// \brief A tag stored in the dataset.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct tagRecord
+    {
+        std::uint64_t m_key; // < See getTagKey()
+        std::shared_ptr<data> m_pData;
+    };
+
+    typedef std::vector<tagRecord> tTagRecords;
+
+    /// \brief Return the first tag with a key equal or
+    ///         greater than the specified one.
+    ///
+    /// @param key the key to look for
+    /// @return an iterator to the first tag with a key equal
+    ///          or greater than key
+    ///
+    ///////////////////////////////////////////////////////////
+    tTagRecords::const_iterator findTagRecord(std::uint64_t key) const;
+
+    /// \brief Return the requested buffer and the VR of
+    ///         its tag, or nullptr if the tag or the buffer
+    ///         don't exist.
+    ///
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<buffer> findBuffer(std::uint16_t groupId, std::uint32_t order, std::uint16_t tagId, size_t bufferId, tagVR_t& tagVR) const;
+
+    // All the tags in the dataset, sorted by group id,
+    //  group order and tag id.
+    // The tags are normally added in ascending order while
+    //  a stream is parsed, so they are just appended.
+    ///////////////////////////////////////////////////////////
+    tTagRecords m_tags;
+
+    // Arena used to allocate the tags' data and buffer
+    //  objects
+    ///////////////////////////////////////////////////////////
+    const std::shared_ptr<arena> m_pArena;
 
     std::shared_ptr<charsetsList_t> m_pCharsetsList;
 
     mutable std::recursive_mutex m_mutex;
+
+    // True when the reading methods don't need the lock
+    //  (see freeze())
+    ///////////////////////////////////////////////////////////
+    bool m_bFrozen;
 };
 
 
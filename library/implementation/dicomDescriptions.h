@@ -39,6 +39,14 @@ struct tagDescription_t
     tagVR_t m_vr0;                          ///< Default VR
     tagVR_t m_vr1;                          ///< Alternative VR
 };
+
+/// \brief Tags description, multiplicity and VR.
+///
+/// The table is terminated by an entry with the id 0xffffffff.
+/// dicomDictionary builds a sorted index of the tags that don't use
+///  a mask when it is constructed.
+///
+///////////////////////////////////////////////////////////////////////////////
 static const tagDescription_t m_tagsDescription[] = 
     {
         { 0x00000000, 0xffffffff, L"Command Group Length", "CommandGroupLength", 1, 1, 1, ::imebra::tagVR_t::UL, ::imebra::tagVR_t::UL },
@@ -272,6 +280,7 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x0008119A, 0xffffffff, L"Other Failures Sequence", "OtherFailuresSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
         { 0x00081200, 0xffffffff, L"Studies Containing Other Referenced Instances Sequence", "StudiesContainingOtherReferencedInstancesSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
         { 0x00081250, 0xffffffff, L"Related Series Sequence", "RelatedSeriesSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
+        { 0x00082110, 0xffffffff, L"Lossy Image Compression (Retired)", "LossyImageCompressionRetired", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00082111, 0xffffffff, L"Derivation Description", "DerivationDescription", 1, 1, 1, ::imebra::tagVR_t::ST, ::imebra::tagVR_t::ST },
         { 0x00082112, 0xffffffff, L"Source Image Sequence", "SourceImageSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
         { 0x00082120, 0xffffffff, L"Stage Name", "StageName", 1, 1, 1, ::imebra::tagVR_t::SH, ::imebra::tagVR_t::SH },
@@ -1514,7 +1523,6 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x00201206, 0xffffffff, L"Number of Study Related Series", "NumberOfStudyRelatedSeries", 1, 1, 1, ::imebra::tagVR_t::IS, ::imebra::tagVR_t::IS },
         { 0x00201208, 0xffffffff, L"Number of Study Related Instances", "NumberOfStudyRelatedInstances", 1, 1, 1, ::imebra::tagVR_t::IS, ::imebra::tagVR_t::IS },
         { 0x00201209, 0xffffffff, L"Number of Series Related Instances", "NumberOfSeriesRelatedInstances", 1, 1, 1, ::imebra::tagVR_t::IS, ::imebra::tagVR_t::IS },
-        { 0x00203100, 0xffffff00, L"Source Image IDs", "SourceImageIDs", 1, 0, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00203401, 0xffffffff, L"Modifying Device ID", "ModifyingDeviceID", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00203402, 0xffffffff, L"Modified Image ID", "ModifiedImageID", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00203403, 0xffffffff, L"Modified Image Date", "ModifiedImageDate", 1, 1, 1, ::imebra::tagVR_t::DA, ::imebra::tagVR_t::DA },
@@ -1914,10 +1922,6 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x00280302, 0xffffffff, L"Recognizable Visual Features", "RecognizableVisualFeatures", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00280303, 0xffffffff, L"Longitudinal Temporal Information Modified", "LongitudinalTemporalInformationModified", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00280304, 0xffffffff, L"Referenced Color Palette Instance UID", "ReferencedColorPaletteInstanceUID", 1, 1, 1, ::imebra::tagVR_t::UI, ::imebra::tagVR_t::UI },
-        { 0x00280400, 0xffffff0f, L"Rows For Nth Order Coefficients", "RowsForNthOrderCoefficients", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x00280401, 0xffffff0f, L"Columns For Nth Order Coefficients", "ColumnsForNthOrderCoefficients", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x00280402, 0xffffff0f, L"Coefficient Coding", "CoefficientCoding", 1, 0, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
-        { 0x00280403, 0xffffff0f, L"Coefficient Coding Pointers", "CoefficientCodingPointers", 1, 0, 1, ::imebra::tagVR_t::AT, ::imebra::tagVR_t::AT },
         { 0x00280404, 0xffffffff, L"Details of Coefficients", "DetailsOfCoefficients", 1, 0, 1, ::imebra::tagVR_t::AT, ::imebra::tagVR_t::AT },
         { 0x00280700, 0xffffffff, L"DCT Label", "DCTLabel", 1, 1, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
         { 0x00280701, 0xffffffff, L"Data Block Description", "DataBlockDescription", 1, 0, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
@@ -1928,11 +1932,6 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x00280722, 0xffffffff, L"Zonal Map Format", "ZonalMapFormat", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x00280730, 0xffffffff, L"Adaptive Map Format", "AdaptiveMapFormat", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x00280740, 0xffffffff, L"Code Number Format", "CodeNumberFormat", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x00280800, 0xffffff0f, L"Code Label", "CodeLabel", 1, 0, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
-        { 0x00280802, 0xffffff0f, L"Number of Tables", "NumberOfTables", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x00280803, 0xffffff0f, L"Code Table Location", "CodeTableLocation", 1, 0, 1, ::imebra::tagVR_t::AT, ::imebra::tagVR_t::AT },
-        { 0x00280804, 0xffffff0f, L"Bits For Code Word", "BitsForCodeWord", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x00280808, 0xffffff0f, L"Image Data Location", "ImageDataLocation", 1, 0, 1, ::imebra::tagVR_t::AT, ::imebra::tagVR_t::AT },
         { 0x00280A02, 0xffffffff, L"Pixel Spacing Calibration Type", "PixelSpacingCalibrationType", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00280A04, 0xffffffff, L"Pixel Spacing Calibration Description", "PixelSpacingCalibrationDescription", 1, 1, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
         { 0x00281040, 0xffffffff, L"Pixel Intensity Relationship", "PixelIntensityRelationship", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
@@ -1992,7 +1991,6 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x00281410, 0xffffffff, L"Alpha LUT Transfer Function", "AlphaLUTTransferFunction", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00282000, 0xffffffff, L"ICC Profile", "ICCProfile", 1, 1, 1, ::imebra::tagVR_t::OB, ::imebra::tagVR_t::OB },
         { 0x00282002, 0xffffffff, L"Color Space", "ColorSpace", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
-        { 0x00082110, 0xffffffff, L"Lossy Image Compression (Retired)", "LossyImageCompressionRetired", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00282110, 0xffffffff, L"Lossy Image Compression", "LossyImageCompression", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00282112, 0xffffffff, L"Lossy Image Compression Ratio", "LossyImageCompressionRatio", 1, 0, 1, ::imebra::tagVR_t::DS, ::imebra::tagVR_t::DS },
         { 0x00282114, 0xffffffff, L"Lossy Image Compression Method", "LossyImageCompressionMethod", 1, 0, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
@@ -2312,13 +2310,13 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x00402001, 0xffffffff, L"Reason for the Imaging Service Request", "ReasonForTheImagingServiceRequest", 1, 1, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
         { 0x00402004, 0xffffffff, L"Issue Date of Imaging Service Request", "IssueDateOfImagingServiceRequest", 1, 1, 1, ::imebra::tagVR_t::DA, ::imebra::tagVR_t::DA },
         { 0x00402005, 0xffffffff, L"Issue Time of Imaging Service Request", "IssueTimeOfImagingServiceRequest", 1, 1, 1, ::imebra::tagVR_t::TM, ::imebra::tagVR_t::TM },
+        { 0x00402006, 0xffffffff, L"Placer Order Number / Imaging Service Request (Retired)", "PlacerOrderNumberImagingServiceRequestRetired", 1, 1, 1, ::imebra::tagVR_t::SH, ::imebra::tagVR_t::SH },
+        { 0x00402007, 0xffffffff, L"Filler Order Number / Imaging Service Request (Retired)", "FillerOrderNumberImagingServiceRequestRetired", 1, 1, 1, ::imebra::tagVR_t::SH, ::imebra::tagVR_t::SH },
         { 0x00402008, 0xffffffff, L"Order Entered By", "OrderEnteredBy", 1, 1, 1, ::imebra::tagVR_t::PN, ::imebra::tagVR_t::PN },
         { 0x00402009, 0xffffffff, L"Order Enterer's Location", "OrderEntererLocation", 1, 1, 1, ::imebra::tagVR_t::SH, ::imebra::tagVR_t::SH },
         { 0x00402010, 0xffffffff, L"Order Callback Phone Number", "OrderCallbackPhoneNumber", 1, 1, 1, ::imebra::tagVR_t::SH, ::imebra::tagVR_t::SH },
         { 0x00402011, 0xffffffff, L"Order Callback Telecom Information", "OrderCallbackTelecomInformation", 1, 1, 1, ::imebra::tagVR_t::LT, ::imebra::tagVR_t::LT },
-        { 0x00402006, 0xffffffff, L"Placer Order Number / Imaging Service Request (Retired)", "PlacerOrderNumberImagingServiceRequestRetired", 1, 1, 1, ::imebra::tagVR_t::SH, ::imebra::tagVR_t::SH },
         { 0x00402016, 0xffffffff, L"Placer Order Number / Imaging Service Request", "PlacerOrderNumberImagingServiceRequest", 1, 1, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
-        { 0x00402007, 0xffffffff, L"Filler Order Number / Imaging Service Request (Retired)", "FillerOrderNumberImagingServiceRequestRetired", 1, 1, 1, ::imebra::tagVR_t::SH, ::imebra::tagVR_t::SH },
         { 0x00402017, 0xffffffff, L"Filler Order Number / Imaging Service Request", "FillerOrderNumberImagingServiceRequest", 1, 1, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
         { 0x00402400, 0xffffffff, L"Imaging Service Request Comments", "ImagingServiceRequestComments", 1, 1, 1, ::imebra::tagVR_t::LT, ::imebra::tagVR_t::LT },
         { 0x00403001, 0xffffffff, L"Confidentiality Constraint on Patient Data Description", "ConfidentialityConstraintOnPatientDataDescription", 1, 1, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
@@ -2970,8 +2968,8 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x00700022, 0xffffffff, L"Graphic Data", "GraphicData", 2, 0, 1, ::imebra::tagVR_t::FL, ::imebra::tagVR_t::FL },
         { 0x00700023, 0xffffffff, L"Graphic Type", "GraphicType", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00700024, 0xffffffff, L"Graphic Filled", "GraphicFilled", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
-        { 0x00700041, 0xffffffff, L"Image Horizontal Flip", "ImageHorizontalFlip", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00700040, 0xffffffff, L"Image Rotation (Retired)", "ImageRotationRetired", 1, 1, 1, ::imebra::tagVR_t::IS, ::imebra::tagVR_t::IS },
+        { 0x00700041, 0xffffffff, L"Image Horizontal Flip", "ImageHorizontalFlip", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x00700042, 0xffffffff, L"Image Rotation", "ImageRotation", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x00700050, 0xffffffff, L"Displayed Area Top Left Hand Corner (Trial)", "DisplayedAreaTopLeftHandCornerTrial", 2, 2, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x00700051, 0xffffffff, L"Displayed Area Bottom Right Hand Corner (Trial)", "DisplayedAreaBottomRightHandCornerTrial", 2, 2, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
@@ -3448,13 +3446,6 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x04000564, 0xffffffff, L"Source of Previous Values", "SourceOfPreviousValues", 1, 1, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
         { 0x04000565, 0xffffffff, L"Reason for the Attribute Modification", "ReasonForTheAttributeModification", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
         { 0x04000600, 0xffffffff, L"Instance Origin Status", "InstanceOriginStatus", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
-        { 0x10000000, 0xffff000f, L"Escape Triplet", "EscapeTriplet", 3, 3, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x10000001, 0xffff000f, L"Run Length Triplet", "RunLengthTriplet", 3, 3, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x10000002, 0xffff000f, L"Huffman Table Size", "HuffmanTableSize", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x10000003, 0xffff000f, L"Huffman Table Triplet", "HuffmanTableTriplet", 3, 3, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x10000004, 0xffff000f, L"Shift Table Size", "ShiftTableSize", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x10000005, 0xffff000f, L"Shift Table Triplet", "ShiftTableTriplet", 3, 3, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x10100000, 0xffff0000, L"Zonal Map", "ZonalMap", 1, 0, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x20000010, 0xffffffff, L"Number of Copies", "NumberOfCopies", 1, 1, 1, ::imebra::tagVR_t::IS, ::imebra::tagVR_t::IS },
         { 0x2000001E, 0xffffffff, L"Printer Configuration Sequence", "PrinterConfigurationSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
         { 0x20000020, 0xffffffff, L"Print Priority", "PrintPriority", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
@@ -4457,6 +4448,47 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x4010107D, 0xffffffff, L"Secondary Inspection Method Sequence", "SecondaryInspectionMethodSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
         { 0x4010107E, 0xffffffff, L"PRCS to RCS Orientation", "PRCSToRCSOrientation", 6, 6, 1, ::imebra::tagVR_t::DS, ::imebra::tagVR_t::DS },
         { 0x4FFE0001, 0xffffffff, L"MAC Parameters Sequence", "MACParametersSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
+        { 0x52009229, 0xffffffff, L"Shared Functional Groups Sequence", "SharedFunctionalGroupsSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
+        { 0x52009230, 0xffffffff, L"Per-frame Functional Groups Sequence", "PerFrameFunctionalGroupsSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
+        { 0x54000100, 0xffffffff, L"Waveform Sequence", "WaveformSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
+        { 0x54000110, 0xffffffff, L"Channel Minimum Value", "ChannelMinimumValue", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
+        { 0x54000112, 0xffffffff, L"Channel Maximum Value", "ChannelMaximumValue", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
+        { 0x54001004, 0xffffffff, L"Waveform Bits Allocated", "WaveformBitsAllocated", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x54001006, 0xffffffff, L"Waveform Sample Interpretation", "WaveformSampleInterpretation", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
+        { 0x5400100A, 0xffffffff, L"Waveform Padding Value", "WaveformPaddingValue", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
+        { 0x54001010, 0xffffffff, L"Waveform Data", "WaveformData", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
+        { 0x56000010, 0xffffffff, L"First Order Phase Correction Angle", "FirstOrderPhaseCorrectionAngle", 1, 1, 1, ::imebra::tagVR_t::OF, ::imebra::tagVR_t::OF },
+        { 0x56000020, 0xffffffff, L"Spectroscopy Data", "SpectroscopyData", 1, 1, 1, ::imebra::tagVR_t::OF, ::imebra::tagVR_t::OF },
+        { 0x7FE00001, 0xffffffff, L"Extended Offset Table", "ExtendedOffsetTable", 1, 1, 1, ::imebra::tagVR_t::OV, ::imebra::tagVR_t::OV },
+        { 0x7FE00002, 0xffffffff, L"Extended Offset Table Lengths", "ExtendedOffsetTableLengths", 1, 1, 1, ::imebra::tagVR_t::OV, ::imebra::tagVR_t::OV },
+        { 0x7FE00008, 0xffffffff, L"Float Pixel Data", "FloatPixelData", 1, 1, 1, ::imebra::tagVR_t::OF, ::imebra::tagVR_t::OF },
+        { 0x7FE00009, 0xffffffff, L"Double Float Pixel Data", "DoubleFloatPixelData", 1, 1, 1, ::imebra::tagVR_t::OD, ::imebra::tagVR_t::OD },
+        { 0x7FE00010, 0xffffffff, L"Pixel Data", "PixelData", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
+        { 0x7FE00020, 0xffffffff, L"Coefficients SDVN", "CoefficientsSDVN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
+        { 0x7FE00030, 0xffffffff, L"Coefficients SDHN", "CoefficientsSDHN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
+        { 0x7FE00040, 0xffffffff, L"Coefficients SDDN", "CoefficientsSDDN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
+        { 0xFFFAFFFA, 0xffffffff, L"Digital Signatures Sequence", "DigitalSignaturesSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
+        { 0xFFFCFFFC, 0xffffffff, L"Data Set Trailing Padding", "DataSetTrailingPadding", 1, 1, 1, ::imebra::tagVR_t::OB, ::imebra::tagVR_t::OB },
+        { 0xFFFEE000, 0xffffffff, L"Item", "Item", 1, 1, 1, ::imebra::tagVR_t::UN, ::imebra::tagVR_t::UN },
+        { 0xFFFEE00D, 0xffffffff, L"Item Delimitation Item", "ItemDelimitationItem", 1, 1, 1, ::imebra::tagVR_t::UN, ::imebra::tagVR_t::UN },
+        { 0xFFFEE0DD, 0xffffffff, L"Sequence Delimitation Item", "SequenceDelimitationItem", 1, 1, 1, ::imebra::tagVR_t::UN, ::imebra::tagVR_t::UN },
+        { 0x00203100, 0xffffff00, L"Source Image IDs", "SourceImageIDs", 1, 0, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
+        { 0x00280400, 0xffffff0f, L"Rows For Nth Order Coefficients", "RowsForNthOrderCoefficients", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x00280401, 0xffffff0f, L"Columns For Nth Order Coefficients", "ColumnsForNthOrderCoefficients", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x00280402, 0xffffff0f, L"Coefficient Coding", "CoefficientCoding", 1, 0, 1, ::imebra::tagVR_t::LO, ::imebra::tagVR_t::LO },
+        { 0x00280403, 0xffffff0f, L"Coefficient Coding Pointers", "CoefficientCodingPointers", 1, 0, 1, ::imebra::tagVR_t::AT, ::imebra::tagVR_t::AT },
+        { 0x00280800, 0xffffff0f, L"Code Label", "CodeLabel", 1, 0, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
+        { 0x00280802, 0xffffff0f, L"Number of Tables", "NumberOfTables", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x00280803, 0xffffff0f, L"Code Table Location", "CodeTableLocation", 1, 0, 1, ::imebra::tagVR_t::AT, ::imebra::tagVR_t::AT },
+        { 0x00280804, 0xffffff0f, L"Bits For Code Word", "BitsForCodeWord", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x00280808, 0xffffff0f, L"Image Data Location", "ImageDataLocation", 1, 0, 1, ::imebra::tagVR_t::AT, ::imebra::tagVR_t::AT },
+        { 0x10000000, 0xffff000f, L"Escape Triplet", "EscapeTriplet", 3, 3, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x10000001, 0xffff000f, L"Run Length Triplet", "RunLengthTriplet", 3, 3, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x10000002, 0xffff000f, L"Huffman Table Size", "HuffmanTableSize", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x10000003, 0xffff000f, L"Huffman Table Triplet", "HuffmanTableTriplet", 3, 3, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x10000004, 0xffff000f, L"Shift Table Size", "ShiftTableSize", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x10000005, 0xffff000f, L"Shift Table Triplet", "ShiftTableTriplet", 3, 3, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
+        { 0x10100000, 0xffff0000, L"Zonal Map", "ZonalMap", 1, 0, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x50000005, 0xff00ffff, L"Curve Dimensions", "CurveDimensions", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x50000010, 0xff00ffff, L"Number of Points", "NumberOfPoints", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x50000020, 0xff00ffff, L"Type of Data", "TypeOfData", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
@@ -4483,17 +4515,6 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x50002600, 0xff00ffff, L"Curve Referenced Overlay Sequence", "CurveReferencedOverlaySequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
         { 0x50002610, 0xff00ffff, L"Curve Referenced Overlay Group", "CurveReferencedOverlayGroup", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x50003000, 0xff00ffff, L"Curve Data", "CurveData", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
-        { 0x52009229, 0xffffffff, L"Shared Functional Groups Sequence", "SharedFunctionalGroupsSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
-        { 0x52009230, 0xffffffff, L"Per-frame Functional Groups Sequence", "PerFrameFunctionalGroupsSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
-        { 0x54000100, 0xffffffff, L"Waveform Sequence", "WaveformSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
-        { 0x54000110, 0xffffffff, L"Channel Minimum Value", "ChannelMinimumValue", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
-        { 0x54000112, 0xffffffff, L"Channel Maximum Value", "ChannelMaximumValue", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
-        { 0x54001004, 0xffffffff, L"Waveform Bits Allocated", "WaveformBitsAllocated", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
-        { 0x54001006, 0xffffffff, L"Waveform Sample Interpretation", "WaveformSampleInterpretation", 1, 1, 1, ::imebra::tagVR_t::CS, ::imebra::tagVR_t::CS },
-        { 0x5400100A, 0xffffffff, L"Waveform Padding Value", "WaveformPaddingValue", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
-        { 0x54001010, 0xffffffff, L"Waveform Data", "WaveformData", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
-        { 0x56000010, 0xffffffff, L"First Order Phase Correction Angle", "FirstOrderPhaseCorrectionAngle", 1, 1, 1, ::imebra::tagVR_t::OF, ::imebra::tagVR_t::OF },
-        { 0x56000020, 0xffffffff, L"Spectroscopy Data", "SpectroscopyData", 1, 1, 1, ::imebra::tagVR_t::OF, ::imebra::tagVR_t::OF },
         { 0x60000010, 0xff00ffff, L"Overlay Rows", "OverlayRows", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x60000011, 0xff00ffff, L"Overlay Columns", "OverlayColumns", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
         { 0x60000012, 0xff00ffff, L"Overlay Planes", "OverlayPlanes", 1, 1, 1, ::imebra::tagVR_t::US, ::imebra::tagVR_t::US },
@@ -4539,17 +4560,6 @@ static const tagDescription_t m_tagsDescription[] =
         { 0x7F000020, 0xff00ffff, L"Variable Coefficients SDVN", "VariableCoefficientsSDVN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
         { 0x7F000030, 0xff00ffff, L"Variable Coefficients SDHN", "VariableCoefficientsSDHN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
         { 0x7F000040, 0xff00ffff, L"Variable Coefficients SDDN", "VariableCoefficientsSDDN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
-        { 0x7FE00008, 0xffffffff, L"Float Pixel Data", "FloatPixelData", 1, 1, 1, ::imebra::tagVR_t::OF, ::imebra::tagVR_t::OF },
-        { 0x7FE00009, 0xffffffff, L"Double Float Pixel Data", "DoubleFloatPixelData", 1, 1, 1, ::imebra::tagVR_t::OD, ::imebra::tagVR_t::OD },
-        { 0x7FE00010, 0xffffffff, L"Pixel Data", "PixelData", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OB },
-        { 0x7FE00020, 0xffffffff, L"Coefficients SDVN", "CoefficientsSDVN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
-        { 0x7FE00030, 0xffffffff, L"Coefficients SDHN", "CoefficientsSDHN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
-        { 0x7FE00040, 0xffffffff, L"Coefficients SDDN", "CoefficientsSDDN", 1, 1, 1, ::imebra::tagVR_t::OW, ::imebra::tagVR_t::OW },
-        { 0xFFFAFFFA, 0xffffffff, L"Digital Signatures Sequence", "DigitalSignaturesSequence", 1, 1, 1, ::imebra::tagVR_t::SQ, ::imebra::tagVR_t::SQ },
-        { 0xFFFCFFFC, 0xffffffff, L"Data Set Trailing Padding", "DataSetTrailingPadding", 1, 1, 1, ::imebra::tagVR_t::OB, ::imebra::tagVR_t::OB },
-        { 0xFFFEE000, 0xffffffff, L"Item", "Item", 1, 1, 1, ::imebra::tagVR_t::UN, ::imebra::tagVR_t::UN },
-        { 0xFFFEE00D, 0xffffffff, L"Item Delimitation Item", "ItemDelimitationItem", 1, 1, 1, ::imebra::tagVR_t::UN, ::imebra::tagVR_t::UN },
-        { 0xFFFEE0DD, 0xffffffff, L"Sequence Delimitation Item", "SequenceDelimitationItem", 1, 1, 1, ::imebra::tagVR_t::UN, ::imebra::tagVR_t::UN },
 
         { 0xffffffff, 0xffffffff, 0, 0, 0, 0, 0, ::imebra::tagVR_t::OB, ::imebra::tagVR_t::OB}
     };
@@ -21,6 +21,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "dicomDictImpl.h"
 #include "dicomDescriptions.h"
 #include "../include/imebra/exceptions.h"
+#include <algorithm>
 
 namespace imebra
 {
@@ -46,62 +47,105 @@ namespace implementation
 ///////////////////////////////////////////////////////////
 //
 //
-// Constructor. Register all the known tags and VRs
+// Known VRs, sorted by enumeration value so they can be
+//  found with a binary search
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+static const dicomDictionary::validDataTypesStruct m_vrDescriptions[] =
+    {
+        { tagVR_t::AE, false, 0, 16 },
+        { tagVR_t::AS, false, 0, 0 },
+        { tagVR_t::AT, false, 4, 0 },
+        { tagVR_t::CS, false, 0, 16 },
+        { tagVR_t::DA, false, 0, 0 },
+        { tagVR_t::DS, false, 0, 16 },
+        { tagVR_t::DT, false, 0, 26 },
+        { tagVR_t::FD, false, 8, 0 },
+        { tagVR_t::FL, false, 4, 0 },
+        { tagVR_t::IS, false, 0, 12 },
+        { tagVR_t::LO, false, 0, 64 },
+        { tagVR_t::LT, false, 0, 10240 },
+        { tagVR_t::OB, true,  0, 0 },
+        { tagVR_t::OD, true,  8, 0 },
+        { tagVR_t::OF, true,  4, 0 },
+        { tagVR_t::OL, true,  4, 0 },
+        { tagVR_t::OV, true,  8, 0 },
+        { tagVR_t::OW, true,  2, 0 },
+        { tagVR_t::PN, false, 0, 64 },
+        { tagVR_t::SB, true,  0, 0 }, // Non standard. Used internally for signed bytes
+        { tagVR_t::SH, false, 0, 16 },
+        { tagVR_t::SL, false, 4, 0 },
+        { tagVR_t::SQ, true,  0, 0 },
+        { tagVR_t::SS, false, 2, 0 },
+        { tagVR_t::ST, false, 0, 1024 },
+        { tagVR_t::TM, false, 0, 16 },
+        { tagVR_t::UC, true,  0, 0 },
+        { tagVR_t::UI, false, 0, 64 },
+        { tagVR_t::UL, false, 4, 0 },
+        { tagVR_t::UN, true,  0, 0 },
+        { tagVR_t::UR, true,  0, 0 },
+        { tagVR_t::US, false, 2, 0 },
+        { tagVR_t::UT, true,  0, 0 }
+    };
+
+static const size_t vrDescriptionsSize(sizeof(m_vrDescriptions) / sizeof(m_vrDescriptions[0]));
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Constructor. Build the sorted index of the tags that
+//  don't use a mask from the static tags table
 //
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 dicomDictionary::dicomDictionary()
 {
-    IMEBRA_FUNCTION_START();
+    for(const tagDescription_t* pDescription(m_tagsDescription); pDescription->m_tagId != (std::uint32_t)0xffffffff; ++pDescription)
+    {
+        if(pDescription->m_tagMask == (std::uint32_t)0xffffffff)
+        {
+            tagIndex_t index = {pDescription->m_tagId, pDescription->m_vr0, pDescription};
+            m_tagsIndex.push_back(index);
+        }
+        else
+        {
+            m_maskedTags.push_back(pDescription);
+        }
+    }
 
-    registerVR(tagVR_t::AE, false, 0, 16);
-    registerVR(tagVR_t::AS, false, 0, 0);
-    registerVR(tagVR_t::AT, false, 4, 0);
-    registerVR(tagVR_t::CS, false, 0, 16);
-    registerVR(tagVR_t::DA, false, 0, 0);
-    registerVR(tagVR_t::DS, false, 0, 16);
-    registerVR(tagVR_t::DT, false, 0, 26);
-    registerVR(tagVR_t::FL, false, 4, 0);
-    registerVR(tagVR_t::FD, false, 8, 0);
-    registerVR(tagVR_t::IS, false, 0, 12);
-    registerVR(tagVR_t::LO, false, 0, 64);
-    registerVR(tagVR_t::LT, false, 0, 10240);
-    registerVR(tagVR_t::OB, true,  0, 0);
-    registerVR(tagVR_t::SB, true,  0, 0); // Non standard. Used internally for signed bytes
-    registerVR(tagVR_t::OD, true,  8, 0);
-    registerVR(tagVR_t::OF, true,  4, 0);
-    registerVR(tagVR_t::OL, true,  4, 0);
-    registerVR(tagVR_t::OW, true,  2, 0);
-    registerVR(tagVR_t::PN, false, 0, 64);
-    registerVR(tagVR_t::SH, false, 0, 16);
-    registerVR(tagVR_t::SL, false, 4, 0);
-    registerVR(tagVR_t::SQ, true,  0, 0);
-    registerVR(tagVR_t::SS, false, 2, 0);
-    registerVR(tagVR_t::ST, false, 0, 1024);
-    registerVR(tagVR_t::TM, false, 0, 16);
-    registerVR(tagVR_t::UC, true, 0, 0);
-    registerVR(tagVR_t::UI, false, 0, 64);
-    registerVR(tagVR_t::UL, false, 4, 0);
-    registerVR(tagVR_t::UN, true,  0, 0);
-    registerVR(tagVR_t::UR, true, 0, 0);
-    registerVR(tagVR_t::US, false, 2, 0);
-    registerVR(tagVR_t::UT, true, 0, 0);
-
-    for(size_t scanDescriptions(0); m_tagsDescription[scanDescriptions].m_tagId != (std::uint32_t)0xffffffff; ++scanDescriptions)
+    std::stable_sort(m_tagsIndex.begin(), m_tagsIndex.end(), [](const tagIndex_t& left, const tagIndex_t& right)
     {
-        registerTag(m_tagsDescription[scanDescriptions].m_tagId,
-                    m_tagsDescription[scanDescriptions].m_tagMask,
-                    m_tagsDescription[scanDescriptions].m_tagDescription,
-                    m_tagsDescription[scanDescriptions].m_tagKeyword,
-                    m_tagsDescription[scanDescriptions].m_vr0, m_tagsDescription[scanDescriptions].m_vr1,
-                    m_tagsDescription[scanDescriptions].m_multiplicityMin,
-                    m_tagsDescription[scanDescriptions].m_multiplicityMax,
-                    m_tagsDescription[scanDescriptions].m_multiplicityStep);
+        return left.m_tagId < right.m_tagId;
+    });
+}
 
-    }
 
-    IMEBRA_FUNCTION_END();
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Find a tag in the sorted index
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+const dicomDictionary::tagIndex_t* dicomDictionary::findTagIndex(std::uint32_t tagDWordId) const
+{
+    std::vector<tagIndex_t>::const_iterator findIndex(std::lower_bound(m_tagsIndex.begin(), m_tagsIndex.end(), tagDWordId, [](const tagIndex_t& index, std::uint32_t tagId)
+    {
+        return index.m_tagId < tagId;
+    }));
+
+    if(findIndex == m_tagsIndex.end() || findIndex->m_tagId != tagDWordId)
+    {
+        return 0;
+    }
+    return &(*findIndex);
 }
 
 
@@ -109,40 +153,33 @@ dicomDictionary::dicomDictionary()
 ///////////////////////////////////////////////////////////
 //
 //
-// Register a tag
+// Find the description of a tag.
+// The tags without a mask are located with a binary
+//  search in the sorted index, then the few tags
+//  defined through a mask are scanned
 //
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-void dicomDictionary::registerTag(std::uint32_t tagId,
-                                  std::uint32_t tagMask,
-                                  const wchar_t* tagName,
-                                  const char* tagKeyword,
-                                  tagVR_t vr0, tagVR_t vr1,
-                                  std::uint32_t multiplicityMin, std::uint32_t multiplicityMax, std::uint32_t multiplicityStep)
+const tagDescription_t* dicomDictionary::findTag(std::uint16_t groupId, std::uint16_t tagId) const
 {
-    IMEBRA_FUNCTION_START();
+    const std::uint32_t tagDWordId=(((std::uint32_t)groupId)<<16) | (std::uint32_t)tagId;
 
-    std::uint32_t increaseValue = 1u;
-    while(tagMask != 0xffffffff && (increaseValue & tagMask) != 0)
+    const tagIndex_t* pIndex(findTagIndex(tagDWordId));
+    if(pIndex != 0)
     {
-        increaseValue <<= 1;
+        return pIndex->m_pDescription;
     }
 
-    for(std::uint32_t registerTagId(tagId); (registerTagId & tagMask) == tagId; registerTagId += increaseValue)
+    for(const tagDescription_t* pMaskedTag: m_maskedTags)
     {
-        imageDataDictionaryElement newElement;
-        newElement.m_tagDescription = tagName;
-        newElement.m_tagKeyword = tagKeyword;
-        newElement.m_vr0 = vr0;
-        newElement.m_vr1 = vr1;
-        newElement.m_multiplicityMin = multiplicityMin;
-        newElement.m_multiplicityMax = multiplicityMax;
-        newElement.m_multiplicityStep = multiplicityStep;
-        m_dicomDict[registerTagId] = newElement;
+        if((tagDWordId & pMaskedTag->m_tagMask) == pMaskedTag->m_tagId)
+        {
+            return pMaskedTag;
+        }
     }
 
-    IMEBRA_FUNCTION_END();
+    return 0;
 }
 
 
@@ -150,30 +187,61 @@ void dicomDictionary::registerTag(std::uint32_t tagId,
 ///////////////////////////////////////////////////////////
 //
 //
-// Register a VR
+// Find the description of a tag. Throws if the tag
+//  is unknown
 //
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-void dicomDictionary::registerVR(tagVR_t vr, bool bLongLength, std::uint32_t wordSize, std::uint32_t maxLength)
+const tagDescription_t& dicomDictionary::getTag(std::uint16_t groupId, std::uint16_t tagId) const
 {
     IMEBRA_FUNCTION_START();
 
-    if(m_vrDict.find(vr) != m_vrDict.end())
+    const tagDescription_t* pDescription(findTag(groupId, tagId));
+    if(pDescription == 0)
     {
-        IMEBRA_THROW(std::logic_error, "VR registered twice");
+        IMEBRA_THROW(DictionaryUnknownTagError, "Unknown tag " << std::hex << groupId << ", " << std::hex << tagId);
     }
-    validDataTypesStruct newElement;
-    newElement.m_longLength = bLongLength;
-    newElement.m_wordLength = wordSize;
-    newElement.m_maxLength = maxLength;
 
-    m_vrDict[vr] = newElement;
+    return *pDescription;
 
     IMEBRA_FUNCTION_END();
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Find the description of a VR
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+const dicomDictionary::validDataTypesStruct* dicomDictionary::findVR(tagVR_t dataType) const
+{
+    size_t low(0), high(vrDescriptionsSize);
+    while(low != high)
+    {
+        const size_t middle((low + high) / 2);
+        if(m_vrDescriptions[middle].m_vr < dataType)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if(low != vrDescriptionsSize && m_vrDescriptions[low].m_vr == dataType)
+    {
+        return &(m_vrDescriptions[low]);
+    }
+
+    return 0;
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -187,15 +255,7 @@ std::wstring dicomDictionary::getTagDescription(std::uint16_t groupId, std::uint
 {
     IMEBRA_FUNCTION_START();
 
-    std::uint32_t tagDWordId=(((std::uint32_t)groupId)<<16) | (std::uint32_t)tagId;
-
-    tDicomDictionary::const_iterator findIterator = m_dicomDict.find(tagDWordId);
-    if(findIterator == m_dicomDict.end())
-    {
-        IMEBRA_THROW(DictionaryUnknownTagError, "Unknown tag " << std::hex << groupId << ", " << std::hex << tagId);
-    }
-
-    return findIterator->second.m_tagDescription;
+    return getTag(groupId, tagId).m_tagDescription;
 
     IMEBRA_FUNCTION_END();
 }
@@ -205,15 +265,7 @@ std::uint32_t dicomDictionary::getTagMultiplicityMin(std::uint16_t groupId, std:
 {
     IMEBRA_FUNCTION_START();
 
-    std::uint32_t tagDWordId=(((std::uint32_t)groupId)<<16) | (std::uint32_t)tagId;
-
-    tDicomDictionary::const_iterator findIterator = m_dicomDict.find(tagDWordId);
-    if(findIterator == m_dicomDict.end())
-    {
-        IMEBRA_THROW(DictionaryUnknownTagError, "Unknown tag " << std::hex << groupId << ", " << std::hex << tagId);
-    }
-
-    return findIterator->second.m_multiplicityMin;
+    return getTag(groupId, tagId).m_multiplicityMin;
 
     IMEBRA_FUNCTION_END();
 }
@@ -223,15 +275,7 @@ std::uint32_t dicomDictionary::getTagMultiplicityMax(std::uint16_t groupId, std:
 {
     IMEBRA_FUNCTION_START();
 
-    std::uint32_t tagDWordId=(((std::uint32_t)groupId)<<16) | (std::uint32_t)tagId;
-
-    tDicomDictionary::const_iterator findIterator = m_dicomDict.find(tagDWordId);
-    if(findIterator == m_dicomDict.end())
-    {
-        IMEBRA_THROW(DictionaryUnknownTagError, "Unknown tag " << std::hex << groupId << ", " << std::hex << tagId);
-    }
-
-    return findIterator->second.m_multiplicityMax;
+    return getTag(groupId, tagId).m_multiplicityMax;
 
     IMEBRA_FUNCTION_END();
 }
@@ -241,15 +285,7 @@ std::uint32_t dicomDictionary::getTagMultiplicityStep(std::uint16_t groupId, std
 {
     IMEBRA_FUNCTION_START();
 
-    std::uint32_t tagDWordId=(((std::uint32_t)groupId)<<16) | (std::uint32_t)tagId;
-
-    tDicomDictionary::const_iterator findIterator = m_dicomDict.find(tagDWordId);
-    if(findIterator == m_dicomDict.end())
-    {
-        IMEBRA_THROW(DictionaryUnknownTagError, "Unknown tag " << std::hex << groupId << ", " << std::hex << tagId);
-    }
-
-    return findIterator->second.m_multiplicityStep;
+    return getTag(groupId, tagId).m_multiplicityStep;
 
     IMEBRA_FUNCTION_END();
 }
@@ -268,44 +304,81 @@ tagVR_t dicomDictionary::getTagType(std::uint16_t groupId, std::uint16_t tagId)
 {
     IMEBRA_FUNCTION_START();
 
-    std::uint32_t tagDWordId=(((std::uint32_t)groupId)<<16) | (std::uint32_t)tagId;
-
-    tDicomDictionary::const_iterator findIterator = m_dicomDict.find(tagDWordId);
-    if(findIterator == m_dicomDict.end())
+    tagVR_t vr;
+    if(!findTagType(groupId, tagId, vr))
     {
         IMEBRA_THROW(DictionaryUnknownTagError, "Unknown tag " << std::hex << groupId << ", " << std::hex << tagId);
     }
 
-    return findIterator->second.m_vr0;
+    return vr;
 
     IMEBRA_FUNCTION_END();
 }
 
 
-bool dicomDictionary::isDataTypeValid(const std::string& dataType) const
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return the default type for the specified tag, or
+//  false if the tag is unknown
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+bool dicomDictionary::findTagType(std::uint16_t groupId, std::uint16_t tagId, tagVR_t& vr) const
 {
-    try
+    // The index holds the VR: the descriptions are read only
+    //  for the tags defined through a mask
+    ///////////////////////////////////////////////////////////
+    const tagIndex_t* pIndex(findTagIndex((((std::uint32_t)groupId)<<16) | (std::uint32_t)tagId));
+    if(pIndex != 0)
     {
-        stringDataTypeToEnum(dataType);
+        vr = pIndex->m_vr;
         return true;
     }
-    catch(const DictionaryUnknownDataTypeError&)
+
+    const tagDescription_t* pDescription(findTag(groupId, tagId));
+    if(pDescription == 0)
     {
         return false;
     }
+
+    vr = pDescription->m_vr0;
+    return true;
 }
 
 
-tagVR_t dicomDictionary::stringDataTypeToEnum(const std::string& dataType) const
+bool dicomDictionary::isDataTypeValid(const std::string& dataType) const
 {
-    std::uint16_t enumVR = MAKE_VR_ENUM(dataType);
+    tagVR_t vr;
+    return dataType.size() >= 2 && findDataType(dataType.data(), vr);
+}
+
 
-    if(m_vrDict.find((tagVR_t)enumVR) == m_vrDict.end())
+tagVR_t dicomDictionary::stringDataTypeToEnum(const std::string& dataType) const
+{
+    tagVR_t vr;
+    if(dataType.size() < 2 || !findDataType(dataType.data(), vr))
     {
         IMEBRA_THROW(DictionaryUnknownDataTypeError, "Unknown data type " << dataType);
     }
 
-    return (tagVR_t)enumVR;
+    return vr;
+}
+
+
+bool dicomDictionary::findDataType(const char* dataType, tagVR_t& vr) const
+{
+    const tagVR_t enumVR((tagVR_t)MAKE_VR_ENUM(dataType));
+
+    if(findVR(enumVR) == 0)
+    {
+        return false;
+    }
+
+    vr = enumVR;
+    return true;
 }
 
 
@@ -330,14 +403,14 @@ std::string dicomDictionary::enumDataTypeToString(tagVR_t dataType) const
 ///////////////////////////////////////////////////////////
 bool dicomDictionary::getLongLength(tagVR_t dataType) const
 {
-    tVRDictionary::const_iterator findIterator = m_vrDict.find(dataType);
+    const validDataTypesStruct* pVR(findVR(dataType));
 
-    if(findIterator == m_vrDict.end())
+    if(pVR == 0)
     {
         return false;
     }
 
-    return findIterator->second.m_longLength;
+    return pVR->m_longLength;
 }
 
 
@@ -354,14 +427,14 @@ std::uint32_t dicomDictionary::getWordSize(tagVR_t dataType) const
 {
     IMEBRA_FUNCTION_START();
 
-    tVRDictionary::const_iterator findIterator = m_vrDict.find(dataType);
+    const validDataTypesStruct* pVR(findVR(dataType));
 
-    if(findIterator == m_vrDict.end())
+    if(pVR == 0)
     {
         IMEBRA_THROW(DictionaryUnknownDataTypeError, "Unregistered data type" << (std::uint16_t)dataType);
     }
 
-    return findIterator->second.m_wordLength;
+    return pVR->m_wordLength;
 
     IMEBRA_FUNCTION_END();
 }
@@ -381,14 +454,14 @@ std::uint32_t dicomDictionary::getMaxSize(tagVR_t dataType) const
 {
     IMEBRA_FUNCTION_START();
 
-    tVRDictionary::const_iterator findIterator = m_vrDict.find(dataType);
+    const validDataTypesStruct* pVR(findVR(dataType));
 
-    if(findIterator == m_vrDict.end())
+    if(pVR == 0)
     {
         IMEBRA_THROW(DictionaryUnknownDataTypeError, "Unregistered data type " << (std::uint16_t)dataType);
     }
 
-    return findIterator->second.m_maxLength;
+    return pVR->m_maxLength;
 
     IMEBRA_FUNCTION_END();
 }
@@ -21,7 +21,8 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #define imebraDicomDict_CC44A2C5_2B8C_42c1_9704_3F9C582643B9__INCLUDED_
 
 #include <memory>
-#include <map>
+#include <string>
+#include <vector>
 #include "../include/imebra/definitions.h"
 
 namespace imebra
@@ -30,6 +31,8 @@ namespace imebra
 namespace implementation
 {
 
+struct tagDescription_t;
+
 /// \addtogroup group_dictionary Dicom dictionary
 ///
 /// @{
@@ -52,34 +55,15 @@ class dicomDictionary
 {
     dicomDictionary();
 
-    struct imageDataDictionaryElement
-    {
-        std::wstring m_tagDescription;
-        std::string m_tagKeyword;
-        tagVR_t m_vr0;
-        tagVR_t m_vr1;
-        std::uint32_t m_multiplicityMin;
-        std::uint32_t m_multiplicityMax;
-        std::uint32_t m_multiplicityStep;
-    };
-
+public:
     struct validDataTypesStruct
     {
+        tagVR_t m_vr;                     // The data type
         bool  m_longLength;       // true if the tag has a 4 bytes length descriptor
         std::uint32_t m_wordLength;       // Word's length, used for byte reversing in hi/lo endian conversion
         std::uint32_t m_maxLength;        // The maximum length for the tag. An exception will be trown while reading a tag which exceedes this size
     };
 
-public:
-    void registerTag(std::uint32_t tagId,
-                     std::uint32_t tagMask,
-                     const wchar_t* tagName,
-                     const char* tagKeyword,
-                     tagVR_t vr0, tagVR_t vr1,
-                     std::uint32_t multiplicityMin, std::uint32_t multiplicityMax, std::uint32_t multiplicityStep);
-
-    void registerVR(tagVR_t vr, bool bLongLength, std::uint32_t wordSize, std::uint32_t maxLength);
-
     /// \brief Retrieve a tag's description.
     ///
     /// @param groupId   The group which the tag belongs to
@@ -102,6 +86,23 @@ public:
     ///////////////////////////////////////////////////////////
     tagVR_t getTagType(std::uint16_t groupId, std::uint16_t tagId) const;
 
+    /// \brief Retrieve a tag's default data type without
+    ///         throwing if the tag is not in the dictionary.
+    ///
+    /// Used by the parser, which must handle private and
+    ///  unknown tags at a table lookup's cost.
+    ///
+    /// @param groupId   The group which the tag belongs to
+    /// @param tagId     The tag's id
+    /// @param vr        receives the tag's data type when
+    ///                   the function returns true, is left
+    ///                   untouched otherwise
+    /// @return          true if the tag is in the dictionary,
+    ///                   false otherwise
+    ///
+    ///////////////////////////////////////////////////////////
+    bool findTagType(std::uint16_t groupId, std::uint16_t tagId, tagVR_t& vr) const;
+
     /// \brief Retrieve the only valid instance of this class.
     ///
     /// @return a pointer to the dicom dictionary
@@ -112,6 +113,22 @@ public:
     bool isDataTypeValid(const std::string& dataType) const;
 
     tagVR_t stringDataTypeToEnum(const std::string& dataType) const;
+
+    /// \brief Convert a 2 characters data type into the
+    ///         corresponding enumeration without throwing
+    ///         if the data type is not registered.
+    ///
+    /// @param dataType  pointer to the 2 characters of the
+    ///                   data type (not null terminated)
+    /// @param vr        receives the data type when the
+    ///                   function returns true, is left
+    ///                   untouched otherwise
+    /// @return          true if the data type is valid,
+    ///                   false otherwise
+    ///
+    ///////////////////////////////////////////////////////////
+    bool findDataType(const char* dataType, tagVR_t& vr) const;
+
     std::string enumDataTypeToString(tagVR_t dataType) const;
 
     /// \brief Return true if the tag's length in the dicom
@@ -145,11 +162,66 @@ public:
     std::uint32_t getMaxSize(tagVR_t dataType) const;
 
 protected:
-    typedef std::map<std::uint32_t, imageDataDictionaryElement> tDicomDictionary;
-    tDicomDictionary m_dicomDict;
+    /// \brief Find a tag's description.
+    ///
+    /// @param groupId   The group which the tag belongs to
+    /// @param tagId     The tag's id
+    /// @return          a pointer to the tag's description,
+    ///                   or 0 if the tag is unknown
+    ///
+    ///////////////////////////////////////////////////////////
+    const tagDescription_t* findTag(std::uint16_t groupId, std::uint16_t tagId) const;
+
+    /// \brief Find a tag's description, throw
+    ///         DictionaryUnknownTagError if the tag is
+    ///         unknown.
+    ///
+    /// @param groupId   The group which the tag belongs to
+    /// @param tagId     The tag's id
+    /// @return          the tag's description
+    ///
+    ///////////////////////////////////////////////////////////
+    const tagDescription_t& getTag(std::uint16_t groupId, std::uint16_t tagId) const;
+
+    /// \brief Find a VR's description.
+    ///
+    /// @param dataType  the VR
+    /// @return          a pointer to the VR's description,
+    ///                   or 0 if the VR is unknown
+    ///
+    ///////////////////////////////////////////////////////////
+    const validDataTypesStruct* findVR(tagVR_t dataType) const;
 
-    typedef std::map<tagVR_t, validDataTypesStruct> tVRDictionary;
-    tVRDictionary m_vrDict;
+    /// \brief An entry of the tags index.
+    ///
+    ///////////////////////////////////////////////////////////
+    struct tagIndex_t
+    {
+        std::uint32_t m_tagId;                   // Tag group and id
+        tagVR_t m_vr;                            // Default VR
+        const tagDescription_t* m_pDescription;  // Tag description
+    };
+
+    // Tags that don't use a mask, sorted by id. Built by the
+    //  constructor from the table in dicomDescriptions.h and
+    //  used by the parser to find the tags' VRs
+    ///////////////////////////////////////////////////////////
+    std::vector<tagIndex_t> m_tagsIndex;
+
+    // Tags defined through a mask, scanned when a tag is not
+    //  in m_tagsIndex
+    ///////////////////////////////////////////////////////////
+    std::vector<const tagDescription_t*> m_maskedTags;
+
+    /// \brief Find a tag in m_tagsIndex.
+    ///
+    /// @param tagDWordId the tag's group (high word) and id
+    ///                   (low word)
+    /// @return          a pointer to the index entry, or 0 if
+    ///                   the tag is not in the index
+    ///
+    ///////////////////////////////////////////////////////////
+    const tagIndex_t* findTagIndex(std::uint32_t tagDWordId) const;
 
 };
 
@@ -82,37 +82,7 @@ std::shared_ptr<image> dicomNativeImageCodec::getImage(const std::string& /* tra
 
     // Create an image
     ///////////////////////////////////////////////////////////
-    bitDepth_t depth;
-    if(b2Complement)
-    {
-        if(highBit >= 16)
-        {
-            depth = bitDepth_t::depthS32;
-        }
-        else if(highBit >= 8)
-        {
-            depth = bitDepth_t::depthS16;
-        }
-        else
-        {
-            depth = bitDepth_t::depthS8;
-        }
-    }
-    else
-    {
-        if(highBit >= 16)
-        {
-            depth = bitDepth_t::depthU32;
-        }
-        else if(highBit >= 8)
-        {
-            depth = bitDepth_t::depthU16;
-        }
-        else
-        {
-            depth = bitDepth_t::depthU8;
-        }
-    }
+    const bitDepth_t depth(getImageDepth(b2Complement, highBit));
 
     std::shared_ptr<image> pImage(std::make_shared<image>(imageWidth, imageHeight, depth, colorSpace, highBit));
     std::uint32_t tempChannelsNumber = pImage->getChannelsNumber();
@@ -190,40 +160,27 @@ std::shared_ptr<image> dicomNativeImageCodec::getImage(const std::string& /* tra
         }
         else
         {
-            std::vector<std::shared_ptr<channel>> subsampledChannels = allocChannels(3, imageWidth, imageHeight, bSubSampledX, bSubSampledY);
-
             if(allocatedBits != 1)
             {
                 size_t imageSizeBytes = nativeImageSizeBits / 8;
                 std::shared_ptr<memory> pStreamMemory = std::make_shared<memory>(imageSizeBytes);
                 pSourceStream->read(pStreamMemory->data(), pStreamMemory->size());
-                readInterleavedSubsampled<std::int32_t>(subsampledChannels, allocatedBits, pStreamMemory->data());
-
-                std::uint32_t maxSamplingFactorX = bSubSampledX ? 2u : 1u;
-                std::uint32_t maxSamplingFactorY = bSubSampledY ? 2u : 1u;
-
-                for(std::uint32_t copyChannels = 0; copyChannels < channelsNumber; ++copyChannels)
+                readInterleavedSubsampled(
+                            imageHandler->getMemoryBuffer(),
+                            allocatedBits,
+                            pImage->getDepth(),
+                            pStreamMemory->data(),
+                            imageWidth,
+                            imageHeight,
+                            channelsNumber,
+                            bSubSampledX,
+                            bSubSampledY);
+
+                // Adjust b2complement buffers
+                ///////////////////////////////////////////////////////////
+                if(b2Complement)
                 {
-                    std::shared_ptr<channel> pChannel = subsampledChannels[copyChannels];
-
-                    // Adjust b2complement buffers
-                    ///////////////////////////////////////////////////////////
-                    if(b2Complement)
-                    {
-                        adjustB2Complement(pChannel->m_memory->data(), highBit, bitDepth_t::depthS32, pChannel->m_memory->size() / sizeof(std::uint32_t));
-                    }
-
-                    imageHandler->copyFromInt32Interleaved(
-                                pChannel->m_pBuffer,
-                                maxSamplingFactorX / pChannel->m_samplingFactorX,
-                                maxSamplingFactorY / pChannel->m_samplingFactorY,
-                                0, 0,
-                                pChannel->m_width * (maxSamplingFactorX /pChannel->m_samplingFactorX),
-                                pChannel->m_height * (maxSamplingFactorY /pChannel->m_samplingFactorY),
-                                copyChannels,
-                                imageWidth,
-                                imageHeight,
-                                channelsNumber);
+                    adjustB2Complement(imageHandler->getMemoryBuffer(), highBit, depth, imageHandler->getSize());
                 }
             }
             else
@@ -242,6 +199,130 @@ std::shared_ptr<image> dicomNativeImageCodec::getImage(const std::string& /* tra
 }
 
 
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+//
+//
+// Get a region of a DICOM raw image from a dicom structure
+//
+//
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+std::shared_ptr<image> dicomNativeImageCodec::getImageRegion(const std::string& transferSyntax,
+                                                             const std::string& colorSpace,
+                                                             std::uint32_t channelsNumber,
+                                                             std::uint32_t imageWidth,
+                                                             std::uint32_t imageHeight,
+                                                             bool bSubSampledX,
+                                                             bool bSubSampledY,
+                                                             bool bInterleaved,
+                                                             bool b2Complement,
+                                                             std::uint8_t allocatedBits,
+                                                             std::uint8_t storedBits,
+                                                             std::uint8_t highBit,
+                                                             std::shared_ptr<streamReader> pSourceStream,
+                                                             std::uint32_t regionLeft,
+                                                             std::uint32_t regionTop,
+                                                             std::uint32_t regionWidth,
+                                                             std::uint32_t regionHeight) const
+{
+    IMEBRA_FUNCTION_START();
+
+    // Only the not subsampled images with whole bytes per
+    //  sample and all the channels in the same pixel can be
+    //  read row by row
+    ///////////////////////////////////////////////////////////
+    if(bSubSampledX || bSubSampledY || (!bInterleaved && channelsNumber != 1) ||
+            allocatedBits == 0 || (allocatedBits % 8) != 0 || !pSourceStream->seekable())
+    {
+        return imageCodec::getImageRegion(transferSyntax, colorSpace, channelsNumber, imageWidth, imageHeight,
+                                          bSubSampledX, bSubSampledY, bInterleaved, b2Complement,
+                                          allocatedBits, storedBits, highBit, pSourceStream,
+                                          regionLeft, regionTop, regionWidth, regionHeight);
+    }
+
+    const bitDepth_t depth(getImageDepth(b2Complement, highBit));
+
+    std::shared_ptr<image> pImage(std::make_shared<image>(regionWidth, regionHeight, depth, colorSpace, highBit));
+    if(pImage->getChannelsNumber() != channelsNumber)
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Wrong number of channels");
+    }
+
+    std::shared_ptr<handlers::writingDataHandlerNumericBase> imageHandler = pImage->getWritingDataHandler();
+
+    // Read only the bytes of the rows inside the region
+    ///////////////////////////////////////////////////////////
+    const size_t pixelSizeBytes(static_cast<size_t>(allocatedBits / 8) * channelsNumber);
+    const size_t sourceRowSizeBytes(pixelSizeBytes * imageWidth);
+    const size_t regionRowSizeBytes(pixelSizeBytes * regionWidth);
+    const size_t imageRowSizeBytes(imageHandler->getUnitSize() * channelsNumber * regionWidth);
+
+    std::shared_ptr<memory> pRowMemory = std::make_shared<memory>(regionRowSizeBytes);
+    std::uint8_t* pImageRow(imageHandler->getMemoryBuffer());
+    for(std::uint32_t scanRow(0); scanRow != regionHeight; ++scanRow)
+    {
+        pSourceStream->seek(sourceRowSizeBytes * (regionTop + scanRow) + pixelSizeBytes * regionLeft);
+        pSourceStream->read(pRowMemory->data(), regionRowSizeBytes);
+
+        readInterleavedNotSubsampled(
+                    pImageRow,
+                    allocatedBits,
+                    depth,
+                    pRowMemory->data(),
+                    regionWidth,
+                    channelsNumber
+                    );
+        pImageRow += imageRowSizeBytes;
+    }
+
+    if(b2Complement)
+    {
+        adjustB2Complement(imageHandler->getMemoryBuffer(), highBit, depth, imageHandler->getSize());
+    }
+
+    return pImage;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+//
+//
+// Return the depth of the image that stores the samples
+//
+//
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+bitDepth_t dicomNativeImageCodec::getImageDepth(bool b2Complement, std::uint8_t highBit)
+{
+    if(b2Complement)
+    {
+        if(highBit >= 16)
+        {
+            return bitDepth_t::depthS32;
+        }
+        if(highBit >= 8)
+        {
+            return bitDepth_t::depthS16;
+        }
+        return bitDepth_t::depthS8;
+    }
+
+    if(highBit >= 16)
+    {
+        return bitDepth_t::depthU32;
+    }
+    if(highBit >= 8)
+    {
+        return bitDepth_t::depthU16;
+    }
+    return bitDepth_t::depthU8;
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -355,13 +436,20 @@ void dicomNativeImageCodec::setImage(
     }
     else
     {
-        std::vector<std::shared_ptr<channel>> subsampledChannels = splitImageIntoChannels(pImage, bSubSampledX, bSubSampledY);
-
         if(allocatedBits != 1)
         {
             size_t imageSizeBytes = nativeImageSizeBits / 8;
             std::shared_ptr<memory> pStreamMemory = std::make_shared<memory>(imageSizeBytes);
-            writeInterleavedSubsampled<std::int32_t>(subsampledChannels, allocatedBits, pStreamMemory->data());
+            writeInterleavedSubsampled(
+                        imageHandler->getMemoryBuffer(),
+                        allocatedBits,
+                        pImage->getDepth(),
+                        pStreamMemory->data(),
+                        imageWidth,
+                        imageHeight,
+                        channelsNumber,
+                        bSubSampledX,
+                        bSubSampledY);
 
             pDestStream->write(pStreamMemory->data(), imageSizeBytes);
         }
@@ -504,6 +592,76 @@ void dicomNativeImageCodec::readNotInterleavedNotSubsampled(
 }
 
 
+void dicomNativeImageCodec::writeInterleavedSubsampled(
+        const std::uint8_t* pImageSamples,
+        std::uint32_t allocatedBits,
+        bitDepth_t samplesDepth,
+        std::uint8_t* pLittleEndianTagData,
+        std::uint32_t imageWidth,
+        std::uint32_t imageHeight,
+        std::uint32_t numChannels,
+        bool bSubSampledX,
+        bool bSubSampledY)
+{
+    switch(samplesDepth)
+    {
+    case bitDepth_t::depthU8:
+        writeInterleavedSubsampled(pImageSamples, allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthS8:
+        writeInterleavedSubsampled(reinterpret_cast<const std::int8_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthU16:
+        writeInterleavedSubsampled(reinterpret_cast<const std::uint16_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthS16:
+        writeInterleavedSubsampled(reinterpret_cast<const std::int16_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthU32:
+        writeInterleavedSubsampled(reinterpret_cast<const std::uint32_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthS32:
+        writeInterleavedSubsampled(reinterpret_cast<const std::int32_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    }
+}
+
+
+void dicomNativeImageCodec::readInterleavedSubsampled(
+        std::uint8_t* pImageSamples,
+        std::uint32_t allocatedBits,
+        bitDepth_t samplesDepth,
+        const std::uint8_t* pLittleEndianTagData,
+        std::uint32_t imageWidth,
+        std::uint32_t imageHeight,
+        std::uint32_t numChannels,
+        bool bSubSampledX,
+        bool bSubSampledY)
+{
+    switch(samplesDepth)
+    {
+    case bitDepth_t::depthU8:
+        readInterleavedSubsampled(pImageSamples, allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthS8:
+        readInterleavedSubsampled(reinterpret_cast<std::int8_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthU16:
+        readInterleavedSubsampled(reinterpret_cast<std::uint16_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthS16:
+        readInterleavedSubsampled(reinterpret_cast<std::int16_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthU32:
+        readInterleavedSubsampled(reinterpret_cast<std::uint32_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    case bitDepth_t::depthS32:
+        readInterleavedSubsampled(reinterpret_cast<std::int32_t*>(pImageSamples), allocatedBits, pLittleEndianTagData, imageWidth, imageHeight, numChannels, bSubSampledX, bSubSampledY);
+        break;
+    }
+}
+
+
 void dicomNativeImageCodec::write1bitInterleaved(
         const std::uint8_t* pImageSamples,
         bitDepth_t samplesDepth,
@@ -65,6 +65,27 @@ public:
                                             std::uint8_t highBit,
                                             std::shared_ptr<streamReader> pSourceStream) const override;
 
+    // Get a region of an image from a dicom structure,
+    //  reading only the rows' bytes inside the region
+    ///////////////////////////////////////////////////////////
+    virtual std::shared_ptr<image> getImageRegion(const std::string& transferSyntax,
+                                                  const std::string& colorSpace,
+                                                  std::uint32_t channelsNumber,
+                                                  std::uint32_t imageWidth,
+                                                  std::uint32_t imageHeight,
+                                                  bool bSubSampledX,
+                                                  bool bSubSampledY,
+                                                  bool bInterleaved,
+                                                  bool b2Complement,
+                                                  std::uint8_t allocatedBits,
+                                                  std::uint8_t storedBits,
+                                                  std::uint8_t highBit,
+                                                  std::shared_ptr<streamReader> pSourceStream,
+                                                  std::uint32_t regionLeft,
+                                                  std::uint32_t regionTop,
+                                                  std::uint32_t regionWidth,
+                                                  std::uint32_t regionHeight) const override;
+
     // Return the default planar configuration
     ///////////////////////////////////////////////////////////
     virtual bool defaultInterleaved() const override;
@@ -107,7 +128,10 @@ public:
                                       bool bSubsampledY);
 
 protected:
-
+    // Return the depth of the image that stores the decoded
+    //  samples
+    ///////////////////////////////////////////////////////////
+    static bitDepth_t getImageDepth(bool b2Complement, std::uint8_t highBit);
 
     template<typename samplesType_t> static void writeInterleavedNotSubsampled(
             const samplesType_t* pImageSamples,
@@ -230,50 +254,78 @@ protected:
             size_t numChannels);
 
 
+    // Write the image's samples into interleaved subsampled
+    //  data. The chrominance samples are the average of the
+    //  image's pixels covered by each block
+    ///////////////////////////////////////////////////////////
     template<typename samplesType_t> static void writeInterleavedSubsampled(
-            const std::vector<std::shared_ptr<channel>> pImageSamples,
+            const samplesType_t* pImageSamples,
             std::uint32_t allocatedBits,
-            std::uint8_t* pLittleEndianTagData)
+            std::uint8_t* pLittleEndianTagData,
+            std::uint32_t imageWidth,
+            std::uint32_t imageHeight,
+            std::uint32_t numChannels,
+            bool bSubSampledX,
+            bool bSubSampledY)
     {
         const std::uint32_t allocatedBytes = allocatedBits / 8;
-
-        std::uint32_t maxSamplingFactorX = 1;
-        std::uint32_t maxSamplingFactorY = 1;
-        for (const std::shared_ptr<const channel>& pChannel: pImageSamples)
-        {
-            maxSamplingFactorX = std::max(maxSamplingFactorX, pChannel->m_samplingFactorX);
-            maxSamplingFactorY = std::max(maxSamplingFactorY, pChannel->m_samplingFactorY);
-        }
-
         const std::uint8_t mask(0xff);
 
-        // First copy the first channel
-        size_t blocksX = pImageSamples[0]->m_width / maxSamplingFactorX;
-        size_t blocksY = pImageSamples[0]->m_height / maxSamplingFactorY;
-        size_t imageWidth = pImageSamples[0]->m_width;
+        const std::uint32_t maxSamplingFactorX(bSubSampledX ? 2u : 1u);
+        const std::uint32_t maxSamplingFactorY(bSubSampledY ? 2u : 1u);
+        const std::uint32_t blocksX((imageWidth + maxSamplingFactorX - 1) / maxSamplingFactorX);
+        const std::uint32_t blocksY((imageHeight + maxSamplingFactorY - 1) / maxSamplingFactorY);
 
         std::uint8_t* pScanDestination(pLittleEndianTagData);
-        for(size_t scanBlocksY(0); scanBlocksY != blocksY; ++scanBlocksY )
+        for(std::uint32_t scanBlocksY(0); scanBlocksY != blocksY; ++scanBlocksY)
         {
-            const samplesType_t* pScanImageSamples =
-                    reinterpret_cast<const samplesType_t*>(pImageSamples[0]->m_pBuffer) + scanBlocksY * imageWidth * maxSamplingFactorY;
-            for(size_t scanBlocksX(0); scanBlocksX != blocksX; ++scanBlocksX )
+            for(std::uint32_t scanBlocksX(0); scanBlocksX != blocksX; ++scanBlocksX)
             {
-                for(size_t scanInsideBlockY(0); scanInsideBlockY != maxSamplingFactorY; ++scanInsideBlockY)
+                // The first channel is not subsampled. The padding
+                //  column repeats the last pixel of its row, the
+                //  padding row repeats the image's last pixel
+                ///////////////////////////////////////////////////////////
+                for(std::uint32_t scanInsideBlockY(0); scanInsideBlockY != maxSamplingFactorY; ++scanInsideBlockY)
                 {
-                    for(size_t scanInsideBlockX(0); scanInsideBlockX != maxSamplingFactorX; ++scanInsideBlockX)
+                    for(std::uint32_t scanInsideBlockX(0); scanInsideBlockX != maxSamplingFactorX; ++scanInsideBlockX)
                     {
-                        const samplesType_t pixel = *(pScanImageSamples + scanInsideBlockX + scanInsideBlockY * imageWidth);
+                        std::uint32_t pixelY(scanBlocksY * maxSamplingFactorY + scanInsideBlockY);
+                        std::uint32_t pixelX(scanBlocksX * maxSamplingFactorX + scanInsideBlockX);
+                        if(pixelY >= imageHeight)
+                        {
+                            pixelY = imageHeight - 1;
+                            pixelX = imageWidth - 1;
+                        }
+                        else if(pixelX >= imageWidth)
+                        {
+                            pixelX = imageWidth - 1;
+                        }
+                        const std::int32_t pixel(static_cast<std::int32_t>(pImageSamples[(pixelY * imageWidth + pixelX) * numChannels]));
                         for(std::uint32_t shiftRight(0); shiftRight != allocatedBytes; ++shiftRight)
                         {
                             *(pScanDestination++) = static_cast<std::uint8_t>((pixel >> (shiftRight * 8)) & mask);
                         }
                     }
                 }
-                pScanImageSamples += maxSamplingFactorX;
-                for(size_t channelNumber(1u); channelNumber < pImageSamples.size(); ++channelNumber)
+
+                for(std::uint32_t channelNumber(1u); channelNumber < numChannels; ++channelNumber)
                 {
-                    const samplesType_t pixel = pImageSamples[channelNumber]->m_pBuffer[scanBlocksY * blocksX + scanBlocksX];
+                    std::int32_t sum(0);
+                    std::int32_t count(0);
+                    for(std::uint32_t scanInsideBlockY(0); scanInsideBlockY != maxSamplingFactorY; ++scanInsideBlockY)
+                    {
+                        const std::uint32_t pixelY(scanBlocksY * maxSamplingFactorY + scanInsideBlockY);
+                        for(std::uint32_t scanInsideBlockX(0); scanInsideBlockX != maxSamplingFactorX; ++scanInsideBlockX)
+                        {
+                            const std::uint32_t pixelX(scanBlocksX * maxSamplingFactorX + scanInsideBlockX);
+                            if(pixelX < imageWidth && pixelY < imageHeight)
+                            {
+                                sum += static_cast<std::int32_t>(pImageSamples[(pixelY * imageWidth + pixelX) * numChannels + channelNumber]);
+                                ++count;
+                            }
+                        }
+                    }
+                    const std::int32_t pixel(sum / count);
                     for(std::uint32_t shiftRight(0); shiftRight != allocatedBytes; ++shiftRight)
                     {
                         *(pScanDestination++) = static_cast<std::uint8_t>((pixel >> (shiftRight * 8)) & mask);
@@ -283,60 +335,105 @@ protected:
         }
     }
 
+    static void writeInterleavedSubsampled(
+            const std::uint8_t* pImageSamples,
+            std::uint32_t allocatedBits,
+            bitDepth_t samplesDepth,
+            std::uint8_t* pLittleEndianTagData,
+            std::uint32_t imageWidth,
+            std::uint32_t imageHeight,
+            std::uint32_t numChannels,
+            bool bSubSampledX,
+            bool bSubSampledY);
+
 
+    // Read interleaved subsampled data into the image. Each
+    //  chrominance sample is replicated in all the image's
+    //  pixels covered by its block
+    ///////////////////////////////////////////////////////////
     template<typename samplesType_t> static void readInterleavedSubsampled(
-            const std::vector<std::shared_ptr<channel>> pImageSamples,
+            samplesType_t* pImageSamples,
             std::uint32_t allocatedBits,
-            const std::uint8_t* pLittleEndianTagData)
+            const std::uint8_t* pLittleEndianTagData,
+            std::uint32_t imageWidth,
+            std::uint32_t imageHeight,
+            std::uint32_t numChannels,
+            bool bSubSampledX,
+            bool bSubSampledY)
     {
         const std::uint32_t allocatedBytes = allocatedBits / 8;
 
-        std::uint32_t maxSamplingFactorX = 1;
-        std::uint32_t maxSamplingFactorY = 1;
-        for (const std::shared_ptr<const channel>& pChannel: pImageSamples)
-        {
-            maxSamplingFactorX = std::max(maxSamplingFactorX, pChannel->m_samplingFactorX);
-            maxSamplingFactorY = std::max(maxSamplingFactorY, pChannel->m_samplingFactorY);
-        }
+        const std::uint32_t maxSamplingFactorX(bSubSampledX ? 2u : 1u);
+        const std::uint32_t maxSamplingFactorY(bSubSampledY ? 2u : 1u);
+        const std::uint32_t blocksX((imageWidth + maxSamplingFactorX - 1) / maxSamplingFactorX);
+        const std::uint32_t blocksY((imageHeight + maxSamplingFactorY - 1) / maxSamplingFactorY);
 
-        // First copy the first channel
-        size_t blocksX = pImageSamples[0]->m_width / maxSamplingFactorX;
-        size_t blocksY = pImageSamples[0]->m_height / maxSamplingFactorY;
-        size_t imageWidth = pImageSamples[0]->m_width;
+        const size_t rowSize(imageWidth * numChannels);
 
         const std::uint8_t* pScanSource(pLittleEndianTagData);
-        for(size_t scanBlocksY(0); scanBlocksY != blocksY; ++scanBlocksY )
+        for(std::uint32_t scanBlocksY(0); scanBlocksY != blocksY; ++scanBlocksY)
         {
-            samplesType_t* pScanImageSamples =
-                    reinterpret_cast<samplesType_t*>(pImageSamples[0]->m_pBuffer) + scanBlocksY * imageWidth * maxSamplingFactorY;
-            for(size_t scanBlocksX(0); scanBlocksX != blocksX; ++scanBlocksX )
+            // The padding row and column are not copied into the
+            //  image
+            ///////////////////////////////////////////////////////////
+            const std::uint32_t blockRows(scanBlocksY * maxSamplingFactorY + maxSamplingFactorY <= imageHeight ? maxSamplingFactorY : 1u);
+            samplesType_t* pBlock(pImageSamples + scanBlocksY * maxSamplingFactorY * rowSize);
+            for(std::uint32_t scanBlocksX(0); scanBlocksX != blocksX; ++scanBlocksX)
             {
-                for(size_t scanInsideBlockY(0); scanInsideBlockY != maxSamplingFactorY; ++scanInsideBlockY)
+                const std::uint32_t blockColumns(scanBlocksX * maxSamplingFactorX + maxSamplingFactorX <= imageWidth ? maxSamplingFactorX : 1u);
+
+                // The first channel has one sample per pixel
+                ///////////////////////////////////////////////////////////
+                for(std::uint32_t scanInsideBlockY(0); scanInsideBlockY != maxSamplingFactorY; ++scanInsideBlockY)
                 {
-                    for(size_t scanInsideBlockX(0); scanInsideBlockX != maxSamplingFactorX; ++scanInsideBlockX)
+                    for(std::uint32_t scanInsideBlockX(0); scanInsideBlockX != maxSamplingFactorX; ++scanInsideBlockX)
                     {
-                        samplesType_t pixel(0);
+                        samplesType_t value(0);
                         for(std::uint32_t shiftLeft(0); shiftLeft != allocatedBytes; ++shiftLeft)
                         {
-                            pixel = pixel | (static_cast<samplesType_t>(*(pScanSource++)) << (shiftLeft * 8));
+                            value = static_cast<samplesType_t>(value | static_cast<samplesType_t>(*(pScanSource++)) << (shiftLeft * 8));
+                        }
+                        if(scanInsideBlockY < blockRows && scanInsideBlockX < blockColumns)
+                        {
+                            pBlock[scanInsideBlockY * rowSize + scanInsideBlockX * numChannels] = value;
                         }
-                        *(pScanImageSamples + scanInsideBlockX + scanInsideBlockY * imageWidth) = pixel;
                     }
                 }
-                pScanImageSamples += maxSamplingFactorX;
-                for(size_t channelNumber(1u); channelNumber < pImageSamples.size(); ++channelNumber)
+
+                // The other channels have one sample per block
+                ///////////////////////////////////////////////////////////
+                for(std::uint32_t channelNumber(1u); channelNumber < numChannels; ++channelNumber)
                 {
-                    samplesType_t pixel(0);
+                    samplesType_t value(0);
                     for(std::uint32_t shiftLeft(0); shiftLeft != allocatedBytes; ++shiftLeft)
                     {
-                        pixel = pixel | (static_cast<samplesType_t>(*(pScanSource++)) << (shiftLeft * 8));
+                        value = static_cast<samplesType_t>(value | static_cast<samplesType_t>(*(pScanSource++)) << (shiftLeft * 8));
+                    }
+                    for(std::uint32_t scanInsideBlockY(0); scanInsideBlockY != blockRows; ++scanInsideBlockY)
+                    {
+                        for(std::uint32_t scanInsideBlockX(0); scanInsideBlockX != blockColumns; ++scanInsideBlockX)
+                        {
+                            pBlock[scanInsideBlockY * rowSize + scanInsideBlockX * numChannels + channelNumber] = value;
+                        }
                     }
-                    pImageSamples[channelNumber]->m_pBuffer[scanBlocksY * blocksX + scanBlocksX] = pixel;
                 }
+
+                pBlock += maxSamplingFactorX * numChannels;
             }
         }
     }
 
+    static void readInterleavedSubsampled(
+            std::uint8_t* pImageSamples,
+            std::uint32_t allocatedBits,
+            bitDepth_t samplesDepth,
+            const std::uint8_t* pLittleEndianTagData,
+            std::uint32_t imageWidth,
+            std::uint32_t imageHeight,
+            std::uint32_t numChannels,
+            bool bSubSampledX,
+            bool bSubSampledY);
+
 
     template<typename samplesType_t> static void write1bitInterleaved(
             const samplesType_t* pImageSamples,
@@ -16,6 +16,8 @@ If you do not want to be bound by the GPL terms (such as the requirement
 
 */
 
+#include <algorithm>
+#include <limits>
 #include <list>
 #include <vector>
 #include <string.h>
@@ -30,6 +32,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "colorTransformsFactoryImpl.h"
 #include "codecFactoryImpl.h"
 #include "bufferImpl.h"
+#include "parallelTasksImpl.h"
 #include "../include/imebra/exceptions.h"
 
 namespace imebra
@@ -41,6 +44,137 @@ namespace implementation
 namespace codecs
 {
 
+namespace
+{
+
+///////////////////////////////////////////////////////////
+//
+// Combine the byte planes of a channel (most significant
+//  plane first) into the channel's samples.
+//
+// The loops that write contiguous samples are kept
+//  separate so the compiler can vectorize them.
+//
+///////////////////////////////////////////////////////////
+template<typename samplesType_t>
+void combineRLEPlanes(
+        const std::uint8_t* pPlanes,
+        size_t planeSize,
+        std::uint32_t planesNumber,
+        samplesType_t* pChannelSamples,
+        std::uint32_t channelsNumber,
+        std::uint32_t mask)
+{
+    if(planesNumber == 1)
+    {
+        if(channelsNumber == 1)
+        {
+            for(size_t index(0); index != planeSize; ++index)
+            {
+                pChannelSamples[index] = (samplesType_t)(pPlanes[index] & mask);
+            }
+            return;
+        }
+        for(size_t index(0); index != planeSize; ++index)
+        {
+            pChannelSamples[index * channelsNumber] = (samplesType_t)(pPlanes[index] & mask);
+        }
+        return;
+    }
+
+    if(planesNumber == 2)
+    {
+        const std::uint8_t* pLowPlane(pPlanes + planeSize);
+        if(channelsNumber == 1)
+        {
+            for(size_t index(0); index != planeSize; ++index)
+            {
+                pChannelSamples[index] = (samplesType_t)((((std::uint32_t)pPlanes[index] << 8) | pLowPlane[index]) & mask);
+            }
+            return;
+        }
+        for(size_t index(0); index != planeSize; ++index)
+        {
+            pChannelSamples[index * channelsNumber] = (samplesType_t)((((std::uint32_t)pPlanes[index] << 8) | pLowPlane[index]) & mask);
+        }
+        return;
+    }
+
+    for(size_t index(0); index != planeSize; ++index)
+    {
+        std::uint32_t value(0);
+        for(std::uint32_t plane(0); plane != planesNumber; ++plane)
+        {
+            value = (value << 8) | pPlanes[plane * planeSize + index];
+        }
+        pChannelSamples[index * channelsNumber] = (samplesType_t)(value & mask);
+    }
+}
+
+///////////////////////////////////////////////////////////
+//
+// Expand the complete RLE packets stored in a contiguous
+//  span into a byte plane, using block copies for the
+//  literal and the replicated runs.
+//
+// Stops when the plane is full or when the next packet
+//  is not completely contained in the span; returns a
+//  pointer to the first packet not expanded.
+//
+///////////////////////////////////////////////////////////
+const std::uint8_t* expandRLEPackets(
+        const std::uint8_t* pSpan,
+        const std::uint8_t* pSpanEnd,
+        std::uint8_t** ppPlane,
+        std::uint8_t* pPlaneEnd)
+{
+    std::uint8_t* pPlane(*ppPlane);
+    while(pPlane != pPlaneEnd && pSpan != pSpanEnd)
+    {
+        const std::uint8_t rleByte(*pSpan);
+
+        // Copy the specified number of bytes
+        ///////////////////////////////////////////////////////////
+        if(rleByte < 0x80)
+        {
+            const size_t copyBytes((size_t)rleByte + 1);
+            if((size_t)(pSpanEnd - pSpan) <= copyBytes)
+            {
+                break;
+            }
+            const size_t planeBytes(std::min(copyBytes, (size_t)(pPlaneEnd - pPlane)));
+            ::memcpy(pPlane, pSpan + 1, planeBytes);
+            pPlane += planeBytes;
+            pSpan += copyBytes + 1;
+            continue;
+        }
+
+        // Copy the same byte several times
+        ///////////////////////////////////////////////////////////
+        if(rleByte > 0x80)
+        {
+            if(pSpanEnd - pSpan < 2)
+            {
+                break;
+            }
+            const size_t runLength(std::min((size_t)(257 - rleByte), (size_t)(pPlaneEnd - pPlane)));
+            ::memset(pPlane, pSpan[1], runLength);
+            pPlane += runLength;
+            pSpan += 2;
+            continue;
+        }
+
+        // 0x80 is a no-op
+        ///////////////////////////////////////////////////////////
+        ++pSpan;
+    }
+
+    *ppPlane = pPlane;
+    return pSpan;
+}
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
@@ -134,44 +268,30 @@ std::shared_ptr<image> dicomRLEImageCodec::getImage(const std::string& /* transf
         IMEBRA_THROW(CodecCorruptedFileError,  "The color space " << colorSpace << " requires " << tempChannelsNumber << " but the dataset declares " << channelsNumber << " channels");
     }
 
-    // Allocate the dicom channels
-    ///////////////////////////////////////////////////////////
-    std::vector<std::shared_ptr<channel>> channels = allocChannels(channelsNumber, imageWidth, imageHeight, bSubSampledX, bSubSampledY);
-
     std::uint32_t mask = (std::uint32_t)( ((std::uint64_t)1 << (highBit + 1)) - 1);
     mask -= (std::uint32_t)(((std::uint64_t)1 << (highBit + 1 - storedBits)) - 1);
 
-    readRLECompressed(channels, imageWidth, imageHeight, channelsNumber, pSourceStream.get(), allocatedBits, mask);
-
-    if(b2Complement)
+    // Decode the segments directly into the image's buffer
+    ///////////////////////////////////////////////////////////
+    std::uint8_t* pImageMemory(handler->getMemoryBuffer());
+    switch(depth)
     {
-        for(const std::shared_ptr<channel>& pChannel: channels)
-        {
-            {
-                adjustB2Complement(pChannel->m_memory->data(), highBit, bitDepth_t::depthS32, pChannel->m_memory->size() / sizeof(std::uint32_t));
-            }
-        }
+    case bitDepth_t::depthU8:
+    case bitDepth_t::depthS8:
+        readRLECompressed(pImageMemory, imageWidth, imageHeight, channelsNumber, pSourceStream.get(), allocatedBits, mask);
+        break;
+    case bitDepth_t::depthU16:
+    case bitDepth_t::depthS16:
+        readRLECompressed(reinterpret_cast<std::uint16_t*>(pImageMemory), imageWidth, imageHeight, channelsNumber, pSourceStream.get(), allocatedBits, mask);
+        break;
+    default:
+        readRLECompressed(reinterpret_cast<std::uint32_t*>(pImageMemory), imageWidth, imageHeight, channelsNumber, pSourceStream.get(), allocatedBits, mask);
+        break;
     }
 
-    // Copy the dicom channels into the image
-    ///////////////////////////////////////////////////////////
-    std::uint32_t maxSamplingFactorX = bSubSampledX ? 2 : 1;
-    std::uint32_t maxSamplingFactorY = bSubSampledY ? 2 : 1;
-    for(std::uint32_t copyChannels = 0; copyChannels < channelsNumber; ++copyChannels)
+    if(b2Complement)
     {
-        std::shared_ptr<channel> dicomChannel = channels[copyChannels];
-        handler->copyFromInt32Interleaved(
-                    dicomChannel->m_pBuffer,
-                    maxSamplingFactorX /dicomChannel->m_samplingFactorX,
-                    maxSamplingFactorY /dicomChannel->m_samplingFactorY,
-                    0, 0,
-                    dicomChannel->m_width * maxSamplingFactorX / dicomChannel->m_samplingFactorX,
-                    dicomChannel->m_height * maxSamplingFactorY / dicomChannel->m_samplingFactorY,
-                    copyChannels,
-                    imageWidth,
-                    imageHeight,
-                    channelsNumber);
-
+        adjustB2Complement(pImageMemory, highBit, depth, handler->getSize());
     }
 
     // Return OK
@@ -207,8 +327,9 @@ bool dicomRLEImageCodec::defaultInterleaved() const
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
+template<typename samplesType_t>
 void dicomRLEImageCodec::writeRLECompressed(
-        const std::vector<std::shared_ptr<channel>>& channels,
+        const samplesType_t* pImageSamples,
         std::uint32_t imageWidth,
         std::uint32_t imageHeight,
         std::uint32_t channelsNumber,
@@ -222,110 +343,134 @@ void dicomRLEImageCodec::writeRLECompressed(
     std::uint32_t segmentsOffset[16];
     ::memset(segmentsOffset, 0, sizeof(segmentsOffset));
 
-    // The first phase fills the segmentsOffset pointers, the
-    //  second phase writes to the stream.
+    // One segment for each byte of each channel, the most
+    //  significant byte first
+    ///////////////////////////////////////////////////////////
+    const std::uint32_t planesNumber((allocatedBits + 7) / 8);
+    const std::uint32_t segmentsNumber(channelsNumber * planesNumber);
+    if(segmentsNumber >= sizeof(segmentsOffset) / sizeof(segmentsOffset[0]))
+    {
+        IMEBRA_THROW(std::logic_error, "Too many RLE segments");
+    }
+
+    // The segments are independent: each one is compressed
+    //  into its own buffer, by several threads if enabled
+    ///////////////////////////////////////////////////////////
+    std::vector<std::vector<std::uint8_t> > segments(segmentsNumber);
+
+    runParallelTasks(segmentsNumber, codecFactory::getCodecFactory()->getRLEEncodingThreads(), [&](size_t segment)
+    {
+        const std::uint32_t channel((std::uint32_t)segment / planesNumber);
+        const std::uint32_t rightShift(8 * (planesNumber - 1 - (std::uint32_t)segment % planesNumber));
+        writeRLESegment(pImageSamples + channel, imageWidth, imageHeight, channelsNumber, rightShift, mask, &(segments[segment]));
+    });
+
+    // Now that the size of all the segments is known, write
+    //  the offsets table followed by the segments
     ///////////////////////////////////////////////////////////
-    for(int phase = 0; phase < 2; ++phase)
+    segmentsOffset[0] = segmentsNumber;
+    std::uint32_t offset(sizeof(segmentsOffset));
+    for(std::uint32_t segment(0); segment != segmentsNumber; ++segment)
     {
-        if(phase == 1)
+        segmentsOffset[segment + 1] = offset;
+        offset += (std::uint32_t)segments[segment].size();
+    }
+
+    pDestStream->adjustEndian((std::uint8_t*)segmentsOffset, 4, streamController::lowByteEndian, sizeof(segmentsOffset) / sizeof(segmentsOffset[0]));
+    pDestStream->write((std::uint8_t*)segmentsOffset, sizeof(segmentsOffset));
+    for(const std::vector<std::uint8_t>& segment: segments)
+    {
+        pDestStream->write(segment.data(), segment.size());
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Compress one byte of one channel into an RLE segment
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+template<typename samplesType_t>
+void dicomRLEImageCodec::writeRLESegment(
+        const samplesType_t* pChannelSamples,
+        std::uint32_t imageWidth,
+        std::uint32_t imageHeight,
+        std::uint32_t channelsNumber,
+        std::uint32_t rightShift,
+        std::uint32_t mask,
+        std::vector<std::uint8_t>* pSegment)
+{
+    IMEBRA_FUNCTION_START();
+
+    // Reserve the space for the worst case (literal runs
+    //  only), so the segment is never reallocated
+    ///////////////////////////////////////////////////////////
+    pSegment->clear();
+    pSegment->reserve((size_t)imageHeight * ((size_t)imageWidth + (imageWidth + 127) / 128) + 1);
+
+    std::vector<std::uint8_t> rowBytes(imageWidth);
+    const samplesType_t* pPixel = pChannelSamples;
+
+    for(std::uint32_t scanY = imageHeight; scanY != 0; --scanY)
+    {
+        std::uint8_t* rowBytesPointer = &(rowBytes[0]);
+
+        for(std::uint32_t scanX = imageWidth; scanX != 0; --scanX)
         {
-            pDestStream->adjustEndian((std::uint8_t*)segmentsOffset, 4, streamController::lowByteEndian, sizeof(segmentsOffset) / sizeof(segmentsOffset[0]));
-            pDestStream->write((std::uint8_t*)segmentsOffset, sizeof(segmentsOffset));
+            *(rowBytesPointer++) = (std::uint8_t)( ((std::uint32_t)*pPixel & mask) >> rightShift);
+            pPixel += channelsNumber;
         }
 
-        std::uint32_t segmentNumber = 0;
-        std::uint32_t offset = 64;
+        // Bytes not included in a run-length, not yet written
+        ///////////////////////////////////////////////////////////
+        size_t differentBytesStart(0);
 
-        for(std::uint32_t scanChannels = 0; scanChannels < channelsNumber; ++scanChannels)
+        for(size_t scanBytes = 0; scanBytes < imageWidth; /* left empty */)
         {
-            std::vector<std::uint8_t> rowBytes(imageWidth);
-
-            std::vector<std::uint8_t> differentBytes;
-            differentBytes.reserve(imageWidth);
+            std::uint8_t currentByte = rowBytes[scanBytes];
 
-            for(std::int32_t rightShift = (std::int32_t)(((allocatedBits + 7) & 0xfffffff8) - 8); rightShift >= 0; rightShift -= 8)
+            // Calculate the run-length
+            ///////////////////////////
+            size_t runLength(1);
+            for(; ((scanBytes + runLength) != imageWidth) && rowBytes[scanBytes + runLength] == currentByte; ++runLength)
             {
-                std::int32_t* pPixel = channels[scanChannels]->m_pBuffer;
+            }
 
-                if(phase == 0)
-                {
-                    segmentsOffset[++segmentNumber] = offset;
-                    segmentsOffset[0] = segmentNumber;
-                }
-                else
+            // Write the runlength
+            //////////////////////
+            if(runLength > 3)
+            {
+                writeRLEDifferentBytes(&(rowBytes[differentBytesStart]), scanBytes - differentBytesStart, pSegment);
+                if(runLength > 128)
                 {
-                    offset = segmentsOffset[++segmentNumber];
+                    runLength = 128;
                 }
+                scanBytes += runLength;
+                differentBytesStart = scanBytes;
+                pSegment->push_back((std::uint8_t)(1 - runLength));
+                pSegment->push_back(currentByte);
+                continue;
+            }
 
-                for(std::uint32_t scanY = imageHeight; scanY != 0; --scanY)
-                {
-                    std::uint8_t* rowBytesPointer = &(rowBytes[0]);
-
-                    for(std::uint32_t scanX = imageWidth; scanX != 0; --scanX)
-                    {
-                        *(rowBytesPointer++) = (std::uint8_t)( ((std::uint32_t)*pPixel & mask) >> rightShift);
-                        ++pPixel;
-                    }
-
-                    for(size_t scanBytes = 0; scanBytes < imageWidth; /* left empty */)
-                    {
-                        std::uint8_t currentByte = rowBytes[scanBytes];
-
-                        // Calculate the run-length
-                        ///////////////////////////
-                        size_t runLength(1);
-                        for(; ((scanBytes + runLength) != imageWidth) && rowBytes[scanBytes + runLength] == currentByte; ++runLength)
-                        {
-                        }
-
-                        // Write the runlength
-                        //////////////////////
-                        if(runLength > 3)
-                        {
-                            if(!differentBytes.empty())
-                            {
-                                offset += (std::uint32_t)writeRLEDifferentBytes(&differentBytes, pDestStream, phase == 1);
-                            }
-                            if(runLength > 128)
-                            {
-                                runLength = 128;
-                            }
-                            offset += 2;
-                            scanBytes += runLength;
-                            if(phase == 1)
-                            {
-                                std::uint8_t lengthByte = (std::uint8_t)(1 - runLength);
-                                pDestStream->write(&lengthByte, 1);
-                                pDestStream->write(&currentByte, 1);
-                            }
-                            continue;
-                        }
-
-                        // Remmember sequence of different bytes
-                        ////////////////////////////////////////
-                        differentBytes.push_back(currentByte);
-                        ++scanBytes;
-                    } // for(std::uint32_t scanBytes = 0; scanBytes < imageWidth; )
-
-                    offset += (std::uint32_t)writeRLEDifferentBytes(&differentBytes, pDestStream, phase == 1);
-
-                } // for(std::uint32_t scanY = imageHeight; scanY != 0; --scanY)
-
-                if((offset & 1) != 0)
-                {
-                    ++offset;
-                    if(phase == 1)
-                    {
-                        const std::uint8_t command = 0x80;
-                        pDestStream->write(&command, 1);
-                    }
-                }
+            // Remmember sequence of different bytes
+            ////////////////////////////////////////
+            ++scanBytes;
+        } // for(std::uint32_t scanBytes = 0; scanBytes < imageWidth; )
 
-            } // for(std::int32_t rightShift = ((allocatedBits + 7) & 0xfffffff8) -8; rightShift >= 0; rightShift -= 8)
+        writeRLEDifferentBytes(rowBytes.data() + differentBytesStart, imageWidth - differentBytesStart, pSegment);
 
-        } // for(int scanChannels = 0; scanChannels < channelsNumber; ++scanChannels)
+    } // for(std::uint32_t scanY = imageHeight; scanY != 0; --scanY)
 
-    } // for(int phase = 0; phase < 2; ++phase)
+    if((pSegment->size() & 1) != 0)
+    {
+        pSegment->push_back(0x80);
+    }
 
     IMEBRA_FUNCTION_END();
 }
@@ -340,32 +485,21 @@ void dicomRLEImageCodec::writeRLECompressed(
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-size_t dicomRLEImageCodec::writeRLEDifferentBytes(std::vector<std::uint8_t>* pDifferentBytes, streamWriter* pDestStream, bool bWrite)
+void dicomRLEImageCodec::writeRLEDifferentBytes(const std::uint8_t* pDifferentBytes, size_t differentBytesCount, std::vector<std::uint8_t>* pSegment)
 {
     IMEBRA_FUNCTION_START();
 
-    size_t writtenLength = 0;
-    for(size_t offset(0); offset != pDifferentBytes->size();)
+    for(size_t offset(0); offset != differentBytesCount;)
     {
-        size_t writeSize = pDifferentBytes->size() - offset;
+        size_t writeSize = differentBytesCount - offset;
         if(writeSize > 128)
         {
             writeSize = 128;
         }
-        writtenLength += writeSize + 1;
-        if(bWrite)
-        {
-            const std::uint8_t writeLength((std::uint8_t)(writeSize - 1));
-            pDestStream->write(&writeLength, 1);
-            pDestStream->write(&(pDifferentBytes->at(offset)), writeSize);
-        }
+        pSegment->push_back((std::uint8_t)(writeSize - 1));
+        pSegment->insert(pSegment->end(), pDifferentBytes + offset, pDifferentBytes + offset + writeSize);
         offset += writeSize;
     }
-    pDifferentBytes->clear();
-
-    // return number of written bytes
-    /////////////////////////////////
-    return writtenLength;
 
     IMEBRA_FUNCTION_END();
 }
@@ -380,8 +514,9 @@ size_t dicomRLEImageCodec::writeRLEDifferentBytes(std::vector<std::uint8_t>* pDi
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
+template<typename samplesType_t>
 void dicomRLEImageCodec::readRLECompressed(
-        const std::vector<std::shared_ptr<channel>>& channels,
+        samplesType_t* pImageSamples,
         std::uint32_t imageWidth,
         std::uint32_t imageHeight,
         std::uint32_t channelsNumber,
@@ -399,101 +534,113 @@ void dicomRLEImageCodec::readRLECompressed(
     pSourceStream->read((std::uint8_t*)segmentsOffset, 64);
     pSourceStream->adjustEndian((std::uint8_t*)segmentsOffset, 4, streamController::lowByteEndian, sizeof(segmentsOffset) / sizeof(segmentsOffset[0]));
 
-    //
-    // Scan all the RLE segments
-    //
+    const std::uint32_t planesNumber((allocatedBits + 7) / 8);
+    if(channelsNumber * planesNumber >= sizeof(segmentsOffset) / sizeof(segmentsOffset[0]))
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Too many RLE segments");
+    }
+
+    // Each segment is expanded into a byte plane, then the
+    //  planes of a channel are combined into the channel's
+    //  samples.
+    // 8 bit monochrome images are expanded directly into
+    //  the image's buffer.
+    // The planes come from the memory pool, so they are
+    //  recycled when decoding the frames of a cine loop
     ///////////////////////////////////////////////////////////
-    std::uint32_t loopsNumber = channelsNumber;
-    std::uint32_t loopSize = imageWidth * imageHeight;
+    const size_t planeSize((size_t)imageWidth * (size_t)imageHeight);
+    const bool bDecodeInPlace(sizeof(samplesType_t) == 1 && planesNumber == 1 && channelsNumber == 1);
+    std::shared_ptr<memory> pPlanes;
+    if(!bDecodeInPlace)
+    {
+        pPlanes = std::make_shared<memory>(planeSize * planesNumber);
+    }
 
     std::uint32_t currentSegmentOffset = sizeof(segmentsOffset);
-    std::uint8_t segmentNumber = 0;
-    for(std::uint32_t channel = 0; channel<loopsNumber; ++channel)
+    std::uint32_t segmentNumber(0);
+    for(std::uint32_t channel(0); channel != channelsNumber; ++channel)
     {
-        for(std::int32_t leftShift = (std::int32_t)(((allocatedBits + 7) & 0xfffffff8) - 8); leftShift >= 0; leftShift -= 8)
+        for(std::uint32_t plane(0); plane != planesNumber; ++plane)
         {
-            // Prepare to scan all the RLE segment
+            // A segment ends where the next one starts or at
+            //  the end of the frame
             ///////////////////////////////////////////////////////////
-            std::uint32_t segmentOffset = segmentsOffset[++segmentNumber]; // Get the offset
+            const std::uint32_t segmentOffset(segmentsOffset[++segmentNumber]);
+            if(segmentOffset < currentSegmentOffset)
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "Invalid RLE segment offset");
+            }
             pSourceStream->seekForward(segmentOffset - currentSegmentOffset);
             currentSegmentOffset = segmentOffset;
 
-            std::uint8_t  rleByte = 0;         // RLE code
-            std::uint8_t  copyBytes = 0;       // Number of bytes to copy
-            std::uint8_t  runByte = 0;         // Byte to use in run-lengths
-            std::uint8_t  runLength = 0;       // Number of bytes with the same information (runByte)
-            std::uint8_t  copyBytesBuffer[0x81];
+            size_t segmentSize(std::numeric_limits<size_t>::max());
+            if(segmentNumber + 1 < sizeof(segmentsOffset) / sizeof(segmentsOffset[0]) &&
+                    segmentsOffset[segmentNumber + 1] > segmentOffset)
+            {
+                segmentSize = segmentsOffset[segmentNumber + 1] - segmentOffset;
+            }
 
-            std::int32_t* pChannelMemory = channels[channel]->m_pBuffer;
-            std::uint32_t channelSize = loopSize;
-            std::uint8_t* pScanCopyBytes;
+            std::uint8_t* pPlane(bDecodeInPlace ? reinterpret_cast<std::uint8_t*>(pImageSamples) : pPlanes->data() + plane * planeSize);
+            currentSegmentOffset += (std::uint32_t)decodeRLESegment(pSourceStream, segmentSize, pPlane, planeSize);
+        }
 
-            // Read the RLE segment
-            ///////////////////////////////////////////////////////////
-            pSourceStream->read(&rleByte, 1);
-            ++currentSegmentOffset;
-            while(channelSize != 0)
+        if(bDecodeInPlace)
+        {
+            if((mask & 0xff) != 0xff)
             {
-                if(rleByte==0x80)
-                {
-                    pSourceStream->read(&rleByte, 1);
-                    ++currentSegmentOffset;
-                    continue;
-                }
+                combineRLEPlanes(reinterpret_cast<std::uint8_t*>(pImageSamples), planeSize, 1, pImageSamples, 1, mask);
+            }
+        }
+        else
+        {
+            combineRLEPlanes(pPlanes->data(), planeSize, planesNumber, pImageSamples + channel, channelsNumber, mask);
+        }
 
-                // Copy the specified number of bytes
-                ///////////////////////////////////////////////////////////
-                if(rleByte<0x80)
-                {
-                    copyBytes = ++rleByte;
-                    if(copyBytes < channelSize)
-                    {
-                        pSourceStream->read(copyBytesBuffer, copyBytes + 1);
-                        currentSegmentOffset += copyBytes + 1;
-                        rleByte = copyBytesBuffer[copyBytes];
-                    }
-                    else
-                    {
-                        pSourceStream->read(copyBytesBuffer, copyBytes);
-                        currentSegmentOffset += copyBytes;
-                    }
-                    pScanCopyBytes = copyBytesBuffer;
-                    while(copyBytes-- && channelSize != 0)
-                    {
-                        *pChannelMemory |= (std::int32_t) ((((std::uint32_t)(*pScanCopyBytes++)) << leftShift) & mask);
-                        ++pChannelMemory;
-                        --channelSize;
-                    }
-                    continue;
-                }
+    } // ...Channels scanning loop
 
-                // Copy the same byte several times
-                ///////////////////////////////////////////////////////////
-                runLength = (std::uint8_t)(1-rleByte);
-                if(runLength < channelSize)
-                {
-                    pSourceStream->read(copyBytesBuffer, 2);
-                    currentSegmentOffset += 2;
-                    runByte = copyBytesBuffer[0];
-                    rleByte = copyBytesBuffer[1];
-                }
-                else
-                {
-                    pSourceStream->read(&runByte, 1);
-                    ++currentSegmentOffset;
-                }
-                while(runLength-- && channelSize != 0)
-                {
-                    *pChannelMemory |= (std::int32_t) (((std::uint32_t)runByte << leftShift) & mask);
-                    ++pChannelMemory;
-                    --channelSize;
-                }
+    IMEBRA_FUNCTION_END();
+}
 
-            } // ...End of the segment scanning loop
 
-        } // ...End of the leftshift calculation
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Expand one RLE segment into a byte plane
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+size_t dicomRLEImageCodec::decodeRLESegment(
+        streamReader* pSourceStream,
+        size_t segmentSize,
+        std::uint8_t* pPlane,
+        size_t planeSize)
+{
+    IMEBRA_FUNCTION_START();
 
-    } // ...Channels scanning loop
+    // The packets are expanded straight from the stream's
+    //  buffer: each span contains at least one complete
+    //  packet (up to 129 bytes)
+    ///////////////////////////////////////////////////////////
+    std::uint8_t* const pPlaneEnd(pPlane + planeSize);
+    size_t readSize(0);
+    while(pPlane != pPlaneEnd)
+    {
+        size_t availableSize(0);
+        const std::uint8_t* pSpan(pSourceStream->getBufferedData(std::min((size_t)129, segmentSize - readSize), &availableSize));
+        availableSize = std::min(availableSize, segmentSize - readSize);
+
+        const size_t expandedSize((size_t)(expandRLEPackets(pSpan, pSpan + availableSize, &pPlane, pPlaneEnd) - pSpan));
+        if(expandedSize == 0 && pPlane != pPlaneEnd)
+        {
+            IMEBRA_THROW(CodecCorruptedFileError, "The RLE segment is shorter than the image");
+        }
+        pSourceStream->skipBufferedData(expandedSize);
+        readSize += expandedSize;
+    }
+
+    return readSize;
 
     IMEBRA_FUNCTION_END();
 }
@@ -544,20 +691,25 @@ void dicomRLEImageCodec::setImage(
     std::shared_ptr<handlers::readingDataHandlerNumericBase> imageHandler = pImage->getReadingDataHandler();
     std::uint32_t channelsNumber = pImage->getChannelsNumber();
 
-    // Copy the image into the dicom channels
-    ///////////////////////////////////////////////////////////
-    std::vector<std::shared_ptr<channel>> channels = splitImageIntoChannels(pImage, bSubSampledX, bSubSampledY);
-
     std::uint32_t mask = (std::uint32_t)(((std::uint64_t)1 << (highBit + 1)) - 1);
 
-    writeRLECompressed(
-                channels,
-                imageWidth,
-                imageHeight,
-                channelsNumber,
-                pDestStream.get(),
-                (std::uint8_t)allocatedBits,
-                mask);
+    // Encode the segments directly from the image's buffer
+    ///////////////////////////////////////////////////////////
+    const std::uint8_t* pImageMemory(imageHandler->getMemoryBuffer());
+    switch(pImage->getDepth())
+    {
+    case bitDepth_t::depthU8:
+    case bitDepth_t::depthS8:
+        writeRLECompressed(pImageMemory, imageWidth, imageHeight, channelsNumber, pDestStream.get(), (std::uint8_t)allocatedBits, mask);
+        break;
+    case bitDepth_t::depthU16:
+    case bitDepth_t::depthS16:
+        writeRLECompressed(reinterpret_cast<const std::uint16_t*>(pImageMemory), imageWidth, imageHeight, channelsNumber, pDestStream.get(), (std::uint8_t)allocatedBits, mask);
+        break;
+    default:
+        writeRLECompressed(reinterpret_cast<const std::uint32_t*>(pImageMemory), imageWidth, imageHeight, channelsNumber, pDestStream.get(), (std::uint8_t)allocatedBits, mask);
+        break;
+    }
 
     IMEBRA_FUNCTION_END();
 }
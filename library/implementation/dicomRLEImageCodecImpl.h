@@ -111,10 +111,12 @@ public:
     virtual std::uint32_t suggestAllocatedBits(const std::string& transferSyntax, std::uint32_t highBit) const override;
 
 protected:
-    // Write an RLE compressed image
+    // Write an RLE compressed image, reading the samples
+    //  directly from the image's buffer
     ///////////////////////////////////////////////////////////
+    template<typename samplesType_t>
     static void writeRLECompressed(
-            const std::vector<std::shared_ptr<channel>>& channels,
+            const samplesType_t* pImageSamples,
             std::uint32_t imageWidth,
             std::uint32_t imageHeight,
             std::uint32_t channelsNumber,
@@ -123,14 +125,28 @@ protected:
             std::uint32_t mask
             );
 
+    // Compress one byte of one channel into an RLE segment
+    ///////////////////////////////////////////////////////////
+    template<typename samplesType_t>
+    static void writeRLESegment(
+            const samplesType_t* pChannelSamples,
+            std::uint32_t imageWidth,
+            std::uint32_t imageHeight,
+            std::uint32_t channelsNumber,
+            std::uint32_t rightShift,
+            std::uint32_t mask,
+            std::vector<std::uint8_t>* pSegment);
+
     // Write RLE sequence of different bytes
     ///////////////////////////////////////////////////////////
-    static size_t writeRLEDifferentBytes(std::vector<std::uint8_t>* pDifferentBytes, streamWriter* pDestStream, bool bWrite);
+    static void writeRLEDifferentBytes(const std::uint8_t* pDifferentBytes, size_t differentBytesCount, std::vector<std::uint8_t>* pSegment);
 
-    // Read an RLE compressed image
+    // Read an RLE compressed image, writing the samples
+    //  directly into the image's buffer
     ///////////////////////////////////////////////////////////
+    template<typename samplesType_t>
     static void readRLECompressed(
-            const std::vector<std::shared_ptr<channel>>& information,
+            samplesType_t* pImageSamples,
             std::uint32_t imageWidth,
             std::uint32_t imageHeight,
             std::uint32_t channelsNumber,
@@ -138,6 +154,15 @@ protected:
             std::uint8_t allocatedBits,
             std::uint32_t mask);
 
+    // Expand one RLE segment into a byte plane. Returns the
+    //  number of bytes read from the segment
+    ///////////////////////////////////////////////////////////
+    static size_t decodeRLESegment(
+            streamReader* pSourceStream,
+            size_t segmentSize,
+            std::uint8_t* pPlane,
+            size_t planeSize);
+
 
     // Flush the unwritten bytes of an uncompressed image
     ///////////////////////////////////////////////////////////
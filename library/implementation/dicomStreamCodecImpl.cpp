@@ -16,8 +16,9 @@ If you do not want to be bound by the GPL terms (such as the requirement
 
 */
 
-#include <list>
 #include <vector>
+#include <map>
+#include <algorithm>
 #include <string.h>
 #include "exceptionImpl.h"
 #include "streamReaderImpl.h"
@@ -73,11 +74,34 @@ void dicomStreamCodec::writeStream(std::shared_ptr<streamWriter> pStream, std::s
 
     // Adjust the flags
     ///////////////////////////////////////////////////////////
-    bool bExplicitDataType = (transferSyntax != "1.2.840.10008.1.2");        // Implicit VR little endian
+    bool bExplicitDataType;
+    streamController::tByteOrdering endianType;
+    getTransferSyntaxEncoding(transferSyntax, &bExplicitDataType, &endianType);
 
-    // Explicit VR big endian
+    // Write the dicom header
+    ///////////////////////////////////////////////////////////
+    writePreamble(pStream);
+
+    // Build the stream
     ///////////////////////////////////////////////////////////
-    streamController::tByteOrdering endianType = (transferSyntax == "1.2.840.10008.1.2.2") ? streamController::highByteEndian : streamController::lowByteEndian;
+    buildStream(pStream, pDataSet, bExplicitDataType, endianType, streamType_t::mediaStorage);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Write the preamble and the DICM signature
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void dicomStreamCodec::writePreamble(std::shared_ptr<streamWriter> pStream)
+{
+    IMEBRA_FUNCTION_START();
 
     // Write the dicom header
     ///////////////////////////////////////////////////////////
@@ -89,9 +113,31 @@ void dicomStreamCodec::writeStream(std::shared_ptr<streamWriter> pStream, std::s
     ///////////////////////////////////////////////////////////
     pStream->write((std::uint8_t*)"DICM", 4);
 
-    // Build the stream
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return the VR mode and the byte ordering of a transfer
+//  syntax
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void dicomStreamCodec::getTransferSyntaxEncoding(const std::string& transferSyntax, bool* pbExplicitDataType, streamController::tByteOrdering* pEndianType)
+{
+    IMEBRA_FUNCTION_START();
+
+    // Implicit VR little endian
     ///////////////////////////////////////////////////////////
-    buildStream(pStream, pDataSet, bExplicitDataType, endianType, streamType_t::mediaStorage);
+    *pbExplicitDataType = (transferSyntax != "1.2.840.10008.1.2");
+
+    // Explicit VR big endian
+    ///////////////////////////////////////////////////////////
+    *pEndianType = (transferSyntax == "1.2.840.10008.1.2.2") ? streamController::highByteEndian : streamController::lowByteEndian;
 
     IMEBRA_FUNCTION_END();
 }
@@ -106,7 +152,7 @@ void dicomStreamCodec::writeStream(std::shared_ptr<streamWriter> pStream, std::s
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-void dicomStreamCodec::buildStream(std::shared_ptr<streamWriter> pStream, std::shared_ptr<const dataSet> pDataSet, bool bExplicitDataType, streamController::tByteOrdering endianType, streamType_t streamType)
+void dicomStreamCodec::buildStream(std::shared_ptr<streamWriter> pStream, std::shared_ptr<const dataSet> pDataSet, bool bExplicitDataType, streamController::tByteOrdering endianType, streamType_t streamType, std::uint32_t firstTag, std::uint32_t endTag)
 {
     IMEBRA_FUNCTION_START();
 
@@ -114,10 +160,28 @@ void dicomStreamCodec::buildStream(std::shared_ptr<streamWriter> pStream, std::s
 
     for(dataSet::tGroupsIds::const_iterator scanGroups(groups.begin()), endGroups(groups.end()); scanGroups != endGroups; ++scanGroups)
     {
+        // Skip the groups outside the requested range
+        ///////////////////////////////////////////////////////////
+        const std::uint32_t groupFirstTag(static_cast<std::uint32_t>(*scanGroups) << 16);
+        const std::uint32_t groupLastTag(groupFirstTag | 0xffffu);
+        if(groupLastTag < firstTag || groupFirstTag >= endTag)
+        {
+            continue;
+        }
+        const bool bPartialGroup(groupFirstTag < firstTag || groupLastTag >= endTag);
+
         size_t numGroups = pDataSet->getGroupsNumber(*scanGroups);
         for(size_t scanGroupsNumber(0); scanGroupsNumber != numGroups; ++scanGroupsNumber)
         {
-            const dataSet::tTags& tags(pDataSet->getGroupTags(*scanGroups, scanGroupsNumber));
+            dataSet::tTags tags(pDataSet->getGroupTags(*scanGroups, scanGroupsNumber));
+            if(bPartialGroup)
+            {
+                tags.erase(std::remove_if(tags.begin(), tags.end(), [groupFirstTag, firstTag, endTag](const dataSet::tTags::value_type& tag)
+                {
+                    const std::uint32_t tagId(groupFirstTag | tag.first);
+                    return tagId < firstTag || tagId >= endTag;
+                }), tags.end());
+            }
 
             if(*scanGroups == 0x0002)
             {
@@ -125,7 +189,7 @@ void dicomStreamCodec::buildStream(std::shared_ptr<streamWriter> pStream, std::s
                 ////////////////////////////////////////////////////////////////////////
                 if(streamType == streamType_t::mediaStorage)
                 {
-                    dataSet::tTags temporaryTags(tags);
+                    std::map<std::uint16_t, std::shared_ptr<data> > temporaryTags(tags.begin(), tags.end());
                     const std::shared_ptr<charsetsList_t> charsets(std::make_shared<charsetsList_t>());
                     std::shared_ptr<data> metaInformationTag(std::make_shared<data>(tagVR_t::OB, charsets));
                     {
@@ -151,7 +215,7 @@ void dicomStreamCodec::buildStream(std::shared_ptr<streamWriter> pStream, std::s
                     }
                     temporaryTags[0x13] = implementationNameTag;
 
-                    writeGroup(pStream, temporaryTags, *scanGroups, bExplicitDataType, endianType);
+                    writeGroup(pStream, dataSet::tTags(temporaryTags.begin(), temporaryTags.end()), *scanGroups, bExplicitDataType, endianType);
                 }
             }
             else
@@ -596,7 +660,7 @@ std::uint32_t dicomStreamCodec::getDataSetLength(std::shared_ptr<dataSet> pDataS
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-void dicomStreamCodec::readStream(std::shared_ptr<streamReader> pStream, std::shared_ptr<dataSet> pDataSet, std::uint32_t maxSizeBufferLoad /* = 0xffffffff */) const
+void dicomStreamCodec::readStream(std::shared_ptr<streamReader> pStream, std::shared_ptr<dataSet> pDataSet, std::uint32_t maxSizeBufferLoad /* = 0xffffffff */, std::uint32_t stopTag /* = 0xffffffff */) const
 {
     IMEBRA_FUNCTION_START();
 
@@ -651,15 +715,13 @@ void dicomStreamCodec::readStream(std::shared_ptr<streamReader> pStream, std::sh
         // Set "explicit data type" to true if a valid data type
         //  is found
         ///////////////////////////////////////////////////////////
-        std::string firstDataType;
-        firstDataType.push_back((char)(oldDicomSignature[4]));
-        firstDataType.push_back((char)(oldDicomSignature[5]));
-        bExplicitDataType = dicomDictionary::getDicomDictionary()->isDataTypeValid(firstDataType);
+        tagVR_t firstDataType;
+        bExplicitDataType = dicomDictionary::getDicomDictionary()->findDataType((const char*)&(oldDicomSignature[4]), firstDataType);
     }
 
     // Signature OK. Now scan all the tags.
     ///////////////////////////////////////////////////////////
-    parseStream(pStream, pDataSet, bExplicitDataType, endianType, maxSizeBufferLoad);
+    parseStream(pStream, pDataSet, bExplicitDataType, endianType, maxSizeBufferLoad, 0xffffffff, 0, 0, stopTag);
 
     IMEBRA_FUNCTION_END();
 }
@@ -680,7 +742,8 @@ void dicomStreamCodec::parseStream(std::shared_ptr<streamReader> pStream,
                              std::uint32_t maxSizeBufferLoad /* = 0xffffffff */,
                              std::uint32_t subItemLength /* = 0xffffffff */,
                              std::uint32_t* pReadSubItemLength /* = 0 */,
-                             std::uint32_t depth)
+                             std::uint32_t depth /* = 0 */,
+                             std::uint32_t stopTag /* = 0xffffffff */)
 {
     IMEBRA_FUNCTION_START();
 
@@ -786,6 +849,14 @@ void dicomStreamCodec::parseStream(std::shared_ptr<streamReader> pStream,
         pStream->adjustEndian((std::uint8_t*)&tagSubId, sizeof(tagSubId), endianType);
         (*pReadSubItemLength) += (std::uint32_t)sizeof(tagSubId);
 
+        // Stop before the requested tag: the rest of the stream
+        //  is not parsed
+        ///////////////////////////////////////////////////////////
+        if(depth == 0 && (((std::uint32_t)tagId << 16) | tagSubId) >= stopTag)
+        {
+            break;
+        }
+
         // Check for the end of the dataset
         ///////////////////////////////////////////////////////////
         if(tagId==0xfffe && tagSubId==0xe00d)
@@ -807,9 +878,9 @@ void dicomStreamCodec::parseStream(std::shared_ptr<streamReader> pStream,
         {
             // Get the tag's type
             ///////////////////////////////////////////////////////////
-            std::string tagTypeString((size_t)2, ' ');
+            char tagTypeString[2];
 
-            pStream->read((std::uint8_t*)&(tagTypeString[0]), 2);
+            pStream->read((std::uint8_t*)tagTypeString, 2);
             (*pReadSubItemLength) += 2;
 
             // Get the tag's length
@@ -820,9 +891,8 @@ void dicomStreamCodec::parseStream(std::shared_ptr<streamReader> pStream,
 
             // The data type is valid
             ///////////////////////////////////////////////////////////
-            try
+            if(dicomDictionary::getDicomDictionary()->findDataType(tagTypeString, tagType))
             {
-                tagType = dicomDictionary::getDicomDictionary()->stringDataTypeToEnum(tagTypeString);
                 tagLengthDWord=(std::uint32_t)tagLengthWord;
                 wordSize = dicomDictionary::getDicomDictionary()->getWordSize(tagType);
                 if(dicomDictionary::getDicomDictionary()->getLongLength(tagType))
@@ -832,7 +902,7 @@ void dicomStreamCodec::parseStream(std::shared_ptr<streamReader> pStream,
                     (*pReadSubItemLength) += (std::uint32_t)sizeof(tagLengthDWord);
                 }
             }
-            catch(const DictionaryUnknownDataTypeError&)
+            else
             {
                 // The data type is not valid. Switch to implicit data type
                 ///////////////////////////////////////////////////////////
@@ -876,11 +946,7 @@ void dicomStreamCodec::parseStream(std::shared_ptr<streamReader> pStream,
             }
             else
             {
-                try
-                {
-                    tagType = dicomDictionary::getDicomDictionary()->getTagType(tagId, tagSubId);
-                }
-                catch(const DictionaryUnknownTagError&)
+                if(!dicomDictionary::getDicomDictionary()->findTagType(tagId, tagSubId, tagType))
                 {
                     tagType = tagVR_t::UN;
                 }
@@ -1085,6 +1151,38 @@ std::uint32_t dicomStreamCodec::readTag(
         return (std::uint32_t)bufferLength;
     }
 
+    // Small values are read directly into the dataset's
+    //  arena, without allocating a data handler and its
+    //  memory
+    ///////////////////////////////////////////////////////////
+    if(tagLengthDWord != 0 && tagLengthDWord <= IMEBRA_ARENA_MAX_VALUE_SIZE && !(tagId == 0xfffc && tagSubId == 0xfffc))
+    {
+        if(!pStream->isDataAvailable(tagLengthDWord))
+        {
+            IMEBRA_THROW(StreamEOFError, "The tag's length exceeds the stream's size");
+        }
+
+        // The value returns to the arena when the memory that
+        //  references it is released (e.g. when the tag is
+        //  modified)
+        ///////////////////////////////////////////////////////////
+        const std::shared_ptr<arena>& pArena(pDataSet->getArena());
+        std::shared_ptr<std::uint8_t> pValue(
+                    static_cast<std::uint8_t*>(pArena->allocate(tagLengthDWord, 1)),
+                    arenaDeleter(pArena, tagLengthDWord),
+                    arenaAllocator<std::uint8_t>(pArena));
+        pStream->read(pValue.get(), tagLengthDWord);
+        if(wordSize != 0)
+        {
+            pStream->adjustEndian(pValue.get(), wordSize, endianType, tagLengthDWord / wordSize);
+        }
+
+        pDataSet->getTagCreate(tagId, order, tagSubId, tagType)->getBufferCreate(bufferId)->commit(
+                    std::allocate_shared<memory>(arenaAllocator<memory>(pArena), pValue, pValue.get(), (size_t)tagLengthDWord));
+
+        return (std::uint32_t)tagLengthDWord;
+    }
+
     // Allocate the tag's buffer
     ///////////////////////////////////////////////////////////
     std::shared_ptr<handlers::writingDataHandlerRaw> handler(pDataSet->getWritingDataHandlerRaw(tagId, order, tagSubId, bufferId, tagType));
@@ -1096,70 +1194,37 @@ std::uint32_t dicomStreamCodec::readTag(
         return 0;
     }
 
-    // In order to deal with damaged tags asking for an
-    //  incredible amount of memory, this function reads the
-    //  tag using a lot of small buffers (32768 bytes max)
-    //  and then the tag's buffer is rebuilt at the end of the
-    //  function.
-    // This method saves a lot of time if a huge amount of
-    //  memory is asked by a damaged tag, since only the amount
-    //  of memory actually stored in the source file is
+    // Damaged tags may ask for an incredible amount of
+    //  memory. When the stream is seekable the tag's length
+    //  is checked against the stream's size before the
+    //  buffer is allocated, then the tag is read directly
+    //  into its buffer.
+    // The size of a non seekable stream is unknown: the
+    //  buffer grows geometrically while the data is read, so
+    //  only the memory actually stored in the stream is
     //  allocated
     ///////////////////////////////////////////////////////////
-
-    // If the buffer size is bigger than the following const
-    //  variable, then read the buffer in small chunks
-    ///////////////////////////////////////////////////////////
     const std::uint32_t smallBuffersSize(32768);
 
-    if(tagLengthDWord <= smallBuffersSize) // Read in one go
+    if(tagLengthDWord <= smallBuffersSize || pStream->seekable()) // Read in one go
     {
+        if(!pStream->isDataAvailable(tagLengthDWord))
+        {
+            IMEBRA_THROW(StreamEOFError, "The tag's length exceeds the stream's size");
+        }
         handler->setSize(tagLengthDWord);
         pStream->read(handler->getMemoryBuffer(), tagLengthDWord);
     }
-    else // Read in small chunks
+    else // Grow the buffer while reading
     {
-        std::list<std::vector<std::uint8_t> > buffers;
-
-        // Used to keep track of the read bytes
-        ///////////////////////////////////////////////////////////
-        std::uint32_t remainingBytes(tagLengthDWord);
-
-        // Fill all the small buffers
-        ///////////////////////////////////////////////////////////
-        while(remainingBytes != 0)
-        {
-            // Calculate the small buffer's size and allocate it
-            ///////////////////////////////////////////////////////////
-            std::uint32_t thisBufferSize( (remainingBytes > smallBuffersSize) ? smallBuffersSize : remainingBytes);
-            buffers.push_back(std::vector<std::uint8_t>());
-            buffers.back().resize(thisBufferSize);
-
-            // Fill the buffer
-            ///////////////////////////////////////////////////////////
-            pStream->read(&buffers.back()[0], thisBufferSize);
-
-            // Decrease the number of the remaining bytes
-            ///////////////////////////////////////////////////////////
-            remainingBytes -= thisBufferSize;
-        }
-
-        // Copy the small buffers into the tag object
-        ///////////////////////////////////////////////////////////
-        handler->setSize(tagLengthDWord);
-        std::uint8_t* pHandlerBuffer(handler->getMemoryBuffer());
-
-        // Scan all the small buffers and copy their content into
-        //  the final buffer
-        ///////////////////////////////////////////////////////////
-        std::list<std::vector<std::uint8_t> >::iterator smallBuffersIterator;
-        remainingBytes = tagLengthDWord;
-        for(smallBuffersIterator=buffers.begin(); smallBuffersIterator != buffers.end(); ++smallBuffersIterator)
+        std::uint32_t readBytes(0);
+        std::uint32_t bufferSize(smallBuffersSize);
+        while(readBytes != tagLengthDWord)
         {
-            std::uint32_t copySize=(remainingBytes>smallBuffersSize) ? smallBuffersSize : remainingBytes;
-            ::memcpy(pHandlerBuffer, &(*smallBuffersIterator)[0], copySize);
-            pHandlerBuffer += copySize;
-            remainingBytes -= copySize;
+            handler->setSize(bufferSize);
+            pStream->read(handler->getMemoryBuffer() + readBytes, bufferSize - readBytes);
+            readBytes = bufferSize;
+            bufferSize = (tagLengthDWord - bufferSize > bufferSize) ? bufferSize * 2 : tagLengthDWord;
         }
     } // end of reading from stream
 
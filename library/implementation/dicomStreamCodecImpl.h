@@ -104,6 +104,10 @@ public:
     ///                    - >=1 = dataset embedded into
     ///                      another dataset. This value is
     ///                      used to prevent a stack overflow
+    /// @param stopTag    the parsing of the root dataset
+    ///                    stops before the first tag with an
+    ///                    id equal or greater than this one,
+    ///                    expressed as (groupId << 16) | tagId
     ///
     ///////////////////////////////////////////////////////////
     static void parseStream(
@@ -114,7 +118,8 @@ public:
         std::uint32_t maxSizeBufferLoad = 0xffffffff,
         std::uint32_t subItemLength = 0xffffffff,
         std::uint32_t* pReadSubItemLength = 0,
-        std::uint32_t depth = 0);
+        std::uint32_t depth = 0,
+        std::uint32_t stopTag = 0xffffffff);
 
     /// \brief Indicates the type of DICOM stream to build
     ///
@@ -136,9 +141,35 @@ public:
     ///                   the data type is implicit
     /// @param endianType the endian type to be generated
     /// @param streamType the type of DICOM stream to build
+    /// @param firstTag  the first tag to write, as
+    ///                   (groupId << 16) | tagId
+    /// @param endTag    the tag following the last one to
+    ///                   write, as (groupId << 16) | tagId.
+    ///                  The tags in the range are written
+    ///                   for all the group orders
     ///
     ///////////////////////////////////////////////////////////
-    static void buildStream(std::shared_ptr<streamWriter> pStream, std::shared_ptr<const dataSet> pDataSet, bool bExplicitDataType, streamController::tByteOrdering endianType, streamType_t streamType);
+    static void buildStream(std::shared_ptr<streamWriter> pStream, std::shared_ptr<const dataSet> pDataSet, bool bExplicitDataType, streamController::tByteOrdering endianType, streamType_t streamType, std::uint32_t firstTag = 0, std::uint32_t endTag = 0xffffffff);
+
+    /// \brief Write the 128 bytes preamble and the DICM
+    ///         signature that precede a DICOM file.
+    ///
+    /// @param pStream   the destination stream
+    ///
+    ///////////////////////////////////////////////////////////
+    static void writePreamble(std::shared_ptr<streamWriter> pStream);
+
+    /// \brief Return the data type mode and the byte
+    ///         ordering used by a transfer syntax.
+    ///
+    /// @param transferSyntax     the transfer syntax
+    /// @param pbExplicitDataType set to true if the transfer
+    ///                            syntax uses explicit VR
+    /// @param pEndianType        set to the transfer syntax's
+    ///                            byte ordering
+    ///
+    ///////////////////////////////////////////////////////////
+    static void getTransferSyntaxEncoding(const std::string& transferSyntax, bool* pbExplicitDataType, streamController::tByteOrdering* pEndianType);
 
 protected:
     // Write a dicom stream
@@ -147,7 +178,7 @@ protected:
 
     // Load a dicom stream
     ///////////////////////////////////////////////////////////
-    virtual void readStream(std::shared_ptr<streamReader> pStream, std::shared_ptr<dataSet> pDataSet, std::uint32_t maxSizeBufferLoad = 0xffffffff) const;
+    virtual void readStream(std::shared_ptr<streamReader> pStream, std::shared_ptr<dataSet> pDataSet, std::uint32_t maxSizeBufferLoad = 0xffffffff, std::uint32_t stopTag = 0xffffffff) const;
 
 protected:
     // Read a single tag
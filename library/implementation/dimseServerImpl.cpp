@@ -0,0 +1,537 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file dimseServerImpl.cpp
+    \brief Implementation of the SCP server that serves several associations
+           through a tcpReactor.
+
+*/
+
+#include "dimseServerImpl.h"
+#include "dimseImpl.h"
+#include "acseImpl.h"
+#include "tcpSequenceStreamImpl.h"
+#include "pduAssemblerImpl.h"
+#include "streamReaderImpl.h"
+#include "streamWriterImpl.h"
+#include "exceptionImpl.h"
+#include "../include/imebra/exceptions.h"
+#include <vector>
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+dimseServer::dimseServer(
+        const std::shared_ptr<tcpListener>& pListener,
+        const std::shared_ptr<const presentationContexts>& contexts,
+        const std::string& thisAET,
+        std::uint32_t maxOperationsWeInvoke,
+        std::uint32_t maxOperationsWeCanPerform,
+        std::uint32_t dimseTimeoutSeconds,
+        std::uint32_t artimTimeoutSeconds,
+        const std::shared_ptr<const payloadSpoolFolders>& spoolFolders,
+        size_t workerThreads,
+        const commandsHandler_t& commandsHandler):
+    m_pListener(pListener),
+    m_pPresentationContexts(contexts),
+    m_thisAET(thisAET),
+    m_maxOperationsWeInvoke(maxOperationsWeInvoke),
+    m_maxOperationsWeCanPerform(maxOperationsWeCanPerform),
+    m_dimseTimeoutSeconds(dimseTimeoutSeconds),
+    m_artimTimeoutSeconds(artimTimeoutSeconds),
+    m_pSpoolFolders(spoolFolders == nullptr ? nullptr : std::make_shared<payloadSpoolFolders>(*spoolFolders)),
+    m_commandsHandler(commandsHandler),
+    m_bTerminated(false),
+    m_idleContextThreads(0),
+    m_reactor(workerThreads)
+{
+    IMEBRA_FUNCTION_START();
+
+    m_reactor.addSocket(m_pListener->getSocketHandle(), [this](bool /* bTimeout */){ acceptConnection(); }, 0);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+dimseServer::~dimseServer()
+{
+    terminate();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Stop the server
+//
+///////////////////////////////////////////////////////////
+void dimseServer::terminate()
+{
+    if(m_bTerminated.exchange(true))
+    {
+        return;
+    }
+
+    m_reactor.removeSocket(m_pListener->getSocketHandle());
+    m_pListener->terminate();
+
+    // Abort the associations and close the connections:
+    // the handlers waiting for data exit with an exception
+    ///////////////////////////////////////////////////////////
+    std::vector<std::shared_ptr<connection> > connections;
+    std::vector<std::shared_ptr<associationSCP> > associations;
+    {
+        std::unique_lock<std::mutex> lock(m_lockConnections);
+        for(const connections_t::value_type& openConnection: m_connections)
+        {
+            m_reactor.removeSocket(openConnection.first);
+            connections.push_back(openConnection.second);
+            associations.push_back(openConnection.second->m_pAssociation);
+        }
+    }
+
+    for(size_t scanConnections(0); scanConnections != connections.size(); ++scanConnections)
+    {
+        try
+        {
+            if(associations[scanConnections] != nullptr)
+            {
+                associations[scanConnections]->abort(acsePDUAAbort::reason_t::serviceUser);
+            }
+        }
+        catch(const std::exception&)
+        {
+            // The connection is being closed anyway
+        }
+        connections[scanConnections]->m_pReader->terminate();
+    }
+
+    m_reactor.terminate();
+
+    // Wait for the running handler contexts. The scheduled
+    // ones are discarded
+    ///////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(m_lockContexts);
+        m_scheduledContexts.clear();
+        m_notifyContexts.notify_all();
+    }
+    for(std::thread& contextThread: m_contextThreads)
+    {
+        contextThread.join();
+    }
+
+    std::unique_lock<std::mutex> lock(m_lockConnections);
+    m_connections.clear();
+}
+
+
+size_t dimseServer::getConnectionsCount() const
+{
+    std::unique_lock<std::mutex> lock(m_lockConnections);
+    return m_connections.size();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Accept a connection and start monitoring it
+//
+///////////////////////////////////////////////////////////
+void dimseServer::acceptConnection()
+{
+    try
+    {
+        std::shared_ptr<connection> pConnection(std::make_shared<connection>());
+        pConnection->m_pStream = m_pListener->waitForConnection();
+        const int socket(pConnection->m_pStream->getSocketHandle());
+        pConnection->m_socket = socket;
+        pConnection->m_pAssembler = std::make_shared<pduAssembler>(
+                    pConnection->m_pStream,
+                    MAXIMUM_PDU_SIZE,
+                    m_dimseTimeoutSeconds,
+                    [this, socket](){ resumeConnection(socket); });
+        pConnection->m_pReader = std::make_shared<streamReader>(pConnection->m_pAssembler);
+        pConnection->m_pWriter = std::make_shared<streamWriter>(std::make_shared<tcpSequenceStreamOutput>(pConnection->m_pStream));
+        pConnection->m_bContextRunning = false;
+
+        // The association request must arrive within the
+        // ARTIM timeout
+        ///////////////////////////////////////////////////////////
+        pConnection->m_bHasDeadline = (m_artimTimeoutSeconds != 0);
+        pConnection->m_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(m_artimTimeoutSeconds);
+
+        {
+            std::unique_lock<std::mutex> lock(m_lockConnections);
+            if(m_bTerminated.load())
+            {
+                return;
+            }
+            m_connections[socket] = pConnection;
+        }
+
+        m_reactor.addSocket(socket, [this, socket](bool bTimeout){ processConnection(socket, bTimeout); }, m_artimTimeoutSeconds);
+    }
+    catch(const std::exception&)
+    {
+        // The connection is dropped
+    }
+
+    if(!m_bTerminated.load())
+    {
+        m_reactor.rearmSocket(m_pListener->getSocketHandle(), 0);
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Collect the incoming data and start the handler context
+//  when a whole PDU has been received
+//
+///////////////////////////////////////////////////////////
+void dimseServer::processConnection(int socket, bool bTimeout)
+{
+    std::shared_ptr<connection> pConnection;
+    {
+        std::unique_lock<std::mutex> lock(m_lockConnections);
+        connections_t::const_iterator findConnection(m_connections.find(socket));
+        if(findConnection == m_connections.end())
+        {
+            return;
+        }
+        pConnection = findConnection->second;
+    }
+
+    std::unique_lock<std::mutex> lockContext(pConnection->m_lockContext);
+
+    try
+    {
+        bool bMonitor(true);
+        if(!bTimeout)
+        {
+            bMonitor = pConnection->m_pAssembler->receive();
+
+            if(!pConnection->m_bContextRunning)
+            {
+                if(pConnection->m_pAssembler->getCompletePDUs() != 0)
+                {
+                    pConnection->m_bContextRunning = true;
+                    pConnection->m_bHasDeadline = false;
+                    pConnection->m_pAssembler->setBlockingReads(true);
+                    scheduleContext(pConnection);
+                }
+                else if(pConnection->m_pAssembler->isClosed())
+                {
+                    // The peer closed the connection
+                    ///////////////////////////////////////////////////////////
+                    lockContext.unlock();
+                    closeConnection(socket);
+                    return;
+                }
+            }
+        }
+
+        if(pConnection->m_bContextRunning)
+        {
+            // Keep feeding the handler context. The context
+            // applies the DIMSE timeout to its reads.
+            // When the buffer is full the connection is monitored
+            // again when the context has read part of the data,
+            // when the peer closed the connection the context
+            // closes it
+            ///////////////////////////////////////////////////////////
+            if(bMonitor && !m_bTerminated.load())
+            {
+                m_reactor.rearmSocket(socket, 0);
+            }
+            return;
+        }
+
+        monitorConnection(pConnection);
+        return;
+    }
+    catch(const AcseCorruptedMessageError&)
+    {
+        // A PDU exceeds the maximum length
+        ///////////////////////////////////////////////////////////
+        IMEBRA_LOG_INFO("-- Received a PDU that is too long, aborting the association");
+        abortConnection(*pConnection, acsePDUAAbort::reason_t::serviceProviderInvalidPDUParameterValue);
+    }
+    catch(const std::exception&)
+    {
+        abortConnection(*pConnection, acsePDUAAbort::reason_t::serviceUser);
+    }
+
+    lockContext.unlock();
+    closeConnection(socket);
+}
+
+
+void dimseServer::resumeConnection(int socket)
+{
+    std::unique_lock<std::mutex> lock(m_lockConnections);
+    if(m_bTerminated.load() || m_connections.find(socket) == m_connections.end())
+    {
+        return;
+    }
+    m_reactor.rearmSocket(socket, 0);
+}
+
+
+void dimseServer::monitorConnection(const std::shared_ptr<connection>& pConnection)
+{
+    // Monitor the connection again. The timeout is checked
+    // also after the partial reads, so a peer that stops
+    // sending in the middle of a PDU is disconnected
+    ///////////////////////////////////////////////////////////
+    std::uint32_t timeoutSeconds(0);
+    if(getConnectionTimeout(*pConnection, timeoutSeconds))
+    {
+        if(!m_bTerminated.load())
+        {
+            m_reactor.rearmSocket(pConnection->m_socket, timeoutSeconds);
+        }
+        return;
+    }
+
+    if(pConnection->m_pAssociation == nullptr)
+    {
+        IMEBRA_LOG_INFO("-- ARTIM timeout expired, closing the connection");
+    }
+    else
+    {
+        IMEBRA_LOG_INFO("-- DIMSE timeout expired, aborting the association");
+        abortConnection(*pConnection, acsePDUAAbort::reason_t::serviceUser);
+    }
+    closeConnection(pConnection->m_socket);
+}
+
+
+void dimseServer::scheduleContext(const std::shared_ptr<connection>& pConnection)
+{
+    std::unique_lock<std::mutex> lock(m_lockContexts);
+    if(m_bTerminated.load())
+    {
+        return;
+    }
+
+    m_scheduledContexts.push_back(pConnection);
+
+    // Launch a new thread when all the threads are busy
+    ///////////////////////////////////////////////////////////
+    if(m_scheduledContexts.size() > m_idleContextThreads)
+    {
+        m_contextThreads.emplace_back(&dimseServer::contextThread, this);
+    }
+    m_notifyContexts.notify_one();
+}
+
+
+void dimseServer::contextThread()
+{
+    std::unique_lock<std::mutex> lock(m_lockContexts);
+    for(;;)
+    {
+        while(m_scheduledContexts.empty() && !m_bTerminated.load())
+        {
+            ++m_idleContextThreads;
+            m_notifyContexts.wait(lock);
+            --m_idleContextThreads;
+        }
+        if(m_bTerminated.load())
+        {
+            return;
+        }
+
+        std::shared_ptr<connection> pConnection(m_scheduledContexts.front());
+        m_scheduledContexts.pop_front();
+
+        lock.unlock();
+        runContext(pConnection);
+        lock.lock();
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Negotiate the association, then decode the received
+//  datasets and process the commands. The reads wait for
+//  the PDUs that are still being received
+//
+///////////////////////////////////////////////////////////
+void dimseServer::runContext(const std::shared_ptr<connection>& pConnection)
+{
+    try
+    {
+        for(;;)
+        {
+            if(pConnection->m_pAssociation == nullptr)
+            {
+                std::shared_ptr<associationSCP> pAssociation(
+                            std::make_shared<associationSCP>(
+                                m_pPresentationContexts,
+                                m_thisAET,
+                                m_maxOperationsWeInvoke,
+                                m_maxOperationsWeCanPerform,
+                                pConnection->m_pReader,
+                                pConnection->m_pWriter,
+                                m_dimseTimeoutSeconds,
+                                m_artimTimeoutSeconds,
+                                m_pSpoolFolders,
+                                false));
+                std::unique_lock<std::mutex> lock(m_lockConnections);
+                pConnection->m_pAssociation = pAssociation;
+                pConnection->m_pDimseService = std::make_shared<dimseService>(pAssociation);
+            }
+            else if(!pConnection->m_pAssociation->readMessage())
+            {
+                // The association has been released or aborted
+                ///////////////////////////////////////////////////////////
+                closeConnection(pConnection->m_socket);
+                return;
+            }
+
+            while(pConnection->m_pAssociation->isCommandPending())
+            {
+                m_commandsHandler(pConnection->m_pDimseService);
+            }
+
+            // Exit when all the received PDUs have been processed:
+            // the reactor starts the context again when the next
+            // PDU arrives
+            ///////////////////////////////////////////////////////////
+            std::unique_lock<std::mutex> lockContext(pConnection->m_lockContext);
+            if(pConnection->m_pAssembler->getCompletePDUs() == 0)
+            {
+                if(pConnection->m_pAssembler->isClosed())
+                {
+                    lockContext.unlock();
+                    closeConnection(pConnection->m_socket);
+                    return;
+                }
+                pConnection->m_bContextRunning = false;
+                pConnection->m_pAssembler->setBlockingReads(false);
+                monitorConnection(pConnection);
+                return;
+            }
+        }
+    }
+    catch(const StreamEOFError&)
+    {
+        // The association has been released or aborted
+    }
+    catch(const std::exception&)
+    {
+        abortConnection(*pConnection, acsePDUAAbort::reason_t::serviceUser);
+    }
+
+    closeConnection(pConnection->m_socket);
+}
+
+
+bool dimseServer::getConnectionTimeout(connection& activeConnection, std::uint32_t& timeoutSeconds) const
+{
+    // Start the DIMSE timeout when the first part of a dataset
+    // arrives, stop it when the dataset is complete
+    ///////////////////////////////////////////////////////////
+    if(activeConnection.m_pAssociation != nullptr)
+    {
+        if(!activeConnection.m_pAssembler->isReceivingUnit() || m_dimseTimeoutSeconds == 0)
+        {
+            activeConnection.m_bHasDeadline = false;
+        }
+        else if(!activeConnection.m_bHasDeadline)
+        {
+            activeConnection.m_bHasDeadline = true;
+            activeConnection.m_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(m_dimseTimeoutSeconds);
+        }
+    }
+
+    timeoutSeconds = 0;
+    if(!activeConnection.m_bHasDeadline)
+    {
+        return true;
+    }
+
+    const std::chrono::milliseconds::rep remainingMs(
+                std::chrono::duration_cast<std::chrono::milliseconds>(activeConnection.m_deadline - std::chrono::steady_clock::now()).count());
+    if(remainingMs <= 0)
+    {
+        return false;
+    }
+    timeoutSeconds = (std::uint32_t)((remainingMs + 999) / 1000);
+    return true;
+}
+
+
+void dimseServer::abortConnection(const connection& activeConnection, acsePDUAAbort::reason_t reason)
+{
+    try
+    {
+        std::shared_ptr<associationSCP> pAssociation;
+        {
+            std::unique_lock<std::mutex> lock(m_lockConnections);
+            pAssociation = activeConnection.m_pAssociation;
+        }
+        if(pAssociation != nullptr)
+        {
+            pAssociation->abort(reason);
+        }
+        else if(!activeConnection.m_bContextRunning)
+        {
+            // The association request hasn't been processed yet
+            ///////////////////////////////////////////////////////////
+            std::make_shared<acsePDUAAbort>(reason)->encodePDU(activeConnection.m_pWriter);
+        }
+    }
+    catch(const std::exception&)
+    {
+        // The connection is being closed anyway
+    }
+}
+
+
+void dimseServer::closeConnection(int socket)
+{
+    if(m_bTerminated.load())
+    {
+        // terminate() removes the connections
+        return;
+    }
+
+    std::shared_ptr<connection> pConnection;
+    {
+        std::unique_lock<std::mutex> lock(m_lockConnections);
+        connections_t::iterator findConnection(m_connections.find(socket));
+        if(findConnection == m_connections.end())
+        {
+            return;
+        }
+        pConnection = findConnection->second;
+        m_connections.erase(findConnection);
+    }
+
+    m_reactor.removeSocket(socket);
+
+    // Unblock the handler context waiting for data
+    ///////////////////////////////////////////////////////////
+    pConnection->m_pReader->terminate();
+}
+
+} // namespace implementation
+
+} // namespace imebra
@@ -0,0 +1,299 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+
+/*! \file dimseServerImpl.h
+    \brief Declaration of the SCP server that serves several associations
+           through a tcpReactor.
+
+*/
+
+#if !defined(imebraDimseServer_D58B2C8F_4C6F_4AEB_B26E_42DBE6E764D3__INCLUDED_)
+#define imebraDimseServer_D58B2C8F_4C6F_4AEB_B26E_42DBE6E764D3__INCLUDED_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "acseImpl.h"
+#include "tcpReactorImpl.h"
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+class tcpListener;
+class tcpSequenceStream;
+class pduAssembler;
+class streamReader;
+class streamWriter;
+class presentationContexts;
+class payloadSpoolFolders;
+class associationSCP;
+class dimseService;
+
+///
+/// \brief Accepts the connections arriving on a tcpListener,
+///        negotiates the associations and dispatches the
+///        incoming DIMSE commands to a handler.
+///
+/// The associations don't have a reading thread: the sockets
+///  are monitored by a tcpReactor, and the data is collected
+///  by a pduAssembler on one of the reactor's worker threads
+///  when it arrives.
+///
+/// When a whole PDU has been received the association is
+///  handed to a handler context, executed by a separate pool
+///  of threads that grows on demand: the context decodes the
+///  datasets while their PDUs arrive and calls the handler
+///  for the received commands. The handler can wait for other
+///  messages (e.g. the responses to the C-STORE commands
+///  related to a C-GET, or a C-CANCEL): the reactor keeps
+///  feeding the pduAssembler while the handler waits.
+///
+/// The context ends when all the received PDUs have been
+///  processed, so idle or stalled peers don't occupy any
+///  thread.
+///
+//////////////////////////////////////////////////////////////////
+class dimseServer
+{
+public:
+    ///
+    /// \brief Function called to process the commands waiting on
+    ///        an association. It must retrieve one command via
+    ///        dimseService::getCommand() and reply to it.
+    ///
+    //////////////////////////////////////////////////////////////////
+    typedef std::function<void(const std::shared_ptr<dimseService>&)> commandsHandler_t;
+
+    ///
+    /// \brief Constructor. Starts accepting connections
+    ///        immediately.
+    ///
+    /// \param pListener            the listener that supplies the
+    ///                             connections
+    /// \param contexts             accepted presentation contexts
+    /// \param thisAET              accepted called AET. Leave empty
+    ///                             to accept all the called AETs
+    /// \param maxOperationsWeInvoke max number of simultaneous
+    ///                             operation that the SCP will
+    ///                             invoke on the peers
+    /// \param maxOperationsWeCanPerform maximum number of
+    ///                             simultaneous operations that the
+    ///                             SCP can perform
+    /// \param dimseTimeoutSeconds  DIMSE timeout, in seconds. 0
+    ///                             means infinite
+    /// \param artimTimeoutSeconds  maximum time, in seconds, that can
+    ///                             pass between the connection and
+    ///                             the association request
+    /// \param spoolFolders         folders where the received
+    ///                             payloads are spooled, per abstract
+    ///                             syntax. Can be null
+    /// \param workerThreads        number of threads that collect
+    ///                             the incoming data
+    /// \param commandsHandler      function called to process the
+    ///                             incoming commands
+    ///
+    //////////////////////////////////////////////////////////////////
+    dimseServer(
+            const std::shared_ptr<tcpListener>& pListener,
+            const std::shared_ptr<const presentationContexts>& contexts,
+            const std::string& thisAET,
+            std::uint32_t maxOperationsWeInvoke,
+            std::uint32_t maxOperationsWeCanPerform,
+            std::uint32_t dimseTimeoutSeconds,
+            std::uint32_t artimTimeoutSeconds,
+            const std::shared_ptr<const payloadSpoolFolders>& spoolFolders,
+            size_t workerThreads,
+            const commandsHandler_t& commandsHandler);
+
+    ///
+    /// \brief Destructor. Calls terminate().
+    ///
+    //////////////////////////////////////////////////////////////////
+    ~dimseServer();
+
+    ///
+    /// \brief Stops accepting connections, aborts the open
+    ///        associations and waits for the running handler
+    ///        contexts to exit.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void terminate();
+
+    ///
+    /// \brief Returns the number of open connections.
+    ///
+    /// \return the number of open connections
+    ///
+    //////////////////////////////////////////////////////////////////
+    size_t getConnectionsCount() const;
+
+private:
+    struct connection
+    {
+        int m_socket;
+        std::shared_ptr<tcpSequenceStream> m_pStream;
+        std::shared_ptr<pduAssembler> m_pAssembler;
+        std::shared_ptr<streamReader> m_pReader;
+        std::shared_ptr<streamWriter> m_pWriter;
+        std::shared_ptr<associationSCP> m_pAssociation;
+        std::shared_ptr<dimseService> m_pDimseService;
+
+        // Time by which the association request (ARTIM) or
+        //  the rest of a partially received dataset (DIMSE
+        //  timeout) must arrive
+        ///////////////////////////////////////////////////////////
+        bool m_bHasDeadline;
+        std::chrono::steady_clock::time_point m_deadline;
+
+        // true while the handler context is scheduled or
+        //  running. Protected by m_lockContext together with the
+        //  deadline
+        ///////////////////////////////////////////////////////////
+        bool m_bContextRunning;
+        std::mutex m_lockContext;
+    };
+
+    ///
+    /// \brief Called by the reactor when a connection is
+    ///        waiting on the listener.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void acceptConnection();
+
+    ///
+    /// \brief Called by the reactor when data arrives on a
+    ///        connection or when the ARTIM or DIMSE timeout
+    ///        expires.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void processConnection(int socket, bool bTimeout);
+
+    ///
+    /// \brief Called by the pduAssembler when the reactor
+    ///        can resume receiving data on a connection.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void resumeConnection(int socket);
+
+    ///
+    /// \brief Monitors a connection again after its data has
+    ///        been processed, or aborts it if its deadline has
+    ///        expired.
+    ///
+    /// Must be called with the connection's m_lockContext
+    ///  locked, when the handler context is not running.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void monitorConnection(const std::shared_ptr<connection>& pConnection);
+
+    ///
+    /// \brief Schedules the handler context of a connection
+    ///        on the handler threads.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void scheduleContext(const std::shared_ptr<connection>& pConnection);
+
+    ///
+    /// \brief Executed by the handler threads: runs the
+    ///        scheduled handler contexts.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void contextThread();
+
+    ///
+    /// \brief Negotiates the association, decodes the received
+    ///        datasets and calls the handler for the received
+    ///        commands until all the received PDUs have been
+    ///        processed.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void runContext(const std::shared_ptr<connection>& pConnection);
+
+    ///
+    /// \brief Returns the timeout to pass to the reactor when
+    ///        the connection is monitored again.
+    ///
+    /// Starts the DIMSE timeout when the connection has
+    ///  received part of a dataset, so the timeout covers
+    ///  all the partial reads of the dataset.
+    ///
+    /// \param activeConnection the connection to monitor
+    /// \param timeoutSeconds   set to the timeout in seconds
+    ///                         (0 = infinite)
+    /// \return false if the deadline has already expired
+    ///
+    //////////////////////////////////////////////////////////////////
+    bool getConnectionTimeout(connection& activeConnection, std::uint32_t& timeoutSeconds) const;
+
+    ///
+    /// \brief Sends an A-ABORT to the peer.
+    ///
+    /// Must be called with the connection's m_lockContext
+    ///  locked or from the handler context.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void abortConnection(const connection& activeConnection, acsePDUAAbort::reason_t reason);
+
+    ///
+    /// \brief Removes a connection from the reactor and from
+    ///        the open connections and unblocks its handler
+    ///        context.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void closeConnection(int socket);
+
+    const std::shared_ptr<tcpListener> m_pListener;
+    const std::shared_ptr<const presentationContexts> m_pPresentationContexts;
+    const std::string m_thisAET;
+    const std::uint32_t m_maxOperationsWeInvoke;
+    const std::uint32_t m_maxOperationsWeCanPerform;
+    const std::uint32_t m_dimseTimeoutSeconds;
+    const std::uint32_t m_artimTimeoutSeconds;
+    const std::shared_ptr<const payloadSpoolFolders> m_pSpoolFolders;
+    const commandsHandler_t m_commandsHandler;
+
+    typedef std::map<int, std::shared_ptr<connection> > connections_t;
+    connections_t m_connections;
+    mutable std::mutex m_lockConnections;
+
+    std::atomic<bool> m_bTerminated;
+
+    // Handler contexts waiting for a thread, and the threads
+    //  that execute them
+    ///////////////////////////////////////////////////////////
+    std::list<std::shared_ptr<connection> > m_scheduledContexts;
+    std::vector<std::thread> m_contextThreads;
+    size_t m_idleContextThreads;
+    std::mutex m_lockContexts;
+    std::condition_variable m_notifyContexts;
+
+    tcpReactor m_reactor;
+};
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraDimseServer_D58B2C8F_4C6F_4AEB_B26E_42DBE6E764D3__INCLUDED_)
@@ -32,6 +32,40 @@ namespace imebra
 namespace implementation
 {
 
+namespace
+{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Move the file pointer and read its position using 64 bit
+//  offsets, so files larger than 2GB can be accessed also
+//  where long is a 32 bit integer
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+int seekFile(FILE* pFile, size_t position, int origin)
+{
+#if defined(IMEBRA_WINDOWS)
+    return ::_fseeki64(pFile, static_cast<__int64>(position), origin);
+#else
+    return ::fseeko(pFile, static_cast<off_t>(position), origin);
+#endif
+}
+
+std::int64_t tellFile(FILE* pFile)
+{
+#if defined(IMEBRA_WINDOWS)
+    return static_cast<std::int64_t>(::_ftelli64(pFile));
+#else
+    return static_cast<std::int64_t>(::ftello(pFile));
+#endif
+}
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
@@ -70,6 +104,9 @@ fileStream::fileStream(const std::wstring& fileName, openMode mode)
     case openMode::write:
         strMode = L"wb";
         break;
+    case openMode::createNew:
+        strMode = L"wbx";
+        break;
     }
 
     errno_t errorCode = ::_wfopen_s(&m_openFile, fileName.c_str(), strMode.c_str());
@@ -90,6 +127,9 @@ fileStream::fileStream(const std::wstring& fileName, openMode mode)
     case openMode::write:
         strMode = "wb";
         break;
+    case openMode::createNew:
+        strMode = "wbx";
+        break;
     }
 
     m_openFile = ::fopen(utf8FileName.c_str(), strMode.c_str());
@@ -126,6 +166,9 @@ fileStream::fileStream(const std::string& fileName, openMode mode)
     case openMode::write:
         strMode = "wb";
         break;
+    case openMode::createNew:
+        strMode = "wbx";
+        break;
     }
 
 #if defined(IMEBRA_WINDOWS)
@@ -181,11 +224,11 @@ fileStreamInput::fileStreamInput(const std::wstring& fileName): fileStream(fileN
 {
 }
 
-fileStreamOutput::fileStreamOutput(const std::string& fileName): fileStream(fileName, openMode::write)
+fileStreamOutput::fileStreamOutput(const std::string& fileName, bool bCreateNew): fileStream(fileName, bCreateNew ? openMode::createNew : openMode::write)
 {
 }
 
-fileStreamOutput::fileStreamOutput(const std::wstring &fileName): fileStream(fileName, openMode::write)
+fileStreamOutput::fileStreamOutput(const std::wstring &fileName, bool bCreateNew): fileStream(fileName, bCreateNew ? openMode::createNew : openMode::write)
 {
 }
 
@@ -205,8 +248,7 @@ void fileStreamOutput::write(size_t startPosition, const std::uint8_t* pBuffer,
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    ::fseek(m_openFile, (long)startPosition, SEEK_SET);
-    if(ferror(m_openFile) != 0)
+    if(seekFile(m_openFile, startPosition, SEEK_SET) != 0 || ferror(m_openFile) != 0)
     {
         IMEBRA_THROW(StreamWriteError, "stream::seek failure");
     }
@@ -219,6 +261,11 @@ void fileStreamOutput::write(size_t startPosition, const std::uint8_t* pBuffer,
     IMEBRA_FUNCTION_END();
 }
 
+bool fileStreamOutput::seekable() const
+{
+    return true;
+}
+
 
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
@@ -235,8 +282,7 @@ size_t fileStreamInput::read(size_t startPosition, std::uint8_t* pBuffer, size_t
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    ::fseek(m_openFile, (long)startPosition, SEEK_SET);
-    if(ferror(m_openFile) != 0)
+    if(seekFile(m_openFile, startPosition, SEEK_SET) != 0 || ferror(m_openFile) != 0)
     {
         IMEBRA_THROW(StreamReadError, "stream::fseek failure");
     }
@@ -267,13 +313,12 @@ size_t fileStreamInput::getSize() const
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    ::fseek(m_openFile, 0, SEEK_END);
-    if(ferror(m_openFile) != 0)
+    if(seekFile(m_openFile, 0, SEEK_END) != 0 || ferror(m_openFile) != 0)
     {
         IMEBRA_THROW(StreamReadError, "stream::fseek failure");
     }
 
-    long int position = ::ftell(m_openFile);
+    std::int64_t position = tellFile(m_openFile);
     if(position < 0)
     {
         IMEBRA_THROW(StreamReadError, "stream::ftell failure");
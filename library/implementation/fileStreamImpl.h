@@ -38,7 +38,8 @@ public:
     enum class openMode: std::uint8_t
     {
         read = 0,
-        write = 1
+        write = 1,
+        createNew = 2 ///< write into a new file: fails if the file already exists
     };
 
     fileStream(const std::wstring& fileName, openMode mode);
@@ -89,9 +90,9 @@ public:
 class fileStreamOutput : public baseStreamOutput, public fileStream
 {
 public:
-    fileStreamOutput(const std::string& fileName);
+    fileStreamOutput(const std::string& fileName, bool bCreateNew = false);
 
-    fileStreamOutput(const std::wstring& fileName);
+    fileStreamOutput(const std::wstring& fileName, bool bCreateNew = false);
 
     ///////////////////////////////////////////////////////////
     //
@@ -100,6 +101,8 @@ public:
     ///////////////////////////////////////////////////////////
     virtual void write(size_t startPosition, const std::uint8_t* pBuffer, size_t bufferLength) override;
 
+    virtual bool seekable() const override;
+
 };
 
 } // namespace implementation
@@ -0,0 +1,132 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file fragmentsStreamImpl.cpp
+    \brief Implementation of the fragmentsStreamInput class.
+
+*/
+
+#include "exceptionImpl.h"
+#include "fragmentsStreamImpl.h"
+#include <algorithm>
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Append a fragment
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void fragmentsStreamInput::addFragment(std::shared_ptr<baseStreamInput> pStream, size_t startPosition, size_t length)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(length == 0)
+    {
+        return;
+    }
+
+    fragment newFragment;
+    newFragment.m_pStream = pStream;
+    newFragment.m_streamPosition = startPosition;
+    newFragment.m_virtualPosition = m_fragments.empty() ? 0 : m_fragments.back().m_virtualPosition + m_fragments.back().m_length;
+    newFragment.m_length = length;
+    m_fragments.push_back(newFragment);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Read raw data from the fragments
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+size_t fragmentsStreamInput::read(size_t startPosition, std::uint8_t* pBuffer, size_t bufferLength)
+{
+    IMEBRA_FUNCTION_START();
+
+    // Find the fragment containing the first byte
+    ///////////////////////////////////////////////////////////
+    std::vector<fragment>::const_iterator scanFragments(std::upper_bound(
+        m_fragments.begin(),
+        m_fragments.end(),
+        startPosition,
+        [](size_t position, const fragment& compareFragment)
+        {
+            return position < compareFragment.m_virtualPosition;
+        }));
+    if(scanFragments == m_fragments.begin())
+    {
+        return 0;
+    }
+    --scanFragments;
+
+    size_t readBytes(0);
+    for(; scanFragments != m_fragments.end() && readBytes != bufferLength; ++scanFragments)
+    {
+        const size_t fragmentOffset(startPosition + readBytes - scanFragments->m_virtualPosition);
+        if(fragmentOffset >= scanFragments->m_length)
+        {
+            continue;
+        }
+        const size_t readLength(std::min(bufferLength - readBytes, scanFragments->m_length - fragmentOffset));
+        const size_t fragmentReadBytes(scanFragments->m_pStream->read(scanFragments->m_streamPosition + fragmentOffset, pBuffer + readBytes, readLength));
+        readBytes += fragmentReadBytes;
+        if(fragmentReadBytes != readLength)
+        {
+            break;
+        }
+    }
+
+    return readBytes;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// The fragments' streams are shared with the dataset's
+//  buffers and are not terminated
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void fragmentsStreamInput::terminate()
+{
+}
+
+
+bool fragmentsStreamInput::seekable() const
+{
+    return true;
+}
+
+} // namespace implementation
+
+} // namespace imebra
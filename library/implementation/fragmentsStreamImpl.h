@@ -0,0 +1,91 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file fragmentsStreamImpl.h
+    \brief Declaration of the fragmentsStreamInput class.
+
+*/
+
+#if !defined(imebraFragmentsStream_5E0C2B7A_93D4_4C1E_A8F6_2D71B0E94C38__INCLUDED_)
+#define imebraFragmentsStream_5E0C2B7A_93D4_4C1E_A8F6_2D71B0E94C38__INCLUDED_
+
+#include "baseStreamImpl.h"
+#include <memory>
+#include <vector>
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief This class derives from the baseStreamInput
+///         class and presents a list of regions of other
+///         streams as one continuous stream.
+///
+/// It is used to decode the frames split into several
+///  fragments: the data is read directly from the
+///  fragments' streams (memory or file) without
+///  concatenating it into a temporary buffer.
+///
+/// The fragments must be added before the stream is read.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class fragmentsStreamInput : public baseStreamInput
+{
+
+public:
+    /// \brief Append a region of a stream to the list of
+    ///         fragments.
+    ///
+    /// @param pStream       the stream containing the
+    ///                       fragment
+    /// @param startPosition the position of the fragment's
+    ///                       first byte in pStream
+    /// @param length        the fragment's length, in bytes
+    ///
+    ///////////////////////////////////////////////////////////
+    void addFragment(std::shared_ptr<baseStreamInput> pStream, size_t startPosition, size_t length);
+
+    ///////////////////////////////////////////////////////////
+    //
+    // Virtual stream's functions
+    //
+    ///////////////////////////////////////////////////////////
+    virtual size_t read(size_t startPosition, std::uint8_t* pBuffer, size_t bufferLength) override;
+
+    virtual void terminate() override;
+
+    virtual bool seekable() const override;
+
+protected:
+    struct fragment
+    {
+        std::shared_ptr<baseStreamInput> m_pStream;
+        size_t m_streamPosition;  // < Position of the fragment in m_pStream
+        size_t m_virtualPosition; // < Position of the fragment in this stream
+        size_t m_length;
+    };
+
+    std::vector<fragment> m_fragments;
+};
+
+} // namespace implementation
+
+} // namespace imebra
+
+
+#endif // !defined(imebraFragmentsStream_5E0C2B7A_93D4_4C1E_A8F6_2D71B0E94C38__INCLUDED_)
@@ -0,0 +1,372 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file framesWriterImpl.cpp
+    \brief Implementation of the class framesWriter.
+
+*/
+
+#include "framesWriterImpl.h"
+#include "dicomStreamCodecImpl.h"
+#include "dicomDictImpl.h"
+#include "imageImpl.h"
+#include "memoryImpl.h"
+#include "streamWriterImpl.h"
+#include "exceptionImpl.h"
+#include "../include/imebra/exceptions.h"
+#include <mutex>
+#include <limits>
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Constructor
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+framesWriter::framesWriter(std::shared_ptr<dataSet> pDataSet, std::shared_ptr<streamWriter> pWriter, std::uint32_t framesNumber, imageQuality_t quality, bool bExtendedOffsetTable):
+    m_pDataSet(pDataSet),
+    m_pWriter(pWriter),
+    m_framesNumber(framesNumber),
+    m_quality(quality),
+    m_bExtendedOffsetTable(bExtendedOffsetTable),
+    m_bExplicitDataType(true),
+    m_endianType(streamController::lowByteEndian),
+    m_writtenFrames(0),
+    m_bClosed(false),
+    m_firstFragmentPosition(0),
+    m_extendedOffsetsPosition(0),
+    m_extendedLengthsPosition(0)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(framesNumber == 0)
+    {
+        IMEBRA_THROW(DataSetWrongFrameError, "At least one frame must be written");
+    }
+
+    // The pixel data is written by addFrame(): the frames
+    //  already in the dataset would be lost
+    ///////////////////////////////////////////////////////////
+    if(pDataSet->bufferExists(0x7fe0, 0, 0x0010, 0))
+    {
+        IMEBRA_THROW(DataSetWrongFrameError, "The dataset passed to the FramesWriter must not contain pixel data");
+    }
+
+    // The tables' length must fit in the tags' 32 bit length
+    ///////////////////////////////////////////////////////////
+    if(bExtendedOffsetTable && framesNumber > std::numeric_limits<std::uint32_t>::max() / sizeof(std::uint64_t))
+    {
+        IMEBRA_THROW(DataSetWrongFrameError, "Too many frames for the Extended Offset Table");
+    }
+
+    // The Extended Offset Table is filled by close(), which
+    //  overwrites the values reserved in the header
+    ///////////////////////////////////////////////////////////
+    if(bExtendedOffsetTable && !pWriter->seekable())
+    {
+        IMEBRA_THROW(StreamWriteError, "The Extended Offset Table requires a stream that allows random access");
+    }
+
+    if(bExtendedOffsetTable)
+    {
+        m_extendedOffsets.reserve(framesNumber);
+        m_extendedLengths.reserve(framesNumber);
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Compress and write a frame
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void framesWriter::addFrame(std::shared_ptr<image> pImage)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(m_bClosed || m_writtenFrames == m_framesNumber)
+    {
+        IMEBRA_THROW(DataSetWrongFrameError, "All the declared frames have already been written");
+    }
+
+    if(m_writtenFrames == 0)
+    {
+        writeHeader(pImage);
+    }
+    else
+    {
+        dataSet::checkFrameFormat(m_encoding, pImage);
+    }
+
+    // Each frame is written as a single fragment
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<memory> pEncodedFrame(dataSet::encodeFrame(m_encoding, pImage));
+    const size_t frameSize(pEncodedFrame->size());
+    const size_t itemSize(frameSize + (frameSize & 1u));
+    if(itemSize >= 0xffffffffu)
+    {
+        IMEBRA_THROW(CodecImageTooBigError, "The compressed frame doesn't fit in a pixel data item");
+    }
+
+    if(m_bExtendedOffsetTable)
+    {
+        m_extendedOffsets.push_back(m_pWriter->getControlledStreamPosition() - m_firstFragmentPosition);
+        m_extendedLengths.push_back(itemSize);
+    }
+
+    writeTagId(0xfffe, 0xe000);
+    writeLength(static_cast<std::uint32_t>(itemSize));
+    m_pWriter->write(pEncodedFrame->data(), frameSize);
+    if(itemSize != frameSize)
+    {
+        const std::uint8_t paddingByte(0);
+        m_pWriter->write(&paddingByte, 1);
+    }
+
+    ++m_writtenFrames;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Terminate the pixel data and write the remaining tags
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void framesWriter::close()
+{
+    IMEBRA_FUNCTION_START();
+
+    if(m_bClosed)
+    {
+        return;
+    }
+
+    if(m_writtenFrames != m_framesNumber)
+    {
+        IMEBRA_THROW(DataSetWrongFrameError, "Written " << m_writtenFrames << " frames but " << m_framesNumber << " have been declared");
+    }
+
+    // Sequence delimiter
+    ///////////////////////////////////////////////////////////
+    writeTagId(0xfffe, 0xe0dd);
+    writeLength(0);
+
+    // Tags that follow the pixel data
+    ///////////////////////////////////////////////////////////
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_pDataSet->m_mutex);
+        codecs::dicomStreamCodec::buildStream(m_pWriter, m_pDataSet, m_bExplicitDataType, m_endianType, codecs::dicomStreamCodec::streamType_t::mediaStorage, 0x7fe00011u);
+    }
+
+    m_pWriter->flushDataBuffer();
+
+    // Fill the Extended Offset Table reserved in the header
+    ///////////////////////////////////////////////////////////
+    if(m_bExtendedOffsetTable)
+    {
+        writeExtendedTable(m_extendedOffsetsPosition, m_extendedOffsets);
+        writeExtendedTable(m_extendedLengthsPosition, m_extendedLengths);
+    }
+
+    m_bClosed = true;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Write the header and the pixel data's offset table
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void framesWriter::writeHeader(const std::shared_ptr<image>& pFirstImage)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::lock_guard<std::recursive_mutex> lock(m_pDataSet->m_mutex);
+
+    m_encoding = m_pDataSet->getFrameEncoding(0, pFirstImage, m_quality);
+    if(!m_encoding.m_bEncapsulated)
+    {
+        IMEBRA_THROW(CodecWrongTransferSyntaxError, "Only the frames of encapsulated transfer syntaxes can be written one by one");
+    }
+
+    // The header must already contain all the image's
+    //  attributes and the number of frames
+    ///////////////////////////////////////////////////////////
+    m_pDataSet->setImageAttributes(pFirstImage, m_encoding);
+    m_pDataSet->setUnsignedLong(0x0028, 0, 0x0008, 0, m_framesNumber);
+
+    codecs::dicomStreamCodec::getTransferSyntaxEncoding(m_encoding.m_transferSyntax, &m_bExplicitDataType, &m_endianType);
+
+    // The extended offset tables already in the dataSet are
+    //  not valid for the new pixel data and are skipped
+    ///////////////////////////////////////////////////////////
+    codecs::dicomStreamCodec::writePreamble(m_pWriter);
+    codecs::dicomStreamCodec::buildStream(m_pWriter, m_pDataSet, m_bExplicitDataType, m_endianType, codecs::dicomStreamCodec::streamType_t::mediaStorage, 0, 0x7fe00001u);
+    if(m_bExtendedOffsetTable)
+    {
+        m_extendedOffsetsPosition = reserveExtendedTable(0x0001);
+        m_extendedLengthsPosition = reserveExtendedTable(0x0002);
+    }
+    codecs::dicomStreamCodec::buildStream(m_pWriter, m_pDataSet, m_bExplicitDataType, m_endianType, codecs::dicomStreamCodec::streamType_t::mediaStorage, 0x7fe00003u, 0x7fe00010u);
+
+    // Pixel data with undefined length
+    ///////////////////////////////////////////////////////////
+    writeTagId(0x7fe0, 0x0010);
+    if(m_bExplicitDataType)
+    {
+        const std::string dataTypeString(dicomDictionary::getDicomDictionary()->enumDataTypeToString(m_encoding.m_dataHandlerType));
+        const std::uint16_t reserved(0);
+        m_pWriter->write(reinterpret_cast<const std::uint8_t*>(dataTypeString.c_str()), 2);
+        m_pWriter->write(reinterpret_cast<const std::uint8_t*>(&reserved), 2);
+    }
+    writeLength(0xffffffff);
+
+    // Empty offset table: the frames' positions are not
+    //  known yet
+    ///////////////////////////////////////////////////////////
+    writeTagId(0xfffe, 0xe000);
+    writeLength(0);
+
+    m_firstFragmentPosition = m_pWriter->getControlledStreamPosition();
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Write a group and tag id
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void framesWriter::writeTagId(std::uint16_t groupId, std::uint16_t tagId)
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint16_t ids[2] = {
+        streamController::adjustEndian(groupId, m_endianType),
+        streamController::adjustEndian(tagId, m_endianType)};
+    m_pWriter->write(reinterpret_cast<const std::uint8_t*>(ids), sizeof(ids));
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Write a 32 bit length
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void framesWriter::writeLength(std::uint32_t length)
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint32_t adjustedLength(streamController::adjustEndian(length, m_endianType));
+    m_pWriter->write(reinterpret_cast<const std::uint8_t*>(&adjustedLength), sizeof(adjustedLength));
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Reserve the space for one of the extended offset tables
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+size_t framesWriter::reserveExtendedTable(std::uint16_t tagId)
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint32_t tableSize(m_framesNumber * static_cast<std::uint32_t>(sizeof(std::uint64_t)));
+
+    writeTagId(0x7fe0, tagId);
+    if(m_bExplicitDataType)
+    {
+        const std::uint16_t reserved(0);
+        m_pWriter->write(reinterpret_cast<const std::uint8_t*>("OV"), 2);
+        m_pWriter->write(reinterpret_cast<const std::uint8_t*>(&reserved), 2);
+    }
+    writeLength(tableSize);
+
+    const size_t position(m_pWriter->getControlledStreamPosition());
+    const std::vector<std::uint8_t> emptyTable(tableSize, 0);
+    m_pWriter->write(emptyTable.data(), emptyTable.size());
+    return position;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Write the values of one of the extended offset tables
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void framesWriter::writeExtendedTable(size_t position, std::vector<std::uint64_t> values)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::uint8_t* pValues(reinterpret_cast<std::uint8_t*>(values.data()));
+    const size_t valuesSize(values.size() * sizeof(std::uint64_t));
+    streamController::adjustEndian(pValues, sizeof(std::uint64_t), m_endianType, values.size());
+    m_pWriter->overwrite(position, pValues, valuesSize);
+
+    IMEBRA_FUNCTION_END();
+}
+
+} // namespace implementation
+
+} // namespace imebra
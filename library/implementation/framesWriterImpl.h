@@ -0,0 +1,175 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file framesWriterImpl.h
+    \brief Declaration of the class framesWriter.
+
+*/
+
+#if !defined(imebraFramesWriter_76853987_DBFE_4951_8DBB_97F5642EA78E__INCLUDED_)
+#define imebraFramesWriter_76853987_DBFE_4951_8DBB_97F5642EA78E__INCLUDED_
+
+#include <memory>
+#include <vector>
+#include "dataSetImpl.h"
+#include "streamControllerImpl.h"
+#include "../include/imebra/definitions.h"
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+class image;
+class streamWriter;
+
+/// \addtogroup group_dataset
+///
+/// @{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief Writes a DICOM file with encapsulated pixel
+///         data directly to a stream, one frame at a
+///         time.
+///
+/// The header is built from a dataSet that doesn't
+///  contain the pixel data: it is written when the first
+///  frame is added, after the image's attributes and the
+///  number of frames have been stored in the dataSet.
+///
+/// Each frame is then compressed and written immediately
+///  as a single fragment, so only one compressed frame
+///  is kept in memory.
+///
+/// Because the frames' positions are not known when the
+///  pixel data's header is written, the Basic Offset
+///  Table is left empty.
+///
+/// Optionally, space for the Extended Offset Table
+///  (7FE0,0001) and the Extended Offset Table Lengths
+///  (7FE0,0002) can be reserved in the header: the tables
+///  are then filled by close(), which requires a stream
+///  that allows random access (a file or memory).
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class framesWriter
+{
+public:
+    /// \brief Constructor.
+    ///
+    /// @param pDataSet     the dataSet containing the
+    ///                      header's tags. The image's
+    ///                      attributes are written into it
+    ///                      when the first frame is added
+    /// @param pWriter      the destination stream
+    /// @param framesNumber the number of frames that will
+    ///                      be written
+    /// @param quality      the compression quality
+    /// @param bExtendedOffsetTable true if the Extended
+    ///                      Offset Table must be written.
+    ///                      Throws StreamWriteError if the
+    ///                      stream doesn't allow random
+    ///                      access
+    ///
+    ///////////////////////////////////////////////////////////
+    framesWriter(std::shared_ptr<dataSet> pDataSet, std::shared_ptr<streamWriter> pWriter, std::uint32_t framesNumber, imageQuality_t quality, bool bExtendedOffsetTable);
+
+    /// \brief Compress a frame and write it to the stream.
+    ///
+    /// The first call also writes the file's header.
+    ///
+    /// @param pImage the frame to write
+    ///
+    ///////////////////////////////////////////////////////////
+    void addFrame(std::shared_ptr<image> pImage);
+
+    /// \brief Write the pixel data's end marker and the
+    ///         tags that follow the pixel data, then flush
+    ///         the stream.
+    ///
+    /// Throws DataSetWrongFrameError if the number of frames
+    ///  written differs from the one declared in the
+    ///  constructor.
+    ///
+    ///////////////////////////////////////////////////////////
+    void close();
+
+private:
+    /// \brief Store the image's attributes in the dataSet
+    ///         and write the header and the pixel data's
+    ///         offset table.
+    ///
+    /// @param pFirstImage the first frame
+    ///
+    ///////////////////////////////////////////////////////////
+    void writeHeader(const std::shared_ptr<image>& pFirstImage);
+
+    /// \brief Write the group and the tag id of an element
+    ///         of the pixel data.
+    ///
+    ///////////////////////////////////////////////////////////
+    void writeTagId(std::uint16_t groupId, std::uint16_t tagId);
+
+    /// \brief Write a 32 bit length.
+    ///
+    ///////////////////////////////////////////////////////////
+    void writeLength(std::uint32_t length);
+
+    /// \brief Write the header of an OV tag followed by
+    ///         one zeroed 64 bit value per frame.
+    ///
+    /// @return the position of the first value in the
+    ///          stream
+    ///
+    ///////////////////////////////////////////////////////////
+    size_t reserveExtendedTable(std::uint16_t tagId);
+
+    /// \brief Overwrite the values reserved by
+    ///         reserveExtendedTable().
+    ///
+    ///////////////////////////////////////////////////////////
+    void writeExtendedTable(size_t position, std::vector<std::uint64_t> values);
+
+    const std::shared_ptr<dataSet> m_pDataSet;
+    const std::shared_ptr<streamWriter> m_pWriter;
+    const std::uint32_t m_framesNumber;
+    const imageQuality_t m_quality;
+    const bool m_bExtendedOffsetTable;
+
+    dataSet::frameEncoding m_encoding;
+    bool m_bExplicitDataType;
+    streamController::tByteOrdering m_endianType;
+
+    std::uint32_t m_writtenFrames;
+    bool m_bClosed;
+
+    // Position of the first fragment and of the extended
+    //  tables' values, and the values to write in them
+    ///////////////////////////////////////////////////////////
+    size_t m_firstFragmentPosition;
+    size_t m_extendedOffsetsPosition;
+    size_t m_extendedLengthsPosition;
+    std::vector<std::uint64_t> m_extendedOffsets;
+    std::vector<std::uint64_t> m_extendedLengths;
+};
+
+/// @}
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraFramesWriter_76853987_DBFE_4951_8DBB_97F5642EA78E__INCLUDED_)
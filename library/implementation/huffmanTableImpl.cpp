@@ -24,6 +24,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "../include/imebra/exceptions.h"
 
 #include <list>
+#include <algorithm>
 #include <string.h>
 #include <stdexcept>
 
@@ -93,10 +94,7 @@ void huffmanTable::reset()
     ::memset(&(m_valuesToHuffmanLength[0]), 0, m_numValues*sizeof(m_valuesToHuffmanLength[0]));
 
     m_valuesPerLength.fill(0);
-    m_firstValidLength = 0;
-    m_firstMinValue = 0xffffffff;
-    m_firstMaxValue = 0xffffffff;
-    m_firstValuesPerLength = 0;
+    m_lookaheadTable.fill(0);
 
     IMEBRA_FUNCTION_END();
 }
@@ -296,15 +294,6 @@ void huffmanTable::calcHuffmanCodesLength(const std::uint32_t maxCodeLength)
         }
     }
 
-    // Find the first available length
-    for(m_firstValidLength = 1; m_firstValidLength != m_valuesPerLength.size(); ++m_firstValidLength)
-    {
-        if(m_valuesPerLength[m_firstValidLength] != 0)
-        {
-            break;
-        }
-    }
-
     IMEBRA_FUNCTION_END();
 }
 
@@ -328,18 +317,15 @@ void huffmanTable::calcHuffmanTables()
 
     ::memset(m_minValuePerLength, 0xff, sizeof(m_minValuePerLength));
     ::memset(m_maxValuePerLength, 0xff, sizeof(m_maxValuePerLength));
-    m_firstValuesPerLength = 0;
-    m_firstMinValue = 0xffffffff;
-    m_firstMaxValue = 0xffffffff;
-    m_firstValidLength = 0;
+    m_lookaheadTable.fill(0);
     for(size_t codeLength = 1; codeLength != m_valuesPerLength.size(); ++codeLength)
     {
-        if(m_valuesPerLength[codeLength] != 0 && m_firstValidLength == 0)
-        {
-            m_firstValidLength = codeLength;
-        }
         for(std::uint32_t generateCodes = 0; generateCodes<m_valuesPerLength[codeLength]; ++generateCodes)
         {
+            if(valueIndex >= m_orderedValues.size())
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "Too many codes in the huffman table");
+            }
             if(generateCodes == 0)
             {
                 m_minValuePerLength[codeLength]=huffmanCode;
@@ -347,6 +333,20 @@ void huffmanTable::calcHuffmanTables()
             m_maxValuePerLength[codeLength]=huffmanCode;
             m_valuesToHuffman[m_orderedValues[valueIndex]]=huffmanCode;
             m_valuesToHuffmanLength[m_orderedValues[valueIndex]] = codeLength;
+
+            // Fill all the lookahead entries that begin with the
+            //  short code. Codes that don't fit in codeLength bits
+            //  (corrupted tables) are never matched
+            ///////////////////////////////////////////////////////////
+            if(codeLength <= IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS && (static_cast<size_t>(huffmanCode) >> codeLength) == 0)
+            {
+                const size_t unusedBits(IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS - codeLength);
+                const size_t firstEntry(static_cast<size_t>(huffmanCode) << unusedBits);
+                const size_t endEntry(firstEntry + (size_t(1) << unusedBits));
+                const std::uint32_t entry((m_orderedValues[valueIndex] << 8) | static_cast<std::uint32_t>(codeLength));
+                std::fill(m_lookaheadTable.begin() + static_cast<std::ptrdiff_t>(firstEntry), m_lookaheadTable.begin() + static_cast<std::ptrdiff_t>(endEntry), entry);
+            }
+
             ++valueIndex;
             ++huffmanCode;
         }
@@ -355,10 +355,6 @@ void huffmanTable::calcHuffmanTables()
 
     }
 
-    m_firstMinValue = m_minValuePerLength[m_firstValidLength];
-    m_firstMaxValue = m_maxValuePerLength[m_firstValidLength];
-    m_firstValuesPerLength = m_valuesPerLength[m_firstValidLength];
-
     IMEBRA_FUNCTION_END();
 }
 
@@ -373,27 +369,42 @@ void huffmanTable::calcHuffmanTables()
 ///////////////////////////////////////////////////////////
 std::uint32_t huffmanTable::readHuffmanCode(codecs::jpegStreamReader& stream)
 {
-    IMEBRA_FUNCTION_START();
-
-    // Read initial number of bits
-    std::uint32_t readBuffer(stream.readBits(m_firstValidLength));
-
-    // Validate the current Huffman code. If it's OK, then
-    //  return the ordered value
+    // Most of the codes are decoded with one lookup. Don't
+    //  use IMEBRA_FUNCTION_START() in this hot path
     ///////////////////////////////////////////////////////////
-    if(readBuffer <= m_firstMaxValue)
+    const std::uint32_t lookahead(m_lookaheadTable[stream.peekBits(IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS)]);
+    if((lookahead & 0xff) != 0)
     {
-        return m_orderedValues[readBuffer - m_firstMinValue];
+        stream.skipBits(lookahead & 0xff);
+        return lookahead >> 8;
     }
 
-    std::uint32_t orderedValue(m_firstValuesPerLength);
+    return readLongHuffmanCode(stream);
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Read an Huffman code longer than the lookahead table
+//  index
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::uint32_t huffmanTable::readLongHuffmanCode(codecs::jpegStreamReader& stream)
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint32_t readBuffer(stream.peekBits(32));
+
+    std::uint32_t orderedValue(0);
 
     // Scan all the codes sizes
     ///////////////////////////////////////////////////////////
-    for(size_t scanSize(m_firstValidLength + 1), missingBits(0); scanSize != m_valuesPerLength.size(); ++scanSize)
+    for(size_t scanSize(1); scanSize <= 32 && scanSize != m_valuesPerLength.size(); ++scanSize)
     {
-        ++missingBits;
-
         // If the active length is empty, then continue the loop
         ///////////////////////////////////////////////////////////
         if(m_valuesPerLength[scanSize] == 0)
@@ -401,30 +412,17 @@ std::uint32_t huffmanTable::readHuffmanCode(codecs::jpegStreamReader& stream)
             continue;
         }
 
-        readBuffer <<= missingBits;
-        if(missingBits == 1)
-        {
-            readBuffer |= stream.readBit();
-        }
-        else
-        {
-            readBuffer |= stream.readBits(missingBits);
-        }
-
         // Validate the current Huffman code. If it's OK, then
         //  return the ordered value
         ///////////////////////////////////////////////////////////
-        if(readBuffer<=m_maxValuePerLength[scanSize])
+        const std::uint32_t code(readBuffer >> (32 - scanSize));
+        if(code <= m_maxValuePerLength[scanSize])
         {
-            return m_orderedValues[orderedValue + readBuffer - m_minValuePerLength[scanSize]];
+            stream.skipBits(scanSize);
+            return m_orderedValues[orderedValue + code - m_minValuePerLength[scanSize]];
         }
 
         orderedValue += m_valuesPerLength[scanSize];
-
-        // Reset the number of bits to read in one go
-        ///////////////////////////////////////////////////////////
-        missingBits = 0;
-
     }
 
     IMEBRA_THROW(CodecCorruptedFileError, "Invalid huffman code found while reading from a stream");
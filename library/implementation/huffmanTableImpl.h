@@ -49,6 +49,11 @@ class streamWriter;
 ///////////////////////////////////////////////////////////
 class huffmanTable
 {
+
+#if(!defined IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS)
+    #define IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS 9
+#endif
+
 public:
     ///////////////////////////////////////////////////////////
     /// \name Initialization
@@ -174,6 +179,10 @@ public:
     /// \brief Read and decode an huffman code from the
     ///         specified stream.
     ///
+    /// The codes up to IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS
+    ///  long are decoded with a single lookup in a table
+    ///  indexed by the next bits in the stream.
+    ///
     /// The function throws a huffmanExceptionRead exception
     ///  if the read code cannot be decoded.
     ///
@@ -249,16 +258,28 @@ protected:
     std::vector<valueObject> m_valuesFreq;
 
 private:
+    /// \brief Decode the codes that are longer than
+    ///         IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS.
+    ///
+    /// @param stream  the stream reader used to read the code
+    /// @return the decoded value
+    ///
+    ///////////////////////////////////////////////////////////
+    std::uint32_t readLongHuffmanCode(codecs::jpegStreamReader& stream);
+
     // Used to calculate the huffman codes
     std::vector<std::uint32_t> m_orderedValues;
     std::array<std::uint32_t, 128> m_valuesPerLength;
-    size_t m_firstValidLength;
-    std::uint32_t m_firstMinValue;
-    std::uint32_t m_firstMaxValue;
-    std::uint32_t m_firstValuesPerLength;
     std::uint32_t m_minValuePerLength[128];
     std::uint32_t m_maxValuePerLength[128];
 
+    // Indexed by the next IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS
+    //  bits in the stream. Each entry contains the decoded
+    //  value in the upper 24 bits and the code length in the
+    //  lower 8 bits. The code length is 0 when the code is
+    //  longer than IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS
+    std::array<std::uint32_t, (size_t(1) << IMEBRA_JPEG_HUFFMAN_LOOKAHEAD_BITS)> m_lookaheadTable;
+
     // Final huffman table
     std::vector<std::uint32_t> m_valuesToHuffman;
     std::vector<size_t> m_valuesToHuffmanLength;
@@ -34,95 +34,6 @@ namespace codecs
 {
 
 
-std::vector<std::shared_ptr<channel>> imageCodec::allocChannels(std::uint32_t channelsNumber, std::uint32_t width, std::uint32_t height, bool bSubSampledX, bool bSubSampledY)
-{
-    IMEBRA_FUNCTION_START();
-
-    if(bSubSampledX && (width & 0x1) != 0)
-    {
-        width++;
-    }
-
-    if(bSubSampledY && (height & 0x1) != 0)
-    {
-        height++;
-    }
-
-    std::vector<std::shared_ptr<channel>> channels;
-    for(std::uint32_t channelNum = 0; channelNum < channelsNumber; ++channelNum)
-    {
-        std::uint32_t channelWidth = width;
-        std::uint32_t channelHeight = height;
-        std::uint32_t samplingFactorX = 1;
-        std::uint32_t samplingFactorY = 1;
-        if(channelNum != 0)
-        {
-            if(bSubSampledX)
-            {
-                channelWidth = width / 2;
-            }
-            if(bSubSampledY)
-            {
-                channelHeight = height / 2;
-            }
-        }
-        else
-        {
-            if(bSubSampledX)
-            {
-                ++samplingFactorX;
-            }
-            if(bSubSampledY)
-            {
-                ++samplingFactorY;
-            }
-        }
-
-        std::shared_ptr<channel> newChannel(std::make_shared<channel>());
-        newChannel->allocate(channelWidth, channelHeight);
-        newChannel->m_samplingFactorX = samplingFactorX;
-        newChannel->m_samplingFactorY = samplingFactorY;
-
-        channels.push_back(newChannel);
-    }
-
-    return channels;
-
-    IMEBRA_FUNCTION_END();
-}
-
-
-std::vector<std::shared_ptr<channel>> imageCodec::splitImageIntoChannels(const std::shared_ptr<const image>& pImage, bool bSubSampledX, bool bSubSampledY)
-{
-    const std::uint32_t channelsNumber = pImage->getChannelsNumber();
-    std::uint32_t imageWidth, imageHeight;
-    pImage->getSize(&imageWidth, &imageHeight);
-    const std::string colorSpace = pImage->getColorSpace();
-    std::vector<std::shared_ptr<channel>> subsampledChannels = allocChannels(channelsNumber, imageWidth, imageHeight, bSubSampledX, bSubSampledY);
-    std::uint32_t maxSamplingFactorX = bSubSampledX ? 2 : 1;
-    std::uint32_t maxSamplingFactorY = bSubSampledY ? 2 : 1;
-    std::shared_ptr<handlers::readingDataHandlerNumericBase> imageHandler = pImage->getReadingDataHandler();
-    for(std::uint32_t copyChannels = 0; copyChannels < channelsNumber; ++copyChannels)
-    {
-        std::shared_ptr<channel> imageChannel = subsampledChannels[copyChannels];
-        imageHandler->copyToInt32Interleaved(
-                    imageChannel->m_pBuffer,
-                    maxSamplingFactorX /imageChannel->m_samplingFactorX,
-                    maxSamplingFactorY /imageChannel->m_samplingFactorY,
-                    0, 0,
-                    subsampledChannels[0]->m_width,
-                    subsampledChannels[0]->m_height,
-                    copyChannels,
-                    imageWidth,
-                    imageHeight,
-                    channelsNumber);
-    }
-
-    return subsampledChannels;
-
-}
-
-
 void imageCodec::adjustB2Complement(
         std::uint8_t* pImageSamples,
         std::uint32_t highBit,
@@ -155,26 +66,95 @@ void imageCodec::adjustB2Complement(
 ///////////////////////////////////////////////////////////
 //
 //
-// Allocate a channel's memory
+// Decode the whole image, then copy the requested region
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::shared_ptr<image> imageCodec::getImageRegion(const std::string& transferSyntax,
+                                                  const std::string& colorSpace,
+                                                  std::uint32_t channelsNumber,
+                                                  std::uint32_t imageWidth,
+                                                  std::uint32_t imageHeight,
+                                                  bool bSubsampledX,
+                                                  bool bSubsampledY,
+                                                  bool bInterleaved,
+                                                  bool b2Complement,
+                                                  std::uint8_t allocatedBits,
+                                                  std::uint8_t storedBits,
+                                                  std::uint8_t highBit,
+                                                  std::shared_ptr<streamReader> pSourceStream,
+                                                  std::uint32_t regionLeft,
+                                                  std::uint32_t regionTop,
+                                                  std::uint32_t regionWidth,
+                                                  std::uint32_t regionHeight) const
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<image> pImage(getImage(transferSyntax, colorSpace, channelsNumber, imageWidth, imageHeight,
+                                           bSubsampledX, bSubsampledY, bInterleaved, b2Complement,
+                                           allocatedBits, storedBits, highBit, pSourceStream));
+
+    return copyImageRegion(pImage, regionLeft, regionTop, regionWidth, regionHeight);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Copy a region of an image into a new image
 //
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-void channel::allocate(std::uint32_t width, std::uint32_t height)
+std::shared_ptr<image> imageCodec::copyImageRegion(
+        const std::shared_ptr<image>& pImage,
+        std::uint32_t regionLeft,
+        std::uint32_t regionTop,
+        std::uint32_t regionWidth,
+        std::uint32_t regionHeight)
 {
     IMEBRA_FUNCTION_START();
 
-    m_width = width;
-    m_height = height;
-    m_bufferSize = width * height;
-    m_memory = std::make_shared<memory>(m_bufferSize * sizeof(std::int32_t) );
-    m_pBuffer = reinterpret_cast<std::int32_t*>(m_memory->data());
+    std::uint32_t imageWidth, imageHeight;
+    pImage->getSize(&imageWidth, &imageHeight);
+    if(regionLeft == 0 && regionTop == 0 && regionWidth == imageWidth && regionHeight == imageHeight)
+    {
+        return pImage;
+    }
+
+    if(regionLeft + regionWidth > imageWidth || regionTop + regionHeight > imageHeight)
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "The decoded image is smaller than the dataset's image");
+    }
 
-    ::memset(m_pBuffer, 0, m_bufferSize * sizeof(std::int32_t));
+    std::shared_ptr<image> pRegion(std::make_shared<image>(regionWidth, regionHeight, pImage->getDepth(), pImage->getColorSpace(), pImage->getHighBit()));
+
+    std::shared_ptr<handlers::readingDataHandlerNumericBase> pSourceHandler(pImage->getReadingDataHandler());
+    std::shared_ptr<handlers::writingDataHandlerNumericBase> pDestinationHandler(pRegion->getWritingDataHandler());
+
+    const size_t pixelSize(pSourceHandler->getUnitSize() * pImage->getChannelsNumber());
+    const size_t sourceRowSize(pixelSize * imageWidth);
+    const size_t destinationRowSize(pixelSize * regionWidth);
+
+    const std::uint8_t* pSource(pSourceHandler->getMemoryBuffer() + sourceRowSize * regionTop + pixelSize * regionLeft);
+    std::uint8_t* pDestination(pDestinationHandler->getMemoryBuffer());
+    for(std::uint32_t scanRows(0); scanRows != regionHeight; ++scanRows)
+    {
+        ::memcpy(pDestination, pSource, destinationRowSize);
+        pSource += sourceRowSize;
+        pDestination += destinationRowSize;
+    }
+
+    return pRegion;
 
     IMEBRA_FUNCTION_END();
 }
 
+
 } // namespace codecs
 
 } // namespace implementation
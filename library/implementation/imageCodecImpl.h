@@ -134,6 +134,60 @@ public:
                                             std::uint8_t highBit,
                                             std::shared_ptr<streamReader> pSourceStream) const = 0;
 
+    /// \brief Get a rectangular region of a decompressed
+    ///         image from a dicom structure.
+    ///
+    /// The default implementation decompresses the whole
+    ///  image with getImage() and then copies the region
+    ///  into a new image: the codecs that can skip the data
+    ///  outside the region override it.
+    ///
+    /// The region must be inside the image: the caller is
+    ///  responsible for the check.
+    ///
+    /// @param transferSyntax the dataset transfer syntax
+    /// @param colorSpace     the color space
+    /// @param channelsNumber the number of channels
+    /// @param imageWidth     the image width in pixels
+    /// @param imageHeight    the image height in pixels
+    /// @param bSubsampledX   true if the image is subsampled
+    ///                        horizontally
+    /// @param bSubsampledY   true if the image is subsampled
+    ///                        vertically
+    /// @param bInterleaved   true if the color channels are
+    ///                        interleaved
+    /// @param b2Complement   true if the values can be
+    ///                        negative
+    /// @param allocatedBits  the number of allocated bits
+    /// @param storedBits     the number of stored bits
+    /// @param highBit        the high bit
+    /// @param pSourceStream  a pointer to a stream containing
+    ///              the data to be parsed
+    /// @param regionLeft     the region's left column
+    /// @param regionTop      the region's top row
+    /// @param regionWidth    the region's width, in pixels
+    /// @param regionHeight   the region's height, in pixels
+    /// @return an image containing the requested region
+    ///
+    ///////////////////////////////////////////////////////////
+    virtual std::shared_ptr<image> getImageRegion(const std::string& transferSyntax,
+                                                  const std::string& colorSpace,
+                                                  std::uint32_t channelsNumber,
+                                                  std::uint32_t imageWidth,
+                                                  std::uint32_t imageHeight,
+                                                  bool bSubsampledX,
+                                                  bool bSubsampledY,
+                                                  bool bInterleaved,
+                                                  bool b2Complement,
+                                                  std::uint8_t allocatedBits,
+                                                  std::uint8_t storedBits,
+                                                  std::uint8_t highBit,
+                                                  std::shared_ptr<streamReader> pSourceStream,
+                                                  std::uint32_t regionLeft,
+                                                  std::uint32_t regionTop,
+                                                  std::uint32_t regionWidth,
+                                                  std::uint32_t regionHeight) const;
+
     ///
     /// \brief Return the default planar configuration.
     ///
@@ -245,10 +299,6 @@ public:
 
     //@}
 
-    static std::vector<std::shared_ptr<channel>> splitImageIntoChannels(const std::shared_ptr<const image>& image, bool bSubSampledX, bool bSubSampledY);
-
-    static std::vector<std::shared_ptr<channel>> allocChannels(std::uint32_t channelsNumber, std::uint32_t width, std::uint32_t height, bool bSubSampledX, bool bSubSampledY);
-
     template<typename samplesType_t> static void adjustB2Complement(
             samplesType_t* pImageSamples,
             std::uint32_t highBit,
@@ -273,6 +323,27 @@ public:
             bitDepth_t samplesDepth,
             size_t numSamples);
 
+    /// \brief Copy a rectangular region of an image into a
+    ///         new image with the same attributes.
+    ///
+    /// If the region covers the whole image then the source
+    ///  image is returned.
+    ///
+    /// @param pImage       the source image
+    /// @param regionLeft   the region's left column
+    /// @param regionTop    the region's top row
+    /// @param regionWidth  the region's width, in pixels
+    /// @param regionHeight the region's height, in pixels
+    /// @return an image containing the region
+    ///
+    ///////////////////////////////////////////////////////////
+    static std::shared_ptr<image> copyImageRegion(
+            const std::shared_ptr<image>& pImage,
+            std::uint32_t regionLeft,
+            std::uint32_t regionTop,
+            std::uint32_t regionWidth,
+            std::uint32_t regionHeight);
+
 };
 
 class channel
@@ -284,13 +355,7 @@ public:
         m_samplingFactorX(1),
         m_samplingFactorY(1),
         m_width(0),
-        m_height(0),
-        m_pBuffer(nullptr),
-        m_bufferSize(0){}
-
-    // Allocate the channel
-    ///////////////////////////////////////////////////////////
-    void allocate(std::uint32_t width, std::uint32_t height);
+        m_height(0){}
 
     // Sampling factor
     ///////////////////////////////////////////////////////////
@@ -301,13 +366,6 @@ public:
     ///////////////////////////////////////////////////////////
     std::uint32_t m_width;
     std::uint32_t m_height;
-
-    // Channel's buffer & size
-    ///////////////////////////////////////////////////////////
-    std::int32_t* m_pBuffer;
-    std::uint32_t m_bufferSize;
-
-    std::shared_ptr<memory> m_memory;
 };
 
 
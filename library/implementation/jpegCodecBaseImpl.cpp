@@ -24,6 +24,8 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "streamReaderImpl.h"
 #include "codecFactoryImpl.h"
 #include "../include/imebra/exceptions.h"
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <stdlib.h>
 #include <string.h>
@@ -89,6 +91,66 @@ static const std::uint32_t JpegStdChrominanceQuantTbl[] =
 };
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+//
+// Typical huffman tables (ISO/IEC 10918-1, Annex K.3):
+//  number of codes for each length from 1 to 16 bits,
+//  followed by the values ordered by code length
+//
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+static const std::uint8_t JpegStdLuminanceDCHuffmanTbl[] =
+{
+    0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b
+};
+
+static const std::uint8_t JpegStdChrominanceDCHuffmanTbl[] =
+{
+    0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b
+};
+
+static const std::uint8_t JpegStdLuminanceACHuffmanTbl[] =
+{
+    0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d,
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+static const std::uint8_t JpegStdChrominanceACHuffmanTbl[] =
+{
+    0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77,
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
@@ -140,13 +202,25 @@ jpegChannel::jpegChannel():
         m_defaultDCValue(0),
         m_losslessPositionX(0),
         m_losslessPositionY(0),
+        m_losslessFirstLineY(0),
         m_unprocessedAmplitudesCount(0),
         m_unprocessedAmplitudesPredictor(0),
         m_huffmanTableDC(0),
         m_huffmanTableAC(0),
         m_pActiveHuffmanTableDC(0),
         m_pActiveHuffmanTableAC(0),
-        m_valuesMask(0)
+        m_valuesMask(0),
+        m_pCoefficients(nullptr),
+        m_pSamples(nullptr),
+        m_samplesDepth(bitDepth_t::depthU8),
+        m_bSignedSamples(false),
+        m_samplesImageWidth(0),
+        m_samplesImageHeight(0),
+        m_samplesImageChannels(0),
+        m_samplesReplicateX(1),
+        m_samplesReplicateY(1),
+        m_sourceChannel(0),
+        m_losslessAboveValue(0)
 {
 }
 
@@ -346,12 +420,24 @@ void jpegInformation::reset(imageQuality_t compQuality)
 
     m_bLossless = false;
 
+    m_bStandardHuffmanTables = false;
+
     // The number of MCUs (horizontal, vertical, total)
     ///////////////////////////////////////////////////////////
     m_mcuNumberX = 0;
     m_mcuNumberY = 0;
     m_mcuNumberTotal = 0;
 
+    m_mcuSizeX = 1;
+    m_mcuSizeY = 1;
+
+    // Decode the whole image
+    ///////////////////////////////////////////////////////////
+    m_regionLeft = 0;
+    m_regionTop = 0;
+    m_regionRight = std::numeric_limits<std::uint32_t>::max();
+    m_regionBottom = std::numeric_limits<std::uint32_t>::max();
+
     m_maxSamplingFactorX = 0;
     m_maxSamplingFactorY = 0;
 
@@ -401,6 +487,52 @@ void jpegInformation::reset(imageQuality_t compQuality)
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Load the typical huffman tables listed in Annex K:
+//  table 0 for the luminance, table 1 for the chrominance
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void jpegInformation::setStandardHuffmanTables()
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint8_t* standardTables[2][2] = {
+        {JpegStdLuminanceDCHuffmanTbl, JpegStdLuminanceACHuffmanTbl},
+        {JpegStdChrominanceDCHuffmanTbl, JpegStdChrominanceACHuffmanTbl}};
+
+    for(size_t tableNum(0); tableNum != 2; ++tableNum)
+    {
+        for(size_t DcAc(0); DcAc != 2; ++DcAc)
+        {
+            huffmanTable* pHuffman = (DcAc == 0) ? m_pHuffmanTableDC[tableNum].get() : m_pHuffmanTableAC[tableNum].get();
+            const std::uint8_t* pValuesPerLength(standardTables[tableNum][DcAc]);
+            const std::uint8_t* pValues(pValuesPerLength + 16);
+
+            pHuffman->reset();
+            size_t valueIndex(0);
+            for(std::uint32_t scanLength(0); scanLength != 16; ++scanLength)
+            {
+                pHuffman->setValuesPerLength(scanLength + 1, pValuesPerLength[scanLength]);
+                for(std::uint32_t scanValues(0); scanValues != pValuesPerLength[scanLength]; ++scanValues, ++valueIndex)
+                {
+                    pHuffman->addOrderedValue(valueIndex, pValues[valueIndex]);
+                }
+            }
+            pHuffman->calcHuffmanTables();
+        }
+    }
+
+    m_bStandardHuffmanTables = true;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -463,7 +595,9 @@ void jpegInformation::allocChannels()
         m_jpegImageHeight*=(m_maxSamplingFactorY<<3);
     }
 
-    // Allocate the channels' buffers
+    // Calculate the channels' size. The codec reads and
+    //  writes the samples directly in the image, so no buffer
+    //  is allocated here
     ///////////////////////////////////////////////////////////
     for(tChannelsMap::iterator channelsIterator1=m_channelsMap.begin(); channelsIterator1 != m_channelsMap.end(); ++channelsIterator1)
     {
@@ -471,9 +605,8 @@ void jpegInformation::allocChannels()
         pChannel->m_defaultDCValue = m_bLossless ? ((std::int32_t)1<<(m_precision - 1)) : 0;
         pChannel->m_lastDCValue = pChannel->m_defaultDCValue;
 
-        pChannel->allocate(
-                    m_jpegImageWidth*(std::uint32_t)pChannel->m_samplingFactorX/m_maxSamplingFactorX,
-                    m_jpegImageHeight*(std::uint32_t)pChannel->m_samplingFactorY/m_maxSamplingFactorY);
+        pChannel->m_width = m_jpegImageWidth*(std::uint32_t)pChannel->m_samplingFactorX/m_maxSamplingFactorX;
+        pChannel->m_height = m_jpegImageHeight*(std::uint32_t)pChannel->m_samplingFactorY/m_maxSamplingFactorY;
         pChannel->m_valuesMask = m_valuesMask;
     }
 
@@ -536,6 +669,7 @@ void jpegInformation::findMcuSize()
         pChannel->m_blockMcuXY = pChannel->m_blockMcuX * pChannel->m_blockMcuY;
         pChannel->m_losslessPositionX = 0;
         pChannel->m_losslessPositionY = 0;
+        pChannel->m_losslessFirstLineY = 0;
         pChannel->m_unprocessedAmplitudesCount = 0;
         pChannel->m_unprocessedAmplitudesPredictor = 0;
         pChannel->m_lastDCValue = pChannel->m_defaultDCValue;
@@ -547,6 +681,8 @@ void jpegInformation::findMcuSize()
     {
         m_mcuNumberX = m_jpegImageWidth * minSamplingFactorX / maxSamplingFactorChannelsX;
         m_mcuNumberY = m_jpegImageHeight * minSamplingFactorY / maxSamplingFactorChannelsY;
+        m_mcuSizeX = maxSamplingFactorChannelsX / minSamplingFactorX;
+        m_mcuSizeY = maxSamplingFactorChannelsY / minSamplingFactorY;
     }
     else
     {
@@ -555,14 +691,93 @@ void jpegInformation::findMcuSize()
 
         m_mcuNumberX = (m_imageWidth + xBoundary - 1) / xBoundary;
         m_mcuNumberY = (m_imageHeight + yBoundary - 1) / yBoundary;
+        m_mcuSizeX = xBoundary;
+        m_mcuSizeY = yBoundary;
     }
     m_mcuNumberTotal = m_mcuNumberX*m_mcuNumberY;
+    m_mcuLastRestart = 0;
     m_mcuProcessed = 0;
     m_mcuProcessedX = 0;
     m_mcuProcessedY = 0;
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Set the region that must be decoded
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void jpegInformation::setRegion(std::uint32_t left, std::uint32_t top, std::uint32_t width, std::uint32_t height)
+{
+    m_regionLeft = left;
+    m_regionTop = top;
+    m_regionRight = left + width;
+    m_regionBottom = top + height;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Check if a range of MCUs intersects the region
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+bool jpegInformation::mcusInRegion(std::uint32_t firstMcu, std::uint32_t endMcu) const
+{
+    if(firstMcu >= endMcu)
+    {
+        return false;
+    }
+
+    const std::uint32_t regionFirstX(m_regionLeft / m_mcuSizeX);
+    const std::uint32_t regionLastX((m_regionRight - 1) / m_mcuSizeX);
+    const std::uint32_t regionFirstY(m_regionTop / m_mcuSizeY);
+    const std::uint32_t regionLastY((m_regionBottom - 1) / m_mcuSizeY);
+
+    // Check the range's portion of each MCU row inside the
+    //  region
+    ///////////////////////////////////////////////////////////
+    const std::uint32_t firstY(firstMcu / m_mcuNumberX);
+    const std::uint32_t lastY((endMcu - 1) / m_mcuNumberX);
+    for(std::uint32_t scanY(std::max(firstY, regionFirstY)); scanY <= std::min(lastY, regionLastY); ++scanY)
+    {
+        const std::uint32_t firstX(scanY == firstY ? firstMcu % m_mcuNumberX : 0);
+        const std::uint32_t lastX(scanY == lastY ? (endMcu - 1) % m_mcuNumberX : m_mcuNumberX - 1);
+        if(firstX <= regionLastX && lastX >= regionFirstX)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return the MCU that follows the region
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::uint32_t jpegInformation::getRegionEndMcu() const
+{
+    const std::uint32_t lastX(std::min((m_regionRight - 1) / m_mcuSizeX, m_mcuNumberX - 1));
+    const std::uint32_t lastY(std::min((m_regionBottom - 1) / m_mcuSizeY, m_mcuNumberY - 1));
+
+    return lastY * m_mcuNumberX + lastX + 1;
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -583,6 +798,7 @@ void jpegInformation::recalculateQuantizationTables(int table)
         for(std::uint8_t col = 0; col<8; ++col)
         {
             m_decompressionQuantizationTable[table][tableIndex]=(long long)((float)((m_quantizationTable[table][tableIndex])<<JPEG_DECOMPRESSION_BITS_PRECISION)*JpegDctScaleFactor[col]*JpegDctScaleFactor[row]);
+            m_floatDecompressionQuantizationTable[table][tableIndex]=(float)(m_quantizationTable[table][tableIndex])*JpegDctScaleFactor[col]*JpegDctScaleFactor[row]*0.125f;
             m_compressionQuantizationTable[table][tableIndex]=1.0f/((float)((m_quantizationTable[table][tableIndex])<<3)*JpegDctScaleFactor[col]*JpegDctScaleFactor[row]);
             ++tableIndex;
         }
@@ -605,98 +821,193 @@ void jpegInformation::recalculateQuantizationTables(int table)
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 
-void jpegChannel::processUnprocessedAmplitudes()
+///////////////////////////////////////////////////////////
+//
+// Allocate the store for the quantized coefficients
+//
+///////////////////////////////////////////////////////////
+void jpegChannel::allocateCoefficients()
 {
     IMEBRA_FUNCTION_START();
 
-    if(m_unprocessedAmplitudesCount == 0)
-    {
-        return;
-    }
+    const size_t coefficientsCount((size_t)m_width * (size_t)m_height);
+    m_pCoefficientsMemory = std::make_shared<memory>(coefficientsCount * sizeof(std::int32_t));
+    m_pCoefficients = reinterpret_cast<std::int32_t*>(m_pCoefficientsMemory->data());
+    ::memset(m_pCoefficients, 0, coefficientsCount * sizeof(std::int32_t));
+
+    IMEBRA_FUNCTION_END();
+}
 
-    std::int32_t* pDest = m_pBuffer + (m_losslessPositionY * m_width + m_losslessPositionX);
-    std::int32_t* pSource = m_unprocessedAmplitudesBuffer;
 
-    // Find missing pixels
-    std::int32_t missingPixels = (std::int32_t)m_width - (std::int32_t)m_losslessPositionX + (std::int32_t)m_width * ((std::int32_t)m_height - (std::int32_t)m_losslessPositionY - 1);
-    if(missingPixels < (std::int32_t)m_unprocessedAmplitudesCount)
-    {
-        IMEBRA_THROW(CodecCorruptedFileError, "Excess data in the lossless jpeg stream");
-    }
+///////////////////////////////////////////////////////////
+//
+// Apply the lossless predictors to the amplitudes and
+//  store the samples into the destination image.
+//
+// The predictors read the samples already decoded from
+//  the image. The samples that don't map into the image
+//  (the padding on the right and bottom) are not stored:
+//  they are never used to predict the image's samples, so
+//  they are predicted from the left sample only
+//
+///////////////////////////////////////////////////////////
+template<typename samplesType_t>
+static void storeLosslessSamples(jpegChannel& channel)
+{
+    IMEBRA_FUNCTION_START();
+
+    samplesType_t* const pSamples(reinterpret_cast<samplesType_t*>(channel.m_pSamples));
+    const size_t pixelSize((size_t)channel.m_samplesImageChannels * channel.m_samplesReplicateX);
+    const size_t rowSize((size_t)channel.m_samplesImageWidth * channel.m_samplesImageChannels * channel.m_samplesReplicateY);
+    const std::uint32_t visibleWidth((channel.m_samplesImageWidth + channel.m_samplesReplicateX - 1) / channel.m_samplesReplicateX);
+    const std::uint32_t visibleHeight((channel.m_samplesImageHeight + channel.m_samplesReplicateY - 1) / channel.m_samplesReplicateY);
+    const bool bReplicate(channel.m_samplesReplicateX != 1 || channel.m_samplesReplicateY != 1);
 
-    if(m_unprocessedAmplitudesPredictor == 0)
+    // Bits set in the negative samples of signed images
+    ///////////////////////////////////////////////////////////
+    const std::int32_t signBit((channel.m_valuesMask >> 1) + 1);
+    const std::int32_t negativeBits(channel.m_bSignedSamples ? ~channel.m_valuesMask : 0);
+
+    const std::int32_t* pSource(channel.m_unprocessedAmplitudesBuffer);
+    for(; channel.m_unprocessedAmplitudesCount != 0; --channel.m_unprocessedAmplitudesCount)
     {
-        while(m_unprocessedAmplitudesCount != 0)
+        const std::uint32_t positionX(channel.m_losslessPositionX);
+        const std::uint32_t positionY(channel.m_losslessPositionY);
+        const bool bVisible(positionX < visibleWidth && positionY < visibleHeight);
+        samplesType_t* const pDest(pSamples + positionY * rowSize + positionX * pixelSize);
+
+        int applyPrediction((int)channel.m_unprocessedAmplitudesPredictor);
+        if(applyPrediction != 0)
         {
-            --m_unprocessedAmplitudesCount;
-            *(pDest++) = *(pSource++) & m_valuesMask;
-            if(++m_losslessPositionX == m_width)
+            if(positionY == channel.m_losslessFirstLineY || !bVisible)
+            {
+                applyPrediction = 1;
+            }
+            else if(positionX == 0)
             {
-                m_losslessPositionX = 0;
-                ++m_losslessPositionY;
+                applyPrediction = 2;
             }
         }
-        m_lastDCValue = *(pDest - 1);
-        return;
-    }
 
-    int applyPrediction;
-    std::int32_t* pPreviousLine = pDest - m_width;
-    std::int32_t* pPreviousLineColumn = pDest - m_width - 1;
-    while(m_unprocessedAmplitudesCount != 0)
-    {
-        --m_unprocessedAmplitudesCount;
-        applyPrediction = (int)m_unprocessedAmplitudesPredictor;
-        if(m_losslessPositionY == 0)
-        {
-            applyPrediction = 1;
-        }
-        else if(m_losslessPositionX == 0)
-        {
-            applyPrediction = 2;
-        }
         switch(applyPrediction)
         {
+        case 0:
+            channel.m_lastDCValue = *(pSource++);
+            break;
         case 1:
-            m_lastDCValue += *(pSource++);
+            channel.m_lastDCValue += *(pSource++);
             break;
         case 2:
-            m_lastDCValue = *(pSource++) + *pPreviousLine;
+            channel.m_lastDCValue = *(pSource++) + ((std::int32_t)*(pDest - rowSize) & channel.m_valuesMask);
             break;
         case 3:
-            m_lastDCValue = *(pSource++) + *pPreviousLineColumn;
+            channel.m_lastDCValue = *(pSource++) + ((std::int32_t)*(pDest - rowSize - pixelSize) & channel.m_valuesMask);
             break;
         case 4:
-            m_lastDCValue += *(pSource++) + *pPreviousLine - *pPreviousLineColumn;
+            channel.m_lastDCValue += *(pSource++) + ((std::int32_t)*(pDest - rowSize) & channel.m_valuesMask) - ((std::int32_t)*(pDest - rowSize - pixelSize) & channel.m_valuesMask);
             break;
         case 5:
-            m_lastDCValue += *(pSource++) + ((*pPreviousLine - *pPreviousLineColumn)>>1);
+            channel.m_lastDCValue += *(pSource++) + ((((std::int32_t)*(pDest - rowSize) & channel.m_valuesMask) - ((std::int32_t)*(pDest - rowSize - pixelSize) & channel.m_valuesMask))>>1);
             break;
         case 6:
-            m_lastDCValue -= *pPreviousLineColumn;
-            m_lastDCValue >>= 1;
-            m_lastDCValue += *(pSource++) + *pPreviousLine;
+            channel.m_lastDCValue -= ((std::int32_t)*(pDest - rowSize - pixelSize) & channel.m_valuesMask);
+            channel.m_lastDCValue >>= 1;
+            channel.m_lastDCValue += *(pSource++) + ((std::int32_t)*(pDest - rowSize) & channel.m_valuesMask);
             break;
         case 7:
-            m_lastDCValue += *pPreviousLine;
-            m_lastDCValue >>= 1;
-            m_lastDCValue += *(pSource++);
+            channel.m_lastDCValue += ((std::int32_t)*(pDest - rowSize) & channel.m_valuesMask);
+            channel.m_lastDCValue >>= 1;
+            channel.m_lastDCValue += *(pSource++);
             break;
         default:
             IMEBRA_THROW(CodecCorruptedFileError, "Wrong predictor index in lossless jpeg stream");
         }
 
-        m_lastDCValue &= m_valuesMask;
-        *pDest++ = m_lastDCValue;
+        channel.m_lastDCValue &= channel.m_valuesMask;
 
-        ++pPreviousLine;
-        ++pPreviousLineColumn;
-        if(++m_losslessPositionX == m_width)
+        if(bVisible)
         {
-            ++m_losslessPositionY;
-            m_losslessPositionX = 0;
+            std::int32_t value(channel.m_lastDCValue);
+            if((value & signBit) != 0)
+            {
+                value |= negativeBits;
+            }
+
+            if(!bReplicate)
+            {
+                *pDest = (samplesType_t)value;
+            }
+            else
+            {
+                const std::uint32_t replicateX(std::min(channel.m_samplesReplicateX, channel.m_samplesImageWidth - positionX * channel.m_samplesReplicateX));
+                const std::uint32_t replicateY(std::min(channel.m_samplesReplicateY, channel.m_samplesImageHeight - positionY * channel.m_samplesReplicateY));
+                samplesType_t* pReplicateRow(pDest);
+                for(std::uint32_t scanY(0); scanY != replicateY; ++scanY, pReplicateRow += channel.m_samplesImageWidth * channel.m_samplesImageChannels)
+                {
+                    samplesType_t* pReplicate(pReplicateRow);
+                    for(std::uint32_t scanX(0); scanX != replicateX; ++scanX, pReplicate += channel.m_samplesImageChannels)
+                    {
+                        *pReplicate = (samplesType_t)value;
+                    }
+                }
+            }
+        }
+
+        if(++channel.m_losslessPositionX == channel.m_width)
+        {
+            channel.m_losslessPositionX = 0;
+            ++channel.m_losslessPositionY;
         }
     }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Decode the lossless amplitudes read so far
+//
+///////////////////////////////////////////////////////////
+void jpegChannel::processUnprocessedAmplitudes()
+{
+    IMEBRA_FUNCTION_START();
+
+    if(m_unprocessedAmplitudesCount == 0)
+    {
+        return;
+    }
+
+    // Find missing pixels
+    std::int32_t missingPixels = (std::int32_t)m_width - (std::int32_t)m_losslessPositionX + (std::int32_t)m_width * ((std::int32_t)m_height - (std::int32_t)m_losslessPositionY - 1);
+    if(missingPixels < (std::int32_t)m_unprocessedAmplitudesCount)
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Excess data in the lossless jpeg stream");
+    }
+
+    if(m_pSamples == nullptr)
+    {
+        IMEBRA_THROW(std::logic_error, "The destination of the jpeg samples has not been set");
+    }
+
+    switch(m_samplesDepth)
+    {
+    case bitDepth_t::depthU8:
+        storeLosslessSamples<std::uint8_t>(*this);
+        break;
+    case bitDepth_t::depthS8:
+        storeLosslessSamples<std::int8_t>(*this);
+        break;
+    case bitDepth_t::depthU16:
+        storeLosslessSamples<std::uint16_t>(*this);
+        break;
+    case bitDepth_t::depthS16:
+        storeLosslessSamples<std::int16_t>(*this);
+        break;
+    default:
+        IMEBRA_THROW(std::logic_error, "Wrong depth for the jpeg samples");
+    }
+
     IMEBRA_FUNCTION_END();
 }
 
@@ -1081,12 +1392,17 @@ void tagDHT::writeTag(streamWriter* pStream, jpegInformation& information) const
                 /////////////////////////////////////////////////////////////////
                 if(phase == 0)
                 {
-                    pHuffman->incValueFreq(0x100);
-                    pHuffman->calcHuffmanCodesLength(16);
-                    // Remove the value 0x100 now
-                    pHuffman->removeLastCode();
+                    // The typical tables are already complete
+                    /////////////////////////////////////////////////////////////////
+                    if(!information.m_bStandardHuffmanTables)
+                    {
+                        pHuffman->incValueFreq(0x100);
+                        pHuffman->calcHuffmanCodesLength(16);
+                        // Remove the value 0x100 now
+                        pHuffman->removeLastCode();
 
-                    pHuffman->calcHuffmanTables();
+                        pHuffman->calcHuffmanTables();
+                    }
                     tagLength = (std::uint16_t)(tagLength + 17);
                     for(std::uint32_t scanLength(0); scanLength != 16;)
                     {
@@ -1517,6 +1833,7 @@ void tagRST::readTag(streamReader&, jpegInformation* pInformation, std::uint8_t
         {
             pChannel->m_losslessPositionX = pInformation->m_mcuProcessedX / pChannel->m_blockMcuX;
             pChannel->m_losslessPositionY = pInformation->m_mcuProcessedY / pChannel->m_blockMcuY;
+            pChannel->m_losslessFirstLineY = pChannel->m_losslessPositionY;
         }
     }
 
@@ -1586,8 +1903,83 @@ void tagEOI::readTag(streamReader&, jpegInformation* pInformation, std::uint8_t
 jpegStreamReader::jpegStreamReader(std::shared_ptr<streamReader> pStreamReader):
     m_pStreamReader(pStreamReader),
     m_inBitsBuffer(0),
-    m_inBitsNum(0)
+    m_inBitsNum(0),
+    m_bEndOfData(false)
+{
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Load the bits buffer
+//
+///////////////////////////////////////////////////////////
+void jpegStreamReader::fillBitsBuffer()
+{
+    IMEBRA_FUNCTION_START();
+
+    while(m_inBitsNum <= 56 && !m_bEndOfData)
+    {
+        // Two bytes are necessary to tell a 0xff byte from a tag
+        ///////////////////////////////////////////////////////////
+        size_t availableBytes(0);
+        const std::uint8_t* pData(m_pStreamReader->getBufferedData(2, &availableBytes));
+
+        size_t usedBytes(0);
+        while(m_inBitsNum <= 56 && usedBytes != availableBytes)
+        {
+            const std::uint8_t byte(pData[usedBytes]);
+            if(byte == 0xff)
+            {
+                if(usedBytes + 1 == availableBytes)
+                {
+                    // The byte following 0xff will be loaded by the
+                    //  next call to getBufferedData(). When it is
+                    //  missing the stream is over
+                    ///////////////////////////////////////////////////////////
+                    m_bEndOfData = (usedBytes == 0);
+                    break;
+                }
+                if(pData[usedBytes + 1] != 0)
+                {
+                    m_bEndOfData = true;
+                    break;
+                }
+                ++usedBytes;
+            }
+            ++usedBytes;
+            m_inBitsBuffer |= static_cast<std::uint64_t>(byte) << (56 - m_inBitsNum);
+            m_inBitsNum += 8;
+        }
+
+        m_pStreamReader->skipBufferedData(usedBytes);
+
+        if(availableBytes == 0)
+        {
+            m_bEndOfData = true;
+        }
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Report the lack of entropy coded data
+//
+///////////////////////////////////////////////////////////
+void jpegStreamReader::throwMissingBits()
 {
+    IMEBRA_FUNCTION_START();
+
+    if(m_pStreamReader->endReached())
+    {
+        IMEBRA_THROW(StreamEOFError, "Attempt to read past the end of the file");
+    }
+    IMEBRA_THROW(CodecCorruptedFileError, "Corrupted jpeg stream (tag in data stream)");
+
+    IMEBRA_FUNCTION_END();
 }
 
 
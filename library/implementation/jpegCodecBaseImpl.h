@@ -21,6 +21,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 
 #include <map>
 #include <list>
+#include <vector>
 #include "imageCodecImpl.h"
 #include "streamReaderImpl.h"
 
@@ -92,6 +93,11 @@ namespace jpeg
         std::uint32_t m_losslessPositionX;
         std::uint32_t m_losslessPositionY;
 
+        // First lossless line of the active restart interval:
+        //  it is predicted from the left pixel only
+        ///////////////////////////////////////////////////////////
+        std::uint32_t m_losslessFirstLineY;
+
         std::int32_t m_unprocessedAmplitudesBuffer[1024];
         std::uint32_t m_unprocessedAmplitudesCount;
         std::uint32_t m_unprocessedAmplitudesPredictor;
@@ -105,6 +111,43 @@ namespace jpeg
 
         std::int32_t m_valuesMask;
 
+        // Quantized DCT coefficients of the channel's blocks.
+        //  Needed only when the coefficients of a block are
+        //  spread across several scans (progressive process):
+        //  allocated by the first scan that needs them
+        ///////////////////////////////////////////////////////////
+        std::shared_ptr<memory> m_pCoefficientsMemory;
+        std::int32_t* m_pCoefficients;
+
+        // Where the decoder writes the channel's samples: the
+        //  first sample of the channel in the interleaved buffer
+        //  of the destination image, the image's depth, size and
+        //  number of channels and the number of image's pixels
+        //  covered by each channel's sample. The encoder uses
+        //  the same description for the source image
+        ///////////////////////////////////////////////////////////
+        std::uint8_t* m_pSamples;
+        bitDepth_t m_samplesDepth;
+        bool m_bSignedSamples;
+        std::uint32_t m_samplesImageWidth;
+        std::uint32_t m_samplesImageHeight;
+        std::uint32_t m_samplesImageChannels;
+        std::uint32_t m_samplesReplicateX;
+        std::uint32_t m_samplesReplicateY;
+
+        // Encoder only: the source image's channel, the row of
+        //  a lossless channel being encoded and the first value
+        //  of the previous row. The samples are read from the
+        //  source image when they are needed
+        ///////////////////////////////////////////////////////////
+        std::uint32_t m_sourceChannel;
+        std::vector<std::int32_t> m_losslessRow;
+        std::int32_t m_losslessAboveValue;
+
+        // Allocate the quantized coefficients' store
+        ///////////////////////////////////////////////////////////
+        void allocateCoefficients();
+
         inline void addUnprocessedAmplitude(std::int32_t unprocessedAmplitude, std::uint32_t predictor, bool bMcuRestart)
         {
             if(bMcuRestart ||
@@ -149,9 +192,30 @@ namespace jpeg
         ///////////////////////////////////////////////////////////
         void findMcuSize();
 
+        // Set the region of the image that must be decoded.
+        //  The MCUs outside the region may be left undecoded
+        ///////////////////////////////////////////////////////////
+        void setRegion(std::uint32_t left, std::uint32_t top, std::uint32_t width, std::uint32_t height);
+
+        // Return true if at least one MCU of the active scan in
+        //  the range firstMcu..endMcu (excluded) intersects the
+        //  region
+        ///////////////////////////////////////////////////////////
+        bool mcusInRegion(std::uint32_t firstMcu, std::uint32_t endMcu) const;
+
+        // Return the MCU of the active scan that follows the
+        //  last MCU in the region
+        ///////////////////////////////////////////////////////////
+        std::uint32_t getRegionEndMcu() const;
+
         // Recalculate the tables for dequantization/quantization
         void recalculateQuantizationTables(int table);
 
+        // Load the typical huffman tables listed in Annex K
+        //  into the tables 0 (luminance) and 1 (chrominance)
+        ///////////////////////////////////////////////////////////
+        void setStandardHuffmanTables();
+
         // The image's size, in pixels
         ///////////////////////////////////////////////////////////
         std::uint32_t m_imageWidth;
@@ -218,6 +282,12 @@ namespace jpeg
         ///////////////////////////////////////////////////////////
         bool m_bLossless;
 
+        // true if the huffman tables have been loaded by
+        //  setStandardHuffmanTables() instead of being
+        //  calculated from the values' frequencies
+        ///////////////////////////////////////////////////////////
+        bool m_bStandardHuffmanTables;
+
         // The maximum sampling factor
         ///////////////////////////////////////////////////////////
         std::uint32_t m_maxSamplingFactorX;
@@ -229,6 +299,18 @@ namespace jpeg
         std::uint32_t m_mcuNumberY;
         std::uint32_t m_mcuNumberTotal;
 
+        // The MCU's size, in image's pixels
+        ///////////////////////////////////////////////////////////
+        std::uint32_t m_mcuSizeX;
+        std::uint32_t m_mcuSizeY;
+
+        // The region that must be decoded, in image's pixels
+        //  (right and bottom excluded)
+        ///////////////////////////////////////////////////////////
+        std::uint32_t m_regionLeft;
+        std::uint32_t m_regionTop;
+        std::uint32_t m_regionRight;
+        std::uint32_t m_regionBottom;
 
         // The image's size, rounded to accomodate all the MCUs
         ///////////////////////////////////////////////////////////
@@ -236,6 +318,7 @@ namespace jpeg
         std::uint32_t m_jpegImageHeight;
 
         long long m_decompressionQuantizationTable[16][64];
+        float m_floatDecompressionQuantizationTable[16][64];
         float m_compressionQuantizationTable[16][64];
 
     };
@@ -553,11 +636,12 @@ public:
     /// \brief Read the specified amount of bits from the
     ///         stream.
     ///
-    /// The functions uses a special bit pointer to keep track
-    ///  of the bytes that haven't been completly read.
+    /// The bits are taken from a 64 bits buffer that is
+    ///  refilled several bytes at once by fillBitsBuffer().
     ///
-    /// The function throws a streamExceptionRead exception if
-    ///  an error occurs.
+    /// The function throws CodecCorruptedFileError if
+    ///  the entropy coded data ends before the requested bits
+    ///  are available.
     ///
     /// @param bitsNum   the number of bits to read.
     ///                  The function can read 32 bits maximum
@@ -567,52 +651,9 @@ public:
     ///////////////////////////////////////////////////////////
     inline std::uint32_t readBits(size_t bitsNum)
     {
-        IMEBRA_FUNCTION_START();
-
-        const size_t bufferSize(8);
-
-        // All the requested bits are already in the buffer.
-        // Just return them.
-        ///////////////////////////////////////////////////////////
-        if(bitsNum <= m_inBitsNum)
-        {
-            std::uint32_t returnValue((m_inBitsBuffer & 0x00ff) >> (bufferSize - bitsNum));
-            m_inBitsBuffer <<= bitsNum;
-            m_inBitsNum -= bitsNum;
-            return returnValue;
-        }
-
-        // Fill a local variable with the read bits
-        ///////////////////////////////////////////////////////////
-        std::uint32_t returnValue(0);
-
-        // Some bits are in the bits buffer, copy them and reset
-        //  the bits buffer
-        ///////////////////////////////////////////////////////////
-        if(m_inBitsNum != 0)
-        {
-            bitsNum -= m_inBitsNum;
-            returnValue = ((std::uint32_t)((m_inBitsBuffer & 0xff) >> (bufferSize - m_inBitsNum))) << bitsNum;
-        }
-
-        // Read the requested number of bits
-        ///////////////////////////////////////////////////////////
-        for(;;)
-        {
-            if(bitsNum <= 8)
-            {
-                m_inBitsBuffer = readByte();
-                returnValue |= (m_inBitsBuffer >> (bufferSize - bitsNum));
-                m_inBitsBuffer <<= bitsNum;
-                m_inBitsNum = 8 - bitsNum;
-                return returnValue;
-            }
-
-            bitsNum -= 8;
-            returnValue |= ((std::uint32_t)readByte()) << bitsNum;
-        }
-
-        IMEBRA_FUNCTION_END();
+        const std::uint32_t returnValue(peekBits(bitsNum));
+        skipBits(bitsNum);
+        return returnValue;
     }
 
     /// \brief Read one bit from the stream.
@@ -620,137 +661,125 @@ public:
     /// The returned buffer will store the value 0 or 1,
     ///  depending on the value of the read bit.
     ///
-    /// The function throws a streamExceptionRead if an error
-    ///  occurs.
-    ///
     /// @return the value of the read bit (1 or 0)
     ///
     ///////////////////////////////////////////////////////////
     inline std::uint32_t readBit()
     {
-        IMEBRA_FUNCTION_START();
+        return readBits(1);
+    }
 
-        if(m_inBitsNum == 0)
+    /// \brief Return the specified amount of bits without
+    ///         moving the read position.
+    ///
+    /// When the entropy coded data ends before the requested
+    ///  bits then the missing bits are set to zero: the
+    ///  caller must then call skipBits() only with the number
+    ///  of bits actually used, which fails if they exceed the
+    ///  available data.
+    ///
+    /// @param bitsNum   the number of bits to return.
+    ///                  The function can return 32 bits
+    ///                  maximum
+    /// @return an integer containing the bits, right aligned
+    ///
+    ///////////////////////////////////////////////////////////
+    inline std::uint32_t peekBits(size_t bitsNum)
+    {
+        if(m_inBitsNum < bitsNum && !m_bEndOfData)
         {
-            m_inBitsBuffer = readByte();
-            m_inBitsNum = 8;
+            fillBitsBuffer();
         }
-        --m_inBitsNum;
-        m_inBitsBuffer <<= 1;
-        return (m_inBitsBuffer >> 8) & 1;
 
-        IMEBRA_FUNCTION_END();
+        // Shift in two steps, so bitsNum = 0 doesn't cause
+        //  a shift by 64 positions
+        ///////////////////////////////////////////////////////////
+        return static_cast<std::uint32_t>((m_inBitsBuffer >> 1) >> (63 - bitsNum));
     }
 
-
-    /// \brief Read one bit from the stream and add its value
-    ///         to the specified buffer.
-    ///
-    /// The buffer pointed by the pBuffer parameter is
-    ///  left-shifted before the read bit is inserted in the
-    ///  least significant bit of the buffer.
+    /// \brief Move the read position forward by the
+    ///         specified amount of bits.
     ///
-    /// The function throws a streamExceptionRead if an error
-    ///  occurs.
+    /// Should be called after peekBits().
     ///
-    /// @param pBuffer   a pointer to a std::uint32_t value that
-    ///                   will be left shifted and filled
-    ///                   with the read bit.
+    /// @param bitsNum   the number of bits to skip
     ///
     ///////////////////////////////////////////////////////////
-    inline void addBit(std::uint32_t* const pBuffer)
+    inline void skipBits(size_t bitsNum)
     {
-        IMEBRA_FUNCTION_START();
-
-        (*pBuffer) <<= 1;
-
-        if(m_inBitsNum == 0)
+        if(bitsNum > m_inBitsNum)
         {
-            m_inBitsBuffer = readByte();
-            m_inBitsNum = 8;
+            fillBitsBuffer();
+            if(bitsNum > m_inBitsNum)
+            {
+                throwMissingBits();
+            }
         }
-        m_inBitsBuffer <<= 1;
-        --m_inBitsNum;
-        *pBuffer |= (m_inBitsBuffer >> 8) & 1;
-
-        IMEBRA_FUNCTION_END();
+        m_inBitsBuffer <<= bitsNum;
+        m_inBitsNum -= bitsNum;
     }
 
-    /// \brief Reset the bit pointer used by readBits(),
-    ///         readBit() and addBit().
+    /// \brief Discard the bits loaded by readBits(),
+    ///         peekBits() and readBit().
     ///
-    /// A subsequent call to readBits(), readBit and
-    ///  addBit() will read data from a byte-aligned boundary.
+    /// Must be called when the entropy coded segment ends:
+    ///  a subsequent call to readBits(), peekBits() and
+    ///  readBit() will load the data that follows the
+    ///  current position of the streamReader.
     ///
     ///////////////////////////////////////////////////////////
     inline void resetInBitsBuffer()
     {
+        m_inBitsBuffer = 0;
         m_inBitsNum = 0;
+        m_bEndOfData = false;
     }
 
-    /// \brief Read a single byte from the stream, parsing it
-    ///         if m_pTagByte is not zero.
+    /// \brief Returns true if the entropy coded data has been
+    ///         completely read.
     ///
-    /// The read byte is stored in the buffer pointed by the
-    ///  parameter pBuffer.
+    /// Only the bits that pad the last byte may be still
+    ///  available.
     ///
-    /// If m_pTagByte is zero, then the function reads a byte
-    ///  and returns true.
-    ///
-    /// If m_pTagByte is not zero, then the function skips
-    ///  all the bytes in the stream that have the value 0xFF.
-    /// If the function doesn't have to skip any 0xFF bytes,
-    ///  then the function just read a byte and returns true.
-    ///
-    /// If one or more 0xFF bytes have been skipped, then
-    ///  the function returns a value depending on the byte
-    ///  that follows the 0xFF run:
-    /// - if the byte is 0, then the function fill the pBuffer
-    ///    parameter with a value 0xFF and returns true
-    /// - if the byte is not 0, then that value is stored in
-    ///    the location pointed by m_pTagByte and the function
-    ///    returns false.
-    ///
-    /// This mechanism is used to parse the jpeg tags in a
-    ///  stream.
-    ///
-    /// @return          the read byte
+    /// @return true if all the bytes have been read
     ///
     ///////////////////////////////////////////////////////////
-    inline std::uint8_t readByte()
+    inline bool endReached()
     {
-        IMEBRA_FUNCTION_START();
-
-        // Read one byte. Return immediatly if the tags are not
-        //  activated
-        ///////////////////////////////////////////////////////////
-        std::uint8_t byte;
-        m_pStreamReader->read(&byte, 1);
-        if(byte != 0xff)
-        {
-            return byte;
-        }
-        while(byte == 0xff)
-        {
-            m_pStreamReader->read(&byte, 1);
-        }
-
-        if(byte == 0)
-        {
-            return 0xff;
-        }
-
-        IMEBRA_THROW(CodecCorruptedFileError, "Corrupted jpeg stream (tag in data stream)");
-
-        IMEBRA_FUNCTION_END();
+        return m_inBitsNum < 8 && m_pStreamReader->endReached();
     }
 
 private:
+    /// \brief Load bytes into the bits buffer until it
+    ///         contains at least 57 bits or a jpeg tag is
+    ///         found.
+    ///
+    /// The 0xff bytes followed by 0x00 are loaded as 0xff.
+    /// The bytes that form a jpeg tag are not consumed, so
+    ///  the tag can be parsed after the entropy coded
+    ///  segment has been decoded.
+    ///
+    ///////////////////////////////////////////////////////////
+    void fillBitsBuffer();
+
+    /// \brief Throws the exception related to the lack of
+    ///         data requested by skipBits().
+    ///
+    ///////////////////////////////////////////////////////////
+    void throwMissingBits();
+
     std::shared_ptr<streamReader> m_pStreamReader;
 
-    unsigned int m_inBitsBuffer;
+    // Buffered bits, left aligned. The unused bits are zero
+    ///////////////////////////////////////////////////////////
+    std::uint64_t m_inBitsBuffer;
     size_t m_inBitsNum;
 
+    // Set when the buffer cannot be filled because a tag or
+    //  the end of the stream has been found
+    ///////////////////////////////////////////////////////////
+    bool m_bEndOfData;
+
 };
 
 } // namespace codecs
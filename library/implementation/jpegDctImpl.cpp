@@ -0,0 +1,707 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file jpegDctImpl.cpp
+    \brief Implementation of the SIMD DCT kernels used by the jpeg codec.
+
+    The kernels implement the same AAN algorithm used by
+     jpegImageCodec::FDCT() and jpegImageCodec::IDCT()
+     (from the IJG software version 6b), processing 4 (SSE2)
+     or 8 (AVX2) rows or columns at once.
+
+*/
+
+#include "jpegDctImpl.h"
+#include "exceptionImpl.h"
+#include "../include/imebra/exceptions.h"
+
+#if !defined(IMEBRA_JPEG_PORTABLE_DCT) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+    #define IMEBRA_JPEG_DCT_X86
+#endif
+
+#if defined(IMEBRA_JPEG_DCT_X86)
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define IMEBRA_TARGET_SSE2
+        #define IMEBRA_TARGET_AVX2
+    #else
+        #define IMEBRA_TARGET_SSE2 __attribute__((target("sse2")))
+        #define IMEBRA_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+namespace codecs
+{
+
+#if defined(IMEBRA_JPEG_DCT_X86)
+
+namespace
+{
+
+///////////////////////////////////////////////////////////
+//
+// CPU features detection
+//
+///////////////////////////////////////////////////////////
+#if defined(_MSC_VER)
+
+bool cpuSupportsSse2()
+{
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+}
+
+bool cpuSupportsAvx2()
+{
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7)
+    {
+        return false;
+    }
+
+    // The OS must save the AVX registers
+    ///////////////////////////////////////////////////////////
+    __cpuid(info, 1);
+    const bool bOsxsave((info[2] & (1 << 27)) != 0);
+    const bool bAvx((info[2] & (1 << 28)) != 0);
+    if(!bOsxsave || !bAvx || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+
+#else
+
+bool cpuSupportsSse2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+}
+
+bool cpuSupportsAvx2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}
+
+#endif
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// SSE2 kernels.
+// The 8x8 block is stored in two halves of 8 vectors each:
+//  the columns 0...3 and the columns 4...7
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////
+//
+// Transpose the block
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_SSE2 inline void transposeSse2(__m128* pLeft, __m128* pRight)
+{
+    _MM_TRANSPOSE4_PS(pLeft[0], pLeft[1], pLeft[2], pLeft[3]);
+    _MM_TRANSPOSE4_PS(pLeft[4], pLeft[5], pLeft[6], pLeft[7]);
+    _MM_TRANSPOSE4_PS(pRight[0], pRight[1], pRight[2], pRight[3]);
+    _MM_TRANSPOSE4_PS(pRight[4], pRight[5], pRight[6], pRight[7]);
+
+    // Swap the top right and bottom left quarters
+    ///////////////////////////////////////////////////////////
+    for(int swapRows(0); swapRows != 4; ++swapRows)
+    {
+        const __m128 temp(pLeft[swapRows + 4]);
+        pLeft[swapRows + 4] = pRight[swapRows];
+        pRight[swapRows] = temp;
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// One dimensional IDCT on the 4 columns stored in v
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_SSE2 inline void idct1DSse2(__m128* v)
+{
+    const __m128 c1_414213562(_mm_set1_ps(1.414213562f));
+    const __m128 c1_847759065(_mm_set1_ps(1.847759065f));
+    const __m128 c1_0823922(_mm_set1_ps(1.0823922f));
+    const __m128 c2_61312593(_mm_set1_ps(2.61312593f));
+
+    // Even part
+    ///////////////////////////////////////////////////////////
+    const __m128 tmp10(_mm_add_ps(v[0], v[4]));
+    const __m128 tmp11(_mm_sub_ps(v[0], v[4]));
+    const __m128 tmp13(_mm_add_ps(v[2], v[6]));
+    const __m128 tmp12(_mm_sub_ps(_mm_mul_ps(_mm_sub_ps(v[2], v[6]), c1_414213562), tmp13)); // 2*c4
+
+    const __m128 tmp0(_mm_add_ps(tmp10, tmp13));
+    const __m128 tmp3(_mm_sub_ps(tmp10, tmp13));
+    const __m128 tmp1(_mm_add_ps(tmp11, tmp12));
+    const __m128 tmp2(_mm_sub_ps(tmp11, tmp12));
+
+    // Odd part
+    ///////////////////////////////////////////////////////////
+    const __m128 z13(_mm_add_ps(v[5], v[3]));
+    const __m128 z10(_mm_sub_ps(v[5], v[3]));
+    const __m128 z11(_mm_add_ps(v[1], v[7]));
+    const __m128 z12(_mm_sub_ps(v[1], v[7]));
+
+    const __m128 tmp7(_mm_add_ps(z11, z13));
+    const __m128 z5(_mm_mul_ps(_mm_add_ps(z10, z12), c1_847759065));                 // 2*c2
+    const __m128 tmp6(_mm_sub_ps(_mm_sub_ps(z5, _mm_mul_ps(z10, c2_61312593)), tmp7)); // -2*(c2+c6)
+    const __m128 tmp5(_mm_sub_ps(_mm_mul_ps(_mm_sub_ps(z11, z13), c1_414213562), tmp6)); // 2*c4
+    const __m128 tmp4(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(z12, c1_0823922), z5), tmp5));  // 2*(c2-c6)
+
+    v[0] = _mm_add_ps(tmp0, tmp7);
+    v[7] = _mm_sub_ps(tmp0, tmp7);
+    v[1] = _mm_add_ps(tmp1, tmp6);
+    v[6] = _mm_sub_ps(tmp1, tmp6);
+    v[2] = _mm_add_ps(tmp2, tmp5);
+    v[5] = _mm_sub_ps(tmp2, tmp5);
+    v[3] = _mm_sub_ps(tmp3, tmp4);
+    v[4] = _mm_add_ps(tmp3, tmp4);
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// One dimensional FDCT on the 4 columns stored in v.
+// The operations are executed in the same order as in
+//  jpegImageCodec::FDCT(), so the results are identical
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_SSE2 inline void fdct1DSse2(__m128* v)
+{
+    const __m128 c0_707106781(_mm_set1_ps(0.707106781f));
+    const __m128 c0_382683433(_mm_set1_ps(0.382683433f));
+    const __m128 c0_541196100(_mm_set1_ps(0.541196100f));
+    const __m128 c1_306562965(_mm_set1_ps(1.306562965f));
+
+    const __m128 tmp0(_mm_add_ps(v[0], v[7]));
+    const __m128 tmp7(_mm_sub_ps(v[0], v[7]));
+    const __m128 tmp1(_mm_add_ps(v[1], v[6]));
+    const __m128 tmp6(_mm_sub_ps(v[1], v[6]));
+    const __m128 tmp2(_mm_add_ps(v[2], v[5]));
+    const __m128 tmp5(_mm_sub_ps(v[2], v[5]));
+    const __m128 tmp3(_mm_add_ps(v[3], v[4]));
+    const __m128 tmp4(_mm_sub_ps(v[3], v[4]));
+
+    // Even part
+    ///////////////////////////////////////////////////////////
+    const __m128 tmp10(_mm_add_ps(tmp0, tmp3));
+    const __m128 tmp13(_mm_sub_ps(tmp0, tmp3));
+    const __m128 tmp11(_mm_add_ps(tmp1, tmp2));
+    const __m128 tmp12(_mm_sub_ps(tmp1, tmp2));
+
+    v[0] = _mm_add_ps(tmp10, tmp11);
+    v[4] = _mm_sub_ps(tmp10, tmp11);
+
+    const __m128 z1(_mm_mul_ps(_mm_add_ps(tmp12, tmp13), c0_707106781)); // c4
+    v[2] = _mm_add_ps(tmp13, z1);
+    v[6] = _mm_sub_ps(tmp13, z1);
+
+    // Odd part
+    ///////////////////////////////////////////////////////////
+    const __m128 oddTmp10(_mm_add_ps(tmp4, tmp5));
+    const __m128 oddTmp11(_mm_add_ps(tmp5, tmp6));
+    const __m128 oddTmp12(_mm_add_ps(tmp6, tmp7));
+
+    const __m128 z5(_mm_mul_ps(_mm_sub_ps(oddTmp10, oddTmp12), c0_382683433)); // c6
+    const __m128 z2(_mm_add_ps(_mm_mul_ps(oddTmp10, c0_541196100), z5));       // c2-c6
+    const __m128 z4(_mm_add_ps(_mm_mul_ps(oddTmp12, c1_306562965), z5));       // c2+c6
+    const __m128 z3(_mm_mul_ps(oddTmp11, c0_707106781));                       // c4
+
+    const __m128 z11(_mm_add_ps(tmp7, z3));
+    const __m128 z13(_mm_sub_ps(tmp7, z3));
+
+    v[5] = _mm_add_ps(z13, z2);
+    v[3] = _mm_sub_ps(z13, z2);
+    v[1] = _mm_add_ps(z11, z4);
+    v[7] = _mm_sub_ps(z11, z4);
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Round to the nearest integer, rounding the halves up
+//  like jpegImageCodec::IDCT() (_mm_cvtps_epi32 rounds
+//  them to the nearest even value)
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_SSE2 inline __m128i roundSse2(const __m128 values)
+{
+    const __m128i rounded(_mm_cvtps_epi32(values));
+    const __m128 roundedDown(_mm_cmpeq_ps(_mm_sub_ps(values, _mm_cvtepi32_ps(rounded)), _mm_set1_ps(.5f)));
+    return _mm_sub_epi32(rounded, _mm_castps_si128(roundedDown));
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// SSE2 IDCT
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_SSE2 void idctSse2(std::int32_t* pIOMatrix, const float* pScaleFactors)
+{
+    __m128i* const pIntMatrix(reinterpret_cast<__m128i*>(pIOMatrix));
+
+    // If all the AC coefficients are zero then all the
+    //  pixels have the same value
+    ///////////////////////////////////////////////////////////
+    __m128i acCoefficients(_mm_and_si128(_mm_loadu_si128(pIntMatrix), _mm_set_epi32(-1, -1, -1, 0)));
+    for(int scanAc(1); scanAc != 16; ++scanAc)
+    {
+        acCoefficients = _mm_or_si128(acCoefficients, _mm_loadu_si128(pIntMatrix + scanAc));
+    }
+    if(_mm_movemask_epi8(_mm_cmpeq_epi32(acCoefficients, _mm_setzero_si128())) == 0xffff)
+    {
+        const __m128i dcValue(roundSse2(_mm_set1_ps(static_cast<float>(pIOMatrix[0]) * pScaleFactors[0])));
+        for(int storeValue(0); storeValue != 16; ++storeValue)
+        {
+            _mm_storeu_si128(pIntMatrix + storeValue, dcValue);
+        }
+        return;
+    }
+
+    __m128 left[8], right[8];
+    for(int loadRows(0); loadRows != 8; ++loadRows)
+    {
+        left[loadRows] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(pIntMatrix + loadRows * 2)), _mm_loadu_ps(pScaleFactors + loadRows * 8));
+        right[loadRows] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(pIntMatrix + loadRows * 2 + 1)), _mm_loadu_ps(pScaleFactors + loadRows * 8 + 4));
+    }
+
+    // Rows, then columns
+    ///////////////////////////////////////////////////////////
+    transposeSse2(left, right);
+    idct1DSse2(left);
+    idct1DSse2(right);
+    transposeSse2(left, right);
+    idct1DSse2(left);
+    idct1DSse2(right);
+
+    for(int storeRows(0); storeRows != 8; ++storeRows)
+    {
+        _mm_storeu_si128(pIntMatrix + storeRows * 2, roundSse2(left[storeRows]));
+        _mm_storeu_si128(pIntMatrix + storeRows * 2 + 1, roundSse2(right[storeRows]));
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// SSE2 FDCT
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_SSE2 void fdctSse2(std::int32_t* pIOMatrix, const float* pDescaleFactors)
+{
+    __m128i* const pIntMatrix(reinterpret_cast<__m128i*>(pIOMatrix));
+
+    __m128 left[8], right[8];
+    for(int loadRows(0); loadRows != 8; ++loadRows)
+    {
+        left[loadRows] = _mm_cvtepi32_ps(_mm_loadu_si128(pIntMatrix + loadRows * 2));
+        right[loadRows] = _mm_cvtepi32_ps(_mm_loadu_si128(pIntMatrix + loadRows * 2 + 1));
+    }
+
+    // Rows, then columns
+    ///////////////////////////////////////////////////////////
+    transposeSse2(left, right);
+    fdct1DSse2(left);
+    fdct1DSse2(right);
+    transposeSse2(left, right);
+    fdct1DSse2(left);
+    fdct1DSse2(right);
+
+    // Descale: same rounding as jpegImageCodec::FDCT()
+    ///////////////////////////////////////////////////////////
+    const __m128 half(_mm_set1_ps(.5f));
+    for(int storeRows(0); storeRows != 8; ++storeRows)
+    {
+        _mm_storeu_si128(pIntMatrix + storeRows * 2, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(left[storeRows], _mm_loadu_ps(pDescaleFactors + storeRows * 8)), half)));
+        _mm_storeu_si128(pIntMatrix + storeRows * 2 + 1, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(right[storeRows], _mm_loadu_ps(pDescaleFactors + storeRows * 8 + 4)), half)));
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// AVX2 kernels.
+// Each vector stores a row of the 8x8 block
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////
+//
+// Transpose the block
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_AVX2 inline void transposeAvx2(__m256* v)
+{
+    const __m256 t0(_mm256_unpacklo_ps(v[0], v[1]));
+    const __m256 t1(_mm256_unpackhi_ps(v[0], v[1]));
+    const __m256 t2(_mm256_unpacklo_ps(v[2], v[3]));
+    const __m256 t3(_mm256_unpackhi_ps(v[2], v[3]));
+    const __m256 t4(_mm256_unpacklo_ps(v[4], v[5]));
+    const __m256 t5(_mm256_unpackhi_ps(v[4], v[5]));
+    const __m256 t6(_mm256_unpacklo_ps(v[6], v[7]));
+    const __m256 t7(_mm256_unpackhi_ps(v[6], v[7]));
+
+    const __m256 s0(_mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)));
+    const __m256 s1(_mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)));
+    const __m256 s2(_mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)));
+    const __m256 s3(_mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)));
+    const __m256 s4(_mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)));
+    const __m256 s5(_mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2)));
+    const __m256 s6(_mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)));
+    const __m256 s7(_mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2)));
+
+    v[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    v[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    v[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    v[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    v[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    v[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    v[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    v[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// One dimensional IDCT on the 8 columns stored in v
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_AVX2 inline void idct1DAvx2(__m256* v)
+{
+    const __m256 c1_414213562(_mm256_set1_ps(1.414213562f));
+    const __m256 c1_847759065(_mm256_set1_ps(1.847759065f));
+    const __m256 c1_0823922(_mm256_set1_ps(1.0823922f));
+    const __m256 c2_61312593(_mm256_set1_ps(2.61312593f));
+
+    // Even part
+    ///////////////////////////////////////////////////////////
+    const __m256 tmp10(_mm256_add_ps(v[0], v[4]));
+    const __m256 tmp11(_mm256_sub_ps(v[0], v[4]));
+    const __m256 tmp13(_mm256_add_ps(v[2], v[6]));
+    const __m256 tmp12(_mm256_sub_ps(_mm256_mul_ps(_mm256_sub_ps(v[2], v[6]), c1_414213562), tmp13)); // 2*c4
+
+    const __m256 tmp0(_mm256_add_ps(tmp10, tmp13));
+    const __m256 tmp3(_mm256_sub_ps(tmp10, tmp13));
+    const __m256 tmp1(_mm256_add_ps(tmp11, tmp12));
+    const __m256 tmp2(_mm256_sub_ps(tmp11, tmp12));
+
+    // Odd part
+    ///////////////////////////////////////////////////////////
+    const __m256 z13(_mm256_add_ps(v[5], v[3]));
+    const __m256 z10(_mm256_sub_ps(v[5], v[3]));
+    const __m256 z11(_mm256_add_ps(v[1], v[7]));
+    const __m256 z12(_mm256_sub_ps(v[1], v[7]));
+
+    const __m256 tmp7(_mm256_add_ps(z11, z13));
+    const __m256 z5(_mm256_mul_ps(_mm256_add_ps(z10, z12), c1_847759065));                    // 2*c2
+    const __m256 tmp6(_mm256_sub_ps(_mm256_sub_ps(z5, _mm256_mul_ps(z10, c2_61312593)), tmp7)); // -2*(c2+c6)
+    const __m256 tmp5(_mm256_sub_ps(_mm256_mul_ps(_mm256_sub_ps(z11, z13), c1_414213562), tmp6)); // 2*c4
+    const __m256 tmp4(_mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(z12, c1_0823922), z5), tmp5));  // 2*(c2-c6)
+
+    v[0] = _mm256_add_ps(tmp0, tmp7);
+    v[7] = _mm256_sub_ps(tmp0, tmp7);
+    v[1] = _mm256_add_ps(tmp1, tmp6);
+    v[6] = _mm256_sub_ps(tmp1, tmp6);
+    v[2] = _mm256_add_ps(tmp2, tmp5);
+    v[5] = _mm256_sub_ps(tmp2, tmp5);
+    v[3] = _mm256_sub_ps(tmp3, tmp4);
+    v[4] = _mm256_add_ps(tmp3, tmp4);
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// One dimensional FDCT on the 8 columns stored in v.
+// The operations are executed in the same order as in
+//  jpegImageCodec::FDCT(), so the results are identical
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_AVX2 inline void fdct1DAvx2(__m256* v)
+{
+    const __m256 c0_707106781(_mm256_set1_ps(0.707106781f));
+    const __m256 c0_382683433(_mm256_set1_ps(0.382683433f));
+    const __m256 c0_541196100(_mm256_set1_ps(0.541196100f));
+    const __m256 c1_306562965(_mm256_set1_ps(1.306562965f));
+
+    const __m256 tmp0(_mm256_add_ps(v[0], v[7]));
+    const __m256 tmp7(_mm256_sub_ps(v[0], v[7]));
+    const __m256 tmp1(_mm256_add_ps(v[1], v[6]));
+    const __m256 tmp6(_mm256_sub_ps(v[1], v[6]));
+    const __m256 tmp2(_mm256_add_ps(v[2], v[5]));
+    const __m256 tmp5(_mm256_sub_ps(v[2], v[5]));
+    const __m256 tmp3(_mm256_add_ps(v[3], v[4]));
+    const __m256 tmp4(_mm256_sub_ps(v[3], v[4]));
+
+    // Even part
+    ///////////////////////////////////////////////////////////
+    const __m256 tmp10(_mm256_add_ps(tmp0, tmp3));
+    const __m256 tmp13(_mm256_sub_ps(tmp0, tmp3));
+    const __m256 tmp11(_mm256_add_ps(tmp1, tmp2));
+    const __m256 tmp12(_mm256_sub_ps(tmp1, tmp2));
+
+    v[0] = _mm256_add_ps(tmp10, tmp11);
+    v[4] = _mm256_sub_ps(tmp10, tmp11);
+
+    const __m256 z1(_mm256_mul_ps(_mm256_add_ps(tmp12, tmp13), c0_707106781)); // c4
+    v[2] = _mm256_add_ps(tmp13, z1);
+    v[6] = _mm256_sub_ps(tmp13, z1);
+
+    // Odd part
+    ///////////////////////////////////////////////////////////
+    const __m256 oddTmp10(_mm256_add_ps(tmp4, tmp5));
+    const __m256 oddTmp11(_mm256_add_ps(tmp5, tmp6));
+    const __m256 oddTmp12(_mm256_add_ps(tmp6, tmp7));
+
+    const __m256 z5(_mm256_mul_ps(_mm256_sub_ps(oddTmp10, oddTmp12), c0_382683433)); // c6
+    const __m256 z2(_mm256_add_ps(_mm256_mul_ps(oddTmp10, c0_541196100), z5));       // c2-c6
+    const __m256 z4(_mm256_add_ps(_mm256_mul_ps(oddTmp12, c1_306562965), z5));       // c2+c6
+    const __m256 z3(_mm256_mul_ps(oddTmp11, c0_707106781));                          // c4
+
+    const __m256 z11(_mm256_add_ps(tmp7, z3));
+    const __m256 z13(_mm256_sub_ps(tmp7, z3));
+
+    v[5] = _mm256_add_ps(z13, z2);
+    v[3] = _mm256_sub_ps(z13, z2);
+    v[1] = _mm256_add_ps(z11, z4);
+    v[7] = _mm256_sub_ps(z11, z4);
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Round to the nearest integer, rounding the halves up
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_AVX2 inline __m256i roundAvx2(const __m256 values)
+{
+    const __m256i rounded(_mm256_cvtps_epi32(values));
+    const __m256 roundedDown(_mm256_cmp_ps(_mm256_sub_ps(values, _mm256_cvtepi32_ps(rounded)), _mm256_set1_ps(.5f), _CMP_EQ_OQ));
+    return _mm256_sub_epi32(rounded, _mm256_castps_si256(roundedDown));
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// AVX2 IDCT
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_AVX2 void idctAvx2(std::int32_t* pIOMatrix, const float* pScaleFactors)
+{
+    __m256i* const pIntMatrix(reinterpret_cast<__m256i*>(pIOMatrix));
+
+    // If all the AC coefficients are zero then all the
+    //  pixels have the same value
+    ///////////////////////////////////////////////////////////
+    __m256i acCoefficients(_mm256_and_si256(_mm256_loadu_si256(pIntMatrix), _mm256_set_epi32(-1, -1, -1, -1, -1, -1, -1, 0)));
+    for(int scanAc(1); scanAc != 8; ++scanAc)
+    {
+        acCoefficients = _mm256_or_si256(acCoefficients, _mm256_loadu_si256(pIntMatrix + scanAc));
+    }
+    if(_mm256_testz_si256(acCoefficients, acCoefficients) != 0)
+    {
+        const __m256i dcValue(roundAvx2(_mm256_set1_ps(static_cast<float>(pIOMatrix[0]) * pScaleFactors[0])));
+        for(int storeValue(0); storeValue != 8; ++storeValue)
+        {
+            _mm256_storeu_si256(pIntMatrix + storeValue, dcValue);
+        }
+        return;
+    }
+
+    __m256 rows[8];
+    for(int loadRows(0); loadRows != 8; ++loadRows)
+    {
+        rows[loadRows] = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(pIntMatrix + loadRows)), _mm256_loadu_ps(pScaleFactors + loadRows * 8));
+    }
+
+    // Rows, then columns
+    ///////////////////////////////////////////////////////////
+    transposeAvx2(rows);
+    idct1DAvx2(rows);
+    transposeAvx2(rows);
+    idct1DAvx2(rows);
+
+    for(int storeRows(0); storeRows != 8; ++storeRows)
+    {
+        _mm256_storeu_si256(pIntMatrix + storeRows, roundAvx2(rows[storeRows]));
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// AVX2 FDCT
+//
+///////////////////////////////////////////////////////////
+IMEBRA_TARGET_AVX2 void fdctAvx2(std::int32_t* pIOMatrix, const float* pDescaleFactors)
+{
+    __m256i* const pIntMatrix(reinterpret_cast<__m256i*>(pIOMatrix));
+
+    __m256 rows[8];
+    for(int loadRows(0); loadRows != 8; ++loadRows)
+    {
+        rows[loadRows] = _mm256_cvtepi32_ps(_mm256_loadu_si256(pIntMatrix + loadRows));
+    }
+
+    // Rows, then columns
+    ///////////////////////////////////////////////////////////
+    transposeAvx2(rows);
+    fdct1DAvx2(rows);
+    transposeAvx2(rows);
+    fdct1DAvx2(rows);
+
+    // Descale: same rounding as jpegImageCodec::FDCT()
+    ///////////////////////////////////////////////////////////
+    const __m256 half(_mm256_set1_ps(.5f));
+    for(int storeRows(0); storeRows != 8; ++storeRows)
+    {
+        _mm256_storeu_si256(pIntMatrix + storeRows, _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(rows[storeRows], _mm256_loadu_ps(pDescaleFactors + storeRows * 8)), half)));
+    }
+}
+
+} // anonymous namespace
+
+#endif // defined(IMEBRA_JPEG_DCT_X86)
+
+
+///////////////////////////////////////////////////////////
+//
+// Return the kernels currently in use
+//
+///////////////////////////////////////////////////////////
+const jpegDct& jpegDct::getJpegDct()
+{
+    return *getSelectedJpegDct().load();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Select the kernels
+//
+///////////////////////////////////////////////////////////
+void jpegDct::setJpegDct(jpegDct_t dct)
+{
+    IMEBRA_FUNCTION_START();
+
+    const jpegDct* pDct(getSupportedJpegDct(dct));
+    if(pDct == nullptr)
+    {
+        IMEBRA_THROW(JpegCodecError, "The requested DCT implementation is not supported by the CPU");
+    }
+    getSelectedJpegDct().store(pDct);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Constructor
+//
+///////////////////////////////////////////////////////////
+jpegDct::jpegDct(jpegDct_t type, idct_t pIDCT, fdct_t pFDCT):
+    m_type(type),
+    m_pIDCT(pIDCT),
+    m_pFDCT(pFDCT)
+{
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Return the kernels of an implementation, or nullptr
+//  if the CPU doesn't support them
+//
+///////////////////////////////////////////////////////////
+const jpegDct* jpegDct::getSupportedJpegDct(jpegDct_t dct)
+{
+    static const jpegDct portableDct(jpegDct_t::portable, nullptr, nullptr);
+#if defined(IMEBRA_JPEG_DCT_X86)
+    static const jpegDct sse2Dct(jpegDct_t::sse2, idctSse2, fdctSse2);
+    static const jpegDct avx2Dct(jpegDct_t::avx2, idctAvx2, fdctAvx2);
+#endif
+
+    switch(dct)
+    {
+    case jpegDct_t::automatic:
+#if defined(IMEBRA_JPEG_DCT_X86)
+        if(cpuSupportsAvx2())
+        {
+            return &avx2Dct;
+        }
+        if(cpuSupportsSse2())
+        {
+            return &sse2Dct;
+        }
+#endif
+        return &portableDct;
+    case jpegDct_t::portable:
+        return &portableDct;
+#if defined(IMEBRA_JPEG_DCT_X86)
+    case jpegDct_t::sse2:
+        return cpuSupportsSse2() ? &sse2Dct : nullptr;
+    case jpegDct_t::avx2:
+        return cpuSupportsAvx2() ? &avx2Dct : nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Return the kernels currently in use. The fastest ones
+//  are selected the first time the function is called
+//
+///////////////////////////////////////////////////////////
+std::atomic<const jpegDct*>& jpegDct::getSelectedJpegDct()
+{
+    static std::atomic<const jpegDct*> selectedDct(getSupportedJpegDct(jpegDct_t::automatic));
+    return selectedDct;
+}
+
+} // namespace codecs
+
+} // namespace implementation
+
+} // namespace imebra
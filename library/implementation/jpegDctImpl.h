@@ -0,0 +1,156 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file jpegDctImpl.h
+    \brief Declaration of the SIMD DCT kernels used by the jpeg codec.
+
+*/
+
+#if !defined(imebraJpegDct_4A1C7E2B_93D5_4F08_B6E1_2C8D05F3A7E9__INCLUDED_)
+#define imebraJpegDct_4A1C7E2B_93D5_4F08_B6E1_2C8D05F3A7E9__INCLUDED_
+
+#include <atomic>
+#include <cstdint>
+#include "../include/imebra/definitions.h"
+
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+namespace codecs
+{
+
+/// \addtogroup group_codecs
+///
+/// @{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief Selects the 8x8 FDCT and IDCT kernels used by
+///        the jpeg codec.
+///
+/// By default the fastest kernels supported by the CPU
+///  are used; setJpegDct() selects a specific
+///  implementation.
+///
+/// When the portable implementation is selected (or when
+///  the CPU doesn't support any of the SIMD kernels, or
+///  IMEBRA_JPEG_PORTABLE_DCT is defined) the function
+///  pointers are null and the jpeg codec uses its portable
+///  jpegImageCodec::FDCT() and jpegImageCodec::IDCT().
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class jpegDct
+{
+public:
+    /// \brief Inverse DCT of a dequantized block.
+    ///
+    /// The results are rounded like the ones returned by
+    ///  jpegImageCodec::IDCT(), but because the kernel
+    ///  calculates in floating point they may differ by one
+    ///  unit.
+    ///
+    /// @param pIOMatrix     the 64 coefficients of the block.
+    ///                      They are replaced by the zero
+    ///                      centered pixel values
+    /// @param pScaleFactors the quantization table combined
+    ///                      with the AAN scale factors and
+    ///                      the final division by 8 (see
+    ///                      jpegInformation::
+    ///                      m_floatDecompressionQuantizationTable)
+    ///
+    ///////////////////////////////////////////////////////////
+    typedef void (*idct_t)(std::int32_t* pIOMatrix, const float* pScaleFactors);
+
+    /// \brief Forward DCT of a block of zero centered pixels.
+    ///
+    /// The results are identical to the ones returned by
+    ///  jpegImageCodec::FDCT().
+    ///
+    /// @param pIOMatrix       the 64 pixels of the block.
+    ///                        They are replaced by the
+    ///                        quantized coefficients
+    /// @param pDescaleFactors the quantization factors (see
+    ///                        jpegInformation::
+    ///                        m_compressionQuantizationTable)
+    ///
+    ///////////////////////////////////////////////////////////
+    typedef void (*fdct_t)(std::int32_t* pIOMatrix, const float* pDescaleFactors);
+
+    /// \brief Returns the kernels currently in use.
+    ///
+    /// @return the kernels currently in use
+    ///
+    ///////////////////////////////////////////////////////////
+    static const jpegDct& getJpegDct();
+
+    /// \brief Selects the kernels used by the jpeg codec.
+    ///
+    /// Throws JpegCodecError if the CPU doesn't support the
+    ///  requested kernels.
+    ///
+    /// @param dct the kernels to use. jpegDct_t::automatic
+    ///            selects the fastest kernels supported by
+    ///            the CPU
+    ///
+    ///////////////////////////////////////////////////////////
+    static void setJpegDct(jpegDct_t dct);
+
+    /// \brief The implementation of the kernels. Never
+    ///        jpegDct_t::automatic.
+    ///
+    ///////////////////////////////////////////////////////////
+    jpegDct_t m_type;
+
+    /// \brief The IDCT kernel, or nullptr when the portable
+    ///        implementation must be used.
+    ///
+    ///////////////////////////////////////////////////////////
+    idct_t m_pIDCT;
+
+    /// \brief The FDCT kernel, or nullptr when the portable
+    ///        implementation must be used.
+    ///
+    ///////////////////////////////////////////////////////////
+    fdct_t m_pFDCT;
+
+private:
+    jpegDct(jpegDct_t type, idct_t pIDCT, fdct_t pFDCT);
+
+    /// \brief Returns the kernels of the specified
+    ///        implementation, or nullptr if the CPU doesn't
+    ///        support them.
+    ///
+    ///////////////////////////////////////////////////////////
+    static const jpegDct* getSupportedJpegDct(jpegDct_t dct);
+
+    /// \brief Returns the pointer to the kernels currently
+    ///        in use.
+    ///
+    ///////////////////////////////////////////////////////////
+    static std::atomic<const jpegDct*>& getSelectedJpegDct();
+};
+
+/// @}
+
+} // namespace codecs
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraJpegDct_4A1C7E2B_93D5_4F08_B6E1_2C8D05F3A7E9__INCLUDED_)
@@ -21,11 +21,17 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "streamWriterImpl.h"
 #include "huffmanTableImpl.h"
 #include "jpegImageCodecImpl.h"
+#include "jpegDctImpl.h"
 #include "dataSetImpl.h"
 #include "imageImpl.h"
 #include "dataHandlerNumericImpl.h"
 #include "codecFactoryImpl.h"
+#include "memoryImpl.h"
+#include "memoryStreamImpl.h"
+#include "parallelTasksImpl.h"
 #include "../include/imebra/exceptions.h"
+#include <algorithm>
+#include <thread>
 #include <vector>
 #include <stdlib.h>
 #include <string.h>
@@ -65,6 +71,186 @@ static const std::uint32_t JpegDeZigZagOrder[]=
 };
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+//
+// The encoder stores each huffman value and its amplitude
+//  bits in a 32 bit symbol, so the scans are written
+//  without encoding the pixels again:
+//  - bits 0..15:  the amplitude bits
+//  - bits 16..23: the value to be huffman encoded
+//  - bits 24..28: the number of amplitude bits, or
+//                 jpegRestartSymbol for a RST marker (the
+//                 marker is stored in the amplitude bits)
+//  - bits 29..31: the huffman table: 2 * the position of
+//                 the channel in the scan, +1 for the AC
+//                 table
+//
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+static const std::uint32_t jpegRestartSymbol(0x1f);
+
+static inline std::uint32_t jpegSymbol(std::uint32_t table, std::uint32_t value, std::uint32_t amplitude, std::uint32_t amplitudeLength)
+{
+    return (table << 29) | (amplitudeLength << 24) | (value << 16) | (amplitude & 0xffff);
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+//
+// Level shift and clip the samples of a block returned
+//  by the IDCT, then store them into the destination
+//  image. The samples of subsampled channels are
+//  replicated; the samples that fall outside the image
+//  are discarded
+//
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+template<typename samplesType_t>
+static void storeLossyBlock(std::int32_t* pBlock, const jpeg::jpegChannel& channel, std::uint32_t blockX, std::uint32_t blockY)
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint32_t startCol(blockX * 8 * channel.m_samplesReplicateX);
+    const std::uint32_t startRow(blockY * 8 * channel.m_samplesReplicateY);
+    if(startCol >= channel.m_samplesImageWidth || startRow >= channel.m_samplesImageHeight)
+    {
+        return;
+    }
+    const std::uint32_t endCol(std::min(startCol + 8 * channel.m_samplesReplicateX, channel.m_samplesImageWidth));
+    const std::uint32_t endRow(std::min(startRow + 8 * channel.m_samplesReplicateY, channel.m_samplesImageHeight));
+
+    const std::int32_t offsetValue((channel.m_valuesMask >> 1) + 1);
+    const std::int32_t levelShift(channel.m_bSignedSamples ? 0 : offsetValue);
+    const std::int32_t minClipValue(channel.m_bSignedSamples ? -offsetValue : 0);
+    const std::int32_t maxClipValue(minClipValue + channel.m_valuesMask);
+    for(std::int32_t* pValue(pBlock), *pEndValue(pBlock + 64); pValue != pEndValue; ++pValue)
+    {
+        const std::int32_t value(*pValue + levelShift);
+        *pValue = value < minClipValue ? minClipValue : (value > maxClipValue ? maxClipValue : value);
+    }
+
+    const size_t rowSize((size_t)channel.m_samplesImageWidth * channel.m_samplesImageChannels);
+    samplesType_t* pRow(reinterpret_cast<samplesType_t*>(channel.m_pSamples) + startRow * rowSize + (size_t)startCol * channel.m_samplesImageChannels);
+    for(std::uint32_t row(startRow); row != endRow; ++row, pRow += rowSize)
+    {
+        const std::int32_t* pValue(pBlock + ((row - startRow) / channel.m_samplesReplicateY) * 8);
+        samplesType_t* pSample(pRow);
+        for(std::uint32_t col(startCol); col != endCol; ++pValue)
+        {
+            for(std::uint32_t replicate(channel.m_samplesReplicateX); replicate != 0 && col != endCol; --replicate, ++col, pSample += channel.m_samplesImageChannels)
+            {
+                *pSample = (samplesType_t)*pValue;
+            }
+        }
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+static void storeLossyBlock(std::int32_t* pBlock, const jpeg::jpegChannel& channel, std::uint32_t blockX, std::uint32_t blockY)
+{
+    IMEBRA_FUNCTION_START();
+
+    switch(channel.m_samplesDepth)
+    {
+    case bitDepth_t::depthU8:
+        storeLossyBlock<std::uint8_t>(pBlock, channel, blockX, blockY);
+        break;
+    case bitDepth_t::depthS8:
+        storeLossyBlock<std::int8_t>(pBlock, channel, blockX, blockY);
+        break;
+    case bitDepth_t::depthU16:
+        storeLossyBlock<std::uint16_t>(pBlock, channel, blockX, blockY);
+        break;
+    case bitDepth_t::depthS16:
+        storeLossyBlock<std::int16_t>(pBlock, channel, blockX, blockY);
+        break;
+    default:
+        IMEBRA_THROW(std::logic_error, "Wrong depth for the jpeg samples");
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+//
+// Read the samples of a channel from a rectangle of the
+//  source image (a block of a lossy channel or a row of a
+//  lossless one), clip them to the jpeg precision and
+//  level shift them
+//
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+static void loadEncoderSamples(
+        const handlers::readingDataHandlerNumericBase& sourceImage,
+        const jpeg::jpegInformation& information,
+        const jpeg::jpegChannel& channel,
+        std::int32_t* pDest,
+        std::uint32_t startCol,
+        std::uint32_t startRow,
+        std::uint32_t endCol,
+        std::uint32_t endRow)
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::uint32_t samplesCount(((endCol - startCol) / channel.m_samplesReplicateX) * ((endRow - startRow) / channel.m_samplesReplicateY));
+    ::memset(pDest, 0, samplesCount * sizeof(std::int32_t));
+
+    sourceImage.copyToInt32Interleaved(
+                pDest,
+                channel.m_samplesReplicateX, channel.m_samplesReplicateY,
+                startCol, startRow, endCol, endRow,
+                channel.m_sourceChannel,
+                channel.m_samplesImageWidth, channel.m_samplesImageHeight,
+                channel.m_samplesImageChannels);
+
+    const std::int32_t offsetValue((std::int32_t)1 << (information.m_precision - 1));
+    std::int32_t maxClipValue(((std::int32_t)1 << information.m_precision) - 1);
+    std::int32_t minClipValue(0);
+    if(channel.m_bSignedSamples)
+    {
+        maxClipValue -= offsetValue;
+        minClipValue -= offsetValue;
+    }
+    const std::int32_t levelShift(!information.m_bLossless && !channel.m_bSignedSamples ? offsetValue : 0);
+    const std::int32_t orValue((std::int32_t)((std::int32_t)-1 * ((std::int32_t)1 << information.m_precision)));
+
+    for(std::int32_t* const pEnd(pDest + samplesCount); pDest != pEnd; ++pDest)
+    {
+        std::int32_t value(std::min(std::max(*pDest, minClipValue), maxClipValue) - levelShift);
+        if((value & offsetValue) != 0)
+        {
+            value |= orValue;
+        }
+        *pDest = value;
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
 
 /////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////
@@ -335,8 +521,93 @@ std::shared_ptr<image> jpegImageCodec::getImage(const std::string& transferSynta
 {
     IMEBRA_FUNCTION_START();
 
+    jpeg::jpegInformation information;
+    return decodeImage(transferSyntax, colorSpace, b2Complement, pSourceStream, information);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+//
+//
+// Get a region of a jpeg image from a Dicom dataset
+//
+//
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+std::shared_ptr<image> jpegImageCodec::getImageRegion(const std::string& transferSyntax,
+                                                      const std::string& colorSpace,
+                                                      std::uint32_t /* channelsNumber */,
+                                                      std::uint32_t /* imageWidth */,
+                                                      std::uint32_t /* imageHeight */,
+                                                      bool /* bSubSampledX */,
+                                                      bool /* bSubSampledY */,
+                                                      bool /* bInterleaved */,
+                                                      bool b2Complement,
+                                                      std::uint8_t /* allocatedBits */,
+                                                      std::uint8_t /* storedBits */,
+                                                      std::uint8_t /* highBit */,
+                                                      std::shared_ptr<streamReader> pSourceStream,
+                                                      std::uint32_t regionLeft,
+                                                      std::uint32_t regionTop,
+                                                      std::uint32_t regionWidth,
+                                                      std::uint32_t regionHeight) const
+{
+    IMEBRA_FUNCTION_START();
+
+    jpeg::jpegInformation information;
+    information.setRegion(regionLeft, regionTop, regionWidth, regionHeight);
+    std::shared_ptr<image> pImage(decodeImage(transferSyntax, colorSpace, b2Complement, pSourceStream, information));
+
+    return copyImageRegion(pImage, regionLeft, regionTop, regionWidth, regionHeight);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+//
+//
+// Decode the jpeg image
+//
+//
+/////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////
+std::shared_ptr<image> jpegImageCodec::decodeImage(const std::string& transferSyntax,
+                                                   const std::string& colorSpace,
+                                                   bool b2Complement,
+                                                   std::shared_ptr<streamReader> pSourceStream,
+                                                   jpeg::jpegInformation& information) const
+{
+    IMEBRA_FUNCTION_START();
+
     jpegStreamReader jpegStream(pSourceStream);
 
+    // If the compression is jpeg baseline or jpeg extended
+    //  then the color space cannot be "RGB"
+    ///////////////////////////////////////////////////////////
+    const std::string imageColorSpace(
+                colorSpace == "RGB" && (transferSyntax == "1.2.840.10008.1.2.4.50" ||  // baseline (8 bits lossy)
+                                        transferSyntax == "1.2.840.10008.1.2.4.51") ?  // extended (12 bits lossy)
+                    "YBR_FULL" : colorSpace);
+
+    // The decoded image and the handler used to write its
+    //  samples. Allocated when the first MCU is decoded
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<image> pImage;
+    std::shared_ptr<handlers::writingDataHandlerNumericBase> pImageHandler;
+
+    // Threads used to decode the restart intervals
+    ///////////////////////////////////////////////////////////
+    size_t threadsCount(codecFactory::getCodecFactory()->getJpegDecodingThreads());
+    if(threadsCount == 0)
+    {
+        threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
     // Read the Jpeg signature
     ///////////////////////////////////////////////////////////
     std::uint8_t jpegSignature[2];
@@ -361,7 +632,6 @@ std::shared_ptr<image> jpegImageCodec::getImage(const std::string& transferSynta
 
     // Read until the end of the image is reached
     ///////////////////////////////////////////////////////////
-    jpeg::jpegInformation information;
     for(; !information.m_bEndOfImage; jpegStream.resetInBitsBuffer())
     {
         std::uint32_t nextMcuStop = information.m_mcuNumberTotal;
@@ -419,102 +689,483 @@ std::shared_ptr<image> jpegImageCodec::getImage(const std::string& transferSynta
 
         }
 
-        while(information.m_mcuProcessed < nextMcuStop && !pSourceStream->endReached())
+        // The samples are written directly into the image: it
+        //  can be allocated now that the SOF tag has been read
+        ///////////////////////////////////////////////////////////
+        if(pImage == nullptr || (!information.m_channelsMap.empty() && information.m_channelsMap.begin()->second->m_pSamples == nullptr))
+        {
+            pImageHandler.reset();
+            pImage = allocateImage(information, b2Complement, imageColorSpace, pImageHandler);
+        }
+
+        // Decode all the restart intervals of the scan in
+        //  parallel, if possible
+        ///////////////////////////////////////////////////////////
+        if(information.m_mcuProcessed == 0 && canReadRestartIntervals(information, threadsCount))
+        {
+            readRestartIntervals(*pSourceStream, information, threadsCount);
+            continue;
+        }
+
+        // The lossy MCUs outside the region are not needed:
+        //  skip the restart intervals that don't intersect it
+        //  and the scan's data that follows it
+        ///////////////////////////////////////////////////////////
+        if(!information.m_bLossless)
+        {
+            const std::uint32_t regionEndMcu(information.getRegionEndMcu());
+            if(information.m_mcuProcessed >= regionEndMcu)
+            {
+                information.m_mcuProcessed = information.m_mcuNumberTotal;
+                information.m_mcuProcessedY = information.m_mcuNumberY;
+                information.m_mcuProcessedX = 0;
+                skipEntropyData(*pSourceStream, true);
+                continue;
+            }
+
+            if(information.m_mcuPerRestartInterval != 0 &&
+                    information.m_mcuProcessed == information.m_mcuLastRestart &&
+                    !information.mcusInRegion(information.m_mcuProcessed, nextMcuStop))
+            {
+                information.m_mcuProcessed = nextMcuStop;
+                information.m_mcuProcessedY = nextMcuStop / information.m_mcuNumberX;
+                information.m_mcuProcessedX = nextMcuStop - information.m_mcuProcessedY * information.m_mcuNumberX;
+                skipEntropyData(*pSourceStream, false);
+                continue;
+            }
+
+            nextMcuStop = std::min(nextMcuStop, regionEndMcu);
+        }
+
+        readMcus(jpegStream, information, nextMcuStop);
+    }
+
+    if(pImage == nullptr)
+    {
+        pImage = allocateImage(information, b2Complement, imageColorSpace, pImageHandler);
+    }
+
+    // Process unprocessed lossless amplitudes
+    ///////////////////////////////////////////////////////////
+    for(jpeg::jpegInformation::tChannelsMap::iterator processLosslessIterator = information.m_channelsMap.begin();
+        processLosslessIterator != information.m_channelsMap.end();
+        ++processLosslessIterator)
+    {
+        processLosslessIterator->second->processUnprocessedAmplitudes();
+    }
+
+    pImageHandler.reset();
+
+    return pImage;
+
+    IMEBRA_FUNCTION_END_MODIFY(StreamEOFError, CodecCorruptedFileError);
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Skip the entropy coded data
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void jpegImageCodec::skipEntropyData(streamReader& sourceStream, bool bSkipRestartMarkers) const
+{
+    IMEBRA_FUNCTION_START();
+
+    for(;;)
+    {
+        size_t availableSize(0);
+        const std::uint8_t* pData(sourceStream.getBufferedData(2, &availableSize));
+        if(availableSize == 0)
+        {
+            return;
+        }
+
+        const std::uint8_t* pMarker(static_cast<const std::uint8_t*>(::memchr(pData, 0xff, availableSize)));
+        if(pMarker == nullptr)
+        {
+            sourceStream.skipBufferedData(availableSize);
+            continue;
+        }
+
+        // Load the byte that follows 0xff
+        ///////////////////////////////////////////////////////////
+        const size_t dataSize((size_t)(pMarker - pData));
+        if(dataSize + 1 == availableSize)
+        {
+            sourceStream.skipBufferedData(dataSize);
+            if(dataSize == 0)
+            {
+                return;
+            }
+            continue;
+        }
+
+        const std::uint8_t markerId(pMarker[1]);
+        if(markerId == 0 || (bSkipRestartMarkers && markerId >= 0xd0 && markerId <= 0xd7))
+        {
+            sourceStream.skipBufferedData(dataSize + 2);
+            continue;
+        }
+
+        // The marker is read by decodeImage()
+        ///////////////////////////////////////////////////////////
+        sourceStream.skipBufferedData(dataSize);
+        return;
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Read the MCUs of the active scan
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void jpegImageCodec::readMcus(jpegStreamReader& stream, jpeg::jpegInformation& information, std::uint32_t lastMcu) const
+{
+    IMEBRA_FUNCTION_START();
+
+    // Selected SIMD IDCT (or nullptr for the portable one)
+    ///////////////////////////////////////////////////////////
+    const jpegDct::idct_t pSimdIDCT(jpegDct::getJpegDct().m_pIDCT);
+
+    // A sequential scan carries all the coefficients of its
+    //  blocks: they are decoded into a temporary block and
+    //  the samples go straight into the image. The other
+    //  scans refine the coefficients kept by the channels
+    ///////////////////////////////////////////////////////////
+    const bool bSequentialScan(information.m_spectralIndexStart == 0 && information.m_spectralIndexEnd >= 63);
+    if(!information.m_bLossless && !bSequentialScan)
+    {
+        for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: information.m_channelsList)
+        {
+            if(pChannel->m_pCoefficients == nullptr)
+            {
+                pChannel->allocateCoefficients();
+            }
+        }
+    }
+    std::int32_t block[64];
+
+    while(information.m_mcuProcessed < lastMcu && !stream.endReached())
+    {
+        // Read an MCU
+        ///////////////////////////////////////////////////////////
+
+        // Scan all components
+        ///////////////////////////////////////////////////////////
+        for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: information.m_channelsList)
+        {
+            // Read a lossless pixel
+            ///////////////////////////////////////////////////////////
+            if(information.m_bLossless)
+            {
+                for(std::uint32_t
+                    scanBlock = 0;
+                    scanBlock != pChannel->m_blockMcuXY;
+                    ++scanBlock)
+                {
+                    std::uint32_t amplitudeLength = pChannel->m_pActiveHuffmanTableDC->readHuffmanCode(stream);
+                    std::int32_t amplitude;
+                    if(amplitudeLength == 16) // logically we should compare with information.m_precision, but DICOM says otherwise
+                    {
+                        amplitude = (std::int32_t)1 << 15;
+                    }
+                    else if(amplitudeLength != 0)
+                    {
+                        amplitude = (std::int32_t)stream.readBits(amplitudeLength);
+                        if(amplitude < ((std::int32_t)1<<(amplitudeLength-1)))
+                        {
+                            amplitude -= ((std::int32_t)1<<amplitudeLength)-1;
+                        }
+                    }
+                    else
+                    {
+                        amplitude = 0;
+                    }
+
+                    pChannel->addUnprocessedAmplitude(amplitude, information.m_spectralIndexStart, information.m_mcuLastRestart == information.m_mcuProcessed && scanBlock == 0);
+                }
+
+                continue;
+            }
+
+            // Read a lossy MCU
+            ///////////////////////////////////////////////////////////
+            const std::uint32_t blocksPerRow(pChannel->m_width >> 3);
+            const std::uint32_t firstBlockX(information.m_mcuProcessedX * pChannel->m_blockMcuX);
+            const std::uint32_t firstBlockY(information.m_mcuProcessedY * pChannel->m_blockMcuY);
+            const bool bTransform(information.m_spectralIndexEnd >= 63 && information.mcusInRegion(information.m_mcuProcessed, information.m_mcuProcessed + 1));
+            for(std::uint32_t blockY(firstBlockY); blockY != firstBlockY + pChannel->m_blockMcuY; ++blockY)
+            {
+                for(std::uint32_t blockX(firstBlockX); blockX != firstBlockX + pChannel->m_blockMcuX; ++blockX)
+                {
+                    if(bSequentialScan)
+                    {
+                        ::memset(block, 0, sizeof(block));
+                        readBlock(stream, information, block, pChannel);
+                    }
+                    else
+                    {
+                        std::int32_t* pCoefficients(pChannel->m_pCoefficients + ((size_t)blockY * blocksPerRow + blockX) * 64);
+                        readBlock(stream, information, pCoefficients, pChannel);
+                        if(bTransform)
+                        {
+                            ::memcpy(block, pCoefficients, sizeof(block));
+                        }
+                    }
+
+                    if(bTransform)
+                    {
+                        if(pSimdIDCT != nullptr)
+                        {
+                            pSimdIDCT(
+                                        block,
+                                        information.m_floatDecompressionQuantizationTable[pChannel->m_quantTable]
+                                    );
+                        }
+                        else
+                        {
+                            IDCT(
+                                        block,
+                                        information.m_decompressionQuantizationTable[pChannel->m_quantTable]
+                                    );
+                        }
+                        storeLossyBlock(block, *pChannel, blockX, blockY);
+                    }
+                }
+            }
+        }
+
+        ++information.m_mcuProcessed;
+        if(++information.m_mcuProcessedX == information.m_mcuNumberX)
+        {
+            information.m_mcuProcessedX = 0;
+            ++information.m_mcuProcessedY;
+        }
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Check if the restart intervals of the active scan can
+//  be decoded in parallel
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+bool jpegImageCodec::canReadRestartIntervals(const jpeg::jpegInformation& information, size_t threadsCount) const
+{
+    if(threadsCount < 2 ||
+            information.m_mcuPerRestartInterval == 0 ||
+            information.m_mcuPerRestartInterval >= information.m_mcuNumberTotal)
+    {
+        return false;
+    }
+
+    // Each restart interval of a lossless scan must start
+    //  on a new line, so it doesn't need the pixels decoded
+    //  by the previous interval
+    ///////////////////////////////////////////////////////////
+    if(information.m_bLossless)
+    {
+        for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: information.m_channelsList)
+        {
+            if(pChannel->m_blockMcuXY != 1)
+            {
+                return false;
+            }
+        }
+        return information.m_mcuPerRestartInterval % information.m_mcuNumberX == 0;
+    }
+
+    // Progressive scans refine the data decoded by the
+    //  previous scans: decode them sequentially
+    ///////////////////////////////////////////////////////////
+    return information.m_spectralIndexStart == 0 && information.m_spectralIndexEnd >= 63;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Split the active scan into its restart intervals and
+//  decode them in parallel
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void jpegImageCodec::readRestartIntervals(streamReader& sourceStream, jpeg::jpegInformation& information, size_t threadsCount) const
+{
+    IMEBRA_FUNCTION_START();
+
+    // Collect the entropy coded data of each interval, up to
+    //  the first marker that is not a RST marker.
+    // The stuffed bytes are left in place: jpegStreamReader
+    //  removes them
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<std::vector<std::uint8_t> > pEntropyData(std::make_shared<std::vector<std::uint8_t> >());
+    std::vector<size_t> intervalsOffsets(1, 0);
+    std::vector<std::uint32_t> intervalsNumbers(1, 0);
+    for(;;)
+    {
+        size_t availableSize(0);
+        const std::uint8_t* pData(sourceStream.getBufferedData(2, &availableSize));
+        if(availableSize == 0)
+        {
+            break;
+        }
+
+        const std::uint8_t* pMarker(static_cast<const std::uint8_t*>(::memchr(pData, 0xff, availableSize)));
+        if(pMarker == nullptr)
+        {
+            pEntropyData->insert(pEntropyData->end(), pData, pData + availableSize);
+            sourceStream.skipBufferedData(availableSize);
+            continue;
+        }
+
+        const size_t dataSize((size_t)(pMarker - pData));
+        pEntropyData->insert(pEntropyData->end(), pData, pMarker);
+
+        // Load the byte that follows 0xff
+        ///////////////////////////////////////////////////////////
+        if(dataSize + 1 == availableSize)
+        {
+            sourceStream.skipBufferedData(dataSize);
+            if(dataSize == 0)
+            {
+                break;
+            }
+            continue;
+        }
+
+        const std::uint8_t markerId(pMarker[1]);
+        if(markerId == 0)
+        {
+            pEntropyData->push_back(0xff);
+            pEntropyData->push_back(0);
+            sourceStream.skipBufferedData(dataSize + 2);
+            continue;
+        }
+        if(markerId == 0xff)
+        {
+            // Fill byte
+            ///////////////////////////////////////////////////////////
+            sourceStream.skipBufferedData(dataSize + 1);
+            continue;
+        }
+        if(markerId >= 0xd0 && markerId <= 0xd7)
+        {
+            sourceStream.skipBufferedData(dataSize + 2);
+
+            // RSTn precedes the intervals 8k + n + 1: take the next
+            //  one (like tagRST::readTag(), this skips the missing
+            //  ones)
+            ///////////////////////////////////////////////////////////
+            std::uint32_t intervalNumber(intervalsNumbers.back() + 1);
+            while(((intervalNumber - 1) & 0x7) != (std::uint32_t)(markerId & 0x7))
+            {
+                ++intervalNumber;
+            }
+            intervalsOffsets.push_back(pEntropyData->size());
+            intervalsNumbers.push_back(intervalNumber);
+            continue;
+        }
+
+        // Any other marker ends the scan: it is read by
+        //  getImage()
+        ///////////////////////////////////////////////////////////
+        sourceStream.skipBufferedData(dataSize);
+        break;
+    }
+    intervalsOffsets.push_back(pEntropyData->size());
+
+    // Each thread decodes the intervals using its own copy
+    //  of the decoding state. The decoded MCUs are written
+    //  directly into the channels' buffers
+    ///////////////////////////////////////////////////////////
+    runParallelWorkers(intervalsNumbers.size(), threadsCount, [this, &information, &pEntropyData, &intervalsOffsets, &intervalsNumbers]() -> std::function<void(size_t)>
+    {
+        std::shared_ptr<jpeg::jpegInformation> pThreadInformation(std::make_shared<jpeg::jpegInformation>(information));
+        pThreadInformation->m_channelsList.clear();
+        for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: information.m_channelsList)
+        {
+            pThreadInformation->m_channelsList.push_back(std::make_shared<jpeg::jpegChannel>(*pChannel));
+        }
+
+        return [this, &information, &pEntropyData, &intervalsOffsets, &intervalsNumbers, pThreadInformation](size_t interval)
         {
-            // Read an MCU
-            ///////////////////////////////////////////////////////////
+            jpeg::jpegInformation& threadInformation(*pThreadInformation);
 
-            // Scan all components
-            ///////////////////////////////////////////////////////////
-            for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: information.m_channelsList)
+            const std::uint32_t firstMcu(intervalsNumbers[interval] * information.m_mcuPerRestartInterval);
+            if(firstMcu >= information.m_mcuNumberTotal)
             {
-                // Read a lossless pixel
-                ///////////////////////////////////////////////////////////
-                if(information.m_bLossless)
-                {
-                    for(std::uint32_t
-                        scanBlock = 0;
-                        scanBlock != pChannel->m_blockMcuXY;
-                        ++scanBlock)
-                    {
-                        std::uint32_t amplitudeLength = pChannel->m_pActiveHuffmanTableDC->readHuffmanCode(jpegStream);
-                        std::int32_t amplitude;
-                        if(amplitudeLength == 16) // logically we should compare with information.m_precision, but DICOM says otherwise
-                        {
-                            amplitude = (std::int32_t)1 << 15;
-                        }
-                        else if(amplitudeLength != 0)
-                        {
-                            amplitude = (std::int32_t)jpegStream.readBits(amplitudeLength);
-                            if(amplitude < ((std::int32_t)1<<(amplitudeLength-1)))
-                            {
-                                amplitude -= ((std::int32_t)1<<amplitudeLength)-1;
-                            }
-                        }
-                        else
-                        {
-                            amplitude = 0;
-                        }
-
-                        pChannel->addUnprocessedAmplitude(amplitude, information.m_spectralIndexStart, information.m_mcuLastRestart == information.m_mcuProcessed && scanBlock == 0);
-                    }
-
-                    continue;
-                }
-
-                // Read a lossy MCU
-                ///////////////////////////////////////////////////////////
-                std::uint32_t bufferPointer = (information.m_mcuProcessedY * pChannel->m_blockMcuY * ((information.m_jpegImageWidth * pChannel->m_samplingFactorX / information.m_maxSamplingFactorX) >> 3) + information.m_mcuProcessedX * pChannel->m_blockMcuX) * 64;
-                for(std::uint32_t scanBlockY = pChannel->m_blockMcuY; (scanBlockY != 0); --scanBlockY)
-                {
-                    for(std::uint32_t scanBlockX = pChannel->m_blockMcuX; scanBlockX != 0; --scanBlockX)
-                    {
-                        readBlock(jpegStream, information, &(pChannel->m_pBuffer[bufferPointer]), pChannel);
+                return;
+            }
 
-                        if(information.m_spectralIndexEnd >= 63)
-                        {
-                            IDCT(
-                                        &(pChannel->m_pBuffer[bufferPointer]),
-                                        information.m_decompressionQuantizationTable[pChannel->m_quantTable]
-                                    );
-                        }
-                        bufferPointer += 64;
-                    }
-                    bufferPointer += (information.m_mcuNumberX -1) * pChannel->m_blockMcuX * 64;
-                }
+            // The intervals are independent: the ones outside
+            //  the region are not needed
+            ///////////////////////////////////////////////////////////
+            if(!information.mcusInRegion(firstMcu, std::min(firstMcu + information.m_mcuPerRestartInterval, information.m_mcuNumberTotal)))
+            {
+                return;
             }
 
-            ++information.m_mcuProcessed;
-            if(++information.m_mcuProcessedX == information.m_mcuNumberX)
+            // Reset the state, as after a RST marker
+            ///////////////////////////////////////////////////////////
+            threadInformation.m_mcuProcessed = firstMcu;
+            threadInformation.m_mcuProcessedY = firstMcu / information.m_mcuNumberX;
+            threadInformation.m_mcuProcessedX = firstMcu - threadInformation.m_mcuProcessedY * information.m_mcuNumberX;
+            threadInformation.m_mcuLastRestart = firstMcu;
+            threadInformation.m_eobRun = 0;
+            for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: threadInformation.m_channelsList)
             {
-                information.m_mcuProcessedX = 0;
-                ++information.m_mcuProcessedY;
+                pChannel->m_lastDCValue = pChannel->m_defaultDCValue;
+                pChannel->m_unprocessedAmplitudesCount = 0;
+                pChannel->m_losslessPositionX = threadInformation.m_mcuProcessedX / pChannel->m_blockMcuX;
+                pChannel->m_losslessPositionY = threadInformation.m_mcuProcessedY / pChannel->m_blockMcuY;
+                pChannel->m_losslessFirstLineY = pChannel->m_losslessPositionY;
             }
-        }
-    }
 
-    // Process unprocessed lossless amplitudes
-    ///////////////////////////////////////////////////////////
-    for(jpeg::jpegInformation::tChannelsMap::iterator processLosslessIterator = information.m_channelsMap.begin();
-        processLosslessIterator != information.m_channelsMap.end();
-        ++processLosslessIterator)
-    {
-        processLosslessIterator->second->processUnprocessedAmplitudes();
-    }
+            std::shared_ptr<memory> pIntervalData(
+                        std::make_shared<memory>(
+                            pEntropyData,
+                            pEntropyData->data() + intervalsOffsets[interval],
+                            intervalsOffsets[interval + 1] - intervalsOffsets[interval]));
+            jpegStreamReader intervalStream(std::make_shared<streamReader>(std::make_shared<memoryStreamInput>(pIntervalData)));
 
+            readMcus(intervalStream, threadInformation, std::min(firstMcu + information.m_mcuPerRestartInterval, information.m_mcuNumberTotal));
 
-    // If the compression is jpeg baseline or jpeg extended
-    //  then the color space cannot be "RGB"
-    ///////////////////////////////////////////////////////////
-    if(colorSpace == "RGB" && (transferSyntax == "1.2.840.10008.1.2.4.50" ||  // baseline (8 bits lossy)
-                transferSyntax == "1.2.840.10008.1.2.4.51"))    // extended (12 bits lossy)
-    {
-        return copyJpegChannelsToImage(information, b2Complement, "YBR_FULL");
-    }
+            for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: threadInformation.m_channelsList)
+            {
+                pChannel->processUnprocessedAmplitudes();
+            }
+        };
+    });
 
-    return copyJpegChannelsToImage(information, b2Complement, colorSpace);
+    // The whole scan has been decoded
+    ///////////////////////////////////////////////////////////
+    information.m_mcuProcessed = information.m_mcuNumberTotal;
+    information.m_mcuProcessedY = information.m_mcuNumberTotal / information.m_mcuNumberX;
+    information.m_mcuProcessedX = information.m_mcuNumberTotal - information.m_mcuProcessedY * information.m_mcuNumberX;
+    information.m_mcuLastRestart = ((information.m_mcuNumberTotal - 1) / information.m_mcuPerRestartInterval) * information.m_mcuPerRestartInterval;
 
-    IMEBRA_FUNCTION_END_MODIFY(StreamEOFError, CodecCorruptedFileError);
+    IMEBRA_FUNCTION_END();
 }
 
 
@@ -537,15 +1188,16 @@ bool jpegImageCodec::defaultInterleaved() const
 ///////////////////////////////////////////////////////////
 //
 //
-// Copy the loaded image into a class image
+// Allocate the image that receives the decoded samples
 //
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-std::shared_ptr<image> jpegImageCodec::copyJpegChannelsToImage(
+std::shared_ptr<image> jpegImageCodec::allocateImage(
         jpeg::jpegInformation& information,
         bool b2complement,
-        const std::string& colorSpace) const
+        const std::string& colorSpace,
+        std::shared_ptr<handlers::writingDataHandlerNumericBase>& pImageHandler) const
 {
     IMEBRA_FUNCTION_START();
 
@@ -557,122 +1209,31 @@ std::shared_ptr<image> jpegImageCodec::copyJpegChannelsToImage(
 
     std::shared_ptr<image> destImage(std::make_shared<image>(information.m_imageWidth, information.m_imageHeight, depth, colorSpace, (std::uint8_t)(information.m_precision-1)));
 
-    std::shared_ptr<handlers::writingDataHandlerNumericBase> handler = destImage->getWritingDataHandler();
-
-    std::int32_t offsetValue=(std::int32_t)1 << (information.m_precision-1);
-    std::int32_t maxClipValue=((std::int32_t)1 << information.m_precision)-1;
-    std::int32_t minClipValue = 0;
-    if(b2complement)
+    const std::uint32_t imageChannels(destImage->getChannelsNumber());
+    if(information.m_channelsMap.size() > imageChannels)
     {
-        maxClipValue-=offsetValue;
-        minClipValue-=offsetValue;
+        IMEBRA_THROW(CodecCorruptedFileError, "The jpeg image contains more channels than the color space " << colorSpace);
     }
 
-    // Copy the jpeg channels into the new image
+    pImageHandler = destImage->getWritingDataHandler();
+
+    // Each channel writes its samples directly into the
+    //  image's interleaved buffer
     ///////////////////////////////////////////////////////////
-    std::uint32_t destChannelNumber = 0;
-    for(jpeg::jpegInformation::tChannelsMap::const_iterator copyChannelsIterator = information.m_channelsMap.begin();
-        copyChannelsIterator != information.m_channelsMap.end();
-        ++copyChannelsIterator)
+    std::uint8_t* pSamples(pImageHandler->getMemoryBuffer());
+    for(jpeg::jpegInformation::tChannelsMap::const_iterator channelsIterator = information.m_channelsMap.begin();
+        channelsIterator != information.m_channelsMap.end();
+        ++channelsIterator, pSamples += pImageHandler->getUnitSize())
     {
-        std::shared_ptr<jpeg::jpegChannel> pChannel = copyChannelsIterator->second;
-
-        // Adjust 2complement
-        ///////////////////////////////////////////////////////////
-        std::int32_t* pChannelBuffer = pChannel->m_pBuffer;
-        if(!information.m_bLossless && !b2complement)
-        {
-            for(std::uint32_t adjust2complement = pChannel->m_bufferSize; adjust2complement != 0; --adjust2complement, ++pChannelBuffer)
-            {
-                *pChannelBuffer += offsetValue;
-                if(*pChannelBuffer < minClipValue)
-                {
-                    *pChannelBuffer = minClipValue;
-                }
-                else if(*pChannelBuffer > maxClipValue)
-                {
-                    *pChannelBuffer = maxClipValue;
-                }
-            }
-        }
-        else if(information.m_bLossless && b2complement)
-        {
-            for(std::uint32_t adjust2complement = pChannel->m_bufferSize; adjust2complement; --adjust2complement)
-            {
-                if(*pChannelBuffer & offsetValue)
-                {
-                    *pChannelBuffer |= (std::int32_t)((std::int32_t)-1 * ((std::int32_t)1 << information.m_precision));
-                }
-                if(*pChannelBuffer < minClipValue)
-                {
-                    *pChannelBuffer = minClipValue;
-                }
-                else if(*pChannelBuffer > maxClipValue)
-                {
-                    *pChannelBuffer = maxClipValue;
-                }
-                ++pChannelBuffer;
-            }
-        }
-
-        // If only one channel is present, then use the fast copy
-        ///////////////////////////////////////////////////////////
-        if(information.m_bLossless && information.m_channelsMap.size() == 1)
-        {
-            handler->copyFrom(pChannel->m_pBuffer, pChannel->m_bufferSize);
-            return destImage;
-        }
-
-        // Lossless interleaved
-        ///////////////////////////////////////////////////////////
-        std::uint32_t runX = information.m_maxSamplingFactorX / pChannel->m_samplingFactorX;
-        std::uint32_t runY = information.m_maxSamplingFactorY / pChannel->m_samplingFactorY;
-        if(information.m_bLossless)
-        {
-            handler->copyFromInt32Interleaved(
-                        pChannel->m_pBuffer,
-                        runX, runY,
-                        0, 0, pChannel->m_width * runX, pChannel->m_height * runY,
-                        destChannelNumber++,
-                        information.m_imageWidth, information.m_imageHeight,
-                        (std::uint32_t)information.m_channelsMap.size());
-
-            continue;
-        }
-
-        // Lossy interleaved
-        ///////////////////////////////////////////////////////////
-        std::uint32_t totalBlocksY(pChannel->m_height >> 3);
-        std::uint32_t totalBlocksX(pChannel->m_width >> 3);
-
-        std::int32_t* pSourceBuffer(pChannel->m_pBuffer);
-
-        std::uint32_t startRow(0);
-        for(std::uint32_t scanBlockY = 0; scanBlockY < totalBlocksY; ++scanBlockY)
-        {
-            std::uint32_t startCol(0);
-            std::uint32_t endRow(startRow + (runY << 3));
-
-            for(std::uint32_t scanBlockX = 0; scanBlockX < totalBlocksX; ++scanBlockX)
-            {
-                std::uint32_t endCol = startCol + (runX << 3);
-                handler->copyFromInt32Interleaved(
-                            pSourceBuffer,
-                            runX, runY,
-                            startCol,
-                            startRow,
-                            endCol,
-                            endRow,
-                            destChannelNumber,
-                            information.m_imageWidth, information.m_imageHeight,
-                            (std::uint32_t)information.m_channelsMap.size());
-
-                pSourceBuffer += 64;
-                startCol = endCol;
-            }
-            startRow = endRow;
-        }
-        ++destChannelNumber;
+        jpeg::jpegChannel& channel(*(channelsIterator->second));
+        channel.m_pSamples = pSamples;
+        channel.m_samplesDepth = depth;
+        channel.m_bSignedSamples = b2complement;
+        channel.m_samplesImageWidth = information.m_imageWidth;
+        channel.m_samplesImageHeight = information.m_imageHeight;
+        channel.m_samplesImageChannels = imageChannels;
+        channel.m_samplesReplicateX = information.m_maxSamplingFactorX / channel.m_samplingFactorX;
+        channel.m_samplesReplicateY = information.m_maxSamplingFactorY / channel.m_samplingFactorY;
     }
 
     return destImage;
@@ -685,12 +1246,12 @@ std::shared_ptr<image> jpegImageCodec::copyJpegChannelsToImage(
 ////////////////////////////////////////////////////////////////
 //
 //
-// Copy an image into the internal channels
+// Create the channels that encode an image
 //
 //
 ////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////
-void jpegImageCodec::copyImageToJpegChannels(
+void jpegImageCodec::createJpegChannels(
         jpeg::jpegInformation& information,
         std::shared_ptr<const image> sourceImage,
         bool b2complement,
@@ -707,7 +1268,6 @@ void jpegImageCodec::copyImageToJpegChannels(
     // Create the channels
     ////////////////////////////////////////////////////////////////
     std::uint32_t channelsNumber(sourceImage->getChannelsNumber());
-    std::shared_ptr<handlers::readingDataHandlerNumericBase>imageDataHandler = sourceImage->getReadingDataHandler();
 
     for(std::uint8_t channelId = 0; channelId < (std::uint8_t)channelsNumber; ++channelId)
     {
@@ -743,128 +1303,21 @@ void jpegImageCodec::copyImageToJpegChannels(
     }
     information.allocChannels();
 
-    std::int32_t offsetValue=(std::int32_t)1 << (information.m_precision-1);
-    std::int32_t maxClipValue=((std::int32_t)1 << information.m_precision)-1;
-    std::int32_t minClipValue = 0;
-    if(b2complement)
-    {
-        maxClipValue-=offsetValue;
-        minClipValue-=offsetValue;
-    }
-
-    // Copy the image into the jpeg channels
+    // Describe the source image to the channels
     ///////////////////////////////////////////////////////////
-    std::uint32_t sourceChannelNumber = 0;
-    for(jpeg::jpegInformation::tChannelsMap::iterator copyChannelsIterator = information.m_channelsMap.begin();
-        copyChannelsIterator != information.m_channelsMap.end();
-        ++copyChannelsIterator)
-    {
-        std::shared_ptr<jpeg::jpegChannel> pChannel = copyChannelsIterator->second;
-
-        // If only one channel is present, then use the fast copy
-        ///////////////////////////////////////////////////////////
-        if(information.m_bLossless && information.m_channelsMap.size() == 1)
-        {
-            imageDataHandler->copyTo(pChannel->m_pBuffer, pChannel->m_bufferSize);
-            continue;
-        }
-
-        // Lossless interleaved
-        ///////////////////////////////////////////////////////////
-        std::uint32_t runX = information.m_maxSamplingFactorX / pChannel->m_samplingFactorX;
-        std::uint32_t runY = information.m_maxSamplingFactorY / pChannel->m_samplingFactorY;
-        if(information.m_bLossless)
-        {
-            imageDataHandler->copyToInt32Interleaved(
-                        pChannel->m_pBuffer,
-                        runX, runY,
-                        0, 0, pChannel->m_width * runX, pChannel->m_height * runY,
-                        sourceChannelNumber++,
-                        information.m_imageWidth, information.m_imageHeight,
-                        (std::uint32_t)information.m_channelsMap.size());
-
-            continue;
-        }
-
-        // Lossy interleaved
-        ///////////////////////////////////////////////////////////
-        std::uint32_t totalBlocksY = (pChannel->m_height >> 3);
-        std::uint32_t totalBlocksX = (pChannel->m_width >> 3);
-
-        std::int32_t* pDestBuffer = pChannel->m_pBuffer;
-
-        std::uint32_t startRow = 0;
-        for(std::uint32_t scanBlockY = 0; scanBlockY < totalBlocksY; ++scanBlockY)
-        {
-            std::uint32_t startCol = 0;
-            std::uint32_t endRow = startRow + (runY << 3);
-
-            for(std::uint32_t scanBlockX = 0; scanBlockX < totalBlocksX; ++scanBlockX)
-            {
-                std::uint32_t endCol = startCol + (runX << 3);
-                imageDataHandler->copyToInt32Interleaved(
-                            pDestBuffer,
-                            runX, runY,
-                            startCol,
-                            startRow,
-                            endCol,
-                            endRow,
-                            sourceChannelNumber,
-                            information.m_imageWidth, information.m_imageHeight,
-                            (std::uint32_t)information.m_channelsMap.size());
-
-                pDestBuffer += 64;
-                startCol = endCol;
-            }
-            startRow = endRow;
-        }
-        ++sourceChannelNumber;
-    }
-
-
-    for(jpeg::jpegInformation::tChannelsMap::iterator clipChannelsIterator = information.m_channelsMap.begin();
-        clipChannelsIterator != information.m_channelsMap.end();
-        ++clipChannelsIterator)
+    std::uint32_t sourceChannelNumber(0);
+    for(jpeg::jpegInformation::tChannelsMap::iterator describeChannelsIterator = information.m_channelsMap.begin();
+        describeChannelsIterator != information.m_channelsMap.end();
+        ++describeChannelsIterator)
     {
-        std::shared_ptr<jpeg::jpegChannel> pChannel = clipChannelsIterator->second;
-
-        // Clip the values
-        ///////////////////////////////////////////////////////////
-        std::int32_t* pChannelBuffer = pChannel->m_pBuffer;
-        for(std::uint32_t clipValues = pChannel->m_bufferSize; clipValues; --clipValues)
-        {
-            if(*pChannelBuffer < minClipValue)
-            {
-                *pChannelBuffer = minClipValue;
-            }
-            if(*pChannelBuffer > maxClipValue)
-            {
-                *pChannelBuffer = maxClipValue;
-            }
-            ++pChannelBuffer;
-        }
-
-        // Adjust 2complement
-        ///////////////////////////////////////////////////////////
-        if(!information.m_bLossless && !b2complement)
-        {
-            pChannelBuffer = pChannel->m_pBuffer;
-            for(std::uint32_t adjust2complement = pChannel->m_bufferSize; adjust2complement; --adjust2complement)
-            {
-                *(pChannelBuffer++) -= offsetValue;
-            }
-        }
-
-        pChannelBuffer = pChannel->m_pBuffer;
-        std::int32_t orValue   = (std::int32_t)((std::int32_t)-1 * ((std::int32_t)1 << information.m_precision));
-        for(std::uint32_t adjustHighBits = pChannel->m_bufferSize; adjustHighBits != 0; --adjustHighBits)
-        {
-            if((*pChannelBuffer & offsetValue) != 0)
-            {
-                *pChannelBuffer |= orValue;
-            }
-            ++pChannelBuffer;
-        }
+        jpeg::jpegChannel& channel(*(describeChannelsIterator->second));
+        channel.m_sourceChannel = sourceChannelNumber++;
+        channel.m_bSignedSamples = b2complement;
+        channel.m_samplesImageWidth = information.m_imageWidth;
+        channel.m_samplesImageHeight = information.m_imageHeight;
+        channel.m_samplesImageChannels = channelsNumber;
+        channel.m_samplesReplicateX = information.m_maxSamplingFactorX / channel.m_samplingFactorX;
+        channel.m_samplesReplicateY = information.m_maxSamplingFactorY / channel.m_samplingFactorY;
     }
 
     IMEBRA_FUNCTION_END();
@@ -907,7 +1360,8 @@ void jpegImageCodec::setImage(
     information.m_bLossless = transferSyntax == "1.2.840.10008.1.2.4.57" ||  // lossless NH
             transferSyntax == "1.2.840.10008.1.2.4.70";    // lossless NH first order prediction
 
-    copyImageToJpegChannels(information, pImage, b2Complement, allocatedBits, bSubSampledX, bSubSampledY);
+    createJpegChannels(information, pImage, b2Complement, allocatedBits, bSubSampledX, bSubSampledY);
+    std::shared_ptr<handlers::readingDataHandlerNumericBase> pImageHandler(pImage->getReadingDataHandler());
 
     // Now write the jpeg stream
     ////////////////////////////////////////////////////////////////
@@ -922,39 +1376,64 @@ void jpegImageCodec::setImage(
     ////////////////////////////////////////////////////////////////
     writeTag(pDestinationStream, dqt, information);
 
-    for(int phase = 0; phase < 2; ++phase)
+    // Collect the channels of each scan
+    ////////////////////////////////////////////////////////////////
+    std::vector<std::list<jpeg::jpegInformation::ptrChannel> > scansChannels;
+    for(jpeg::jpegInformation::tChannelsMap::iterator channelsIterator = information.m_channelsMap.begin();
+        channelsIterator != information.m_channelsMap.end();
+        ++channelsIterator)
     {
-        if(phase == 1)
+        if(!bInterleaved || scansChannels.empty())
         {
-            // Write the huffman tables
-            ////////////////////////////////////////////////////////////////
-            writeTag(pDestinationStream, dht, information);
+            scansChannels.emplace_back();
         }
+        scansChannels.back().push_back(channelsIterator->second);
+    }
 
-        // Write the scans
+    // The typical huffman tables can encode all the values of
+    //  8 bit lossy images and of lossless images up to 11 bits:
+    //  each scan is written as soon as it has been encoded
+    ////////////////////////////////////////////////////////////////
+    if(codecFactory::getCodecFactory()->getJpegStandardHuffmanTables() &&
+            information.m_precision <= (information.m_bLossless ? 11u : 8u))
+    {
+        information.setStandardHuffmanTables();
+
+        // Write the huffman tables
         ////////////////////////////////////////////////////////////////
-        information.m_channelsList.clear();
+        writeTag(pDestinationStream, dht, information);
 
-        if(bInterleaved)
+        std::vector<std::uint32_t> symbols;
+        for(const std::list<jpeg::jpegInformation::ptrChannel>& scanChannels: scansChannels)
         {
-            for(jpeg::jpegInformation::tChannelsMap::iterator channelsIterator = information.m_channelsMap.begin();
-                channelsIterator != information.m_channelsMap.end();
-                ++channelsIterator)
-            {
-                information.m_channelsList.push_back(channelsIterator->second);
-            }
-            writeScan(pDestinationStream, information, phase == 0);
+            information.m_channelsList = scanChannels;
+            encodeScan(information, *pImageHandler, symbols);
+            writeScan(pDestinationStream, information, symbols);
         }
-        else
+    }
+    else
+    {
+        // Encode all the scans and collect the huffman values'
+        //  frequencies
+        ////////////////////////////////////////////////////////////////
+        std::vector<std::vector<std::uint32_t> > scansSymbols(scansChannels.size());
+        for(size_t scan(0); scan != scansChannels.size(); ++scan)
         {
-            for(jpeg::jpegInformation::tChannelsMap::iterator channelsIterator = information.m_channelsMap.begin();
-                channelsIterator != information.m_channelsMap.end();
-                ++channelsIterator)
-            {
-                information.m_channelsList.clear();
-                information.m_channelsList.push_back(channelsIterator->second);
-                writeScan(pDestinationStream, information, phase == 0);
-            }
+            information.m_channelsList = scansChannels[scan];
+            encodeScan(information, *pImageHandler, scansSymbols[scan]);
+        }
+
+        // Write the huffman tables
+        ////////////////////////////////////////////////////////////////
+        writeTag(pDestinationStream, dht, information);
+
+        // Write the encoded scans
+        ////////////////////////////////////////////////////////////////
+        for(size_t scan(0); scan != scansChannels.size(); ++scan)
+        {
+            information.m_channelsList = scansChannels[scan];
+            writeScan(pDestinationStream, information, scansSymbols[scan]);
+            std::vector<std::uint32_t>().swap(scansSymbols[scan]);
         }
     }
 
@@ -968,15 +1447,23 @@ void jpegImageCodec::setImage(
 ///////////////////////////////////////////////////////////
 //
 //
-// Write a single scan (SOS tag + channels)
+// Prepare the information for the active scan
 //
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-void jpegImageCodec::writeScan(streamWriter* pDestinationStream, jpeg::jpegInformation& information, bool bCalcHuffman) const
+void jpegImageCodec::startScan(jpeg::jpegInformation& information) const
 {
     IMEBRA_FUNCTION_START();
 
+    // The huffman table of each symbol is identified by its
+    //  channel's position in the scan
+    ///////////////////////////////////////////////////////////
+    if(information.m_channelsList.size() > 4)
+    {
+        IMEBRA_THROW(CodecWrongFormatError, "A jpeg scan cannot contain more than 4 channels");
+    }
+
     information.findMcuSize();
 
     if(information.m_bLossless)
@@ -984,35 +1471,108 @@ void jpegImageCodec::writeScan(streamWriter* pDestinationStream, jpeg::jpegInfor
         information.m_spectralIndexStart = 1;
         information.m_spectralIndexEnd = 0;
     }
-    if(!bCalcHuffman)
+
+    // Restart intervals made of whole MCU rows
+    ///////////////////////////////////////////////////////////
+    std::uint32_t restartRows(codecFactory::getCodecFactory()->getJpegRestartRows());
+    if(restartRows != 0)
+    {
+        restartRows = std::min(restartRows, information.m_mcuNumberY);
+        restartRows = std::max(std::min(restartRows, (std::uint32_t)0xffff / information.m_mcuNumberX), (std::uint32_t)1);
+        information.m_mcuPerRestartInterval = (std::uint16_t)std::min(restartRows * information.m_mcuNumberX, (std::uint32_t)0xffff);
+    }
+    else
     {
-        writeTag(pDestinationStream, sos, information);
+        information.m_mcuPerRestartInterval = 0;
     }
 
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Encode the MCUs of a single scan into a list of symbols
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void jpegImageCodec::encodeScan(jpeg::jpegInformation& information, const handlers::readingDataHandlerNumericBase& sourceImage, std::vector<std::uint32_t>& symbols) const
+{
+    IMEBRA_FUNCTION_START();
+
+    startScan(information);
+
+    symbols.clear();
+
+    const bool bCalcHuffman(!information.m_bStandardHuffmanTables);
+
     while(information.m_mcuProcessed < information.m_mcuNumberTotal)
     {
-        // Write an MCU
+        // Start a new restart interval
+        ///////////////////////////////////////////////////////////
+        const bool bRestart(
+                    information.m_mcuPerRestartInterval != 0 &&
+                    information.m_mcuProcessed != 0 &&
+                    information.m_mcuProcessed % information.m_mcuPerRestartInterval == 0);
+        if(bRestart)
+        {
+            symbols.push_back(jpegSymbol(0, 0, 0xd0 + ((information.m_mcuProcessed / information.m_mcuPerRestartInterval - 1) & 0x7), jpegRestartSymbol));
+            for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: information.m_channelsList)
+            {
+                pChannel->m_lastDCValue = pChannel->m_defaultDCValue;
+            }
+        }
+
+        // Encode an MCU
         ///////////////////////////////////////////////////////////
 
         // Scan all components
         ///////////////////////////////////////////////////////////
+        std::uint32_t channelTables(0);
         for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: information.m_channelsList)
         {
-            // Write a lossless pixel
+            // Encode a lossless pixel
             ///////////////////////////////////////////////////////////
             if(information.m_bLossless)
             {
                 std::int32_t lastValue = pChannel->m_lastDCValue;
-                std::int32_t* pBuffer = pChannel->m_pBuffer + pChannel->m_losslessPositionY * pChannel->m_width + pChannel->m_losslessPositionX;
 
                 for(std::uint32_t scanBlock = pChannel->m_blockMcuXY; scanBlock != 0; --scanBlock)
                 {
-                    std::int32_t value(*pBuffer);
-                    if(pChannel->m_losslessPositionX == 0 && pChannel->m_losslessPositionY != 0)
+                    // Read the next row from the source image. The rows
+                    //  below the image repeat the last sample
+                    ///////////////////////////////////////////////////////////
+                    if(pChannel->m_losslessPositionX == 0)
+                    {
+                        if(pChannel->m_losslessRow.empty())
+                        {
+                            pChannel->m_losslessRow.resize(pChannel->m_width);
+                        }
+                        pChannel->m_losslessAboveValue = pChannel->m_losslessRow.front();
+                        const std::uint32_t startRow(pChannel->m_losslessPositionY * pChannel->m_samplesReplicateY);
+                        if(startRow < pChannel->m_samplesImageHeight)
+                        {
+                            loadEncoderSamples(sourceImage, information, *pChannel, pChannel->m_losslessRow.data(),
+                                               0, startRow, pChannel->m_width * pChannel->m_samplesReplicateX, startRow + pChannel->m_samplesReplicateY);
+                        }
+                        else
+                        {
+                            std::fill(pChannel->m_losslessRow.begin(), pChannel->m_losslessRow.end(), pChannel->m_losslessRow.back());
+                        }
+                    }
+
+                    std::int32_t value(pChannel->m_losslessRow[pChannel->m_losslessPositionX]);
+
+                    // The first pixel of a restart interval is
+                    //  predicted from the default value
+                    ///////////////////////////////////////////////////////////
+                    if(pChannel->m_losslessPositionX == 0 && pChannel->m_losslessPositionY != 0 && !(bRestart && scanBlock == pChannel->m_blockMcuXY))
                     {
-                        lastValue = *(pBuffer - pChannel->m_width);
+                        lastValue = pChannel->m_losslessAboveValue;
                     }
-                    ++pBuffer;
                     std::int32_t diff = value - lastValue;
                     std::int32_t diff1 = value + ((std::int32_t)1 << information.m_precision) - lastValue;
                     std::int32_t diff2 = value - ((std::int32_t)1 << information.m_precision) - lastValue;
@@ -1050,34 +1610,31 @@ void jpegImageCodec::writeScan(streamWriter* pDestinationStream, jpeg::jpegInfor
                     if(bCalcHuffman)
                     {
                         pChannel->m_pActiveHuffmanTableDC->incValueFreq(amplitudeLength);
-                        continue;
-                    }
-                    pChannel->m_pActiveHuffmanTableDC->writeHuffmanCode(amplitudeLength, pDestinationStream);
-                    if(amplitudeLength != 16)
-                    {
-                        pDestinationStream->writeBits(amplitude, amplitudeLength);
                     }
+                    symbols.push_back(jpegSymbol(channelTables, amplitudeLength, amplitude, amplitudeLength == 16 ? 0 : amplitudeLength));
                 }
 
+                channelTables += 2;
                 continue;
             }
 
-            // write a lossy MCU
+            // Encode a lossy MCU
             ///////////////////////////////////////////////////////////
-            std::uint32_t bufferPointer =
-                    (information.m_mcuProcessedY * pChannel->m_blockMcuY *
-                     ((information.m_jpegImageWidth * pChannel->m_samplingFactorX / information.m_maxSamplingFactorX) >> 3) +
-                     information.m_mcuProcessedX * pChannel->m_blockMcuX) * 64;
-
+            const std::uint32_t blockWidth(8 * pChannel->m_samplesReplicateX);
+            const std::uint32_t blockHeight(8 * pChannel->m_samplesReplicateY);
             for(std::uint32_t scanBlockY = 0; scanBlockY != pChannel->m_blockMcuY; ++scanBlockY)
             {
+                const std::uint32_t startRow((information.m_mcuProcessedY * pChannel->m_blockMcuY + scanBlockY) * blockHeight);
                 for(std::uint32_t scanBlockX = 0; scanBlockX != pChannel->m_blockMcuX; ++scanBlockX)
                 {
-                    writeBlock(pDestinationStream, information, &(pChannel->m_pBuffer[bufferPointer]), pChannel, bCalcHuffman);
-                    bufferPointer += 64;
+                    const std::uint32_t startCol((information.m_mcuProcessedX * pChannel->m_blockMcuX + scanBlockX) * blockWidth);
+                    std::int32_t block[64];
+                    loadEncoderSamples(sourceImage, information, *pChannel, block, startCol, startRow, startCol + blockWidth, startRow + blockHeight);
+                    encodeBlock(information, block, pChannel, channelTables, bCalcHuffman, symbols);
                 }
-                bufferPointer += (information.m_mcuNumberX -1) * pChannel->m_blockMcuX * 64;
             }
+
+            channelTables += 2;
         }
 
         ++information.m_mcuProcessed;
@@ -1088,11 +1645,62 @@ void jpegImageCodec::writeScan(streamWriter* pDestinationStream, jpeg::jpegInfor
         }
     }
 
-    if(!bCalcHuffman)
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Write a single scan (SOS tag + the encoded symbols)
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void jpegImageCodec::writeScan(streamWriter* pDestinationStream, jpeg::jpegInformation& information, const std::vector<std::uint32_t>& symbols) const
+{
+    IMEBRA_FUNCTION_START();
+
+    startScan(information);
+
+    if(information.m_mcuPerRestartInterval != 0)
+    {
+        writeTag(pDestinationStream, dri, information);
+    }
+    writeTag(pDestinationStream, sos, information);
+
+    // The DC and AC tables of each channel, in the same order
+    //  used by encodeScan()
+    ///////////////////////////////////////////////////////////
+    huffmanTable* pHuffmanTables[8];
+    size_t tablesCount(0);
+    for(const std::shared_ptr<jpeg::jpegChannel>& pChannel: information.m_channelsList)
+    {
+        pHuffmanTables[tablesCount++] = pChannel->m_pActiveHuffmanTableDC;
+        pHuffmanTables[tablesCount++] = pChannel->m_pActiveHuffmanTableAC;
+    }
+
+    for(const std::uint32_t symbol: symbols)
     {
-        pDestinationStream->resetOutBitsBuffer();
+        const std::uint32_t amplitudeLength((symbol >> 24) & 0x1f);
+        if(amplitudeLength == jpegRestartSymbol)
+        {
+            pDestinationStream->resetOutBitsBuffer();
+            const std::uint8_t restartMarker[2] = {(std::uint8_t)0xff, (std::uint8_t)(symbol & 0xff)};
+            pDestinationStream->write(restartMarker, 2);
+            continue;
+        }
+
+        pHuffmanTables[symbol >> 29]->writeHuffmanCode((symbol >> 16) & 0xff, pDestinationStream);
+        if(amplitudeLength != 0)
+        {
+            pDestinationStream->writeBits(symbol & 0xffff, amplitudeLength);
+        }
     }
 
+    pDestinationStream->resetOutBitsBuffer();
+
     IMEBRA_FUNCTION_END();
 }
 
@@ -1235,16 +1843,21 @@ inline void jpegImageCodec::readBlock(jpegStreamReader& stream, jpeg::jpegInform
 /////////////////////////////////////////////////////////////////
 //
 //
-// Write a single MCU's block.
+// Encode a single MCU's block.
 //
 //
 /////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////
-inline void jpegImageCodec::writeBlock(streamWriter* pStream, jpeg::jpegInformation& information, std::int32_t* pBuffer, const std::shared_ptr<jpeg::jpegChannel>& pChannel, bool bCalcHuffman) const
+inline void jpegImageCodec::encodeBlock(jpeg::jpegInformation& information, std::int32_t* pBuffer, const std::shared_ptr<jpeg::jpegChannel>& pChannel, std::uint32_t channelTables, bool bCalcHuffman, std::vector<std::uint32_t>& symbols) const
 {
     IMEBRA_FUNCTION_START();
 
-    if(bCalcHuffman)
+    const jpegDct::fdct_t pSimdFDCT(jpegDct::getJpegDct().m_pFDCT);
+    if(pSimdFDCT != nullptr)
+    {
+        pSimdFDCT(pBuffer, information.m_compressionQuantizationTable[pChannel->m_quantTable]);
+    }
+    else
     {
         FDCT(pBuffer, information.m_compressionQuantizationTable[pChannel->m_quantTable]);
     }
@@ -1255,6 +1868,7 @@ inline void jpegImageCodec::writeBlock(streamWriter* pStream, jpeg::jpegInformat
     std::int32_t value;
     const std::uint32_t* pJpegDeZigZagOrder(&(JpegDeZigZagOrder[information.m_spectralIndexStart]));
     huffmanTable* pActiveHuffmanTable;
+    std::uint32_t activeTable;
 
     for(std::uint32_t spectralIndex = information.m_spectralIndexStart; spectralIndex <= information.m_spectralIndexEnd; ++spectralIndex)
     {
@@ -1273,10 +1887,12 @@ inline void jpegImageCodec::writeBlock(streamWriter* pStream, jpeg::jpegInformat
             value -= pChannel->m_lastDCValue;
             pChannel->m_lastDCValue += value;
             pActiveHuffmanTable = pChannel->m_pActiveHuffmanTableDC;
+            activeTable = channelTables;
         }
         else
         {
             pActiveHuffmanTable = pChannel->m_pActiveHuffmanTableAC;
+            activeTable = channelTables + 1;
             if(value == 0)
             {
                 ++zeroRun;
@@ -1284,7 +1900,7 @@ inline void jpegImageCodec::writeBlock(streamWriter* pStream, jpeg::jpegInformat
             }
         }
 
-        //Write out the zero runs
+        //Encode the zero runs
         /////////////////////////////////////////////////////////////////
         while(zeroRun >= 16)
         {
@@ -1293,15 +1909,14 @@ inline void jpegImageCodec::writeBlock(streamWriter* pStream, jpeg::jpegInformat
             if(bCalcHuffman)
             {
                 pActiveHuffmanTable->incValueFreq(zeroRunCode);
-                continue;
             }
-            pActiveHuffmanTable->writeHuffmanCode(zeroRunCode, pStream);
+            symbols.push_back(jpegSymbol(activeTable, zeroRunCode, 0, 0));
         }
 
         std::uint32_t hufCode = (zeroRun << 4);
         zeroRun = 0;
 
-        // Write out the value
+        // Encode the value
         /////////////////////////////////////////////////////////////////
         std::uint32_t amplitudeLength = 0;
         std::uint32_t amplitude = 0;
@@ -1320,13 +1935,8 @@ inline void jpegImageCodec::writeBlock(streamWriter* pStream, jpeg::jpegInformat
         if(bCalcHuffman)
         {
             pActiveHuffmanTable->incValueFreq(hufCode);
-            continue;
-        }
-        pActiveHuffmanTable->writeHuffmanCode(hufCode, pStream);
-        if(amplitudeLength != 0)
-        {
-            pStream->writeBits(amplitude, amplitudeLength);
         }
+        symbols.push_back(jpegSymbol(activeTable, hufCode, amplitude, amplitudeLength));
     }
 
     if(zeroRun == 0)
@@ -1338,9 +1948,8 @@ inline void jpegImageCodec::writeBlock(streamWriter* pStream, jpeg::jpegInformat
     if(bCalcHuffman)
     {
         pChannel->m_pActiveHuffmanTableAC->incValueFreq(zero);
-        return;
     }
-    pChannel->m_pActiveHuffmanTableAC->writeHuffmanCode(zero, pStream);
+    symbols.push_back(jpegSymbol(channelTables + 1, zero, 0, 0));
 
     IMEBRA_FUNCTION_END();
 }
@@ -23,6 +23,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "jpegCodecBaseImpl.h"
 #include <map>
 #include <list>
+#include <vector>
 
 
 namespace imebra
@@ -31,6 +32,12 @@ namespace imebra
 namespace implementation
 {
 
+namespace handlers
+{
+    class readingDataHandlerNumericBase;
+    class writingDataHandlerNumericBase;
+}
+
 namespace codecs
 {
 
@@ -65,6 +72,27 @@ public:
                                             std::uint8_t highBit,
                                             std::shared_ptr<streamReader> pSourceStream) const override;
 
+    // Retrieve a region of the image from a dataset,
+    //  skipping the restart intervals outside the region
+    ///////////////////////////////////////////////////////////
+    virtual std::shared_ptr<image> getImageRegion(const std::string& transferSyntax,
+                                                  const std::string& colorSpace,
+                                                  std::uint32_t channelsNumber,
+                                                  std::uint32_t imageWidth,
+                                                  std::uint32_t imageHeight,
+                                                  bool bSubSampledX,
+                                                  bool bSubSampledY,
+                                                  bool bInterleaved,
+                                                  bool b2Complement,
+                                                  std::uint8_t allocatedBits,
+                                                  std::uint8_t storedBits,
+                                                  std::uint8_t highBit,
+                                                  std::shared_ptr<streamReader> pSourceStream,
+                                                  std::uint32_t regionLeft,
+                                                  std::uint32_t regionTop,
+                                                  std::uint32_t regionWidth,
+                                                  std::uint32_t regionHeight) const override;
+
     // Return the default planar configuration
     ///////////////////////////////////////////////////////////
     virtual bool defaultInterleaved() const override;
@@ -102,18 +130,64 @@ public:
     void IDCT(std::int32_t* pIOMatrix, long long* pScaleFactors) const;
 
 private:
+    // Decode the image, or the region set in information
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<image> decodeImage(const std::string& transferSyntax,
+                                       const std::string& colorSpace,
+                                       bool b2Complement,
+                                       std::shared_ptr<streamReader> pSourceStream,
+                                       jpeg::jpegInformation& information) const;
+
+    // Skip the entropy coded data up to the next marker, or
+    //  up to the first marker that is not a RST marker
+    ///////////////////////////////////////////////////////////
+    void skipEntropyData(streamReader& sourceStream, bool bSkipRestartMarkers) const;
+
+    // Read the MCUs until lastMcu or the end of the stream
+    ///////////////////////////////////////////////////////////
+    void readMcus(jpegStreamReader& stream, jpeg::jpegInformation& information, std::uint32_t lastMcu) const;
+
+    // Return true if the restart intervals of the active scan
+    //  can be decoded in parallel
+    ///////////////////////////////////////////////////////////
+    bool canReadRestartIntervals(const jpeg::jpegInformation& information, size_t threadsCount) const;
+
+    // Read the restart intervals of the active scan in
+    //  parallel
+    ///////////////////////////////////////////////////////////
+    void readRestartIntervals(streamReader& sourceStream, jpeg::jpegInformation& information, size_t threadsCount) const;
+
     // Read a lossy block of pixels
     ///////////////////////////////////////////////////////////
     inline void readBlock(jpegStreamReader& stream, jpeg::jpegInformation& information, std::int32_t* pBuffer, const std::shared_ptr<jpeg::jpegChannel>& pChannel) const;
 
-    // Write a lossy block of pixels
+    // Encode a lossy block of pixels into huffman symbols
+    ///////////////////////////////////////////////////////////
+    inline void encodeBlock(jpeg::jpegInformation& information, std::int32_t* pBuffer, const std::shared_ptr<jpeg::jpegChannel>& pChannel, std::uint32_t channelTables, bool bCalcHuffman, std::vector<std::uint32_t>& symbols) const;
+
+    // Allocate the image that receives the decoded samples
+    //  and let the channels write directly into its buffer
+    ///////////////////////////////////////////////////////////
+    std::shared_ptr<image> allocateImage(jpeg::jpegInformation& information, bool b2complement, const std::string& colorSpace, std::shared_ptr<handlers::writingDataHandlerNumericBase>& pImageHandler) const;
+
+    // Create the channels that encode the source image
     ///////////////////////////////////////////////////////////
-    inline void writeBlock(streamWriter* pStream, jpeg::jpegInformation& information, std::int32_t* pBuffer, const std::shared_ptr<jpeg::jpegChannel>& pChannel, bool bCalcHuffman) const;
+    void createJpegChannels(jpeg::jpegInformation& information, std::shared_ptr<const image> sourceImage, bool b2complement, std::uint32_t allocatedBits, bool bSubSampledX, bool bSubSampledY) const;
 
-    std::shared_ptr<image> copyJpegChannelsToImage(jpeg::jpegInformation& information, bool b2complement, const std::string& colorSpace) const;
-    void copyImageToJpegChannels(jpeg::jpegInformation& information, std::shared_ptr<const image> sourceImage, bool b2complement, std::uint32_t allocatedBits, bool bSubSampledX, bool bSubSampledY) const;
+    // Prepare the information for the active scan
+    ///////////////////////////////////////////////////////////
+    void startScan(jpeg::jpegInformation& information) const;
 
-    void writeScan(streamWriter* pDestinationStream, jpeg::jpegInformation& information, bool bCalcHuffman) const;
+    // Encode the active scan into huffman symbols and, unless
+    //  the typical huffman tables are used, update the huffman
+    //  values' frequencies
+    ///////////////////////////////////////////////////////////
+    void encodeScan(jpeg::jpegInformation& information, const handlers::readingDataHandlerNumericBase& sourceImage, std::vector<std::uint32_t>& symbols) const;
+
+    // Write the active scan: SOS tag followed by the symbols
+    //  returned by encodeScan()
+    ///////////////////////////////////////////////////////////
+    void writeScan(streamWriter* pDestinationStream, jpeg::jpegInformation& information, const std::vector<std::uint32_t>& symbols) const;
 
 };
 
@@ -0,0 +1,1619 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file jpegLsImageCodecImpl.cpp
+    \brief Implementation of the class jpegLsImageCodec.
+
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "exceptionImpl.h"
+#include "streamReaderImpl.h"
+#include "streamWriterImpl.h"
+#include "jpegLsImageCodecImpl.h"
+#include "imageImpl.h"
+#include "../include/imebra/exceptions.h"
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+namespace codecs
+{
+
+namespace
+{
+
+///////////////////////////////////////////////////////////
+//
+// Length (in bits) of the run segments, indexed by the
+//  run index (T.87 A.7.1.1)
+//
+///////////////////////////////////////////////////////////
+static const std::int32_t J[32] = {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+
+///////////////////////////////////////////////////////////
+//
+// Returns the number of bits necessary to represent
+//  the specified amount of values
+//
+///////////////////////////////////////////////////////////
+std::int32_t bitsForValues(std::int32_t values)
+{
+    std::int32_t bits(0);
+    while((1 << bits) < values)
+    {
+        ++bits;
+    }
+    return bits;
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Returns the number of leading zero bits in a 64 bit
+//  value different from zero
+//
+///////////////////////////////////////////////////////////
+inline std::uint32_t countLeadingZeros(std::uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (std::uint32_t)__builtin_clzll(value);
+#else
+    std::uint32_t zeros(0);
+    while((value & 0x8000000000000000ull) == 0)
+    {
+        value <<= 1;
+        ++zeros;
+    }
+    return zeros;
+#endif
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// The parameters used to code a scan (T.87 C.2.4.1.1 and
+//  A.2.1).
+//
+// When used to store the preset parameters (LSE marker)
+//  the values set to zero select the default values.
+//
+///////////////////////////////////////////////////////////
+struct jpegLsParameters
+{
+    jpegLsParameters(): m_maxVal(0), m_near(0), m_t1(0), m_t2(0), m_t3(0), m_reset(0), m_range(0), m_qbpp(0), m_limit(0)
+    {}
+
+    std::int32_t m_maxVal;
+    std::int32_t m_near;
+    std::int32_t m_t1;
+    std::int32_t m_t2;
+    std::int32_t m_t3;
+    std::int32_t m_reset;
+
+    std::int32_t m_range;
+    std::int32_t m_qbpp;
+    std::int32_t m_limit;
+};
+
+
+///////////////////////////////////////////////////////////
+//
+// Calculate the coding parameters from the samples
+//  precision, the NEAR parameter and the preset
+//  parameters
+//
+///////////////////////////////////////////////////////////
+jpegLsParameters getJpegLsParameters(std::uint32_t precision, std::int32_t near, const jpegLsParameters& preset)
+{
+    IMEBRA_FUNCTION_START();
+
+    jpegLsParameters parameters;
+
+    parameters.m_maxVal = (preset.m_maxVal != 0) ? preset.m_maxVal : (std::int32_t)((1u << precision) - 1);
+    if(parameters.m_maxVal <= 0 || parameters.m_maxVal >= (std::int32_t)(1u << precision))
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Invalid JPEG-LS MAXVAL parameter");
+    }
+    const std::int32_t maxVal(parameters.m_maxVal);
+
+    if(near < 0 || near > std::min(255, maxVal / 2))
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Invalid JPEG-LS NEAR parameter");
+    }
+    parameters.m_near = near;
+
+    // Default thresholds (T.87 C.2.4.1.1.1)
+    ///////////////////////////////////////////////////////////
+    std::int32_t defaultT1, defaultT2, defaultT3;
+    if(maxVal >= 128)
+    {
+        const std::int32_t factor((std::min(maxVal, 4095) + 128) >> 8);
+        defaultT1 = factor * (3 - 2) + 2 + 3 * near;
+        defaultT1 = (defaultT1 > maxVal || defaultT1 < near + 1) ? near + 1 : defaultT1;
+        defaultT2 = factor * (7 - 3) + 3 + 5 * near;
+        defaultT2 = (defaultT2 > maxVal || defaultT2 < defaultT1) ? defaultT1 : defaultT2;
+        defaultT3 = factor * (21 - 4) + 4 + 7 * near;
+        defaultT3 = (defaultT3 > maxVal || defaultT3 < defaultT2) ? defaultT2 : defaultT3;
+    }
+    else
+    {
+        const std::int32_t factor(256 / (maxVal + 1));
+        defaultT1 = std::max(2, 3 / factor + 3 * near);
+        defaultT1 = (defaultT1 > maxVal || defaultT1 < near + 1) ? near + 1 : defaultT1;
+        defaultT2 = std::max(3, 7 / factor + 5 * near);
+        defaultT2 = (defaultT2 > maxVal || defaultT2 < defaultT1) ? defaultT1 : defaultT2;
+        defaultT3 = std::max(4, 21 / factor + 7 * near);
+        defaultT3 = (defaultT3 > maxVal || defaultT3 < defaultT2) ? defaultT2 : defaultT3;
+    }
+
+    parameters.m_t1 = (preset.m_t1 != 0) ? preset.m_t1 : defaultT1;
+    parameters.m_t2 = (preset.m_t2 != 0) ? preset.m_t2 : defaultT2;
+    parameters.m_t3 = (preset.m_t3 != 0) ? preset.m_t3 : defaultT3;
+    parameters.m_reset = (preset.m_reset != 0) ? preset.m_reset : 64;
+
+    if(parameters.m_t1 < near + 1 || parameters.m_t1 > maxVal ||
+            parameters.m_t2 < parameters.m_t1 || parameters.m_t2 > maxVal ||
+            parameters.m_t3 < parameters.m_t2 || parameters.m_t3 > maxVal ||
+            parameters.m_reset < 3 || parameters.m_reset > std::max(255, maxVal))
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Invalid JPEG-LS preset parameters");
+    }
+
+    // Derived parameters (T.87 A.2.1)
+    ///////////////////////////////////////////////////////////
+    parameters.m_range = (maxVal + 2 * near) / (2 * near + 1) + 1;
+    parameters.m_qbpp = bitsForValues(parameters.m_range);
+    const std::int32_t bpp(std::max(2, bitsForValues(maxVal + 1)));
+    parameters.m_limit = 2 * (bpp + std::max(8, bpp));
+
+    return parameters;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Writes the bits of a JPEG-LS scan.
+//
+// A zero bit is stuffed after each 0xff byte, so a
+//  marker cannot appear in the coded data (T.87 A.1).
+//
+///////////////////////////////////////////////////////////
+class jpegLsBitWriter
+{
+public:
+    static const bool bEncoder = true;
+
+    explicit jpegLsBitWriter(std::vector<std::uint8_t>* pOutput): m_pOutput(pOutput), m_bits(0), m_bitsNumber(0), m_bLastFF(false)
+    {}
+
+    // Write up to 32 bits
+    ///////////////////////////////////////////////////////////
+    inline void writeBits(std::uint32_t value, std::uint32_t bitsNumber)
+    {
+        m_bits = (m_bits << bitsNumber) | value;
+        m_bitsNumber += bitsNumber;
+
+        for(;;)
+        {
+            const std::uint32_t byteBits(m_bLastFF ? 7 : 8);
+            if(m_bitsNumber < byteBits)
+            {
+                break;
+            }
+            m_bitsNumber -= byteBits;
+            const std::uint8_t byte((std::uint8_t)((m_bits >> m_bitsNumber) & ((1u << byteBits) - 1)));
+            m_pOutput->push_back(byte);
+            m_bLastFF = (byte == 0xff);
+        }
+        m_bits &= ((std::uint64_t)1 << m_bitsNumber) - 1;
+    }
+
+    inline void writeZeros(std::uint32_t zerosNumber)
+    {
+        for(; zerosNumber > 32; zerosNumber -= 32)
+        {
+            writeBits(0, 32);
+        }
+        writeBits(0, zerosNumber);
+    }
+
+    // Pad the last byte with zeros. A scan cannot end with
+    //  0xff because the following marker would be mistaken
+    //  for coded data
+    ///////////////////////////////////////////////////////////
+    void flush()
+    {
+        if(m_bitsNumber != 0)
+        {
+            writeBits(0, (m_bLastFF ? 7 : 8) - m_bitsNumber);
+        }
+        if(m_bLastFF)
+        {
+            writeBits(0, 7);
+        }
+    }
+
+private:
+    std::vector<std::uint8_t>* m_pOutput;
+    std::uint64_t m_bits;
+    std::uint32_t m_bitsNumber;
+    bool m_bLastFF;
+};
+
+
+///////////////////////////////////////////////////////////
+//
+// Reads the bits of a JPEG-LS scan.
+//
+// The reader is initialized with the scan's data up to
+//  the next marker; zero bits are returned past the end
+//  of the data.
+//
+///////////////////////////////////////////////////////////
+class jpegLsBitReader
+{
+public:
+    static const bool bEncoder = false;
+
+    jpegLsBitReader(const std::uint8_t* pData, const std::uint8_t* pDataEnd): m_pData(pData), m_pDataEnd(pDataEnd), m_bits(0), m_bitsNumber(0), m_bLastFF(false)
+    {}
+
+    // Read up to 32 bits
+    ///////////////////////////////////////////////////////////
+    inline std::uint32_t readBits(std::uint32_t bitsNumber)
+    {
+        if(bitsNumber == 0)
+        {
+            return 0;
+        }
+        if(m_bitsNumber < bitsNumber)
+        {
+            fill();
+        }
+        const std::uint32_t value((std::uint32_t)(m_bits >> (64 - bitsNumber)));
+        m_bits <<= bitsNumber;
+        m_bitsNumber -= bitsNumber;
+        return value;
+    }
+
+    // Count the zero bits that precede a one and consume
+    //  them together with the one
+    ///////////////////////////////////////////////////////////
+    inline std::uint32_t readZeros(std::uint32_t maximumZeros)
+    {
+        std::uint32_t zeros(0);
+        for(;;)
+        {
+            if(m_bitsNumber == 0)
+            {
+                fill();
+            }
+            if(m_bits != 0)
+            {
+                const std::uint32_t leadingZeros(countLeadingZeros(m_bits));
+                zeros += leadingZeros;
+                if(zeros > maximumZeros)
+                {
+                    break;
+                }
+                m_bits <<= leadingZeros;
+                m_bits <<= 1;
+                m_bitsNumber -= leadingZeros + 1;
+                return zeros;
+            }
+            zeros += m_bitsNumber;
+            m_bitsNumber = 0;
+            if(zeros > maximumZeros)
+            {
+                break;
+            }
+        }
+
+        IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS stream (golomb code too long)");
+    }
+
+private:
+    void fill()
+    {
+        while(m_bitsNumber <= 56)
+        {
+            const std::uint32_t byteBits(m_bLastFF ? 7 : 8);
+            std::uint64_t byte(0);
+            m_bLastFF = false;
+            if(m_pData != m_pDataEnd)
+            {
+                byte = *(m_pData++);
+                m_bLastFF = (byte == 0xff);
+            }
+            m_bits |= byte << (64 - m_bitsNumber - byteBits);
+            m_bitsNumber += byteBits;
+        }
+    }
+
+    const std::uint8_t* m_pData;
+    const std::uint8_t* m_pDataEnd;
+    std::uint64_t m_bits;
+    std::uint32_t m_bitsNumber;
+    bool m_bLastFF;
+};
+
+
+///////////////////////////////////////////////////////////
+//
+// Code a mapped error value with the limited length
+//  Golomb code (T.87 A.5.3).
+//
+// The encoder writes mappedError, the decoder reads it.
+//
+///////////////////////////////////////////////////////////
+inline void codeMappedError(jpegLsBitWriter& writer, std::int32_t k, std::int32_t& mappedError, std::int32_t limit, std::int32_t qbpp)
+{
+    const std::int32_t highBits(mappedError >> k);
+    if(highBits < limit - qbpp - 1)
+    {
+        const std::uint32_t lowBits((std::uint32_t)mappedError & ((1u << k) - 1));
+        if(highBits + k < 32)
+        {
+            writer.writeBits((1u << k) | lowBits, (std::uint32_t)(highBits + k + 1));
+        }
+        else
+        {
+            writer.writeZeros((std::uint32_t)highBits);
+            writer.writeBits(1, 1);
+            writer.writeBits(lowBits, (std::uint32_t)k);
+        }
+        return;
+    }
+
+    writer.writeZeros((std::uint32_t)(limit - qbpp - 1));
+    writer.writeBits(1, 1);
+    writer.writeBits((std::uint32_t)(mappedError - 1), (std::uint32_t)qbpp);
+}
+
+inline void codeMappedError(jpegLsBitReader& reader, std::int32_t k, std::int32_t& mappedError, std::int32_t limit, std::int32_t qbpp)
+{
+    const std::uint32_t escapeZeros((std::uint32_t)(limit - qbpp - 1));
+    const std::uint32_t zeros(reader.readZeros(escapeZeros));
+    if(zeros < escapeZeros)
+    {
+        mappedError = (std::int32_t)((zeros << k) | reader.readBits((std::uint32_t)k));
+        return;
+    }
+    mappedError = (std::int32_t)reader.readBits((std::uint32_t)qbpp) + 1;
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Code the length of a run (T.87 A.7.1.2).
+//
+// The encoder writes runLength, the decoder reads it.
+//
+///////////////////////////////////////////////////////////
+inline void codeRunLength(jpegLsBitWriter& writer, std::int32_t& runLength, std::int32_t remainingSamples, std::int32_t& runIndex)
+{
+    std::int32_t remainingRun(runLength);
+    while(remainingRun >= (1 << J[runIndex]))
+    {
+        writer.writeBits(1, 1);
+        remainingRun -= (1 << J[runIndex]);
+        if(runIndex < 31)
+        {
+            ++runIndex;
+        }
+    }
+
+    if(runLength == remainingSamples)
+    {
+        // The run reaches the end of the line
+        ///////////////////////////////////////////////////////////
+        if(remainingRun != 0)
+        {
+            writer.writeBits(1, 1);
+        }
+        return;
+    }
+
+    // A zero bit followed by the remaining length
+    ///////////////////////////////////////////////////////////
+    writer.writeBits((std::uint32_t)remainingRun, (std::uint32_t)J[runIndex] + 1);
+}
+
+inline void codeRunLength(jpegLsBitReader& reader, std::int32_t& runLength, std::int32_t remainingSamples, std::int32_t& runIndex)
+{
+    runLength = 0;
+    while(reader.readBits(1) != 0)
+    {
+        const std::int32_t segmentLength(1 << J[runIndex]);
+        if(segmentLength <= remainingSamples - runLength)
+        {
+            runLength += segmentLength;
+            if(runIndex < 31)
+            {
+                ++runIndex;
+            }
+        }
+        else
+        {
+            runLength = remainingSamples;
+        }
+        if(runLength == remainingSamples)
+        {
+            return;
+        }
+    }
+
+    runLength += (std::int32_t)reader.readBits((std::uint32_t)J[runIndex]);
+    if(runLength > remainingSamples)
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS stream (run past the end of the line)");
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Codes the lines of a scan with the LOCO-I algorithm
+//  (T.87 Annex A).
+//
+// The same code is used by the encoder and by the
+//  decoder: the stream type selects the direction.
+//
+// Each line is stored with one extra sample on the left
+//  and on the right side, used to predict the samples on
+//  the edges.
+//
+///////////////////////////////////////////////////////////
+class jpegLsCoder
+{
+public:
+    jpegLsCoder(const jpegLsParameters& parameters, std::uint32_t width):
+        m_width((std::int32_t)width),
+        m_maxVal(parameters.m_maxVal),
+        m_near(parameters.m_near),
+        m_quantizationStep(2 * parameters.m_near + 1),
+        m_range(parameters.m_range),
+        m_qbpp(parameters.m_qbpp),
+        m_limit(parameters.m_limit),
+        m_reset(parameters.m_reset),
+        m_gradientQuantization((size_t)(2 * parameters.m_maxVal + 1))
+    {
+        // Quantized value of each local gradient (T.87 A.3.3)
+        ///////////////////////////////////////////////////////////
+        for(std::int32_t gradient(-m_maxVal); gradient <= m_maxVal; ++gradient)
+        {
+            std::int8_t quantized;
+            if(gradient <= -parameters.m_t3)       quantized = -4;
+            else if(gradient <= -parameters.m_t2)  quantized = -3;
+            else if(gradient <= -parameters.m_t1)  quantized = -2;
+            else if(gradient < -m_near)            quantized = -1;
+            else if(gradient <= m_near)            quantized = 0;
+            else if(gradient < parameters.m_t1)    quantized = 1;
+            else if(gradient < parameters.m_t2)    quantized = 2;
+            else if(gradient < parameters.m_t3)    quantized = 3;
+            else                                   quantized = 4;
+            m_gradientQuantization[(size_t)(gradient + m_maxVal)] = quantized;
+        }
+
+        // Initial values of the context variables (T.87 A.2.1)
+        ///////////////////////////////////////////////////////////
+        const std::int32_t initialA(std::max(2, (m_range + 32) / 64));
+        for(regularContext& context: m_regularContexts)
+        {
+            context.m_A = initialA;
+            context.m_B = 0;
+            context.m_C = 0;
+            context.m_N = 1;
+        }
+        for(runContext& context: m_runContexts)
+        {
+            context.m_A = initialA;
+            context.m_N = 1;
+            context.m_Nn = 0;
+        }
+    }
+
+    // Code a line of one component
+    ///////////////////////////////////////////////////////////
+    template<typename stream_t>
+    void codeLine(stream_t& stream, const std::int32_t* pPrevious, std::int32_t* pCurrent, std::int32_t& runIndex)
+    {
+        std::int32_t index(0);
+        std::int32_t rb(pPrevious[-1]);
+        std::int32_t rd(pPrevious[0]);
+
+        while(index < m_width)
+        {
+            const std::int32_t ra(pCurrent[index - 1]);
+            const std::int32_t rc(rb);
+            rb = rd;
+            rd = pPrevious[index + 1];
+
+            const std::int32_t context(getContext(ra, rb, rc, rd));
+            if(context != 0)
+            {
+                pCurrent[index] = codeRegular(stream, context, pCurrent[index], predict(ra, rb, rc));
+                ++index;
+            }
+            else
+            {
+                index += codeRun(stream, pPrevious, pCurrent, index, runIndex);
+                rb = pPrevious[index - 1];
+                rd = pPrevious[index];
+            }
+        }
+    }
+
+    // Code a line of up to 4 interleaved components
+    ///////////////////////////////////////////////////////////
+    template<typename stream_t>
+    void codeInterleavedLine(stream_t& stream, const std::int32_t* const* ppPrevious, std::int32_t* const* ppCurrent, size_t componentsNumber, std::int32_t& runIndex)
+    {
+        std::int32_t index(0);
+        std::int32_t contexts[4];
+
+        while(index < m_width)
+        {
+            bool bRunMode(true);
+            for(size_t component(0); component != componentsNumber; ++component)
+            {
+                const std::int32_t* pPrevious(ppPrevious[component]);
+                contexts[component] = getContext(ppCurrent[component][index - 1], pPrevious[index], pPrevious[index - 1], pPrevious[index + 1]);
+                bRunMode = bRunMode && (contexts[component] == 0);
+            }
+
+            if(bRunMode)
+            {
+                index += codeInterleavedRun(stream, ppPrevious, ppCurrent, componentsNumber, index, runIndex);
+                continue;
+            }
+
+            for(size_t component(0); component != componentsNumber; ++component)
+            {
+                const std::int32_t* pPrevious(ppPrevious[component]);
+                std::int32_t* pCurrent(ppCurrent[component]);
+                pCurrent[index] = codeRegular(stream, contexts[component], pCurrent[index], predict(pCurrent[index - 1], pPrevious[index], pPrevious[index - 1]));
+            }
+            ++index;
+        }
+    }
+
+private:
+    // Context index, negative when the sign of the context
+    //  must be inverted (T.87 A.3.3 and A.3.4)
+    ///////////////////////////////////////////////////////////
+    inline std::int32_t getContext(std::int32_t ra, std::int32_t rb, std::int32_t rc, std::int32_t rd) const
+    {
+        return (m_gradientQuantization[(size_t)(rd - rb + m_maxVal)] * 9 +
+                m_gradientQuantization[(size_t)(rb - rc + m_maxVal)]) * 9 +
+                m_gradientQuantization[(size_t)(rc - ra + m_maxVal)];
+    }
+
+    // Median edge detector (T.87 A.4.1)
+    ///////////////////////////////////////////////////////////
+    static inline std::int32_t predict(std::int32_t ra, std::int32_t rb, std::int32_t rc)
+    {
+        if(rc >= std::max(ra, rb))
+        {
+            return std::min(ra, rb);
+        }
+        if(rc <= std::min(ra, rb))
+        {
+            return std::max(ra, rb);
+        }
+        return ra + rb - rc;
+    }
+
+    inline std::int32_t clampSample(std::int32_t sample) const
+    {
+        return sample < 0 ? 0 : (sample > m_maxVal ? m_maxVal : sample);
+    }
+
+    // Quantize the prediction error for the near-lossless
+    //  coding and reduce it modulo RANGE (T.87 A.4.4 and
+    //  A.4.5)
+    ///////////////////////////////////////////////////////////
+    inline std::int32_t reduceError(std::int32_t error) const
+    {
+        if(error > m_near)
+        {
+            error = (error + m_near) / m_quantizationStep;
+        }
+        else if(error < -m_near)
+        {
+            error = (error - m_near) / m_quantizationStep;
+        }
+        else
+        {
+            error = 0;
+        }
+
+        if(error < 0)
+        {
+            error += m_range;
+        }
+        if(error >= (m_range + 1) / 2)
+        {
+            error -= m_range;
+        }
+        return error;
+    }
+
+    // Calculate the reconstructed value of a sample
+    ///////////////////////////////////////////////////////////
+    inline std::int32_t reconstruct(std::int32_t predicted, std::int32_t error) const
+    {
+        std::int32_t sample(predicted + error * m_quantizationStep);
+        if(sample < -m_near)
+        {
+            sample += m_range * m_quantizationStep;
+        }
+        else if(sample > m_maxVal + m_near)
+        {
+            sample -= m_range * m_quantizationStep;
+        }
+        return clampSample(sample);
+    }
+
+    static inline std::int32_t getGolombK(std::int32_t n, std::int32_t a)
+    {
+        std::int32_t k(0);
+        for(; (n << k) < a && k < 24; ++k)
+        {
+        }
+        return k;
+    }
+
+    // Code a sample in regular mode (T.87 A.4 to A.6)
+    ///////////////////////////////////////////////////////////
+    template<typename stream_t>
+    inline std::int32_t codeRegular(stream_t& stream, std::int32_t signedContext, std::int32_t sample, std::int32_t predicted)
+    {
+        const std::int32_t sign(signedContext < 0 ? -1 : 1);
+        regularContext& context(m_regularContexts[signedContext * sign]);
+
+        const std::int32_t k(getGolombK(context.m_N, context.m_A));
+        predicted = clampSample(predicted + sign * context.m_C);
+
+        // The mapping of the errors is inverted when the bias
+        //  is negative (T.87 A.5.2)
+        ///////////////////////////////////////////////////////////
+        const std::int32_t invertMapping((m_near == 0 && k == 0 && 2 * context.m_B <= -context.m_N) ? 1 : 0);
+
+        std::int32_t error(0);
+        std::int32_t mappedError(0);
+        if(stream_t::bEncoder)
+        {
+            error = reduceError((sample - predicted) * sign);
+            mappedError = ((error >= 0) ? 2 * error : -2 * error - 1) ^ invertMapping;
+        }
+
+        codeMappedError(stream, k, mappedError, m_limit, m_qbpp);
+
+        if(!stream_t::bEncoder)
+        {
+            mappedError ^= invertMapping;
+            error = ((mappedError & 1) != 0) ? -((mappedError + 1) >> 1) : (mappedError >> 1);
+        }
+
+        // Update the context variables and the bias correction
+        //  (T.87 A.6)
+        ///////////////////////////////////////////////////////////
+        context.m_B += error * m_quantizationStep;
+        context.m_A += std::abs(error);
+        if(context.m_N == m_reset)
+        {
+            context.m_A >>= 1;
+            context.m_B = (context.m_B >= 0) ? (context.m_B >> 1) : -((1 - context.m_B) >> 1);
+            context.m_N >>= 1;
+        }
+        ++context.m_N;
+
+        if(context.m_B <= -context.m_N)
+        {
+            context.m_B += context.m_N;
+            if(context.m_C > -128)
+            {
+                --context.m_C;
+            }
+            if(context.m_B <= -context.m_N)
+            {
+                context.m_B = -context.m_N + 1;
+            }
+        }
+        else if(context.m_B > 0)
+        {
+            context.m_B -= context.m_N;
+            if(context.m_C < 127)
+            {
+                ++context.m_C;
+            }
+            if(context.m_B > 0)
+            {
+                context.m_B = 0;
+            }
+        }
+
+        return reconstruct(predicted, error * sign);
+    }
+
+    // Code the error of the sample that interrupts a run
+    //  (T.87 A.7.2)
+    ///////////////////////////////////////////////////////////
+    template<typename stream_t>
+    inline std::int32_t codeRunInterruptionError(stream_t& stream, std::int32_t runInterruptionType, std::int32_t error, std::int32_t runIndex)
+    {
+        runContext& context(m_runContexts[runInterruptionType]);
+
+        const std::int32_t k(getGolombK(context.m_N, context.m_A + runInterruptionType * (context.m_N >> 1)));
+        const bool bMapNegative(k != 0 || 2 * context.m_Nn >= context.m_N);
+
+        std::int32_t mappedError(0);
+        if(stream_t::bEncoder)
+        {
+            const bool bMap(error > 0 ? !bMapNegative : (error < 0 && bMapNegative));
+            mappedError = 2 * std::abs(error) - runInterruptionType - (bMap ? 1 : 0);
+        }
+
+        codeMappedError(stream, k, mappedError, m_limit - J[runIndex] - 1, m_qbpp);
+
+        if(!stream_t::bEncoder)
+        {
+            const std::int32_t temp(mappedError + runInterruptionType);
+            const bool bMap((temp & 1) != 0);
+            const std::int32_t absError((temp + (bMap ? 1 : 0)) >> 1);
+            error = (bMap == bMapNegative) ? -absError : absError;
+        }
+
+        if(error < 0)
+        {
+            ++context.m_Nn;
+        }
+        context.m_A += (mappedError + 1 - runInterruptionType) >> 1;
+        if(context.m_N == m_reset)
+        {
+            context.m_A >>= 1;
+            context.m_N >>= 1;
+            context.m_Nn >>= 1;
+        }
+        ++context.m_N;
+
+        return error;
+    }
+
+    // Code a run and the sample that interrupts it (T.87
+    //  A.7). Returns the number of coded samples
+    ///////////////////////////////////////////////////////////
+    template<typename stream_t>
+    std::int32_t codeRun(stream_t& stream, const std::int32_t* pPrevious, std::int32_t* pCurrent, std::int32_t index, std::int32_t& runIndex)
+    {
+        const std::int32_t ra(pCurrent[index - 1]);
+        const std::int32_t remainingSamples(m_width - index);
+
+        std::int32_t runLength(0);
+        if(stream_t::bEncoder)
+        {
+            while(runLength != remainingSamples && std::abs(pCurrent[index + runLength] - ra) <= m_near)
+            {
+                ++runLength;
+            }
+        }
+
+        codeRunLength(stream, runLength, remainingSamples, runIndex);
+        std::fill(pCurrent + index, pCurrent + index + runLength, ra);
+        if(runLength == remainingSamples)
+        {
+            return runLength;
+        }
+
+        index += runLength;
+        const std::int32_t rb(pPrevious[index]);
+        if(std::abs(ra - rb) <= m_near)
+        {
+            const std::int32_t error(codeRunInterruptionError(stream, 1, stream_t::bEncoder ? reduceError(pCurrent[index] - ra) : 0, runIndex));
+            pCurrent[index] = reconstruct(ra, error);
+        }
+        else
+        {
+            const std::int32_t sign(rb < ra ? -1 : 1);
+            const std::int32_t error(codeRunInterruptionError(stream, 0, stream_t::bEncoder ? reduceError((pCurrent[index] - rb) * sign) : 0, runIndex));
+            pCurrent[index] = reconstruct(rb, error * sign);
+        }
+
+        if(runIndex != 0)
+        {
+            --runIndex;
+        }
+        return runLength + 1;
+    }
+
+    // Code a run of interleaved samples and the samples
+    //  that interrupt it. Returns the number of coded
+    //  samples per component
+    ///////////////////////////////////////////////////////////
+    template<typename stream_t>
+    std::int32_t codeInterleavedRun(stream_t& stream, const std::int32_t* const* ppPrevious, std::int32_t* const* ppCurrent, size_t componentsNumber, std::int32_t index, std::int32_t& runIndex)
+    {
+        const std::int32_t remainingSamples(m_width - index);
+
+        std::int32_t runLength(0);
+        if(stream_t::bEncoder)
+        {
+            for(; runLength != remainingSamples; ++runLength)
+            {
+                size_t component(0);
+                while(component != componentsNumber && std::abs(ppCurrent[component][index + runLength] - ppCurrent[component][index - 1]) <= m_near)
+                {
+                    ++component;
+                }
+                if(component != componentsNumber)
+                {
+                    break;
+                }
+            }
+        }
+
+        codeRunLength(stream, runLength, remainingSamples, runIndex);
+        for(size_t component(0); component != componentsNumber; ++component)
+        {
+            std::int32_t* pCurrent(ppCurrent[component]);
+            std::fill(pCurrent + index, pCurrent + index + runLength, pCurrent[index - 1]);
+        }
+        if(runLength == remainingSamples)
+        {
+            return runLength;
+        }
+
+        index += runLength;
+        for(size_t component(0); component != componentsNumber; ++component)
+        {
+            std::int32_t* pCurrent(ppCurrent[component]);
+            const std::int32_t rb(ppPrevious[component][index]);
+            const std::int32_t sign(rb < pCurrent[index - 1] ? -1 : 1);
+            const std::int32_t error(codeRunInterruptionError(stream, 0, stream_t::bEncoder ? reduceError((pCurrent[index] - rb) * sign) : 0, runIndex));
+            pCurrent[index] = reconstruct(rb, error * sign);
+        }
+
+        if(runIndex != 0)
+        {
+            --runIndex;
+        }
+        return runLength + 1;
+    }
+
+    struct regularContext
+    {
+        std::int32_t m_A;
+        std::int32_t m_B;
+        std::int32_t m_C;
+        std::int32_t m_N;
+    };
+
+    struct runContext
+    {
+        std::int32_t m_A;
+        std::int32_t m_N;
+        std::int32_t m_Nn;
+    };
+
+    const std::int32_t m_width;
+    const std::int32_t m_maxVal;
+    const std::int32_t m_near;
+    const std::int32_t m_quantizationStep;
+    const std::int32_t m_range;
+    const std::int32_t m_qbpp;
+    const std::int32_t m_limit;
+    const std::int32_t m_reset;
+
+    std::vector<std::int8_t> m_gradientQuantization;
+
+    regularContext m_regularContexts[365];
+    runContext m_runContexts[2];
+};
+
+
+///////////////////////////////////////////////////////////
+//
+// Code all the lines of a scan.
+//
+// transferLine(y, component, pLine) is called before
+//  coding each line when encoding (and must fill pLine)
+//  and after decoding each line when decoding.
+//
+///////////////////////////////////////////////////////////
+template<typename stream_t, typename transferLine_t>
+void codeScan(
+        stream_t& stream,
+        const jpegLsParameters& parameters,
+        std::uint32_t width,
+        std::uint32_t height,
+        std::uint32_t componentsNumber,
+        bool bSampleInterleaved,
+        transferLine_t transferLine)
+{
+    jpegLsCoder coder(parameters, width);
+
+    // Two lines per component, each one with a sample on
+    //  the left and on the right side. The line above the
+    //  first one is made of zeros
+    ///////////////////////////////////////////////////////////
+    const size_t lineSize((size_t)width + 2);
+    std::vector<std::int32_t> lines(lineSize * 2 * componentsNumber, 0);
+    std::vector<std::int32_t*> previousLines(componentsNumber);
+    std::vector<std::int32_t*> currentLines(componentsNumber);
+    std::vector<std::int32_t> runIndex(componentsNumber, 0);
+
+    for(std::uint32_t scanY(0); scanY != height; ++scanY)
+    {
+        for(std::uint32_t component(0); component != componentsNumber; ++component)
+        {
+            std::int32_t* pPrevious(&(lines[(2 * component + (scanY & 1)) * lineSize + 1]));
+            std::int32_t* pCurrent(&(lines[(2 * component + 1 - (scanY & 1)) * lineSize + 1]));
+            pPrevious[width] = pPrevious[width - 1];
+            pCurrent[-1] = pPrevious[0];
+            previousLines[component] = pPrevious;
+            currentLines[component] = pCurrent;
+
+            if(stream_t::bEncoder)
+            {
+                transferLine(scanY, component, pCurrent);
+            }
+        }
+
+        if(bSampleInterleaved)
+        {
+            coder.codeInterleavedLine(stream, previousLines.data(), currentLines.data(), componentsNumber, runIndex[0]);
+        }
+        else
+        {
+            for(std::uint32_t component(0); component != componentsNumber; ++component)
+            {
+                coder.codeLine(stream, previousLines[component], currentLines[component], runIndex[component]);
+            }
+        }
+
+        if(!stream_t::bEncoder)
+        {
+            for(std::uint32_t component(0); component != componentsNumber; ++component)
+            {
+                transferLine(scanY, component, currentLines[component]);
+            }
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Read a 16 bit big endian value from the JPEG-LS
+//  stream
+//
+///////////////////////////////////////////////////////////
+std::uint32_t readUint16(const std::vector<std::uint8_t>& jpegLsStream, size_t position)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(position + 2 > jpegLsStream.size())
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS stream (truncated tag)");
+    }
+    return ((std::uint32_t)jpegLsStream[position] << 8) | (std::uint32_t)jpegLsStream[position + 1];
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Write a marker and its length to the JPEG-LS stream
+//
+///////////////////////////////////////////////////////////
+void writeMarker(std::vector<std::uint8_t>* pJpegLsStream, std::uint8_t marker, size_t length)
+{
+    pJpegLsStream->push_back(0xff);
+    pJpegLsStream->push_back(marker);
+    if(length != 0)
+    {
+        pJpegLsStream->push_back((std::uint8_t)(length >> 8));
+        pJpegLsStream->push_back((std::uint8_t)length);
+    }
+}
+
+} // anonymous namespace
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Get a JPEG-LS image from a dicom structure
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::shared_ptr<image> jpegLsImageCodec::getImage(const std::string& transferSyntax,
+                                                  const std::string& colorSpace,
+                                                  std::uint32_t channelsNumber,
+                                                  std::uint32_t imageWidth,
+                                                  std::uint32_t imageHeight,
+                                                  bool bSubSampledX,
+                                                  bool bSubSampledY,
+                                                  bool /* bInterleaved */,
+                                                  bool b2Complement,
+                                                  std::uint8_t /* allocatedBits */,
+                                                  std::uint8_t /* storedBits */,
+                                                  std::uint8_t highBit,
+                                                  std::shared_ptr<streamReader> pSourceStream) const
+{
+    IMEBRA_FUNCTION_START();
+
+    if(!canHandleTransferSyntax(transferSyntax))
+    {
+        IMEBRA_THROW(CodecWrongTransferSyntaxError, "Cannot handle the transfer syntax");
+    }
+
+    if(bSubSampledX || bSubSampledY)
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "Cannot read subsampled JPEG-LS compressed images");
+    }
+
+    if(highBit >= 16)
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "JPEG-LS images cannot have more than 16 bits per sample");
+    }
+
+    // Load the compressed frame
+    ///////////////////////////////////////////////////////////
+    std::vector<std::uint8_t> jpegLsStream;
+    for(;;)
+    {
+        size_t availableSize(0);
+        const std::uint8_t* pData(pSourceStream->getBufferedData(1, &availableSize));
+        if(availableSize == 0)
+        {
+            break;
+        }
+        jpegLsStream.insert(jpegLsStream.end(), pData, pData + availableSize);
+        pSourceStream->skipBufferedData(availableSize);
+    }
+
+    // Create an image
+    ///////////////////////////////////////////////////////////
+    bitDepth_t depth;
+    if(b2Complement)
+    {
+        depth = (highBit >= 8) ? bitDepth_t::depthS16 : bitDepth_t::depthS8;
+    }
+    else
+    {
+        depth = (highBit >= 8) ? bitDepth_t::depthU16 : bitDepth_t::depthU8;
+    }
+
+    std::shared_ptr<image> pImage(std::make_shared<image>(imageWidth, imageHeight, depth, colorSpace, highBit));
+    std::shared_ptr<handlers::writingDataHandlerNumericBase> handler = pImage->getWritingDataHandler();
+
+    if(pImage->getChannelsNumber() != channelsNumber)
+    {
+        IMEBRA_THROW(CodecCorruptedFileError,  "The color space " << colorSpace << " requires " << pImage->getChannelsNumber() << " but the dataset declares " << channelsNumber << " channels");
+    }
+
+    const std::uint32_t mask((std::uint32_t)(((std::uint64_t)1 << (highBit + 1)) - 1));
+
+    // Decode the scans directly into the image's buffer
+    ///////////////////////////////////////////////////////////
+    std::uint8_t* pImageMemory(handler->getMemoryBuffer());
+    if(highBit >= 8)
+    {
+        readJpegLs(jpegLsStream, reinterpret_cast<std::uint16_t*>(pImageMemory), imageWidth, imageHeight, channelsNumber, mask);
+    }
+    else
+    {
+        readJpegLs(jpegLsStream, pImageMemory, imageWidth, imageHeight, channelsNumber, mask);
+    }
+
+    if(b2Complement)
+    {
+        adjustB2Complement(pImageMemory, highBit, depth, handler->getSize());
+    }
+
+    return pImage;
+
+    IMEBRA_FUNCTION_END_MODIFY(StreamEOFError, CodecCorruptedFileError);
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Decode a JPEG-LS stream
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+template<typename samplesType_t>
+void jpegLsImageCodec::readJpegLs(
+        const std::vector<std::uint8_t>& jpegLsStream,
+        samplesType_t* pImageSamples,
+        std::uint32_t imageWidth,
+        std::uint32_t imageHeight,
+        std::uint32_t channelsNumber,
+        std::uint32_t mask)
+{
+    IMEBRA_FUNCTION_START();
+
+    const size_t streamSize(jpegLsStream.size());
+    if(streamSize < 2 || jpegLsStream[0] != 0xff || jpegLsStream[1] != 0xd8)
+    {
+        IMEBRA_THROW(CodecWrongFormatError, "JPEG-LS signature not present");
+    }
+
+    std::uint32_t precision(0);
+    std::vector<std::uint8_t> componentsIds;
+    jpegLsParameters preset;
+    std::uint32_t decodedScans(0);
+
+    size_t position(2);
+    for(;;)
+    {
+        // Find the next marker, skipping the fill bytes
+        ///////////////////////////////////////////////////////////
+        while(position != streamSize && jpegLsStream[position] != 0xff)
+        {
+            ++position;
+        }
+        while(position != streamSize && jpegLsStream[position] == 0xff)
+        {
+            ++position;
+        }
+        if(position == streamSize)
+        {
+            break;
+        }
+
+        const std::uint8_t marker(jpegLsStream[position++]);
+        if(marker == 0xd9) // EOI
+        {
+            break;
+        }
+        if(marker == 0xd8 || marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7))
+        {
+            // Markers without parameters
+            continue;
+        }
+
+        const size_t segmentLength(readUint16(jpegLsStream, position));
+        const size_t segmentEnd(position + segmentLength);
+        if(segmentLength < 2 || segmentEnd > streamSize)
+        {
+            IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS stream (wrong tag length)");
+        }
+        position += 2;
+
+        switch(marker)
+        {
+        case 0xf7: // SOF55
+        {
+            if(!componentsIds.empty() || segmentLength < 6)
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS SOF tag");
+            }
+            precision = jpegLsStream[position];
+            const std::uint32_t height(readUint16(jpegLsStream, position + 1));
+            const std::uint32_t width(readUint16(jpegLsStream, position + 3));
+            const std::uint32_t componentsNumber(jpegLsStream[position + 5]);
+            if(precision < 2 || precision > 16 || componentsNumber == 0 || segmentLength != 8 + 3 * componentsNumber)
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS SOF tag");
+            }
+            if(width == 0 || height == 0)
+            {
+                IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "JPEG-LS images with the size defined in the LSE tag are not supported");
+            }
+            if(width != imageWidth || height != imageHeight || componentsNumber != channelsNumber)
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "The JPEG-LS image size or channels don't match the dataset");
+            }
+            for(std::uint32_t scanComponents(0); scanComponents != componentsNumber; ++scanComponents)
+            {
+                const size_t componentPosition(position + 6 + 3 * scanComponents);
+                if(jpegLsStream[componentPosition + 1] != 0x11)
+                {
+                    IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "Subsampled JPEG-LS images are not supported");
+                }
+                componentsIds.push_back(jpegLsStream[componentPosition]);
+            }
+            break;
+        }
+
+        case 0xf8: // LSE
+        {
+            if(segmentLength < 3 || jpegLsStream[position] != 1)
+            {
+                IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "JPEG-LS mapping tables are not supported");
+            }
+            if(segmentLength != 13)
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS LSE tag");
+            }
+            preset.m_maxVal = (std::int32_t)readUint16(jpegLsStream, position + 1);
+            preset.m_t1 = (std::int32_t)readUint16(jpegLsStream, position + 3);
+            preset.m_t2 = (std::int32_t)readUint16(jpegLsStream, position + 5);
+            preset.m_t3 = (std::int32_t)readUint16(jpegLsStream, position + 7);
+            preset.m_reset = (std::int32_t)readUint16(jpegLsStream, position + 9);
+            break;
+        }
+
+        case 0xdd: // DRI
+        {
+            if(readUint16(jpegLsStream, position) != 0)
+            {
+                IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "JPEG-LS restart intervals are not supported");
+            }
+            break;
+        }
+
+        case 0xe8: // APP8: color transform
+        {
+            if(segmentLength == 7 &&
+                    jpegLsStream[position] == 'm' && jpegLsStream[position + 1] == 'r' &&
+                    jpegLsStream[position + 2] == 'f' && jpegLsStream[position + 3] == 'x' &&
+                    jpegLsStream[position + 4] != 0)
+            {
+                IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "JPEG-LS color transforms are not supported");
+            }
+            break;
+        }
+
+        case 0xda: // SOS
+        {
+            if(componentsIds.empty())
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "JPEG-LS SOS tag found before the SOF tag");
+            }
+            const std::uint32_t componentsNumber(segmentLength > 2 ? jpegLsStream[position] : 0);
+            if(componentsNumber == 0 || componentsNumber > componentsIds.size() || segmentLength != 6 + 2 * componentsNumber)
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS SOS tag");
+            }
+
+            std::vector<std::uint32_t> scanChannels;
+            for(std::uint32_t scanComponents(0); scanComponents != componentsNumber; ++scanComponents)
+            {
+                const size_t componentPosition(position + 1 + 2 * scanComponents);
+                std::vector<std::uint8_t>::const_iterator findComponent(std::find(componentsIds.begin(), componentsIds.end(), jpegLsStream[componentPosition]));
+                if(findComponent == componentsIds.end())
+                {
+                    IMEBRA_THROW(CodecCorruptedFileError, "Corrupted SOS tag found (scan component not specified by the SOF tag)");
+                }
+                if(jpegLsStream[componentPosition + 1] != 0)
+                {
+                    IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "JPEG-LS mapping tables are not supported");
+                }
+                scanChannels.push_back((std::uint32_t)(findComponent - componentsIds.begin()));
+            }
+
+            const size_t parametersPosition(position + 1 + 2 * componentsNumber);
+            const std::int32_t near(jpegLsStream[parametersPosition]);
+            const std::uint8_t interleave(jpegLsStream[parametersPosition + 1]);
+            if(interleave > 2 || (interleave == 0 && componentsNumber != 1))
+            {
+                IMEBRA_THROW(CodecCorruptedFileError, "Corrupted JPEG-LS SOS tag (wrong interleave mode)");
+            }
+            if(interleave == 2 && componentsNumber > 4)
+            {
+                IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "JPEG-LS sample interleaved scans cannot have more than 4 components");
+            }
+            if(jpegLsStream[parametersPosition + 2] != 0)
+            {
+                IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "JPEG-LS point transform is not supported");
+            }
+
+            const jpegLsParameters parameters(getJpegLsParameters(precision, near, preset));
+
+            // The coded data ends at the next marker
+            ///////////////////////////////////////////////////////////
+            size_t scanEnd(segmentEnd);
+            while(scanEnd < streamSize && (jpegLsStream[scanEnd] != 0xff || scanEnd + 1 == streamSize || jpegLsStream[scanEnd + 1] < 0x80))
+            {
+                ++scanEnd;
+            }
+
+            jpegLsBitReader reader(jpegLsStream.data() + segmentEnd, jpegLsStream.data() + scanEnd);
+            codeScan(reader, parameters, imageWidth, imageHeight, componentsNumber, interleave == 2,
+                     [&](std::uint32_t scanY, std::uint32_t component, const std::int32_t* pLine)
+            {
+                samplesType_t* pSamples(pImageSamples + (size_t)scanY * imageWidth * channelsNumber + scanChannels[component]);
+                for(std::uint32_t scanX(0); scanX != imageWidth; ++scanX)
+                {
+                    *pSamples = (samplesType_t)((std::uint32_t)pLine[scanX] & mask);
+                    pSamples += channelsNumber;
+                }
+            });
+
+            ++decodedScans;
+            position = scanEnd;
+            continue;
+        }
+
+        default:
+            if(marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc)
+            {
+                IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "The stream contains a jpeg image that is not compressed with JPEG-LS");
+            }
+            break;
+        }
+
+        position = segmentEnd;
+    }
+
+    if(decodedScans == 0)
+    {
+        IMEBRA_THROW(CodecCorruptedFileError, "The JPEG-LS stream does not contain any scan");
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return the default planar configuration
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+bool jpegLsImageCodec::defaultInterleaved() const
+{
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Encode a JPEG-LS stream
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+template<typename samplesType_t>
+void jpegLsImageCodec::writeJpegLs(
+        std::vector<std::uint8_t>* pJpegLsStream,
+        const samplesType_t* pImageSamples,
+        std::uint32_t imageWidth,
+        std::uint32_t imageHeight,
+        std::uint32_t channelsNumber,
+        std::uint32_t precision,
+        std::uint32_t mask,
+        std::int32_t near,
+        bool bInterleaved)
+{
+    IMEBRA_FUNCTION_START();
+
+    const jpegLsParameters parameters(getJpegLsParameters(precision, near, jpegLsParameters()));
+
+    // SOI and SOF55
+    ///////////////////////////////////////////////////////////
+    writeMarker(pJpegLsStream, 0xd8, 0);
+    writeMarker(pJpegLsStream, 0xf7, 8 + 3 * channelsNumber);
+    pJpegLsStream->push_back((std::uint8_t)precision);
+    pJpegLsStream->push_back((std::uint8_t)(imageHeight >> 8));
+    pJpegLsStream->push_back((std::uint8_t)imageHeight);
+    pJpegLsStream->push_back((std::uint8_t)(imageWidth >> 8));
+    pJpegLsStream->push_back((std::uint8_t)imageWidth);
+    pJpegLsStream->push_back((std::uint8_t)channelsNumber);
+    for(std::uint32_t channel(0); channel != channelsNumber; ++channel)
+    {
+        pJpegLsStream->push_back((std::uint8_t)(channel + 1));
+        pJpegLsStream->push_back(0x11);
+        pJpegLsStream->push_back(0);
+    }
+
+    // Interleaved images are coded in one sample interleaved
+    //  scan, planar images in one scan per channel
+    ///////////////////////////////////////////////////////////
+    const bool bSampleInterleaved(bInterleaved && channelsNumber > 1);
+    const std::uint32_t scanChannelsNumber(bSampleInterleaved ? channelsNumber : 1);
+    for(std::uint32_t firstChannel(0); firstChannel != channelsNumber; firstChannel += scanChannelsNumber)
+    {
+        writeMarker(pJpegLsStream, 0xda, 6 + 2 * scanChannelsNumber);
+        pJpegLsStream->push_back((std::uint8_t)scanChannelsNumber);
+        for(std::uint32_t channel(firstChannel); channel != firstChannel + scanChannelsNumber; ++channel)
+        {
+            pJpegLsStream->push_back((std::uint8_t)(channel + 1));
+            pJpegLsStream->push_back(0);
+        }
+        pJpegLsStream->push_back((std::uint8_t)near);
+        pJpegLsStream->push_back(bSampleInterleaved ? 2 : 0);
+        pJpegLsStream->push_back(0);
+
+        jpegLsBitWriter writer(pJpegLsStream);
+        codeScan(writer, parameters, imageWidth, imageHeight, scanChannelsNumber, bSampleInterleaved,
+                 [&](std::uint32_t scanY, std::uint32_t component, std::int32_t* pLine)
+        {
+            const samplesType_t* pSamples(pImageSamples + (size_t)scanY * imageWidth * channelsNumber + firstChannel + component);
+            for(std::uint32_t scanX(0); scanX != imageWidth; ++scanX)
+            {
+                pLine[scanX] = (std::int32_t)((std::uint32_t)*pSamples & mask);
+                pSamples += channelsNumber;
+            }
+        });
+        writer.flush();
+    }
+
+    writeMarker(pJpegLsStream, 0xd9, 0);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Insert an image into a Dicom structure
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void jpegLsImageCodec::setImage(
+        std::shared_ptr<streamWriter> pDestStream,
+        std::shared_ptr<const image> pImage,
+        const std::string& transferSyntax,
+        imageQuality_t imageQuality,
+        std::uint32_t /* allocatedBits */,
+        bool bSubSampledX,
+        bool bSubSampledY,
+        bool bInterleaved,
+        bool /* b2Complement */) const
+{
+    IMEBRA_FUNCTION_START();
+
+    if(!canHandleTransferSyntax(transferSyntax))
+    {
+        IMEBRA_THROW(CodecWrongTransferSyntaxError, "Cannot handle the transfer syntax");
+    }
+
+    if(bSubSampledX || bSubSampledY)
+    {
+        IMEBRA_THROW(std::logic_error, "Cannot write subsampled JPEG-LS compressed images");
+    }
+
+    const std::uint32_t highBit(pImage->getHighBit());
+    if(highBit >= 16)
+    {
+        IMEBRA_THROW(JpegCodecCannotHandleSyntaxError, "JPEG-LS images cannot have more than 16 bits per sample");
+    }
+
+    std::uint32_t imageWidth, imageHeight;
+    pImage->getSize(&imageWidth, &imageHeight);
+    const std::uint32_t channelsNumber(pImage->getChannelsNumber());
+
+    // JPEG-LS needs at least 2 bits per sample
+    ///////////////////////////////////////////////////////////
+    const std::uint32_t precision(std::max(2u, highBit + 1));
+    const std::uint32_t mask((1u << (highBit + 1)) - 1);
+
+    // The near-lossless error grows by one 8 bit level for
+    //  each step down in the quality scale
+    ///////////////////////////////////////////////////////////
+    std::int32_t near(0);
+    if(transferSyntax == "1.2.840.10008.1.2.4.81")
+    {
+        near = (std::int32_t)((std::uint32_t)imageQuality / (std::uint32_t)imageQuality_t::high);
+        if(precision > 8)
+        {
+            near <<= (precision - 8);
+        }
+        near = std::min(near, std::min(255, (std::int32_t)((1u << precision) - 1) / 2));
+    }
+
+    std::shared_ptr<handlers::readingDataHandlerNumericBase> imageHandler = pImage->getReadingDataHandler();
+    const std::uint8_t* pImageMemory(imageHandler->getMemoryBuffer());
+
+    std::vector<std::uint8_t> jpegLsStream;
+    switch(pImage->getDepth())
+    {
+    case bitDepth_t::depthU8:
+    case bitDepth_t::depthS8:
+        writeJpegLs(&jpegLsStream, pImageMemory, imageWidth, imageHeight, channelsNumber, precision, mask, near, bInterleaved);
+        break;
+    case bitDepth_t::depthU16:
+    case bitDepth_t::depthS16:
+        writeJpegLs(&jpegLsStream, reinterpret_cast<const std::uint16_t*>(pImageMemory), imageWidth, imageHeight, channelsNumber, precision, mask, near, bInterleaved);
+        break;
+    default:
+        writeJpegLs(&jpegLsStream, reinterpret_cast<const std::uint32_t*>(pImageMemory), imageWidth, imageHeight, channelsNumber, precision, mask, near, bInterleaved);
+        break;
+    }
+
+    pDestStream->write(jpegLsStream.data(), jpegLsStream.size());
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Returns true if the codec can handle the transfer
+//  syntax
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+bool jpegLsImageCodec::canHandleTransferSyntax(const std::string& transferSyntax) const
+{
+    return(
+                transferSyntax == "1.2.840.10008.1.2.4.80" ||  // JPEG-LS lossless
+                transferSyntax == "1.2.840.10008.1.2.4.81");   // JPEG-LS near-lossless
+}
+
+
+////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////
+//
+//
+// Returns true if the transfer syntax has to be
+//  encapsulated
+//
+//
+////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////
+bool jpegLsImageCodec::encapsulated(const std::string& transferSyntax) const
+{
+    IMEBRA_FUNCTION_START();
+
+    if(!canHandleTransferSyntax(transferSyntax))
+    {
+        IMEBRA_THROW(CodecWrongTransferSyntaxError, "Cannot handle the transfer syntax");
+    }
+    return true;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Suggest the number of allocated bits
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::uint32_t jpegLsImageCodec::suggestAllocatedBits(const std::string& /* transferSyntax */, std::uint32_t highBit) const
+{
+    return (highBit + 8) & 0xfffffff8;
+}
+
+} // namespace codecs
+
+} // namespace implementation
+
+} // namespace imebra
@@ -0,0 +1,153 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file jpegLsImageCodecImpl.h
+    \brief Declaration of the class jpegLsImageCodec.
+
+*/
+
+#if !defined(imebraJpegLsImageCodec_7E3B1D44_5C2A_4F0E_9B86_0D61A2C9F371__INCLUDED_)
+#define imebraJpegLsImageCodec_7E3B1D44_5C2A_4F0E_9B86_0D61A2C9F371__INCLUDED_
+
+#include "imageCodecImpl.h"
+#include <vector>
+
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+namespace codecs
+{
+
+/// \addtogroup group_codecs
+///
+/// @{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief The JPEG-LS codec.
+///
+/// This class is used to decode and encode images
+///  compressed with JPEG-LS (ITU T.87), lossless
+///  (transfer syntax 1.2.840.10008.1.2.4.80) or
+///  near-lossless (transfer syntax 1.2.840.10008.1.2.4.81).
+///
+/// The codec decodes the non interleaved, the line
+///  interleaved and the sample interleaved modes.
+/// Interleaved images are encoded in sample interleaved
+///  mode, planar images are encoded with one scan per
+///  channel.
+///
+/// When encoding with the near-lossless transfer syntax
+///  the maximum error allowed for each sample (the NEAR
+///  parameter) is derived from the image quality: it is
+///  0 for imageQuality_t::veryHigh and grows by one 8 bit
+///  level for each step down in the quality scale.
+///
+/// Mapping tables, restart intervals and color
+///  transforms are not supported.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class jpegLsImageCodec : public imageCodec
+{
+public:
+    // Get an image from a dicom structure
+    ///////////////////////////////////////////////////////////
+    virtual std::shared_ptr<image> getImage(const std::string& transferSyntax,
+                                            const std::string& colorSpace,
+                                            std::uint32_t channelsNumber,
+                                            std::uint32_t imageWidth,
+                                            std::uint32_t imageHeight,
+                                            bool bSubSampledX,
+                                            bool bSubSampledY,
+                                            bool bInterleaved,
+                                            bool b2Complement,
+                                            std::uint8_t allocatedBits,
+                                            std::uint8_t storedBits,
+                                            std::uint8_t highBit,
+                                            std::shared_ptr<streamReader> pSourceStream) const override;
+
+    // Return the default planar configuration
+    ///////////////////////////////////////////////////////////
+    virtual bool defaultInterleaved() const override;
+
+    // Write an image into a dicom structure
+    ///////////////////////////////////////////////////////////
+    virtual void setImage(
+        std::shared_ptr<streamWriter> pDestStream,
+        std::shared_ptr<const image> pImage,
+        const std::string& transferSyntax,
+        imageQuality_t imageQuality,
+        std::uint32_t allocatedBits,
+        bool bSubSampledX,
+        bool bSubSampledY,
+        bool bInterleaved,
+        bool b2Complement) const override;
+
+    // Returns true if the codec can handle the transfer
+    //  syntax
+    ///////////////////////////////////////////////////////////
+    virtual bool canHandleTransferSyntax(const std::string& transferSyntax) const override;
+
+    // Returns true if the transfer syntax has to be
+    //  encapsulated
+    //
+    ///////////////////////////////////////////////////////////
+    virtual bool encapsulated(const std::string& transferSyntax) const override;
+
+    // Returns the suggested allocated bits
+    ///////////////////////////////////////////////////////////
+    virtual std::uint32_t suggestAllocatedBits(const std::string& transferSyntax, std::uint32_t highBit) const override;
+
+protected:
+    // Decode the JPEG-LS stream directly into the image's
+    //  buffer
+    ///////////////////////////////////////////////////////////
+    template<typename samplesType_t>
+    static void readJpegLs(
+            const std::vector<std::uint8_t>& jpegLsStream,
+            samplesType_t* pImageSamples,
+            std::uint32_t imageWidth,
+            std::uint32_t imageHeight,
+            std::uint32_t channelsNumber,
+            std::uint32_t mask);
+
+    // Encode the image's buffer into a JPEG-LS stream
+    ///////////////////////////////////////////////////////////
+    template<typename samplesType_t>
+    static void writeJpegLs(
+            std::vector<std::uint8_t>* pJpegLsStream,
+            const samplesType_t* pImageSamples,
+            std::uint32_t imageWidth,
+            std::uint32_t imageHeight,
+            std::uint32_t channelsNumber,
+            std::uint32_t precision,
+            std::uint32_t mask,
+            std::int32_t near,
+            bool bInterleaved);
+};
+
+
+/// @}
+
+} // namespace codecs
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraJpegLsImageCodec_7E3B1D44_5C2A_4F0E_9B86_0D61A2C9F371__INCLUDED_)
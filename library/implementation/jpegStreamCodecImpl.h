@@ -56,7 +56,7 @@ public:
 protected:
 	// Read a jpeg stream and build a Dicom dataset
 	///////////////////////////////////////////////////////////
-    virtual void readStream(std::shared_ptr<streamReader> pSourceStream, std::shared_ptr<dataSet> pDataSet, std::uint32_t maxSizeBufferLoad = 0xffffffff) const override;
+    virtual void readStream(std::shared_ptr<streamReader> pSourceStream, std::shared_ptr<dataSet> pDataSet, std::uint32_t maxSizeBufferLoad = 0xffffffff, std::uint32_t stopTag = 0xffffffff) const override;
 
 	// Write a Dicom dataset as a Jpeg stream
 	///////////////////////////////////////////////////////////
@@ -0,0 +1,197 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file loadedMemoryCacheImpl.cpp
+    \brief Implementation of the class loadedMemoryCache.
+
+*/
+
+#include "loadedMemoryCacheImpl.h"
+#include "memoryImpl.h"
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Constructor
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+loadedMemoryCache::loadedMemoryCache(size_t maxSize):
+    m_maxSize(maxSize), m_actualSize(0)
+{
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return the only instance of the cache
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+loadedMemoryCache& loadedMemoryCache::getLoadedMemoryCache()
+{
+    static loadedMemoryCache cache(IMEBRA_LOADED_MEMORY_CACHE_MAX_SIZE);
+    return cache;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Set the maximum size
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void loadedMemoryCache::setMaxSize(size_t maxSize)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_maxSize = maxSize;
+    shrink();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return the size of the cached memory
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+size_t loadedMemoryCache::getSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_actualSize;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Insert a memory object or move it to the front of the
+//  list
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void loadedMemoryCache::touch(const std::shared_ptr<const memory>& pMemory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    tMemoryIndex::iterator findMemory(m_memoryIndex.find(pMemory.get()));
+    if(findMemory != m_memoryIndex.end())
+    {
+        m_memoryList.splice(m_memoryList.begin(), m_memoryList, findMemory->second);
+        return;
+    }
+
+    const size_t memorySize(pMemory->size());
+    if(memorySize == 0 || memorySize > m_maxSize)
+    {
+        return;
+    }
+
+    m_memoryList.push_front(pMemory);
+    m_memoryIndex[pMemory.get()] = m_memoryList.begin();
+    m_actualSize += memorySize;
+
+    shrink();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Remove a memory object
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void loadedMemoryCache::remove(const std::shared_ptr<const memory>& pMemory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    tMemoryIndex::iterator findMemory(m_memoryIndex.find(pMemory.get()));
+    if(findMemory == m_memoryIndex.end())
+    {
+        return;
+    }
+
+    m_actualSize -= pMemory->size();
+    m_memoryList.erase(findMemory->second);
+    m_memoryIndex.erase(findMemory);
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Release all the memory
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void loadedMemoryCache::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_memoryIndex.clear();
+    m_memoryList.clear();
+    m_actualSize = 0;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Release the least recently used memory until the
+//  size is within the limits
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void loadedMemoryCache::shrink()
+{
+    while(m_actualSize > m_maxSize)
+    {
+        const std::shared_ptr<const memory>& pOldest(m_memoryList.back());
+        m_actualSize -= pOldest->size();
+        m_memoryIndex.erase(pOldest.get());
+        m_memoryList.pop_back();
+    }
+}
+
+
+} // namespace implementation
+
+} // namespace imebra
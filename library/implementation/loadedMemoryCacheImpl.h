@@ -0,0 +1,150 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file loadedMemoryCacheImpl.h
+    \brief Declaration of the class loadedMemoryCache.
+
+*/
+
+#if !defined(imebraLoadedMemoryCache_3A1F0C52_8E4B_4D0A_9C27_61B5E0D4F218__INCLUDED_)
+#define imebraLoadedMemoryCache_3A1F0C52_8E4B_4D0A_9C27_61B5E0D4F218__INCLUDED_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#if(!defined IMEBRA_LOADED_MEMORY_CACHE_MAX_SIZE)
+    #define IMEBRA_LOADED_MEMORY_CACHE_MAX_SIZE 67108864
+#endif
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+class memory;
+
+/// \addtogroup group_dataset
+///
+/// @{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief Keeps alive the most recently used memory
+///         objects loaded on demand by the buffers.
+///
+/// Buffers larger than the maxSizeBufferLoad parameter
+///  passed to codecFactory::load() are read from the
+///  original stream only when they are accessed.
+/// Without this cache the data would be read again
+///  from the stream each time a handler is requested.
+///
+/// The cache is shared by all the buffers and is bounded
+///  by a maximum size in bytes: when the limit is
+///  exceeded then the least recently used memory objects
+///  are released.
+///
+/// One instance of this class is statically allocated
+///  by the library: use getLoadedMemoryCache() to
+///  retrieve it.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class loadedMemoryCache
+{
+    loadedMemoryCache(size_t maxSize);
+
+public:
+    /// \brief Return the only instance of the cache.
+    ///
+    ///////////////////////////////////////////////////////////
+    static loadedMemoryCache& getLoadedMemoryCache();
+
+    /// \brief Set the maximum size, in bytes, of the memory
+    ///         kept alive by the cache.
+    ///
+    /// If the current size exceeds the new maximum then the
+    ///  least recently used memory objects are released
+    ///  immediately.
+    ///
+    /// @param maxSize the maximum size in bytes. 0 disables
+    ///                the cache
+    ///
+    ///////////////////////////////////////////////////////////
+    void setMaxSize(size_t maxSize);
+
+    /// \brief Return the total size of the memory objects
+    ///         kept alive by the cache.
+    ///
+    /// @return the size of the cached memory, in bytes
+    ///
+    ///////////////////////////////////////////////////////////
+    size_t getSize() const;
+
+    /// \brief Insert a memory object in the cache or mark it
+    ///         as the most recently used one if it is already
+    ///         there.
+    ///
+    /// Memory objects larger than the cache's maximum size
+    ///  are ignored.
+    ///
+    /// @param pMemory the memory object to keep alive
+    ///
+    ///////////////////////////////////////////////////////////
+    void touch(const std::shared_ptr<const memory>& pMemory);
+
+    /// \brief Remove a memory object from the cache.
+    ///
+    /// @param pMemory the memory object to remove
+    ///
+    ///////////////////////////////////////////////////////////
+    void remove(const std::shared_ptr<const memory>& pMemory);
+
+    /// \brief Release all the memory objects kept alive by
+    ///         the cache.
+    ///
+    ///////////////////////////////////////////////////////////
+    void flush();
+
+private:
+    /// \brief Release the least recently used memory objects
+    ///         until the cache's size is within its limit.
+    ///
+    /// Must be called while m_mutex is locked.
+    ///
+    ///////////////////////////////////////////////////////////
+    void shrink();
+
+    mutable std::mutex m_mutex;
+
+    // Most recently used objects are at the front of the list
+    ///////////////////////////////////////////////////////////
+    typedef std::list<std::shared_ptr<const memory> > tMemoryList;
+    tMemoryList m_memoryList;
+
+    typedef std::map<const memory*, tMemoryList::iterator> tMemoryIndex;
+    tMemoryIndex m_memoryIndex;
+
+    size_t m_maxSize;
+    size_t m_actualSize;
+};
+
+/// @}
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraLoadedMemoryCache_3A1F0C52_8E4B_4D0A_9C27_61B5E0D4F218__INCLUDED_)
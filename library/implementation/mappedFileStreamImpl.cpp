@@ -0,0 +1,412 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file mappedFileStreamImpl.cpp
+    \brief Implementation of the memory mapped file stream.
+
+*/
+
+#include "mappedFileStreamImpl.h"
+#include "memoryImpl.h"
+#include "../include/imebra/exceptions.h"
+
+#include <cstring>
+#include <errno.h>
+#include <locale>
+#include <codecvt>
+
+#if defined(IMEBRA_WINDOWS)
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+//
+// fileMapping
+//
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+
+#if defined(IMEBRA_WINDOWS)
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Open and map a file (unicode)
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+fileMapping::fileMapping(const std::wstring& fileName):
+    m_pData(0), m_size(0), m_hFile(INVALID_HANDLE_VALUE), m_hMapping(0)
+{
+    IMEBRA_FUNCTION_START();
+
+    HANDLE hFile = ::CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if(hFile == INVALID_HANDLE_VALUE)
+    {
+        IMEBRA_THROW(StreamOpenError, "fileMapping::fileMapping failure - error code: " << ::GetLastError());
+    }
+    mapFile(hFile);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Open and map a file
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+fileMapping::fileMapping(const std::string& fileName):
+    m_pData(0), m_size(0), m_hFile(INVALID_HANDLE_VALUE), m_hMapping(0)
+{
+    IMEBRA_FUNCTION_START();
+
+    HANDLE hFile = ::CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if(hFile == INVALID_HANDLE_VALUE)
+    {
+        IMEBRA_THROW(StreamOpenError, "fileMapping::fileMapping failure - error code: " << ::GetLastError());
+    }
+    mapFile(hFile);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Map an open file
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void fileMapping::mapFile(void* hFile)
+{
+    IMEBRA_FUNCTION_START();
+
+    m_hFile = hFile;
+
+    LARGE_INTEGER fileSize;
+    if(!::GetFileSizeEx(m_hFile, &fileSize))
+    {
+        DWORD errorCode = ::GetLastError();
+        ::CloseHandle(m_hFile);
+        IMEBRA_THROW(StreamOpenError, "fileMapping::mapFile size failure - error code: " << errorCode);
+    }
+    m_size = (size_t)fileSize.QuadPart;
+
+    // Empty files cannot be mapped
+    ///////////////////////////////////////////////////////////
+    if(m_size == 0)
+    {
+        return;
+    }
+
+    m_hMapping = ::CreateFileMappingW(m_hFile, 0, PAGE_READONLY, 0, 0, 0);
+    if(m_hMapping == 0)
+    {
+        DWORD errorCode = ::GetLastError();
+        ::CloseHandle(m_hFile);
+        IMEBRA_THROW(StreamOpenError, "fileMapping::mapFile mapping failure - error code: " << errorCode);
+    }
+
+    m_pData = (const std::uint8_t*)::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+    if(m_pData == 0)
+    {
+        DWORD errorCode = ::GetLastError();
+        ::CloseHandle(m_hMapping);
+        ::CloseHandle(m_hFile);
+        IMEBRA_THROW(StreamOpenError, "fileMapping::mapFile view failure - error code: " << errorCode);
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Destructor
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+fileMapping::~fileMapping()
+{
+    if(m_pData != 0)
+    {
+        ::UnmapViewOfFile(m_pData);
+    }
+    if(m_hMapping != 0)
+    {
+        ::CloseHandle(m_hMapping);
+    }
+    ::CloseHandle(m_hFile);
+}
+
+#else
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Open and map a file (unicode)
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+fileMapping::fileMapping(const std::wstring& fileName):
+    m_pData(0), m_size(0)
+{
+    IMEBRA_FUNCTION_START();
+
+    // Convert the filename to UTF8
+    std::string utf8FileName(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>{}.to_bytes(fileName));
+
+    int fileDescriptor = ::open(utf8FileName.c_str(), O_RDONLY);
+    if(fileDescriptor < 0)
+    {
+        IMEBRA_THROW(StreamOpenError, "fileMapping::fileMapping failure - error code: " << errno);
+    }
+    mapFile(fileDescriptor);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Open and map a file
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+fileMapping::fileMapping(const std::string& fileName):
+    m_pData(0), m_size(0)
+{
+    IMEBRA_FUNCTION_START();
+
+    int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    if(fileDescriptor < 0)
+    {
+        IMEBRA_THROW(StreamOpenError, "fileMapping::fileMapping failure - error code: " << errno);
+    }
+    mapFile(fileDescriptor);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Map an open file. The file descriptor is closed
+//  before returning: the mapping stays valid until
+//  munmap is called
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void fileMapping::mapFile(int fileDescriptor)
+{
+    IMEBRA_FUNCTION_START();
+
+    struct stat fileStatus;
+    if(::fstat(fileDescriptor, &fileStatus) != 0)
+    {
+        int errorCode = errno;
+        ::close(fileDescriptor);
+        IMEBRA_THROW(StreamOpenError, "fileMapping::mapFile fstat failure - error code: " << errorCode);
+    }
+    m_size = (size_t)fileStatus.st_size;
+
+    // Empty files cannot be mapped
+    ///////////////////////////////////////////////////////////
+    if(m_size == 0)
+    {
+        ::close(fileDescriptor);
+        return;
+    }
+
+    void* pData = ::mmap(0, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    int errorCode = errno;
+    ::close(fileDescriptor);
+    if(pData == MAP_FAILED)
+    {
+        IMEBRA_THROW(StreamOpenError, "fileMapping::mapFile mmap failure - error code: " << errorCode);
+    }
+    m_pData = (const std::uint8_t*)pData;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Destructor
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+fileMapping::~fileMapping()
+{
+    if(m_pData != 0)
+    {
+        ::munmap((void*)m_pData, m_size);
+    }
+}
+
+#endif
+
+
+const std::uint8_t* fileMapping::data() const
+{
+    return m_pData;
+}
+
+size_t fileMapping::size() const
+{
+    return m_size;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+//
+// mappedFileStreamInput
+//
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+
+mappedFileStreamInput::mappedFileStreamInput(const std::string& fileName):
+    m_pMapping(std::make_shared<fileMapping>(fileName))
+{
+}
+
+mappedFileStreamInput::mappedFileStreamInput(const std::wstring& fileName):
+    m_pMapping(std::make_shared<fileMapping>(fileName))
+{
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Read raw data from the stream.
+// The mapping is immutable: no lock is necessary
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+size_t mappedFileStreamInput::read(size_t startPosition, std::uint8_t* pBuffer, size_t bufferLength)
+{
+    const size_t fileSize(m_pMapping->size());
+    if(startPosition >= fileSize)
+    {
+        return 0;
+    }
+
+    size_t readBytes(fileSize - startPosition);
+    if(readBytes > bufferLength)
+    {
+        readBytes = bufferLength;
+    }
+    ::memcpy(pBuffer, m_pMapping->data() + startPosition, readBytes);
+
+    return readBytes;
+}
+
+
+void mappedFileStreamInput::terminate()
+{
+}
+
+bool mappedFileStreamInput::seekable() const
+{
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return a memory object that references the mapped
+//  file. The memory object keeps the mapping alive
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+std::shared_ptr<const memory> mappedFileStreamInput::getMemoryView(size_t startPosition, size_t length) const
+{
+    IMEBRA_FUNCTION_START();
+
+    if(startPosition > m_pMapping->size() || length > m_pMapping->size() - startPosition)
+    {
+        return nullptr;
+    }
+
+    return std::make_shared<const memory>(m_pMapping, m_pMapping->data() + startPosition, length);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+size_t mappedFileStreamInput::getSize() const
+{
+    return m_pMapping->size();
+}
+
+} // namespace implementation
+
+} // namespace imebra
@@ -0,0 +1,120 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file mappedFileStreamImpl.h
+    \brief Declaration of the memory mapped file stream.
+
+*/
+
+#if !defined(imebraMappedFileStream_5A1C3E7B_94D2_4F60_8B1E_2C7D9A4E6F13__INCLUDED_)
+#define imebraMappedFileStream_5A1C3E7B_94D2_4F60_8B1E_2C7D9A4E6F13__INCLUDED_
+
+#include "baseStreamImpl.h"
+
+#include <string>
+#include <cstdint>
+
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief Maps a whole file in memory in read-only mode.
+///
+/// The file is unmapped when the object is destroyed.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class fileMapping
+{
+public:
+    fileMapping(const std::string& fileName);
+    fileMapping(const std::wstring& fileName);
+
+    virtual ~fileMapping();
+
+    const std::uint8_t* data() const;
+
+    size_t size() const;
+
+protected:
+    const std::uint8_t* m_pData;
+    size_t m_size;
+
+#if defined(IMEBRA_WINDOWS)
+    void* m_hFile;
+    void* m_hMapping;
+#endif
+
+private:
+#if defined(IMEBRA_WINDOWS)
+    void mapFile(void* hFile);
+#else
+    void mapFile(int fileDescriptor);
+#endif
+};
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief An input stream that reads from a memory mapped
+///         file.
+///
+/// The read operations do not lock any mutex and the
+///  stream can supply memory objects that reference
+///  the mapped file directly (see getMemoryView()):
+///  buffers loaded lazily from this stream don't copy
+///  their content.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class mappedFileStreamInput : public baseStreamInput
+{
+public:
+    mappedFileStreamInput(const std::string& fileName);
+    mappedFileStreamInput(const std::wstring& fileName);
+
+    ///////////////////////////////////////////////////////////
+    //
+    // Virtual stream's functions
+    //
+    ///////////////////////////////////////////////////////////
+    virtual size_t read(size_t startPosition, std::uint8_t* pBuffer, size_t bufferLength) override;
+
+    virtual void terminate() override;
+
+    virtual bool seekable() const override;
+
+    virtual std::shared_ptr<const memory> getMemoryView(size_t startPosition, size_t length) const override;
+
+    ///////////////////////////////////////////////////////////
+    //
+    // Returns the file size
+    //
+    ///////////////////////////////////////////////////////////
+    size_t getSize() const;
+
+protected:
+    const std::shared_ptr<const fileMapping> m_pMapping;
+};
+
+} // namespace implementation
+
+} // namespace imebra
+
+
+#endif // !defined(imebraMappedFileStream_5A1C3E7B_94D2_4F60_8B1E_2C7D9A4E6F13__INCLUDED_)
@@ -51,17 +51,30 @@ namespace implementation
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 memory::memory():
-    m_pMemoryBuffer(new stringUint8())
+    m_pMemoryBuffer(new stringUint8()),
+    m_pExternalData(0),
+    m_externalSize(0)
 {
 }
 
 memory::memory(stringUint8* pBuffer):
-    m_pMemoryBuffer(pBuffer)
+    m_pMemoryBuffer(pBuffer),
+    m_pExternalData(0),
+    m_externalSize(0)
 {
 }
 
 memory::memory(size_t initialSize):
-    m_pMemoryBuffer(memoryPoolGetter::getMemoryPoolGetter().getMemoryPoolLocal().getMemory(initialSize))
+    m_pMemoryBuffer(memoryPoolGetter::getMemoryPoolGetter().getMemoryPoolLocal().getMemory(initialSize)),
+    m_pExternalData(0),
+    m_externalSize(0)
+{
+}
+
+memory::memory(const std::shared_ptr<const void>& pOwner, const std::uint8_t* pData, size_t size):
+    m_pExternalOwner(pOwner),
+    m_pExternalData(pData),
+    m_externalSize(size)
 {
 }
 
@@ -77,10 +90,49 @@ memory::memory(size_t initialSize):
 ///////////////////////////////////////////////////////////
 memory::~memory()
 {
+    if(memoryPoolGetter::isMemoryPoolLocalReleased())
+    {
+        // m_pMemoryBuffer deletes the buffer
+        ///////////////////////////////////////////////////////////
+        return;
+    }
     memoryPoolGetter::getMemoryPoolGetter().getMemoryPoolLocal().reuseMemory(m_pMemoryBuffer.release());
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Copy the referenced external data into the owned
+//  buffer
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void memory::detachExternalData()
+{
+    IMEBRA_FUNCTION_START();
+
+    if(m_pExternalOwner == nullptr)
+    {
+        return;
+    }
+
+    m_pMemoryBuffer.reset(memoryPoolGetter::getMemoryPoolGetter().getMemoryPoolLocal().getMemory(m_externalSize));
+    if(m_externalSize != 0)
+    {
+        ::memcpy(&((*m_pMemoryBuffer)[0]), m_pExternalData, m_externalSize);
+    }
+
+    m_pExternalOwner.reset();
+    m_pExternalData = 0;
+    m_externalSize = 0;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -94,6 +146,8 @@ void memory::copyFrom(const std::shared_ptr<const memory>& sourceMemory)
 {
     IMEBRA_FUNCTION_START();
 
+    detachExternalData();
+
     if(m_pMemoryBuffer.get() == 0)
     {
         m_pMemoryBuffer.reset(new stringUint8);
@@ -115,6 +169,8 @@ void memory::copyFrom(const std::shared_ptr<const memory>& sourceMemory)
 ///////////////////////////////////////////////////////////
 void memory::clear()
 {
+    detachExternalData();
+
     if(m_pMemoryBuffer.get() != 0)
     {
         m_pMemoryBuffer->clear();
@@ -135,6 +191,8 @@ void memory::resize(size_t newSize)
 {
     IMEBRA_FUNCTION_START();
 
+    detachExternalData();
+
     if(m_pMemoryBuffer.get() == 0)
     {
         m_pMemoryBuffer.reset(new stringUint8((size_t)newSize, (std::uint8_t)0));
@@ -161,6 +219,8 @@ void memory::reserve(size_t reserveSize)
 {
     IMEBRA_FUNCTION_START();
 
+    detachExternalData();
+
     if(m_pMemoryBuffer.get() == 0)
     {
         m_pMemoryBuffer.reset(new stringUint8());
@@ -182,6 +242,10 @@ void memory::reserve(size_t reserveSize)
 ///////////////////////////////////////////////////////////
 size_t memory::size() const
 {
+    if(m_pExternalOwner != nullptr)
+    {
+        return m_externalSize;
+    }
     if(m_pMemoryBuffer.get() == 0)
     {
         return 0;
@@ -201,6 +265,8 @@ size_t memory::size() const
 ///////////////////////////////////////////////////////////
 std::uint8_t* memory::data()
 {
+    detachExternalData();
+
     if(m_pMemoryBuffer.get() == 0 || m_pMemoryBuffer->empty())
     {
         return 0;
@@ -210,6 +276,10 @@ std::uint8_t* memory::data()
 
 const std::uint8_t* memory::data() const
 {
+    if(m_pExternalOwner != nullptr)
+    {
+        return m_externalSize == 0 ? 0 : m_pExternalData;
+    }
     if(m_pMemoryBuffer.get() == 0 || m_pMemoryBuffer->empty())
     {
         return 0;
@@ -228,6 +298,10 @@ const std::uint8_t* memory::data() const
 ///////////////////////////////////////////////////////////
 bool memory::empty() const
 {
+    if(m_pExternalOwner != nullptr)
+    {
+        return m_externalSize == 0;
+    }
     return m_pMemoryBuffer.get() == 0 || m_pMemoryBuffer->empty();
 }
 
@@ -245,6 +319,8 @@ void memory::assign(const std::uint8_t* pSource, const size_t sourceLength)
 {
     IMEBRA_FUNCTION_START();
 
+    detachExternalData();
+
     if(m_pMemoryBuffer.get() == 0)
     {
         m_pMemoryBuffer.reset(new stringUint8);
@@ -258,6 +334,8 @@ void memory::assignRegion(const std::uint8_t* pSource, const size_t sourceLength
 {
     IMEBRA_FUNCTION_START();
 
+    detachExternalData();
+
     if(m_pMemoryBuffer.get() == 0)
     {
         m_pMemoryBuffer.reset(new stringUint8);
@@ -304,14 +382,11 @@ memoryPool::memoryPool(size_t memoryMinSize, size_t poolMaxSize):
 
 memoryPool::~memoryPool()
 {
-    while(m_actualSize != 0)
+    // Hand the unused memory to the other threads
+    ///////////////////////////////////////////////////////////
+    while(m_firstUsedCell != m_firstFreeCell)
     {
-        m_actualSize -= m_memorySize[m_firstUsedCell];
-        delete m_memoryPointer[m_firstUsedCell++];
-        if(m_firstUsedCell == m_memoryPointer.size())
-        {
-            m_firstUsedCell = 0;
-        }
+        releaseOldestMemory();
     }
 }
 
@@ -362,30 +437,46 @@ void memoryPool::reuseMemory(stringUint8* pString)
         m_firstFreeCell = 0;
     }
 
-    // Remove old unused memory objects
+    // Move old unused memory objects to the depot
     ///////////////////////////////////////////////////////////
     if(m_firstFreeCell == m_firstUsedCell)
     {
-        m_actualSize -= m_memorySize[m_firstUsedCell];
-        delete m_memoryPointer[m_firstUsedCell];
-        if(++m_firstUsedCell >= m_memorySize.size())
-        {
-            m_firstUsedCell = 0;
-        }
+        releaseOldestMemory();
     }
 
-    // Remove old unused memory objects if the total unused
-    //  memory is bigger than the specified parameters
+    // Move old unused memory objects to the depot if the
+    //  total unused memory is bigger than the specified
+    //  parameters
     ///////////////////////////////////////////////////////////
     while(m_actualSize != 0 && m_actualSize > m_maxMemoryUsageSize)
     {
-        m_actualSize -= m_memorySize[m_firstUsedCell];
-        delete m_memoryPointer[m_firstUsedCell];
-        if(++m_firstUsedCell >= IMEBRA_MEMORY_POOL_SLOTS)
-        {
-            m_firstUsedCell = 0;
-        }
+        releaseOldestMemory();
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Move the oldest memory object to the depot
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void memoryPool::releaseOldestMemory()
+{
+    IMEBRA_FUNCTION_START();
+
+    m_actualSize -= m_memorySize[m_firstUsedCell];
+    stringUint8* pMemory(m_memoryPointer[m_firstUsedCell]);
+    if(++m_firstUsedCell >= m_memorySize.size())
+    {
+        m_firstUsedCell = 0;
     }
+    memoryPoolDepot::getMemoryPoolDepot().reuseMemory(pMemory);
 
     IMEBRA_FUNCTION_END();
 }
@@ -471,6 +562,7 @@ stringUint8* memoryPool::getMemory(size_t requestedSize)
         ///////////////////////////////////////////////////////////
         std::unique_ptr<stringUint8> pMemory(m_memoryPointer[findCell]);
         m_actualSize -= m_memorySize[findCell];
+        memoryPoolDepot::getMemoryPoolDepot().addHit();
         if(findCell == m_firstUsedCell)
         {
             if(++m_firstUsedCell >= IMEBRA_MEMORY_POOL_SLOTS)
@@ -499,14 +591,285 @@ stringUint8* memoryPool::getMemory(size_t requestedSize)
         return pMemory.release();
     }
 
+    // Look into the memory released by the other threads
+    ///////////////////////////////////////////////////////////
+    memoryPoolDepot& depot(memoryPoolDepot::getMemoryPoolDepot());
+    stringUint8* pDepotMemory(depot.getMemory(requestedSize));
+    if(pDepotMemory != 0)
+    {
+        depot.addHit();
+        return pDepotMemory;
+    }
+
+    depot.addMiss();
     return new stringUint8(requestedSize, 0);
 
     IMEBRA_FUNCTION_END();
 }
 
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+//
+// memoryPoolDepot
+//
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Constructor
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+memoryPoolDepot::memoryPoolDepot(size_t poolMaxSize):
+    m_maxMemoryUsageSize(poolMaxSize),
+    m_actualSize(0),
+    m_hits(0),
+    m_misses(0)
+{
+}
+
+memoryPoolDepot::~memoryPoolDepot()
+{
+    flush();
+}
+
+memoryPoolDepot& memoryPoolDepot::getMemoryPoolDepot()
+{
+    static memoryPoolDepot depot(IMEBRA_MEMORY_POOL_DEPOT_MAX_SIZE);
+    return depot;
+}
+
+void memoryPoolDepot::setMaxMemory(size_t poolMaxSize)
+{
+    m_maxMemoryUsageSize = poolMaxSize;
+    if(m_actualSize > poolMaxSize)
+    {
+        flush();
+    }
+}
+
+size_t memoryPoolDepot::getUnusedMemorySize() const
+{
+    return m_actualSize;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Return the bin that stores the memory objects with
+//  the specified size (one bin per power of 2)
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+size_t memoryPoolDepot::getBinIndex(size_t memorySize)
+{
+    size_t binIndex(0);
+    while(memorySize > 1 && binIndex != IMEBRA_MEMORY_POOL_DEPOT_BINS - 1)
+    {
+        memorySize >>= 1;
+        ++binIndex;
+    }
+    return binIndex;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Store a memory object.
+// The list nodes are allocated and deleted outside the
+//  locks, so the new handler can flush the depot safely
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void memoryPoolDepot::reuseMemory(stringUint8* pMemoryToReuse)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::unique_ptr<stringUint8> pMemory(pMemoryToReuse);
+
+    const size_t memorySize(pMemory->size());
+    if(memorySize == 0 || memorySize > m_maxMemoryUsageSize)
+    {
+        return;
+    }
+
+    std::list<stringUint8*> insertMemory;
+    insertMemory.push_back(pMemory.get());
+
+    std::list<stringUint8*> discardMemory;
+    bin_t& bin(m_bins[getBinIndex(memorySize)]);
+    {
+        std::lock_guard<std::mutex> lock(bin.m_mutex);
+
+        bin.m_memory.splice(bin.m_memory.end(), insertMemory);
+        pMemory.release();
+        m_actualSize += memorySize;
+
+        // Discard the oldest memory in the bin if the depot
+        //  is full
+        ///////////////////////////////////////////////////////////
+        while(m_actualSize > m_maxMemoryUsageSize && !bin.m_memory.empty())
+        {
+            m_actualSize -= bin.m_memory.front()->size();
+            discardMemory.splice(discardMemory.end(), bin.m_memory, bin.m_memory.begin());
+        }
+    }
+
+    for(stringUint8* pDiscard: discardMemory)
+    {
+        delete pDiscard;
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Retrieve a memory object with the requested size
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+stringUint8* memoryPoolDepot::getMemory(size_t requestedSize)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(m_actualSize == 0)
+    {
+        return 0;
+    }
+
+    std::list<stringUint8*> foundMemory;
+    bin_t& bin(m_bins[getBinIndex(requestedSize)]);
+    {
+        std::lock_guard<std::mutex> lock(bin.m_mutex);
+
+        for(std::list<stringUint8*>::iterator scanMemory(bin.m_memory.begin()), endMemory(bin.m_memory.end());
+            scanMemory != endMemory;
+            ++scanMemory)
+        {
+            if((*scanMemory)->size() == requestedSize)
+            {
+                m_actualSize -= requestedSize;
+                foundMemory.splice(foundMemory.end(), bin.m_memory, scanMemory);
+                break;
+            }
+        }
+    }
+
+    if(foundMemory.empty())
+    {
+        return 0;
+    }
+
+    stringUint8* pMemory(foundMemory.front());
+    ::memset(&(pMemory->at(0)), 0, pMemory->size());
+    return pMemory;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Discard all the unused memory
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+bool memoryPoolDepot::flush()
+{
+    bool bCleared(false);
+    for(bin_t& bin: m_bins)
+    {
+        std::list<stringUint8*> discardMemory;
+        {
+            std::lock_guard<std::mutex> lock(bin.m_mutex);
+            discardMemory.swap(bin.m_memory);
+        }
+        for(stringUint8* pDiscard: discardMemory)
+        {
+            m_actualSize -= pDiscard->size();
+            delete pDiscard;
+            bCleared = true;
+        }
+    }
+    return bCleared;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Statistics
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void memoryPoolDepot::addHit()
+{
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+}
+
+void memoryPoolDepot::addMiss()
+{
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t memoryPoolDepot::getHitsCount() const
+{
+    return m_hits.load(std::memory_order_relaxed);
+}
+
+size_t memoryPoolDepot::getMissesCount() const
+{
+    return m_misses.load(std::memory_order_relaxed);
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+//
+// memoryPoolGetter
+//
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+
 memoryPoolGetter::memoryPoolGetter()
 {
+    // Make sure that the depot outlives the getter
+    ///////////////////////////////////////////////////////////
+    memoryPoolDepot::getMemoryPoolDepot();
+
     m_oldNewHandler = std::set_new_handler(memoryPoolGetter::newHandler);
 #ifdef __APPLE__
     ::pthread_key_create(&m_key, &memoryPoolGetter::deleteMemoryPool);
@@ -528,7 +891,13 @@ memoryPoolGetter& memoryPoolGetter::getMemoryPoolGetter()
 }
 
 #ifndef __APPLE__
-thread_local std::unique_ptr<memoryPool> memoryPoolGetter::m_pool = std::unique_ptr<memoryPool>();
+thread_local memoryPoolGetter::localMemoryPool memoryPoolGetter::m_pool;
+thread_local bool memoryPoolGetter::m_bPoolReleased = false;
+
+memoryPoolGetter::localMemoryPool::~localMemoryPool()
+{
+    m_bPoolReleased = true;
+}
 #endif
 
 memoryPool& memoryPoolGetter::getMemoryPoolLocal()
@@ -544,16 +913,25 @@ memoryPool& memoryPoolGetter::getMemoryPoolLocal()
     }
     return *pPool;
 #else
-    if(m_pool.get() == 0)
+    if(m_pool.m_pPool.get() == 0)
     {
-        m_pool.reset(new memoryPool(IMEBRA_MEMORY_POOL_MIN_SIZE, IMEBRA_MEMORY_POOL_MAX_SIZE));
+        m_pool.m_pPool.reset(new memoryPool(IMEBRA_MEMORY_POOL_MIN_SIZE, IMEBRA_MEMORY_POOL_MAX_SIZE));
     }
-    return *(m_pool.get());
+    return *(m_pool.m_pPool.get());
 #endif
 
     IMEBRA_FUNCTION_END();
 }
 
+bool memoryPoolGetter::isMemoryPoolLocalReleased()
+{
+#ifdef __APPLE__
+    return false;
+#else
+    return m_bPoolReleased;
+#endif
+}
+
 #ifdef __APPLE__
 void memoryPoolGetter::deleteMemoryPool(void* pMemoryPool)
 {
@@ -572,7 +950,9 @@ void memoryPoolGetter::deleteMemoryPool(void* pMemoryPool)
 ///////////////////////////////////////////////////////////
 void memoryPoolGetter::newHandler()
 {
-    if(!memoryPoolGetter::getMemoryPoolGetter().getMemoryPoolLocal().flush())
+    const bool bLocalCleared(memoryPoolGetter::getMemoryPoolGetter().getMemoryPoolLocal().flush());
+    const bool bDepotCleared(memoryPoolDepot::getMemoryPoolDepot().flush());
+    if(!bLocalCleared && !bDepotCleared)
     {
         throw ImebraBadAlloc();
     }
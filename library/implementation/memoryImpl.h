@@ -23,6 +23,8 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include <map>
 #include <memory>
 #include <array>
+#include <atomic>
+#include <mutex>
 
 #ifdef __APPLE__
 #include <pthread.h>
@@ -40,6 +42,12 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #if(!defined IMEBRA_MEMORY_POOL_MIN_SIZE)
     #define IMEBRA_MEMORY_POOL_MIN_SIZE 1024
 #endif
+#if(!defined IMEBRA_MEMORY_POOL_DEPOT_MAX_SIZE)
+    #define IMEBRA_MEMORY_POOL_DEPOT_MAX_SIZE 40000000
+#endif
+#if(!defined IMEBRA_MEMORY_POOL_DEPOT_BINS)
+    #define IMEBRA_MEMORY_POOL_DEPOT_BINS 48
+#endif
 
 
 namespace imebra
@@ -94,6 +102,24 @@ public:
 	///////////////////////////////////////////////////////////
     memory(size_t initialSize);
 
+    /// \brief Construct a read-only memory object that
+    ///        references data owned by another object
+    ///        (e.g. a memory mapped file).
+    ///
+    /// No data is copied: the const methods access the
+    ///  external data directly. The first call to a non-const
+    ///  method copies the referenced data into a private
+    ///  buffer.
+    ///
+    /// @param pOwner the object that owns the referenced
+    ///               data. It is kept alive as long as the
+    ///               memory object references it
+    /// @param pData  a pointer to the referenced data
+    /// @param size   the size of the referenced data, in bytes
+    ///
+    ///////////////////////////////////////////////////////////
+    memory(const std::shared_ptr<const void>& pOwner, const std::uint8_t* pData, size_t size);
+
     /// \brief Destruct the memory object.
     ///
     /// The owned buffer is passed to the memoryPool for
@@ -191,7 +217,17 @@ public:
 
 
 protected:
+    /// \brief Copy the referenced external data (if any)
+    ///        into the owned buffer.
+    ///
+    ///////////////////////////////////////////////////////////
+    void detachExternalData();
+
     std::unique_ptr<stringUint8> m_pMemoryBuffer;
+
+    std::shared_ptr<const void> m_pExternalOwner;
+    const std::uint8_t* m_pExternalData;
+    size_t m_externalSize;
 };
 
 
@@ -222,7 +258,9 @@ protected:
 ///  the amount of memory requested through getMemory().
 ///
 /// When a memory object is not used for a while then it
-///  is deleted permanently.
+///  is moved to the \ref memoryPoolDepot shared by all
+///  the threads, so it can be reused by a thread different
+///  from the one that released it.
 ///
 ///////////////////////////////////////////////////////////
 class memoryPool
@@ -281,6 +319,13 @@ protected:
 	///////////////////////////////////////////////////////////
     void reuseMemory(stringUint8* pMemoryToReuse);
 
+    /// \internal
+    /// \brief Move the oldest memory object to the
+    ///        \ref memoryPoolDepot.
+    ///
+    ///////////////////////////////////////////////////////////
+    void releaseOldestMemory();
+
     std::array<size_t, IMEBRA_MEMORY_POOL_SLOTS> m_memorySize;
     std::array<stringUint8*, IMEBRA_MEMORY_POOL_SLOTS>  m_memoryPointer;
 
@@ -292,6 +337,102 @@ protected:
 
 };
 
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief Stores the unused memory objects released by
+///         the thread local memory pools (see
+///         \ref memoryPool), so they can be reused by any
+///         thread.
+///
+/// The memory objects are grouped in bins by size class
+///  (power of 2); each bin has its own lock so threads
+///  requesting different sizes don't contend with each
+///  other.
+///
+/// The depot also collects the allocation statistics of
+///  all the memory pools.
+///
+/// One instance of this class is statically allocated
+///  by the library: call getMemoryPoolDepot() to
+///  retrieve it.
+///
+///////////////////////////////////////////////////////////
+class memoryPoolDepot
+{
+    memoryPoolDepot(size_t poolMaxSize);
+
+public:
+    ~memoryPoolDepot();
+
+    static memoryPoolDepot& getMemoryPoolDepot();
+
+    void setMaxMemory(size_t poolMaxSize);
+
+    size_t getUnusedMemorySize() const;
+
+    /// \brief Discard all the unused memory stored in the
+    ///        depot.
+    ///
+    /// \return true if some unused memory has been deleted,
+    ///         false if the depot was already empty
+    ///////////////////////////////////////////////////////////
+    bool flush();
+
+    /// \brief Retrieve a memory object with the requested
+    ///        size.
+    ///
+    /// @param requestedSize the size of the requested memory
+    /// @return a memory object with the requested size and
+    ///          filled with zeros, or 0 if the depot
+    ///          does not contain a memory object with the
+    ///          requested size
+    ///
+    ///////////////////////////////////////////////////////////
+    stringUint8* getMemory(size_t requestedSize);
+
+    /// \brief Store a memory object for later reuse.
+    ///
+    /// The depot takes ownership of the memory object and
+    ///  deletes it if the depot is full.
+    ///
+    /// @param pMemoryToReuse the memory object to store
+    ///
+    ///////////////////////////////////////////////////////////
+    void reuseMemory(stringUint8* pMemoryToReuse);
+
+    /// \brief Update the statistics with a request that
+    ///        was satisfied by reusing a memory object.
+    ///
+    ///////////////////////////////////////////////////////////
+    void addHit();
+
+    /// \brief Update the statistics with a request that
+    ///        needed a new allocation.
+    ///
+    ///////////////////////////////////////////////////////////
+    void addMiss();
+
+    size_t getHitsCount() const;
+
+    size_t getMissesCount() const;
+
+protected:
+    static size_t getBinIndex(size_t memorySize);
+
+    struct bin_t
+    {
+        std::mutex m_mutex;
+        std::list<stringUint8*> m_memory;
+    };
+
+    std::array<bin_t, IMEBRA_MEMORY_POOL_DEPOT_BINS> m_bins;
+
+    std::atomic<size_t> m_maxMemoryUsageSize;
+    std::atomic<size_t> m_actualSize;
+    std::atomic<size_t> m_hits;
+    std::atomic<size_t> m_misses;
+};
+
 class memoryPoolGetter
 {
 protected:
@@ -303,6 +444,17 @@ public:
 
     memoryPool& getMemoryPoolLocal();
 
+    /// \internal
+    /// \brief Returns true if the calling thread has already
+    ///        deleted its memory pool.
+    ///
+    /// This happens when a static object releases its memory
+    ///  while the process exits, after the thread local
+    ///  objects have been destroyed.
+    ///
+    ///////////////////////////////////////////////////////////
+    static bool isMemoryPoolLocalReleased();
+
 protected:
 #ifdef __APPLE__
     static void deleteMemoryPool(void* pMemoryPool);
@@ -319,7 +471,21 @@ protected:
     static void newHandler();
 
 #ifndef __APPLE__
-    thread_local static std::unique_ptr<memoryPool> m_pool;
+    /// \internal
+    /// \brief Owns the thread's memory pool and records its
+    ///        deletion.
+    ///
+    ///////////////////////////////////////////////////////////
+    class localMemoryPool
+    {
+    public:
+        ~localMemoryPool();
+
+        std::unique_ptr<memoryPool> m_pPool;
+    };
+
+    thread_local static localMemoryPool m_pool;
+    thread_local static bool m_bPoolReleased;
 #endif
 };
 
@@ -97,6 +97,12 @@ void memoryStreamOutput::write(size_t startPosition, const std::uint8_t* pBuffer
 }
 
 
+bool memoryStreamOutput::seekable() const
+{
+    return true;
+}
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
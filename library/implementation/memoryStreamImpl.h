@@ -96,6 +96,8 @@ public:
     ///////////////////////////////////////////////////////////
     virtual void write(size_t startPosition, const std::uint8_t* pBuffer, size_t bufferLength) override;
 
+    virtual bool seekable() const override;
+
 protected:
     std::shared_ptr<memory> m_memory;
 
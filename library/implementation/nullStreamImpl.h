@@ -52,6 +52,11 @@ public:
 	///////////////////////////////////////////////////////////
     virtual void write(size_t, const std::uint8_t*, size_t)  override
     {}
+
+    virtual bool seekable() const override
+    {
+        return true;
+    }
 };
 
 } // namespace implementation
@@ -0,0 +1,219 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file parallelTasksImpl.cpp
+    \brief Implementation of the function that runs independent tasks on
+           several threads.
+
+*/
+
+#include "parallelTasksImpl.h"
+#include "exceptionImpl.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+namespace
+{
+
+// Additional threads currently running parallel tasks
+///////////////////////////////////////////////////////////
+std::atomic<size_t> runningThreads(0);
+
+///////////////////////////////////////////////////////////
+//
+// Return the maximum number of additional threads
+//
+///////////////////////////////////////////////////////////
+size_t getThreadsLimit()
+{
+    if(IMEBRA_PARALLEL_THREADS_LIMIT != 0)
+    {
+        return (size_t)IMEBRA_PARALLEL_THREADS_LIMIT;
+    }
+    return (size_t)std::max(std::thread::hardware_concurrency(), 1u) - 1;
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+/// \brief The additional threads used by one call to
+///        runParallelWorkers().
+///
+/// The threads are reserved from the process' budget by
+///  the constructor; the destructor joins the started
+///  threads and returns all the reserved ones to the
+///  budget.
+///
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+class additionalThreads
+{
+public:
+    additionalThreads(size_t requestedThreads): m_reservedThreads(0)
+    {
+        const size_t threadsLimit(getThreadsLimit());
+        size_t running(runningThreads.load());
+        for(;;)
+        {
+            const size_t available(threadsLimit > running ? threadsLimit - running : 0);
+            const size_t reserve(std::min(requestedThreads, available));
+            if(reserve == 0 || runningThreads.compare_exchange_weak(running, running + reserve))
+            {
+                m_reservedThreads = reserve;
+                return;
+            }
+        }
+    }
+
+    additionalThreads(const additionalThreads&) = delete;
+    additionalThreads& operator=(const additionalThreads&) = delete;
+
+    ~additionalThreads()
+    {
+        for(std::thread& thread: m_threads)
+        {
+            thread.join();
+        }
+        runningThreads -= m_reservedThreads;
+    }
+
+    // Start the reserved threads. Stops at the first thread
+    //  that cannot be started: its work is done by the
+    //  threads already running
+    ///////////////////////////////////////////////////////////
+    void start(const std::function<void()>& threadFunction)
+    {
+        try
+        {
+            m_threads.reserve(m_reservedThreads);
+            while(m_threads.size() < m_reservedThreads)
+            {
+                m_threads.emplace_back(threadFunction);
+            }
+        }
+        catch(...)
+        {
+        }
+    }
+
+private:
+    size_t m_reservedThreads;
+    std::vector<std::thread> m_threads;
+};
+
+} // anonymous namespace
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Run the tasks on the calling thread and on the
+//  additional threads available
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void runParallelWorkers(size_t tasksCount, size_t threadsCount, const std::function<std::function<void(size_t)>()>& createWorker)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(tasksCount == 0)
+    {
+        return;
+    }
+
+    if(threadsCount == 0)
+    {
+        threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threadsCount = std::min(threadsCount, tasksCount);
+
+    std::atomic<size_t> nextTask(0);
+    std::exception_ptr pException;
+    std::mutex exceptionMutex;
+
+    // Each thread executes the next task not yet taken by
+    //  another thread. After an exception the remaining
+    //  tasks are skipped
+    ///////////////////////////////////////////////////////////
+    auto runTasks = [tasksCount, &createWorker, &nextTask, &pException, &exceptionMutex]()
+    {
+        try
+        {
+            const std::function<void(size_t)> worker(createWorker());
+            for(size_t task(nextTask++); task < tasksCount; task = nextTask++)
+            {
+                worker(task);
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(exceptionMutex);
+            if(pException == nullptr)
+            {
+                pException = std::current_exception();
+            }
+            nextTask = tasksCount;
+        }
+    };
+
+    {
+        additionalThreads threads(threadsCount - 1);
+        threads.start(runTasks);
+        runTasks();
+    }
+
+    if(pException != nullptr)
+    {
+        std::rethrow_exception(pException);
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+//
+//
+// Run the same function for all the tasks
+//
+//
+///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+void runParallelTasks(size_t tasksCount, size_t threadsCount, const std::function<void(size_t)>& task)
+{
+    IMEBRA_FUNCTION_START();
+
+    runParallelWorkers(tasksCount, threadsCount, [&task]()
+    {
+        return task;
+    });
+
+    IMEBRA_FUNCTION_END();
+}
+
+} // namespace implementation
+
+} // namespace imebra
@@ -0,0 +1,99 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file parallelTasksImpl.h
+    \brief Declaration of the function that runs independent tasks on
+           several threads.
+
+*/
+
+#if !defined(imebraParallelTasks_8C2D4E61_5A3F_4B1E_B7D0_2F96E3A1C845__INCLUDED_)
+#define imebraParallelTasks_8C2D4E61_5A3F_4B1E_B7D0_2F96E3A1C845__INCLUDED_
+
+#include <cstddef>
+#include <functional>
+
+// Maximum number of additional threads that run the
+//  parallel tasks at the same time in the whole process.
+//  0 means one less than the number of cores (the calling
+//  threads execute the tasks too)
+///////////////////////////////////////////////////////////
+#if(!defined IMEBRA_PARALLEL_THREADS_LIMIT)
+    #define IMEBRA_PARALLEL_THREADS_LIMIT 0
+#endif
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///////////////////////////////////////////////////////////
+/// \brief Execute a set of independent tasks using
+///        several threads.
+///
+/// The calling thread executes the tasks together with up
+///  to threadsCount - 1 additional threads. Each thread
+///  executes the next task not yet taken by another
+///  thread.
+///
+/// The additional threads are taken from a budget shared
+///  by the whole process (see
+///  IMEBRA_PARALLEL_THREADS_LIMIT): when the function is
+///  called by a task of another parallel execution (for
+///  instance a jpeg frame decoded by DataSet::getImages())
+///  the budget is usually exhausted and the calling thread
+///  executes all the tasks. If a thread cannot be started
+///  then the tasks are executed by the threads already
+///  running.
+///
+/// All the threads are joined before the function returns,
+///  also when a task throws. The first exception thrown by a
+///  task is rethrown to the caller; the tasks not yet
+///  started are skipped.
+///
+/// \param tasksCount   the number of tasks to execute
+/// \param threadsCount the maximum number of threads to use,
+///                     including the calling one. 0 means
+///                     one thread per core
+/// \param createWorker called once by each thread: returns
+///                     the function that the thread calls
+///                     with the index of each task it takes.
+///                     Can be used to allocate the state used
+///                     by a single thread
+///
+///////////////////////////////////////////////////////////
+void runParallelWorkers(size_t tasksCount, size_t threadsCount, const std::function<std::function<void(size_t)>()>& createWorker);
+
+///////////////////////////////////////////////////////////
+/// \brief Execute a set of independent tasks using
+///        several threads.
+///
+/// Like runParallelWorkers(), but all the threads call
+///  the same function.
+///
+/// \param tasksCount   the number of tasks to execute
+/// \param threadsCount the maximum number of threads to use,
+///                     including the calling one. 0 means
+///                     one thread per core
+/// \param task         the function called with the index
+///                     of each task
+///
+///////////////////////////////////////////////////////////
+void runParallelTasks(size_t tasksCount, size_t threadsCount, const std::function<void(size_t)>& task);
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraParallelTasks_8C2D4E61_5A3F_4B1E_B7D0_2F96E3A1C845__INCLUDED_)
@@ -0,0 +1,327 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file pduAssemblerImpl.cpp
+    \brief Implementation of the stream that assembles the incoming PDUs
+           from non-blocking reads.
+
+*/
+
+#include "pduAssemblerImpl.h"
+#include "acseImpl.h"
+#include "tcpSequenceStreamImpl.h"
+#include "exceptionImpl.h"
+#include "../include/imebra/exceptions.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+namespace
+{
+
+// Size of the chunks read from the socket, maximum amount
+//  of data read by a single call to receive() and amount
+//  of unread data that stops the reception
+///////////////////////////////////////////////////////////
+const size_t receiveChunkSize(65536);
+const size_t maxReceiveSize(1024 * 1024);
+const size_t maxBufferedSize(1024 * 1024);
+
+// Maximum length of the PDUs other than P-DATA-TF, which
+//  are not covered by the length negotiated with the peer
+///////////////////////////////////////////////////////////
+const size_t maxControlPDULength(1024 * 1024);
+
+///////////////////////////////////////////////////////////
+//
+// Read a big endian 32 bit value
+//
+///////////////////////////////////////////////////////////
+size_t readBigEndian32(const std::deque<std::uint8_t>& buffer, size_t position)
+{
+    return ((size_t)buffer[position] << 24) | ((size_t)buffer[position + 1] << 16) | ((size_t)buffer[position + 2] << 8) | (size_t)buffer[position + 3];
+}
+
+} // anonymous namespace
+
+
+pduAssembler::pduAssembler(
+        const std::shared_ptr<tcpSequenceStream>& pTcpStream,
+        std::uint32_t maxPDULength,
+        std::uint32_t readTimeoutSeconds,
+        const std::function<void()>& resumeReceiving):
+    m_pTcpStream(pTcpStream),
+    m_maxPDULength(maxPDULength),
+    m_readTimeoutSeconds(readTimeoutSeconds),
+    m_resumeReceiving(resumeReceiving),
+    m_readPosition(0),
+    m_completePosition(0),
+    m_bDatasetStarted(false),
+    m_bBlockingReads(false),
+    m_bPaused(false),
+    m_bClosed(false),
+    m_bTerminated(false)
+{
+    IMEBRA_FUNCTION_START();
+
+    m_pTcpStream->setBlockingMode(false);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Append the data waiting on the socket to the buffer
+//
+///////////////////////////////////////////////////////////
+bool pduAssembler::receive()
+{
+    IMEBRA_FUNCTION_START();
+
+    std::array<std::uint8_t, receiveChunkSize> receiveBuffer;
+
+    std::unique_lock<std::mutex> lock(m_lockBuffer);
+
+    try
+    {
+        for(size_t totalReceived(0); totalReceived < maxReceiveSize && m_buffer.size() < maxBufferedSize; /* increased in the loop */)
+        {
+            const size_t receivedBytes(m_pTcpStream->readAvailable(receiveBuffer.data(), receiveBuffer.size()));
+            if(receivedBytes == 0)
+            {
+                break;
+            }
+            m_buffer.insert(m_buffer.end(), receiveBuffer.begin(), receiveBuffer.begin() + (std::ptrdiff_t)receivedBytes);
+            totalReceived += receivedBytes;
+        }
+    }
+    catch(const StreamClosedError&)
+    {
+        m_bClosed = true;
+    }
+
+    const size_t completePDUs(m_completePDUs.size());
+    try
+    {
+        scanCompletePDUs();
+    }
+    catch(...)
+    {
+        m_notifyBuffer.notify_all();
+        throw;
+    }
+    if(m_completePDUs.size() != completePDUs || m_bClosed)
+    {
+        m_notifyBuffer.notify_all();
+    }
+
+    // Stop receiving while the reader consumes the complete
+    // PDUs
+    ///////////////////////////////////////////////////////////
+    m_bPaused = m_buffer.size() >= maxBufferedSize && !m_completePDUs.empty();
+
+    return !m_bPaused && !m_bClosed;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+size_t pduAssembler::getCompletePDUs() const
+{
+    std::unique_lock<std::mutex> lock(m_lockBuffer);
+
+    return m_completePDUs.size();
+}
+
+
+bool pduAssembler::isReceivingUnit() const
+{
+    std::unique_lock<std::mutex> lock(m_lockBuffer);
+
+    return m_bDatasetStarted || m_readPosition + m_buffer.size() != m_completePosition;
+}
+
+
+bool pduAssembler::isClosed() const
+{
+    std::unique_lock<std::mutex> lock(m_lockBuffer);
+
+    return m_bClosed;
+}
+
+
+void pduAssembler::setBlockingReads(bool bBlockingReads)
+{
+    std::unique_lock<std::mutex> lock(m_lockBuffer);
+
+    m_bBlockingReads = bBlockingReads;
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Return the data of the complete PDUs
+//
+///////////////////////////////////////////////////////////
+size_t pduAssembler::read(std::uint8_t* pBuffer, size_t bufferLength)
+{
+    IMEBRA_FUNCTION_START();
+
+    bool bResume(false);
+    size_t readBytes(0);
+    {
+        std::unique_lock<std::mutex> lock(m_lockBuffer);
+
+        // Wait for the next complete PDU
+        ///////////////////////////////////////////////////////////
+        const std::chrono::steady_clock::time_point endTime(std::chrono::steady_clock::now() + std::chrono::seconds(m_readTimeoutSeconds));
+        while(m_bBlockingReads && m_completePosition == m_readPosition && !m_bClosed && !m_bTerminated)
+        {
+            if(m_readTimeoutSeconds == 0)
+            {
+                m_notifyBuffer.wait(lock);
+            }
+            else if(m_notifyBuffer.wait_until(lock, endTime) == std::cv_status::timeout &&
+                    m_completePosition == m_readPosition && !m_bClosed && !m_bTerminated)
+            {
+                IMEBRA_THROW(StreamReadError, "Timeout expired while waiting for a PDU");
+            }
+        }
+
+        if(m_bTerminated)
+        {
+            return 0;
+        }
+
+        readBytes = (size_t)std::min((std::uint64_t)bufferLength, m_completePosition - m_readPosition);
+        std::copy(m_buffer.begin(), m_buffer.begin() + (std::ptrdiff_t)readBytes, pBuffer);
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + (std::ptrdiff_t)readBytes);
+        m_readPosition += readBytes;
+
+        while(!m_completePDUs.empty() && m_completePDUs.front() <= m_readPosition)
+        {
+            m_completePDUs.pop_front();
+        }
+
+        // Resume the reception when half of the buffer or all
+        // the complete PDUs have been consumed
+        ///////////////////////////////////////////////////////////
+        if(m_bPaused && (m_buffer.size() < maxBufferedSize / 2 || m_completePDUs.empty()))
+        {
+            m_bPaused = false;
+            bResume = true;
+        }
+    }
+
+    if(bResume)
+    {
+        m_resumeReceiving();
+    }
+
+    return readBytes;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+void pduAssembler::terminate()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_lockBuffer);
+        m_bTerminated = true;
+        m_notifyBuffer.notify_all();
+    }
+
+    m_pTcpStream->terminate();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Check the PDUs lengths and record the end of the
+//  complete PDUs
+//
+///////////////////////////////////////////////////////////
+void pduAssembler::scanCompletePDUs()
+{
+    IMEBRA_FUNCTION_START();
+
+    const size_t pduHeaderSize(6);
+    const size_t pDataValueHeaderSize(6);
+
+    for(;;)
+    {
+        // The reader doesn't read beyond the complete PDUs, so
+        // the incomplete ones are still in the buffer
+        ///////////////////////////////////////////////////////////
+        const size_t pduStart((size_t)(m_completePosition - m_readPosition));
+        if(m_buffer.size() - pduStart < pduHeaderSize)
+        {
+            return;
+        }
+
+        const bool bPData(m_buffer[pduStart] == (std::uint8_t)acsePDU::pduType_t::pData);
+        const size_t pduLength(readBigEndian32(m_buffer, pduStart + 2));
+        if(pduLength > (bPData ? (size_t)m_maxPDULength : maxControlPDULength))
+        {
+            IMEBRA_THROW(AcseCorruptedMessageError, "The PDU length (" << pduLength << ") exceeds the maximum length");
+        }
+        if(m_buffer.size() - pduStart - pduHeaderSize < pduLength)
+        {
+            return;
+        }
+        m_completePosition += pduHeaderSize + pduLength;
+        m_completePDUs.push_back(m_completePosition);
+
+        if(!bPData)
+        {
+            m_bDatasetStarted = false;
+            continue;
+        }
+
+        // Look for the P-DATA values that complete a dataset
+        ///////////////////////////////////////////////////////////
+        const size_t valuesStart(pduStart + pduHeaderSize);
+        for(size_t scanValues(0); scanValues != pduLength; /* increased in the loop */)
+        {
+            const size_t valueLength(pduLength - scanValues < pDataValueHeaderSize ? 0 : readBigEndian32(m_buffer, valuesStart + scanValues));
+            if(valueLength < 2 || valueLength > pduLength - scanValues - 4)
+            {
+                // Corrupted PDU: let the association decode it
+                //  and report the error
+                ///////////////////////////////////////////////////////////
+                m_bDatasetStarted = false;
+                break;
+            }
+
+            // Bit 1 of the message control header flags the
+            //  last fragment of a dataset
+            ///////////////////////////////////////////////////////////
+            m_bDatasetStarted = (m_buffer[valuesStart + scanValues + 5] & 0x02) == 0;
+            scanValues += 4 + valueLength;
+        }
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+} // namespace implementation
+
+} // namespace imebra
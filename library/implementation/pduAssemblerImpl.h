@@ -0,0 +1,222 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file pduAssemblerImpl.h
+    \brief Declaration of the stream that assembles the incoming PDUs
+           from non-blocking reads.
+
+*/
+
+#if !defined(imebraPduAssembler_6F0B3E8A_1D2C_4B7E_9A55_3C9E2D71B0F4__INCLUDED_)
+#define imebraPduAssembler_6F0B3E8A_1D2C_4B7E_9A55_3C9E2D71B0F4__INCLUDED_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "baseSequenceStreamImpl.h"
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+class tcpSequenceStream;
+
+///
+/// \brief Collects the data received by a socket without
+///        blocking and exposes to its readers only the
+///        PDUs that have been completely received.
+///
+/// Used by the associations served by a tcpReactor: the
+///  reactor's worker threads feed the assembler when new data
+///  arrives on the socket, while the association's handler
+///  context reads the PDUs from it.
+///
+/// The handler context is started only when a whole PDU
+///  has been received, so the peers that stop sending in the
+///  middle of a PDU don't occupy any thread. Once started,
+///  the handler context reads the datasets while their PDUs
+///  arrive (see setBlockingReads()): only the PDUs not yet
+///  decoded are kept in memory.
+///
+/// The length of each PDU is checked as soon as its header
+///  arrives: P-DATA-TF PDUs longer than the maximum length
+///  advertised to the peer are rejected.
+///
+//////////////////////////////////////////////////////////////////
+class pduAssembler: public baseSequenceStreamInput
+{
+public:
+    ///
+    /// \brief Constructor. Switches the socket to
+    ///        non-blocking mode.
+    ///
+    /// \param pTcpStream       the socket from which the data
+    ///                         is received
+    /// \param maxPDULength     the maximum length of the
+    ///                         P-DATA-TF PDUs
+    /// \param readTimeoutSeconds maximum time, in seconds,
+    ///                         that a blocking read waits for
+    ///                         a PDU. 0 means infinite
+    /// \param resumeReceiving  function called when the reader
+    ///                         has consumed enough data to
+    ///                         resume receiving after receive()
+    ///                         returned false
+    ///
+    //////////////////////////////////////////////////////////////////
+    pduAssembler(
+            const std::shared_ptr<tcpSequenceStream>& pTcpStream,
+            std::uint32_t maxPDULength,
+            std::uint32_t readTimeoutSeconds,
+            const std::function<void()>& resumeReceiving);
+
+    ///
+    /// \brief Reads the data waiting on the socket, without
+    ///        waiting for new data.
+    ///
+    /// Throws AcseCorruptedMessageError if a PDU is longer
+    ///  than the allowed length.
+    ///
+    /// \return false if the socket must not be monitored
+    ///         anymore: the peer closed the connection or the
+    ///         received data not yet read exceeds the buffer
+    ///         size (in this case the function passed to the
+    ///         constructor is called when the socket has to be
+    ///         monitored again)
+    ///
+    //////////////////////////////////////////////////////////////////
+    bool receive();
+
+    ///
+    /// \brief Returns the number of PDUs that have been
+    ///        completely received and not read yet.
+    ///
+    /// \return the number of PDUs that can be read without
+    ///         waiting
+    ///
+    //////////////////////////////////////////////////////////////////
+    size_t getCompletePDUs() const;
+
+    ///
+    /// \brief Returns true if part of a PDU or part of a
+    ///        dataset has been received, but not the whole
+    ///        PDU or dataset.
+    ///
+    /// \return true if the rest of a PDU or dataset is
+    ///         expected
+    ///
+    //////////////////////////////////////////////////////////////////
+    bool isReceivingUnit() const;
+
+    ///
+    /// \brief Returns true if the peer closed the
+    ///        connection.
+    ///
+    /// The PDUs received before the connection was closed
+    ///  can still be read.
+    ///
+    /// \return true if the peer closed the connection
+    ///
+    //////////////////////////////////////////////////////////////////
+    bool isClosed() const;
+
+    ///
+    /// \brief Specifies what read() does when all the
+    ///        complete PDUs have been read.
+    ///
+    /// \param bBlockingReads if true then read() waits for
+    ///                       the next complete PDU, otherwise
+    ///                       it returns 0 (end of stream)
+    ///
+    //////////////////////////////////////////////////////////////////
+    void setBlockingReads(bool bBlockingReads);
+
+    ///
+    /// \brief Returns the data of the PDUs that have been
+    ///        completely received.
+    ///
+    /// When the blocking reads are disabled, returns 0 (end
+    ///  of stream) when the reader tries to read beyond the
+    ///  last complete PDU: this happens only when the PDUs are
+    ///  corrupted.
+    ///
+    /// When the blocking reads are enabled waits for the next
+    ///  complete PDU, and throws StreamClosedError if the
+    ///  read timeout expires.
+    ///
+    //////////////////////////////////////////////////////////////////
+    virtual size_t read(std::uint8_t* pBuffer, size_t bufferLength) override;
+
+    virtual void terminate() override;
+
+private:
+    ///
+    /// \brief Checks the headers of the PDUs received by
+    ///        the last receive() and records the end of
+    ///        the complete ones.
+    ///        Must be called with m_lockBuffer locked.
+    ///
+    //////////////////////////////////////////////////////////////////
+    void scanCompletePDUs();
+
+    const std::shared_ptr<tcpSequenceStream> m_pTcpStream;
+
+    const std::uint32_t m_maxPDULength;
+
+    const std::uint32_t m_readTimeoutSeconds;
+
+    const std::function<void()> m_resumeReceiving;
+
+    // Received data not yet read. The buffer starts at the
+    //  stream position m_readPosition; the bytes after the
+    //  position m_completePosition belong to an incomplete
+    //  PDU
+    ///////////////////////////////////////////////////////////
+    std::deque<std::uint8_t> m_buffer;
+    std::uint64_t m_readPosition;
+    std::uint64_t m_completePosition;
+
+    // Stream positions of the end of the complete PDUs not
+    //  yet read
+    ///////////////////////////////////////////////////////////
+    std::deque<std::uint64_t> m_completePDUs;
+
+    // true when the complete PDUs end in the middle of a
+    //  dataset
+    ///////////////////////////////////////////////////////////
+    bool m_bDatasetStarted;
+
+    bool m_bBlockingReads;
+
+    // true when receive() returned false because the buffer
+    //  is full
+    ///////////////////////////////////////////////////////////
+    bool m_bPaused;
+
+    bool m_bClosed;
+
+    bool m_bTerminated;
+
+    mutable std::mutex m_lockBuffer;
+    std::condition_variable m_notifyBuffer;
+};
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraPduAssembler_6F0B3E8A_1D2C_4B7E_9A55_3C9E2D71B0F4__INCLUDED_)
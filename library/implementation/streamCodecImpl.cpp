@@ -49,7 +49,7 @@ streamCodec::~streamCodec()
 //
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
-std::shared_ptr<dataSet> streamCodec::read(std::shared_ptr<streamReader> pSourceStream, std::uint32_t maxSizeBufferLoad /* = 0xffffffff */) const
+std::shared_ptr<dataSet> streamCodec::read(std::shared_ptr<streamReader> pSourceStream, std::uint32_t maxSizeBufferLoad /* = 0xffffffff */, std::uint32_t stopTag /* = 0xffffffff */) const
 {
     IMEBRA_FUNCTION_START();
 
@@ -59,7 +59,7 @@ std::shared_ptr<dataSet> streamCodec::read(std::shared_ptr<streamReader> pSource
 
     // Read the stream
     ///////////////////////////////////////////////////////////
-    readStream(pSourceStream, pDestDataSet, maxSizeBufferLoad);
+    readStream(pSourceStream, pDestDataSet, maxSizeBufferLoad, stopTag);
 
     return pDestDataSet;
 
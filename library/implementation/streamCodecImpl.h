@@ -127,10 +127,16 @@ public:
     ///                 ignore this parameter.
     ///                Set to -1 to load all the buffers
     ///                 immediatly
+    /// @param stopTag the parsing stops before the first tag
+    ///                 of the root dataset with an id equal
+    ///                 or greater than this one, expressed
+    ///                 as (groupId << 16) | tagId.
+    ///                 Some codecs may ignore this parameter.
+    ///                Set to -1 to parse the whole stream
     /// @return        a pointer to the loaded dataSet
     ///
     ///////////////////////////////////////////////////////////
-    std::shared_ptr<dataSet> read(std::shared_ptr<streamReader> pSourceStream, std::uint32_t maxSizeBufferLoad = std::numeric_limits<std::uint32_t>::max()) const;
+    std::shared_ptr<dataSet> read(std::shared_ptr<streamReader> pSourceStream, std::uint32_t maxSizeBufferLoad = std::numeric_limits<std::uint32_t>::max(), std::uint32_t stopTag = std::numeric_limits<std::uint32_t>::max()) const;
 
     /// \brief Write a dicom structure into a stream.
     ///
@@ -150,7 +156,7 @@ public:
     //@}
 
 protected:
-    virtual void readStream(std::shared_ptr<streamReader> pInputStream, std::shared_ptr<dataSet> pDestDataSet, std::uint32_t maxSizeBufferLoad = std::numeric_limits<std::uint32_t>::max()) const = 0;
+    virtual void readStream(std::shared_ptr<streamReader> pInputStream, std::shared_ptr<dataSet> pDestDataSet, std::uint32_t maxSizeBufferLoad = std::numeric_limits<std::uint32_t>::max(), std::uint32_t stopTag = std::numeric_limits<std::uint32_t>::max()) const = 0;
     virtual void writeStream(std::shared_ptr<streamWriter> pDestStream, std::shared_ptr<dataSet> pSourceDataSet) const = 0;
 };
 
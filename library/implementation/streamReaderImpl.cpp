@@ -165,6 +165,117 @@ bool streamReader::endReached()
 }
 
 
+///////////////////////////////////////////////////////////
+//
+// Check if the requested bytes can be read
+//
+///////////////////////////////////////////////////////////
+bool streamReader::isDataAvailable(size_t length)
+{
+    IMEBRA_FUNCTION_START();
+
+    if(length <= m_dataBufferEnd - m_dataBufferCurrent)
+    {
+        return true;
+    }
+
+    const size_t endPosition(position() + length);
+    if(m_virtualLength != 0 && endPosition > m_virtualLength)
+    {
+        return false;
+    }
+
+    if(!m_pControlledStream->seekable())
+    {
+        return true;
+    }
+
+    // The stream is long enough if its last requested byte
+    //  can be read
+    ///////////////////////////////////////////////////////////
+    std::uint8_t lastByte;
+    return m_pControlledStream->read(m_virtualStart + endPosition - 1, &lastByte, 1) == 1;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Return the unread bytes in the data buffer, loading
+//  more data if necessary
+//
+///////////////////////////////////////////////////////////
+const std::uint8_t* streamReader::getBufferedData(size_t minimumSize, size_t* pAvailableSize)
+{
+    IMEBRA_FUNCTION_START();
+
+    size_t availableSize(m_dataBufferEnd - m_dataBufferCurrent);
+
+    if(availableSize < minimumSize)
+    {
+        // Move the unread bytes to the beginning of the data
+        //  buffer, then append new data
+        ///////////////////////////////////////////////////////////
+        if(availableSize != 0)
+        {
+            ::memmove(&(m_dataBuffer[0]), &(m_dataBuffer[m_dataBufferCurrent]), availableSize);
+        }
+        m_dataBufferStreamPosition += m_dataBufferCurrent;
+        m_dataBufferCurrent = 0;
+        m_dataBufferEnd = availableSize;
+
+        while(m_dataBufferEnd < minimumSize)
+        {
+            size_t readPosition(m_dataBufferStreamPosition + m_dataBufferEnd);
+            size_t readLength(m_dataBuffer.size() - m_dataBufferEnd);
+            if(m_virtualLength != 0)
+            {
+                if(readPosition >= m_virtualLength)
+                {
+                    break;
+                }
+                if(readPosition + readLength > m_virtualLength)
+                {
+                    readLength = m_virtualLength - readPosition;
+                }
+            }
+            size_t readBytes(m_pControlledStream->read(readPosition + m_virtualStart, &(m_dataBuffer[m_dataBufferEnd]), readLength));
+            if(readBytes == 0)
+            {
+                break;
+            }
+            m_dataBufferEnd += readBytes;
+        }
+        availableSize = m_dataBufferEnd;
+    }
+
+    *pAvailableSize = availableSize;
+    return &(m_dataBuffer[m_dataBufferCurrent]);
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Consume the bytes returned by getBufferedData()
+//
+///////////////////////////////////////////////////////////
+void streamReader::skipBufferedData(size_t size)
+{
+    IMEBRA_FUNCTION_START();
+
+    for(std::shared_ptr<streamWriter>& pWriter: m_forwardStream)
+    {
+        pWriter->write(&(m_dataBuffer[m_dataBufferCurrent]), size);
+    }
+    m_dataBufferCurrent += size;
+
+    IMEBRA_FUNCTION_END();
+}
+
+
 ///////////////////////////////////////////////////////////
 //
 // Refill the data buffer
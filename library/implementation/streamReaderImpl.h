@@ -159,6 +159,51 @@ public:
     ///////////////////////////////////////////////////////////
     bool endReached();
 
+    /// \brief Check if the specified amount of bytes can be
+    ///         read from the current position.
+    ///
+    /// The size of the non seekable streams is unknown: for
+    ///  them the function returns true unless the virtual
+    ///  length of the stream is exceeded.
+    ///
+    /// @param length the number of bytes to check
+    /// @return false if the stream ends before the specified
+    ///          amount of bytes
+    ///
+    ///////////////////////////////////////////////////////////
+    bool isDataAvailable(size_t length);
+
+    /// \brief Returns the bytes that have been loaded in the
+    ///         data buffer but not yet read.
+    ///
+    /// If less than minimumSize bytes are available then
+    ///  the function loads more data from the controlled
+    ///  stream, unless the end of the stream is reached.
+    ///
+    /// The returned bytes are not consumed: call
+    ///  skipBufferedData() to move the read position past
+    ///  the bytes actually used.
+    ///
+    /// @param minimumSize    the minimum number of bytes that
+    ///                        must be loaded. Cannot be larger
+    ///                        than the data buffer
+    /// @param pAvailableSize set to the number of available
+    ///                        bytes. Can be less than
+    ///                        minimumSize only when the end of
+    ///                        the stream has been reached
+    /// @return a pointer to the first unread byte
+    ///
+    ///////////////////////////////////////////////////////////
+    const std::uint8_t* getBufferedData(size_t minimumSize, size_t* pAvailableSize);
+
+    /// \brief Consumes the specified amount of bytes returned
+    ///         by getBufferedData().
+    ///
+    /// @param size the number of bytes to consume
+    ///
+    ///////////////////////////////////////////////////////////
+    void skipBufferedData(size_t size);
+
 private:
     friend class forwardStream;
 
@@ -128,6 +128,27 @@ void streamWriter::write(const std::uint8_t* pBuffer, size_t bufferLength)
     IMEBRA_FUNCTION_END();
 }
 
+
+///////////////////////////////////////////////////////////
+//
+// Overwrite data already written into the stream
+//
+///////////////////////////////////////////////////////////
+void streamWriter::overwrite(size_t streamPosition, const std::uint8_t* pBuffer, size_t bufferLength)
+{
+    IMEBRA_FUNCTION_START();
+
+    flushDataBuffer();
+    m_pControlledStream->write(streamPosition, pBuffer, bufferLength);
+
+    IMEBRA_FUNCTION_END();
+}
+
+bool streamWriter::seekable() const
+{
+    return m_pControlledStream->seekable();
+}
+
 } // namespace implementation
 
 } // namespace imebra
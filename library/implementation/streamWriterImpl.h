@@ -95,6 +95,28 @@ public:
 	///////////////////////////////////////////////////////////
     void write(const std::uint8_t* pBuffer, size_t bufferLength);
 
+    /// \brief Overwrite data that has already been written
+    ///         into the stream.
+    ///
+    /// The internal buffer is flushed before the data is
+    ///  overwritten. Only the streams that allow random
+    ///  access (files and memory) support this operation.
+    ///
+    /// @param streamPosition the position of the first byte
+    ///                   to overwrite, as returned by
+    ///                   getControlledStreamPosition()
+    /// @param pBuffer   a pointer to the data to write
+    /// @param bufferLength the number of bytes to write
+    ///
+    ///////////////////////////////////////////////////////////
+    void overwrite(size_t streamPosition, const std::uint8_t* pBuffer, size_t bufferLength);
+
+    /// \brief Return true if the controlled stream supports
+    ///         overwrite(), false otherwise.
+    ///
+    ///////////////////////////////////////////////////////////
+    bool seekable() const;
+
 	/// \brief Write the specified amount of bits to the
 	///         stream.
 	///
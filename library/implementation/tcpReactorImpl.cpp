@@ -0,0 +1,560 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file tcpReactorImpl.cpp
+    \brief Implementation of the reactor that multiplexes several sockets
+           on a pool of worker threads.
+
+*/
+
+#include "tcpReactorImpl.h"
+#include "tcpSequenceStreamImpl.h"
+#include "exceptionImpl.h"
+#include "../include/imebra/exceptions.h"
+
+#ifdef IMEBRA_WINDOWS
+
+#include <Winsock2.h>
+
+#else
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+#endif
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+#ifdef IMEBRA_WINDOWS
+typedef WSAPOLLFD reactorPollFd_t;
+#define IMEBRA_REACTOR_POLL WSAPoll
+#else
+typedef pollfd reactorPollFd_t;
+#define IMEBRA_REACTOR_POLL ::poll
+#endif
+
+
+///////////////////////////////////////////////////////////
+//
+// Constructor
+//
+///////////////////////////////////////////////////////////
+tcpReactor::tcpReactor(size_t workerThreads):
+    m_bTerminate(false)
+{
+    IMEBRA_FUNCTION_START();
+
+    INIT_WINSOCK;
+
+#if !defined(IMEBRA_WINDOWS)
+    // The pipe is used to wake up the reactor thread when
+    // the registered sockets change
+    ///////////////////////////////////////////////////////////
+    throwTcpException(::pipe(m_wakePipe));
+    for(size_t pipeEnd(0); pipeEnd != 2; ++pipeEnd)
+    {
+        int flags = (int)throwTcpException(fcntl(m_wakePipe[pipeEnd], F_GETFL, 0));
+        throwTcpException(fcntl(m_wakePipe[pipeEnd], F_SETFL, flags | O_NONBLOCK));
+        throwTcpException(fcntl(m_wakePipe[pipeEnd], F_SETFD, FD_CLOEXEC));
+    }
+#endif
+
+#if defined(__linux__)
+    m_epoll = (int)throwTcpException(epoll_create1(EPOLL_CLOEXEC));
+
+    epoll_event wakeEvent;
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.fd = m_wakePipe[0];
+    throwTcpException(epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakePipe[0], &wakeEvent));
+#endif
+
+    if(workerThreads == 0)
+    {
+        workerThreads = 1;
+    }
+
+    m_reactorThread = std::thread(&tcpReactor::reactorThread, this);
+    for(size_t createThreads(0); createThreads != workerThreads; ++createThreads)
+    {
+        m_workerThreads.emplace_back(&tcpReactor::workerThread, this);
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Destructor
+//
+///////////////////////////////////////////////////////////
+tcpReactor::~tcpReactor()
+{
+    terminate();
+
+#if defined(__linux__)
+    ::close(m_epoll);
+#endif
+
+#if !defined(IMEBRA_WINDOWS)
+    ::close(m_wakePipe[0]);
+    ::close(m_wakePipe[1]);
+#endif
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Register a socket
+//
+///////////////////////////////////////////////////////////
+void tcpReactor::addSocket(int socket, const callback_t& callback, std::uint32_t timeoutSeconds)
+{
+    IMEBRA_FUNCTION_START();
+
+    {
+        std::unique_lock<std::mutex> lock(m_lockSockets);
+
+        registeredSocket& registered(m_sockets[socket]);
+        registered.m_callback = callback;
+        registered.m_bArmed = true;
+        registered.m_bMonitored = false;
+        registered.m_bHasDeadline = (timeoutSeconds != 0);
+        registered.m_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds);
+
+        updateMonitor(socket, registered);
+    }
+
+    wakeReactor();
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Monitor a socket again after its callback has been
+//  executed
+//
+///////////////////////////////////////////////////////////
+void tcpReactor::rearmSocket(int socket, std::uint32_t timeoutSeconds)
+{
+    IMEBRA_FUNCTION_START();
+
+    {
+        std::unique_lock<std::mutex> lock(m_lockSockets);
+
+        registeredSockets_t::iterator findSocket(m_sockets.find(socket));
+        if(findSocket == m_sockets.end())
+        {
+            IMEBRA_THROW(std::logic_error, "The socket is not registered with the reactor");
+        }
+
+        findSocket->second.m_bArmed = true;
+        findSocket->second.m_bHasDeadline = (timeoutSeconds != 0);
+        findSocket->second.m_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds);
+
+        updateMonitor(socket, findSocket->second);
+    }
+
+#if defined(__linux__)
+    // epoll picks up the socket immediately: wake up the
+    // reactor only when the wait time must be recalculated
+    ///////////////////////////////////////////////////////////
+    if(timeoutSeconds != 0)
+    {
+        wakeReactor();
+    }
+#else
+    wakeReactor();
+#endif
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Unregister a socket
+//
+///////////////////////////////////////////////////////////
+void tcpReactor::removeSocket(int socket)
+{
+    IMEBRA_FUNCTION_START();
+
+    {
+        std::unique_lock<std::mutex> lock(m_lockSockets);
+
+        registeredSockets_t::iterator findSocket(m_sockets.find(socket));
+        if(findSocket == m_sockets.end())
+        {
+            return;
+        }
+
+        findSocket->second.m_bArmed = false;
+        updateMonitor(socket, findSocket->second);
+        m_sockets.erase(findSocket);
+    }
+
+    wakeReactor();
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Stop the reactor and the workers
+//
+///////////////////////////////////////////////////////////
+void tcpReactor::terminate()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_lockScheduledCallbacks);
+        m_bTerminate.store(true);
+        m_scheduledCallbacks.clear();
+        m_notifyScheduledCallbacks.notify_all();
+    }
+
+    wakeReactor();
+
+    if(m_reactorThread.joinable())
+    {
+        m_reactorThread.join();
+    }
+
+    for(std::thread& workerThread: m_workerThreads)
+    {
+        if(workerThread.joinable())
+        {
+            workerThread.join();
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Wait for the sockets and dispatch the callbacks
+//
+///////////////////////////////////////////////////////////
+void tcpReactor::reactorThread()
+{
+#if defined(__linux__)
+
+    std::vector<epoll_event> events(64);
+
+    while(!m_bTerminate.load())
+    {
+        int waitTimeMs;
+        {
+            std::unique_lock<std::mutex> lock(m_lockSockets);
+            waitTimeMs = getWaitTimeMs();
+        }
+
+        int readyEvents(epoll_wait(m_epoll, events.data(), (int)events.size(), waitTimeMs));
+        if(readyEvents < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(m_lockSockets);
+
+        for(int scanEvents(0); scanEvents != readyEvents; ++scanEvents)
+        {
+            if(events[(size_t)scanEvents].data.fd == m_wakePipe[0])
+            {
+                std::uint8_t drain[64];
+                while(::read(m_wakePipe[0], drain, sizeof(drain)) > 0)
+                {
+                }
+                continue;
+            }
+            processReadableSocket(events[(size_t)scanEvents].data.fd);
+        }
+
+        processExpiredDeadlines();
+    }
+
+#else
+
+    std::vector<reactorPollFd_t> pollSockets;
+
+    while(!m_bTerminate.load())
+    {
+        int waitTimeMs;
+        pollSockets.clear();
+        {
+            std::unique_lock<std::mutex> lock(m_lockSockets);
+            waitTimeMs = getWaitTimeMs();
+
+            for(const registeredSockets_t::value_type& registered: m_sockets)
+            {
+                if(registered.second.m_bArmed)
+                {
+                    reactorPollFd_t pollSocket;
+                    pollSocket.fd = registered.first;
+                    pollSocket.events = POLLIN;
+                    pollSocket.revents = 0;
+                    pollSockets.push_back(pollSocket);
+                }
+            }
+        }
+
+#if defined(IMEBRA_WINDOWS)
+        // There isn't a wake up pipe on Windows: the changes
+        // in the registered sockets are picked up after
+        // IMEBRA_TCP_TIMEOUT_MS
+        ///////////////////////////////////////////////////////////
+        if(waitTimeMs < 0 || waitTimeMs > IMEBRA_TCP_TIMEOUT_MS)
+        {
+            waitTimeMs = IMEBRA_TCP_TIMEOUT_MS;
+        }
+        if(pollSockets.empty())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(waitTimeMs));
+        }
+        else if(IMEBRA_REACTOR_POLL(pollSockets.data(), (ULONG)pollSockets.size(), waitTimeMs) < 0)
+        {
+            return;
+        }
+#else
+        reactorPollFd_t wakeSocket;
+        wakeSocket.fd = m_wakePipe[0];
+        wakeSocket.events = POLLIN;
+        wakeSocket.revents = 0;
+        pollSockets.push_back(wakeSocket);
+
+        if(IMEBRA_REACTOR_POLL(pollSockets.data(), (nfds_t)pollSockets.size(), waitTimeMs) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+#endif
+
+        std::unique_lock<std::mutex> lock(m_lockSockets);
+
+        for(const reactorPollFd_t& pollSocket: pollSockets)
+        {
+            if(pollSocket.revents == 0)
+            {
+                continue;
+            }
+#if !defined(IMEBRA_WINDOWS)
+            if(pollSocket.fd == m_wakePipe[0])
+            {
+                std::uint8_t drain[64];
+                while(::read(m_wakePipe[0], drain, sizeof(drain)) > 0)
+                {
+                }
+                continue;
+            }
+#endif
+            processReadableSocket((int)pollSocket.fd);
+        }
+
+        processExpiredDeadlines();
+    }
+
+#endif
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Execute the scheduled callbacks
+//
+///////////////////////////////////////////////////////////
+void tcpReactor::workerThread()
+{
+    for(;;)
+    {
+        std::pair<callback_t, bool> callback;
+        {
+            std::unique_lock<std::mutex> lock(m_lockScheduledCallbacks);
+            while(m_scheduledCallbacks.empty() && !m_bTerminate.load())
+            {
+                m_notifyScheduledCallbacks.wait(lock);
+            }
+            if(m_bTerminate.load())
+            {
+                return;
+            }
+            callback = m_scheduledCallbacks.front();
+            m_scheduledCallbacks.pop_front();
+        }
+
+        try
+        {
+            callback.first(callback.second);
+        }
+        catch(...)
+        {
+            // The callbacks are responsible for their errors
+        }
+    }
+}
+
+
+void tcpReactor::schedule(const callback_t& callback, bool bTimeout)
+{
+    std::unique_lock<std::mutex> lock(m_lockScheduledCallbacks);
+    m_scheduledCallbacks.emplace_back(callback, bTimeout);
+    m_notifyScheduledCallbacks.notify_one();
+}
+
+
+void tcpReactor::wakeReactor()
+{
+#if !defined(IMEBRA_WINDOWS)
+    const std::uint8_t wake(0);
+    if(::write(m_wakePipe[1], &wake, 1) < 0)
+    {
+        // The pipe is already full: the reactor will wake up
+        // anyway
+    }
+#endif
+}
+
+
+void tcpReactor::updateMonitor(int socket, registeredSocket& registered)
+{
+    IMEBRA_FUNCTION_START();
+
+#if defined(__linux__)
+    if(registered.m_bArmed)
+    {
+        // One-shot: the socket is disabled after its first
+        // event until it is armed again
+        ///////////////////////////////////////////////////////////
+        epoll_event socketEvent;
+        socketEvent.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        socketEvent.data.fd = socket;
+        throwTcpException(epoll_ctl(m_epoll, registered.m_bMonitored ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, socket, &socketEvent));
+        registered.m_bMonitored = true;
+    }
+    else if(registered.m_bMonitored)
+    {
+        epoll_event socketEvent;
+        socketEvent.events = 0;
+        socketEvent.data.fd = socket;
+        throwTcpException(epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, &socketEvent));
+        registered.m_bMonitored = false;
+    }
+#else
+    // The poll set is rebuilt by the reactor thread
+    ///////////////////////////////////////////////////////////
+    (void)socket;
+    registered.m_bMonitored = registered.m_bArmed;
+#endif
+
+    IMEBRA_FUNCTION_END();
+}
+
+
+int tcpReactor::getWaitTimeMs() const
+{
+    bool bHasDeadline(false);
+    deadline_t nearestDeadline;
+    for(const registeredSockets_t::value_type& registered: m_sockets)
+    {
+        if(registered.second.m_bArmed && registered.second.m_bHasDeadline &&
+                (!bHasDeadline || registered.second.m_deadline < nearestDeadline))
+        {
+            bHasDeadline = true;
+            nearestDeadline = registered.second.m_deadline;
+        }
+    }
+
+    if(!bHasDeadline)
+    {
+        return -1;
+    }
+
+    const deadline_t now(std::chrono::steady_clock::now());
+    if(nearestDeadline <= now)
+    {
+        return 0;
+    }
+
+    // Round up, so the deadline has expired when the reactor
+    // wakes up
+    ///////////////////////////////////////////////////////////
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(nearestDeadline - now).count() + 1;
+}
+
+
+void tcpReactor::processExpiredDeadlines()
+{
+    const deadline_t now(std::chrono::steady_clock::now());
+
+    for(registeredSockets_t::value_type& registered: m_sockets)
+    {
+        if(registered.second.m_bArmed && registered.second.m_bHasDeadline && registered.second.m_deadline <= now)
+        {
+            registered.second.m_bArmed = false;
+            registered.second.m_bHasDeadline = false;
+            try
+            {
+                updateMonitor(registered.first, registered.second);
+            }
+            catch(...)
+            {
+                // The socket is not monitored anymore anyway
+            }
+            schedule(registered.second.m_callback, true);
+        }
+    }
+}
+
+
+void tcpReactor::processReadableSocket(int socket)
+{
+    registeredSockets_t::iterator findSocket(m_sockets.find(socket));
+    if(findSocket == m_sockets.end() || !findSocket->second.m_bArmed)
+    {
+        return;
+    }
+
+    // With epoll the one-shot flag has already disabled the
+    // socket
+    ///////////////////////////////////////////////////////////
+    findSocket->second.m_bArmed = false;
+    findSocket->second.m_bHasDeadline = false;
+#if !defined(__linux__)
+    findSocket->second.m_bMonitored = false;
+#endif
+
+    schedule(findSocket->second.m_callback, false);
+}
+
+} // namespace implementation
+
+} // namespace imebra
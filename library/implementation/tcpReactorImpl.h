@@ -0,0 +1,225 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file tcpReactorImpl.h
+    \brief Declaration of the reactor that multiplexes several sockets
+           on a pool of worker threads.
+
+*/
+
+#if !defined(imebraTcpReactor_AA40BEA6_0FAC_4D45_B26F_BD94C37437DD__INCLUDED_)
+#define imebraTcpReactor_AA40BEA6_0FAC_4D45_B26F_BD94C37437DD__INCLUDED_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "configurationImpl.h"
+
+#ifndef IMEBRA_REACTOR_WORKER_THREADS
+#define IMEBRA_REACTOR_WORKER_THREADS 4
+#endif
+
+namespace imebra
+{
+
+namespace implementation
+{
+
+///
+/// \brief Waits for incoming data on many sockets from a single
+///        thread and executes the sockets' callbacks on a pool
+///        of worker threads.
+///
+/// On Linux the sockets are monitored via epoll, on the other
+///  platforms via poll (WSAPoll on Windows).
+///
+/// The sockets are registered in one-shot mode: once a
+///  socket becomes readable its callback is scheduled on a
+///  worker thread and the socket is not monitored anymore
+///  until rearmSocket() is called. This guarantees that only
+///  one worker at the time processes the data of a socket.
+///
+///////////////////////////////////////////////////////////
+class tcpReactor
+{
+public:
+    ///
+    /// \brief Callback executed on a worker thread when a
+    ///        socket becomes readable or when its timeout
+    ///        expires.
+    ///
+    /// The parameter is true when the callback is called
+    ///  because the timeout expired.
+    ///
+    ///////////////////////////////////////////////////////////
+    typedef std::function<void(bool)> callback_t;
+
+    ///
+    /// \brief Constructor. Launches the reactor thread and
+    ///        the worker threads.
+    ///
+    /// \param workerThreads the number of worker threads
+    ///                      that execute the callbacks
+    ///
+    ///////////////////////////////////////////////////////////
+    tcpReactor(size_t workerThreads);
+
+    ///
+    /// \brief Destructor. Calls terminate().
+    ///
+    ///////////////////////////////////////////////////////////
+    ~tcpReactor();
+
+    ///
+    /// \brief Registers a socket and starts monitoring it.
+    ///
+    /// \param socket         the socket to monitor
+    /// \param callback       the function to call when the
+    ///                       socket becomes readable
+    /// \param timeoutSeconds if not zero, then the callback
+    ///                       is called with the parameter set
+    ///                       to true when no data arrives
+    ///                       within the specified time
+    ///
+    ///////////////////////////////////////////////////////////
+    void addSocket(int socket, const callback_t& callback, std::uint32_t timeoutSeconds);
+
+    ///
+    /// \brief Resumes the monitoring of a socket after its
+    ///        callback has been executed.
+    ///
+    /// \param socket         the socket to monitor
+    /// \param timeoutSeconds if not zero, then the callback
+    ///                       is called with the parameter set
+    ///                       to true when no data arrives
+    ///                       within the specified time
+    ///
+    ///////////////////////////////////////////////////////////
+    void rearmSocket(int socket, std::uint32_t timeoutSeconds);
+
+    ///
+    /// \brief Stops monitoring a socket and removes its
+    ///        callback.
+    ///
+    /// Must be called before the socket is closed.
+    ///
+    /// \param socket the socket to remove
+    ///
+    ///////////////////////////////////////////////////////////
+    void removeSocket(int socket);
+
+    ///
+    /// \brief Stops the reactor and the worker threads.
+    ///
+    /// The callbacks being executed are allowed to complete,
+    ///  the scheduled ones are discarded.
+    ///
+    ///////////////////////////////////////////////////////////
+    void terminate();
+
+private:
+    typedef std::chrono::time_point<std::chrono::steady_clock> deadline_t;
+
+    struct registeredSocket
+    {
+        callback_t m_callback;
+        bool m_bArmed;
+        bool m_bMonitored;
+        bool m_bHasDeadline;
+        deadline_t m_deadline;
+    };
+
+    void reactorThread();
+
+    void workerThread();
+
+    ///
+    /// \brief Schedules a callback on the worker threads.
+    ///
+    ///////////////////////////////////////////////////////////
+    void schedule(const callback_t& callback, bool bTimeout);
+
+    ///
+    /// \brief Wakes up the reactor thread so it can pick
+    ///        up the changes in the registered sockets.
+    ///
+    ///////////////////////////////////////////////////////////
+    void wakeReactor();
+
+    ///
+    /// \brief Updates the epoll set for the specified socket.
+    ///        Must be called with m_lockSockets locked.
+    ///
+    ///////////////////////////////////////////////////////////
+    void updateMonitor(int socket, registeredSocket& registered);
+
+    ///
+    /// \brief Returns the time to wait for the next deadline,
+    ///        in milliseconds (-1 = infinite).
+    ///        Must be called with m_lockSockets locked.
+    ///
+    ///////////////////////////////////////////////////////////
+    int getWaitTimeMs() const;
+
+    ///
+    /// \brief Schedules the callbacks of the sockets whose
+    ///        deadline has expired.
+    ///        Must be called with m_lockSockets locked.
+    ///
+    ///////////////////////////////////////////////////////////
+    void processExpiredDeadlines();
+
+    ///
+    /// \brief Disarms a socket that became readable and
+    ///        schedules its callback.
+    ///        Must be called with m_lockSockets locked.
+    ///
+    ///////////////////////////////////////////////////////////
+    void processReadableSocket(int socket);
+
+    typedef std::map<int, registeredSocket> registeredSockets_t;
+    registeredSockets_t m_sockets;
+    mutable std::mutex m_lockSockets;
+
+#if defined(__linux__)
+    int m_epoll;
+#endif
+
+#if !defined(IMEBRA_WINDOWS)
+    int m_wakePipe[2];
+#endif
+
+    std::atomic<bool> m_bTerminate;
+
+    typedef std::list<std::pair<callback_t, bool> > scheduledCallbacks_t;
+    scheduledCallbacks_t m_scheduledCallbacks;
+    std::mutex m_lockScheduledCallbacks;
+    std::condition_variable m_notifyScheduledCallbacks;
+
+    std::thread m_reactorThread;
+    std::vector<std::thread> m_workerThreads;
+};
+
+} // namespace implementation
+
+} // namespace imebra
+
+#endif // !defined(imebraTcpReactor_AA40BEA6_0FAC_4D45_B26F_BD94C37437DD__INCLUDED_)
@@ -455,6 +455,12 @@ void tcpBaseSocket::setBlockingMode(bool bBlocking)
 }
 
 
+int tcpBaseSocket::getSocketHandle() const
+{
+    return m_socket;
+}
+
+
 void tcpBaseSocket::terminate()
 {
     m_bTerminate.store(true);
@@ -644,6 +650,41 @@ size_t tcpSequenceStream::read(std::uint8_t* pBuffer, size_t bufferLength)
 }
 
 
+///////////////////////////////////////////////////////////
+//
+// Read the data already received, without waiting
+//
+///////////////////////////////////////////////////////////
+size_t tcpSequenceStream::readAvailable(std::uint8_t* pBuffer, size_t bufferLength)
+{
+    IMEBRA_FUNCTION_START();
+
+    isTerminating();
+
+    if(bufferLength == 0)
+    {
+        return 0;
+    }
+
+    try
+    {
+        long receivedBytes(throwTcpException(recv(m_socket, (char*)pBuffer, bufferLength, 0)));
+        if(receivedBytes == 0)
+        {
+            IMEBRA_THROW(StreamClosedError, "Stream closed");
+        }
+        return (size_t)receivedBytes;
+    }
+    catch(const SocketTimeout&)
+    {
+        // No data waiting on the socket
+        return 0;
+    }
+
+    IMEBRA_FUNCTION_END();
+}
+
+
 ///////////////////////////////////////////////////////////
 //
 // Write into the TCP stream
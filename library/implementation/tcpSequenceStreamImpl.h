@@ -168,6 +168,15 @@ public:
     ///////////////////////////////////////////////////////////
     void poll(pollType_t pollType);
 
+    ///
+    /// \brief Returns the socket handle, used to register the
+    ///        socket with a tcpReactor.
+    ///
+    /// \return the socket handle
+    ///
+    ///////////////////////////////////////////////////////////
+    int getSocketHandle() const;
+
     ///
     /// \brief Allocate this class at the beginning of a
     ///        blocking method.
@@ -250,6 +259,28 @@ public:
 
     void terminate();
 
+    using tcpBaseSocket::getSocketHandle;
+    using tcpBaseSocket::setBlockingMode;
+
+    ///
+    /// \brief Reads the data already received by the socket,
+    ///        without waiting for new data.
+    ///
+    /// The socket must be in non-blocking mode (see
+    ///  setBlockingMode()).
+    ///
+    /// Throws StreamClosedError if the peer closed the
+    ///  connection.
+    ///
+    /// \param pBuffer      the buffer where the read data
+    ///                     is stored
+    /// \param bufferLength the buffer's size
+    /// \return the number of bytes read, 0 if no data is
+    ///         waiting on the socket
+    ///
+    ///////////////////////////////////////////////////////////
+    size_t readAvailable(std::uint8_t* pBuffer, size_t bufferLength);
+
 private:
     size_t read(std::uint8_t* pBuffer, size_t bufferLength);
     void write(const std::uint8_t* pBuffer, size_t bufferLength);
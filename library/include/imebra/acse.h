@@ -34,6 +34,7 @@ namespace implementation
     class associationMessage;
     class presentationContext;
     class presentationContexts;
+    class payloadSpoolFolders;
 }
 
 class StreamReader;
@@ -150,6 +151,60 @@ private:
 };
 
 
+///
+/// \brief The folders where an AssociationSCP or a DimseServer spool the
+///        received payloads, per abstract syntax.
+///
+/// See AssociationBase::setPayloadSpoolFolder() for the details about the
+/// spooling. Pass the PayloadSpoolFolders to the AssociationSCP or
+/// DimseServer constructor: the spooling is then active also for the
+/// payloads that arrive right after the association has been negotiated.
+///
+///////////////////////////////////////////////////////////////////////////////
+class IMEBRA_API PayloadSpoolFolders
+{
+public:
+    ///
+    /// \brief Default constructor. Initially no payload is spooled.
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    explicit PayloadSpoolFolders();
+
+    ///
+    /// \brief Copy constructor.
+    ///
+    /// \param source source spool folders
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    PayloadSpoolFolders(const PayloadSpoolFolders& source);
+
+    PayloadSpoolFolders& operator=(const PayloadSpoolFolders& source) = delete;
+
+    virtual ~PayloadSpoolFolders();
+
+    ///
+    /// \brief Store the payloads received for a specific abstract syntax
+    ///        in temporary files instead of memory.
+    ///
+    /// \param abstractSyntax    the abstract syntax of the payloads to store
+    ///                          in the spool folder
+    /// \param spoolFolder       the folder where the temporary files are
+    ///                          created. An empty string disables the
+    ///                          spooling for the abstract syntax
+    /// \param maxSizeBufferLoad the tags larger than this size are not
+    ///                          loaded in memory
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    void setPayloadSpoolFolder(const std::string& abstractSyntax, const std::string& spoolFolder, std::uint32_t maxSizeBufferLoad);
+
+#ifndef SWIG
+private:
+    friend const std::shared_ptr<implementation::payloadSpoolFolders>& getPayloadSpoolFoldersImplementation(const PayloadSpoolFolders& spoolFolders);
+    std::shared_ptr<implementation::payloadSpoolFolders> m_pPayloadSpoolFolders;
+#endif
+};
+
+
 ///
 /// \brief An immutable ACSE message composed by one or two datasets.
 ///
@@ -386,6 +441,30 @@ public:
     //////////////////////////////////////////////////////////////////
     std::vector<std::string> getTransferSyntaxes(const std::string& abstractSyntax) const;
 
+    ///
+    /// \brief Store the payloads received for a specific abstract syntax
+    ///        in temporary files instead of memory.
+    ///
+    /// By default the payloads are parsed while their fragments are
+    /// received and all their tags are kept in memory.
+    ///
+    /// When a spool folder is set for an abstract syntax, then the payloads
+    /// are written into a temporary file in the spool folder and then parsed
+    /// from there: the tags larger than maxSizeBufferLoad are not loaded in
+    /// memory but reference the temporary file (which is memory mapped and
+    /// removed from the folder immediately).
+    ///
+    /// \param abstractSyntax    the abstract syntax of the payloads to store
+    ///                          in the spool folder
+    /// \param spoolFolder       the folder where the temporary files are
+    ///                          created. An empty string disables the
+    ///                          spooling for the abstract syntax
+    /// \param maxSizeBufferLoad the tags larger than this size are not
+    ///                          loaded in memory
+    ///
+    //////////////////////////////////////////////////////////////////
+    void setPayloadSpoolFolder(const std::string& abstractSyntax, const std::string& spoolFolder, std::uint32_t maxSizeBufferLoad);
+
 
 
 #ifndef SWIG
@@ -550,6 +629,46 @@ public:
             std::uint32_t dimseTimeoutSeconds,
             std::uint32_t artimTimeoutSeconds);
 
+    ///
+    /// \brief Listens for an association request and spools the received
+    ///        payloads into temporary files.
+    ///
+    /// Same as the previous constructor, but the payloads of the abstract
+    /// syntaxes listed in spoolFolders are stored in temporary files from
+    /// the first one received (see AssociationBase::setPayloadSpoolFolder()).
+    ///
+    /// \param thisAET              the AET of the SCP. If empty then the SCP
+    ///                             will accept associations for any called AET,
+    ///                             otherwise it will reject the association
+    ///                             when the called AET does not match this one
+    /// \param invokedOperations    maximum number of parallel operations we
+    ///                             intend to invoke when acting as a SCU
+    /// \param performedOperations  maximum number of parallel operations we can
+    ///                             perform when acting as a SCP
+    /// \param presentationContexts list of accepted presentation contexts
+    /// \param pInput               input stream from which the SCP receives
+    ///                             data
+    /// \param pOutput              output stream into which the SCP writes
+    ///                             data
+    /// \param dimseTimeoutSeconds  DIMSE timeout, in seconds. 0 means infinite
+    /// \param artimTimeoutSeconds  ARTIM timeout, in seconds. Amount of time that
+    ///                             is allowed to pass before an association
+    ///                             request arrives
+    /// \param spoolFolders         the folders where the payloads are spooled,
+    ///                             per abstract syntax
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    AssociationSCP(
+            const std::string& thisAET,
+            std::uint32_t invokedOperations,
+            std::uint32_t performedOperations,
+            const PresentationContexts& presentationContexts,
+            StreamReader& pInput,
+            StreamWriter& pOutput,
+            std::uint32_t dimseTimeoutSeconds,
+            std::uint32_t artimTimeoutSeconds,
+            const PayloadSpoolFolders& spoolFolders);
+
     ///
     /// \brief Copy constructor.
     ///
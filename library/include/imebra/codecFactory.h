@@ -47,6 +47,10 @@ public:
     /// The read position of the StreamReader is undefined when this method
     /// returns.
     ///
+    /// The returned DataSet cannot be modified, therefore it can be read by
+    /// several threads at once without locking its tags (except the ones that
+    /// are loaded lazily from the input stream).
+    ///
     /// \param reader            a StreamReader connected to the input stream
     /// \param maxSizeBufferLoad the maximum size of the tags that are loaded
     ///                          immediately. Tags larger than maxSizeBufferLoad
@@ -58,6 +62,33 @@ public:
     ///////////////////////////////////////////////////////////////////////////////
     static const DataSet load(StreamReader& reader, size_t maxSizeBufferLoad = std::numeric_limits<size_t>::max());
 
+    /// \brief Parses the content of the input stream up to the specified tag
+    ///        and returns a DataSet representing it.
+    ///
+    /// The parsing stops before the first tag of the root dataset with an id
+    /// equal or greater than stopTag (the group order is ignored): the tags
+    /// that follow it are not parsed. For instance, use the tag 7FE0,0010 to
+    /// load all the DICOM attributes except the pixel data.
+    ///
+    /// If none of the codecs supplied by Imebra is able to decode the stream's
+    /// content then it throws a CodecWrongFormatError exception.
+    ///
+    /// The read position of the StreamReader is undefined when this method
+    /// returns.
+    ///
+    /// \param reader            a StreamReader connected to the input stream
+    /// \param maxSizeBufferLoad the maximum size of the tags that are loaded
+    ///                          immediately. Tags larger than maxSizeBufferLoad
+    ///                          are left on the input stream and loaded only when
+    ///                          a ReadingDataHandler or a WritingDataHandler
+    ///                          reference them.
+    /// \param stopTag           the tag before which the parsing stops
+    /// \return a DataSet object representing the input stream's content that
+    ///         precedes stopTag
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static const DataSet load(StreamReader& reader, size_t maxSizeBufferLoad, const TagId& stopTag);
+
     /// \brief Parses the content of the input file and returns a DataSet
     ///        representing it.
     ///
@@ -75,6 +106,28 @@ public:
     ///////////////////////////////////////////////////////////////////////////////
 #ifndef SWIG // Use Unicode strings only with SWIG
     static const DataSet load(const std::wstring& fileName, size_t maxSizeBufferLoad = std::numeric_limits<size_t>::max());
+
+    /// \brief Parses the content of the input file up to the specified tag
+    ///        and returns a DataSet representing it.
+    ///
+    /// The parsing stops before the first tag of the root dataset with an id
+    /// equal or greater than stopTag (the group order is ignored).
+    ///
+    /// If none of the codecs supplied by Imebra is able to decode the file's
+    /// content then it throws a CodecWrongFormatError exception.
+    ///
+    /// \param fileName          the Unicode name of the input file to read
+    /// \param maxSizeBufferLoad the maximum size of the tags that are loaded
+    ///                          immediately. Tags larger than maxSizeBufferLoad
+    ///                          are left on the input stream and loaded only when
+    ///                          a ReadingDataHandler or a WritingDataHandler
+    ///                          reference them.
+    /// \param stopTag           the tag before which the parsing stops
+    /// \return a DataSet object representing the input file's content that
+    ///         precedes stopTag
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static const DataSet load(const std::wstring& fileName, size_t maxSizeBufferLoad, const TagId& stopTag);
 #endif
 
     /// \brief Parses the content of the input file and returns a DataSet
@@ -94,6 +147,28 @@ public:
     ///////////////////////////////////////////////////////////////////////////////
     static const DataSet load(const std::string& fileName, size_t maxSizeBufferLoad = std::numeric_limits<size_t>::max());
 
+    /// \brief Parses the content of the input file up to the specified tag
+    ///        and returns a DataSet representing it.
+    ///
+    /// The parsing stops before the first tag of the root dataset with an id
+    /// equal or greater than stopTag (the group order is ignored).
+    ///
+    /// If none of the codecs supplied by Imebra is able to decode the file's
+    /// content then it throws a CodecWrongFormatError exception.
+    ///
+    /// \param fileName          the Utf8 name of the input file to read
+    /// \param maxSizeBufferLoad the maximum size of the tags that are loaded
+    ///                          immediately. Tags larger than maxSizeBufferLoad
+    ///                          are left on the input stream and loaded only when
+    ///                          a ReadingDataHandler or a WritingDataHandler
+    ///                          reference them.
+    /// \param stopTag           the tag before which the parsing stops
+    /// \return a DataSet object representing the input file's content that
+    ///         precedes stopTag
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static const DataSet load(const std::string& fileName, size_t maxSizeBufferLoad, const TagId& stopTag);
+
     static void saveImage(
             StreamWriter& destStream,
             const Image& sourceImage,
@@ -148,6 +223,139 @@ public:
     ///////////////////////////////////////////////////////////////////////////////
     static void setMaximumImageSize(const std::uint32_t maximumWidth, const std::uint32_t maximumHeight);
 
+    /// \brief Set the number of threads used to decode the restart intervals
+    ///        of a jpeg image.
+    ///
+    /// When a jpeg image contains restart markers, the restart intervals of
+    /// each baseline, extended or lossless scan can be decoded in parallel.
+    /// Lossless scans are decoded in parallel only when each restart
+    /// interval contains whole MCU rows.
+    ///
+    /// By default the jpeg images are decoded on the calling thread only.
+    ///
+    /// The threads started by all the parallel operations of the library
+    /// are limited by a process-wide budget (one thread per CPU core by
+    /// default): when the budget is exhausted the restart intervals are
+    /// decoded by the calling thread.
+    ///
+    /// \param threadsCount the maximum number of threads used to decode a
+    ///                     jpeg image. 0 means one thread per CPU core
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static void setJpegDecodingThreads(std::uint32_t threadsCount);
+
+    /// \brief Set the number of MCU rows in each restart interval written by
+    ///        the jpeg encoder.
+    ///
+    /// Restart intervals allow the decoders to decode the image in parallel.
+    /// By default the jpeg encoder doesn't write restart intervals.
+    ///
+    /// \param mcuRows the number of MCU rows in each restart interval.
+    ///                0 disables the restart intervals
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static void setJpegRestartRows(std::uint32_t mcuRows);
+
+    /// \brief Enable or disable the typical huffman tables in the jpeg
+    ///        encoder.
+    ///
+    /// By default the jpeg encoder encodes each image twice: the first pass
+    /// collects the statistics used to build the optimal huffman tables and
+    /// the second pass writes the image.
+    ///
+    /// When the typical huffman tables listed in the Annex K of the jpeg
+    /// standard are enabled, the images are encoded in one pass, at the
+    /// cost of a slightly bigger size. The typical tables are used only for
+    /// lossy images with 8 bits per channel and for lossless images up to
+    /// 11 bits per channel: the other images are always encoded with the
+    /// optimal tables.
+    ///
+    /// \param bStandardTables true if the jpeg encoder must use the typical
+    ///                        huffman tables, false (default) if it must
+    ///                        calculate the optimal tables
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static void setJpegStandardHuffmanTables(bool bStandardTables);
+
+    /// \brief Select the implementation of the 8x8 DCT used by the jpeg
+    ///        codec.
+    ///
+    /// By default the jpeg codec uses the fastest implementation supported by
+    /// the CPU. The SIMD implementations return the same coefficients as the
+    /// portable one when encoding, while the decoded samples may differ by
+    /// one unit.
+    ///
+    /// Select jpegDct_t::portable to obtain the same results on all the
+    /// platforms.
+    ///
+    /// Throws JpegCodecError if the CPU doesn't support the requested
+    /// implementation.
+    ///
+    /// \param dct the implementation of the DCT to use
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static void setJpegDct(jpegDct_t dct);
+
+    /// \brief Return the implementation of the 8x8 DCT currently used by
+    ///        the jpeg codec.
+    ///
+    /// \return the implementation of the DCT used by the jpeg codec. Never
+    ///         returns jpegDct_t::automatic
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static jpegDct_t getJpegDct();
+
+    /// \brief Set the number of threads used to compress the segments of an
+    ///        RLE image.
+    ///
+    /// An RLE image contains one independent segment for each byte of each
+    /// channel (e.g. 3 segments for an 8 bit RGB image, 2 segments for a 16
+    /// bit monochrome image): the segments can be compressed in parallel.
+    ///
+    /// By default the RLE images are compressed on the calling thread only.
+    /// When the frames of a multi-frame image are already being compressed in
+    /// parallel by MutableDataSet::setImages() there is little to gain by
+    /// enabling this option too.
+    ///
+    /// The threads started by all the parallel operations of the library
+    /// are limited by a process-wide budget (one thread per CPU core by
+    /// default): when the budget is exhausted the segments are compressed
+    /// by the calling thread.
+    ///
+    /// \param threadsCount the maximum number of threads used to compress an
+    ///                     RLE image. 0 means one thread per CPU core
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static void setRLEEncodingThreads(std::uint32_t threadsCount);
+
+    /// \brief Set the maximum size of the cache that keeps the tags loaded on
+    ///        demand.
+    ///
+    /// Tags larger than the maxSizeBufferLoad parameter passed to load() are
+    /// read from the input stream when they are accessed. The loaded content is
+    /// shared by all the handlers that reference it and the most recently used
+    /// content is kept in a cache shared by all the DataSet objects, so
+    /// accessing the same tag again doesn't read the stream again.
+    ///
+    /// By default the cache size is 64MB.
+    ///
+    /// \param maxCacheSize the maximum size of the cache, in bytes. 0 disables
+    ///                     the cache
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static void setLazyLoadCacheSize(size_t maxCacheSize);
+
+    /// \brief Return the size of the content currently kept in the cache of
+    ///        the tags loaded on demand.
+    ///
+    /// The content of a tag is removed from the cache when the DataSet that
+    /// owns the tag is destroyed.
+    ///
+    /// \return the size of the cached content, in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static size_t getLazyLoadCacheUsedSize();
+
 };
 
 }
@@ -24,6 +24,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include <string>
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include "image.h"
 #include "readingDataHandlerNumeric.h"
 #include "writingDataHandlerNumeric.h"
@@ -85,6 +86,13 @@ class Overlay;
 ///
 /// If you want to modify the dataset, use MutableDataSet instead.
 ///
+/// The DataSet allocates its tags and the small values read from a stream
+/// from a few larger memory blocks, which are released when the DataSet and
+/// all the Tag, data handler and Memory objects obtained from it have been
+/// released. A single surviving object keeps all the blocks allocated:
+/// copy the values that must outlive the DataSet instead of keeping the
+/// objects that contain them.
+///
 ///////////////////////////////////////////////////////////////////////////////
 class IMEBRA_API DataSet
 {
@@ -149,6 +157,56 @@ public:
     ///////////////////////////////////////////////////////////////////////////////
     const Image getImage(size_t frameNumber) const;
 
+    /// \brief Retrieve a rectangular region of an image from the dataset.
+    ///
+    /// The native (uncompressed) images are read only where the region is
+    /// located; the jpeg images skip the decoding of the restart intervals
+    /// outside the region and stop decoding after the region's last block.
+    /// The images compressed with other transfer syntaxes are decompressed
+    /// completely before the region is extracted.
+    ///
+    /// Throws DataSetImageDoesntExistError if the requested frame does not
+    /// exist.
+    ///
+    /// Throws ImageInvalidSizeError if the region is empty or is not completely
+    /// inside the image.
+    ///
+    /// \param frameNumber the frame to retrieve (the first frame is 0)
+    /// \param left        the region's left column
+    /// \param top         the region's top row
+    /// \param width       the region's width, in pixels
+    /// \param height      the region's height, in pixels
+    /// \return an Image object containing the requested region
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    const Image getImage(size_t frameNumber, std::uint32_t left, std::uint32_t top, std::uint32_t width, std::uint32_t height) const;
+
+#ifndef SWIG // Image cannot be stored in a SWIG wrapped vector
+    /// \brief Retrieve several consecutive frames from the dataset, decoding
+    ///        them in parallel.
+    ///
+    /// The position of all the requested frames is resolved once, then the
+    /// frames are decoded by several threads. The DataSet is not locked while
+    /// the frames are being decoded.
+    ///
+    /// Throws DataSetImageDoesntExistError if one of the requested frames does
+    /// not exist.
+    ///
+    /// \param firstFrame   the first frame to retrieve (the first frame in the
+    ///                     dataset is 0)
+    /// \param framesCount  the number of frames to retrieve
+    /// \param threadsCount the number of threads used to decode the frames.
+    ///                     0 means one thread per hardware core. The
+    ///                     threads started by all the parallel operations
+    ///                     of the library are limited by a process-wide
+    ///                     budget (one thread per hardware core by
+    ///                     default)
+    /// \return the decompressed frames, ordered by frame number
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    std::vector<Image> getImages(size_t firstFrame, size_t framesCount, size_t threadsCount) const;
+#endif
+
     /// \brief Retrieve one of the DICOM overlays.
     ///
     /// Throws MissingGroupError if the requested overlay does not exist.
@@ -694,6 +752,8 @@ public:
     ///                       - "1.2.840.10008.1.2.4.57" (Jpeg lossless NH)
     ///                       - "1.2.840.10008.1.2.4.70" (Jpeg lossless NH first
     ///                         order prediction)
+    ///                       - "1.2.840.10008.1.2.4.80" (Jpeg-LS lossless)
+    ///                       - "1.2.840.10008.1.2.4.81" (Jpeg-LS near-lossless)
     ///
     ///////////////////////////////////////////////////////////////////////////////
     explicit MutableDataSet(const std::string& transferSyntax);
@@ -713,6 +773,8 @@ public:
     ///                       - "1.2.840.10008.1.2.4.57" (Jpeg lossless NH)
     ///                       - "1.2.840.10008.1.2.4.70" (Jpeg lossless NH first
     ///                         order prediction)
+    ///                       - "1.2.840.10008.1.2.4.80" (Jpeg-LS lossless)
+    ///                       - "1.2.840.10008.1.2.4.81" (Jpeg-LS near-lossless)
     ///
     /// \param charsets a list of charsets supported by the DataSet
     ///
@@ -765,6 +827,34 @@ public:
     ///////////////////////////////////////////////////////////////////////////////
     void setImage(size_t frameNumber, const Image& image, imageQuality_t quality);
 
+#ifndef SWIG // Image cannot be stored in a SWIG wrapped vector
+    /// \brief Insert several consecutive frames into the dataset, encoding them
+    ///        in parallel.
+    ///
+    /// The frames are encoded by several threads into separate memory buffers,
+    /// then they are inserted into the dataset in order.
+    ///
+    /// The same rules of setImage() apply: the first frame must follow the
+    /// frames already in the dataset and all the images must have the same
+    /// properties, otherwise DataSetWrongFrameError or
+    /// DataSetDifferentFormatError is thrown.
+    ///
+    /// \param firstFrame   the frame number of the first image (the first frame
+    ///                     in the dataset is 0)
+    /// \param images       the images to insert
+    /// \param quality      the quality to use for lossy compression. Ignored
+    ///                     if lossless compression is used
+    /// \param threadsCount the number of threads used to encode the frames.
+    ///                     0 means one thread per hardware core. The
+    ///                     threads started by all the parallel operations
+    ///                     of the library are limited by a process-wide
+    ///                     budget (one thread per hardware core by
+    ///                     default)
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    void setImages(size_t firstFrame, const std::vector<Image>& images, imageQuality_t quality, size_t threadsCount);
+#endif
+
     void setOverlay(size_t overlayNumber, const Overlay& overlay);
 
     /// \brief Get a StreamWriter connected to a tag buffer's data.
@@ -129,6 +129,18 @@ enum class codecType_t: std::uint32_t
     jpeg   ///< JPEG codec
 };
 
+///
+/// \brief Defines the implementation of the 8x8 DCT used by the jpeg codec.
+///
+///////////////////////////////////////////////////////////////////////////////
+enum class jpegDct_t: std::uint32_t
+{
+    automatic = 0, ///< the fastest implementation supported by the CPU
+    portable = 1,  ///< the portable implementation, available on all the CPUs
+    sse2 = 2,      ///< the SSE2 implementation (x86 CPUs)
+    avx2 = 3       ///< the AVX2 implementation (x86 CPUs)
+};
+
 ///
 /// \brief Defines the Overlay type.
 ///
@@ -163,6 +175,7 @@ enum class tagVR_t: std::uint32_t
     OD = 0x4f44, ///< Other Double String
     OF = 0x4f46, ///< Other Float String
     OL = 0x4f4c, ///< Other Long String
+    OV = 0x4f56, ///< Other 64-bit Very Long
     OW = 0x4f57, ///< Other Word String
     PN = 0x504e, ///< Person Name
     SH = 0x5348, ///< Short String
@@ -198,6 +211,7 @@ static_assert((std::uint16_t)tagVR_t::SB == MAKE_VR_ENUM("SB"), "Wrong VR enumer
 static_assert((std::uint16_t)tagVR_t::OD == MAKE_VR_ENUM("OD"), "Wrong VR enumeration value");
 static_assert((std::uint16_t)tagVR_t::OF == MAKE_VR_ENUM("OF"), "Wrong VR enumeration value");
 static_assert((std::uint16_t)tagVR_t::OL == MAKE_VR_ENUM("OL"), "Wrong VR enumeration value");
+static_assert((std::uint16_t)tagVR_t::OV == MAKE_VR_ENUM("OV"), "Wrong VR enumeration value");
 static_assert((std::uint16_t)tagVR_t::OW == MAKE_VR_ENUM("OW"), "Wrong VR enumeration value");
 static_assert((std::uint16_t)tagVR_t::PN == MAKE_VR_ENUM("PN"), "Wrong VR enumeration value");
 static_assert((std::uint16_t)tagVR_t::SH == MAKE_VR_ENUM("SH"), "Wrong VR enumeration value");
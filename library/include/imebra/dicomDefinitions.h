@@ -4536,6 +4536,8 @@ enum class tagId_t: std::uint32_t
     VariableCoefficientsSDVN_7F00_0020 = 0x7F000020, ///< Variable Coefficients SDVN (7F00,0020)
     VariableCoefficientsSDHN_7F00_0030 = 0x7F000030, ///< Variable Coefficients SDHN (7F00,0030)
     VariableCoefficientsSDDN_7F00_0040 = 0x7F000040, ///< Variable Coefficients SDDN (7F00,0040)
+    ExtendedOffsetTable_7FE0_0001 = 0x7FE00001, ///< Extended Offset Table (7FE0,0001)
+    ExtendedOffsetTableLengths_7FE0_0002 = 0x7FE00002, ///< Extended Offset Table Lengths (7FE0,0002)
     FloatPixelData_7FE0_0008 = 0x7FE00008, ///< Float Pixel Data (7FE0,0008)
     DoubleFloatPixelData_7FE0_0009 = 0x7FE00009, ///< Double Float Pixel Data (7FE0,0009)
     PixelData_7FE0_0010 = 0x7FE00010, ///< Pixel Data (7FE0,0010)
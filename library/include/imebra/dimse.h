@@ -2219,7 +2219,11 @@ public:
     const NDeleteResponse getNDeleteResponse(const NDeleteCommand& command);
 
 #ifndef SWIG
+protected:
+    explicit DimseService(const std::shared_ptr<implementation::dimseService>& pDimseService);
+
 private:
+    friend class DimseServer;
     friend const std::shared_ptr<implementation::dimseService>& getDimseServiceImplementation(const DimseService& service);
     std::shared_ptr<implementation::dimseService> m_pDimseService;
 #endif
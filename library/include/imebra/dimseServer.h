@@ -0,0 +1,220 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file dimseServer.h
+    \brief Declaration of the the DimseServer class.
+*/
+
+#if !defined(imebraDimseServer__INCLUDED_)
+#define imebraDimseServer__INCLUDED_
+
+#include <memory>
+#include <string>
+#include "dimse.h"
+#include "definitions.h"
+
+namespace imebra
+{
+
+namespace implementation
+{
+    class dimseServer;
+}
+
+class TCPListener;
+class PresentationContexts;
+class PayloadSpoolFolders;
+
+///
+/// \brief Receives the DIMSE commands dispatched by a DimseServer.
+///
+/// Derive a class from DimseCommandsHandler and override
+/// processCommand() in order to reply to the incoming commands.
+///
+///////////////////////////////////////////////////////////////////////////////
+class IMEBRA_API DimseCommandsHandler
+{
+
+public:
+    virtual ~DimseCommandsHandler();
+
+    ///
+    /// \brief Called by the DimseServer when a command arrives on one of the
+    ///        served associations.
+    ///
+    /// The method is called on one of the DimseServer's handler threads and
+    /// must reply to the command via DimseService::sendCommandOrResponse().
+    /// The method can also send commands to the peer and wait for their
+    /// responses (e.g. the C-STORE commands related to a C-GET).
+    ///
+    /// The commands of the same association are processed one at the time,
+    /// while commands from different associations may be processed
+    /// simultaneously by different threads.
+    ///
+    /// If the method throws an exception then the association is aborted.
+    ///
+    /// \param dimseService the DimseService through which the command has
+    ///                     been received
+    /// \param command      the received command
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    virtual void processCommand(DimseService& dimseService, const DimseCommand& command) = 0;
+};
+
+
+///
+/// \brief Serves many associations with a small pool of threads.
+///
+/// The DimseServer accepts the connections arriving on a TCPListener,
+/// negotiates the associations and dispatches the incoming DIMSE commands to
+/// a DimseCommandsHandler.
+///
+/// Differently from an AssociationSCP used with a DimseService, the served
+/// associations don't have a dedicated reading thread: a single thread waits
+/// for incoming data on all the connections (via epoll on Linux) and the
+/// worker threads collect the incoming data without waiting for it.
+///
+/// When a whole PDU has been received the association is handed to one of
+/// the handler threads, which decodes the messages while they arrive and
+/// calls the DimseCommandsHandler. The handler threads are launched when
+/// needed, so a handler waiting for a response doesn't delay the other
+/// associations.
+///
+/// The association is released by the handler thread once all the received
+/// data has been processed: idle associations and peers that stop sending
+/// in the middle of a PDU don't occupy any thread.
+///
+///////////////////////////////////////////////////////////////////////////////
+class IMEBRA_API DimseServer
+{
+
+public:
+    ///
+    /// \brief Constructor. Starts serving the connections immediately.
+    ///
+    /// \param listener             the listener that accepts the connections.
+    ///                             The server calls TCPListener::terminate()
+    ///                             when it is terminated
+    /// \param thisAET              the AET of the SCP. If empty then the SCP
+    ///                             will accept associations for any called AET,
+    ///                             otherwise it will reject the association
+    ///                             when the called AET does not match this one
+    /// \param invokedOperations    maximum number of parallel operations we
+    ///                             intend to invoke when acting as a SCU
+    /// \param performedOperations  maximum number of parallel operations we can
+    ///                             perform when acting as a SCP
+    /// \param presentationContexts list of accepted presentation contexts
+    /// \param dimseTimeoutSeconds  DIMSE timeout, in seconds. 0 means infinite.
+    ///                             Maximum amount of time that can pass
+    ///                             between the first and the last part of a
+    ///                             command or payload, and maximum amount of
+    ///                             time that a handler waits for a message:
+    ///                             when it expires the association is aborted
+    /// \param artimTimeoutSeconds  ARTIM timeout, in seconds. Amount of time that
+    ///                             is allowed to pass between the connection
+    ///                             and the association request
+    /// \param workerThreads        number of threads that collect the incoming
+    ///                             data
+    /// \param handler              the object that receives the incoming
+    ///                             commands. It must stay valid until the
+    ///                             server is terminated
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    DimseServer(
+            TCPListener& listener,
+            const std::string& thisAET,
+            std::uint32_t invokedOperations,
+            std::uint32_t performedOperations,
+            const PresentationContexts& presentationContexts,
+            std::uint32_t dimseTimeoutSeconds,
+            std::uint32_t artimTimeoutSeconds,
+            std::uint32_t workerThreads,
+            DimseCommandsHandler& handler);
+
+    ///
+    /// \brief Constructor. Starts serving the connections immediately and
+    ///        spools the received payloads into temporary files.
+    ///
+    /// Same as the previous constructor, but the payloads of the abstract
+    /// syntaxes listed in spoolFolders are stored in temporary files (see
+    /// AssociationBase::setPayloadSpoolFolder()).
+    ///
+    /// \param listener             the listener that accepts the connections.
+    ///                             The server calls TCPListener::terminate()
+    ///                             when it is terminated
+    /// \param thisAET              the AET of the SCP. If empty then the SCP
+    ///                             will accept associations for any called AET
+    /// \param invokedOperations    maximum number of parallel operations we
+    ///                             intend to invoke when acting as a SCU
+    /// \param performedOperations  maximum number of parallel operations we can
+    ///                             perform when acting as a SCP
+    /// \param presentationContexts list of accepted presentation contexts
+    /// \param dimseTimeoutSeconds  DIMSE timeout, in seconds. 0 means infinite
+    /// \param artimTimeoutSeconds  ARTIM timeout, in seconds
+    /// \param workerThreads        number of threads that collect the incoming
+    ///                             data
+    /// \param handler              the object that receives the incoming
+    ///                             commands. It must stay valid until the
+    ///                             server is terminated
+    /// \param spoolFolders         the folders where the payloads are spooled,
+    ///                             per abstract syntax. The server keeps a
+    ///                             copy of the folders list
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    DimseServer(
+            TCPListener& listener,
+            const std::string& thisAET,
+            std::uint32_t invokedOperations,
+            std::uint32_t performedOperations,
+            const PresentationContexts& presentationContexts,
+            std::uint32_t dimseTimeoutSeconds,
+            std::uint32_t artimTimeoutSeconds,
+            std::uint32_t workerThreads,
+            DimseCommandsHandler& handler,
+            const PayloadSpoolFolders& spoolFolders);
+
+    ///
+    /// \brief Destructor. Terminates the server.
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    virtual ~DimseServer();
+
+    DimseServer(const DimseServer& source) = delete;
+
+    DimseServer& operator=(const DimseServer& source) = delete;
+
+    ///
+    /// \brief Stops accepting connections, aborts the open associations and
+    ///        waits for the running DimseCommandsHandler::processCommand()
+    ///        calls to return.
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    void terminate();
+
+    ///
+    /// \brief Returns the number of open connections.
+    ///
+    /// \return the number of connections currently served
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    size_t getConnectionsCount() const;
+
+#ifndef SWIG
+private:
+    std::shared_ptr<implementation::dimseServer> m_pDimseServer;
+#endif
+};
+
+}
+
+#endif // !defined(imebraDimseServer__INCLUDED_)
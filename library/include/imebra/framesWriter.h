@@ -0,0 +1,140 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file framesWriter.h
+    \brief Declaration of the class FramesWriter.
+
+*/
+
+#if !defined(imebraFramesWriter__INCLUDED_)
+#define imebraFramesWriter__INCLUDED_
+
+#include <memory>
+#include <cstdint>
+#include "definitions.h"
+
+namespace imebra
+{
+
+namespace implementation
+{
+    class framesWriter;
+}
+
+class MutableDataSet;
+class StreamWriter;
+class Image;
+
+///
+/// \brief Writes a multi-frame DICOM file with compressed (encapsulated)
+///        pixel data directly into a StreamWriter, one frame at a time.
+///
+/// Inserting the frames with MutableDataSet::setImage() keeps all the
+/// compressed frames in memory until the dataset is saved; the FramesWriter
+/// instead compresses each frame and writes it to the stream immediately,
+/// so only one compressed frame at a time is kept in memory.
+///
+/// The MutableDataSet passed to the constructor supplies the file's tags and
+/// the transfer syntax. It must not contain the pixel data (tag 7FE0,0010),
+/// otherwise the constructor throws DataSetWrongFrameError. When the first frame
+/// is added the FramesWriter stores the image's attributes and the number of
+/// frames into it and writes the header. Each frame is written as a single
+/// fragment; the Basic Offset Table is left empty because the frames'
+/// positions are not known when it is written.
+///
+/// Optionally the FramesWriter can also write the Extended Offset Table
+/// (tag 7FE0,0001) and the Extended Offset Table Lengths (tag 7FE0,0002),
+/// which allow readers to locate any frame with a single 64 bit seek:
+/// the space for the tables is reserved in the header and filled by
+/// close(), therefore the StreamWriter must write into a file or a memory
+/// stream.
+///
+/// Call close() after the last frame to terminate the pixel data and write
+/// the tags that follow it: the file is incomplete until close() returns.
+///
+///////////////////////////////////////////////////////////////////////////////
+class IMEBRA_API FramesWriter
+{
+
+public:
+    /// \brief Constructor.
+    ///
+    /// \param dataSet      the dataset containing the file's tags and the
+    ///                     transfer syntax (tag 0002,0010). The transfer
+    ///                     syntax must be an encapsulated one, otherwise
+    ///                     CodecWrongTransferSyntaxError is thrown when the
+    ///                     first frame is added
+    /// \param writer       the StreamWriter into which the file is written
+    /// \param framesNumber the number of frames that will be written
+    /// \param quality      the quality to use for lossy compression. Ignored
+    ///                     if lossless compression is used
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    FramesWriter(MutableDataSet& dataSet, StreamWriter& writer, std::uint32_t framesNumber, imageQuality_t quality);
+
+    /// \brief Constructor.
+    ///
+    /// \param dataSet      the dataset containing the file's tags and the
+    ///                     transfer syntax (tag 0002,0010). The transfer
+    ///                     syntax must be an encapsulated one, otherwise
+    ///                     CodecWrongTransferSyntaxError is thrown when the
+    ///                     first frame is added
+    /// \param writer       the StreamWriter into which the file is written.
+    ///                     If bExtendedOffsetTable is true then it must
+    ///                     write into a file or a memory stream, otherwise
+    ///                     StreamWriteError is thrown
+    /// \param framesNumber the number of frames that will be written
+    /// \param quality      the quality to use for lossy compression. Ignored
+    ///                     if lossless compression is used
+    /// \param bExtendedOffsetTable true if the Extended Offset Table and the
+    ///                     Extended Offset Table Lengths must be written
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    FramesWriter(MutableDataSet& dataSet, StreamWriter& writer, std::uint32_t framesNumber, imageQuality_t quality, bool bExtendedOffsetTable);
+
+    FramesWriter(const FramesWriter& source) = delete;
+
+    FramesWriter& operator=(const FramesWriter& source) = delete;
+
+    virtual ~FramesWriter();
+
+    /// \brief Compress a frame and write it into the stream.
+    ///
+    /// All the frames must have the same properties (size, color space,
+    /// high bit), otherwise DataSetDifferentFormatError is thrown.
+    /// If all the declared frames have already been written then
+    /// DataSetWrongFrameError is thrown.
+    ///
+    /// \param image the frame to write
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    void addFrame(const Image& image);
+
+    /// \brief Terminate the pixel data, write the tags that follow it and
+    ///        flush the stream.
+    ///
+    /// If the number of frames written differs from the one declared in the
+    /// constructor then DataSetWrongFrameError is thrown.
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    void close();
+
+#ifndef SWIG
+private:
+    std::shared_ptr<implementation::framesWriter> m_pFramesWriter;
+#endif
+};
+
+}
+
+#endif // !defined(imebraFramesWriter__INCLUDED_)
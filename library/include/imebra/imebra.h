@@ -33,6 +33,8 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "exceptions.h"
 #include "fileStreamInput.h"
 #include "fileStreamOutput.h"
+#include "framesWriter.h"
+#include "mappedFileStreamInput.h"
 #include "image.h"
 #include "lut.h"
 #include "memory.h"
@@ -58,6 +60,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "pipeStream.h"
 #include "acse.h"
 #include "dimse.h"
+#include "dimseServer.h"
 #include "uidGeneratorFactory.h"
 #include "randomUidGenerator.h"
 #include "serialNumberUidGenerator.h"
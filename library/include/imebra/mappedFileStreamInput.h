@@ -0,0 +1,79 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file mappedFileStreamInput.h
+    \brief Declaration of the MappedFileStreamInput class.
+
+*/
+
+#if !defined(imebraMappedFileStreamInput__INCLUDED_)
+#define imebraMappedFileStreamInput__INCLUDED_
+
+#include <string>
+#include "baseStreamInput.h"
+#include "definitions.h"
+
+namespace imebra
+{
+
+///
+/// \brief Represents an input file stream that maps the whole file in
+///        memory.
+///
+/// Reading from a MappedFileStreamInput does not involve any system call
+/// and the tags that are loaded lazily from the stream (see
+/// CodecFactory::load()) reference the mapped file directly instead of
+/// copying their content in memory.
+///
+/// The file is unmapped when the stream and all the data loaded from it
+/// have been destroyed.
+///
+///////////////////////////////////////////////////////////////////////////////
+class IMEBRA_API MappedFileStreamInput : public BaseStreamInput
+{
+
+public:
+    /// \brief Constructor.
+    ///
+    /// \param name the path to the file to map in read mode
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+#ifndef SWIG // Use only UTF-8 strings with SWIG
+    explicit MappedFileStreamInput(const std::wstring& name);
+#endif
+
+    /// \brief Constructor.
+    ///
+    /// \param name the path to the file to map in read mode, in encoded in UTF8
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    explicit MappedFileStreamInput(const std::string& name);
+
+    ///
+    /// \brief Copy constructor.
+    ///
+    /// \param source source MappedFileStreamInput object
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    MappedFileStreamInput(const MappedFileStreamInput& source);
+
+    MappedFileStreamInput& operator=(const MappedFileStreamInput& source) = delete;
+
+    /// \brief Destructor.
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    ~MappedFileStreamInput();
+};
+
+}
+#endif // !defined(imebraMappedFileStreamInput__INCLUDED_)
@@ -37,13 +37,17 @@ namespace implementation
 /// MemoryPool keeps around recently deleted memory regions so they can be
 /// repurposed quickly when new memory regions are requested.
 ///
-/// Each thread has its own MemoryPool object.
+/// Each thread has its own MemoryPool object. When a thread's MemoryPool
+/// is full (or when the thread terminates) the oldest memory regions are
+/// moved to a pool shared by all the threads, where they can be picked up
+/// by a thread different from the one that released them.
 ///
 ///////////////////////////////////////////////////////////////////////////////
 class IMEBRA_API MemoryPool
 {
 public:
-    /// \brief Release all the unused memory regions.
+    /// \brief Release all the unused memory regions kept by the current
+    ///        thread and by the shared memory pool.
     ///
     ///////////////////////////////////////////////////////////////////////////////
     static void flush();
@@ -70,6 +74,41 @@ public:
     ///
     ///////////////////////////////////////////////////////////////////////////////
     static void setMemoryPoolSize(size_t minMemoryBlockSize, size_t maxMemoryPoolSize);
+
+    /// \brief Return the total size of the unused memory regions kept by the
+    ///        memory pool shared by all the threads.
+    ///
+    /// \return the total size of the memory kept by the shared memory pool
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static size_t getSharedUnusedMemorySize();
+
+    /// \brief Set the maximum size of the unused memory kept by the memory
+    ///        pool shared by all the threads.
+    ///
+    /// \param maxSharedMemoryPoolSize the maximum size of the sum of all the
+    ///                                unused memory regions kept by the shared
+    ///                                memory pool
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static void setSharedMemoryPoolSize(size_t maxSharedMemoryPoolSize);
+
+    /// \brief Return the number of memory requests, across all the threads,
+    ///        that have been satisfied by reusing an unused memory region.
+    ///
+    /// \return the number of memory requests satisfied by the memory pools
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static size_t getHitsCount();
+
+    /// \brief Return the number of memory requests, across all the threads,
+    ///        that could have been satisfied by the memory pools but required
+    ///        a new allocation.
+    ///
+    /// \return the number of memory requests that required a new allocation
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    static size_t getMissesCount();
 };
 
 }
@@ -89,6 +89,40 @@ const std::shared_ptr<implementation::presentationContexts>& getPresentationCont
 }
 
 
+//
+// PayloadSpoolFolders methods
+//
+///////////////////////////////////////////////////////////////////////////////
+
+PayloadSpoolFolders::PayloadSpoolFolders():
+    m_pPayloadSpoolFolders(std::make_shared<implementation::payloadSpoolFolders>())
+{
+}
+
+PayloadSpoolFolders::PayloadSpoolFolders(const PayloadSpoolFolders& source):
+    m_pPayloadSpoolFolders(getPayloadSpoolFoldersImplementation(source))
+{
+}
+
+PayloadSpoolFolders::~PayloadSpoolFolders()
+{
+}
+
+void PayloadSpoolFolders::setPayloadSpoolFolder(const std::string& abstractSyntax, const std::string& spoolFolder, std::uint32_t maxSizeBufferLoad)
+{
+    IMEBRA_FUNCTION_START();
+
+    m_pPayloadSpoolFolders->setPayloadSpoolFolder(abstractSyntax, spoolFolder, maxSizeBufferLoad);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+const std::shared_ptr<implementation::payloadSpoolFolders>& getPayloadSpoolFoldersImplementation(const PayloadSpoolFolders& spoolFolders)
+{
+    return spoolFolders.m_pPayloadSpoolFolders;
+}
+
+
 //
 // AssociationMessage methods
 //
@@ -271,6 +305,15 @@ std::vector<std::string> AssociationBase::getTransferSyntaxes(const std::string&
     return m_pAssociation->getPresentationContextTransferSyntaxes(abstractSyntax);
 }
 
+void AssociationBase::setPayloadSpoolFolder(const std::string& abstractSyntax, const std::string& spoolFolder, std::uint32_t maxSizeBufferLoad)
+{
+    IMEBRA_FUNCTION_START();
+
+    m_pAssociation->setPayloadSpoolFolder(abstractSyntax, spoolFolder, maxSizeBufferLoad);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
 
 const std::shared_ptr<implementation::associationBase>& getAssociationBaseImplementation(const AssociationBase& associationBase)
 {
@@ -335,7 +378,33 @@ AssociationSCP::AssociationSCP(
                 pInput.m_pReader,
                 pOutput.m_pWriter,
                 dimseTimeoutSeconds,
-                        artimTimeoutSeconds))
+                        artimTimeoutSeconds,
+                        nullptr,
+                        true))
+{
+}
+
+AssociationSCP::AssociationSCP(
+        const std::string& thisAET,
+        std::uint32_t invokedOperations,
+        std::uint32_t performedOperations,
+        const PresentationContexts& presentationContexts,
+        StreamReader& pInput,
+        StreamWriter& pOutput,
+        std::uint32_t dimseTimeoutSeconds,
+        std::uint32_t artimTimeoutSeconds,
+        const PayloadSpoolFolders& spoolFolders):
+    AssociationBase(std::make_shared<implementation::associationSCP>(
+                        getPresentationContextsImplementation(presentationContexts),
+                        thisAET,
+                        invokedOperations,
+                        performedOperations,
+                        pInput.m_pReader,
+                        pOutput.m_pWriter,
+                        dimseTimeoutSeconds,
+                        artimTimeoutSeconds,
+                        getPayloadSpoolFoldersImplementation(spoolFolders),
+                        true))
 {
 }
 
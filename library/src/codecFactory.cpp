@@ -24,7 +24,9 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include "../implementation/codecFactoryImpl.h"
 #include "../implementation/streamCodecImpl.h"
 #include "../implementation/imageCodecImpl.h"
+#include "../implementation/jpegDctImpl.h"
 #include "../implementation/exceptionImpl.h"
+#include "../implementation/loadedMemoryCacheImpl.h"
 
 namespace imebra
 {
@@ -34,7 +36,21 @@ const DataSet CodecFactory::load(StreamReader& reader, size_t maxSizeBufferLoad
     IMEBRA_FUNCTION_START();
 
     std::shared_ptr<imebra::implementation::codecs::codecFactory> factory(imebra::implementation::codecs::codecFactory::getCodecFactory());
-    return DataSet(factory->load(reader.m_pReader, (std::uint32_t)maxSizeBufferLoad));
+    std::shared_ptr<implementation::dataSet> pDataSet(factory->load(reader.m_pReader, (std::uint32_t)maxSizeBufferLoad));
+    pDataSet->freeze();
+    return DataSet(pDataSet);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+const DataSet CodecFactory::load(StreamReader& reader, size_t maxSizeBufferLoad, const TagId& stopTag)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<imebra::implementation::codecs::codecFactory> factory(imebra::implementation::codecs::codecFactory::getCodecFactory());
+    std::shared_ptr<implementation::dataSet> pDataSet(factory->load(reader.m_pReader, (std::uint32_t)maxSizeBufferLoad, ((std::uint32_t)stopTag.getGroupId() << 16) | stopTag.getTagId()));
+    pDataSet->freeze();
+    return DataSet(pDataSet);
 
     IMEBRA_FUNCTION_END_LOG();
 }
@@ -63,6 +79,30 @@ const DataSet CodecFactory::load(const std::string& fileName, size_t maxSizeBuff
     IMEBRA_FUNCTION_END_LOG();
 }
 
+const DataSet CodecFactory::load(const std::wstring& fileName, size_t maxSizeBufferLoad, const TagId& stopTag)
+{
+    IMEBRA_FUNCTION_START();
+
+    FileStreamInput file(fileName);
+
+    StreamReader reader(file);
+    return load(reader, maxSizeBufferLoad, stopTag);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+const DataSet CodecFactory::load(const std::string& fileName, size_t maxSizeBufferLoad, const TagId& stopTag)
+{
+    IMEBRA_FUNCTION_START();
+
+    FileStreamInput file(fileName);
+
+    StreamReader reader(file);
+    return load(reader, maxSizeBufferLoad, stopTag);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
 void CodecFactory::saveImage(
         StreamWriter& destStream,
         const Image& sourceImage,
@@ -95,6 +135,90 @@ void CodecFactory::setMaximumImageSize(const std::uint32_t maximumWidth, const s
 }
 
 
+void CodecFactory::setJpegDecodingThreads(std::uint32_t threadsCount)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<imebra::implementation::codecs::codecFactory> factory(imebra::implementation::codecs::codecFactory::getCodecFactory());
+    factory->setJpegDecodingThreads(threadsCount);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+void CodecFactory::setJpegRestartRows(std::uint32_t mcuRows)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<imebra::implementation::codecs::codecFactory> factory(imebra::implementation::codecs::codecFactory::getCodecFactory());
+    factory->setJpegRestartRows(mcuRows);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+void CodecFactory::setJpegStandardHuffmanTables(bool bStandardTables)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<imebra::implementation::codecs::codecFactory> factory(imebra::implementation::codecs::codecFactory::getCodecFactory());
+    factory->setJpegStandardHuffmanTables(bStandardTables);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+void CodecFactory::setJpegDct(jpegDct_t dct)
+{
+    IMEBRA_FUNCTION_START();
+
+    implementation::codecs::jpegDct::setJpegDct(dct);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+jpegDct_t CodecFactory::getJpegDct()
+{
+    IMEBRA_FUNCTION_START();
+
+    return implementation::codecs::jpegDct::getJpegDct().m_type;
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+void CodecFactory::setRLEEncodingThreads(std::uint32_t threadsCount)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::shared_ptr<imebra::implementation::codecs::codecFactory> factory(imebra::implementation::codecs::codecFactory::getCodecFactory());
+    factory->setRLEEncodingThreads(threadsCount);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+void CodecFactory::setLazyLoadCacheSize(size_t maxCacheSize)
+{
+    IMEBRA_FUNCTION_START();
+
+    implementation::loadedMemoryCache::getLoadedMemoryCache().setMaxSize(maxCacheSize);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+size_t CodecFactory::getLazyLoadCacheUsedSize()
+{
+    IMEBRA_FUNCTION_START();
+
+    return implementation::loadedMemoryCache::getLoadedMemoryCache().getSize();
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
 void CodecFactory::save(const DataSet& dataSet, StreamWriter& writer, codecType_t codecType)
 {
     IMEBRA_FUNCTION_START();
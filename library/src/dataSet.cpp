@@ -97,6 +97,33 @@ const Image DataSet::getImage(size_t frameNumber) const
     IMEBRA_FUNCTION_END_LOG();
 }
 
+const Image DataSet::getImage(size_t frameNumber, std::uint32_t left, std::uint32_t top, std::uint32_t width, std::uint32_t height) const
+{
+    IMEBRA_FUNCTION_START();
+
+    return Image(m_pDataSet->getImage(static_cast<std::uint32_t>(frameNumber), left, top, width, height));
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+std::vector<Image> DataSet::getImages(size_t firstFrame, size_t framesCount, size_t threadsCount) const
+{
+    IMEBRA_FUNCTION_START();
+
+    const std::vector<std::shared_ptr<implementation::image> > images(
+                m_pDataSet->getImages(static_cast<std::uint32_t>(firstFrame), static_cast<std::uint32_t>(framesCount), threadsCount));
+
+    std::vector<Image> returnImages;
+    returnImages.reserve(images.size());
+    for(const std::shared_ptr<implementation::image>& pImage: images)
+    {
+        returnImages.push_back(Image(pImage));
+    }
+    return returnImages;
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
 const Overlay DataSet::getOverlay(size_t overlayNumber) const
 {
     IMEBRA_FUNCTION_START();
@@ -484,6 +511,21 @@ void MutableDataSet::setImage(size_t frameNumber, const Image& image, imageQuali
     IMEBRA_FUNCTION_END_LOG();
 }
 
+void MutableDataSet::setImages(size_t firstFrame, const std::vector<Image>& images, imageQuality_t quality, size_t threadsCount)
+{
+    IMEBRA_FUNCTION_START();
+
+    std::vector<std::shared_ptr<implementation::image> > implementationImages;
+    implementationImages.reserve(images.size());
+    for(const Image& image: images)
+    {
+        implementationImages.push_back(getImageImplementation(image));
+    }
+    getDataSetImplementation(*this)->setImages(static_cast<std::uint32_t>(firstFrame), implementationImages, quality, threadsCount);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
 void MutableDataSet::setOverlay(size_t overlayNumber, const Overlay& overlay)
 {
     IMEBRA_FUNCTION_START();
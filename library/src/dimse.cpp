@@ -1299,6 +1299,11 @@ DimseService::DimseService(const DimseService& source): m_pDimseService(getDimse
 }
 
 
+DimseService::DimseService(const std::shared_ptr<implementation::dimseService>& pDimseService): m_pDimseService(pDimseService)
+{
+}
+
+
 DimseService::~DimseService()
 {
 }
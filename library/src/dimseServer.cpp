@@ -0,0 +1,109 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file dimseServer.cpp
+    \brief Implementation of the the DimseServer class.
+*/
+
+#include "../include/imebra/dimseServer.h"
+#include "../include/imebra/tcpListener.h"
+#include "../include/imebra/acse.h"
+#include "../implementation/dimseServerImpl.h"
+#include "../implementation/dimseImpl.h"
+
+namespace imebra
+{
+
+DimseCommandsHandler::~DimseCommandsHandler()
+{
+}
+
+
+DimseServer::DimseServer(
+        TCPListener& listener,
+        const std::string& thisAET,
+        std::uint32_t invokedOperations,
+        std::uint32_t performedOperations,
+        const PresentationContexts& presentationContexts,
+        std::uint32_t dimseTimeoutSeconds,
+        std::uint32_t artimTimeoutSeconds,
+        std::uint32_t workerThreads,
+        DimseCommandsHandler& handler):
+    DimseServer(listener, thisAET, invokedOperations, performedOperations, presentationContexts, dimseTimeoutSeconds, artimTimeoutSeconds, workerThreads, handler, PayloadSpoolFolders())
+{
+}
+
+
+DimseServer::DimseServer(
+        TCPListener& listener,
+        const std::string& thisAET,
+        std::uint32_t invokedOperations,
+        std::uint32_t performedOperations,
+        const PresentationContexts& presentationContexts,
+        std::uint32_t dimseTimeoutSeconds,
+        std::uint32_t artimTimeoutSeconds,
+        std::uint32_t workerThreads,
+        DimseCommandsHandler& handler,
+        const PayloadSpoolFolders& spoolFolders)
+{
+    IMEBRA_FUNCTION_START();
+
+    DimseCommandsHandler* pHandler(&handler);
+
+    m_pDimseServer = std::make_shared<implementation::dimseServer>(
+                getTCPListenerImplementation(listener),
+                getPresentationContextsImplementation(presentationContexts),
+                thisAET,
+                invokedOperations,
+                performedOperations,
+                dimseTimeoutSeconds,
+                artimTimeoutSeconds,
+                getPayloadSpoolFoldersImplementation(spoolFolders),
+                (size_t)workerThreads,
+                [pHandler](const std::shared_ptr<implementation::dimseService>& pDimseService)
+                {
+                    DimseService dimseService(pDimseService);
+                    const DimseCommand command(dimseService.getCommand());
+                    pHandler->processCommand(dimseService, command);
+                });
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+DimseServer::~DimseServer()
+{
+    m_pDimseServer->terminate();
+}
+
+
+void DimseServer::terminate()
+{
+    IMEBRA_FUNCTION_START();
+
+    m_pDimseServer->terminate();
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+
+size_t DimseServer::getConnectionsCount() const
+{
+    IMEBRA_FUNCTION_START();
+
+    return m_pDimseServer->getConnectionsCount();
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+}
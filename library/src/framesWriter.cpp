@@ -0,0 +1,79 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+/*! \file framesWriter.cpp
+    \brief Implementation of the class FramesWriter.
+
+*/
+
+#include "../include/imebra/framesWriter.h"
+#include "../include/imebra/dataSet.h"
+#include "../include/imebra/image.h"
+#include "../include/imebra/streamWriter.h"
+#include "../implementation/framesWriterImpl.h"
+#include "../implementation/exceptionImpl.h"
+
+namespace imebra
+{
+
+FramesWriter::FramesWriter(MutableDataSet& dataSet, StreamWriter& writer, std::uint32_t framesNumber, imageQuality_t quality)
+{
+    IMEBRA_FUNCTION_START();
+
+    m_pFramesWriter = std::make_shared<implementation::framesWriter>(
+                getDataSetImplementation(dataSet),
+                getStreamWriterImplementation(writer),
+                framesNumber,
+                quality,
+                false);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+FramesWriter::FramesWriter(MutableDataSet& dataSet, StreamWriter& writer, std::uint32_t framesNumber, imageQuality_t quality, bool bExtendedOffsetTable)
+{
+    IMEBRA_FUNCTION_START();
+
+    m_pFramesWriter = std::make_shared<implementation::framesWriter>(
+                getDataSetImplementation(dataSet),
+                getStreamWriterImplementation(writer),
+                framesNumber,
+                quality,
+                bExtendedOffsetTable);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+FramesWriter::~FramesWriter()
+{
+}
+
+void FramesWriter::addFrame(const Image& image)
+{
+    IMEBRA_FUNCTION_START();
+
+    m_pFramesWriter->addFrame(getImageImplementation(image));
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+void FramesWriter::close()
+{
+    IMEBRA_FUNCTION_START();
+
+    m_pFramesWriter->close();
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+}
@@ -23,6 +23,7 @@ void MemoryPool::flush()
     IMEBRA_FUNCTION_START();
 
     implementation::memoryPoolGetter::getMemoryPoolGetter().getMemoryPoolLocal().flush();
+    implementation::memoryPoolDepot::getMemoryPoolDepot().flush();
 
     IMEBRA_FUNCTION_END_LOG();
 }
@@ -45,4 +46,40 @@ void MemoryPool::setMemoryPoolSize(size_t minMemoryBlockSize, size_t maxMemoryPo
     IMEBRA_FUNCTION_END_LOG();
 }
 
+size_t MemoryPool::getSharedUnusedMemorySize()
+{
+    IMEBRA_FUNCTION_START();
+
+    return implementation::memoryPoolDepot::getMemoryPoolDepot().getUnusedMemorySize();
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+void MemoryPool::setSharedMemoryPoolSize(size_t maxSharedMemoryPoolSize)
+{
+    IMEBRA_FUNCTION_START();
+
+    implementation::memoryPoolDepot::getMemoryPoolDepot().setMaxMemory(maxSharedMemoryPoolSize);
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+size_t MemoryPool::getHitsCount()
+{
+    IMEBRA_FUNCTION_START();
+
+    return implementation::memoryPoolDepot::getMemoryPoolDepot().getHitsCount();
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
+size_t MemoryPool::getMissesCount()
+{
+    IMEBRA_FUNCTION_START();
+
+    return implementation::memoryPoolDepot::getMemoryPoolDepot().getMissesCount();
+
+    IMEBRA_FUNCTION_END_LOG();
+}
+
 }
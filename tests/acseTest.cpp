@@ -6,6 +6,11 @@
 #include <fstream>
 #include <sstream>
 #include "testsSettings.h"
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+#endif
 
 namespace imebra
 {
@@ -629,6 +634,418 @@ TEST(acseTest, sendPayload)
 }
 
 
+size_t countSpoolFiles(const std::string& folder)
+{
+    const std::string prefix("imebra_spool_");
+    size_t spoolFiles(0);
+
+#ifdef _WIN32
+    WIN32_FIND_DATA findFileData;
+    HANDLE hFind(FindFirstFile((folder + "\\" + prefix + "*").c_str(), &findFileData));
+    if(hFind != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            ++spoolFiles;
+        } while(FindNextFile(hFind, &findFileData) != 0);
+        FindClose(hFind);
+    }
+#else
+    DIR* pDir(opendir(folder.c_str()));
+    if(pDir != 0)
+    {
+        for(struct dirent* pEntry(readdir(pDir)); pEntry != 0; pEntry = readdir(pDir))
+        {
+            if(std::string(pEntry->d_name).compare(0, prefix.size(), prefix) == 0)
+            {
+                ++spoolFiles;
+            }
+        }
+        closedir(pDir);
+    }
+#endif
+
+    return spoolFiles;
+}
+
+
+void scpThreadLargeResponse(const std::string& name, PresentationContexts& presentationContexts, StreamReader& readSCP, StreamWriter& writeSCP, size_t payloadSize)
+{
+    try
+    {
+        AssociationSCP scp(name, 1, 1, presentationContexts, readSCP, writeSCP, 0, 10);
+
+        for(;;)
+        {
+            AssociationMessage command = scp.getCommand();
+
+            MutableAssociationMessage response(command.getAbstractSyntax());
+            MutableDataSet responseDataSet;
+            responseDataSet.setUnsignedLong(TagId(tagId_t::CommandField_0000_0100), 0x8001, tagVR_t::US);
+            responseDataSet.setUnsignedLong(TagId(tagId_t::MessageIDBeingRespondedTo_0000_0120), command.getCommand().getUnsignedLong(TagId(tagId_t::MessageID_0000_0110), 0), tagVR_t::US);
+            responseDataSet.setUnsignedLong(TagId(tagId_t::CommandDataSetType_0000_0800), 0);
+            responseDataSet.setUnsignedLong(TagId(tagId_t::Status_0000_0900), 0x0000);
+            response.addDataSet(responseDataSet);
+
+            MutableDataSet payload(scp.getTransferSyntax(command.getAbstractSyntax()));
+            {
+                WritingDataHandlerNumeric writing = payload.getWritingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 0, tagVR_t::OB);
+                writing.setSize(payloadSize);
+            }
+            response.addDataSet(payload);
+
+            scp.sendMessage(response);
+        }
+    }
+    catch(const std::runtime_error&)
+    {
+
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Forward whole PDUs from the reader to the writer until
+//  at least minBytes bytes have been forwarded, then close
+//  the destination pipe and discard the remaining data
+//
+///////////////////////////////////////////////////////////
+void truncatingProxyThread(StreamReader& reader, StreamWriter& writer, PipeStream& destination, size_t minBytes)
+{
+    size_t forwardedBytes(0);
+    try
+    {
+        for(;;)
+        {
+            std::vector<char> pdu(6);
+            reader.read(pdu.data(), pdu.size());
+            const size_t pduLength(
+                        ((size_t)(std::uint8_t)pdu[2] << 24) |
+                        ((size_t)(std::uint8_t)pdu[3] << 16) |
+                        ((size_t)(std::uint8_t)pdu[4] << 8) |
+                        (size_t)(std::uint8_t)pdu[5]);
+            pdu.resize(6 + pduLength);
+            reader.read(pdu.data() + 6, pduLength);
+
+            if(forwardedBytes < minBytes)
+            {
+                writer.write(pdu.data(), pdu.size());
+                writer.flush();
+                forwardedBytes += pdu.size();
+                if(forwardedBytes >= minBytes)
+                {
+                    destination.close(50000);
+                }
+            }
+        }
+    }
+    catch(const std::runtime_error&)
+    {
+
+    }
+}
+
+
+TEST(acseTest, sendPayloadSpool)
+{
+    PipeStream toSCU(1024), toSCP(1024);
+
+    StreamReader readSCU(toSCU.getStreamInput());
+    StreamWriter writeSCU(toSCP.getStreamOutput());
+
+    StreamReader readSCP(toSCP.getStreamInput());
+    StreamWriter writeSCP(toSCU.getStreamOutput());
+
+    PresentationContext scuContext("1.2.840.10008.1.1");
+    scuContext.addTransferSyntax("1.2.840.10008.1.2"); // implicit VR little endian
+    scuContext.addTransferSyntax("1.2.840.10008.1.2.1"); // explicit VR little endian
+    PresentationContexts scuPresentationContexts;
+    scuPresentationContexts.addPresentationContext(scuContext);
+
+    PresentationContext scpContext("1.2.840.10008.1.1");
+    scpContext.addTransferSyntax("1.2.840.10008.1.2.1"); // explicit VR little endian
+    PresentationContexts scpPresentationContexts;
+    scpPresentationContexts.addPresentationContext(scpContext);
+
+    const std::string scpName("SCP");
+
+    const size_t maxPayloadSize(128000);
+
+    // Spool the received payloads in the temporary folder
+    char* tempFileName = ::tempnam(0, "dcmimebraspool");
+    std::string spoolFolder(tempFileName);
+    free(tempFileName);
+    spoolFolder = spoolFolder.substr(0, spoolFolder.find_last_of("/\\"));
+
+    std::vector<std::string> scpAbstractSyntaxes;
+    std::thread scp(imebra::tests::scpThread, std::ref(scpName), std::ref(scpPresentationContexts), std::ref(readSCP), std::ref(writeSCP), std::ref(scpAbstractSyntaxes), std::ref(scpAbstractSyntaxes));
+
+    try{
+
+    {
+        AssociationSCU scu("SCU", scpName, 1, 1, scuPresentationContexts, readSCU, writeSCU, 0);
+        scu.setPayloadSpoolFolder("1.2.840.10008.1.1", spoolFolder, 1024);
+
+        for(size_t payloadSize(1); payloadSize < maxPayloadSize; payloadSize += 12800)
+        {
+            MutableAssociationMessage command("1.2.840.10008.1.1");
+
+            MutableDataSet dataset0;
+            dataset0.setUnsignedLong(TagId(tagId_t::CommandField_0000_0100), 0x1, tagVR_t::US);
+            dataset0.setUnsignedLong(TagId(tagId_t::MessageID_0000_0110), 0x1, tagVR_t::US);
+            dataset0.setUnsignedLong(TagId(tagId_t::CommandDataSetType_0000_0800), 0);
+
+            command.addDataSet(dataset0);
+
+            MutableDataSet payload(scu.getTransferSyntax("1.2.840.10008.1.1"));
+            {
+                WritingDataHandlerNumeric writing = payload.getWritingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 0, tagVR_t::OB);
+                writing.setSize(payloadSize);
+                size_t dummy;
+                char* payloadData(writing.data(&dummy));
+                for(size_t fillPayload(0); fillPayload != payloadSize; ++fillPayload)
+                {
+                    payloadData[fillPayload] = (char)(fillPayload & 0x7f);
+                }
+            }
+            command.addDataSet(payload);
+
+            scu.sendMessage(command);
+
+            AssociationMessage response = scu.getResponse(1);
+            DataSet responsePayload = response.getPayload();
+
+            EXPECT_EQ("1.2.840.10008.1.1", response.getAbstractSyntax());
+            {
+                ReadingDataHandlerNumeric reading = responsePayload.getReadingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 0);
+                size_t dummy;
+                const char* payloadData(reading.data(&dummy));
+                for(size_t fillPayload(0); fillPayload != payloadSize; ++fillPayload)
+                {
+                    EXPECT_EQ(payloadData[fillPayload], (char)(fillPayload & 0x7f));
+                }
+                EXPECT_EQ(reading.getSize(), (payloadSize + 1) & 0xfffffffe);
+            }
+        }
+        scu.release();
+    }
+
+    }
+    catch(std::runtime_error& e)
+    {
+        std::cout << e.what() << std::endl;
+    }
+
+
+    scp.join();
+
+    // The spool files are removed as soon as they are mapped
+    ///////////////////////////////////////////////////////////
+    const size_t spoolFiles(countSpoolFiles(spoolFolder));
+
+    // Abort the association while the SCU is spooling a
+    //  response payload: the truncated spool file must be
+    //  removed
+    ///////////////////////////////////////////////////////////
+    {
+        PipeStream toProxy(1024), toAbortedSCU(1024), toAbortedSCP(1024);
+
+        StreamReader readProxy(toProxy.getStreamInput());
+        StreamWriter writeProxy(toAbortedSCU.getStreamOutput());
+
+        StreamReader readAbortedSCU(toAbortedSCU.getStreamInput());
+        StreamWriter writeAbortedSCU(toAbortedSCP.getStreamOutput());
+
+        StreamReader readAbortedSCP(toAbortedSCP.getStreamInput());
+        StreamWriter writeAbortedSCP(toProxy.getStreamOutput());
+
+        std::thread abortedSCP(imebra::tests::scpThreadLargeResponse, std::ref(scpName), std::ref(scpPresentationContexts), std::ref(readAbortedSCP), std::ref(writeAbortedSCP), maxPayloadSize);
+
+        // Forward the association negotiation and the beginning
+        //  of the response payload, then close the SCU input
+        std::thread proxy(imebra::tests::truncatingProxyThread, std::ref(readProxy), std::ref(writeProxy), std::ref(toAbortedSCU), maxPayloadSize / 2);
+
+        {
+            AssociationSCU scu("SCU", scpName, 1, 1, scuPresentationContexts, readAbortedSCU, writeAbortedSCU, 0);
+            scu.setPayloadSpoolFolder("1.2.840.10008.1.1", spoolFolder, 1024);
+
+            MutableAssociationMessage command("1.2.840.10008.1.1");
+            MutableDataSet dataset0;
+            dataset0.setUnsignedLong(TagId(tagId_t::CommandField_0000_0100), 0x1, tagVR_t::US);
+            dataset0.setUnsignedLong(TagId(tagId_t::MessageID_0000_0110), 0x1, tagVR_t::US);
+            dataset0.setUnsignedLong(TagId(tagId_t::CommandDataSetType_0000_0800), 0x0101);
+            command.addDataSet(dataset0);
+
+            scu.sendMessage(command);
+
+            EXPECT_THROW(scu.getResponse(1), std::runtime_error);
+        }
+
+        toAbortedSCP.close(0);
+        abortedSCP.join();
+        toProxy.close(0);
+        proxy.join();
+    }
+
+    EXPECT_EQ(spoolFiles, countSpoolFiles(spoolFolder));
+}
+
+
+
+void scpThreadSpool(const std::string& name, PresentationContexts& presentationContexts, StreamReader& readSCP, StreamWriter& writeSCP, PayloadSpoolFolders& spoolFolders)
+{
+    try
+    {
+        AssociationSCP scp(name, 1, 1, presentationContexts, readSCP, writeSCP, 0, 10, spoolFolders);
+
+        for(;;)
+        {
+            AssociationMessage command = scp.getCommand();
+            DataSet payload = command.getPayload();
+
+            // Check the received payload. The payload size grows
+            //  by 12800 bytes with each message
+            ///////////////////////////////////////////////////////////
+            std::uint16_t status(0);
+            {
+                ReadingDataHandlerNumeric reading = payload.getReadingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 0);
+                const std::uint32_t payloadSize(1 + (command.getCommand().getUnsignedLong(TagId(tagId_t::MessageID_0000_0110), 0) - 1) * 12800);
+                size_t dummy;
+                const char* payloadData(reading.data(&dummy));
+                for(size_t checkPayload(0); checkPayload != payloadSize; ++checkPayload)
+                {
+                    if(payloadData[checkPayload] != (char)(checkPayload & 0x7f))
+                    {
+                        status = 0x0110;
+                    }
+                }
+                if(reading.getSize() != ((payloadSize + 1) & 0xfffffffe))
+                {
+                    status = 0x0110;
+                }
+            }
+
+            MutableAssociationMessage response(command.getAbstractSyntax());
+            MutableDataSet responseDataSet;
+            responseDataSet.setUnsignedLong(TagId(tagId_t::CommandField_0000_0100), 0x8001, tagVR_t::US);
+            responseDataSet.setUnsignedLong(TagId(tagId_t::MessageIDBeingRespondedTo_0000_0120), command.getCommand().getUnsignedLong(TagId(tagId_t::MessageID_0000_0110), 0), tagVR_t::US);
+            responseDataSet.setUnsignedLong(TagId(tagId_t::CommandDataSetType_0000_0800), 0x0101);
+            responseDataSet.setUnsignedLong(TagId(tagId_t::Status_0000_0900), status, tagVR_t::US);
+            response.addDataSet(responseDataSet);
+
+            scp.sendMessage(response);
+        }
+    }
+    catch(const std::runtime_error&)
+    {
+
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Send payloads of increasing size to an SCP that spools
+//  them. Returns false if the association fails
+//
+///////////////////////////////////////////////////////////
+bool sendPayloadsToSpoolingSCP(const std::string& spoolFolder, size_t maxPayloadSize)
+{
+    PipeStream toSCU(1024), toSCP(1024);
+
+    StreamReader readSCU(toSCU.getStreamInput());
+    StreamWriter writeSCU(toSCP.getStreamOutput());
+
+    StreamReader readSCP(toSCP.getStreamInput());
+    StreamWriter writeSCP(toSCU.getStreamOutput());
+
+    PresentationContext context("1.2.840.10008.1.1");
+    context.addTransferSyntax("1.2.840.10008.1.2.1"); // explicit VR little endian
+    PresentationContexts presentationContexts;
+    presentationContexts.addPresentationContext(context);
+
+    const std::string scpName("SCP");
+
+    PayloadSpoolFolders spoolFolders;
+    spoolFolders.setPayloadSpoolFolder("1.2.840.10008.1.1", spoolFolder, 1024);
+
+    std::thread scp(imebra::tests::scpThreadSpool, std::ref(scpName), std::ref(presentationContexts), std::ref(readSCP), std::ref(writeSCP), std::ref(spoolFolders));
+
+    bool bSuccess(true);
+    try
+    {
+        AssociationSCU scu("SCU", scpName, 1, 1, presentationContexts, readSCU, writeSCU, 0);
+
+        std::uint16_t messageId(1);
+        for(size_t payloadSize(1); payloadSize < maxPayloadSize; payloadSize += 12800, ++messageId)
+        {
+            MutableAssociationMessage command("1.2.840.10008.1.1");
+
+            MutableDataSet dataset0;
+            dataset0.setUnsignedLong(TagId(tagId_t::CommandField_0000_0100), 0x1, tagVR_t::US);
+            dataset0.setUnsignedLong(TagId(tagId_t::MessageID_0000_0110), messageId, tagVR_t::US);
+            dataset0.setUnsignedLong(TagId(tagId_t::CommandDataSetType_0000_0800), 0);
+
+            command.addDataSet(dataset0);
+
+            MutableDataSet payload("1.2.840.10008.1.2.1");
+            {
+                WritingDataHandlerNumeric writing = payload.getWritingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 0, tagVR_t::OB);
+                writing.setSize(payloadSize);
+                size_t dummy;
+                char* payloadData(writing.data(&dummy));
+                for(size_t fillPayload(0); fillPayload != payloadSize; ++fillPayload)
+                {
+                    payloadData[fillPayload] = (char)(fillPayload & 0x7f);
+                }
+            }
+            command.addDataSet(payload);
+
+            scu.sendMessage(command);
+
+            AssociationMessage response = scu.getResponse(messageId);
+            EXPECT_EQ(0u, response.getCommand().getUnsignedLong(TagId(tagId_t::Status_0000_0900), 0));
+        }
+        scu.release();
+    }
+    catch(const std::runtime_error&)
+    {
+        bSuccess = false;
+        toSCP.close(0);
+    }
+
+    scp.join();
+
+    return bSuccess;
+}
+
+
+TEST(acseTest, receivePayloadSpoolSCP)
+{
+    // Spool the received payloads in the temporary folder
+    char* tempFileName = ::tempnam(0, "dcmimebraspool");
+    std::string spoolFolder(tempFileName);
+    free(tempFileName);
+    spoolFolder = spoolFolder.substr(0, spoolFolder.find_last_of("/\\"));
+
+    const size_t spoolFiles(countSpoolFiles(spoolFolder));
+
+    EXPECT_TRUE(sendPayloadsToSpoolingSCP(spoolFolder, 128000));
+
+    // The spool files are removed as soon as they are mapped
+    ///////////////////////////////////////////////////////////
+    EXPECT_EQ(spoolFiles, countSpoolFiles(spoolFolder));
+
+    // The SCP spools also the first payload, which arrives
+    //  right after the negotiation: when the spool folder
+    //  doesn't exist it cannot receive it
+    ///////////////////////////////////////////////////////////
+    EXPECT_FALSE(sendPayloadsToSpoolingSCP(spoolFolder + "/imebra_missing_spool_folder", 128000));
+}
+
+
+
 void scuThread(AssociationSCU& scu, std::uint16_t firstMessageId, size_t numberOfMessages)
 {
     const size_t payloadSize(100);
@@ -361,6 +361,44 @@ bool identicalImages(const imebra::Image& image0, const imebra::Image& image1)
     return ::memcmp(pData0, pData1, dataSize0) == 0;
 }
 
+bool identicalRegion(const imebra::Image& image, const imebra::Image& region, std::uint32_t left, std::uint32_t top)
+{
+    std::uint32_t width(image.getWidth()), height(image.getHeight());
+    std::uint32_t regionWidth(region.getWidth()), regionHeight(region.getHeight());
+
+    if(left + regionWidth > width || top + regionHeight > height)
+    {
+        return false;
+    }
+
+    std::uint32_t channelsNumber(image.getChannelsNumber());
+    if(channelsNumber != region.getChannelsNumber() ||
+            image.getDepth() != region.getDepth() ||
+            image.getHighBit() != region.getHighBit() ||
+            image.getColorSpace() != region.getColorSpace())
+    {
+        return false;
+    }
+
+    ReadingDataHandlerNumeric hImage = image.getReadingDataHandler();
+    ReadingDataHandlerNumeric hRegion = region.getReadingDataHandler();
+
+    for(std::uint32_t scanY(0); scanY != regionHeight; ++scanY)
+    {
+        for(size_t scanX(0); scanX != (size_t)regionWidth * channelsNumber; ++scanX)
+        {
+            const size_t imageIndex(((size_t)(top + scanY) * width + left) * channelsNumber + scanX);
+            const size_t regionIndex((size_t)scanY * regionWidth * channelsNumber + scanX);
+            if(hImage.getSignedLong(imageIndex) != hRegion.getSignedLong(regionIndex))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 } // namespace tests
 
 } // namespace imebra
@@ -28,6 +28,8 @@ namespace tests
 
     bool identicalImages(const imebra::Image& image0, const imebra::Image& image1);
 
+    bool identicalRegion(const imebra::Image& image, const imebra::Image& region, std::uint32_t left, std::uint32_t top);
+
 
 } // namespace tests
 
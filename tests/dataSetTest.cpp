@@ -4,6 +4,7 @@
 #include <list>
 #include <string.h>
 #include <memory>
+#include <typeinfo>
 #include <gtest/gtest.h>
 
 namespace imebra
@@ -93,16 +94,81 @@ TEST(dataSetTest, testFragmentation)
         StreamWriter streamWriter(memoryStreamOutput);
         CodecFactory::save(testDataSet, streamWriter, codecType_t::dicom);
 
-        MemoryStreamInput memoryStreamInput(saveDataSet);
-        StreamReader streamReader(memoryStreamInput);
-        DataSet checkDataSet = CodecFactory::load(streamReader);
+        // The fragments are read from memory or, when the buffers
+        //  are not loaded, directly from the stream
+        for(size_t maxSizeBufferLoad: {std::numeric_limits<size_t>::max(), size_t(1)})
+        {
+            MemoryStreamInput memoryStreamInput(saveDataSet);
+            StreamReader streamReader(memoryStreamInput);
+            DataSet checkDataSet = CodecFactory::load(streamReader, maxSizeBufferLoad);
 
-        Image compareImage0 = checkDataSet.getImage(0);
-        ASSERT_TRUE(compareImages(testImage0, compareImage0) < 0.000001);
+            Image compareImage0 = checkDataSet.getImage(0);
+            ASSERT_TRUE(compareImages(testImage0, compareImage0) < 0.000001);
 
-        Image compareImage1 = checkDataSet.getImage(1);
-        ASSERT_TRUE(compareImages(testImage1, compareImage1) < 0.000001);
-        ASSERT_TRUE(compareImages(testImage0, compareImage1) > 30);
+            Image compareImage1 = checkDataSet.getImage(1);
+            ASSERT_TRUE(compareImages(testImage1, compareImage1) < 0.000001);
+            ASSERT_TRUE(compareImages(testImage0, compareImage1) > 30);
+        }
+    }
+}
+
+
+TEST(dataSetTest, testGetImageRegion)
+{
+    const char* transferSyntaxes[] = {"1.2.840.10008.1.2", "1.2.840.10008.1.2.1", "1.2.840.10008.1.2.2", "1.2.840.10008.1.2.5"};
+
+    for(const char* transferSyntax: transferSyntaxes)
+    {
+        for(bitDepth_t depth: {bitDepth_t::depthU8, bitDepth_t::depthU16, bitDepth_t::depthS16})
+        {
+            for(const char* colorSpace: {"MONOCHROME2", "RGB"})
+            {
+                // RLE doesn't store interleaved images: it is decoded
+                //  completely before the region is copied
+                if(std::string(transferSyntax) == "1.2.840.10008.1.2.5" && std::string(colorSpace) == "RGB")
+                {
+                    continue;
+                }
+
+                const std::uint32_t width(97), height(53);
+                Image testImage = buildImageForTest(width, height, depth, depth == bitDepth_t::depthU8 ? 7 : 11, colorSpace, 50);
+
+                MutableDataSet testDataSet(transferSyntax);
+                testDataSet.setImage(0, testImage, imageQuality_t::high);
+                testDataSet.setImage(1, testImage, imageQuality_t::high);
+
+                // Load the dataset from a stream, so the pixel data is
+                //  read from the stream when the region is requested
+                MutableMemory saveDataSet;
+                {
+                    MemoryStreamOutput memoryStreamOutput(saveDataSet);
+                    StreamWriter streamWriter(memoryStreamOutput);
+                    CodecFactory::save(testDataSet, streamWriter, codecType_t::dicom);
+                }
+                MemoryStreamInput memoryStreamInput(saveDataSet);
+                StreamReader streamReader(memoryStreamInput);
+                DataSet checkDataSet = CodecFactory::load(streamReader, 1);
+
+                for(size_t frame(0); frame != 2; ++frame)
+                {
+                    Image fullImage = checkDataSet.getImage(frame);
+
+                    const std::uint32_t regions[][4] = {{0, 0, width, height}, {0, 0, 1, 1}, {13, 7, 40, 21}, {width - 5, height - 3, 5, 3}};
+                    for(const std::uint32_t* region: regions)
+                    {
+                        Image regionImage = checkDataSet.getImage(frame, region[0], region[1], region[2], region[3]);
+                        ASSERT_EQ(region[2], regionImage.getWidth());
+                        ASSERT_EQ(region[3], regionImage.getHeight());
+                        ASSERT_TRUE(identicalRegion(fullImage, regionImage, region[0], region[1]));
+                    }
+                }
+
+                ASSERT_THROW(checkDataSet.getImage(0, 0, 0, 0, 1), ImageInvalidSizeError);
+                ASSERT_THROW(checkDataSet.getImage(0, 90, 0, 8, 1), ImageInvalidSizeError);
+                ASSERT_THROW(checkDataSet.getImage(0, 0, 53, 1, 1), ImageInvalidSizeError);
+                ASSERT_THROW(checkDataSet.getImage(2, 0, 0, 1, 1), DataSetImageDoesntExistError);
+            }
+        }
     }
 }
 
@@ -160,6 +226,149 @@ TEST(dataSetTest, testGetTags)
     ASSERT_TRUE(bPatientAge);
 }
 
+TEST(dataSetTest, testTagsOrder)
+{
+    MutableDataSet testDataSet("1.2.840.10008.1.2.1");
+
+    // Insert the tags in random order, also in a second group
+    //  with the same id
+    testDataSet.setString(TagId(0x0020, 0x0020), "4");
+    testDataSet.setString(TagId(0x0010, 0x0020), "2");
+    testDataSet.setString(TagId(0x0020, 1, 0x0010), "5");
+    testDataSet.setString(TagId(0x0010, 0x0010), "1");
+    testDataSet.setString(TagId(0x0020, 0x0010), "3");
+
+    tagsIds_t tags = testDataSet.getTags();
+    ASSERT_EQ(6u, tags.size());
+    EXPECT_EQ(0x0002, tags[0].getGroupId());
+    EXPECT_EQ(0x0010, tags[1].getTagId());
+    EXPECT_EQ(0x0020, tags[2].getTagId());
+    EXPECT_EQ(0x0020, tags[3].getGroupId());
+    EXPECT_EQ(0x0010, tags[3].getTagId());
+    EXPECT_EQ(0x0020, tags[4].getTagId());
+    EXPECT_EQ(1u, tags[5].getGroupOrder());
+
+    EXPECT_THROW(testDataSet.getTag(TagId(0x0020, 0x0030)), MissingTagError);
+    EXPECT_THROW(testDataSet.getTag(TagId(0x0020, 2, 0x0010)), MissingGroupError);
+    EXPECT_THROW(testDataSet.getTag(TagId(0x0030, 0x0010)), MissingGroupError);
+
+    MutableMemory savedDataSet;
+    {
+        MemoryStreamOutput streamOutput(savedDataSet);
+        StreamWriter writer(streamOutput);
+        CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+    }
+
+    // The tags retrieved from a loaded dataset remain valid
+    //  after the dataset has been destroyed
+    std::unique_ptr<Tag> pTag;
+    {
+        MemoryStreamInput streamInput(savedDataSet);
+        StreamReader reader(streamInput);
+        DataSet loadedDataSet(CodecFactory::load(reader));
+        EXPECT_EQ("1", loadedDataSet.getString(TagId(0x0010, 0x0010), 0));
+        EXPECT_EQ("2", loadedDataSet.getString(TagId(0x0010, 0x0020), 0));
+        EXPECT_EQ("3", loadedDataSet.getString(TagId(0x0020, 0x0010), 0));
+        EXPECT_EQ("4", loadedDataSet.getString(TagId(0x0020, 0x0020), 0));
+        EXPECT_EQ("5", loadedDataSet.getString(TagId(0x0020, 1, 0x0010), 0));
+        pTag.reset(new Tag(loadedDataSet.getTag(TagId(0x0020, 0x0020))));
+    }
+    EXPECT_EQ("4", pTag->getReadingDataHandler(0).getString(0));
+}
+
+// Compare the values returned by the two getters
+template<typename value_t>
+void expectSameValue(const value_t& expected, const value_t& value)
+{
+    EXPECT_EQ(expected, value);
+}
+
+void expectSameValue(double expected, double value)
+{
+    EXPECT_DOUBLE_EQ(expected, value);
+}
+
+// Check that a DataSet getter returns the same value, or
+//  throws the same exception, as the data handler
+template<typename getDataSetValue_t, typename getHandlerValue_t>
+void compareGetters(getDataSetValue_t getDataSetValue, getHandlerValue_t getHandlerValue)
+{
+    try
+    {
+        auto expected(getHandlerValue());
+        expectSameValue(expected, getDataSetValue());
+    }
+    catch(const std::exception& expectedError)
+    {
+        try
+        {
+            getDataSetValue();
+            ADD_FAILURE() << "Expected " << typeid(expectedError).name();
+        }
+        catch(const std::exception& error)
+        {
+            EXPECT_EQ(typeid(expectedError), typeid(error));
+        }
+    }
+}
+
+TEST(dataSetTest, testDirectGetters)
+{
+    MutableDataSet testDataSet("1.2.840.10008.1.2.1");
+
+    const std::vector<tagVR_t> stringVRs = {tagVR_t::AE, tagVR_t::CS, tagVR_t::DS, tagVR_t::IS, tagVR_t::LO, tagVR_t::UI, tagVR_t::UR};
+    const std::vector<std::string> strings = {
+        "12", " 12 ", "-5", "+7", "1.5", "-1.5e3", "1e", "0x10", "inf", "abc", "", "4294967295", "4294967296",
+        "99999999999", "12\\-3\\ 4.25 \\", "1.2.840.10008.1.2", "001.02.3"};
+
+    const std::vector<tagVR_t> numericVRs = {tagVR_t::US, tagVR_t::SS, tagVR_t::UL, tagVR_t::SL, tagVR_t::FL, tagVR_t::FD, tagVR_t::OB, tagVR_t::OW};
+
+    std::uint16_t tagId(1);
+    std::vector<TagId> tags;
+    for(tagVR_t tagVR: stringVRs)
+    {
+        for(const std::string& value: strings)
+        {
+            tags.push_back(TagId(0x0011, tagId++));
+            WritingDataHandlerNumeric handler(testDataSet.getWritingDataHandlerRaw(tags.back(), 0, tagVR));
+            handler.assign(value.data(), value.size());
+        }
+    }
+    for(tagVR_t tagVR: numericVRs)
+    {
+        tags.push_back(TagId(0x0011, tagId++));
+        WritingDataHandler handler(testDataSet.getWritingDataHandler(tags.back(), 0, tagVR));
+        handler.setSize(3);
+        handler.setSignedLong(0, 100);
+        handler.setSignedLong(1, tagVR == tagVR_t::US || tagVR == tagVR_t::UL || tagVR == tagVR_t::OB || tagVR == tagVR_t::OW ? 7 : -7);
+        handler.setDouble(2, tagVR == tagVR_t::FL || tagVR == tagVR_t::FD ? 2.5 : 2);
+    }
+
+    for(const TagId& tag: tags)
+    {
+        ReadingDataHandler handler(testDataSet.getReadingDataHandler(tag, 0));
+        for(size_t element(0); element != 5; ++element)
+        {
+            compareGetters([&](){ return testDataSet.getSignedLong(tag, element); }, [&](){ return handler.getSignedLong(element); });
+            compareGetters([&](){ return testDataSet.getUnsignedLong(tag, element); }, [&](){ return handler.getUnsignedLong(element); });
+            compareGetters([&](){ return testDataSet.getDouble(tag, element); }, [&](){ return handler.getDouble(element); });
+            compareGetters([&](){ return testDataSet.getString(tag, element); }, [&](){ return handler.getString(element); });
+
+            if(element >= handler.getSize())
+            {
+                EXPECT_EQ(3u, testDataSet.getUnsignedLong(tag, element, 3u));
+                EXPECT_EQ("default", testDataSet.getString(tag, element, "default"));
+            }
+        }
+    }
+
+    // Missing tags and groups
+    EXPECT_THROW(testDataSet.getUnsignedLong(TagId(0x0011, 0x1000), 0), MissingTagError);
+    EXPECT_EQ(3u, testDataSet.getUnsignedLong(TagId(0x0011, 0x1000), 0, 3u));
+    EXPECT_THROW(testDataSet.getDouble(TagId(0x0013, 1), 0), MissingGroupError);
+    EXPECT_DOUBLE_EQ(3.5, testDataSet.getDouble(TagId(0x0013, 1), 0, 3.5));
+}
+
 TEST(dataSetTest, testCreateTags)
 {
     MutableDataSet testDataSet;
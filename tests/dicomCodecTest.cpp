@@ -2,8 +2,10 @@
 #include "buildImageForTest.h"
 #include "testsSettings.h"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <limits>
 #include <thread>
+#include <vector>
 
 #ifndef DISABLE_DCMTK_INTEROPERABILITY_TEST
 
@@ -350,6 +352,66 @@ TEST(dicomCodecTest, testDicom32bit)
 }
 
 
+// Decode a hand made RLE frame containing no-op packets and
+//  packets that straddle the reader's internal buffer
+TEST(dicomCodecTest, testRLESegments)
+{
+    const std::uint32_t width(3000);
+    const std::uint32_t height(2);
+    const size_t planeSize(width * height);
+
+    // The first segment replicates the high byte, the second
+    //  one contains literal copies of the low byte
+    std::vector<std::uint8_t> highSegment(1, 0x80);
+    for(size_t writtenBytes(0); writtenBytes < planeSize; writtenBytes += 128)
+    {
+        highSegment.push_back((std::uint8_t)(1 - (int)std::min((size_t)128, planeSize - writtenBytes)));
+        highSegment.push_back(0x12);
+    }
+    std::vector<std::uint8_t> lowSegment;
+    for(size_t writtenBytes(0); writtenBytes < planeSize; writtenBytes += 128)
+    {
+        const size_t copyBytes(std::min((size_t)128, planeSize - writtenBytes));
+        lowSegment.push_back((std::uint8_t)(copyBytes - 1));
+        for(size_t scanBytes(0); scanBytes != copyBytes; ++scanBytes)
+        {
+            lowSegment.push_back((std::uint8_t)(writtenBytes + scanBytes));
+        }
+    }
+
+    std::vector<std::uint8_t> rleFrame(64, 0);
+    rleFrame[0] = 2;
+    rleFrame[4] = 64;
+    rleFrame[8] = (std::uint8_t)((64 + highSegment.size()) & 0xff);
+    rleFrame[9] = (std::uint8_t)((64 + highSegment.size()) >> 8);
+    rleFrame.insert(rleFrame.end(), highSegment.begin(), highSegment.end());
+    rleFrame.insert(rleFrame.end(), lowSegment.begin(), lowSegment.end());
+
+    Image image(buildImageForTest(width, height, bitDepth_t::depthU16, 15, "MONOCHROME2", 50));
+    MutableDataSet dataSet("1.2.840.10008.1.2.5");
+    dataSet.setImage(0, image, imageQuality_t::veryHigh);
+    {
+        WritingDataHandlerNumeric handler(dataSet.getWritingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 1));
+        handler.assign((const char*)rleFrame.data(), rleFrame.size());
+    }
+
+    Image checkImage(dataSet.getImage(0));
+    ReadingDataHandlerNumeric checkHandler(checkImage.getReadingDataHandler());
+    ASSERT_EQ(planeSize, checkHandler.getSize());
+    for(size_t index(0); index != planeSize; ++index)
+    {
+        ASSERT_EQ(0x1200u | (index & 0xff), checkHandler.getUnsignedLong(index));
+    }
+
+    // Truncate the last segment
+    {
+        WritingDataHandlerNumeric handler(dataSet.getWritingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 1));
+        handler.assign((const char*)rleFrame.data(), rleFrame.size() - lowSegment.size() / 2);
+    }
+    EXPECT_THROW(dataSet.getImage(0), CodecCorruptedFileError);
+}
+
+
 TEST(dicomCodecTest, testImplicitPrivateTags)
 {
     MutableMemory streamMemory;
@@ -414,6 +476,148 @@ TEST(dicomCodecTest, codecFactoryPipe)
 }
 
 
+TEST(dicomCodecTest, testLargeTags)
+{
+    const std::uint32_t width(300), height(200);
+    Image testImage = buildImageForTest(width, height, bitDepth_t::depthU8, 7, "RGB", 50);
+
+    MutableDataSet testDataSet("1.2.840.10008.1.2.1");
+    testDataSet.setImage(0, testImage, imageQuality_t::high);
+
+    MutableMemory savedDataSet;
+    {
+        MemoryStreamOutput streamOutput(savedDataSet);
+        StreamWriter writer(streamOutput);
+        CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+    }
+
+    // Seekable stream: the pixel data is read directly into its buffer
+    {
+        MemoryStreamInput streamInput(savedDataSet);
+        StreamReader reader(streamInput);
+        DataSet loadedDataSet(CodecFactory::load(reader));
+        EXPECT_TRUE(identicalImages(testImage, loadedDataSet.getImage(0)));
+    }
+
+    // Non seekable stream: the buffer grows while the pixel data is read
+    {
+        PipeStream source(1024);
+        std::thread feedData(imebra::tests::feedDataThread, std::ref(source), std::ref(testDataSet));
+        StreamReader reader(source.getStreamInput());
+        DataSet loadedDataSet(CodecFactory::load(reader));
+        feedData.join();
+        EXPECT_TRUE(identicalImages(testImage, loadedDataSet.getImage(0)));
+    }
+
+    // Truncated stream: the pixel data's length exceeds the stream's size
+    {
+        savedDataSet.resize(savedDataSet.size() - 1000);
+        MemoryStreamInput streamInput(savedDataSet);
+        StreamReader reader(streamInput);
+        EXPECT_THROW(CodecFactory::load(reader), StreamEOFError);
+    }
+}
+
+
+TEST(dicomCodecTest, testStopTag)
+{
+    Image testImage = buildImageForTest(30, 20, bitDepth_t::depthU8, 7, "MONOCHROME2", 50);
+
+    MutableDataSet testDataSet("1.2.840.10008.1.2.1");
+    testDataSet.setString(TagId(tagId_t::PatientName_0010_0010), "Test^Patient");
+    testDataSet.setString(TagId(tagId_t::StudyInstanceUID_0020_000D), "1.2.3");
+    {
+        MutableDataSet sequenceItem = testDataSet.appendSequenceItem(TagId(tagId_t::ReferencedImageSequence_0008_1140));
+        sequenceItem.setString(TagId(tagId_t::StudyInstanceUID_0020_000D), "1.2.3.4");
+    }
+    testDataSet.setImage(0, testImage, imageQuality_t::high);
+
+    MutableMemory savedDataSet;
+    {
+        MemoryStreamOutput streamOutput(savedDataSet);
+        StreamWriter writer(streamOutput);
+        CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+    }
+
+    // Stop before the pixel data
+    {
+        MemoryStreamInput streamInput(savedDataSet);
+        StreamReader reader(streamInput);
+        DataSet loadedDataSet(CodecFactory::load(reader, std::numeric_limits<size_t>::max(), TagId(tagId_t::PixelData_7FE0_0010)));
+        EXPECT_EQ("Test^Patient", loadedDataSet.getString(TagId(tagId_t::PatientName_0010_0010), 0));
+        EXPECT_EQ("1.2.3", loadedDataSet.getString(TagId(tagId_t::StudyInstanceUID_0020_000D), 0));
+        EXPECT_THROW(loadedDataSet.getTag(TagId(tagId_t::PixelData_7FE0_0010)), MissingDataElementError);
+    }
+
+    // Stop before the study instance UID: the tags in the sequence items are not affected
+    {
+        MemoryStreamInput streamInput(savedDataSet);
+        StreamReader reader(streamInput);
+        DataSet loadedDataSet(CodecFactory::load(reader, std::numeric_limits<size_t>::max(), TagId(tagId_t::StudyInstanceUID_0020_000D)));
+        EXPECT_EQ("Test^Patient", loadedDataSet.getString(TagId(tagId_t::PatientName_0010_0010), 0));
+        EXPECT_EQ("1.2.3.4", loadedDataSet.getSequenceItem(TagId(tagId_t::ReferencedImageSequence_0008_1140), 0).getString(TagId(tagId_t::StudyInstanceUID_0020_000D), 0));
+        EXPECT_THROW(loadedDataSet.getTag(TagId(tagId_t::StudyInstanceUID_0020_000D)), MissingDataElementError);
+        EXPECT_THROW(loadedDataSet.getTag(TagId(tagId_t::PixelData_7FE0_0010)), MissingDataElementError);
+    }
+}
+
+
+TEST(dicomCodecTest, testConcurrentReads)
+{
+    Image testImage = buildImageForTest(30, 20, bitDepth_t::depthU16, 15, "MONOCHROME2", 50);
+
+    MutableDataSet testDataSet("1.2.840.10008.1.2.1");
+    testDataSet.setString(TagId(tagId_t::PatientName_0010_0010), "Test^Patient");
+    testDataSet.setUnsignedLong(TagId(tagId_t::SeriesNumber_0020_0011), 12);
+    {
+        MutableDataSet sequenceItem = testDataSet.appendSequenceItem(TagId(tagId_t::ReferencedImageSequence_0008_1140));
+        sequenceItem.setString(TagId(tagId_t::StudyInstanceUID_0020_000D), "1.2.3.4");
+    }
+    testDataSet.setImage(0, testImage, imageQuality_t::high);
+
+    MutableMemory savedDataSet;
+    {
+        MemoryStreamOutput streamOutput(savedDataSet);
+        StreamWriter writer(streamOutput);
+        CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+    }
+
+    MemoryStreamInput streamInput(savedDataSet);
+    StreamReader reader(streamInput);
+    DataSet loadedDataSet(CodecFactory::load(reader));
+
+    // The loaded dataset is read without locks: several
+    //  threads read the same tags at the same time
+    std::vector<size_t> errors(4, 0);
+    std::vector<std::thread> readers;
+    for(size_t threadNumber(0); threadNumber != errors.size(); ++threadNumber)
+    {
+        readers.emplace_back([&loadedDataSet, &testImage, &errors, threadNumber]()
+        {
+            for(size_t repeat(0); repeat != 20; ++repeat)
+            {
+                if(loadedDataSet.getString(TagId(tagId_t::PatientName_0010_0010), 0) != "Test^Patient" ||
+                        loadedDataSet.getUnsignedLong(TagId(tagId_t::SeriesNumber_0020_0011), 0) != 12 ||
+                        loadedDataSet.getSequenceItem(TagId(tagId_t::ReferencedImageSequence_0008_1140), 0).getString(TagId(tagId_t::StudyInstanceUID_0020_000D), 0) != "1.2.3.4" ||
+                        compareImages(testImage, loadedDataSet.getImage(0)) > 0.0001)
+                {
+                    ++errors[threadNumber];
+                }
+            }
+        });
+    }
+    for(std::thread& readerThread: readers)
+    {
+        readerThread.join();
+    }
+
+    for(size_t threadErrors: errors)
+    {
+        EXPECT_EQ(0u, threadErrors);
+    }
+}
+
+
 TEST(dicomCodecTest, testExternalStream)
 {
     // Save a big file
@@ -499,6 +703,156 @@ TEST(dicomCodecTest, testExternalStream)
 }
 
 
+TEST(dicomCodecTest, testLazyLoadCache)
+{
+    MutableMemory streamMemory;
+    {
+        MutableDataSet testDataSet("1.2.840.10008.1.2.2");
+        {
+            WritingDataHandlerNumeric writeHandler = testDataSet.getWritingDataHandlerNumeric(TagId(0x20, 0x20), 0, tagVR_t::OW);
+            writeHandler.setSize(4096);
+            for(size_t writeValue(0); writeValue != 4096; ++writeValue)
+            {
+                writeHandler.setUnsignedLong(writeValue, (std::uint32_t)writeValue);
+            }
+        }
+
+        MemoryStreamOutput writeStream(streamMemory);
+        StreamWriter writer(writeStream);
+        CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+    }
+
+    for(size_t cacheSize(0); cacheSize != 2; ++cacheSize)
+    {
+        CodecFactory::setLazyLoadCacheSize(cacheSize == 0 ? 0 : 1024 * 1024);
+
+        MemoryStreamInput readStream(streamMemory);
+        StreamReader reader(readStream);
+        DataSet testDataSet = CodecFactory::load(reader, 1);
+
+        size_t dataSize(0);
+        const char* pFirstData(0);
+        {
+            ReadingDataHandlerNumeric firstHandler = testDataSet.getReadingDataHandlerNumeric(TagId(0x20, 0x20), 0);
+            pFirstData = firstHandler.data(&dataSize);
+            EXPECT_EQ(8192u, dataSize);
+
+            // While the first handler is alive the loaded memory is shared
+            ReadingDataHandlerNumeric secondHandler = testDataSet.getReadingDataHandlerNumeric(TagId(0x20, 0x20), 0);
+            EXPECT_EQ(pFirstData, secondHandler.data(&dataSize));
+        }
+
+        ReadingDataHandlerNumeric readHandler = testDataSet.getReadingDataHandlerNumeric(TagId(0x20, 0x20), 0);
+        if(cacheSize != 0)
+        {
+            EXPECT_EQ(pFirstData, readHandler.data(&dataSize));
+        }
+        for(size_t readValue(0); readValue != 4096; ++readValue)
+        {
+            EXPECT_EQ(readValue, readHandler.getUnsignedLong(readValue));
+        }
+    }
+
+    CodecFactory::setLazyLoadCacheSize(64 * 1024 * 1024);
+}
+
+
+TEST(dicomCodecTest, testLazyLoadCacheReleasedWithDataSet)
+{
+    // Big endian: the content is copied and cached instead of
+    //  being referenced directly in the stream's memory
+    MutableMemory streamMemory;
+    {
+        MutableDataSet testDataSet("1.2.840.10008.1.2.2");
+        {
+            WritingDataHandlerNumeric writeHandler = testDataSet.getWritingDataHandlerNumeric(TagId(0x20, 0x20), 0, tagVR_t::OW);
+            writeHandler.setSize(4096);
+        }
+
+        MemoryStreamOutput writeStream(streamMemory);
+        StreamWriter writer(writeStream);
+        CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+    }
+
+    const size_t initialCacheSize(CodecFactory::getLazyLoadCacheUsedSize());
+    {
+        MemoryStreamInput readStream(streamMemory);
+        StreamReader reader(readStream);
+        DataSet testDataSet = CodecFactory::load(reader, 1);
+        {
+            ReadingDataHandlerNumeric readHandler = testDataSet.getReadingDataHandlerNumeric(TagId(0x20, 0x20), 0);
+            EXPECT_EQ(8192u, readHandler.getSize() * 2);
+        }
+        EXPECT_LE(initialCacheSize + 8192u, CodecFactory::getLazyLoadCacheUsedSize());
+    }
+
+    // Destroying the dataset removes its content from the cache
+    EXPECT_EQ(initialCacheSize, CodecFactory::getLazyLoadCacheUsedSize());
+}
+
+
+TEST(dicomCodecTest, testMappedFileStream)
+{
+    for(int transferSyntaxId(0); transferSyntaxId != 2; ++transferSyntaxId)
+    {
+        std::string transferSyntax(transferSyntaxId == 0 ? "1.2.840.10008.1.2.1" : "1.2.840.10008.1.2.2");
+
+        char* tempFileName = ::tempnam(0, "dcmimebramapped");
+        std::string fileName(tempFileName);
+        free(tempFileName);
+
+        {
+            MutableDataSet testDataSet(transferSyntax);
+            for(std::uint16_t tagId(0x20); tagId != 0x24; tagId = (std::uint16_t)(tagId + 2))
+            {
+                WritingDataHandlerNumeric writeHandler = testDataSet.getWritingDataHandlerNumeric(TagId(0x20, tagId), 0, tagVR_t::OW);
+                writeHandler.setSize(4096);
+                for(size_t writeValue(0); writeValue != 4096; ++writeValue)
+                {
+                    writeHandler.setUnsignedLong(writeValue, (std::uint32_t)writeValue);
+                }
+            }
+            testDataSet.setString(TagId(tagId_t::PatientName_0010_0010), "Patient^Name");
+
+            CodecFactory::save(testDataSet, fileName, codecType_t::dicom);
+        }
+
+        {
+            MappedFileStreamInput readStream(fileName);
+            StreamReader reader(readStream);
+            DataSet testDataSet = CodecFactory::load(reader, 1);
+
+            EXPECT_EQ("Patient^Name", testDataSet.getString(TagId(tagId_t::PatientName_0010_0010), 0));
+
+            size_t dataSize(0);
+            ReadingDataHandlerNumeric firstHandler = testDataSet.getReadingDataHandlerNumeric(TagId(0x20, 0x20), 0);
+            const char* pFirstData = firstHandler.data(&dataSize);
+            EXPECT_EQ(8192u, dataSize);
+
+            ReadingDataHandlerNumeric secondHandler = testDataSet.getReadingDataHandlerNumeric(TagId(0x20, 0x22), 0);
+            const char* pSecondData = secondHandler.data(&dataSize);
+            EXPECT_EQ(8192u, dataSize);
+
+            // Little endian buffers reference the mapped file: the
+            //  distance between them is the one in the file
+            //  (data + 12 bytes of the next tag's header)
+            if(transferSyntaxId == 0)
+            {
+                EXPECT_EQ(8192 + 12, pSecondData - pFirstData);
+            }
+
+            for(size_t readValue(0); readValue != 4096; ++readValue)
+            {
+                EXPECT_EQ(readValue, firstHandler.getUnsignedLong(readValue));
+                EXPECT_EQ(readValue, secondHandler.getUnsignedLong(readValue));
+            }
+        }
+
+        ::remove(fileName.c_str());
+    }
+}
+
+
 TEST(dicomCodecTest, testExternalStreamOddSize)
 {
     // Save a big file
@@ -33,6 +33,37 @@ TEST(dicomDictionaryTest, testMask)
     ASSERT_THROW(DicomDictionary::getTagDescription(TagId(0x6100, 0x0010)), DictionaryUnknownTagError);
 }
 
+
+TEST(dicomDictionaryTest, testLookup)
+{
+    ASSERT_EQ(tagVR_t::UL, DicomDictionary::getTagType(TagId(0x0000, 0x0000)));
+    ASSERT_EQ(tagVR_t::UN, DicomDictionary::getTagType(TagId(0xfffe, 0xe0dd)));
+    ASSERT_EQ(tagVR_t::SH, DicomDictionary::getTagType(TagId(0x0040, 0x2006)));
+    ASSERT_EQ(tagVR_t::LT, DicomDictionary::getTagType(TagId(0x0040, 0x2011)));
+    ASSERT_EQ(tagVR_t::CS, DicomDictionary::getTagType(TagId(tagId_t::ColorSpace_0028_2002)));
+    ASSERT_EQ(tagVR_t::US, DicomDictionary::getTagType(TagId(0x50fe, 0x0010)));
+    ASSERT_EQ(tagVR_t::US, DicomDictionary::getTagType(TagId(0x6002, 0x0011)));
+
+    ASSERT_THROW(DicomDictionary::getTagType(TagId(0x0009, 0x0010)), DictionaryUnknownTagError);
+    ASSERT_THROW(DicomDictionary::getTagType(TagId(0xffff, 0xffff)), DictionaryUnknownTagError);
+    ASSERT_THROW(DicomDictionary::getWordSize((tagVR_t)0x4141), DictionaryUnknownDataTypeError);
+
+    ASSERT_EQ(8u, DicomDictionary::getWordSize(tagVR_t::FD));
+    ASSERT_EQ(0u, DicomDictionary::getWordSize(tagVR_t::UT));
+    ASSERT_EQ(16u, DicomDictionary::getMaxSize(tagVR_t::AE));
+}
+
+
+TEST(dicomDictionaryTest, testTagsIndex)
+{
+    // The index is built from the descriptions table: the
+    //  tags added at the end of a group must be found
+    ASSERT_EQ(tagVR_t::OV, DicomDictionary::getTagType(TagId(tagId_t::ExtendedOffsetTable_7FE0_0001)));
+    ASSERT_EQ(tagVR_t::OV, DicomDictionary::getTagType(TagId(tagId_t::ExtendedOffsetTableLengths_7FE0_0002)));
+    ASSERT_EQ("Extended Offset Table Lengths", DicomDictionary::getTagDescription(TagId(tagId_t::ExtendedOffsetTableLengths_7FE0_0002)));
+    ASSERT_EQ(tagVR_t::OW, DicomDictionary::getTagType(TagId(tagId_t::PixelData_7FE0_0010)));
+}
+
 } // namespace tests
 
 } // namespace imebra
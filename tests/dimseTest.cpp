@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include <array>
 #include <list>
 #include <stdio.h>
@@ -1351,6 +1352,475 @@ TEST(dimseTest, dimseTimeoutTest)
 }
 
 
+///////////////////////////////////////////////////////////
+//
+// Handler that replies to C-STORE and C-ECHO commands
+//  received by a DimseServer
+//
+///////////////////////////////////////////////////////////
+class storeEchoHandler: public DimseCommandsHandler
+{
+public:
+    storeEchoHandler(): m_storeCount(0), m_echoCount(0)
+    {
+    }
+
+    virtual void processCommand(DimseService& dimseService, const DimseCommand& command) override
+    {
+        if(command.getCommandType() == dimseCommandType_t::cStore)
+        {
+            CStoreCommand storeCommand(command.getAsCStoreCommand());
+            if(storeCommand.getPayloadDataSet().getString(TagId(tagId_t::PatientName_0010_0010), 0) == "Test^Patient")
+            {
+                ++m_storeCount;
+            }
+            dimseService.sendCommandOrResponse(CStoreResponse(storeCommand, dimseStatusCode_t::success));
+        }
+        else
+        {
+            ++m_echoCount;
+            dimseService.sendCommandOrResponse(CEchoResponse(command.getAsCEchoCommand(), dimseStatusCode_t::success));
+        }
+    }
+
+    std::atomic<int> m_storeCount;
+    std::atomic<int> m_echoCount;
+};
+
+
+void dimseServerScuThread(const std::string& port, const PresentationContexts& presentationContexts, size_t commandsCount, std::atomic<int>& successCount)
+{
+    TCPStream tcpStream(TCPActiveAddress("127.0.0.1", port));
+
+    StreamReader readSCU(tcpStream.getStreamInput());
+    StreamWriter writeSCU(tcpStream.getStreamOutput());
+
+    AssociationSCU scu("SCU", "SCP", 1, 1, presentationContexts, readSCU, writeSCU, 0);
+    DimseService dimse(scu);
+
+    for(size_t sendCommands(0); sendCommands != commandsCount; ++sendCommands)
+    {
+        MutableDataSet payload("1.2.840.10008.1.2");
+        payload.setString(TagId(tagId_t::SOPClassUID_0008_0016), "1.1.1.1.1");
+        payload.setString(TagId(tagId_t::SOPInstanceUID_0008_0018), "1.1.1.1.2");
+        payload.setString(TagId(tagId_t::PatientName_0010_0010), "Test^Patient");
+        CStoreCommand storeCommand(
+                    "1.2.840.10008.5.1.4.1.1.1",
+                    dimse.getNextCommandID(),
+                    dimseCommandPriority_t::medium,
+                    "1.1.1.1.1",
+                    "1.1.1.1.2",
+                    "",
+                    0,
+                    payload);
+        dimse.sendCommandOrResponse(storeCommand);
+        if(dimse.getCStoreResponse(storeCommand).getStatus() == dimseStatus_t::success)
+        {
+            ++successCount;
+        }
+    }
+
+    CEchoCommand echoCommand("1.2.840.10008.1.1", dimse.getNextCommandID(), dimseCommandPriority_t::medium, "1.2.840.10008.1.1");
+    dimse.sendCommandOrResponse(echoCommand);
+    if(dimse.getCEchoResponse(echoCommand).getStatus() == dimseStatus_t::success)
+    {
+        ++successCount;
+    }
+
+    scu.release();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Several SCUs connect to a DimseServer served by 2
+//  worker threads
+//
+///////////////////////////////////////////////////////////
+TEST(dimseTest, dimseServerTest)
+{
+    PresentationContext storeContext("1.2.840.10008.5.1.4.1.1.1");
+    storeContext.addTransferSyntax("1.2.840.10008.1.2"); // implicit VR little endian
+    PresentationContext echoContext("1.2.840.10008.1.1");
+    echoContext.addTransferSyntax("1.2.840.10008.1.2"); // implicit VR little endian
+    PresentationContexts presentationContexts;
+    presentationContexts.addPresentationContext(storeContext);
+    presentationContexts.addPresentationContext(echoContext);
+
+    TCPListener tcpListener(TCPPassiveAddress("", "30006"));
+
+    // The store payloads are spooled to the temporary folder
+    ///////////////////////////////////////////////////////////
+    char* tempFileName = ::tempnam(0, "dcmimebraspool");
+    std::string spoolFolder(tempFileName);
+    free(tempFileName);
+    spoolFolder = spoolFolder.substr(0, spoolFolder.find_last_of("/\\"));
+    PayloadSpoolFolders spoolFolders;
+    spoolFolders.setPayloadSpoolFolder("1.2.840.10008.5.1.4.1.1.1", spoolFolder, 1024);
+
+    storeEchoHandler handler;
+    DimseServer server(tcpListener, "SCP", 1, 1, presentationContexts, 0, 1, 2, handler, spoolFolders);
+
+    // A connection that doesn't request an association is
+    // closed after the ARTIM timeout
+    ///////////////////////////////////////////////////////////
+    TCPStream idleStream(TCPActiveAddress("127.0.0.1", "30006"));
+
+    const size_t scuCount(8);
+    const size_t commandsCount(5);
+    std::atomic<int> successCount(0);
+    std::list<std::thread> scuThreads;
+    for(size_t startThreads(0); startThreads != scuCount; ++startThreads)
+    {
+        scuThreads.emplace_back(dimseServerScuThread, std::string("30006"), std::ref(presentationContexts), commandsCount, std::ref(successCount));
+    }
+    for(std::thread& scuThread: scuThreads)
+    {
+        scuThread.join();
+    }
+
+    EXPECT_EQ((int)(scuCount * (commandsCount + 1)), successCount.load());
+    EXPECT_EQ((int)(scuCount * commandsCount), handler.m_storeCount.load());
+    EXPECT_EQ((int)scuCount, handler.m_echoCount.load());
+
+    for(size_t waitClose(0); waitClose != 50 && server.getConnectionsCount() != 0; ++waitClose)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    EXPECT_EQ(0u, server.getConnectionsCount());
+
+    server.terminate();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Peers that stop sending in the middle of a PDU don't
+//  prevent a DimseServer with one worker thread from
+//  serving the other associations, and are disconnected
+//  when the ARTIM or DIMSE timeout expires
+//
+///////////////////////////////////////////////////////////
+TEST(dimseTest, dimseServerStalledPeersTest)
+{
+    PresentationContext storeContext("1.2.840.10008.5.1.4.1.1.1");
+    storeContext.addTransferSyntax("1.2.840.10008.1.2"); // implicit VR little endian
+    PresentationContext echoContext("1.2.840.10008.1.1");
+    echoContext.addTransferSyntax("1.2.840.10008.1.2"); // implicit VR little endian
+    PresentationContexts presentationContexts;
+    presentationContexts.addPresentationContext(storeContext);
+    presentationContexts.addPresentationContext(echoContext);
+
+    TCPListener tcpListener(TCPPassiveAddress("", "30007"));
+
+    storeEchoHandler handler;
+    DimseServer server(tcpListener, "SCP", 1, 1, presentationContexts, 2, 2, 1, handler);
+
+    // A peer that sends only part of the association request
+    ///////////////////////////////////////////////////////////
+    TCPStream stalledRequestStream(TCPActiveAddress("127.0.0.1", "30007"));
+    StreamWriter stalledRequestWriter(stalledRequestStream.getStreamOutput());
+    const std::uint8_t partialRequest[] = {0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x02};
+    stalledRequestWriter.write((const char*)partialRequest, sizeof(partialRequest));
+    stalledRequestWriter.flush();
+
+    // A peer that negotiates the association, then sends only
+    // part of a P-DATA PDU
+    ///////////////////////////////////////////////////////////
+    TCPStream stalledDataStream(TCPActiveAddress("127.0.0.1", "30007"));
+    StreamReader stalledDataReader(stalledDataStream.getStreamInput());
+    StreamWriter stalledDataWriter(stalledDataStream.getStreamOutput());
+    AssociationSCU stalledScu("SCU", "SCP", 1, 1, presentationContexts, stalledDataReader, stalledDataWriter, 0);
+    const std::uint8_t partialPData[] = {0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x01, 0x03};
+    stalledDataWriter.write((const char*)partialPData, sizeof(partialPData));
+    stalledDataWriter.flush();
+
+    // The other associations are served while the stalled
+    // peers are connected
+    ///////////////////////////////////////////////////////////
+    const size_t commandsCount(3);
+    std::atomic<int> successCount(0);
+    std::thread scuThread(dimseServerScuThread, std::string("30007"), std::ref(presentationContexts), commandsCount, std::ref(successCount));
+    scuThread.join();
+
+    EXPECT_EQ((int)(commandsCount + 1), successCount.load());
+    EXPECT_EQ((int)commandsCount, handler.m_storeCount.load());
+
+    // The stalled connections are closed by the timeouts
+    ///////////////////////////////////////////////////////////
+    for(size_t waitClose(0); waitClose != 100 && server.getConnectionsCount() != 0; ++waitClose)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    EXPECT_EQ(0u, server.getConnectionsCount());
+
+    // The association with the stalled payload has been
+    // aborted
+    ///////////////////////////////////////////////////////////
+    DimseService stalledDimse(stalledScu);
+    EXPECT_THROW(stalledDimse.getCommand(), StreamClosedError);
+
+    server.terminate();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Handler that replies to C-GET commands with several
+//  C-STORE sub-operations, waiting for the response to
+//  each one
+//
+///////////////////////////////////////////////////////////
+class getHandler: public DimseCommandsHandler
+{
+public:
+    getHandler(std::uint32_t subOperations): m_subOperations(subOperations)
+    {
+    }
+
+    virtual void processCommand(DimseService& dimseService, const DimseCommand& command) override
+    {
+        CGetCommand getCommand(command.getAsCGetCommand());
+        const std::string abstractSyntax(getCommand.getAbstractSyntax());
+
+        std::uint32_t completedSubOperations(0);
+        std::uint32_t failedSubOperations(0);
+        for(std::uint32_t subOperation(0); subOperation != m_subOperations; ++subOperation)
+        {
+            dimseService.sendCommandOrResponse(
+                        CGetResponse(getCommand, dimseStatusCode_t::pending, m_subOperations - subOperation, completedSubOperations, failedSubOperations, 0));
+
+            MutableDataSet storePayload(dimseService.getTransferSyntax(abstractSyntax));
+            storePayload.setString(TagId(tagId_t::PatientID_0010_0020), "100");
+            storePayload.setUnsignedLong(TagId(tagId_t::InstanceNumber_0020_0013), subOperation);
+            CStoreCommand storeCommand(
+                        abstractSyntax,
+                        dimseService.getNextCommandID(),
+                        dimseCommandPriority_t::medium,
+                        getCommand.getAffectedSopClassUid(),
+                        "1.2.3.4.5.6",
+                        "SCU",
+                        getCommand.getID(),
+                        storePayload);
+            dimseService.sendCommandOrResponse(storeCommand);
+            if(dimseService.getCStoreResponse(storeCommand).getStatus() == dimseStatus_t::success)
+            {
+                ++completedSubOperations;
+            }
+            else
+            {
+                ++failedSubOperations;
+            }
+        }
+
+        dimseService.sendCommandOrResponse(
+                    CGetResponse(getCommand, failedSubOperations == 0 ? dimseStatusCode_t::success : dimseStatusCode_t::subOperationCompletedWithErrors, 0, completedSubOperations, failedSubOperations, 0));
+    }
+
+    const std::uint32_t m_subOperations;
+};
+
+
+void dimseServerGetScuThread(const std::string& port, const PresentationContexts& presentationContexts, std::uint32_t subOperations, std::atomic<int>& successCount)
+{
+    TCPStream tcpStream(TCPActiveAddress("127.0.0.1", port));
+
+    StreamReader readSCU(tcpStream.getStreamInput());
+    StreamWriter writeSCU(tcpStream.getStreamOutput());
+
+    AssociationSCU scu("SCU", "SCP", 1, 1, presentationContexts, readSCU, writeSCU, 0);
+    DimseService dimse(scu);
+
+    MutableDataSet keys(dimse.getTransferSyntax("1.2.840.10008.5.1.4.1.2.1.3"));
+    keys.setString(TagId(tagId_t::QueryRetrieveLevel_0008_0052), "PATIENT");
+    keys.setString(TagId(tagId_t::PatientID_0010_0020), "100");
+    CGetCommand getCommand(
+                "1.2.840.10008.5.1.4.1.2.1.3",
+                dimse.getNextCommandID(),
+                dimseCommandPriority_t::medium,
+                "1.1.1.1.1",
+                keys);
+    dimse.sendCommandOrResponse(getCommand);
+
+    // The sub-operations arrive in order, each one after the
+    // response to the previous one
+    ///////////////////////////////////////////////////////////
+    bool bSuccess(true);
+    for(std::uint32_t subOperation(0); subOperation != subOperations; ++subOperation)
+    {
+        CGetResponse pendingResponse(dimse.getCGetResponse(getCommand));
+        bSuccess = bSuccess && pendingResponse.getStatus() == dimseStatus_t::pending;
+
+        CStoreCommand storeCommand(dimse.getCommand().getAsCStoreCommand());
+        DataSet storePayload(storeCommand.getPayloadDataSet());
+        bSuccess = bSuccess && storePayload.getUnsignedLong(TagId(tagId_t::InstanceNumber_0020_0013), 0) == subOperation;
+        dimse.sendCommandOrResponse(CStoreResponse(storeCommand, dimseStatusCode_t::success));
+    }
+
+    CGetResponse finalResponse(dimse.getCGetResponse(getCommand));
+    bSuccess = bSuccess &&
+            finalResponse.getStatus() == dimseStatus_t::success &&
+            finalResponse.getCompletedSubOperations() == subOperations;
+    if(bSuccess)
+    {
+        ++successCount;
+    }
+
+    scu.release();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// The handlers of a DimseServer served by 1 worker thread
+//  send C-STORE sub-operations and wait for their
+//  responses while serving several C-GET SCUs
+//
+///////////////////////////////////////////////////////////
+TEST(dimseTest, dimseServerGetTest)
+{
+    PresentationContext context("1.2.840.10008.5.1.4.1.2.1.3", true, true);
+    context.addTransferSyntax("1.2.840.10008.1.2"); // implicit VR little endian
+    PresentationContexts presentationContexts;
+    presentationContexts.addPresentationContext(context);
+
+    TCPListener tcpListener(TCPPassiveAddress("", "30008"));
+
+    const std::uint32_t subOperations(5);
+    getHandler handler(subOperations);
+    DimseServer server(tcpListener, "SCP", 1, 1, presentationContexts, 10, 10, 1, handler);
+
+    const size_t scuCount(4);
+    std::atomic<int> successCount(0);
+    std::list<std::thread> scuThreads;
+    for(size_t startThreads(0); startThreads != scuCount; ++startThreads)
+    {
+        scuThreads.emplace_back(dimseServerGetScuThread, std::string("30008"), std::ref(presentationContexts), subOperations, std::ref(successCount));
+    }
+    for(std::thread& scuThread: scuThreads)
+    {
+        scuThread.join();
+    }
+
+    EXPECT_EQ((int)scuCount, successCount.load());
+
+    server.terminate();
+}
+
+
+///////////////////////////////////////////////////////////
+//
+// Handler that checks the size and the content of the
+//  received C-STORE payloads
+//
+///////////////////////////////////////////////////////////
+class largeStoreHandler: public DimseCommandsHandler
+{
+public:
+    largeStoreHandler(size_t payloadSize): m_payloadSize(payloadSize), m_storeCount(0)
+    {
+    }
+
+    virtual void processCommand(DimseService& dimseService, const DimseCommand& command) override
+    {
+        CStoreCommand storeCommand(command.getAsCStoreCommand());
+        ReadingDataHandlerNumeric reading(storeCommand.getPayloadDataSet().getReadingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 0));
+        size_t dataSize(0);
+        const char* pData(reading.data(&dataSize));
+        bool bCorrect(dataSize == m_payloadSize);
+        for(size_t checkData(0); bCorrect && checkData != dataSize; ++checkData)
+        {
+            bCorrect = pData[checkData] == (char)(checkData & 0x7f);
+        }
+        if(bCorrect)
+        {
+            ++m_storeCount;
+        }
+        dimseService.sendCommandOrResponse(CStoreResponse(storeCommand, bCorrect ? dimseStatusCode_t::success : dimseStatusCode_t::unableToProcess));
+    }
+
+    const size_t m_payloadSize;
+    std::atomic<int> m_storeCount;
+};
+
+
+///////////////////////////////////////////////////////////
+//
+// A DimseServer receives payloads larger than its receive
+//  buffer, and aborts the associations that send PDUs
+//  longer than the negotiated maximum length
+//
+///////////////////////////////////////////////////////////
+TEST(dimseTest, dimseServerLargePayloadTest)
+{
+    PresentationContext storeContext("1.2.840.10008.5.1.4.1.1.1");
+    storeContext.addTransferSyntax("1.2.840.10008.1.2"); // implicit VR little endian
+    PresentationContexts presentationContexts;
+    presentationContexts.addPresentationContext(storeContext);
+
+    TCPListener tcpListener(TCPPassiveAddress("", "30009"));
+
+    const size_t payloadSize(4 * 1024 * 1024);
+    largeStoreHandler handler(payloadSize);
+    DimseServer server(tcpListener, "SCP", 1, 1, presentationContexts, 10, 10, 1, handler);
+
+    {
+        TCPStream tcpStream(TCPActiveAddress("127.0.0.1", "30009"));
+        StreamReader readSCU(tcpStream.getStreamInput());
+        StreamWriter writeSCU(tcpStream.getStreamOutput());
+        AssociationSCU scu("SCU", "SCP", 1, 1, presentationContexts, readSCU, writeSCU, 0);
+        DimseService dimse(scu);
+
+        for(size_t sendCommands(0); sendCommands != 2; ++sendCommands)
+        {
+            MutableDataSet payload("1.2.840.10008.1.2");
+            payload.setString(TagId(tagId_t::SOPClassUID_0008_0016), "1.1.1.1.1");
+            payload.setString(TagId(tagId_t::SOPInstanceUID_0008_0018), "1.1.1.1.2");
+            {
+                WritingDataHandlerNumeric writing(payload.getWritingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 0, tagVR_t::OB));
+                writing.setSize(payloadSize);
+                size_t dummy;
+                char* pData(writing.data(&dummy));
+                for(size_t fillData(0); fillData != payloadSize; ++fillData)
+                {
+                    pData[fillData] = (char)(fillData & 0x7f);
+                }
+            }
+            CStoreCommand storeCommand(
+                        "1.2.840.10008.5.1.4.1.1.1",
+                        dimse.getNextCommandID(),
+                        dimseCommandPriority_t::medium,
+                        "1.1.1.1.1",
+                        "1.1.1.1.2",
+                        "",
+                        0,
+                        payload);
+            dimse.sendCommandOrResponse(storeCommand);
+            EXPECT_EQ(dimseStatus_t::success, dimse.getCStoreResponse(storeCommand).getStatus());
+        }
+
+        scu.release();
+    }
+    EXPECT_EQ(2, handler.m_storeCount.load());
+
+    // A P-DATA PDU longer than the maximum length advertised
+    // by the server
+    ///////////////////////////////////////////////////////////
+    TCPStream tcpStream(TCPActiveAddress("127.0.0.1", "30009"));
+    StreamReader readSCU(tcpStream.getStreamInput());
+    StreamWriter writeSCU(tcpStream.getStreamOutput());
+    AssociationSCU scu("SCU", "SCP", 1, 1, presentationContexts, readSCU, writeSCU, 0);
+    const std::uint8_t longPData[] = {0x04, 0x00, 0x10, 0x00, 0x00, 0x00};
+    writeSCU.write((const char*)longPData, sizeof(longPData));
+    writeSCU.flush();
+
+    DimseService dimse(scu);
+    EXPECT_THROW(dimse.getCommand(), StreamClosedError);
+
+    server.terminate();
+}
+
+
 
 
 
@@ -1,5 +1,10 @@
 #include <imebra/imebra.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
 #include <thread>
 #include "buildImageForTest.h"
 
@@ -206,6 +211,351 @@ TEST(jpegCodecTest, testLossless)
 }
 
 
+TEST(jpegCodecTest, testRestartIntervals)
+{
+    const char* transferSyntaxes[] = {"1.2.840.10008.1.2.4.50", "1.2.840.10008.1.2.4.57", "1.2.840.10008.1.2.4.70"};
+
+    for(const char* transferSyntax: transferSyntaxes)
+    {
+        for(std::uint32_t restartRows(1); restartRows <= 3; restartRows += 2)
+        {
+            std::cout << "Testing restart intervals (transfer syntax " << transferSyntax << ", " << restartRows << " MCU rows per interval)" << std::endl;
+
+            const bool bLossless(std::string(transferSyntax) != "1.2.840.10008.1.2.4.50");
+
+            std::uint32_t width = 301;
+            std::uint32_t height = 203;
+
+            Image image = buildImageForTest(width, height, bitDepth_t::depthU8, 7, bLossless ? "RGB" : "YBR_FULL", 50);
+
+            CodecFactory::setJpegRestartRows(restartRows);
+            MutableDataSet dataSet(transferSyntax);
+            dataSet.setImage(0, image, imageQuality_t::veryHigh);
+            CodecFactory::setJpegRestartRows(0);
+
+            CodecFactory::setJpegDecodingThreads(1);
+            Image sequentialImage = dataSet.getImage(0);
+
+            CodecFactory::setJpegDecodingThreads(4);
+            Image parallelImage = dataSet.getImage(0);
+            CodecFactory::setJpegDecodingThreads(1);
+
+            ASSERT_DOUBLE_EQ(0.0, compareImages(sequentialImage, parallelImage));
+            if(bLossless)
+            {
+                ASSERT_DOUBLE_EQ(0.0, compareImages(image, parallelImage));
+            }
+            else
+            {
+                ASSERT_LE(compareImages(image, parallelImage), 5);
+            }
+        }
+    }
+}
+
+
+TEST(jpegCodecTest, testRegion)
+{
+    const char* transferSyntaxes[] = {"1.2.840.10008.1.2.4.50", "1.2.840.10008.1.2.4.70"};
+
+    for(const char* transferSyntax: transferSyntaxes)
+    {
+        for(std::uint32_t restartRows(0); restartRows <= 1; ++restartRows)
+        {
+            std::cout << "Testing jpeg region (transfer syntax " << transferSyntax << ", " << restartRows << " MCU rows per interval)" << std::endl;
+
+            const bool bLossless(std::string(transferSyntax) != "1.2.840.10008.1.2.4.50");
+
+            std::uint32_t width = 301;
+            std::uint32_t height = 203;
+
+            Image image = buildImageForTest(width, height, bitDepth_t::depthU8, 7, bLossless ? "RGB" : "YBR_FULL", 50);
+
+            CodecFactory::setJpegRestartRows(restartRows);
+            MutableDataSet dataSet(transferSyntax);
+            dataSet.setImage(0, image, imageQuality_t::veryHigh);
+            CodecFactory::setJpegRestartRows(0);
+
+            for(std::uint32_t threadsCount(1); threadsCount <= 4; threadsCount += 3)
+            {
+                CodecFactory::setJpegDecodingThreads(threadsCount);
+
+                Image fullImage = dataSet.getImage(0);
+
+                const std::uint32_t regions[][4] = {{0, 0, width, height}, {0, 0, 1, 1}, {37, 61, 100, 45}, {width - 9, height - 17, 9, 17}, {150, 0, 20, height}};
+                for(const std::uint32_t* region: regions)
+                {
+                    Image regionImage = dataSet.getImage(0, region[0], region[1], region[2], region[3]);
+                    ASSERT_EQ(region[2], regionImage.getWidth());
+                    ASSERT_EQ(region[3], regionImage.getHeight());
+                    ASSERT_TRUE(identicalRegion(fullImage, regionImage, region[0], region[1]));
+                }
+            }
+            CodecFactory::setJpegDecodingThreads(1);
+        }
+    }
+}
+
+
+// Typical huffman tables listed in Annex K (K.3.3.1 and K.3.3.2): the
+//  number of codes for each length (1 to 16) followed by the values
+const std::vector<std::uint8_t> annexKLuminanceDC = {
+    0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const std::vector<std::uint8_t> annexKChrominanceDC = {
+    0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const std::vector<std::uint8_t> annexKLuminanceAC = {
+    0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d,
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa};
+
+const std::vector<std::uint8_t> annexKChrominanceAC = {
+    0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77,
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa};
+
+// Collect the huffman tables defined by the DHT segments that precede the
+//  first scan of a jpeg stream. The key is the table class (0 = DC,
+//  1 = AC) followed by the table id
+std::map<std::uint8_t, std::vector<std::uint8_t> > readHuffmanTables(const std::uint8_t* pJpeg, size_t jpegSize)
+{
+    std::map<std::uint8_t, std::vector<std::uint8_t> > tables;
+
+    // Skip the SOI marker, then walk the segments up to SOS
+    for(size_t position(2); position + 4 <= jpegSize; )
+    {
+        EXPECT_EQ(0xff, pJpeg[position]);
+        const std::uint8_t marker(pJpeg[position + 1]);
+        const size_t segmentEnd(position + 2 + ((size_t)pJpeg[position + 2] << 8) + (size_t)pJpeg[position + 3]);
+        if(marker == 0xda || segmentEnd > jpegSize)
+        {
+            break;
+        }
+        if(marker == 0xc4)
+        {
+            for(size_t scanTables(position + 4); scanTables + 17 <= segmentEnd; )
+            {
+                const std::uint8_t tableKey(pJpeg[scanTables]);
+                size_t valuesCount(0);
+                for(size_t length(0); length != 16; ++length)
+                {
+                    valuesCount += pJpeg[scanTables + 1 + length];
+                }
+                const size_t tableEnd(std::min(scanTables + 17 + valuesCount, segmentEnd));
+                tables[tableKey].assign(pJpeg + scanTables + 1, pJpeg + tableEnd);
+                scanTables = tableEnd;
+            }
+        }
+        position = segmentEnd;
+    }
+
+    return tables;
+}
+
+
+TEST(jpegCodecTest, testStandardHuffmanTables)
+{
+    const char* transferSyntaxes[] = {"1.2.840.10008.1.2.4.50", "1.2.840.10008.1.2.4.70"};
+
+    for(const char* transferSyntax: transferSyntaxes)
+    {
+        const bool bLossless(std::string(transferSyntax) != "1.2.840.10008.1.2.4.50");
+
+        // The 16 bits lossless image is encoded with the optimal
+        //  huffman tables
+        for(int bits16 = 0; bits16 != (bLossless ? 2 : 1); ++bits16)
+        {
+            std::cout << "Testing standard huffman tables (transfer syntax " << transferSyntax << ", 16 bits=" << bits16 << ")" << std::endl;
+
+            std::uint32_t width = 257;
+            std::uint32_t height = 131;
+
+            Image image = buildImageForTest(width, height, bits16 == 0 ? bitDepth_t::depthU8 : bitDepth_t::depthU16, bits16 == 0 ? 7 : 15, bLossless ? "RGB" : "YBR_FULL", 50);
+
+            CodecFactory::setJpegStandardHuffmanTables(true);
+            CodecFactory::setJpegRestartRows(2);
+            MutableDataSet dataSet(transferSyntax);
+            dataSet.setImage(0, image, imageQuality_t::veryHigh);
+            CodecFactory::setJpegStandardHuffmanTables(false);
+            CodecFactory::setJpegRestartRows(0);
+
+            Image checkImage = dataSet.getImage(0);
+            if(bLossless)
+            {
+                ASSERT_DOUBLE_EQ(0.0, compareImages(image, checkImage));
+            }
+            else
+            {
+                ASSERT_LE(compareImages(image, checkImage), 5);
+            }
+
+            // The 8 bits image must use exactly the tables listed in
+            //  Annex K: table 0 for the luminance, table 1 for the
+            //  chrominance
+            if(bits16 == 0)
+            {
+                ReadingDataHandlerNumeric jpegHandler(dataSet.getReadingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 1));
+                size_t jpegSize(0);
+                const std::uint8_t* pJpeg(reinterpret_cast<const std::uint8_t*>(jpegHandler.data(&jpegSize)));
+                const std::map<std::uint8_t, std::vector<std::uint8_t> > tables(readHuffmanTables(pJpeg, jpegSize));
+
+                const std::map<std::uint8_t, const std::vector<std::uint8_t>*> expectedTables = {
+                    {0x00, &annexKLuminanceDC}, {0x01, &annexKChrominanceDC}, {0x10, &annexKLuminanceAC}, {0x11, &annexKChrominanceAC}};
+
+                ASSERT_EQ(1u, tables.count(0x00));
+                if(!bLossless)
+                {
+                    ASSERT_EQ(1u, tables.count(0x10));
+                }
+                for(const std::pair<const std::uint8_t, std::vector<std::uint8_t> >& table: tables)
+                {
+                    ASSERT_EQ(1u, expectedTables.count(table.first));
+                    EXPECT_EQ(*(expectedTables.at(table.first)), table.second);
+                }
+            }
+        }
+    }
+}
+
+
+// Build an image made of 8x8 blocks that stress the DCT: random blocks and
+//  blocks containing only the minimum and the maximum values
+Image buildDctTestImage(std::uint32_t highBit)
+{
+    const std::uint32_t blocksPerRow(16);
+    const std::uint32_t blocksTypes(8);
+    const std::uint32_t size(blocksPerRow * 8);
+    const std::uint32_t maxValue(((std::uint32_t)1 << (highBit + 1)) - 1);
+
+    MutableImage image(size, size, highBit < 8 ? bitDepth_t::depthU8 : bitDepth_t::depthU16, "MONOCHROME2", highBit);
+    WritingDataHandler handler(image.getWritingDataHandler());
+
+    std::mt19937 randomGenerator(1234);
+    std::uniform_int_distribution<std::uint32_t> randomValue(0, maxValue);
+
+    for(std::uint32_t scanY(0); scanY != size; ++scanY)
+    {
+        for(std::uint32_t scanX(0); scanX != size; ++scanX)
+        {
+            const std::uint32_t blockX(scanX % 8), blockY(scanY % 8);
+            const bool bHigh((blockX & 1) != (blockY & 1));
+            std::uint32_t value(0);
+            switch(((scanY / 8) * blocksPerRow + scanX / 8) % blocksTypes)
+            {
+            case 0: value = 0; break;
+            case 1: value = maxValue; break;
+            case 2: value = bHigh ? maxValue : 0; break;
+            case 3: value = (blockX & 1) != 0 ? maxValue : 0; break;
+            case 4: value = blockY < 4 ? maxValue : 0; break;
+            case 5: value = (blockX == 0 && blockY == 0) ? maxValue : 0; break;
+            case 6: value = blockX == blockY ? 0 : maxValue; break;
+            default: value = randomValue(randomGenerator);
+            }
+            handler.setUnsignedLong(scanY * size + scanX, value);
+        }
+    }
+
+    return image;
+}
+
+
+TEST(jpegCodecTest, testDctImplementations)
+{
+    const jpegDct_t implementations[] = {jpegDct_t::sse2, jpegDct_t::avx2};
+    const imageQuality_t qualities[] = {imageQuality_t::veryHigh, imageQuality_t::medium, imageQuality_t::veryLow};
+
+    for(std::uint32_t highBit: {7u, 11u})
+    {
+        Image image(buildDctTestImage(highBit));
+        const std::string transferSyntax(highBit == 7 ? "1.2.840.10008.1.2.4.50" : "1.2.840.10008.1.2.4.51");
+
+        for(imageQuality_t quality: qualities)
+        {
+            // Encode and decode with the portable DCT
+            CodecFactory::setJpegDct(jpegDct_t::portable);
+            ASSERT_EQ(jpegDct_t::portable, CodecFactory::getJpegDct());
+
+            MutableDataSet portableDataSet(transferSyntax);
+            portableDataSet.setImage(0, image, quality);
+            MutableMemory portableJpeg;
+            {
+                MemoryStreamOutput stream(portableJpeg);
+                StreamWriter writer(stream);
+                CodecFactory::save(portableDataSet, writer, codecType_t::jpeg);
+            }
+            Image portableImage(portableDataSet.getImage(0));
+            ReadingDataHandlerNumeric portableHandler(portableImage.getReadingDataHandler());
+
+            for(jpegDct_t implementation: implementations)
+            {
+                try
+                {
+                    CodecFactory::setJpegDct(implementation);
+                }
+                catch(const JpegCodecError&)
+                {
+                    std::cout << "DCT implementation " << (std::uint32_t)implementation << " not supported by the CPU" << std::endl;
+                    continue;
+                }
+                ASSERT_EQ(implementation, CodecFactory::getJpegDct());
+
+                std::cout << "Testing DCT implementation " << (std::uint32_t)implementation << " (" << (highBit + 1) << " bits, quality " << (std::uint32_t)quality << ")" << std::endl;
+
+                // The FDCT must return the same coefficients
+                MutableDataSet simdDataSet(transferSyntax);
+                simdDataSet.setImage(0, image, quality);
+                MutableMemory simdJpeg;
+                {
+                    MemoryStreamOutput stream(simdJpeg);
+                    StreamWriter writer(stream);
+                    CodecFactory::save(simdDataSet, writer, codecType_t::jpeg);
+                }
+                size_t portableSize(0), simdSize(0);
+                const char* pPortableData(portableJpeg.data(&portableSize));
+                const char* pSimdData(simdJpeg.data(&simdSize));
+                ASSERT_EQ(portableSize, simdSize);
+                ASSERT_EQ(0, ::memcmp(pPortableData, pSimdData, portableSize));
+
+                // The IDCT may differ by one unit
+                Image simdImage(portableDataSet.getImage(0));
+                ReadingDataHandlerNumeric simdHandler(simdImage.getReadingDataHandler());
+                ASSERT_EQ(portableHandler.getSize(), simdHandler.getSize());
+                std::int32_t maxDifference(0);
+                for(size_t scanValues(0); scanValues != portableHandler.getSize(); ++scanValues)
+                {
+                    maxDifference = std::max(maxDifference, std::abs(portableHandler.getSignedLong(scanValues) - simdHandler.getSignedLong(scanValues)));
+                }
+                EXPECT_LE(maxDifference, 1);
+            }
+        }
+    }
+
+    CodecFactory::setJpegDct(jpegDct_t::automatic);
+    EXPECT_NE(jpegDct_t::automatic, CodecFactory::getJpegDct());
+}
+
+
 void feedJpegDataThread(PipeStream& source, DataSet& dataSet)
 {
     StreamWriter writer(source.getStreamOutput());
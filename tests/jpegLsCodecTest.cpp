@@ -0,0 +1,192 @@
+#include <imebra/imebra.h>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "buildImageForTest.h"
+
+namespace imebra
+{
+
+namespace tests
+{
+
+// Compress the example image in T.87 Annex H.3 and check
+//  the result against the stream published in the standard
+TEST(jpegLsCodecTest, testStandardExample)
+{
+    const std::uint8_t samples[] = {
+        0, 0, 90, 74,
+        68, 50, 43, 205,
+        64, 145, 145, 145,
+        100, 145, 145, 145};
+
+    const std::uint8_t expectedStream[] = {
+        0xff, 0xd8, 0xff, 0xf7, 0x00, 0x0b, 0x08, 0x00, 0x04, 0x00, 0x04, 0x01, 0x01, 0x11, 0x00,
+        0xff, 0xda, 0x00, 0x08, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0xc0, 0x00, 0x00, 0x6c, 0x80, 0x20, 0x8e, 0x01, 0xc0, 0x00, 0x00, 0x57, 0x40, 0x00, 0x00, 0x6e,
+        0xe6, 0x00, 0x00, 0x01, 0xbc, 0x18, 0x00, 0x00, 0x05, 0xd8, 0x00, 0x00, 0x91, 0x60,
+        0xff, 0xd9};
+
+    MutableImage image(4, 4, bitDepth_t::depthU8, "MONOCHROME2", 7);
+    {
+        WritingDataHandler handler(image.getWritingDataHandler());
+        for(size_t index(0); index != sizeof(samples); ++index)
+        {
+            handler.setUnsignedLong(index, samples[index]);
+        }
+    }
+
+    MutableMemory compressed;
+    {
+        MemoryStreamOutput compressedStream(compressed);
+        StreamWriter writer(compressedStream);
+        CodecFactory::saveImage(writer, image, "1.2.840.10008.1.2.4.80", imageQuality_t::veryHigh, 8, false, false, true, false);
+    }
+
+    size_t compressedSize(0);
+    const char* pCompressed(compressed.data(&compressedSize));
+    ASSERT_EQ(sizeof(expectedStream), compressedSize);
+    for(size_t index(0); index != sizeof(expectedStream); ++index)
+    {
+        EXPECT_EQ(expectedStream[index], (std::uint8_t)pCompressed[index]);
+    }
+
+    MutableDataSet dataSet("1.2.840.10008.1.2.4.80");
+    dataSet.setImage(0, image, imageQuality_t::veryHigh);
+    ASSERT_DOUBLE_EQ(0.0, compareImages(image, dataSet.getImage(0)));
+}
+
+
+TEST(jpegLsCodecTest, testLossless)
+{
+    for(int interleaved = 0; interleaved != 2; ++interleaved)
+    {
+        for(std::uint32_t highBit = 0; highBit <= 15; highBit += (highBit < 7 ? 7 : 4))
+        {
+            for(int b2Complement = 0; b2Complement != 2; ++b2Complement)
+            {
+                for(int colorSpace(0); colorSpace != 2; ++colorSpace)
+                {
+                    std::cout <<
+                                 "Testing lossless jpeg-ls (high bit " << highBit <<
+                                 ", interleaved=" << interleaved <<
+                                 ", 2complement=" << b2Complement <<
+                                 ", colorSpace=" << (colorSpace == 0 ? "RGB" : "MONOCHROME2") <<
+                                 ")"<< std::endl;
+
+                    std::uint32_t width = 115;
+                    std::uint32_t height = 400;
+
+                    bitDepth_t depth;
+                    if(highBit < 8)
+                    {
+                        depth = (b2Complement == 1) ? bitDepth_t::depthS8 : bitDepth_t::depthU8;
+                    }
+                    else
+                    {
+                        depth = (b2Complement == 1) ? bitDepth_t::depthS16 : bitDepth_t::depthU16;
+                    }
+
+                    Image image = buildImageForTest(width, height, depth, highBit, colorSpace == 0 ? "RGB" : "MONOCHROME2", 50);
+
+                    MutableMemory savedJpegLs;
+                    {
+                        MutableDataSet dataSet("1.2.840.10008.1.2.4.80");
+                        dataSet.setUnsignedLong(TagId(tagId_t::PlanarConfiguration_0028_0006), interleaved == 1 ? 0 : 1);
+                        dataSet.setImage(0, image, imageQuality_t::veryHigh);
+
+                        MemoryStreamOutput saveStream(savedJpegLs);
+                        StreamWriter writer(saveStream);
+                        CodecFactory::save(dataSet, writer, codecType_t::dicom);
+                    }
+
+                    MemoryStreamInput loadStream(savedJpegLs);
+                    StreamReader reader(loadStream);
+
+                    DataSet readDataSet = CodecFactory::load(reader, 0xffff);
+                    EXPECT_EQ("1.2.840.10008.1.2.4.80", readDataSet.getString(TagId(tagId_t::TransferSyntaxUID_0002_0010), 0));
+
+                    Image checkImage = readDataSet.getImage(0);
+
+                    // Compare the buffers
+                    double difference = compareImages(image, checkImage);
+                    ASSERT_DOUBLE_EQ(0.0, difference);
+                }
+            }
+        }
+    }
+}
+
+
+TEST(jpegLsCodecTest, testNearLossless)
+{
+    for(int interleaved = 0; interleaved != 2; ++interleaved)
+    {
+        for(std::uint32_t highBit = 7; highBit <= 11; highBit += 4)
+        {
+            for(imageQuality_t quality: {imageQuality_t::veryHigh, imageQuality_t::high, imageQuality_t::medium})
+            {
+                std::cout <<
+                             "Testing near-lossless jpeg-ls (high bit " << highBit <<
+                             ", interleaved=" << interleaved <<
+                             ", quality=" << (std::uint32_t)quality <<
+                             ")"<< std::endl;
+
+                std::uint32_t width = 301;
+                std::uint32_t height = 203;
+
+                Image image = buildImageForTest(width, height, highBit < 8 ? bitDepth_t::depthU8 : bitDepth_t::depthU16, highBit, "RGB", 50);
+
+                MutableDataSet dataSet("1.2.840.10008.1.2.4.81");
+                dataSet.setUnsignedLong(TagId(tagId_t::PlanarConfiguration_0028_0006), interleaved == 1 ? 0 : 1);
+                dataSet.setImage(0, image, quality);
+
+                Image checkImage = dataSet.getImage(0);
+
+                // The error of each sample cannot be larger than the
+                //  NEAR parameter
+                const std::int64_t near(((std::int64_t)quality / 100) << (highBit - 7));
+                std::int64_t maxError(0);
+                ReadingDataHandler originalHandler(image.getReadingDataHandler());
+                ReadingDataHandler checkHandler(checkImage.getReadingDataHandler());
+                for(size_t index(0); index != originalHandler.getSize(); ++index)
+                {
+                    maxError = std::max(maxError, (std::int64_t)std::llabs((std::int64_t)originalHandler.getUnsignedLong(index) - (std::int64_t)checkHandler.getUnsignedLong(index)));
+                }
+                EXPECT_LE(maxError, near);
+                if(quality == imageQuality_t::veryHigh)
+                {
+                    ASSERT_EQ(0, maxError);
+                }
+            }
+        }
+    }
+}
+
+
+TEST(jpegLsCodecTest, testCorruptedStream)
+{
+    Image image = buildImageForTest(64, 64, bitDepth_t::depthU8, 7, "MONOCHROME2", 50);
+
+    MutableMemory compressed;
+    {
+        MemoryStreamOutput compressedStream(compressed);
+        StreamWriter writer(compressedStream);
+        CodecFactory::saveImage(writer, image, "1.2.840.10008.1.2.4.80", imageQuality_t::veryHigh, 8, false, false, true, false);
+    }
+
+    // Truncate the coded data
+    size_t compressedSize(0);
+    const char* pCompressed(compressed.data(&compressedSize));
+    MutableDataSet dataSet("1.2.840.10008.1.2.4.80");
+    dataSet.setImage(0, image, imageQuality_t::veryHigh);
+    {
+        WritingDataHandlerNumeric handler(dataSet.getWritingDataHandlerRaw(TagId(tagId_t::PixelData_7FE0_0010), 1));
+        handler.assign(pCompressed, compressedSize / 4);
+    }
+
+    EXPECT_THROW(dataSet.getImage(0), CodecCorruptedFileError);
+}
+
+} // namespace tests
+
+} // namespace imebra
@@ -97,6 +97,47 @@ TEST(memoryTest, testMemoryPool)
     }
 }
 
+// Check that the memory released by a thread can be reused by
+//  another one
+TEST(memoryTest, testSharedMemoryPool)
+{
+    MemoryPool::flush();
+    MemoryPool::setMemoryPoolSize(100, 500);
+
+    // The memory pool of a terminating thread is moved to the
+    //  shared memory pool
+    std::thread releaseThread([]()
+    {
+        MemoryPool::setMemoryPoolSize(100, 500);
+        MutableMemory memory(400);
+    });
+    releaseThread.join();
+    EXPECT_EQ(0u, MemoryPool::getUnusedMemorySize());
+    EXPECT_EQ(400u, MemoryPool::getSharedUnusedMemorySize());
+
+    const size_t hitsCount(MemoryPool::getHitsCount());
+    const size_t missesCount(MemoryPool::getMissesCount());
+    {
+        MutableMemory memory(400);
+        EXPECT_EQ(0u, MemoryPool::getSharedUnusedMemorySize());
+        EXPECT_EQ(hitsCount + 1, MemoryPool::getHitsCount());
+        EXPECT_EQ(missesCount, MemoryPool::getMissesCount());
+
+        MutableMemory newMemory(300);
+        EXPECT_EQ(missesCount + 1, MemoryPool::getMissesCount());
+    }
+    // The memory evicted from the thread's memory pool goes to the
+    //  shared memory pool
+    EXPECT_EQ(400u, MemoryPool::getUnusedMemorySize());
+    EXPECT_EQ(300u, MemoryPool::getSharedUnusedMemorySize());
+
+    MemoryPool::flush();
+    EXPECT_EQ(0u, MemoryPool::getUnusedMemorySize());
+    EXPECT_EQ(0u, MemoryPool::getSharedUnusedMemorySize());
+
+    MemoryPool::setMemoryPoolSize(1024, 20000000);
+}
+
 TEST(memoryTest, readMemory)
 {
     std::string testString("Test string");
@@ -14,6 +14,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #include <imebra/imebra.h>
 #include "buildImageForTest.h"
 #include <gtest/gtest.h>
+#include <cstring>
 
 namespace imebra
 {
@@ -103,6 +104,370 @@ TEST(multipleImagesTest, testLosslessImages)
     } // transferSyntaxId
 }
 
+
+TEST(multipleImagesTest, testParallelDecoding)
+{
+    const size_t numImages(12);
+
+    for(int transferSyntaxId(0); transferSyntaxId != 3; ++transferSyntaxId)
+    {
+        std::string transferSyntax;
+        switch(transferSyntaxId)
+        {
+        case 0:
+            transferSyntax = "1.2.840.10008.1.2.4.70";
+            break;
+        case 1:
+            transferSyntax = "1.2.840.10008.1.2.1";
+            break;
+        case 2:
+            transferSyntax = "1.2.840.10008.1.2.5";
+            break;
+        }
+
+        std::cout << "Parallel decoding test. Transfer syntax: " << transferSyntax << std::endl;
+
+        std::vector<Image> images;
+        MutableMemory streamMemory;
+        {
+            MutableDataSet testDataSet(transferSyntax);
+            for(size_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+            {
+                images.push_back(buildImageForTest(300, 200, bitDepth_t::depthU16, 15, "MONOCHROME2", static_cast<std::uint32_t>(imageNumber + 2)));
+                testDataSet.setImage(imageNumber, images.back(), imageQuality_t::veryHigh);
+            }
+
+            MemoryStreamOutput writeStream(streamMemory);
+            StreamWriter writer(writeStream);
+            CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+        }
+
+        MemoryStreamInput readStream(streamMemory);
+        StreamReader reader(readStream);
+        DataSet testDataSet = CodecFactory::load(reader, 1);
+
+        for(size_t threadsCount(0); threadsCount != 5; ++threadsCount)
+        {
+            std::vector<Image> checkImages(testDataSet.getImages(2, numImages - 2, threadsCount));
+            ASSERT_EQ(numImages - 2, checkImages.size());
+            for(size_t imageNumber(0); imageNumber != checkImages.size(); ++imageNumber)
+            {
+                ASSERT_TRUE(identicalImages(checkImages[imageNumber], images[imageNumber + 2]));
+            }
+        }
+
+        ASSERT_THROW(testDataSet.getImages(numImages - 2, 3, 2), DataSetImageDoesntExistError);
+    } // transferSyntaxId
+}
+
+
+TEST(multipleImagesTest, testParallelEncoding)
+{
+    const size_t numImages(12);
+
+    std::vector<Image> images;
+    for(size_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+    {
+        images.push_back(buildImageForTest(300, 200, bitDepth_t::depthU16, 15, "MONOCHROME2", static_cast<std::uint32_t>(imageNumber + 2)));
+    }
+
+    for(int transferSyntaxId(0); transferSyntaxId != 3; ++transferSyntaxId)
+    {
+        std::string transferSyntax;
+        switch(transferSyntaxId)
+        {
+        case 0:
+            transferSyntax = "1.2.840.10008.1.2.4.70";
+            break;
+        case 1:
+            transferSyntax = "1.2.840.10008.1.2.1";
+            break;
+        case 2:
+            transferSyntax = "1.2.840.10008.1.2.5";
+            break;
+        }
+
+        std::cout << "Parallel encoding test. Transfer syntax: " << transferSyntax << std::endl;
+
+        // Reference dataset, built one frame at a time
+        MutableMemory referenceMemory;
+        {
+            MutableDataSet testDataSet(transferSyntax);
+            for(size_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+            {
+                testDataSet.setImage(imageNumber, images[imageNumber], imageQuality_t::veryHigh);
+            }
+
+            MemoryStreamOutput writeStream(referenceMemory);
+            StreamWriter writer(writeStream);
+            CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+        }
+
+        for(size_t threadsCount(0); threadsCount != 5; ++threadsCount)
+        {
+            // The RLE segments are compressed in parallel too
+            CodecFactory::setRLEEncodingThreads(static_cast<std::uint32_t>(threadsCount));
+
+            MutableMemory streamMemory;
+            {
+                MutableDataSet testDataSet(transferSyntax);
+                testDataSet.setImage(0, images[0], imageQuality_t::veryHigh);
+                testDataSet.setImages(1, std::vector<Image>(images.begin() + 1, images.end()), imageQuality_t::veryHigh, threadsCount);
+
+                ASSERT_THROW(testDataSet.setImages(numImages + 1, images, imageQuality_t::veryHigh, threadsCount), DataSetWrongFrameError);
+                std::vector<Image> differentImages(2, images[0]);
+                differentImages.push_back(buildImageForTest(300, 201, bitDepth_t::depthU16, 15, "MONOCHROME2", 2));
+                ASSERT_THROW(testDataSet.setImages(numImages, differentImages, imageQuality_t::veryHigh, threadsCount), DataSetDifferentFormatError);
+
+                MemoryStreamOutput writeStream(streamMemory);
+                StreamWriter writer(writeStream);
+                CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+            }
+
+            size_t referenceSize(0), streamSize(0);
+            const char* pReference(referenceMemory.data(&referenceSize));
+            const char* pStream(streamMemory.data(&streamSize));
+            ASSERT_EQ(referenceSize, streamSize);
+            ASSERT_EQ(0, ::memcmp(pReference, pStream, streamSize));
+        }
+
+        CodecFactory::setRLEEncodingThreads(1);
+    } // transferSyntaxId
+}
+
+
+TEST(multipleImagesTest, testFramesWriter)
+{
+    const std::uint32_t numImages(6);
+
+    std::vector<Image> images;
+    for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+    {
+        images.push_back(buildImageForTest(300, 200, bitDepth_t::depthU16, 15, "MONOCHROME2", imageNumber + 2));
+    }
+
+    for(int transferSyntaxId(0); transferSyntaxId != 3; ++transferSyntaxId)
+    {
+        std::string transferSyntax;
+        switch(transferSyntaxId)
+        {
+        case 0:
+            transferSyntax = "1.2.840.10008.1.2.4.70";
+            break;
+        case 1:
+            transferSyntax = "1.2.840.10008.1.2.5";
+            break;
+        case 2:
+            transferSyntax = "1.2.840.10008.1.2.4.80";
+            break;
+        }
+
+        std::cout << "Frames writer test. Transfer syntax: " << transferSyntax << std::endl;
+
+        MutableMemory streamMemory;
+        {
+            MutableDataSet testDataSet(transferSyntax);
+            testDataSet.setString(TagId(tagId_t::PatientName_0010_0010), "Test^Patient");
+            testDataSet.setString(TagId(0x7fe1, 0x0010), "After the pixel data", tagVR_t::LO);
+
+            MemoryStreamOutput writeStream(streamMemory);
+            StreamWriter writer(writeStream);
+            FramesWriter framesWriter(testDataSet, writer, numImages, imageQuality_t::veryHigh);
+            ASSERT_THROW(framesWriter.close(), DataSetWrongFrameError);
+            for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+            {
+                framesWriter.addFrame(images[imageNumber]);
+            }
+            ASSERT_THROW(framesWriter.addFrame(buildImageForTest(300, 201, bitDepth_t::depthU16, 15, "MONOCHROME2", 2)), DataSetWrongFrameError);
+            framesWriter.close();
+        }
+
+        MemoryStreamInput readStream(streamMemory);
+        StreamReader reader(readStream);
+        DataSet loadedDataSet(CodecFactory::load(reader));
+
+        EXPECT_EQ(transferSyntax, loadedDataSet.getString(TagId(tagId_t::TransferSyntaxUID_0002_0010), 0));
+        EXPECT_EQ("Test^Patient", loadedDataSet.getString(TagId(tagId_t::PatientName_0010_0010), 0));
+        EXPECT_EQ("After the pixel data", loadedDataSet.getString(TagId(0x7fe1, 0x0010), 0));
+        EXPECT_EQ(numImages, loadedDataSet.getUnsignedLong(TagId(tagId_t::NumberOfFrames_0028_0008), 0));
+        for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+        {
+            EXPECT_TRUE(identicalImages(images[imageNumber], loadedDataSet.getImage(imageNumber)));
+        }
+    }
+
+    // Frames with different attributes
+    {
+        MutableMemory streamMemory;
+        MutableDataSet testDataSet("1.2.840.10008.1.2.5");
+        MemoryStreamOutput writeStream(streamMemory);
+        StreamWriter writer(writeStream);
+        FramesWriter framesWriter(testDataSet, writer, numImages, imageQuality_t::veryHigh);
+        framesWriter.addFrame(images[0]);
+        ASSERT_THROW(framesWriter.addFrame(buildImageForTest(300, 201, bitDepth_t::depthU16, 15, "MONOCHROME2", 2)), DataSetDifferentFormatError);
+    }
+
+    // Native transfer syntaxes are not encapsulated
+    {
+        MutableMemory streamMemory;
+        MutableDataSet testDataSet("1.2.840.10008.1.2.1");
+        MemoryStreamOutput writeStream(streamMemory);
+        StreamWriter writer(writeStream);
+        FramesWriter framesWriter(testDataSet, writer, numImages, imageQuality_t::veryHigh);
+        ASSERT_THROW(framesWriter.addFrame(images[0]), CodecWrongTransferSyntaxError);
+    }
+
+    // The dataset must not contain pixel data
+    {
+        MutableMemory streamMemory;
+        MutableDataSet testDataSet("1.2.840.10008.1.2.5");
+        testDataSet.setImage(0, images[0], imageQuality_t::veryHigh);
+        MemoryStreamOutput writeStream(streamMemory);
+        StreamWriter writer(writeStream);
+        ASSERT_THROW(FramesWriter(testDataSet, writer, numImages, imageQuality_t::veryHigh), DataSetWrongFrameError);
+    }
+}
+
+
+TEST(multipleImagesTest, testExtendedOffsetTable)
+{
+    const std::uint32_t numImages(5);
+
+    std::vector<Image> images;
+    for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+    {
+        images.push_back(buildImageForTest(301, 200, bitDepth_t::depthU8, 7, "MONOCHROME2", imageNumber + 2));
+    }
+
+    for(int writerType(0); writerType != 2; ++writerType)
+    {
+        std::cout << "Extended offset table test. Writer: " << (writerType == 0 ? "FramesWriter" : "DataSet") << std::endl;
+
+        MutableMemory streamMemory;
+        {
+            MutableDataSet testDataSet("1.2.840.10008.1.2.5");
+            MemoryStreamOutput writeStream(streamMemory);
+            StreamWriter writer(writeStream);
+            if(writerType == 0)
+            {
+                FramesWriter framesWriter(testDataSet, writer, numImages, imageQuality_t::veryHigh, true);
+                for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+                {
+                    framesWriter.addFrame(images[imageNumber]);
+                }
+                framesWriter.close();
+            }
+            else
+            {
+                // An empty extended offset table is kept updated by setImage()
+                testDataSet.getWritingDataHandlerRaw(TagId(tagId_t::ExtendedOffsetTable_7FE0_0001), 0, tagVR_t::OV);
+                for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+                {
+                    testDataSet.setImage(imageNumber, images[imageNumber], imageQuality_t::veryHigh);
+                }
+                CodecFactory::save(testDataSet, writer, codecType_t::dicom);
+            }
+        }
+
+        MemoryStreamInput readStream(streamMemory);
+        StreamReader reader(readStream);
+        DataSet loadedDataSet(CodecFactory::load(reader));
+
+        EXPECT_EQ(tagVR_t::OV, loadedDataSet.getDataType(TagId(tagId_t::ExtendedOffsetTable_7FE0_0001)));
+        EXPECT_EQ(numImages * 8, loadedDataSet.getTag(TagId(tagId_t::ExtendedOffsetTable_7FE0_0001)).getBufferSize(0));
+        EXPECT_EQ(numImages * 8, loadedDataSet.getTag(TagId(tagId_t::ExtendedOffsetTableLengths_7FE0_0002)).getBufferSize(0));
+
+        // The basic offset table is empty, the extended one
+        //  points to the fragments
+        Tag pixelData(loadedDataSet.getTag(TagId(tagId_t::PixelData_7FE0_0010)));
+        EXPECT_EQ(0u, pixelData.getBufferSize(0));
+        ASSERT_EQ(numImages + 1, pixelData.getBuffersCount());
+        std::uint32_t expectedOffset(0);
+        for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+        {
+            const std::uint32_t fragmentSize(static_cast<std::uint32_t>(pixelData.getBufferSize(imageNumber + 1)));
+            EXPECT_EQ(expectedOffset, loadedDataSet.getUnsignedLong(TagId(tagId_t::ExtendedOffsetTable_7FE0_0001), imageNumber));
+            EXPECT_EQ(fragmentSize, loadedDataSet.getUnsignedLong(TagId(tagId_t::ExtendedOffsetTableLengths_7FE0_0002), imageNumber));
+            expectedOffset += fragmentSize + 8;
+        }
+
+        for(std::uint32_t imageNumber(numImages); imageNumber != 0; --imageNumber)
+        {
+            EXPECT_TRUE(identicalImages(images[imageNumber - 1], loadedDataSet.getImage(imageNumber - 1)));
+        }
+    }
+
+    // The extended offset table cannot be written into a
+    //  stream that doesn't allow random access
+    {
+        PipeStream pipe(1024);
+        StreamWriter writer(pipe.getStreamOutput());
+        MutableDataSet testDataSet("1.2.840.10008.1.2.5");
+        EXPECT_THROW(FramesWriter(testDataSet, writer, numImages, imageQuality_t::veryHigh, true), StreamWriteError);
+        FramesWriter framesWriter(testDataSet, writer, numImages, imageQuality_t::veryHigh, false);
+        pipe.close(0);
+    }
+}
+
+
+TEST(multipleImagesTest, testCorruptedExtendedOffsetTable)
+{
+    const std::uint32_t numImages(3);
+
+    std::vector<Image> images;
+    for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+    {
+        images.push_back(buildImageForTest(301, 200, bitDepth_t::depthU8, 7, "MONOCHROME2", imageNumber + 2));
+    }
+
+    MutableDataSet testDataSet("1.2.840.10008.1.2.5");
+    testDataSet.getWritingDataHandlerRaw(TagId(tagId_t::ExtendedOffsetTable_7FE0_0001), 0, tagVR_t::OV);
+    for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+    {
+        testDataSet.setImage(imageNumber, images[imageNumber], imageQuality_t::veryHigh);
+    }
+    const TagId offsetsTag(tagId_t::ExtendedOffsetTable_7FE0_0001);
+    const TagId lengthsTag(tagId_t::ExtendedOffsetTableLengths_7FE0_0002);
+    std::vector<std::uint32_t> offsets, lengths;
+    for(std::uint32_t imageNumber(0); imageNumber != numImages; ++imageNumber)
+    {
+        offsets.push_back(testDataSet.getUnsignedLong(offsetsTag, imageNumber));
+        lengths.push_back(testDataSet.getUnsignedLong(lengthsTag, imageNumber));
+    }
+
+    // Replace a table, changing one of its entries
+    auto writeTable = [&testDataSet](const TagId& tableTag, std::vector<std::uint32_t> values, size_t changeEntry, std::uint32_t changeValue)
+    {
+        values[changeEntry] = changeValue;
+        WritingDataHandler tableHandler(testDataSet.getWritingDataHandler(tableTag, 0));
+        tableHandler.setSize(values.size());
+        for(size_t entry(0); entry != values.size(); ++entry)
+        {
+            tableHandler.setUnsignedLong(entry, values[entry]);
+        }
+    };
+
+    EXPECT_TRUE(identicalImages(images[1], testDataSet.getImage(1)));
+
+    // A length larger than the fragment
+    writeTable(lengthsTag, lengths, 1, lengths[1] + 2);
+    EXPECT_THROW(testDataSet.getImage(1), DataSetCorruptedOffsetTableError);
+    EXPECT_TRUE(identicalImages(images[2], testDataSet.getImage(2)));
+    writeTable(lengthsTag, lengths, 1, lengths[1]);
+    EXPECT_TRUE(identicalImages(images[1], testDataSet.getImage(1)));
+
+    // An offset that doesn't point to the frame's fragment
+    writeTable(offsetsTag, offsets, 1, offsets[1] + 2);
+    EXPECT_THROW(testDataSet.getImage(1), DataSetCorruptedOffsetTableError);
+    writeTable(offsetsTag, offsets, 1, offsets[1]);
+    EXPECT_TRUE(identicalImages(images[1], testDataSet.getImage(1)));
+
+    // The lengths table must have one entry per frame
+    lengths.pop_back();
+    writeTable(lengthsTag, lengths, 0, lengths[0]);
+    EXPECT_THROW(testDataSet.getImage(0), DataSetCorruptedOffsetTableError);
+}
+
 }
 
 }
@@ -35,6 +35,8 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #import "imebra_exceptions.h"
 #import "imebra_fileStreamInput.h"
 #import "imebra_fileStreamOutput.h"
+#import "imebra_framesWriter.h"
+#import "imebra_mappedFileStreamInput.h"
 #import "imebra_image.h"
 #import "imebra_lut.h"
 #import "imebra_memoryPool.h"
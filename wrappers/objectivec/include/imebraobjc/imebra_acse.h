@@ -104,6 +104,49 @@ If you do not want to be bound by the GPL terms (such as the requirement
 @end
 
 
+///
+/// \brief The folders where an ImebraAssociationSCP spools the received
+///        payloads, per abstract syntax.
+///
+/// See ImebraAssociationBase::setPayloadSpoolFolder for the details about
+/// the spooling.
+///
+///////////////////////////////////////////////////////////////////////////////
+@interface ImebraPayloadSpoolFolders: NSObject
+{
+    @public
+    define_imebra_object_holder(PayloadSpoolFolders);
+}
+
+    ///
+    /// \brief Initializer. Initially no payload is spooled.
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    -(id)init;
+
+    -(void)dealloc;
+
+    ///
+    /// \brief Store the payloads received for a specific abstract
+    ///        syntax in temporary files instead of memory.
+    ///
+    /// \param abstractSyntax    the abstract syntax of the payloads
+    ///                          to store in the spool folder
+    /// \param spoolFolder       the folder where the temporary files
+    ///                          are created. An empty string disables
+    ///                          the spooling for the abstract syntax
+    /// \param maxSizeBufferLoad the tags larger than this size are
+    ///                          not loaded in memory
+    /// \param pError            set to a subclass of NSError in case
+    ///                          of error
+    ///
+    //////////////////////////////////////////////////////////////////
+    -(void)setPayloadSpoolFolder:(NSString*)abstractSyntax spoolFolder:(NSString*)spoolFolder maxSizeBufferLoad:(unsigned int)maxSizeBufferLoad error:(NSError**)pError
+        __attribute__((swift_error(nonnull_error)));
+
+@end
+
+
 ///
 /// \brief A message composed by one or two datasets.
 ///
@@ -288,6 +331,27 @@ If you do not want to be bound by the GPL terms (such as the requirement
     //////////////////////////////////////////////////////////////////
     -(NSString*)getTransferSyntax:(NSString*)abstractSyntax error:(NSError**)pError;
 
+    ///
+    /// \brief Store the payloads received for a specific abstract
+    ///        syntax in temporary files instead of memory.
+    ///
+    /// The tags larger than maxSizeBufferLoad are not loaded in
+    /// memory but reference the temporary file.
+    ///
+    /// \param abstractSyntax    the abstract syntax of the payloads
+    ///                          to store in the spool folder
+    /// \param spoolFolder       the folder where the temporary files
+    ///                          are created. An empty string disables
+    ///                          the spooling for the abstract syntax
+    /// \param maxSizeBufferLoad the tags larger than this size are
+    ///                          not loaded in memory
+    /// \param pError            set to a subclass of NSError in case
+    ///                          of error
+    ///
+    //////////////////////////////////////////////////////////////////
+    -(void)setPayloadSpoolFolder:(NSString*)abstractSyntax spoolFolder:(NSString*)spoolFolder maxSizeBufferLoad:(unsigned int)maxSizeBufferLoad error:(NSError**)pError
+        __attribute__((swift_error(nonnull_error)));
+
     ///
     /// \brief Returns our AET.
     ///
@@ -419,6 +483,43 @@ If you do not want to be bound by the GPL terms (such as the requirement
                                     writer:(ImebraStreamWriter*)pOutput
                                     dimseTimeoutSeconds:(unsigned int)dimseTimeoutSeconds
                                     artimTimeoutSeconds:(unsigned int)artimTimeoutSeconds error:(NSError**)pError;
+
+    ///
+    /// \brief Listens for an association request and spools the
+    ///        received payloads into temporary files.
+    ///
+    /// Same as the previous initializer, but the payloads of the abstract
+    /// syntaxes listed in spoolFolders are stored in temporary files from
+    /// the first one received.
+    ///
+    /// \param thisAET              the AET of the SCP. If empty then the SCP
+    ///                             will accept associations for any called AET
+    /// \param invokedOperations    maximum number of parallel operations we
+    ///                             intend to invoke when acting as a SCU
+    /// \param performedOperations  maximum number of parallel operations we can
+    ///                             perform when acting as a SCP
+    /// \param presentationContexts list of accepted presentation contexts
+    /// \param pInput               input stream from which the SCP receives
+    ///                             data
+    /// \param pOutput              output stream into which the SCP writes
+    ///                             data
+    /// \param dimseTimeoutSeconds  DIMSE timeout, in seconds. 0 means infinite
+    /// \param artimTimeoutSeconds  ARTIM timeout, in seconds
+    /// \param spoolFolders         the folders where the payloads are spooled,
+    ///                             per abstract syntax
+    /// \param pError               may be set to one of the errors listed for
+    ///                             the previous initializer
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    -(id)initWithThisAET:(NSString*)thisAET
+                                    maxInvokedOperations:(unsigned int)invokedOperations
+                                    maxPerformedOperations:(unsigned int)performedOperations
+                                    presentationContexts:(ImebraPresentationContexts*)presentationContexts
+                                    reader:(ImebraStreamReader*)pInput
+                                    writer:(ImebraStreamWriter*)pOutput
+                                    dimseTimeoutSeconds:(unsigned int)dimseTimeoutSeconds
+                                    artimTimeoutSeconds:(unsigned int)artimTimeoutSeconds
+                                    spoolFolders:(ImebraPayloadSpoolFolders*)spoolFolders error:(NSError**)pError;
 @end
 
 
@@ -19,6 +19,7 @@ If you do not want to be bound by the GPL terms (such as the requirement
 @class ImebraDataSet;
 @class ImebraStreamReader;
 @class ImebraStreamWriter;
+@class ImebraTagId;
 
 
 /// \enum ImebraCodecType
@@ -31,6 +32,19 @@ typedef NS_ENUM(unsigned short, ImebraCodecType)
     ImebraCodecTypeJpeg  = 1  ///< JPEG codec
 };
 
+
+/// \enum ImebraJpegDct
+/// \brief Defines the implementation of the 8x8 DCT used by the jpeg codec.
+///
+///////////////////////////////////////////////////////////////////////////////
+typedef NS_ENUM(unsigned int, ImebraJpegDct)
+{
+    ImebraJpegDctAutomatic = 0, ///< the fastest implementation supported by the CPU
+    ImebraJpegDctPortable  = 1, ///< the portable implementation
+    ImebraJpegDctSse2      = 2, ///< the SSE2 implementation (x86 CPUs)
+    ImebraJpegDctAvx2      = 3  ///< the AVX2 implementation (x86 CPUs)
+};
+
 ///
 /// \brief The ImebraCodecFactory class can load or save a DataSet or an Image
 ///        object using one of the codecs supplied by the Imebra library.
@@ -72,6 +86,30 @@ typedef NS_ENUM(unsigned short, ImebraCodecType)
     ///////////////////////////////////////////////////////////////////////////////
     +(ImebraDataSet*)loadFromFileMaxSize:(NSString*)fileName maxBufferSize:(unsigned int)maxBufferSize error:(NSError**)pError;
 
+    /// \brief Parses the content of the input file up to the specified tag
+    ///        and returns a ImebraDataSet object representing it.
+    ///
+    /// The parsing stops before the first tag of the root dataset with an id
+    /// equal or greater than stopTag (the group order is ignored).
+    ///
+    /// If none of the codecs supplied by Imebra is able to decode the file's
+    /// content then sets the pError parameter and returns nil.
+    ///
+    /// \param fileName          the name of the input file
+    /// \param maxSizeBufferLoad the maximum size of the tags that are loaded
+    ///                          immediately. Tags larger than maxSizeBufferLoad
+    ///                          are left on the input stream and loaded only when
+    ///                          a ImebraReadingDataHandler object or a
+    ///                          ImebraWritingDataHandler object reference them.
+    /// \param stopTag           the tag before which the parsing stops
+    /// \param pError            pointer to a NSError pointer that will be set
+    ///                          in case of error
+    /// \return a ImebraDataSet object representing the input file's content
+    ///         that precedes stopTag
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    +(ImebraDataSet*)loadFromFileMaxSize:(NSString*)fileName maxBufferSize:(unsigned int)maxBufferSize stopTag:(ImebraTagId*)stopTag error:(NSError**)pError;
+
     /// \brief Parses the content of the input stream and returns a
     ///        ImebraDataSet representing it.
     ///
@@ -113,6 +151,34 @@ typedef NS_ENUM(unsigned short, ImebraCodecType)
     ///////////////////////////////////////////////////////////////////////////////
     +(ImebraDataSet*)loadFromStreamMaxSize:(ImebraStreamReader*)pReader maxBufferSize:(unsigned int)maxBufferSize error:(NSError**)pError;
 
+    /// \brief Parses the content of the input stream up to the specified tag
+    ///        and returns a ImebraDataSet representing it.
+    ///
+    /// The parsing stops before the first tag of the root dataset with an id
+    /// equal or greater than stopTag (the group order is ignored).
+    ///
+    /// If none of the codecs supplied by Imebra is able to decode the stream's
+    /// content then sets the pError parameter and returns nil.
+    ///
+    /// The read position of the ImebraStreamReader object is undefined when
+    /// this method returns.
+    ///
+    /// \param pReader           a ImebraStreamReader object connected to the
+    ///                          input stream
+    /// \param maxSizeBufferLoad the maximum size of the tags that are loaded
+    ///                          immediately. Tags larger than maxSizeBufferLoad
+    ///                          are left on the input stream and loaded only when
+    ///                          an ImebraReadingDataHandler or an
+    ///                          ImebraWritingDataHandler object reference them.
+    /// \param stopTag           the tag before which the parsing stops
+    /// \param pError            pointer to a NSError pointer that will be set
+    ///                          in case of error
+    /// \return an ImebraDataSet object representing the input stream's content
+    ///         that precedes stopTag
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    +(ImebraDataSet*)loadFromStreamMaxSize:(ImebraStreamReader*)pReader maxBufferSize:(unsigned int)maxBufferSize stopTag:(ImebraTagId*)stopTag error:(NSError**)pError;
+
     /// \brief Saves the content of a ImebraDataSet object to a file.
     ///
     /// \param fileName          the name of the output file
@@ -148,6 +214,73 @@ typedef NS_ENUM(unsigned short, ImebraCodecType)
     ///////////////////////////////////////////////////////////////////////////////
     +(void)setMaximumImageSize:(unsigned int)maximumWidth maxHeight:(unsigned int)maximumHeight;
 
+    /// \brief Set the number of threads used to decode the restart intervals
+    ///        of a jpeg image.
+    ///
+    /// By default the jpeg images are decoded on the calling thread only.
+    ///
+    /// \param threadsCount the maximum number of threads used to decode a
+    ///                     jpeg image. 0 means one thread per CPU core
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    +(void)setJpegDecodingThreads:(unsigned int)threadsCount;
+
+    /// \brief Set the number of MCU rows in each restart interval written by
+    ///        the jpeg encoder.
+    ///
+    /// \param mcuRows the number of MCU rows in each restart interval.
+    ///                0 (default) disables the restart intervals
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    +(void)setJpegRestartRows:(unsigned int)mcuRows;
+
+    /// \brief Enable or disable the typical huffman tables (Annex K) in the
+    ///        jpeg encoder.
+    ///
+    /// The typical tables allow to encode the images in one pass.
+    ///
+    /// \param bStandardTables true if the jpeg encoder must use the typical
+    ///                        huffman tables, false (default) if it must
+    ///                        calculate the optimal tables
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    +(void)setJpegStandardHuffmanTables:(BOOL)bStandardTables;
+
+    /// \brief Select the implementation of the 8x8 DCT used by the jpeg
+    ///        codec.
+    ///
+    /// Select ImebraJpegDctPortable to obtain the same results on all the
+    /// platforms.
+    ///
+    /// \param dct    the implementation of the DCT to use
+    /// \param pError set to a NSError derived class in case of error (e.g.
+    ///               the CPU doesn't support the requested implementation)
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    +(void)setJpegDct:(ImebraJpegDct)dct error:(NSError**)pError;
+
+    /// \brief Set the number of threads used to compress the segments of an
+    ///        RLE image.
+    ///
+    /// By default the RLE images are compressed on the calling thread only.
+    ///
+    /// \param threadsCount the maximum number of threads used to compress an
+    ///                     RLE image. 0 means one thread per CPU core
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    +(void)setRLEEncodingThreads:(unsigned int)threadsCount;
+
+    /// \brief Set the maximum size of the cache that keeps the tags loaded on
+    ///        demand.
+    ///
+    /// By default the cache size is 64MB.
+    ///
+    /// \param maxCacheSize the maximum size of the cache, in bytes. 0 disables
+    ///                     the cache
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    +(void)setLazyLoadCacheSize:(unsigned int)maxCacheSize;
+
 @end
 
 #endif // imebraObjcCodecFactory__INCLUDED_
@@ -57,6 +57,7 @@ typedef NS_ENUM(unsigned short, ImebraTagType)
     ImebraTagTypeOD = 0x4f44, ///< Other Double String
     ImebraTagTypeOF = 0x4f46, ///< Other Float String
     ImebraTagTypeOL = 0x4f4c, ///< Other Long String
+    ImebraTagTypeOV = 0x4f56, ///< Other 64-bit Very Long
     ImebraTagTypeOW = 0x4f57, ///< Other Word String
     ImebraTagTypePN = 0x504e, ///< Person Name
     ImebraTagTypeSH = 0x5348, ///< Short String
@@ -176,6 +177,26 @@ typedef NS_ENUM(unsigned int, ImebraImageQuality)
     ///////////////////////////////////////////////////////////////////////////////
     -(ImebraImage*) getImage:(unsigned int) frameNumber error:(NSError**)pError;
 
+    /// \brief Retrieve a rectangular region of an image from the dataset.
+    ///
+    /// The native and the jpeg images skip most of the data outside the
+    /// region.
+    ///
+    /// Set pError and returns nil if the requested image does not exist or
+    /// if the region is empty or not completely inside the image.
+    ///
+    /// \param frameNumber the frame to retrieve (the first frame is 0)
+    /// \param left        the region's left column
+    /// \param top         the region's top row
+    /// \param width       the region's width, in pixels
+    /// \param height      the region's height, in pixels
+    /// \param pError      a pointer to a NSError pointer which is set when an
+    ///                    error occurs
+    /// \return an ImebraImage object containing the requested region
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    -(ImebraImage*) getImage:(unsigned int) frameNumber left:(unsigned int)left top:(unsigned int)top width:(unsigned int)width height:(unsigned int)height error:(NSError**)pError;
+
     /// \brief Retrieve one of the DICOM overlays.
     ///
     /// Set pError to ImebraMissingGroupError if the requested overlay does not
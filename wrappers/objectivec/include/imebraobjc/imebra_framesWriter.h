@@ -0,0 +1,99 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+#if !defined(imebraObjcFramesWriter__INCLUDED_)
+#define imebraObjcFramesWriter__INCLUDED_
+
+#import <Foundation/Foundation.h>
+#include "imebra_macros.h"
+#import "imebra_dataset.h"
+
+@class ImebraStreamWriter;
+@class ImebraImage;
+
+///
+/// \brief Writes a multi-frame DICOM file with compressed (encapsulated)
+///        pixel data directly into an ImebraStreamWriter, one frame at a
+///        time.
+///
+/// Only one compressed frame at a time is kept in memory.
+///
+/// The ImebraMutableDataSet passed to the initializer supplies the file's
+/// tags and the transfer syntax, and must not contain the pixel data
+/// (tag 7FE0,0010).
+///
+/// Call close() after the last frame: the file is incomplete until close()
+/// returns.
+///
+///////////////////////////////////////////////////////////////////////////////
+@interface ImebraFramesWriter: NSObject
+
+#ifndef __IMEBRA_OBJECTIVEC_BRIDGING__
+{
+    @public
+    define_imebra_object_holder(FramesWriter);
+}
+#endif
+
+    /// \brief Initializer.
+    ///
+    /// \param pDataSet     the dataset containing the file's tags and the
+    ///                     transfer syntax
+    /// \param pWriter      the ImebraStreamWriter into which the file is
+    ///                     written
+    /// \param framesNumber the number of frames that will be written
+    /// \param quality      the quality to use for lossy compression
+    /// \param pError       set to a NSError derived class in case of error
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    -(id)initWithDataSet:(ImebraMutableDataSet*)pDataSet writer:(ImebraStreamWriter*)pWriter framesNumber:(unsigned int)framesNumber quality:(ImebraImageQuality)quality error:(NSError**)pError;
+
+    /// \brief Initializer.
+    ///
+    /// \param pDataSet     the dataset containing the file's tags and the
+    ///                     transfer syntax
+    /// \param pWriter      the ImebraStreamWriter into which the file is
+    ///                     written. If bExtendedOffsetTable is true then it
+    ///                     must write into a file or a memory stream
+    /// \param framesNumber the number of frames that will be written
+    /// \param quality      the quality to use for lossy compression
+    /// \param bExtendedOffsetTable true if the Extended Offset Table and the
+    ///                     Extended Offset Table Lengths must be written
+    /// \param pError       set to a NSError derived class in case of error
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    -(id)initWithDataSet:(ImebraMutableDataSet*)pDataSet writer:(ImebraStreamWriter*)pWriter framesNumber:(unsigned int)framesNumber quality:(ImebraImageQuality)quality extendedOffsetTable:(BOOL)bExtendedOffsetTable error:(NSError**)pError;
+
+    -(void)dealloc;
+
+    /// \brief Compress a frame and write it into the stream.
+    ///
+    /// \param pImage the frame to write
+    /// \param pError set to a NSError derived class in case of error
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    -(void)addFrame:(ImebraImage*)pImage error:(NSError**)pError
+        __attribute__((swift_error(nonnull_error)));
+
+    /// \brief Terminate the pixel data, write the tags that follow it and
+    ///        flush the stream.
+    ///
+    /// \param pError set to a NSError derived class in case of error
+    ///
+    ///////////////////////////////////////////////////////////////////////////////
+    -(void)close:(NSError**)pError
+        __attribute__((swift_error(nonnull_error)));
+
+@end
+
+#endif // !defined(imebraObjcFramesWriter__INCLUDED_)
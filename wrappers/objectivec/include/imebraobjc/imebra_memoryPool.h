@@ -18,7 +18,8 @@ If you do not want to be bound by the GPL terms (such as the requirement
 
 @interface ImebraMemoryPool : NSObject
 
-/// \brief Release all the unused memory regions.
+/// \brief Release all the unused memory regions kept by the current
+///        thread and by the shared memory pool.
 ///
 ///////////////////////////////////////////////////////////////////////////////
 +(void) flush;
@@ -46,6 +47,41 @@ If you do not want to be bound by the GPL terms (such as the requirement
 ///////////////////////////////////////////////////////////////////////////////
 +(void) setMemoryPoolSize:(unsigned int)minMemoryBlockSize maxSize:(unsigned int)maxMemoryPoolSize;
 
+/// \brief Return the total size of the unused memory regions kept by the
+///        memory pool shared by all the threads.
+///
+/// \return the total size of the memory kept by the shared memory pool
+///
+///////////////////////////////////////////////////////////////////////////////
++(unsigned int) getSharedUnusedMemorySize;
+
+/// \brief Set the maximum size of the unused memory kept by the memory
+///        pool shared by all the threads.
+///
+/// \param maxSharedMemoryPoolSize the maximum size of the sum of all the
+///                                unused memory regions kept by the shared
+///                                memory pool
+///
+///////////////////////////////////////////////////////////////////////////////
++(void) setSharedMemoryPoolSize:(unsigned int)maxSharedMemoryPoolSize;
+
+/// \brief Return the number of memory requests, across all the threads,
+///        that have been satisfied by reusing an unused memory region.
+///
+/// \return the number of memory requests satisfied by the memory pools
+///
+///////////////////////////////////////////////////////////////////////////////
++(unsigned int) getHitsCount;
+
+/// \brief Return the number of memory requests, across all the threads,
+///        that could have been satisfied by the memory pools but required
+///        a new allocation.
+///
+/// \return the number of memory requests that required a new allocation
+///
+///////////////////////////////////////////////////////////////////////////////
++(unsigned int) getMissesCount;
+
 @end
 
 #endif // imebraObjcMemoryPool__INCLUDED_
@@ -4522,6 +4522,8 @@ typedef NS_ENUM(unsigned int, ImebraTagEnum)
     ImebraTagEnumVariableCoefficientsSDVN_7F00_0020 = 0x7F000020, ///< Variable Coefficients SDVN (7F00,0020)
     ImebraTagEnumVariableCoefficientsSDHN_7F00_0030 = 0x7F000030, ///< Variable Coefficients SDHN (7F00,0030)
     ImebraTagEnumVariableCoefficientsSDDN_7F00_0040 = 0x7F000040, ///< Variable Coefficients SDDN (7F00,0040)
+    ImebraTagEnumExtendedOffsetTable_7FE0_0001 = 0x7FE00001, ///< Extended Offset Table (7FE0,0001)
+    ImebraTagEnumExtendedOffsetTableLengths_7FE0_0002 = 0x7FE00002, ///< Extended Offset Table Lengths (7FE0,0002)
     ImebraTagEnumFloatPixelData_7FE0_0008 = 0x7FE00008, ///< Float Pixel Data (7FE0,0008)
     ImebraTagEnumDoubleFloatPixelData_7FE0_0009 = 0x7FE00009, ///< Double Float Pixel Data (7FE0,0009)
     ImebraTagEnumPixelData_7FE0_0010 = 0x7FE00010, ///< Pixel Data (7FE0,0010)
@@ -92,6 +92,40 @@ If you do not want to be bound by the GPL terms (such as the requirement
 @end
 
 
+@implementation ImebraPayloadSpoolFolders
+
+-(id)init
+{
+    reset_imebra_object_holder(PayloadSpoolFolders);
+    self = [super init];
+    if(self)
+    {
+        set_imebra_object_holder(PayloadSpoolFolders, new imebra::PayloadSpoolFolders());
+    }
+    return self;
+
+}
+
+-(void)dealloc
+{
+    delete_imebra_object_holder(PayloadSpoolFolders);
+}
+
+-(void)setPayloadSpoolFolder:(NSString*)abstractSyntax spoolFolder:(NSString*)spoolFolder maxSizeBufferLoad:(unsigned int)maxSizeBufferLoad error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    get_imebra_object_holder(PayloadSpoolFolders)->setPayloadSpoolFolder(
+                imebra::NSStringToString(abstractSyntax),
+                imebra::NSStringToString(spoolFolder),
+                (std::uint32_t)maxSizeBufferLoad);
+
+    OBJC_IMEBRA_FUNCTION_END();
+}
+
+@end
+
+
 @implementation ImebraAssociationMessage: NSObject
 
 -(id)initWithImebraAssociationMessage:define_imebra_parameter(AssociationMessage)
@@ -230,6 +264,18 @@ If you do not want to be bound by the GPL terms (such as the requirement
     OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
 }
 
+-(void)setPayloadSpoolFolder:(NSString*)abstractSyntax spoolFolder:(NSString*)spoolFolder maxSizeBufferLoad:(unsigned int)maxSizeBufferLoad error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    get_imebra_object_holder(AssociationBase)->setPayloadSpoolFolder(
+                imebra::NSStringToString(abstractSyntax),
+                imebra::NSStringToString(spoolFolder),
+                (std::uint32_t)maxSizeBufferLoad);
+
+    OBJC_IMEBRA_FUNCTION_END();
+}
+
 -(NSString*)thisAET
 {
     return imebra::stringToNSString(get_imebra_object_holder(AssociationBase)->getThisAET());
@@ -313,6 +359,40 @@ If you do not want to be bound by the GPL terms (such as the requirement
     OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
 }
 
+-(id)initWithThisAET:(NSString*)thisAET
+    maxInvokedOperations:(unsigned int)invokedOperations
+    maxPerformedOperations:(unsigned int)performedOperations
+    presentationContexts:(ImebraPresentationContexts*)presentationContexts
+    reader:(ImebraStreamReader*)pInput
+    writer:(ImebraStreamWriter*)pOutput
+    dimseTimeoutSeconds:(unsigned int)dimseTimeoutSeconds
+    artimTimeoutSeconds:(unsigned int)artimTimeoutSeconds
+    spoolFolders:(ImebraPayloadSpoolFolders*)spoolFolders error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    reset_imebra_object_holder(AssociationBase);
+
+    self = [super init];
+    if(self)
+    {
+        set_imebra_object_holder(AssociationBase,
+                    new imebra::AssociationSCP(
+                                     imebra::NSStringToString(thisAET),
+                                     invokedOperations,
+                                     performedOperations,
+                                     *get_other_imebra_object_holder(presentationContexts, PresentationContexts),
+                                     *get_other_imebra_object_holder(pInput, StreamReader),
+                                     *get_other_imebra_object_holder(pOutput, StreamWriter),
+                                     dimseTimeoutSeconds,
+                                     artimTimeoutSeconds,
+                                     *get_other_imebra_object_holder(spoolFolders, PayloadSpoolFolders)));
+    }
+    return self;
+
+    OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
+}
+
 @end
 
 
@@ -15,12 +15,14 @@ If you do not want to be bound by the GPL terms (such as the requirement
 #import "../include/imebraobjc/imebra_dataset.h"
 #import "../include/imebraobjc/imebra_streamReader.h"
 #import "../include/imebraobjc/imebra_streamWriter.h"
+#import "../include/imebraobjc/imebra_tagId.h"
 #include "imebra_implementation_macros.h"
 #include "imebra_nserror.h"
 #include "imebra_strings.h"
 #include <imebra/codecFactory.h>
 #include <imebra/dataSet.h>
 #include <imebra/streamReader.h>
+#include <imebra/tagId.h>
 
 @implementation ImebraCodecFactory
 
@@ -44,6 +46,16 @@ If you do not want to be bound by the GPL terms (such as the requirement
     OBJC_IMEBRA_FUNCTION_END_RETURN(nil)
 }
 
++(ImebraDataSet*)loadFromFileMaxSize:(NSString*) fileName maxBufferSize:(unsigned int)maxBufferSize stopTag:(ImebraTagId*)stopTag error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START()
+
+    std::unique_ptr<imebra::DataSet> pDataSet(new imebra::DataSet(imebra::CodecFactory::load(imebra::NSStringToString(fileName), maxBufferSize, *get_other_imebra_object_holder(stopTag, TagId))));
+    return [[ImebraDataSet alloc] initWithImebraDataSet:pDataSet.release()];
+
+    OBJC_IMEBRA_FUNCTION_END_RETURN(nil)
+}
+
 +(ImebraDataSet*)loadFromStream:(ImebraStreamReader*)pReader error:(NSError**)pError
 {
     OBJC_IMEBRA_FUNCTION_START();
@@ -64,6 +76,16 @@ If you do not want to be bound by the GPL terms (such as the requirement
     OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
 }
 
++(ImebraDataSet*)loadFromStreamMaxSize:(ImebraStreamReader*)pReader maxBufferSize:(unsigned int)maxBufferSize stopTag:(ImebraTagId*)stopTag error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    std::unique_ptr<imebra::DataSet> pDataSet(new imebra::DataSet(imebra::CodecFactory::load(*get_other_imebra_object_holder(pReader, StreamReader), maxBufferSize, *get_other_imebra_object_holder(stopTag, TagId))));
+    return [[ImebraDataSet alloc] initWithImebraDataSet:pDataSet.release()];
+
+    OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
+}
+
 +(void)saveToFile:(NSString*)fileName dataSet:(ImebraDataSet*)pDataSet codecType:(ImebraCodecType)codecType error:(NSError**)pError
 {
     OBJC_IMEBRA_FUNCTION_START();
@@ -88,6 +110,40 @@ If you do not want to be bound by the GPL terms (such as the requirement
     imebra::CodecFactory::setMaximumImageSize((const::uint32_t)maximumWidth, (const::uint32_t)maximumHeight);
 }
 
++(void)setJpegDecodingThreads:(unsigned int)threadsCount
+{
+    imebra::CodecFactory::setJpegDecodingThreads((std::uint32_t)threadsCount);
+}
+
++(void)setJpegRestartRows:(unsigned int)mcuRows
+{
+    imebra::CodecFactory::setJpegRestartRows((std::uint32_t)mcuRows);
+}
+
++(void)setJpegStandardHuffmanTables:(BOOL)bStandardTables
+{
+    imebra::CodecFactory::setJpegStandardHuffmanTables(bStandardTables ? true : false);
+}
+
++(void)setJpegDct:(ImebraJpegDct)dct error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    imebra::CodecFactory::setJpegDct((imebra::jpegDct_t)dct);
+
+    OBJC_IMEBRA_FUNCTION_END();
+}
+
++(void)setRLEEncodingThreads:(unsigned int)threadsCount
+{
+    imebra::CodecFactory::setRLEEncodingThreads((std::uint32_t)threadsCount);
+}
+
++(void)setLazyLoadCacheSize:(unsigned int)maxCacheSize
+{
+    imebra::CodecFactory::setLazyLoadCacheSize((size_t)maxCacheSize);
+}
+
 
 @end
 
@@ -102,6 +102,15 @@ If you do not want to be bound by the GPL terms (such as the requirement
     OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
 }
 
+-(ImebraImage*) getImage:(unsigned int) frameNumber left:(unsigned int)left top:(unsigned int)top width:(unsigned int)width height:(unsigned int)height error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    return [[ImebraImage alloc] initWithImebraImage:new imebra::Image(get_imebra_object_holder(DataSet)->getImage(frameNumber, left, top, width, height))];
+
+    OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
+}
+
 -(ImebraOverlay*) getOverlay:(unsigned int) overlayNumber error:(NSError**)pError
 {
     OBJC_IMEBRA_FUNCTION_START();
@@ -0,0 +1,90 @@
+/*
+Copyright 2005 - 2017 by Paolo Brandoli/Binarno s.p.
+
+Imebra is available for free under the GNU General Public License.
+
+The full text of the license is available in the file license.rst
+ in the project root folder.
+
+If you do not want to be bound by the GPL terms (such as the requirement
+ that your application must also be GPL), you may purchase a commercial
+ license for Imebra from the Imebra’s website (http://imebra.com).
+*/
+
+#import "../include/imebraobjc/imebra_framesWriter.h"
+#import "../include/imebraobjc/imebra_dataset.h"
+#import "../include/imebraobjc/imebra_streamWriter.h"
+#import "../include/imebraobjc/imebra_image.h"
+
+#include "imebra_implementation_macros.h"
+#include "imebra_nserror.h"
+#include <imebra/framesWriter.h>
+#include <imebra/dataSet.h>
+#include <imebra/streamWriter.h>
+#include <imebra/image.h>
+
+@implementation ImebraFramesWriter
+
+-(id)initWithDataSet:(ImebraMutableDataSet*)pDataSet writer:(ImebraStreamWriter*)pWriter framesNumber:(unsigned int)framesNumber quality:(ImebraImageQuality)quality error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    reset_imebra_object_holder(FramesWriter);
+    self = [super init];
+    if(self)
+    {
+        set_imebra_object_holder(FramesWriter, new imebra::FramesWriter(
+                                     *((imebra::MutableDataSet*)get_other_imebra_object_holder(pDataSet, DataSet)),
+                                     *get_other_imebra_object_holder(pWriter, StreamWriter),
+                                     framesNumber,
+                                     (imebra::imageQuality_t)quality));
+    }
+    return self;
+
+    OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
+}
+
+-(id)initWithDataSet:(ImebraMutableDataSet*)pDataSet writer:(ImebraStreamWriter*)pWriter framesNumber:(unsigned int)framesNumber quality:(ImebraImageQuality)quality extendedOffsetTable:(BOOL)bExtendedOffsetTable error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    reset_imebra_object_holder(FramesWriter);
+    self = [super init];
+    if(self)
+    {
+        set_imebra_object_holder(FramesWriter, new imebra::FramesWriter(
+                                     *((imebra::MutableDataSet*)get_other_imebra_object_holder(pDataSet, DataSet)),
+                                     *get_other_imebra_object_holder(pWriter, StreamWriter),
+                                     framesNumber,
+                                     (imebra::imageQuality_t)quality,
+                                     bExtendedOffsetTable == YES));
+    }
+    return self;
+
+    OBJC_IMEBRA_FUNCTION_END_RETURN(nil);
+}
+
+-(void)dealloc
+{
+    delete_imebra_object_holder(FramesWriter);
+}
+
+-(void)addFrame:(ImebraImage*)pImage error:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    get_imebra_object_holder(FramesWriter)->addFrame(*get_other_imebra_object_holder(pImage, Image));
+
+    OBJC_IMEBRA_FUNCTION_END();
+}
+
+-(void)close:(NSError**)pError
+{
+    OBJC_IMEBRA_FUNCTION_START();
+
+    get_imebra_object_holder(FramesWriter)->close();
+
+    OBJC_IMEBRA_FUNCTION_END();
+}
+
+@end
@@ -32,6 +32,26 @@ If you do not want to be bound by the GPL terms (such as the requirement
     imebra::MemoryPool::setMemoryPoolSize((size_t)minMemoryBlockSize, (size_t)maxMemoryPoolSize);
 }
 
++(unsigned int) getSharedUnusedMemorySize
+{
+    return (unsigned int)imebra::MemoryPool::getSharedUnusedMemorySize();
+}
+
++(void) setSharedMemoryPoolSize:(unsigned int)maxSharedMemoryPoolSize
+{
+    imebra::MemoryPool::setSharedMemoryPoolSize((size_t)maxSharedMemoryPoolSize);
+}
+
++(unsigned int) getHitsCount
+{
+    return (unsigned int)imebra::MemoryPool::getHitsCount();
+}
+
++(unsigned int) getMissesCount
+{
+    return (unsigned int)imebra::MemoryPool::getMissesCount();
+}
+
 @end
 
 
@@ -1,4 +1,4 @@
-%module (threads="1") imebra
+%module (threads="1", directors="1") imebra
 
 
 #ifdef SWIGJAVA
@@ -63,6 +63,9 @@
 %template(TagsIds) std::vector<imebra::TagId>;
 %template(VOIs) std::vector<imebra::VOIDescription>;
 
+// DimseCommandsHandler is implemented in the target language
+%feature("director") imebra::DimseCommandsHandler;
+
 %exception {
     try {
         $action
@@ -151,10 +154,13 @@
 %include "../library/include/imebra/drawBitmap.h"
 %include "../library/include/imebra/fileStreamInput.h"
 %include "../library/include/imebra/fileStreamOutput.h"
+%include "../library/include/imebra/mappedFileStreamInput.h"
 %include "../library/include/imebra/memoryStreamInput.h"
 %include "../library/include/imebra/memoryStreamOutput.h"
+%include "../library/include/imebra/framesWriter.h"
 %include "../library/include/imebra/acse.h"
 %include "../library/include/imebra/dimse.h"
+%include "../library/include/imebra/dimseServer.h"
 %include "../library/include/imebra/date.h"
 %include "../library/include/imebra/age.h"
 %include "../library/include/imebra/patientName.h"